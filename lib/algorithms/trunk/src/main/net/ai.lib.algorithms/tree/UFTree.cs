@@ -64,6 +64,14 @@ namespace ai.lib.algorithms.tree
             get { return _fdaReader != null;  }
         }
 
+        /// <summary>
+        /// Returns true if the tree is memory-mapped from a file (see ReadMapped()).
+        /// </summary>
+        public bool IsMapped
+        {
+            get { return _mappedFile != null; }
+        }
+
         public byte GetDepth(Int64 nodeIdx)
         {
             // Do only an assertion to get the max. performance
@@ -108,6 +116,10 @@ namespace ai.lib.algorithms.tree
             {
                 throw new ApplicationException(String.Format("Node index out of range: was {0}, node count {1}", nodeIdx, _nodesCount));
             }
+            if (IsMapped && !_mappedFile.IsCopyOnWrite)
+            {
+                throw new ApplicationException("Cannot modify a read-only mapped tree");
+            }
             _depths[nodeIdx] = depth;
         }
 
@@ -165,6 +177,43 @@ namespace ai.lib.algorithms.tree
             return tree;
         }
 
+        /// <summary>
+        /// Maps the file read-only to memory, with a hint for sequential pre-order access.
+        /// </summary>
+        public static T ReadMapped<T>(string fileName) where T : UFTree, new()
+        {
+            return ReadMapped<T>(fileName, false, MappedFileAdvice.Sequential);
+        }
+
+        /// <summary>
+        /// Binary deserialization by mapping the file to memory. Depths and nodes are accessed 
+        /// directly in the mapping (like in a tree read to memory), but the pages are loaded by the OS on demand 
+        /// and shared with other processes mapping the same file. This allows to work with trees larger 
+        /// than the available memory at nearly in-memory speed, unlike from-disk access.
+        /// <para>If isCopyOnWrite is false, the tree is read-only, SetDepth() throws an exception and 
+        /// writing to the nodes causes an access violation. Otherwise the tree can be modified, 
+        /// the changes are private to this object and are not written back to the file.</para>
+        /// <para>The advice is a hint for the access pattern: Sequential for pre-order walks, 
+        /// Random for index-based access.</para>
+        /// </summary>
+        public static T ReadMapped<T>(string fileName, bool isCopyOnWrite, MappedFileAdvice advice) where T : UFTree, new()
+        {
+            T tree = new T();
+            tree.ReadInternalMapped(fileName, isCopyOnWrite, advice);
+            return tree;
+        }
+
+        /// <summary>
+        /// Changes the access pattern hint of a mapped tree, does nothing for other trees.
+        /// </summary>
+        public void AdviseMapped(MappedFileAdvice advice)
+        {
+            if (_mappedFile != null)
+            {
+                _mappedFile.Advise(advice);
+            }
+        }
+
         /// <summary>
         /// Set memory of depths array to a given value.
         /// </summary>
@@ -203,6 +252,11 @@ namespace ai.lib.algorithms.tree
                 _fdaReader.Close();
                 _fdaReader = null;
             }
+            if (_mappedFile != null)
+            {
+                _mappedFile.Dispose();
+                _mappedFile = null;
+            }
         }
 
         #endregion
@@ -271,6 +325,8 @@ namespace ai.lib.algorithms.tree
         private long _depthFilePos;
         private long _nodesFilePos;
 
+        private MappedFile _mappedFile;
+
         #endregion
 
         #region Implementation
@@ -315,6 +371,32 @@ namespace ai.lib.algorithms.tree
             AfterRead();
         }
 
+        private void ReadInternalMapped(string fileName, bool isCopyOnWrite, MappedFileAdvice advice)
+        {
+            using (BinaryReader r = new BinaryReader(File.Open(fileName, FileMode.Open, FileAccess.Read, FileShare.Read)))
+            {
+                Version = new BdsVersion();
+                Version.Read(r);
+                int serFmtVer = r.ReadInt32();
+                _nodesByteSize = r.ReadInt64();
+                _nodesCount = r.ReadInt64();
+                _nodeByteSize = (int)(_nodesByteSize / _nodesCount);
+                _depthFilePos = r.BaseStream.Position;
+                _nodesFilePos = _depthFilePos + _nodesCount;
+                if (r.BaseStream.Length < _nodesFilePos + _nodesByteSize)
+                {
+                    throw new ApplicationException(String.Format("File '{0}' is truncated", fileName));
+                }
+                r.BaseStream.Seek(_nodesFilePos + _nodesByteSize, SeekOrigin.Begin);
+                ReadUserData(r);
+            }
+            _mappedFile = new MappedFile(fileName, advice, isCopyOnWrite);
+            _depthPtr = new SmartPtr(new IntPtr(_mappedFile.Ptr + _depthFilePos), false);
+            _depths = (byte*)_depthPtr;
+            _nodesPtr = new SmartPtr(new IntPtr(_mappedFile.Ptr + _nodesFilePos), false);
+            AfterRead();
+        }
+
         private Int64 _nodesCount;
 
         #endregion
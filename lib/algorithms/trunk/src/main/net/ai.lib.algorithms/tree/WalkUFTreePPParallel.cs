@@ -0,0 +1,438 @@
+/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Threading;
+using ai.lib.algorithms.parallel;
+
+namespace ai.lib.algorithms.tree
+{
+    /// <summary>
+    /// A parallel version of WalkUFTreePP. The tree is cut into subtrees at SplitDepth,
+    /// the subtrees are walked on ThreadsCount worker threads. It can replace WalkUFTreePP
+    /// with the same callbacks if they fulfill the rules below.
+    /// <para>The walk is done in 3 steps:</para>
+    /// <para>1. The nodes above SplitDepth (upper nodes) are walked in pre-order on the calling thread (OnNodeBegin() only).
+    /// Each node at SplitDepth - 1 with children becomes a job.</para>
+    /// <para>2. The workers process the jobs, the largest first. A free worker takes the next job, so that all workers
+    /// are busy until the jobs are exhausted. Each job walks all children of its node (OnNodeBegin() and OnNodeEnd()).
+    /// Each worker has its own context stack, the contexts of the upper nodes are shared.</para>
+    /// <para>3. OnNodeEnd() is called for the upper nodes in post-order on the calling thread, then OnReduce() for each worker.</para>
+    /// <para>Rules for the callbacks:</para>
+    /// <para>- A callback may modify its own node and context and those of the parent (stack[depth - 1]).
+    /// All children of a node are processed by the same worker, therefore this needs no locking.
+    /// The contexts of the other ancestors are shared between workers and must be treated as read-only.
+    /// Results are normally combined this way in OnNodeEnd() (e.g. summing node values into the parent).</para>
+    /// <para>- Results accumulated elsewhere (e.g. counters in fields) must be kept per worker (see CurrentWorker)
+    /// and combined in OnReduce().</para>
+    /// <para>- The order of calls differs from WalkUFTreePP: OnNodeBegin() for all upper nodes is called before the
+    /// subtrees are processed, and ChildrenCount of the upper ancestors (except the parent)
+    /// is the final number of children.</para>
+    /// <para>To jump over the subtrees, the walker keeps the end of the subtree of each node of the last walked tree
+    /// (8 bytes per node). It is created in the first parallel walk of a tree, therefore the structure of the tree
+    /// must not change between the walks.</para>
+    /// <para>A tree with from-disk access (UFTree.IsFDA) reads all nodes through one stream, therefore it is
+    /// walked on the calling thread as with ThreadsCount = 1.</para>
+    /// <para>The object owns the worker threads, call Dispose() to stop them.</para>
+    /// </summary>
+    public class WalkUFTreePPParallel<TreeT, ContextT> : WalkUFTreePP<TreeT, ContextT>, IDisposable
+        where TreeT : UFTree
+        where ContextT : WalkUFTreePPContext, new()
+    {
+        #region Public types
+
+        public delegate void OnReduceDelegate(TreeT tree, int worker);
+
+        #endregion
+
+        #region Public Interface
+
+        /// <summary>
+        /// Max. number of worker threads: the thread pool waits on a wait handle per thread,
+        /// WaitHandle.WaitAll() supports up to 64 handles.
+        /// </summary>
+        public const int MaxThreadsCount = 64;
+
+        public WalkUFTreePPParallel()
+        {
+            ThreadsCount = Environment.ProcessorCount;
+        }
+
+        /// <summary>
+        /// Number of worker threads, larger values are clamped to MaxThreadsCount. 
+        /// If it is 1, the subtrees are processed on the calling thread.
+        /// Default: number of processors.
+        /// </summary>
+        public int ThreadsCount
+        {
+            set { _threadsCount = Math.Min(value, MaxThreadsCount); }
+            get { return _threadsCount; }
+        }
+
+        /// <summary>
+        /// Depth (relative to the start node) of the roots of the subtrees processed by the workers.
+        /// If 0 (default), it is chosen automatically so that there are enough jobs for all workers.
+        /// </summary>
+        public int SplitDepth
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// A delegate called on the calling thread after all nodes are processed, once for each worker
+        /// (0..ThreadsCount-1) to combine the per-worker results.
+        /// </summary>
+        public OnReduceDelegate OnReduce
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Index of the worker (0..ThreadsCount-1) calling the callback from the current thread.
+        /// The calling thread uses index 0, it never runs concurrently with worker 0.
+        /// </summary>
+        public static int CurrentWorker
+        {
+            get { return _currentWorker; }
+        }
+
+        public override void Walk(TreeT tree, Int64 startNode)
+        {
+            int startDepth = tree.GetDepth(startNode);
+            int splitDepth = startDepth + 1;
+            bool isParallel = ThreadsCount > 1 && !tree.IsFDA;
+            if (isParallel)
+            {
+                PrepareSubtreeEnds(tree);
+                splitDepth += (SplitDepth > 0 ? SplitDepth : GetAutoSplitDepth(tree, startNode)) - 1;
+            }
+            if (splitDepth >= DEFAULT_DEPTH_LIMIT)
+            {
+                throw new ApplicationException(String.Format("Split depth {0} is too large", splitDepth));
+            }
+
+            _currentWorker = 0;
+            OnTreeBegin(tree);
+            List<ContextT> upperNodes = new List<ContextT>();
+            List<Job> jobs = new List<Job>();
+            WalkUpperNodes(tree, startNode, startDepth, splitDepth, upperNodes, jobs);
+            ProcessJobs(tree, splitDepth, jobs, isParallel);
+            _currentWorker = 0;
+            EndUpperNodes(tree, startDepth, upperNodes);
+            Reduce(tree);
+            OnTreeEnd(tree);
+        }
+
+        #endregion
+
+        #region IDisposable Members
+
+        public void Dispose()
+        {
+            if (_threadPool != null)
+            {
+                _threadPool.Dispose();
+                _threadPool = null;
+            }
+        }
+
+        #endregion
+
+        #region Implementation
+
+        private const int DEFAULT_DEPTH_LIMIT = 256;
+
+        /// <summary>
+        /// Number of jobs per worker to choose the split depth automatically.
+        /// More jobs give better load balancing, but more upper nodes processed by one thread.
+        /// </summary>
+        private const int AUTO_JOBS_PER_THREAD = 16;
+
+        class Job
+        {
+            /// <summary>
+            /// Contexts of the job node (the last element) and its ancestors.
+            /// </summary>
+            public ContextT[] Path;
+            public Int64 Begin;
+            /// <summary>
+            /// End of the subtree, or an upper bound if the subtree ends are not known.
+            /// </summary>
+            public Int64 End;
+        }
+
+        /// <summary>
+        /// Walks the nodes above the split depth, creates their contexts and the jobs.
+        /// The subtrees of the jobs are skipped, so only the upper nodes are visited.
+        /// </summary>
+        void WalkUpperNodes(TreeT tree, Int64 startNode, int startDepth, int splitDepth, List<ContextT> upperNodes, List<Job> jobs)
+        {
+            ContextT[] stack = new ContextT[splitDepth];
+            Int64 end = GetSubtreeEnd(tree, startNode);
+            for (Int64 i = startNode; i < end; )
+            {
+                int curDepth = tree.GetDepth(i);
+                ContextT context = new ContextT();
+                context.NodeIdx = i;
+                stack[curDepth] = context;
+                if (curDepth > startDepth)
+                {
+                    stack[curDepth - 1].ChildrenCount++;
+                }
+                upperNodes.Add(context);
+                OnNodeBegin(tree, stack, curDepth);
+                if (curDepth < splitDepth - 1)
+                {
+                    ++i;
+                    continue;
+                }
+                Job job = new Job { Begin = i, End = GetSubtreeEnd(tree, i), Path = new ContextT[splitDepth] };
+                Array.Copy(stack, job.Path, splitDepth);
+                jobs.Add(job);
+                i = job.End;
+            }
+            // Remove leaves, take the largest subtrees first.
+            jobs.RemoveAll(j => j.End - j.Begin <= 1);
+            jobs.Sort((j1, j2) => (j2.End - j2.Begin).CompareTo(j1.End - j1.Begin));
+        }
+
+        void ProcessJobs(TreeT tree, int splitDepth, List<Job> jobs, bool isParallel)
+        {
+            if (jobs.Count == 0)
+            {
+                return;
+            }
+            _jobs = jobs;
+            _nextJob = -1;
+            _error = null;
+            if (!isParallel)
+            {
+                Worker(tree, splitDepth, 0);
+            }
+            else
+            {
+                if (_threadPool == null || _threadPoolSize != ThreadsCount)
+                {
+                    Dispose();
+                    _threadPool = new BlockingThreadPool(ThreadsCount);
+                    _threadPoolSize = ThreadsCount;
+                }
+                ThreadPoolBase.Job<TreeT, int, int>[] workers = new ThreadPoolBase.Job<TreeT, int, int>[ThreadsCount];
+                for (int w = 0; w < workers.Length; ++w)
+                {
+                    workers[w] = new ThreadPoolBase.Job<TreeT, int, int> { Execute = Worker, Param1 = tree, Param2 = splitDepth, Param3 = w };
+                }
+                _threadPool.ExecuteJobs(workers);
+            }
+            _jobs = null;
+            if (_error != null)
+            {
+                Exception error = _error;
+                _error = null;
+                throw new ApplicationException("Walking a subtree failed, see inner exception for details.", error);
+            }
+        }
+
+        void Worker(TreeT tree, int splitDepth, int worker)
+        {
+            _currentWorker = worker;
+            ContextT[] stack = new ContextT[DEFAULT_DEPTH_LIMIT];
+            for (int d = splitDepth; d < stack.Length; ++d)
+            {
+                stack[d] = new ContextT();
+            }
+            OnNodeBeginDelegate onNodeBegin = OnNodeBegin;
+            OnNodeEndDelegate onNodeEnd = OnNodeEnd;
+            try
+            {
+                for (; ; )
+                {
+                    int j = Interlocked.Increment(ref _nextJob);
+                    if (j >= _jobs.Count || _error != null)
+                    {
+                        break;
+                    }
+                    Job job = _jobs[j];
+                    Array.Copy(job.Path, stack, splitDepth);
+                    int rootDepth = splitDepth - 1;
+                    int depth = rootDepth;
+                    for (Int64 i = job.Begin + 1; i < job.End; ++i)
+                    {
+                        int curDepth = tree.GetDepth(i);
+                        if (curDepth <= rootDepth)
+                        {
+                            // End of the subtree if job.End is an upper bound.
+                            break;
+                        }
+                        for (; depth >= curDepth; --depth)
+                        {
+                            onNodeEnd(tree, stack, depth);
+                        }
+                        depth = curDepth;
+                        stack[depth].NodeIdx = i;
+                        stack[depth].ChildrenCount = 0;
+                        stack[depth - 1].ChildrenCount++;
+                        onNodeBegin(tree, stack, depth);
+                    }
+                    for (; depth > rootDepth; --depth)
+                    {
+                        onNodeEnd(tree, stack, depth);
+                    }
+                }
+            }
+            catch (Exception e)
+            {
+                // Keep the first error and let the other workers stop.
+                Interlocked.CompareExchange(ref _error, e, null);
+            }
+        }
+
+        /// <summary>
+        /// Calls OnNodeEnd() for the upper nodes in post-order.
+        /// </summary>
+        void EndUpperNodes(TreeT tree, int startDepth, List<ContextT> upperNodes)
+        {
+            ContextT[] stack = new ContextT[DEFAULT_DEPTH_LIMIT];
+            int depth = startDepth - 1;
+            foreach (ContextT context in upperNodes)
+            {
+                int curDepth = tree.GetDepth(context.NodeIdx);
+                for (; depth >= curDepth; --depth)
+                {
+                    OnNodeEnd(tree, stack, depth);
+                }
+                depth = curDepth;
+                stack[depth] = context;
+            }
+            for (; depth >= startDepth; --depth)
+            {
+                OnNodeEnd(tree, stack, depth);
+            }
+        }
+
+        void Reduce(TreeT tree)
+        {
+            if (OnReduce == null)
+            {
+                return;
+            }
+            int workersCount = Math.Max(1, ThreadsCount);
+            for (int w = 0; w < workersCount; ++w)
+            {
+                OnReduce(tree, w);
+            }
+        }
+
+        /// <summary>
+        /// Finds the smallest depth with enough nodes to give each worker several jobs.
+        /// Goes down level by level over the subtree ends, so only the nodes down to the split depth are visited.
+        /// The result is cached for the last tree, because the same tree is often walked many times.
+        /// </summary>
+        int GetAutoSplitDepth(TreeT tree, Int64 startNode)
+        {
+            if (tree == _autoSplitTree && startNode == _autoSplitStartNode && ThreadsCount == _autoSplitThreadsCount)
+            {
+                return _autoSplitDepth;
+            }
+            int startDepth = tree.GetDepth(startNode);
+            // Jobs are the nodes at splitDepth - 1, find the first depth with enough of them.
+            int splitDepth = startDepth + 1;
+            List<Int64> level = new List<Int64> { startNode };
+            for (int d = startDepth; d < DEFAULT_DEPTH_LIMIT - 1; ++d)
+            {
+                List<Int64> nextLevel = new List<Int64>();
+                foreach (Int64 n in level)
+                {
+                    for (Int64 c = n + 1; c < _subtreeEnds[n]; c = _subtreeEnds[c])
+                    {
+                        nextLevel.Add(c);
+                    }
+                }
+                if (nextLevel.Count == 0)
+                {
+                    break;
+                }
+                splitDepth = d + 1;
+                if (level.Count >= AUTO_JOBS_PER_THREAD * ThreadsCount)
+                {
+                    break;
+                }
+                level = nextLevel;
+            }
+            _autoSplitTree = tree;
+            _autoSplitStartNode = startNode;
+            _autoSplitThreadsCount = ThreadsCount;
+            _autoSplitDepth = splitDepth - startDepth;
+            return _autoSplitDepth;
+        }
+
+        /// <summary>
+        /// Creates the subtree ends of all nodes of the tree in one pass, unless they are already there.
+        /// </summary>
+        void PrepareSubtreeEnds(TreeT tree)
+        {
+            if (tree == _subtreeEndsTree && _subtreeEnds.LongLength == tree.NodesCount)
+            {
+                return;
+            }
+            _subtreeEndsTree = null;
+            _subtreeEnds = null;
+            Int64[] ends = new Int64[tree.NodesCount];
+            Int64[] stack = new Int64[DEFAULT_DEPTH_LIMIT];
+            int depth = -1;
+            for (Int64 i = 0; i < tree.NodesCount; ++i)
+            {
+                int curDepth = tree.GetDepth(i);
+                for (; depth >= curDepth; --depth)
+                {
+                    ends[stack[depth]] = i;
+                }
+                depth = curDepth;
+                stack[depth] = i;
+            }
+            for (; depth >= 0; --depth)
+            {
+                ends[stack[depth]] = tree.NodesCount;
+            }
+            _subtreeEnds = ends;
+            _subtreeEndsTree = tree;
+        }
+
+        /// <summary>
+        /// Returns the end of the subtree of the node, or the number of nodes as an upper bound
+        /// if the subtree ends are not prepared (single thread).
+        /// </summary>
+        Int64 GetSubtreeEnd(TreeT tree, Int64 node)
+        {
+            return tree == _subtreeEndsTree ? _subtreeEnds[node] : tree.NodesCount;
+        }
+
+        [ThreadStatic]
+        private static int _currentWorker;
+
+        private int _threadsCount;
+        private BlockingThreadPool _threadPool;
+        private int _threadPoolSize;
+        private List<Job> _jobs;
+        private int _nextJob;
+        private Exception _error;
+
+        private TreeT _autoSplitTree;
+        private Int64 _autoSplitStartNode;
+        private int _autoSplitThreadsCount;
+        private int _autoSplitDepth;
+
+        /// <summary>
+        /// For each node of _subtreeEndsTree: the index of the first node after its subtree.
+        /// </summary>
+        private Int64[] _subtreeEnds;
+        private TreeT _subtreeEndsTree;
+
+        #endregion
+    }
+}
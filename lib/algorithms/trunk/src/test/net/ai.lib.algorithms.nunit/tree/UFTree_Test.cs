@@ -99,6 +99,68 @@ namespace ai.lib.algorithms.tree.nunit
             }
         }
 
+        [Test]
+        public unsafe void Test_ReadWriteMapped()
+        {
+            int nodesCount = 1 + 4 + 4 * 4 + 4 * 4 * 4;
+            TestTree tree = new TestTree(nodesCount);
+            int idx = 0;
+            CreateTestTree(tree, ref idx, 0, 3, 4);
+            tree.Version.Major = 4;
+            tree.Version.Minor = 2;
+            tree.UserData = 1234567;
+            string fileName = Path.Combine(_outDir, "uftree-mapped.dat");
+            tree.Write(fileName);
+
+            using (TestTree tree1 = TestTree.ReadMapped<TestTree>(fileName))
+            {
+                Assert.IsTrue(tree1.IsMapped);
+                Assert.IsFalse(tree1.IsFDA);
+                Assert.AreEqual(tree.Version, tree1.Version);
+                Assert.AreEqual(tree.UserData, tree1.UserData);
+                Assert.AreEqual(tree.NodesCount, tree1.NodesCount);
+                for (int i = 0; i < tree.NodesCount; ++i)
+                {
+                    Assert.AreEqual(tree.GetDepth(i), tree1.GetDepth(i), i.ToString());
+                    Assert.AreEqual(tree.Nodes[i].Id, tree1.Nodes[i].Id, i.ToString());
+                    TestNode n1;
+                    tree1.GetNode(i, (byte*)&n1);
+                    Assert.AreEqual(tree.Nodes[i].Id, n1.Id, i.ToString());
+                }
+                bool isReadOnly = false;
+                try
+                {
+                    tree1.SetDepth(1, 5);
+                }
+                catch (ApplicationException)
+                {
+                    isReadOnly = true;
+                }
+                Assert.IsTrue(isReadOnly);
+            }
+
+            // Modify a copy-on-write tree, the file must not change.
+            using (TestTree tree2 = TestTree.ReadMapped<TestTree>(fileName, true, MappedFileAdvice.Random))
+            {
+                for (int i = 0; i < tree.NodesCount; ++i)
+                {
+                    tree2.Nodes[i].Id = -1;
+                }
+                tree2.SetDepth(1, 5);
+                Assert.AreEqual(-1, tree2.Nodes[tree.NodesCount - 1].Id);
+                Assert.AreEqual(5, tree2.GetDepth(1));
+            }
+
+            using (TestTree tree3 = TestTree.Read<TestTree>(fileName))
+            {
+                for (int i = 0; i < tree.NodesCount; ++i)
+                {
+                    Assert.AreEqual(tree.GetDepth(i), tree3.GetDepth(i), i.ToString());
+                    Assert.AreEqual(tree.Nodes[i].Id, tree3.Nodes[i].Id, i.ToString());
+                }
+            }
+        }
+
         #endregion
 
         #region Benchmarks
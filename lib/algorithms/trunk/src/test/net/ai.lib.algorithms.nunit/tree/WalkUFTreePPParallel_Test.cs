@@ -0,0 +1,319 @@
+/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using System.Runtime.InteropServices;
+using ai.lib.utils;
+using System.IO;
+using System.Reflection;
+
+namespace ai.lib.algorithms.tree.nunit
+{
+    /// <summary>
+    /// Unit tests for WalkUFTreePPParallel.
+    /// </summary>
+    [TestFixture]
+    public unsafe class WalkUFTreePPParallel_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_Walk()
+        {
+            int depthLimit = 5;
+            TestTree tree = CreateTestTree(depthLimit, 4);
+            foreach (int threadsCount in new int[] { 1, 2, 4 })
+            {
+                using (WalkUFTreePPParallel<TestTree, Context> wt = new WalkUFTreePPParallel<TestTree, Context>())
+                {
+                    wt.ThreadsCount = threadsCount;
+                    for (int splitDepth = 0; splitDepth <= depthLimit + 1; ++splitDepth)
+                    {
+                        wt.SplitDepth = splitDepth;
+                        // Root, an inner node, a leaf.
+                        DoWalkTest(wt, tree, 0, depthLimit);
+                        DoWalkTest(wt, tree, 2, depthLimit);
+                        DoWalkTest(wt, tree, tree.NodesCount - 1, depthLimit);
+                    }
+                }
+            }
+        }
+
+        [Test]
+        public void Test_MaxThreadsCount()
+        {
+            int depthLimit = 5;
+            TestTree tree = CreateTestTree(depthLimit, 4);
+            using (WalkUFTreePPParallel<TestTree, Context> wt = new WalkUFTreePPParallel<TestTree, Context> { ThreadsCount = 128 })
+            {
+                Assert.AreEqual(WalkUFTreePPParallel<TestTree, Context>.MaxThreadsCount, wt.ThreadsCount);
+                DoWalkTest(wt, tree, 0, depthLimit);
+            }
+        }
+
+        [Test]
+        public void Test_Exception()
+        {
+            TestTree tree = CreateTestTree(5, 4);
+            using (WalkUFTreePPParallel<TestTree, Context> wt = new WalkUFTreePPParallel<TestTree, Context> { ThreadsCount = 4, SplitDepth = 2 })
+            {
+                wt.OnNodeBegin = (t, s, d) =>
+                                     {
+                                         if (s[d].NodeIdx == t.NodesCount - 10)
+                                         {
+                                             throw new ArgumentException("Test");
+                                         }
+                                     };
+                bool isThrown = false;
+                try
+                {
+                    wt.Walk(tree);
+                }
+                catch (ApplicationException e)
+                {
+                    Assert.IsTrue(e.InnerException is ArgumentException);
+                    isThrown = true;
+                }
+                Assert.IsTrue(isThrown);
+
+                // The walker can be used again.
+                wt.OnNodeBegin = null;
+                int count = 0;
+                int[] workerCounts = new int[wt.ThreadsCount];
+                wt.OnNodeEnd = (t, s, d) => workerCounts[WalkUFTreePPParallel<TestTree, Context>.CurrentWorker]++;
+                wt.OnReduce = (t, w) => count += workerCounts[w];
+                wt.Walk(tree);
+                Assert.AreEqual(tree.NodesCount, count);
+            }
+        }
+
+        [Test]
+        public void Test_FDA()
+        {
+            int depthLimit = 5;
+            TestTree tree = CreateTestTree(depthLimit, 4);
+            string fileName = Path.Combine(_outDir, "fda-tree.dat");
+            tree.Write(fileName);
+            using (TestTree fdaTree = UFTree.ReadFDA<TestTree>(fileName))
+            {
+                Assert.IsTrue(fdaTree.IsFDA);
+                using (WalkUFTreePPParallel<TestTree, Context> wt = new WalkUFTreePPParallel<TestTree, Context> { ThreadsCount = 4, SplitDepth = 2 })
+                {
+                    // The nodes are read from the file, check the depths and that all nodes are walked on the calling thread.
+                    int beginCount = 0;
+                    int endCount = 0;
+                    int reduceCount = 0;
+                    wt.OnNodeBegin = (t, s, d) =>
+                                         {
+                                             Assert.AreEqual(0, WalkUFTreePPParallel<TestTree, Context>.CurrentWorker);
+                                             Assert.AreEqual(tree.GetDepth(s[d].NodeIdx), d);
+                                             Assert.AreEqual(beginCount, s[d].NodeIdx);
+                                             beginCount++;
+                                         };
+                    wt.OnNodeEnd = (t, s, d) =>
+                                       {
+                                           Assert.AreEqual(d == depthLimit ? 0 : 4, s[d].ChildrenCount);
+                                           endCount++;
+                                       };
+                    wt.OnReduce = (t, w) => reduceCount++;
+                    wt.Walk(fdaTree);
+                    Assert.AreEqual(tree.NodesCount, beginCount);
+                    Assert.AreEqual(tree.NodesCount, endCount);
+                    Assert.AreEqual(wt.ThreadsCount, reduceCount);
+                }
+            }
+        }
+
+        #endregion
+
+        #region Benchmarks
+
+        [Test]
+        [Category("Benchmark")]
+        public void Benchmark_Walk()
+        {
+            int depthLimit = 22;
+            TestTree tree = CreateTestTree(depthLimit, 2);
+            for (int threadsCount = 1; threadsCount <= Environment.ProcessorCount; threadsCount *= 2)
+            {
+                using (WalkUFTreePPParallel<TestTree, Context> wt = new WalkUFTreePPParallel<TestTree, Context>())
+                {
+                    wt.ThreadsCount = threadsCount;
+                    // Simulate some work.
+                    wt.OnNodeBegin = (t, s, d) =>
+                                         {
+                                             double v = s[d].NodeIdx;
+                                             for (int i = 0; i < 50; ++i)
+                                             {
+                                                 v = Math.Sqrt(v + i);
+                                             }
+                                             t.Nodes[s[d].NodeIdx].Value = (int)v;
+                                         };
+                    DateTime startTime = DateTime.Now;
+                    wt.Walk(tree);
+                    double time = (DateTime.Now - startTime).TotalSeconds;
+                    Console.WriteLine("Threads {0}, nodes {1:#,#}, {2:0.000} s, {3:#,#} n/s",
+                                      threadsCount, tree.NodesCount, time, tree.NodesCount / time);
+                }
+            }
+        }
+
+        #endregion
+
+        #region Implementation
+
+        class Context : WalkUFTreePPContext
+        {
+            public int Depth;
+        }
+
+        struct TestNode
+        {
+            public byte BeginCallCount;
+            public byte EndCallCount;
+            public int Value;
+            public int SubtreeSize;
+            public int ExpectedSubtreeSize;
+        }
+
+        unsafe class TestTree : UFTree
+        {
+            public TestTree()
+            {
+            }
+
+            public TestTree(Int64 nodesCount)
+                : base(nodesCount, Marshal.SizeOf(typeof(TestNode)))
+            {
+                UnmanagedMemory.SetMemory(_nodesPtr.Ptr, _nodesByteSize, 0);
+                _nodes = (TestNode*)_nodesPtr.Ptr.ToPointer();
+            }
+
+            public TestNode* Nodes
+            {
+                get { return _nodes; }
+            }
+
+            private TestNode* _nodes;
+        }
+
+        TestTree CreateTestTree(int depthLimit, int childCount)
+        {
+            int nodesCount = 0;
+            for (int d = 0, power = 1; d <= depthLimit; ++d, power *= childCount)
+            {
+                nodesCount += power;
+            }
+            TestTree tree = new TestTree(nodesCount);
+            int idx = 0;
+            CreateTestTree(tree, ref idx, 0, depthLimit, childCount);
+            Assert.AreEqual(nodesCount, idx);
+            return tree;
+        }
+
+        int CreateTestTree(TestTree tree, ref int nodeIdx, int curDepth, int depthLimit, int childCount)
+        {
+            int n = nodeIdx++;
+            tree.SetDepth(n, (byte)curDepth);
+            int size = 1;
+            if (curDepth < depthLimit)
+            {
+                for (int c = 0; c < childCount; ++c)
+                {
+                    size += CreateTestTree(tree, ref nodeIdx, curDepth + 1, depthLimit, childCount);
+                }
+            }
+            tree.Nodes[n].ExpectedSubtreeSize = size;
+            return size;
+        }
+
+        /// <summary>
+        /// Walks the tree and checks that each node is processed once, in the right order, and
+        /// that a post-order reduction (subtree size) and per-worker counters give correct results.
+        /// </summary>
+        void DoWalkTest(WalkUFTreePPParallel<TestTree, Context> wt, TestTree tree, Int64 startNode, int depthLimit)
+        {
+            for (Int64 i = 0; i < tree.NodesCount; ++i)
+            {
+                tree.Nodes[i].BeginCallCount = 0;
+                tree.Nodes[i].EndCallCount = 0;
+                tree.Nodes[i].SubtreeSize = 0;
+            }
+            int startDepth = tree.GetDepth(startNode);
+            int[] workerCounts = new int[Math.Max(1, wt.ThreadsCount)];
+            int treeBeginCount = 0;
+            int treeEndCount = 0;
+            int reduceCount = 0;
+            int nodesCount = 0;
+
+            wt.OnTreeBegin = t => treeBeginCount++;
+            wt.OnTreeEnd = t =>
+                               {
+                                   Assert.AreEqual(workerCounts.Length, reduceCount);
+                                   treeEndCount++;
+                               };
+            wt.OnNodeBegin = (t, s, d) =>
+            {
+                Int64 n = s[d].NodeIdx;
+                Assert.AreEqual(t.GetDepth(n), d);
+                Assert.AreEqual(0, t.Nodes[n].BeginCallCount);
+                Assert.AreEqual(0, s[d].ChildrenCount);
+                if (d > startDepth)
+                {
+                    Assert.AreEqual(1, t.Nodes[s[d - 1].NodeIdx].BeginCallCount);
+                    Assert.AreEqual(0, t.Nodes[s[d - 1].NodeIdx].EndCallCount);
+                    Assert.IsTrue(s[d - 1].ChildrenCount >= 1);
+                    s[d].Depth = s[d - 1].Depth + 1;
+                }
+                else
+                {
+                    s[d].Depth = d;
+                }
+                t.Nodes[n].BeginCallCount++;
+                t.Nodes[n].SubtreeSize = 1;
+                workerCounts[WalkUFTreePPParallel<TestTree, Context>.CurrentWorker]++;
+            };
+            wt.OnNodeEnd = (t, s, d) =>
+            {
+                Int64 n = s[d].NodeIdx;
+                Assert.AreEqual(d, s[d].Depth);
+                Assert.AreEqual(1, t.Nodes[n].BeginCallCount);
+                Assert.AreEqual(0, t.Nodes[n].EndCallCount);
+                Assert.AreEqual(d == depthLimit ? 0 : 4, s[d].ChildrenCount);
+                Assert.AreEqual(t.Nodes[n].ExpectedSubtreeSize, t.Nodes[n].SubtreeSize);
+                t.Nodes[n].EndCallCount++;
+                if (d > startDepth)
+                {
+                    t.Nodes[s[d - 1].NodeIdx].SubtreeSize += t.Nodes[n].SubtreeSize;
+                }
+            };
+            wt.OnReduce = (t, w) =>
+                              {
+                                  Assert.AreEqual(reduceCount, w);
+                                  reduceCount++;
+                                  nodesCount += workerCounts[w];
+                              };
+
+            wt.Walk(tree, startNode);
+
+            Assert.AreEqual(1, treeBeginCount);
+            Assert.AreEqual(1, treeEndCount);
+            int expectedCount = tree.Nodes[startNode].ExpectedSubtreeSize;
+            Assert.AreEqual(expectedCount, nodesCount);
+            for (Int64 i = 0; i < tree.NodesCount; ++i)
+            {
+                int expectedCalls = i >= startNode && i < startNode + expectedCount ? 1 : 0;
+                Assert.AreEqual(expectedCalls, tree.Nodes[i].BeginCallCount);
+                Assert.AreEqual(expectedCalls, tree.Nodes[i].EndCallCount);
+            }
+        }
+
+        string _outDir = UTHelper.MakeAndGetTestOutputDir(Assembly.GetExecutingAssembly(), "tree/WalkUFTreePPParallel_Test");
+
+        #endregion
+    }
+}
@@ -0,0 +1,277 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Text;
+using System.Net.Sockets;
+using System.Threading;
+using System.IO;
+
+namespace ai.lib.ipc
+{
+    /// <summary>
+    /// IPC client. Is running in an own thread after a call to Start(). The caller can wait for IPC events 
+    /// via WaitEvent. All incoming events (connect, disconnect, rx message) are queued and can be retrieved 
+    /// via DequeInputEvent(). A message can be send by a call to Send().
+    /// <para>Uses the same protocol as the C++ client, so the server can be written in either language.</para>
+    /// </summary>
+    public class Client
+    {
+        /// <summary>
+        /// Input event.
+        /// </summary>
+        public class Event
+        {
+            public EventKind Kind;
+            public byte[] Message;
+        }
+
+        public Client()
+        {
+        }
+
+        /// <summary>
+        /// Starts IPC. Tries to connect to the server. If connected, can send and receive messages.
+        /// If the server is gone, tries to reconnect. 
+        /// </summary>
+        /// <param name="serverAddress">address of the server (address:port).</param>
+        public void Start(string serverAddress)
+        {
+            lock (_sync)
+            {
+                if (_state != State.Stopped)
+                {
+                    return;
+                }
+                _state = State.Disconnected;
+            }
+            int colonPos = serverAddress.LastIndexOf(':');
+            if (colonPos < 0)
+            {
+                throw new ArgumentException(String.Format("Wrong server address '{0}', expected address:port", serverAddress));
+            }
+            _host = serverAddress.Substring(0, colonPos);
+            _port = int.Parse(serverAddress.Substring(colonPos + 1));
+            _thread = new Thread(ThreadFunc) { IsBackground = true, Name = "ai.lib.ipc.Client" };
+            _thread.Start();
+        }
+
+        /// <summary>
+        /// Closes the connection and stops the background thread.
+        /// No disconnect event will be raised.
+        /// </summary>
+        public void Stop()
+        {
+            TcpClient tcpClient;
+            lock (_sync)
+            {
+                if (_state == State.Stopped)
+                {
+                    return;
+                }
+                _state = State.Stopped;
+                tcpClient = _tcpClient;
+                Monitor.PulseAll(_sync);
+            }
+            if (tcpClient != null)
+            {
+                tcpClient.Close();
+            }
+            _thread.Join();
+            lock (_sync)
+            {
+                _inQueue.Clear();
+            }
+        }
+
+        /// <summary>
+        /// Connection status.
+        /// </summary>
+        public bool IsConnected
+        {
+            get
+            {
+                lock (_sync)
+                {
+                    return _state == State.Connected;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Sends a message if there is a connection, otherwise does nothing, ignores the message
+        /// and returns false.
+        /// </summary>
+        public bool Send(byte[] message)
+        {
+            NetworkStream stream;
+            lock (_sync)
+            {
+                if (_state != State.Connected)
+                {
+                    return false;
+                }
+                stream = _stream;
+            }
+            try
+            {
+                lock (_writeHeader)
+                {
+                    Protocol.WriteMessage(stream, message, _writeHeader);
+                }
+            }
+            catch (IOException)
+            {
+                // The reading thread will reconnect.
+                return false;
+            }
+            catch (ObjectDisposedException)
+            {
+                return false;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Retrieves a queued input event, if available, otherwise returns false.
+        /// </summary>
+        public bool DequeInputEvent(out Event e)
+        {
+            lock (_sync)
+            {
+                if (_inQueue.Count == 0)
+                {
+                    e = null;
+                    return false;
+                }
+                e = _inQueue.Dequeue();
+                return true;
+            }
+        }
+
+        /// <summary>
+        /// Is set when an event is queued.
+        /// </summary>
+        public WaitHandle WaitEvent
+        {
+            get { return _waitEvent; }
+        }
+
+        #region Implementation
+
+        enum State
+        {
+            Stopped,
+            Disconnected,
+            Connected
+        }
+
+        void ThreadFunc()
+        {
+            byte[] header = new byte[Protocol.HeaderLength];
+            for (; ; )
+            {
+                TcpClient tcpClient = new TcpClient { NoDelay = true };
+                lock (_sync)
+                {
+                    if (_state == State.Stopped)
+                    {
+                        return;
+                    }
+                    _tcpClient = tcpClient;
+                }
+                try
+                {
+                    tcpClient.Connect(_host, _port);
+                }
+                catch (SocketException)
+                {
+                    tcpClient.Close();
+                    lock (_sync)
+                    {
+                        // Wait before the next attempt, Stop() interrupts the waiting.
+                        if (_state == State.Stopped || Monitor.Wait(_sync, RECONNECT_PERIOD))
+                        {
+                            return;
+                        }
+                    }
+                    continue;
+                }
+                catch (ObjectDisposedException)
+                {
+                    // Closed by Stop().
+                    return;
+                }
+                lock (_sync)
+                {
+                    if (_state == State.Stopped)
+                    {
+                        tcpClient.Close();
+                        return;
+                    }
+                    _stream = tcpClient.GetStream();
+                    _state = State.Connected;
+                    Enqueue(new Event { Kind = EventKind.Connect });
+                }
+                for (; ; )
+                {
+                    byte[] message = null;
+                    try
+                    {
+                        message = Protocol.ReadMessage(_stream, header);
+                    }
+                    catch (IOException)
+                    {
+                    }
+                    catch (ObjectDisposedException)
+                    {
+                    }
+                    if (message == null)
+                    {
+                        break;
+                    }
+                    lock (_sync)
+                    {
+                        Enqueue(new Event { Kind = EventKind.RxMessage, Message = message });
+                    }
+                }
+                tcpClient.Close();
+                lock (_sync)
+                {
+                    if (_state == State.Stopped)
+                    {
+                        return;
+                    }
+                    _state = State.Disconnected;
+                    _stream = null;
+                    Enqueue(new Event { Kind = EventKind.Disconnect });
+                }
+            }
+        }
+
+        void Enqueue(Event e)
+        {
+            _inQueue.Enqueue(e);
+            _waitEvent.Set();
+        }
+
+        const int RECONNECT_PERIOD = 100;
+
+        /// <summary>
+        /// Protects the state, the socket and the input queue.
+        /// </summary>
+        readonly object _sync = new object();
+        State _state = State.Stopped;
+        string _host;
+        int _port;
+        TcpClient _tcpClient;
+        NetworkStream _stream;
+        Thread _thread;
+        Queue<Event> _inQueue = new Queue<Event>();
+        AutoResetEvent _waitEvent = new AutoResetEvent(false);
+        byte[] _writeHeader = new byte[Protocol.HeaderLength];
+
+        #endregion
+    }
+}
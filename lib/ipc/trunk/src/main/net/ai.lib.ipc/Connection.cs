@@ -0,0 +1,135 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Text;
+using System.Net.Sockets;
+using System.Threading;
+using System.IO;
+
+namespace ai.lib.ipc
+{
+    /// <summary>
+    /// IPC connection for the server side. When a new client connects to the server, the server creates 
+    /// a new connection. 
+    /// </summary>
+    public class Connection
+    {
+        /// <summary>
+        /// Can be used to bind this object to any user data. Is not touched by IPC.
+        /// </summary>
+        public object UserData;
+
+        /// <summary>
+        /// Connection status. When the remote client disappears, the connection object is kept, but it goes permanently 
+        /// in the disconnected state.
+        /// </summary>
+        public bool IsConnected
+        {
+            get
+            {
+                lock (_server.Sync)
+                {
+                    return _isConnected;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Sends a message if there is a connection, otherwise does nothing, ignores the message
+        /// and returns false.
+        /// </summary>
+        public bool Send(byte[] message)
+        {
+            if (!IsConnected)
+            {
+                return false;
+            }
+            try
+            {
+                lock (_writeHeader)
+                {
+                    Protocol.WriteMessage(_stream, message, _writeHeader);
+                }
+            }
+            catch (IOException)
+            {
+                // The reading thread will notify about the disconnection.
+                return false;
+            }
+            catch (ObjectDisposedException)
+            {
+                return false;
+            }
+            return true;
+        }
+
+        #region Implementation
+
+        internal Connection(Server server, Socket socket)
+        {
+            _server = server;
+            _socket = socket;
+            _socket.NoDelay = true;
+            _stream = new NetworkStream(socket, false);
+            _isConnected = true;
+        }
+
+        internal void Start()
+        {
+            _thread = new Thread(ReadThreadFunc) { IsBackground = true, Name = "ai.lib.ipc.Connection" };
+            _thread.Start();
+        }
+
+        /// <summary>
+        /// Closes the socket and waits for the reading thread, no event is raised.
+        /// </summary>
+        internal void Close()
+        {
+            lock (_server.Sync)
+            {
+                _isConnected = false;
+            }
+            _socket.Close();
+            if (_thread != null)
+            {
+                _thread.Join();
+            }
+        }
+
+        void ReadThreadFunc()
+        {
+            byte[] header = new byte[Protocol.HeaderLength];
+            for (;;)
+            {
+                byte[] message = null;
+                try
+                {
+                    message = Protocol.ReadMessage(_stream, header);
+                }
+                catch (IOException)
+                {
+                }
+                catch (ObjectDisposedException)
+                {
+                }
+                if (message == null)
+                {
+                    _server.OnDisconnect(this);
+                    return;
+                }
+                _server.OnMessage(this, message);
+            }
+        }
+
+        internal bool _isConnected;
+        Server _server;
+        Socket _socket;
+        NetworkStream _stream;
+        Thread _thread;
+        byte[] _writeHeader = new byte[Protocol.HeaderLength];
+
+        #endregion
+    }
+}
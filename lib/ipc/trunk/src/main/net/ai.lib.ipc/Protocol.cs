@@ -0,0 +1,87 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Text;
+using System.IO;
+
+namespace ai.lib.ipc
+{
+    /// <summary>
+    /// Kind of an input event of the IPC.
+    /// </summary>
+    public enum EventKind
+    {
+        Connect,
+        Disconnect,
+        RxMessage
+    }
+
+    /// <summary>
+    /// Encapsulates IPC protocol, it is the same as in the C++ library.
+    /// <para>IPC sends first 4-bytes message header. The header contains the length 
+    /// of the message body (not including the header) as UInt32 in big-endian.</para>
+    /// </summary>
+    public static class Protocol
+    {
+        public const int HeaderLength = 4;
+
+        public static void EncodeHeader(int bodyLength, byte[] header)
+        {
+            header[0] = (byte)((bodyLength >> 24) & 0xFF);
+            header[1] = (byte)((bodyLength >> 16) & 0xFF);
+            header[2] = (byte)((bodyLength >> 8) & 0xFF);
+            header[3] = (byte)(bodyLength & 0xFF);
+        }
+
+        public static int DecodeHeader(byte[] header)
+        {
+            return (header[0] << 24) | (header[1] << 16) | (header[2] << 8) | header[3];
+        }
+
+        /// <summary>
+        /// Reads a message, returns null if the stream is closed.
+        /// </summary>
+        internal static byte[] ReadMessage(Stream stream, byte[] header)
+        {
+            if (!ReadExactly(stream, header, HeaderLength))
+            {
+                return null;
+            }
+            int length = DecodeHeader(header);
+            if (length < 0)
+            {
+                throw new ApplicationException(String.Format("Wrong IPC message length {0}", length));
+            }
+            byte[] message = new byte[length];
+            if (!ReadExactly(stream, message, length))
+            {
+                return null;
+            }
+            return message;
+        }
+
+        internal static void WriteMessage(Stream stream, byte[] message, byte[] header)
+        {
+            EncodeHeader(message.Length, header);
+            stream.Write(header, 0, HeaderLength);
+            stream.Write(message, 0, message.Length);
+            stream.Flush();
+        }
+
+        static bool ReadExactly(Stream stream, byte[] buffer, int count)
+        {
+            for (int offset = 0; offset < count; )
+            {
+                int read = stream.Read(buffer, offset, count - offset);
+                if (read <= 0)
+                {
+                    return false;
+                }
+                offset += read;
+            }
+            return true;
+        }
+    }
+}
@@ -13,41 +13,202 @@ using System.Diagnostics;
 namespace ai.lib.ipc
 {
     /// <summary>
-    /// Todo: is not ready yet, just started.
+    /// IPC server. Is running in own threads after a call to Start(). The caller can wait for IPC events 
+    /// via WaitEvent. All incoming events (connect, disconnect, rx message) are queued and can be retrieved 
+    /// via DequeInputEvent(). Use Connection object to send messages.
+    /// <para>Uses the same protocol as the C++ server, so the clients can be written in either language.</para>
     /// </summary>
     public class Server
     {
         /// <summary>
-        /// Creates a server on the specified local interface.
+        /// Input event.
         /// </summary>
-        /// <param name="address">port</param>
-        public Server(string address)
+        public class Event
         {
+            public Connection Connection;
+            public EventKind Kind;
+            public byte[] Message;
         }
 
+        public Server()
+        {
+        }
+
+        /// <summary>
+        /// Starts IPC. Begins accepting client connections on all interfaces.
+        /// </summary>
+        /// <param name="address">port, 0 to choose a free port (see Port).</param>
         public void Start(string address)
         {
-            IPAddress ipAddress = IPAddress.Any;
-            int port = int.Parse(address);
-            _listener = new TcpListener(ipAddress, port);
+            lock (Sync)
+            {
+                if (_isStarted)
+                {
+                    return;
+                }
+                _isStarted = true;
+            }
+            _listener = new TcpListener(IPAddress.Any, int.Parse(address));
+            _listener.Start();
+            Port = ((IPEndPoint)_listener.LocalEndpoint).Port;
+            _thread = new Thread(AcceptThreadFunc) { IsBackground = true, Name = "ai.lib.ipc.Server" };
+            _thread.Start();
+        }
+
+        /// <summary>
+        /// Stops the threads, clears queues and removes all connections. 
+        /// No disconnect events will be raised for active connections. 
+        /// </summary>
+        public void Stop()
+        {
+            Connection[] connections;
+            lock (Sync)
+            {
+                if (!_isStarted)
+                {
+                    return;
+                }
+                _isStarted = false;
+                connections = _connections.ToArray();
+            }
+            _listener.Stop();
+            _thread.Join();
+            foreach (Connection c in connections)
+            {
+                c.Close();
+            }
+            lock (Sync)
+            {
+                _connections.Clear();
+                _inQueue.Clear();
+            }
+        }
+
+        public bool IsStarted
+        {
+            get
+            {
+                lock (Sync)
+                {
+                    return _isStarted;
+                }
+            }
+        }
+
+        /// <summary>
+        /// The port the server is listening on.
+        /// </summary>
+        public int Port
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Retrieves a queued input event, if available, otherwise returns false.
+        /// </summary>
+        public bool DequeInputEvent(out Event e)
+        {
+            lock (Sync)
+            {
+                if (_inQueue.Count == 0)
+                {
+                    e = null;
+                    return false;
+                }
+                e = _inQueue.Dequeue();
+                return true;
+            }
+        }
+
+        /// <summary>
+        /// Is set when an event is queued.
+        /// </summary>
+        public WaitHandle WaitEvent
+        {
+            get { return _waitEvent; }
+        }
 
-            //_thread = new Thread(ThreadFunc);
-            //_thread.Start();
+        #region Implementation
 
-            IAsyncResult ar = _listener.BeginAcceptSocket(new AsyncCallback(DoAcceptSocketCallback), null);
+        void AcceptThreadFunc()
+        {
+            for (; ; )
+            {
+                Socket socket;
+                try
+                {
+                    socket = _listener.AcceptSocket();
+                }
+                catch (SocketException)
+                {
+                    // The listener is stopped.
+                    return;
+                }
+                catch (ObjectDisposedException)
+                {
+                    return;
+                }
+                catch (InvalidOperationException)
+                {
+                    // The listener is stopped before the call.
+                    return;
+                }
+                Connection connection = new Connection(this, socket);
+                lock (Sync)
+                {
+                    if (!_isStarted)
+                    {
+                        socket.Close();
+                        return;
+                    }
+                    _connections.Add(connection);
+                    Enqueue(new Event { Connection = connection, Kind = EventKind.Connect });
+                }
+                connection.Start();
+            }
         }
 
-        void ThreadFunc(object param)
+        internal void OnMessage(Connection connection, byte[] message)
         {
+            lock (Sync)
+            {
+                Enqueue(new Event { Connection = connection, Kind = EventKind.RxMessage, Message = message });
+            }
         }
 
-        // Process the client connection.
-        public void DoAcceptSocketCallback(IAsyncResult ar)
+        internal void OnDisconnect(Connection connection)
         {
-            Socket clientSocket = _listener.EndAcceptSocket(ar);
+            lock (Sync)
+            {
+                if (!connection._isConnected)
+                {
+                    // Closed by Stop().
+                    return;
+                }
+                connection._isConnected = false;
+                _connections.Remove(connection);
+                Enqueue(new Event { Connection = connection, Kind = EventKind.Disconnect });
+            }
         }
 
-        private TcpListener _listener;
-        private Thread _thread;
+        void Enqueue(Event e)
+        {
+            _inQueue.Enqueue(e);
+            _waitEvent.Set();
+        }
+
+        /// <summary>
+        /// Protects the state, the connections and the input queue.
+        /// </summary>
+        internal readonly object Sync = new object();
+        bool _isStarted;
+        TcpListener _listener;
+        Thread _thread;
+        List<Connection> _connections = new List<Connection>();
+        Queue<Event> _inQueue = new Queue<Event>();
+        AutoResetEvent _waitEvent = new AutoResetEvent(false);
+
+        #endregion
     }
 }
@@ -2,63 +2,18 @@
 //
 
 #include "stdafx.h"
+#include <cstddef>
 #include "ai.lib.kmeans.kml.h"
 #include "KMlocal.h"			// k-means algorithms
+#include "KMperf.h"			// stage counters
 
-extern "C"
-{
-
-#pragma pack (push)
-#pragma pack (1) 
-struct Parameters
-{
-	//
-	// Input
-	//
-
-	// number of centers
-	int	k;      
-
-	// dimension
-	int	dim;
-
-	// Point coordinates for all dimensions. For example, for N points and dim = 2:
-	// (p0,0 p0,1) (p1,0 p1,1) ... (pN-1,0 pN-1,1)
-	double * points; 
-
-	// Number of points
-	int	n; 
-
-
-	// Max stages to run (e.g. 100 0 0 0).
-	double term_st_a, term_st_b, term_st_c, term_st_d;	
-	
-	double term_minConsecRDL;
-	
-	double  term_minAccumRDL;
-	
-	int term_maxRunStage;
-
-	double term_initProbAccept; 
-
-	int term_tempRunLength;
+/// Size of Parameters of version 1 (without lloydEngine).
+static const int PARAMETERS_V1_SIZE = (int)offsetof(Parameters, lloydEngine);
 
-	double term_tempReducFact;
+static_assert(KML_STAGE_LLOYD == LLOYD && KML_STAGE_SWAP == SWAP && KML_STAGE_RANDOM == RANDOM
+	&& KML_STAGE_LLOYD_BOUNDS == LLOYD_BOUNDS && KML_STAGES_COUNT == N_KM_ALGS, "KML_STAGE_* must match KMalg");
 
-	/// Rng seed, must be a positive number.
-	int seed;
-
-	//
-	// Output
-	//
-
-    // Centers coordinates for all dimensions. Layout as in Parameters.
-	double * centers; 
-};
-#pragma pack (pop)
-
-/// Runs a Hybrid kml algorithm.
-AILIBKMEANSKML_API int KML_Hybrid(Parameters * params)
+static int RunHybrid(Parameters * params, KMlloydEngine lloydEngine)
 {
 	kmIdum = params->seed;
 	// Make negate to initialize.
@@ -67,18 +22,19 @@ AILIBKMEANSKML_API int KML_Hybrid(Parameters * params)
 
 
 	//  Termination conditions
-	KMterm	term(params->term_st_a, 
-		params->term_st_b, 
-		params->term_st_c, 
+	KMterm	term(params->term_st_a,
+		params->term_st_b,
+		params->term_st_c,
 		params->term_st_d,
-		params->term_minConsecRDL,	
-		params->term_minAccumRDL,	
-		params->term_maxRunStage,	
+		params->term_minConsecRDL,
+		params->term_minAccumRDL,
+		params->term_maxRunStage,
 		params->term_initProbAccept,
-		params->term_tempRunLength,	
+		params->term_tempRunLength,
 		params->term_tempReducFact);
 
 	//term.setAbsMaxTotStage(params->stages);		// set number of stages
+	term.setLloydEngine(lloydEngine);
 
 	KMdata dataPts(params->dim, params->n);	// allocate data storage
 
@@ -111,4 +67,61 @@ AILIBKMEANSKML_API int KML_Hybrid(Parameters * params)
 	return 1;
 }
 
-}
\ No newline at end of file
+extern "C"
+{
+
+AILIBKMEANSKML_API int KML_GetVersion()
+{
+	return KML_VERSION;
+}
+
+AILIBKMEANSKML_API int KML_Hybrid(Parameters * params)
+{
+	return RunHybrid(params, KM_LLOYD_AUTO);
+}
+
+AILIBKMEANSKML_API int KML_HybridEx(Parameters * params, int paramsSize, int version)
+{
+	if(version < 1 || version > KML_VERSION || paramsSize < PARAMETERS_V1_SIZE)
+	{
+		return 0;
+	}
+	KMlloydEngine lloydEngine = KM_LLOYD_AUTO;
+	if(version >= 2 && paramsSize >= (int)sizeof(Parameters))
+	{
+		if(params->lloydEngine < 0 || params->lloydEngine >= N_KM_LLOYD_ENGINES)
+		{
+			return 0;
+		}
+		lloydEngine = (KMlloydEngine)params->lloydEngine;
+	}
+	return RunHybrid(params, lloydEngine);
+}
+
+AILIBKMEANSKML_API int KML_PerfCounters_Enable(int enable)
+{
+	return kmPerfEnable(enable != 0) ? 1 : 0;
+}
+
+AILIBKMEANSKML_API void KML_PerfCounters_Reset()
+{
+	kmPerfReset();
+}
+
+AILIBKMEANSKML_API int KML_PerfCounters_Get(int method, StagePerfCounters * counters)
+{
+	if(method < 0 || method >= N_KM_ALGS)
+	{
+		return 0;
+	}
+	KMperfCounters c;
+	kmPerfGet((KMalg)method, c);
+	counters->count = c.count;
+	counters->timeNs = c.timeNs;
+	counters->cycles = c.cycles;
+	counters->instructions = c.instructions;
+	counters->llcMisses = c.llcMisses;
+	return 1;
+}
+
+}
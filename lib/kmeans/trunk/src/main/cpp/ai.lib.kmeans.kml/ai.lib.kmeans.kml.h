@@ -1,22 +1,145 @@
-// The following ifdef block is the standard way of creating macros which make exporting 
-// from a DLL simpler. All files within this DLL are compiled with the AILIBKMEANSKML_EXPORTS
-// symbol defined on the command line. this symbol should not be defined on any project
-// that uses this DLL. This way any other project whose source files include this file see 
-// AILIBKMEANSKML_API functions as being imported from a DLL, whereas this DLL sees symbols
-// defined with this macro as being exported.
-#ifdef AILIBKMEANSKML_EXPORTS
-#define AILIBKMEANSKML_API __declspec(dllexport)
+// C interface of the KML library (ai.lib.kmeans.kml.dll on Windows,
+// libai.lib.kmeans.kml.so on Linux). Used by ai.lib.kmeans.Kml (C#).
+//
+// All files within this library are compiled with the AILIBKMEANSKML_EXPORTS
+// symbol defined. This symbol should not be defined on any project
+// that uses this library. This way any other project whose source files include
+// this file see AILIBKMEANSKML_API functions as being imported, whereas the library
+// sees symbols defined with this macro as being exported.
+
+#ifndef AI_LIB_KMEANS_KML_H
+#define AI_LIB_KMEANS_KML_H
+
+#if defined(_WIN32)
+	#ifdef AILIBKMEANSKML_EXPORTS
+		#define AILIBKMEANSKML_API __declspec(dllexport)
+	#else
+		#define AILIBKMEANSKML_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AILIBKMEANSKML_API __attribute__((visibility("default")))
 #else
-#define AILIBKMEANSKML_API __declspec(dllimport)
+	#define AILIBKMEANSKML_API
 #endif
 
-// This class is exported from the ai.lib.kmeans.kml.dll
-class AILIBKMEANSKML_API Cailibkmeanskml {
-public:
-	Cailibkmeanskml(void);
-	// TODO: add your methods here.
+/// Current version of the interface, returned by KML_GetVersion().
+/// Version 1: Parameters as used by KML_Hybrid().
+/// Version 2: adds Parameters::lloydEngine.
+/// Version 3: adds the performance counters of the stages (KML_PerfCounters_*()).
+#define KML_VERSION 3
+
+/// Methods of the stages for KML_PerfCounters_Get() (values of KMalg, see KMeans.h).
+#define KML_STAGE_LLOYD 0
+#define KML_STAGE_SWAP 1
+#define KML_STAGE_RANDOM 4
+#define KML_STAGE_LLOYD_BOUNDS 5
+#define KML_STAGES_COUNT 6
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma pack (push)
+#pragma pack (1)
+/// Parameters of the algorithm. The layout must match ai.lib.kmeans.Kml.Parameters (C#).
+/// New fields are only appended, so a caller compiled against an older version
+/// passes a shorter struct to KML_HybridEx().
+struct Parameters
+{
+	//
+	// Input
+	//
+
+	// number of centers
+	int	k;
+
+	// dimension
+	int	dim;
+
+	// Point coordinates for all dimensions. For example, for N points and dim = 2:
+	// (p0,0 p0,1) (p1,0 p1,1) ... (pN-1,0 pN-1,1)
+	double * points;
+
+	// Number of points
+	int	n;
+
+
+	// Max stages to run (e.g. 100 0 0 0).
+	double term_st_a, term_st_b, term_st_c, term_st_d;
+
+	double term_minConsecRDL;
+
+	double  term_minAccumRDL;
+
+	int term_maxRunStage;
+
+	double term_initProbAccept;
+
+	int term_tempRunLength;
+
+	double term_tempReducFact;
+
+	/// Rng seed, must be a positive number.
+	int seed;
+
+	//
+	// Output
+	//
+
+    // Centers coordinates for all dimensions. Layout as in Parameters.
+	double * centers;
+
+	//
+	// Input, version 2
+	//
+
+	/// Engine for Lloyd's stages: 0 - auto, 1 - kc-tree filtering, 2 - bounds (see KMterm.h).
+	int lloydEngine;
+};
+#pragma pack (pop)
+
+/// Returns KML_VERSION of the library.
+AILIBKMEANSKML_API int KML_GetVersion();
+
+/// Runs a Hybrid kml algorithm. Parameters must be of version 1 (the fields
+/// of later versions are not read).
+AILIBKMEANSKML_API int KML_Hybrid(struct Parameters * params);
+
+/// Runs a Hybrid kml algorithm.
+/// paramsSize: sizeof(Parameters) of the caller.
+/// version: KML_VERSION of the caller.
+/// Fields not covered by paramsSize take default values.
+/// Returns 1 on success, 0 if the size or version is not supported.
+AILIBKMEANSKML_API int KML_HybridEx(struct Parameters * params, int paramsSize, int version);
+
+/// Performance counters of the stages of a method, summed over all runs since KML_PerfCounters_Reset().
+/// The layout must match ai.lib.kmeans.Kml.StagePerfCounters (C#).
+struct StagePerfCounters
+{
+	// number of stages
+	unsigned long long count;
+	// time, ns
+	unsigned long long timeNs;
+	// Hardware counters of the calling thread (Linux perf_event_open()), 0 if not available.
+	unsigned long long cycles;
+	unsigned long long instructions;
+	// last level cache misses
+	unsigned long long llcMisses;
 };
 
-extern AILIBKMEANSKML_API int nailibkmeanskml;
+/// Enables (enable != 0) or disables the performance counters of the stages (disabled by default).
+/// Returns 1 if the hardware counters are available, otherwise only the stages and the time are counted.
+AILIBKMEANSKML_API int KML_PerfCounters_Enable(int enable);
+
+/// Clears the performance counters.
+AILIBKMEANSKML_API void KML_PerfCounters_Reset();
 
-AILIBKMEANSKML_API int fnailibkmeanskml(void);
+/// Gets the counters of the stages of a method (KML_STAGE_*). Returns 0 if the method is not valid.
+AILIBKMEANSKML_API int KML_PerfCounters_Get(int method, struct StagePerfCounters * counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,423 @@
+//----------------------------------------------------------------------
+//	File:           KMbounds.cpp
+//	Description:    Exact Lloyd's assignment by triangle-inequality
+//			bounds (Elkan / Yinyang)
+//----------------------------------------------------------------------
+// This file is an extension of KMlocal and is distributed under the
+// same terms.  See the file Copyright.txt in the main directory.
+//----------------------------------------------------------------------
+
+#include <cmath>				// sqrt
+#include "KMbounds.h"				// KMbounds includes
+#include "KMfilterCenters.h"			// centers
+
+//----------------------------------------------------------------------
+//  Local utilities
+//	ptDist		Euclidean (not squared) distance.  The bounds are
+//			kept as distances, since the triangle inequality
+//			does not hold for squared distances.
+//----------------------------------------------------------------------
+
+static inline double ptDist(		// distance between points
+    int			dim,			// dimension
+    const KMcoord*	p,			// the points
+    const KMcoord*	q)
+{
+    double sum = 0;
+    for (int d = 0; d < dim; d++) {
+	double diff = p[d] - q[d];
+	sum += diff * diff;
+    }
+    return sqrt(sum);
+}
+
+//----------------------------------------------------------------------
+//  Constructor and destructor
+//	The center dependent arrays are allocated by the first call of
+//	assignPts(), when the number of centers is known.
+//----------------------------------------------------------------------
+
+KMbounds::KMbounds(KMdataArray pa, int n, int dd)
+    : dim(dd), nPts(n), kCtrs(0), nGroups(0), pts(pa)
+{
+    ptSqs	= new double[nPts];
+    assign	= new KMctrIdx[nPts];
+    upper	= new double[nPts];
+    for (int i = 0; i < nPts; i++) {		// precompute (p.p)
+	double sq = 0;
+	for (int d = 0; d < dim; d++) {
+	    sq += pts[i][d] * pts[i][d];
+	}
+	ptSqs[i] = sq;
+    }
+    lower	= NULL;
+    ctrGroup	= NULL;
+    groupStart	= NULL;
+    grpCtrs	= NULL;
+    prevCtrs	= NULL;
+    drift	= NULL;
+    groupDrift	= NULL;
+    distCount	= 0;
+}
+
+KMbounds::~KMbounds()
+{
+    dealloc();
+    delete [] ptSqs;
+    delete [] assign;
+    delete [] upper;
+}
+
+void KMbounds::alloc(int k)		// allocate center dependent data
+{
+    kCtrs	= k;
+    nGroups	= (k <= KM_BOUNDS_ELKAN_MAX_K) ? k :
+		  (k + KM_BOUNDS_CTRS_PER_GROUP - 1) / KM_BOUNDS_CTRS_PER_GROUP;
+    lower	= new double[(size_t)nPts * nGroups];
+    ctrGroup	= new int[kCtrs];
+    groupStart	= new int[nGroups + 1];
+    grpCtrs	= new KMctrIdx[kCtrs];
+    prevCtrs	= kmAllocPts(kCtrs, dim);
+    drift	= new double[kCtrs];
+    groupDrift	= new double[nGroups];
+}
+
+void KMbounds::dealloc()		// deallocate center dependent data
+{
+    if (kCtrs == 0) return;			// nothing allocated
+    delete [] lower;
+    delete [] ctrGroup;
+    delete [] groupStart;
+    delete [] grpCtrs;
+    kmDeallocPts(prevCtrs);
+    delete [] drift;
+    delete [] groupDrift;
+    kCtrs = 0;
+    nGroups = 0;
+}
+
+//----------------------------------------------------------------------
+//  makeGroups - partition the centers into groups
+//	With one center per group (Elkan) this is trivial.  Otherwise
+//	the centers are clustered by a few iterations of Lloyd's
+//	algorithm on the centers themselves (as in Yinyang k-means).
+//	The seeds are taken at regular intervals, so no random numbers
+//	are consumed and the random sequence of the caller is the same
+//	as with the filtering engine.  The quality of the grouping only
+//	affects the speed, not the result.
+//----------------------------------------------------------------------
+
+void KMbounds::makeGroups(KMcenterArray ctrs)
+{
+    int j, g;
+    if (nGroups == kCtrs) {			// one center per group
+	for (j = 0; j < kCtrs; j++) ctrGroup[j] = j;
+    }
+    else {
+	KMpointArray gCtrs = kmAllocPts(nGroups, dim);
+	int* gCount = new int[nGroups];
+	for (g = 0; g < nGroups; g++) {		// regularly spaced seeds
+	    kmCopyPt(dim, ctrs[(long)g * kCtrs / nGroups], gCtrs[g]);
+	}
+	for (int iter = 0; iter < 5; iter++) {
+	    for (j = 0; j < kCtrs; j++) {	// closest group center
+		double minDist = KM_HUGE;
+		for (g = 0; g < nGroups; g++) {
+		    double dist = ptDist(dim, ctrs[j], gCtrs[g]);
+		    if (dist < minDist) {
+			minDist = dist;
+			ctrGroup[j] = g;
+		    }
+		}
+	    }
+	    for (g = 0; g < nGroups; g++) {	// move to centroids
+		gCount[g] = 0;
+	    }
+	    for (j = 0; j < kCtrs; j++) {
+		g = ctrGroup[j];
+		if (gCount[g]++ == 0) {
+		    kmCopyPt(dim, ctrs[j], gCtrs[g]);
+		}
+		else {
+		    for (int d = 0; d < dim; d++) gCtrs[g][d] += ctrs[j][d];
+		}
+	    }
+	    for (g = 0; g < nGroups; g++) {
+		if (gCount[g] <= 1) continue;	// empty or single center
+		for (int d = 0; d < dim; d++) gCtrs[g][d] /= gCount[g];
+	    }
+	}
+	delete [] gCount;
+	kmDeallocPts(gCtrs);
+    }
+						// order centers by group
+    for (g = 0; g <= nGroups; g++) groupStart[g] = 0;
+    for (j = 0; j < kCtrs; j++) groupStart[ctrGroup[j] + 1]++;
+    for (g = 0; g < nGroups; g++) groupStart[g + 1] += groupStart[g];
+    int* pos = kmAllocCopy(nGroups, groupStart);
+    for (j = 0; j < kCtrs; j++) grpCtrs[pos[ctrGroup[j]]++] = j;
+    delete [] pos;
+}
+
+//----------------------------------------------------------------------
+//  initBounds - assign points without valid bounds
+//	Computes all distances.  The lower bound of a group is the
+//	minimal distance to its centers, except the assigned one.
+//----------------------------------------------------------------------
+
+void KMbounds::initBounds(KMcenterArray ctrs)
+{
+    int i;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (i = 0; i < nPts; i++) {
+	KMpoint p = pts[i];
+	double* lb = lower + (size_t)i * nGroups;
+	KMctrIdx best = 0;
+	double bestD = KM_HUGE;
+	double bestMin2 = KM_HUGE;
+	int bestGroup = 0;
+	for (int g = 0; g < nGroups; g++) {
+	    double min1 = KM_HUGE, min2 = KM_HUGE;
+	    KMctrIdx idx1 = -1;
+	    for (int c = groupStart[g]; c < groupStart[g + 1]; c++) {
+		double dist = ptDist(dim, p, ctrs[grpCtrs[c]]);
+		if (dist < min1) {
+		    min2 = min1;
+		    min1 = dist;
+		    idx1 = grpCtrs[c];
+		}
+		else if (dist < min2) {
+		    min2 = dist;
+		}
+	    }
+	    lb[g] = min1;
+	    if (min1 < bestD) {
+		bestD = min1;
+		best = idx1;
+		bestGroup = g;
+		bestMin2 = min2;
+	    }
+	}
+	lb[bestGroup] = bestMin2;		// exclude assigned center
+	assign[i] = best;
+	upper[i] = bestD;
+    }
+    distCount = (double)nPts * kCtrs;
+}
+
+//----------------------------------------------------------------------
+//  updateBounds - assign points using the bounds
+//	First the bounds are loosened by the center drifts.  Then each
+//	point goes through the following filters:
+//
+//	global:	upper <= min_g lower[g]: the center is unchanged.
+//	tight:	the same test with upper tightened to the exact
+//		distance to the assigned center.
+//	group:	only groups with lower[g] < upper are scanned, the
+//		scanned groups get exact lower bounds.
+//
+//	If the point changes its center and the group of the old center
+//	was not scanned, the (exact) distance to the old center is
+//	included in that group's lower bound.
+//----------------------------------------------------------------------
+
+void KMbounds::updateBounds(KMcenterArray ctrs)
+{
+    int i, j, g;
+    for (g = 0; g < nGroups; g++) {		// compute drifts
+	groupDrift[g] = 0;
+    }
+    for (j = 0; j < kCtrs; j++) {
+	drift[j] = ptDist(dim, prevCtrs[j], ctrs[j]);
+	if (drift[j] > groupDrift[ctrGroup[j]]) {
+	    groupDrift[ctrGroup[j]] = drift[j];
+	}
+    }
+
+    double count = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 256) reduction(+:count)
+#endif
+    for (i = 0; i < nPts; i++) {
+	KMpoint p = pts[i];
+	double* lb = lower + (size_t)i * nGroups;
+	KMctrIdx a = assign[i];
+	double ub = upper[i] + drift[a];
+	double minLb = KM_HUGE;
+	for (int g = 0; g < nGroups; g++) {	// loosen lower bounds
+	    lb[g] -= groupDrift[g];
+	    if (lb[g] < minLb) minLb = lb[g];
+	}
+	if (ub <= minLb) {			// global filter
+	    upper[i] = ub;
+	    continue;
+	}
+	ub = ptDist(dim, p, ctrs[a]);		// tighten upper bound
+	count += 1;
+	if (ub <= minLb) {
+	    upper[i] = ub;
+	    continue;
+	}
+	KMctrIdx best = a;
+	double bestD = ub;
+	double bestMin2 = KM_HUGE;
+	int bestGroup = -1;
+	int aGroup = ctrGroup[a];
+	bool aGroupScanned = false;
+	for (int g = 0; g < nGroups; g++) {	// group filter
+	    if (lb[g] >= bestD) continue;
+	    double min1 = KM_HUGE, min2 = KM_HUGE;
+	    KMctrIdx idx1 = -1;
+	    for (int c = groupStart[g]; c < groupStart[g + 1]; c++) {
+		double dist = ptDist(dim, p, ctrs[grpCtrs[c]]);
+		if (dist < min1) {
+		    min2 = min1;
+		    min1 = dist;
+		    idx1 = grpCtrs[c];
+		}
+		else if (dist < min2) {
+		    min2 = dist;
+		}
+	    }
+	    count += groupStart[g + 1] - groupStart[g];
+	    if (g == aGroup) aGroupScanned = true;
+	    lb[g] = min1;
+	    if (min1 < bestD || idx1 == best) {	// new (or same) closest
+		bestD = min1;
+		best = idx1;
+		bestGroup = g;
+		bestMin2 = min2;
+	    }
+	}
+	if (bestGroup >= 0) {			// exclude assigned center
+	    lb[bestGroup] = bestMin2;
+	}
+	if (best != a && !aGroupScanned && ub < lb[aGroup]) {
+	    lb[aGroup] = ub;			// old center is now a rival
+	}
+	assign[i] = best;
+	upper[i] = bestD;
+    }
+    distCount = count;
+}
+
+//----------------------------------------------------------------------
+//  assignPts - assign all points to their closest centers
+//	If the number of centers has changed, everything is
+//	reinitialized.  Otherwise the bounds from the previous call are
+//	reused.
+//----------------------------------------------------------------------
+
+void KMbounds::assignPts(KMcenterArray ctrs, int k)
+{
+    if (k != kCtrs) {				// new center set
+	dealloc();
+	alloc(k);
+	makeGroups(ctrs);
+	initBounds(ctrs);
+    }
+    else {
+	updateBounds(ctrs);
+    }
+    kmCopyPts(kCtrs, dim, ctrs, prevCtrs);	// bounds refer to these
+}
+
+//----------------------------------------------------------------------
+//  getNeighbors - compute sums, sums of squares and weights
+//	Computes the same quantities as KCtree::getNeighbors().  The
+//	points are summed in KM_BOUNDS_BLOCKS contiguous blocks in
+//	parallel and the block results are added in block order.
+//----------------------------------------------------------------------
+
+void KMbounds::getNeighbors(KMfilterCenters& ctrs)
+{
+    int k = ctrs.getK();
+    assignPts(ctrs.getCtrPts(), k);
+
+    KMpointArray sums	= ctrs.getSums(false);
+    double* sumSqs	= ctrs.getSumSqs(false);
+    int* weights	= ctrs.getWeights(false);
+
+    int nBlocks = nPts < KM_BOUNDS_BLOCKS ? nPts : KM_BOUNDS_BLOCKS;
+    size_t sumSize = (size_t)k * dim;
+    double* bSums = new double[nBlocks * sumSize + 1];
+    double* bSqs = new double[(size_t)nBlocks * k + 1];
+    int* bWeights = new int[(size_t)nBlocks * k + 1];
+    int b, j, d;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (b = 0; b < nBlocks; b++) {
+	double* s = bSums + b * sumSize;
+	double* sq = bSqs + (size_t)b * k;
+	int* w = bWeights + (size_t)b * k;
+	for (size_t x = 0; x < sumSize; x++) s[x] = 0;
+	for (int c = 0; c < k; c++) {
+	    sq[c] = 0;
+	    w[c] = 0;
+	}
+	int end = (int)((long long)(b + 1) * nPts / nBlocks);
+	for (int i = (int)((long long)b * nPts / nBlocks); i < end; i++) {
+	    int c = assign[i];
+	    double* sc = s + (size_t)c * dim;
+	    for (int dd = 0; dd < dim; dd++) sc[dd] += pts[i][dd];
+	    sq[c] += ptSqs[i];
+	    w[c]++;
+	}
+    }
+    for (j = 0; j < k; j++) {			// add blocks in order
+	sumSqs[j] = 0;
+	weights[j] = 0;
+	for (d = 0; d < dim; d++) sums[j][d] = 0;
+	for (b = 0; b < nBlocks; b++) {
+	    double* sc = bSums + b * sumSize + (size_t)j * dim;
+	    for (d = 0; d < dim; d++) sums[j][d] += sc[d];
+	    sumSqs[j] += bSqs[(size_t)b * k + j];
+	    weights[j] += bWeights[(size_t)b * k + j];
+	}
+    }
+    delete [] bSums;
+    delete [] bSqs;
+    delete [] bWeights;
+}
+
+//----------------------------------------------------------------------
+//  getAssignments - get closest center and squared distance per point
+//----------------------------------------------------------------------
+
+void KMbounds::getAssignments(
+    KMfilterCenters&	ctrs,			// the current centers
+    KMctrIdxArray	closeCtr,		// closest center per point
+    double*		sqDist)			// sq'd distance to center
+{
+    assignPts(ctrs.getCtrPts(), ctrs.getK());
+    KMcenterArray ctrPts = ctrs.getCtrPts();
+    for (int i = 0; i < nPts; i++) {
+	closeCtr[i] = assign[i];
+	sqDist[i] = kmDist(dim, pts[i], ctrPts[assign[i]]);
+    }
+}
+
+//----------------------------------------------------------------------
+//  kmSelectLloydAlg - select the engine for Lloyd's stages
+//----------------------------------------------------------------------
+
+KMalg kmSelectLloydAlg(
+    KMlloydEngine	engine,			// requested engine
+    int			dim,			// dimension
+    int			n,			// number of points
+    int			k)			// number of centers
+{
+    switch (engine) {
+    case KM_LLOYD_FILTER:
+	return LLOYD;
+    case KM_LLOYD_BOUNDS:
+	return LLOYD_BOUNDS;
+    default:
+	return (dim >= KM_BOUNDS_MIN_DIM && n >= KM_BOUNDS_MIN_PTS && k > 1) ?
+		LLOYD_BOUNDS : LLOYD;
+    }
+}
@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------
+//	File:           KMbounds.h
+//	Description:    Exact Lloyd's assignment by triangle-inequality
+//			bounds (Elkan / Yinyang)
+//----------------------------------------------------------------------
+// This file is an extension of KMlocal and is distributed under the
+// same terms.  See the file Copyright.txt in the main directory.
+//----------------------------------------------------------------------
+
+#ifndef KM_BOUNDS_H
+#define KM_BOUNDS_H
+
+#include "KMeans.h"				// kmeans includes
+
+class KMfilterCenters;				// see KMfilterCenters.h
+
+//----------------------------------------------------------------------
+//  KMbounds - bound-based assignment of points to centers
+//	This is an alternative to the filtering algorithm of the kc-tree
+//	(KCtree::getNeighbors).  The kc-tree prunes candidates by
+//	bounding boxes, which works very well in low dimensions but
+//	degrades quickly as the dimension grows, since almost every
+//	box then intersects several Voronoi cells.
+//
+//	This class instead keeps for each data point an upper bound on
+//	the distance to its assigned center and lower bounds on the
+//	distances to the other centers.  The centers are partitioned
+//	into groups and one lower bound is stored per (point, group)
+//	pair.  With one center per group this is the algorithm of
+//	Elkan, with about k/10 groups it is the Yinyang k-means of Ding
+//	et al.  When the centers move, the bounds are updated by the
+//	distance each center moved (its drift):
+//
+//	    upper[i]    += drift[assign[i]]
+//	    lower[i][g] -= max { drift[j] : j in group g }
+//
+//	A point whose upper bound does not exceed all of its lower
+//	bounds keeps its center without any distance computations.
+//	Otherwise the upper bound is tightened and only the groups whose
+//	lower bound is below it are scanned.
+//
+//	The bounds remain valid for any movement of the centers, not
+//	only for a Lloyd's step.  Therefore the object can serve
+//	arbitrary center sets (swaps, restored solutions, random
+//	centers), it just saves less work if the centers jump far.  The
+//	result is exact: every point is assigned to its closest center.
+//
+//	The assignment pass runs in parallel over the points (OpenMP).
+//	Sums are accumulated in a fixed number of point blocks, which
+//	are added in block order, so the result does not depend on the
+//	number of threads.
+//
+//	The object is owned by KMdata (see KMdata::getBounds()) and is
+//	destroyed when the point set is modified.
+//----------------------------------------------------------------------
+
+const int KM_BOUNDS_ELKAN_MAX_K	= 32;	// up to this k use one ctr/group
+const int KM_BOUNDS_CTRS_PER_GROUP = 10; // ctrs per group for larger k
+const int KM_BOUNDS_MIN_DIM	= 5;	// auto: min dim for bounds
+const int KM_BOUNDS_MIN_PTS	= 2000;	// auto: min number of pts
+const int KM_BOUNDS_BLOCKS	= 64;	// point blocks for summation
+
+class KMbounds {
+private:
+    int			dim;		// dimension
+    int			nPts;		// number of points
+    int			kCtrs;		// number of centers (0 = none yet)
+    int			nGroups;	// number of center groups
+    KMdataArray		pts;		// the data points (not owned)
+    double*		ptSqs;		// (p.p) for every point
+    KMctrIdxArray	assign;		// closest center per point
+    double*		upper;		// upper bound per point
+    double*		lower;		// lower bounds [nPts][nGroups]
+    int*		ctrGroup;	// group of each center
+    int*		groupStart;	// first center of group in grpCtrs
+    KMctrIdxArray	grpCtrs;	// centers ordered by group
+    KMcenterArray	prevCtrs;	// centers the bounds refer to
+    double*		drift;		// drift of each center
+    double*		groupDrift;	// max drift in each group
+    double		distCount;	// distance computations (last pass)
+protected:				// local utilities
+    void alloc(int k);			// allocate center dependent data
+    void dealloc();			// deallocate center dependent data
+    void makeGroups(KMcenterArray ctrs);// partition centers into groups
+    void initBounds(KMcenterArray ctrs);// full pass (no valid bounds)
+    void updateBounds(KMcenterArray ctrs);// incremental pass
+public:
+    KMbounds(				// constructor
+	KMdataArray	pa,			// point array
+	int		n,			// number of points
+	int		dd);			// dimension
+
+    ~KMbounds();			// destructor
+
+    void assignPts(			// assign points to centers
+	KMcenterArray	ctrs,			// the centers
+	int		k);			// number of centers
+
+    void getNeighbors(			// compute neighbors for centers
+	KMfilterCenters& ctrs);			// (same as KCtree)
+
+    void getAssignments(		// compute assignments for points
+	KMfilterCenters& ctrs,			// the current centers
+	KMctrIdxArray	closeCtr,		// closest center per point
+	double*		sqDist);		// sq'd distance to center
+
+    int getNGroups() const {		// number of center groups
+	return nGroups;
+    }
+    double getDistCount() const {	// distances computed by last pass
+	return distCount;
+    }
+};
+
+//----------------------------------------------------------------------
+//  kmSelectLloydAlg - select the engine for Lloyd's stages
+//	Returns LLOYD (filtering) or LLOYD_BOUNDS.  If the engine is
+//	KM_LLOYD_AUTO the choice is made from the dimension and the
+//	number of points: bounds are used when the dimension is at least
+//	KM_BOUNDS_MIN_DIM and there are at least KM_BOUNDS_MIN_PTS
+//	points.
+//----------------------------------------------------------------------
+
+KMalg kmSelectLloydAlg(			// select Lloyd's engine
+    KMlloydEngine	engine,			// requested engine
+    int			dim,			// dimension
+    int			n,			// number of points
+    int			k);			// number of centers
+
+#endif
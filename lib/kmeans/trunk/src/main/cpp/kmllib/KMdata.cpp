@@ -25,16 +25,29 @@
 KMdata::KMdata(int d, int n) : dim(d), maxPts(n), nPts(n) {
     pts = kmAllocPts(n, d);
     kcTree = NULL;
+    bounds = NULL;
 }
 
 KMdata::~KMdata() {			// destructor
     kmDeallocPts(pts);				// deallocate point array
     delete kcTree;				// deallocate kc-tree
+    delete bounds;				// deallocate bounds
 }
 
 void KMdata::buildKcTree() {		// build kc-tree for points
     if (kcTree != NULL) delete kcTree;		// destroy existing tree
     kcTree = new KCtree(pts, nPts, dim);	// construct the tree
+    if (bounds != NULL) {			// points may have changed
+	delete bounds;
+	bounds = NULL;
+    }
+}
+
+KMbounds* KMdata::getBounds() {		// get (create) bounds structure
+    if (bounds == NULL) {
+	bounds = new KMbounds(pts, nPts, dim);
+    }
+    return bounds;
 }
 
 void KMdata::resize(int d, int n) {	// resize point array
@@ -48,6 +61,10 @@ void KMdata::resize(int d, int n) {	// resize point array
 	delete kcTree;				// deallocate kc-tree
 	kcTree = NULL;
     }
+    if (bounds != NULL) {			// bounds exist?
+	delete bounds;				// deallocate bounds
+	bounds = NULL;
+    }
 }
 
 //------------------------------------------------------------------------
@@ -23,6 +23,7 @@
 
 #include "KMeans.h"			// kmeans includes
 #include "KCtree.h"			// kc-tree includes
+#include "KMbounds.h"			// bound-based assignment
 
 //----------------------------------------------------------------------
 //  KMdata - data point set
@@ -34,6 +35,10 @@
 // 	constructed by first initializing the points and then calling
 // 	buildKcTree().
 //
+// 	The bound-based assignment structure (see KMbounds.h) is
+// 	created on demand by getBounds().  Like the kc-tree it is
+// 	destroyed when the points are modified.
+//
 // 	We support a virtual function samplePt and samplePts, which
 // 	sample one or a set of random center points.  In this version,
 // 	the sample is just a random sample of the point set.  However,
@@ -53,10 +58,11 @@ private:
     int			nPts;		// number of data points
     KMdataArray		pts;		// the data points
     KCtree*		kcTree;		// kc-tree for the points
+    KMbounds*		bounds;		// point/center bounds (or NULL)
 private:				// copy functions (not implemented)
-    KMdata(const KMdata& p)		// copy constructor
+    KMdata(const KMdata&)		// copy constructor
       { assert(false); }
-    KMdata& operator=(const KMdata& p)	// assignment operator
+    KMdata& operator=(const KMdata&)	// assignment operator
       { assert(false);  return *this; }
 public:
     KMdata(int d, int n);		// standard constructor
@@ -81,10 +87,16 @@ public:
     }
     void setNPts(int n) {		// set number of points
 	assert(n <= maxPts);		// can't be more than array size
+	if (bounds != NULL && n != nPts) {// bounds refer to old size
+	    delete bounds;
+	    bounds = NULL;
+	}
 	nPts = n;
     }
     void buildKcTree();			// build the kc-tree for points
 
+    KMbounds* getBounds();		// get (create) bounds structure
+
     virtual void sampleCtr(		// sample a center point
 	KMpoint		sample);		// where to store sample
 
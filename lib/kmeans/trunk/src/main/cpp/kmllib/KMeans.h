@@ -105,8 +105,15 @@ enum KMalg {				// k-means algorithm names
 	HYBRID,				// hybrid algorithm
 	EZ_HYBRID,			// EZ-hybrid algorithm
 	RANDOM,				// random centers
+	LLOYD_BOUNDS,			// Lloyd's (using bounds, see KMbounds.h)
 	N_KM_ALGS};			// number of algorithms
 
+enum KMlloydEngine {			// engine for Lloyd's stages
+	KM_LLOYD_AUTO,			// select by dimension and data size
+	KM_LLOYD_FILTER,		// filtering by the kc-tree
+	KM_LLOYD_BOUNDS,		// triangle-inequality bounds
+	N_KM_LLOYD_ENGINES};		// number of engines
+
 //----------------------------------------------------------------------
 //  Global variables
 //----------------------------------------------------------------------
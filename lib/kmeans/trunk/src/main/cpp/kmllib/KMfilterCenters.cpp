@@ -34,6 +34,7 @@ KMfilterCenters::KMfilterCenters(int k, KMdata& p, double df)
     dists	= new double[kCtrs];
     currDist	= KM_HUGE;
     dampFactor	= df;
+    distAlg	= LLOYD;
     invalidate();			// distortions are initially invalid
 }
 					// copy constructor
@@ -45,6 +46,7 @@ KMfilterCenters::KMfilterCenters(const KMfilterCenters& s)
     dists	= kmAllocCopy(kCtrs, s.dists);
     currDist	= s.currDist;
     dampFactor	= s.dampFactor;
+    distAlg	= s.distAlg;
     valid	= s.valid;
 }
 					// assignment operator
@@ -73,6 +75,7 @@ KMfilterCenters& KMfilterCenters::operator=(const KMfilterCenters& s) {
     }
     currDist = s.currDist;
     dampFactor = s.dampFactor;
+    distAlg = s.distAlg;
     return *this;
 }
     					// virtual destructor
@@ -87,9 +90,9 @@ KMfilterCenters::~KMfilterCenters() {
 //  computeDistortion
 //	This procedure computes the total and individual distortions for
 //	a set of center points.  It invokes getNeighbors() on the
-//	kc-tree for the point set,which computes the values of weights,
-//	sums, and sumSqs, from which the distortion is computed as
-//	follows.
+//	kc-tree for the point set (or on the bounds structure if distAlg
+//	is LLOYD_BOUNDS), which computes the values of weights, sums,
+//	and sumSqs, from which the distortion is computed as follows.
 //
 //	Distortion Computation:
 //	-----------------------
@@ -115,9 +118,14 @@ KMfilterCenters::~KMfilterCenters() {
 void KMfilterCenters::computeDistortion() // compute distortions
 {
     // *kmOut << "------------------------------Computing Distortions" << endl;
-    KCtree* t = getData().getKcTree();
-    assert(t != NULL);				// tree better exist
-    t->getNeighbors(*this);			// get neighbors
+    if (distAlg == LLOYD_BOUNDS) {		// bound-based engine
+	getData().getBounds()->getNeighbors(*this);
+    }
+    else {
+	KCtree* t = getData().getKcTree();
+	assert(t != NULL);			// tree better exist
+	t->getNeighbors(*this);			// get neighbors
+    }
     double totDist = 0;
     for (int j = 0; j < kCtrs; j++) {
 	double cDotC = 0;			// init: (c[j] . c[j])
@@ -227,7 +235,7 @@ void KMfilterCenters::swapOneCenter(		// swap one center
 //  print centers and distortions
 //----------------------------------------------------------------------
 
-void KMfilterCenters::print(bool fancy)		// print centers and distortion
+void KMfilterCenters::print(bool /*fancy*/)		// print centers and distortion
 {
     for (int j = 0; j < kCtrs; j++) {
 	*kmOut << "    " << setw(4) << j << "\t";
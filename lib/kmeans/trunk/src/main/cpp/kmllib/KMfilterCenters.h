@@ -43,6 +43,14 @@
 //	getAssignments()
 //		Computes the assignment of points to the closest center.
 //
+//	The neighbors of the centers are normally computed by the
+//	filtering algorithm on the kc-tree.  Alternatively they can be
+//	computed by the bound-based algorithm of KMbounds, which is
+//	faster in higher dimensions.  The engine is selected by the
+//	kind of the last Lloyd's stage (lloyd1Stage() or
+//	lloydBounds1Stage()) and is used for all subsequent distortion
+//	computations.  Both engines give the same (exact) result.
+//
 //	These functions are not computed independently.  In particular,
 //	for a given set of centers, they can each be computed very
 //	efficiently (in O(k*d) time) provided that some intermediate
@@ -112,6 +120,7 @@ protected:			// distortion data
     double		currDist;	// current total distortion
     bool		valid;		// are sums/distortions valid?
     double		dampFactor;	// dampening factor [0,1]
+    KMalg		distAlg;	// LLOYD (filter) or LLOYD_BOUNDS
 protected:			// local utilities
     void computeDistortion();		// compute distortions
     void moveToCentroid();		// move centers to cluster centroids
@@ -174,8 +183,20 @@ public:					// public accessors
 	invalidate();
     }
     void lloyd1Stage() {		// one stage of LLoyd's algorithm
+	setDistAlg(LLOYD);
+	moveToCentroid();
+    }
+    void lloydBounds1Stage() {		// ...using bounds (KMbounds)
+	setDistAlg(LLOYD_BOUNDS);
 	moveToCentroid();
     }
+    void setDistAlg(KMalg alg) {	// set engine for distortions
+	assert(alg == LLOYD || alg == LLOYD_BOUNDS);
+	distAlg = alg;
+    }
+    KMalg getDistAlg() const {		// get engine for distortions
+	return distAlg;
+    }
     void swap1Stage() {			// one stage of swap heuristic
 	swapOneCenter();
     }
@@ -19,6 +19,7 @@
 //----------------------------------------------------------------------
 
 #include "KMlocal.h"				// KMlocal includes
+#include "KMperf.h"				// stage counters
 
 //----------------------------------------------------------------------
 //  execute - execute the clustering algorithm
@@ -34,10 +35,14 @@ KMfilterCenters KMlocal::execute()		// execute the algorithm
 	do {					// do while run is not done
 	    beginStage();			// start of stage processing
 	    KMalg method = selectMethod();	// select a method
+	    kmPerfBegin(method);
 	    switch(method) {			// apply one stage
 	    case LLOYD:				// Lloyd's algorithm
 		curr.lloyd1Stage();
 		break;
+	    case LLOYD_BOUNDS:			// Lloyd's using bounds
+		curr.lloydBounds1Stage();
+		break;
 	    case SWAP:				// swap heuristic
 		curr.swap1Stage();
 		break;
@@ -48,6 +53,7 @@ KMfilterCenters KMlocal::execute()		// execute the algorithm
 		assert(false);
 		break;
 	    }
+	    kmPerfEnd(method);
 	    endStage();				// end of stage processing
 	} while (!isRunDone());			// while run is not done
 	endRun();				// end of run processing
@@ -79,6 +79,7 @@ typedef KMlocal* KMlocalPtr;			// generic algorithm pointer
 //	    method = selectMethod()		// select a method
 //	    switch( method ) {			// apply the method
 //	      LLOYD:  curr.Lloyd(); break
+//	      LLOYD_BOUNDS: curr.LloydBounds(); break
 //	      SWAP:   curr.Swap();  break
 //	      RANDOM: curr.Random();  break
 //	    }
@@ -99,6 +100,11 @@ typedef KMlocal* KMlocalPtr;			// generic algorithm pointer
 //	--------------------
 //	maxTotStage
 //		Maximum number of stages total.
+//	lloydEngine
+//		Engine for Lloyd's stages.  It is resolved once by
+//		kmSelectLloydAlg() to LLOYD (filtering) or LLOYD_BOUNDS
+//		(see KMbounds.h) and stored in lloydAlg, which the
+//		algorithms return from selectMethod() for Lloyd's stages.
 //------------------------------------------------------------------------
 
 class KMlocal {				// generic local search
@@ -109,6 +115,7 @@ protected:
     int			dim;			// dimension
     KMterm		term;			// termination conditions
     int			maxTotStage;		// max total stages (from term)
+    KMalg		lloydAlg;		// LLOYD or LLOYD_BOUNDS
 					// varying quantities
     int			stageNo;		// current stage number
     int			runInitStage;		// stage at which run started
@@ -132,6 +139,7 @@ public:
 	dim     = sol.getDim();
 	stageNo = 0;
 	maxTotStage = term.getMaxTotStage(kCtrs, nPts);
+	lloydAlg = kmSelectLloydAlg(term.getLloydEngine(), dim, nPts, kCtrs);
     }
 
     virtual ~KMlocal() { }			// virtual destructor
@@ -141,6 +149,10 @@ public:
       return stageNo;
     }
 
+    KMalg getLloydAlg() const {			// engine for Lloyd's stages
+      return lloydAlg;
+    }
+
 protected:					// overridden by subclasses
     virtual void reset() {			// reset everything
 	stageNo = 0;
@@ -156,7 +168,7 @@ protected:					// overridden by subclasses
 	runInitStage = stageNo;
     }
     virtual void beginStage() { }		// start of stage processing
-    virtual KMalg selectMethod() = 0;		// method: LLOYD or SWAP
+    virtual KMalg selectMethod() = 0;		// method: lloydAlg or SWAP
     virtual void endStage() {			// end of stage processing
 	stageNo++;
     }
@@ -293,7 +305,7 @@ protected:					// overridden methods
         printStageStats();
     }
     virtual KMalg selectMethod() {		// method = Lloyd's
-    	return (isNewPhase ? RANDOM : LLOYD);	// ...unless start of phase
+    	return (isNewPhase ? RANDOM : lloydAlg);// ...unless start of phase
     }
     virtual void endStage() {			// end of stage processing
 	KMlocal::endStage();			// base class processing
@@ -672,7 +684,7 @@ protected:					// overridden methods
       prevDist = curr.getDist();		// save previous distortion
     }
     virtual KMalg selectMethod() {		// select method
-      return (areSwapping ? SWAP : LLOYD );
+      return (areSwapping ? SWAP : lloydAlg );
     }
     virtual void endStage() {			// end of stage processing
       stageNo++;				// increment stage number
@@ -816,7 +828,7 @@ protected:					// overridden methods
       prevDist = curr.getDist();		// save previous distortion
     }
     virtual KMalg selectMethod() {		// select method
-      return (areSwapping ? SWAP : LLOYD );
+      return (areSwapping ? SWAP : lloydAlg );
     }
     virtual void endStage() {			// end of stage processing
       stageNo++;				// increment stage number
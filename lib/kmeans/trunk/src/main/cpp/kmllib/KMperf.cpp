@@ -0,0 +1,145 @@
+//----------------------------------------------------------------------
+//	File:           KMperf.cpp
+//	Description:    Performance counters of the stages
+//----------------------------------------------------------------------
+// This file is an extension of KMlocal and is distributed under the
+// same terms.  See the file Copyright.txt in the main directory.
+//----------------------------------------------------------------------
+
+#include <chrono>				// steady_clock
+#include <cstring>				// memset
+#include "KMperf.h"				// KMperf includes
+
+#ifdef __linux__
+#include <linux/perf_event.h>			// perf_event_open
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool		kmPerfOn = false;
+
+//----------------------------------------------------------------------
+//  Local data
+//	kmPerfFds	group of the hardware counters (cycles,
+//			instructions, cache misses), opened by the first
+//			kmPerfEnable(true), -1 if not available
+//	kmPerfStart	time and counters at the begin of the stage
+//	kmPerfTotals	counters of each method
+//----------------------------------------------------------------------
+
+static const int KM_PERF_HW_COUNT = 3;		// number of hw counters
+
+static bool		kmPerfIsOpenTried = false;
+static int		kmPerfFds[KM_PERF_HW_COUNT] = {-1, -1, -1};
+static KMperfCount	kmPerfStart[N_KM_ALGS][1 + KM_PERF_HW_COUNT];
+static KMperfCounters	kmPerfTotals[N_KM_ALGS];
+
+static KMperfCount nowNs()			// steady time, ns
+{
+    return (KMperfCount) std::chrono::duration_cast<std::chrono::nanoseconds>(
+	std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void closeHw()				// close the hw counters
+{
+#ifdef __linux__
+    for (int i = KM_PERF_HW_COUNT-1; i >= 0; i--) {
+	if (kmPerfFds[i] != -1) {
+	    close(kmPerfFds[i]);
+	    kmPerfFds[i] = -1;
+	}
+    }
+#endif
+}
+
+static void openHw()				// open the hw counters
+{
+#ifdef __linux__
+    const unsigned long long configs[KM_PERF_HW_COUNT] = {
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < KM_PERF_HW_COUNT; i++) {
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = configs[i];
+	attr.read_format = PERF_FORMAT_GROUP;
+	attr.exclude_kernel = 1;		// allowed by default paranoia
+	attr.exclude_hv = 1;
+					// this thread on any cpu
+	kmPerfFds[i] = (int) syscall(__NR_perf_event_open, &attr, 0, -1,
+		i == 0 ? -1 : kmPerfFds[0], 0);
+	if (kmPerfFds[i] == -1) {
+	    closeHw();
+	    return;
+	}
+    }
+#endif
+}
+
+static bool readHw(KMperfCount* values)	// read the hw counters
+{
+#ifdef __linux__
+    if (kmPerfFds[0] == -1) return false;
+					// group: number, then values
+    KMperfCount data[1 + KM_PERF_HW_COUNT];
+    if (read(kmPerfFds[0], data, sizeof(data)) != (ssize_t) sizeof(data)
+	    || data[0] != KM_PERF_HW_COUNT) {
+	return false;
+    }
+    memcpy(values, data + 1, sizeof(KMperfCount) * KM_PERF_HW_COUNT);
+    return true;
+#else
+    return false;
+#endif
+}
+
+//----------------------------------------------------------------------
+//  Public functions
+//----------------------------------------------------------------------
+
+bool kmPerfEnable(bool on)
+{
+    if (on && !kmPerfIsOpenTried) {
+	kmPerfIsOpenTried = true;
+	openHw();
+    }
+    kmPerfOn = on;
+    return kmPerfFds[0] != -1;
+}
+
+void kmPerfReset()
+{
+    memset(kmPerfTotals, 0, sizeof(kmPerfTotals));
+}
+
+void kmPerfGet(KMalg method, KMperfCounters& counters)
+{
+    counters = kmPerfTotals[method];
+}
+
+void kmPerfBeginStage(KMalg method)
+{
+    KMperfCount* start = kmPerfStart[method];
+    if (!readHw(start + 1)) {
+	memset(start + 1, 0, sizeof(KMperfCount) * KM_PERF_HW_COUNT);
+    }
+    start[0] = nowNs();				// last, excludes the read
+}
+
+void kmPerfEndStage(KMalg method)
+{
+    KMperfCount time = nowNs();
+    const KMperfCount* start = kmPerfStart[method];
+    KMperfCounters& t = kmPerfTotals[method];
+    KMperfCount values[KM_PERF_HW_COUNT];
+    t.count++;
+    t.timeNs += time - start[0];
+    if (readHw(values)) {
+	t.cycles += values[0] - start[1];
+	t.instructions += values[1] - start[2];
+	t.llcMisses += values[2] - start[3];
+    }
+}
@@ -0,0 +1,64 @@
+//----------------------------------------------------------------------
+//	File:           KMperf.h
+//	Description:    Performance counters of the stages
+//----------------------------------------------------------------------
+// This file is an extension of KMlocal and is distributed under the
+// same terms.  See the file Copyright.txt in the main directory.
+//----------------------------------------------------------------------
+
+#ifndef KM_PERF_H
+#define KM_PERF_H
+
+#include "KMeans.h"				// kmeans includes
+
+//----------------------------------------------------------------------
+//  Stage performance counters
+//	KMlocal::execute() brackets each stage with kmPerfBegin() and
+//	kmPerfEnd(), the counters are summed per method (KMalg) of the
+//	stage: the number of stages, the time and, if the hardware
+//	counters are available (Linux perf_event_open(), not in most
+//	VMs), cycles, instructions and last level cache misses.
+//
+//	The hardware counters are of the calling thread only, the
+//	OpenMP threads of the parallel passes are not counted (the time
+//	is the wall time of the stage).
+//
+//	The counters are global, like kmIdum they are not thread safe.
+//	When they are disabled (default), a stage only checks kmPerfOn.
+//----------------------------------------------------------------------
+
+typedef unsigned long long KMperfCount;
+
+struct KMperfCounters {			// counters of a method
+    KMperfCount		count;			// number of stages
+    KMperfCount		timeNs;			// time, ns
+    KMperfCount		cycles;			// hardware counters or 0
+    KMperfCount		instructions;
+    KMperfCount		llcMisses;		// last level cache misses
+};
+
+extern bool		kmPerfOn;		// are the counters enabled?
+
+bool kmPerfEnable(			// enable or disable the counters
+    bool		on);			// returns true if hw available
+
+void kmPerfReset();			// clear the counters
+
+void kmPerfGet(				// get the counters of a method
+    KMalg		method,
+    KMperfCounters&	counters);
+
+void kmPerfBeginStage(KMalg method);	// use kmPerfBegin()
+void kmPerfEndStage(KMalg method);	// use kmPerfEnd()
+
+inline void kmPerfBegin(KMalg method)	// begin a stage
+{
+    if (kmPerfOn) kmPerfBeginStage(method);
+}
+
+inline void kmPerfEnd(KMalg method)	// end a stage
+{
+    if (kmPerfOn) kmPerfEndStage(method);
+}
+
+#endif
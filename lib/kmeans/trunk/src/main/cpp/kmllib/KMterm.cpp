@@ -36,6 +36,7 @@ KMterm::KMterm() {			// default constructor
     initProbAccept	= 0;
     tempRunLength	= 0;
     tempReducFact	= 0;
+    lloydEngine		= KM_LLOYD_AUTO;
 }
 
 //----------------------------------------------------------------------
@@ -54,6 +55,7 @@ KMterm::KMterm(				// standard constructor
     initProbAccept	= ipa;
     tempRunLength	= trl;
     tempReducFact	= trf;
+    lloydEngine		= KM_LLOYD_AUTO;
 }
 
 int KMterm::maxStage(const double param[KM_TERM_VEC_LEN],
@@ -80,6 +80,14 @@
 //	tempReducFactor
 //		The factor by which temperature is reduced at the end of
 //		a temperature run.
+//
+//	Parameters used in Lloyd's Algorithm
+//	------------------------------------
+//	lloydEngine
+//		How the points are assigned to the centers in Lloyd's
+//		stages: filtering by the kc-tree, triangle-inequality
+//		bounds (see KMbounds.h) or an automatic choice based on
+//		the dimension and the number of points (default).
 //------------------------------------------------------------------------
 
 enum {				// entry names
@@ -98,6 +106,7 @@ private:
     double   initProbAccept;			// initial prob. of acceptance
     int      tempRunLength;			// length of temp run
     double   tempReducFact;			// temperature reduction factor
+    KMlloydEngine lloydEngine;			// engine for Lloyd's stages
 
 protected:					// stage count
     int maxStage(const double param[KM_TERM_VEC_LEN], int k, int n) const;
@@ -154,5 +163,11 @@ public:
 
     void setTempReducFact(double trf)		// set temp. reduction fact.
       { tempReducFact = trf; }
+
+    KMlloydEngine getLloydEngine() const	// return Lloyd's engine
+      { return lloydEngine; }
+
+    void setLloydEngine(KMlloydEngine le)	// set Lloyd's engine
+      { lloydEngine = le; }
 };
 #endif
@@ -30,7 +30,7 @@ KMterm  term(100, 0, 0, 0,              // run for 100 stages
              0.10, 0.10, 3,             // other typical parameter values 
              0.50, 10, 0.95);
 
-int main(int argc, char **argv)
+int main()
 {
     int		k	= 4;			// number of centers
     int		dim	= 2;			// dimension
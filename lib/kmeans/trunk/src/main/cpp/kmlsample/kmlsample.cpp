@@ -21,6 +21,7 @@
 #include <cstdlib>			// C standard includes
 #include <iostream>			// C++ I/O
 #include <string>			// C++ strings
+#include <cstring>			// strcmp
 #include "KMlocal.h"			// k-means algorithms
 
 using namespace std;			// make std:: available
@@ -20,8 +20,12 @@
 
 #include <iostream>			// file I/O
 #include <string>			// string ops
+#include <cstring>			// strcmp
 #include <ctime>			// clock
 #include <cmath>			// math routines
+#ifdef _OPENMP
+#include <omp.h>			// omp_get_wtime
+#endif
 
 #include "KMeans.h"			// k-means includes
 #include "KMterm.h"			// k-means termination
@@ -225,6 +229,13 @@
 //				    EZ-hybrid = a simpler version of
 //					    hybrid. One swap followed
 //					    by some number of Lloyd's.
+//	compare_lloyd <int>	Benchmark of the Lloyd's engines.  Samples
+//				random centers and runs the given number
+//				of Lloyd's stages from them, once with
+//				filtering (kc-tree) and once with bounds
+//				(KMbounds).  Prints the wall clock times
+//				and the final distortions, which must be
+//				equal up to rounding.
 //
 //	Miscellaneous: (Strings may have no embedded blanks.)
 //	-----------------------------------------------------
@@ -366,6 +377,16 @@
 //	max_run_stage <int>	This is used in Lloyd's algorithm.  A
 //				run terminates after this many stages.
 //				Default: 100
+//	lloyd_engine <string>	Engine used for Lloyd's stages (in lloyd,
+//				hybrid and EZ-hybrid):
+//				    auto   = bounds if dim >= 5 and
+//					     data_size >= 2000, else
+//					     filter.
+//				    filter = filtering by the kc-tree.
+//				    bounds = triangle-inequality bounds
+//					     (Elkan/Yinyang), better in
+//					     higher dimensions.
+//				Default: auto
 //
 //   Options specific to the swap algorithm:
 //   ---------------------------------------
@@ -439,7 +460,18 @@ static const string kmAlgTable[N_KM_ALGS] = {
 	"swap",				// SWAP only
 	"hybrid",			// HYBRID alternation
 	"EZ-hybrid",			// EZ_HYBRID alternation
-	"--illegal--"};			// RANDOM (not allowed)
+	"--illegal--",			// RANDOM (not allowed)
+	"--illegal--"};			// LLOYD_BOUNDS (see lloyd_engine)
+
+//------------------------------------------------------------------------
+//  Lloyd's engines
+//	(See KMeans.h for coresponding enumeration)
+//------------------------------------------------------------------------
+
+static const string lloydEngineTable[N_KM_LLOYD_ENGINES] = {
+	"auto",				// KM_LLOYD_AUTO
+	"filter",			// KM_LLOYD_FILTER
+	"bounds"};			// KM_LLOYD_BOUNDS
 
 //------------------------------------------------------------------------
 //  Distributions
@@ -499,6 +531,20 @@ inline double elapsedTime(clock_t start) {
     return double(clock() - start)/double(CLOCKS_PER_SEC);
 }
 
+//----------------------------------------------------------------------
+// wallTime
+// Wall clock time in seconds.  clock() sums up the time of all threads
+// on some platforms, so it is not suitable for parallel code.
+//----------------------------------------------------------------------
+
+inline double wallTime() {
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return double(clock())/double(CLOCKS_PER_SEC);
+#endif
+}
+
 //------------------------------------------------------------------------
 // Function declarations
 //------------------------------------------------------------------------
@@ -519,6 +565,10 @@ static void readDataPts(		// read data/query points from file
 static void buildKcTree(		// build kc-tree for points
     KMdataPtr		dataPts);	// point array
 
+static void compareLloyd(		// benchmark Lloyd's engines
+    KMdataPtr		dataPts,	// data points
+    int			stages);	// number of stages
+
 //------------------------------------------------------------------------
 //  Default execution parameters
 //------------------------------------------------------------------------
@@ -814,6 +864,15 @@ int main(int argc, char **argv)
 	    *kmIn >> dblArg;
 	    term.setTempReducFact(dblArg);
 	}
+	else if (directive =="lloyd_engine") {
+	    *kmIn >> strArg;			// input name and translate
+	    int le = lookUp(strArg, lloydEngineTable, N_KM_LLOYD_ENGINES);
+	    if (le >= N_KM_LLOYD_ENGINES) {	// not something we recognize
+		*kmErr << "Lloyd's engine: " << strArg << "\n";
+		kmError("Unknown Lloyd's engine", KMabort);
+	    }
+	    term.setLloydEngine((KMlloydEngine) le);
+	}
 	//----------------------------------------------------------------
 	//  seed option
 	//	The seed is reset by setting the global kmIdum to the
@@ -948,6 +1007,16 @@ int main(int argc, char **argv)
 	    runKmeans(alg, dataPts, term);	// do it
 	}
 	//----------------------------------------------------------------
+	//  compare_lloyd operation
+	//----------------------------------------------------------------
+	else if (directive =="compare_lloyd") {
+	    *kmIn >> intArg;			// number of stages
+	    if (dataPts == NULL) {		// data points must exist
+		kmError("No data set has been generated", KMabort);
+	    }
+	    compareLloyd(dataPts, intArg);
+	}
+	//----------------------------------------------------------------
 	//  Unknown directive
 	//----------------------------------------------------------------
 	else {
@@ -1012,6 +1081,10 @@ static void printHeader(
 	default:
 	    assert(false);			// shouldn't get here
 	}
+	if (alg != SWAP && kmSelectLloydAlg(term.getLloydEngine(), dim,
+			dataPts->getNPts(), kcenters) == LLOYD_BOUNDS) {
+	    *kmOut  << "  lloyd_engine     = bounds\n";
+	}
 	*kmOut << "]" << endl;
     }
 }
@@ -1196,6 +1269,64 @@ static void buildKcTree(		// build kc-tree for points
     }
 }
 
+//------------------------------------------------------------------------
+//  compareLloyd - benchmark of the Lloyd's engines
+//	Runs the given number of Lloyd's stages from the same random
+//	centers with filtering and with bounds and prints the times.  The
+//	bounds time includes the initial full assignment pass.
+//------------------------------------------------------------------------
+
+static void compareLloyd(		// benchmark Lloyd's engines
+    KMdataPtr		dataPts,	// data points
+    int			stages)		// number of stages
+{
+    KMfilterCenters filterCtrs(kcenters, *dataPts, damp_factor);
+    filterCtrs.genRandom();			// common start centers
+    KMfilterCenters boundsCtrs(filterCtrs);
+
+    double start = wallTime();
+    for (int s = 0; s < stages; s++) {
+	filterCtrs.lloyd1Stage();
+	filterCtrs.getDist();
+    }
+    double filterTime = wallTime() - start;
+
+    start = wallTime();
+    for (int s = 0; s < stages; s++) {
+	boundsCtrs.lloydBounds1Stage();
+	boundsCtrs.getDist();
+    }
+    double boundsTime = wallTime() - start;
+
+    double filterDist = filterCtrs.getAvgDist(false);
+    double boundsDist = boundsCtrs.getAvgDist(false);
+    KMbounds* bounds = dataPts->getBounds();
+    KMalg autoAlg = kmSelectLloydAlg(KM_LLOYD_AUTO, dim,
+			dataPts->getNPts(), kcenters);
+
+    *kmOut << "\n[Compare_Lloyd:\n"
+	 << "  data_size      = " << dataPts->getNPts() << "\n"
+	 << "  kcenters       = " << kcenters << "\n"
+	 << "  dim            = " << dim << "\n"
+	 << "  stages         = " << stages << "\n"
+	 << "  groups         = " << bounds->getNGroups() << "\n"
+	 << "  filter_time    = " << filterTime << " sec\n"
+	 << "  bounds_time    = " << boundsTime << " sec\n"
+	 << "  speedup        = "
+	 << (boundsTime > 0 ? filterTime / boundsTime : 0) << "\n"
+	 << "  last_dist_frac = "		// share of n*k distances
+	 << bounds->getDistCount() / (double(dataPts->getNPts()) * kcenters)
+	 << "\n"
+	 << "  filter_distort = " << filterDist << "\n"
+	 << "  bounds_distort = " << boundsDist << "\n"
+	 << "  rel_diff       = "
+	 << (filterDist > 0 ? fabs(filterDist - boundsDist) / filterDist : 0)
+	 << "\n"
+	 << "  auto_engine    = "
+	 << (autoAlg == LLOYD_BOUNDS ? "bounds" : "filter") << "\n"
+	 << "]" << endl;
+}
+
 //------------------------------------------------------------------------
 // Print summary of distribution.
 //------------------------------------------------------------------------
@@ -68,6 +68,16 @@ namespace ai.lib.kmeans
 
             #endregion
 
+            #region Input, version 2
+
+            /// <summary>
+            /// Engine for Lloyd's stages: 0 - auto, 1 - kc-tree filtering, 2 - bounds.
+            /// Used by KML_HybridEx() only.
+            /// </summary>
+            public int lloydEngine;
+
+            #endregion
+
             #region Methods
 
             public void SetDefaultTerm()
@@ -161,9 +171,76 @@ namespace ai.lib.kmeans
         };
 
 
+        /// <summary>
+        /// Performance counters of the stages of a method, see KML_PerfCounters_Get().
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        public struct StagePerfCounters
+        {
+            public UInt64 count;
+            public UInt64 timeNs;
+            /// <summary>
+            /// Hardware counters of the calling thread, 0 if not available.
+            /// </summary>
+            public UInt64 cycles;
+            public UInt64 instructions;
+            public UInt64 llcMisses;
+        }
+
+        /// <summary>
+        /// Methods of the stages for KML_PerfCounters_Get().
+        /// </summary>
+        public enum Stage
+        {
+            Lloyd = 0,
+            Swap = 1,
+            Random = 4,
+            LloydBounds = 5
+        }
+
+        /// <summary>
+        /// Version of Parameters, see KML_HybridEx(). Version 3 adds the performance counters.
+        /// </summary>
+        public const int Version = 3;
+
+        /// <summary>
+        /// Returns the version of the native library.
+        /// </summary>
+        [DllImport("ai.lib.kmeans.kml.dll")]
+        public static extern int KML_GetVersion();
+
+        /// <summary>
+        /// Runs the hybrid algorithm, only the fields of version 1 are used.
+        /// </summary>
         [DllImport("ai.lib.kmeans.kml.dll")]
         public static extern int KML_Hybrid(Parameters * p);
 
+        /// <summary>
+        /// Runs the hybrid algorithm. Pass sizeof(Parameters) and Version.
+        /// Returns 0 if the library does not support this version.
+        /// </summary>
+        [DllImport("ai.lib.kmeans.kml.dll")]
+        public static extern int KML_HybridEx(Parameters* p, int paramsSize, int version);
+
+        /// <summary>
+        /// Enables (enable != 0) or disables the performance counters of the stages.
+        /// Returns 1 if the hardware counters are available, otherwise only the stages and the time are counted.
+        /// </summary>
+        [DllImport("ai.lib.kmeans.kml.dll")]
+        public static extern int KML_PerfCounters_Enable(int enable);
+
+        [DllImport("ai.lib.kmeans.kml.dll")]
+        public static extern void KML_PerfCounters_Reset();
+
+        /// <summary>
+        /// Gets the counters of the stages of a method, returns 0 if the method is not valid.
+        /// </summary>
+        [DllImport("ai.lib.kmeans.kml.dll")]
+        public static extern int KML_PerfCounters_Get(Stage method, out StagePerfCounters counters);
+
+        [DllImport("libdl.so.2")]
+        static extern IntPtr dlopen(string fileName, int flags);
+
         /// <summary>
         /// Prepares the dll to load.
         /// </summary>
@@ -171,14 +248,16 @@ namespace ai.lib.kmeans
         /// default: ${bds.BinDir}</param>
         public static void Init(string dir)
         {
-            string platform = System.IntPtr.Size == 8 ? "win64" : "win32";
+            bool isUnix = Environment.OSVersion.Platform == PlatformID.Unix;
+            string platform = isUnix ? (System.IntPtr.Size == 8 ? "linux64" : "linux32") 
+                : (System.IntPtr.Size == 8 ? "win64" : "win32");
             if (string.IsNullOrEmpty(dir))
             {
                 dir = Props.Global.Get("bds.BinDir");
             }
             string dllDir = Path.Combine(dir,  platform);
 
-            string dllName = "ai.lib.kmeans.kml.dll";
+            string dllName = isUnix ? "libai.lib.kmeans.kml.so" : "ai.lib.kmeans.kml.dll";
 
             string dllPath = Path.Combine(dllDir, dllName);
 
@@ -186,6 +265,17 @@ namespace ai.lib.kmeans
             {
                 throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
             }
+            if (isUnix)
+            {
+                // Load by full path, the DllImports are then resolved by the soname 
+                // (see the dllmap in ai.lib.kmeans.dll.config).
+                const int RTLD_NOW = 2, RTLD_GLOBAL = 0x100;
+                if (dlopen(dllPath, RTLD_NOW | RTLD_GLOBAL) == IntPtr.Zero)
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+                return;
+            }
             string envPath = Environment.GetEnvironmentVariable("PATH");
             string envPathL = envPath.ToLower() + ";";
             if (envPathL.IndexOf(dllDir.ToLower() + ";") < 0)
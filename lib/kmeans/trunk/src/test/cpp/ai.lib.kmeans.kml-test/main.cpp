@@ -0,0 +1,183 @@
+// Tests the C interface of ai.lib.kmeans.kml (same checks as Kml_Test.cs).
+// Returns 0 on success.
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+#include "ai.lib.kmeans.kml.h"
+
+using namespace std;
+
+static int _errors = 0;
+
+#define CHECK(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); ++_errors; }
+
+static void SetDefaultTerm(Parameters & p)
+{
+	// Copied from kmlsample.
+	p.term_st_a = 100;
+	p.term_st_b = p.term_st_c = p.term_st_d = 0;
+	p.term_minConsecRDL = 0.1;
+	p.term_minAccumRDL = 0.1;
+	p.term_maxRunStage = 3;
+	p.term_initProbAccept = 0.50;
+	p.term_tempRunLength = 10;
+	p.term_tempReducFact = 0.95;
+}
+
+/// Creates k well-separated clusters of points around (c*10, c*10, ...).
+static void CreateClusters(Parameters & p, vector<double> & points, vector<double> & centers)
+{
+	points.resize(p.n * p.dim);
+	centers.resize(p.k * p.dim);
+	unsigned rng = 1;
+	for(int i = 0; i < p.n; ++i)
+	{
+		int c = i % p.k;
+		for(int d = 0; d < p.dim; ++d)
+		{
+			rng = rng * 1103515245 + 12345;
+			points[i * p.dim + d] = c * 10 + ((rng >> 16) & 0x7fff) / 32768.0;
+		}
+	}
+	p.points = &points[0];
+	p.centers = &centers[0];
+}
+
+/// Checks that each cluster got a center close to its mean.
+static void CheckCenters(const Parameters & p)
+{
+	for(int c = 0; c < p.k; ++c)
+	{
+		bool found = false;
+		for(int j = 0; j < p.k; ++j)
+		{
+			bool match = true;
+			for(int d = 0; d < p.dim; ++d)
+			{
+				match = match && fabs(p.centers[j * p.dim + d] - (c * 10 + 0.5)) < 0.2;
+			}
+			found = found || match;
+		}
+		CHECK(found);
+	}
+}
+
+static void Test_Hybrid(int dim, int lloydEngine)
+{
+	Parameters p;
+	memset(&p, 0, sizeof(p));
+	p.k = 4;
+	p.dim = dim;
+	p.n = 4000;
+	p.seed = 1;
+	p.lloydEngine = lloydEngine;
+	SetDefaultTerm(p);
+	vector<double> points, centers;
+	CreateClusters(p, points, centers);
+
+	CHECK(KML_HybridEx(&p, sizeof(p), KML_VERSION) == 1);
+	CheckCenters(p);
+
+	vector<double> centersEx = centers;
+	CHECK(KML_Hybrid(&p) == 1);
+	if(lloydEngine == 0)
+	{
+		// Same engine and seed must give the same result.
+		CHECK(centersEx == centers);
+	}
+	CheckCenters(p);
+}
+
+static void Test_Versions()
+{
+	CHECK(KML_GetVersion() == KML_VERSION);
+
+	Parameters p;
+	memset(&p, 0, sizeof(p));
+	p.k = 2;
+	p.dim = 2;
+	p.n = 100;
+	p.seed = 1;
+	SetDefaultTerm(p);
+	vector<double> points, centers;
+	CreateClusters(p, points, centers);
+
+	// Unsupported versions and too short structs are rejected.
+	CHECK(KML_HybridEx(&p, sizeof(p), 0) == 0);
+	CHECK(KML_HybridEx(&p, sizeof(p), KML_VERSION + 1) == 0);
+	CHECK(KML_HybridEx(&p, 10, 1) == 0);
+
+	// A version 1 caller does not know lloydEngine, garbage there is ignored.
+	int v1Size = (int)((char*)&p.lloydEngine - (char*)&p);
+	p.lloydEngine = 12345;
+	CHECK(KML_HybridEx(&p, v1Size, 1) == 1);
+	CHECK(KML_HybridEx(&p, sizeof(p), KML_VERSION) == 0);
+	CheckCenters(p);
+}
+
+static void Test_PerfCounters()
+{
+	Parameters p;
+	memset(&p, 0, sizeof(p));
+	p.k = 4;
+	p.dim = 2;
+	p.n = 4000;
+	p.seed = 1;
+	SetDefaultTerm(p);
+	vector<double> points, centers;
+	CreateClusters(p, points, centers);
+
+	StagePerfCounters c;
+	CHECK(KML_PerfCounters_Get(-1, &c) == 0);
+	CHECK(KML_PerfCounters_Get(KML_STAGES_COUNT, &c) == 0);
+
+	int isHwAvailable = KML_PerfCounters_Enable(1);
+	KML_PerfCounters_Reset();
+	CHECK(KML_HybridEx(&p, sizeof(p), KML_VERSION) == 1);
+	unsigned long long stagesCount = 0;
+	for(int m = 0; m < KML_STAGES_COUNT; ++m)
+	{
+		CHECK(KML_PerfCounters_Get(m, &c) == 1);
+		stagesCount += c.count;
+		CHECK(c.count > 0 || c.timeNs == 0);
+		CHECK((c.cycles > 0) == (isHwAvailable && c.count > 0));
+	}
+	// Hybrid does Lloyd's (kc-tree in 2d) and swap stages.
+	CHECK(KML_PerfCounters_Get(KML_STAGE_LLOYD, &c) == 1 && c.count > 0);
+	CHECK(KML_PerfCounters_Get(KML_STAGE_SWAP, &c) == 1 && c.count > 0);
+
+	// Disabled: nothing is counted, the result is the same.
+	vector<double> centersOn = centers;
+	KML_PerfCounters_Enable(0);
+	CHECK(KML_HybridEx(&p, sizeof(p), KML_VERSION) == 1);
+	CHECK(centersOn == centers);
+	unsigned long long stagesCountOff = 0;
+	for(int m = 0; m < KML_STAGES_COUNT; ++m)
+	{
+		KML_PerfCounters_Get(m, &c);
+		stagesCountOff += c.count;
+	}
+	CHECK(stagesCountOff == stagesCount);
+
+	KML_PerfCounters_Reset();
+	CHECK(KML_PerfCounters_Get(KML_STAGE_LLOYD, &c) == 1 && c.count == 0 && c.timeNs == 0);
+}
+
+int main()
+{
+	Test_Versions();
+	Test_PerfCounters();
+	Test_Hybrid(2, 0);
+	Test_Hybrid(6, 1);
+	Test_Hybrid(6, 2);
+	if(_errors)
+	{
+		printf("%d errors\n", _errors);
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
@@ -64,6 +64,51 @@ namespace ai.lib.kmeans.nunit
             }
         }
 
+        [Test]
+        public void Test_HybridEx()
+        {
+            Kml.Init(Path.GetDirectoryName(CodeBase.Get(Assembly.GetExecutingAssembly())));
+
+            Assert.AreEqual(Kml.Version, Kml.KML_GetVersion());
+
+            Kml.Parameters p = new Kml.Parameters();
+
+            try
+            {
+                p.n = 20;
+                p.k = 4;
+                p.dim = 2;
+
+                p.term_st_a = 50;
+                p.term_st_b = p.term_st_c = p.term_st_d = 0;
+                p.term_minConsecRDL = 0.2;
+                p.term_minAccumRDL = 0.1;
+                p.term_maxRunStage = 100;
+                p.term_initProbAccept = 0.50;
+                p.term_tempRunLength = 10;
+                p.term_tempReducFact = 0.75;
+                p.seed = 4;
+                p.lloydEngine = 1; // kc-tree filtering, as in KML_Hybrid for 2-d data.
+
+                p.Allocate();
+
+                for (int i = 0; i < p.n; ++i)
+                {
+                    for (int d = 0; d < p.dim; ++d)
+                    {
+                        *p.GetPoint(i, d) = _data1[i * p.dim + d];
+                    }
+                }
+                Assert.AreEqual(0, Kml.KML_HybridEx(&p, sizeof(Kml.Parameters), Kml.Version + 1));
+                Assert.AreEqual(1, Kml.KML_HybridEx(&p, sizeof(Kml.Parameters), Kml.Version));
+
+                VerifyResult(p, _data1, _data1_expCenters, _data1_expCenterAssignments);
+            }
+            finally
+            {
+                p.Free();
+            }
+        }
 
         #endregion
 
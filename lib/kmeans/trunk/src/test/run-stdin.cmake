@@ -0,0 +1,7 @@
+# Runs EXE with standard input from INPUT (ctest cannot redirect input).
+#   cmake -DEXE=<program> -DINPUT=<file> -P run-stdin.cmake
+
+execute_process(COMMAND ${EXE} INPUT_FILE ${INPUT} RESULT_VARIABLE RESULT)
+if(NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "${EXE} < ${INPUT} failed: ${RESULT}")
+endif()
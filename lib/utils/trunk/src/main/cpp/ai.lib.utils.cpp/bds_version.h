@@ -0,0 +1,214 @@
+#ifndef AI_LIB_UTILS_CPP_BDS_VERSION_H
+#define AI_LIB_UTILS_CPP_BDS_VERSION_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace ai
+{
+	namespace lib
+	{
+		namespace utils
+		{
+
+			/** Reader and writer for the version header written by ai.lib.utils.BdsVersion.Write() (C#)
+			at the beginning of data files. Reads formats 0..5, writes format 5.
+			Header-only, works on a memory buffer (e.g. a mapped_file).
+			*/
+			class bds_version
+			{
+			public:
+				bds_version()
+				{
+					// Not in the initializer list: major() and minor() are macros in glibc.
+					major = minor = revision = build = 0;
+				}
+
+				int major;
+				int minor;
+				int revision;
+				int build;
+				std::string scm_info;
+				std::string build_info;
+				std::string description;
+				std::string user_description;
+
+				/** Reads the version from data[0..size).
+				@return the size of the header in bytes, or 0 if the data is corrupted.
+				*/
+				std::size_t read(const char * data, std::size_t size)
+				{
+					reader r(data, size);
+					int format = r.read_int32();
+					if(!r.ok)
+					{
+						return 0;
+					}
+					if(format < 3)
+					{
+						read_fields(r, format >= 1, format >= 2, false);
+						return r.ok ? r.pos : 0;
+					}
+					int length = r.read_int32();
+					if(!r.ok || length < 0 || length > MAX_SERIALIZED_LENGTH || r.pos + length > size)
+					{
+						return 0;
+					}
+					const char * fields = data + r.pos;
+					reader fr(fields, length);
+					read_fields(fr, true, true, format >= 4);
+					if(!fr.ok)
+					{
+						return 0;
+					}
+					r.pos += length;
+					if(format >= 5)
+					{
+						unsigned crc = (unsigned)r.read_int32();
+						if(!r.ok || crc != crc32(fields, length))
+						{
+							return 0;
+						}
+					}
+					return r.pos;
+				}
+
+				/// Appends the version in format 5, like BdsVersion.Write() (C#).
+				void write(std::string & out) const
+				{
+					std::string fields;
+					write_int32(fields, major);
+					write_int32(fields, minor);
+					write_int32(fields, revision);
+					write_int32(fields, build);
+					write_string(fields, scm_info);
+					write_string(fields, build_info);
+					write_string(fields, description);
+					write_string(fields, user_description);
+					write_int32(out, 5);
+					write_int32(out, (int)fields.size());
+					out += fields;
+					write_int32(out, (int)crc32(fields.data(), fields.size()));
+				}
+
+				/// CRC32 as computed by ai.lib.utils.Crc32 (C#).
+				static unsigned crc32(const char * data, std::size_t size)
+				{
+					unsigned crc = 0xffffffff;
+					for(std::size_t i = 0; i < size; ++i)
+					{
+						crc ^= (unsigned char)data[i];
+						for(int j = 0; j < 8; ++j)
+						{
+							crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+						}
+					}
+					return ~crc;
+				}
+
+			private:
+				/// Must match BdsVersion.MAX_SERIALIZED_LENGTH (C#).
+				static const int MAX_SERIALIZED_LENGTH = 2000;
+
+				/// Reads little-endian data like System.IO.BinaryReader.
+				struct reader
+				{
+					reader(const char * d, std::size_t s) : data(d), size(s), pos(0), ok(true)
+					{}
+
+					int read_int32()
+					{
+						if(pos + 4 > size)
+						{
+							ok = false;
+							return 0;
+						}
+						const unsigned char * p = (const unsigned char *)data + pos;
+						pos += 4;
+						return (int)(p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24));
+					}
+
+					/// A string with 7-bit encoded length prefix.
+					std::string read_string()
+					{
+						std::size_t length = 0;
+						for(int shift = 0; ; shift += 7)
+						{
+							if(pos >= size || shift > 28)
+							{
+								ok = false;
+								return std::string();
+							}
+							unsigned char b = (unsigned char)data[pos++];
+							length |= (std::size_t)(b & 0x7f) << shift;
+							if((b & 0x80) == 0)
+							{
+								break;
+							}
+						}
+						if(pos + length > size)
+						{
+							ok = false;
+							return std::string();
+						}
+						std::string s(data + pos, length);
+						pos += length;
+						return s;
+					}
+
+					const char * data;
+					std::size_t size;
+					std::size_t pos;
+					bool ok;
+				};
+
+				/// Writes little-endian data like System.IO.BinaryWriter.
+				static void write_int32(std::string & s, int v)
+				{
+					unsigned u = (unsigned)v;
+					for(int i = 0; i < 4; ++i, u >>= 8)
+					{
+						s += (char)(u & 0xff);
+					}
+				}
+
+				/// A string with 7-bit encoded length prefix.
+				static void write_string(std::string & s, const std::string & v)
+				{
+					std::size_t length = v.size();
+					for(; length >= 0x80; length >>= 7)
+					{
+						s += (char)(length | 0x80);
+					}
+					s += (char)length;
+					s += v;
+				}
+
+				void read_fields(reader & r, bool has_build_info, bool has_description, bool has_user_description)
+				{
+					major = r.read_int32();
+					minor = r.read_int32();
+					revision = r.read_int32();
+					build = r.read_int32();
+					scm_info = r.read_string();
+					if(has_build_info)
+					{
+						build_info = r.read_string();
+					}
+					if(has_description)
+					{
+						description = r.read_string();
+					}
+					if(has_user_description)
+					{
+						user_description = r.read_string();
+					}
+				}
+			};
+
+		}
+	}
+}
+
+#endif
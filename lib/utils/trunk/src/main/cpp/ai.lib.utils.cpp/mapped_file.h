@@ -0,0 +1,228 @@
+#ifndef AI_LIB_UTILS_CPP_MAPPED_FILE_H
+#define AI_LIB_UTILS_CPP_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ai
+{
+	namespace lib
+	{
+		namespace utils
+		{
+
+			/** A read-only memory mapping of a whole file.
+			The pages are shared by all processes mapping the same file, so large tables
+			(LUTs, strategies) are kept in memory only once per host.
+			Header-only to be usable from every native library without a link dependency.
+			*/
+			class mapped_file
+			{
+			public:
+
+				/// Access pattern hints, see open().
+				enum advice_t
+				{
+					advice_normal = 0,
+					/// Random access, disables read-ahead.
+					advice_random = 1,
+					/// Sequential access, aggressive read-ahead.
+					advice_sequential = 2,
+					/// Request transparent huge pages (Linux, ignored where unsupported).
+					advice_huge_pages = 4,
+					/// Start reading the whole file in background.
+					advice_will_need = 8
+				};
+
+				mapped_file() : _data(0), _size(0)
+#ifdef _WIN32
+					, _file(INVALID_HANDLE_VALUE), _mapping(0)
+#endif
+				{
+				}
+
+				~mapped_file()
+				{
+					close();
+				}
+
+				/** Maps the file.
+				@param advice: a combination of advice_t flags.
+				@return false on error, see error().
+				*/
+				bool open(const char * path, int advice = advice_normal)
+				{
+					close();
+#ifdef _WIN32
+					_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+						(advice & advice_random) ? FILE_FLAG_RANDOM_ACCESS :
+						((advice & advice_sequential) ? FILE_FLAG_SEQUENTIAL_SCAN : 0), 0);
+					if(_file == INVALID_HANDLE_VALUE)
+					{
+						return fail("cannot open", path);
+					}
+					LARGE_INTEGER size;
+					if(!GetFileSizeEx(_file, &size))
+					{
+						return fail("cannot get size of", path);
+					}
+					_size = (std::size_t)size.QuadPart;
+					if(_size == 0)
+					{
+						return true;
+					}
+					_mapping = CreateFileMappingA(_file, 0, PAGE_READONLY, 0, 0, 0);
+					if(_mapping == 0)
+					{
+						return fail("cannot map", path);
+					}
+					_data = (const char *)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+					if(_data == 0)
+					{
+						return fail("cannot map", path);
+					}
+#else
+					int fd = ::open(path, O_RDONLY);
+					if(fd < 0)
+					{
+						return fail("cannot open", path);
+					}
+					struct stat st;
+					if(fstat(fd, &st) != 0)
+					{
+						::close(fd);
+						return fail("cannot get size of", path);
+					}
+					_size = (std::size_t)st.st_size;
+					if(_size == 0)
+					{
+						::close(fd);
+						return true;
+					}
+					void * data = mmap(0, _size, PROT_READ, MAP_SHARED, fd, 0);
+					// The mapping holds a reference to the file.
+					::close(fd);
+					if(data == MAP_FAILED)
+					{
+						_size = 0;
+						return fail("cannot map", path);
+					}
+					_data = (const char *)data;
+					advise(advice);
+#endif
+					return true;
+				}
+
+				void close()
+				{
+#ifdef _WIN32
+					if(_data != 0)
+					{
+						UnmapViewOfFile(_data);
+					}
+					if(_mapping != 0)
+					{
+						CloseHandle(_mapping);
+						_mapping = 0;
+					}
+					if(_file != INVALID_HANDLE_VALUE)
+					{
+						CloseHandle(_file);
+						_file = INVALID_HANDLE_VALUE;
+					}
+#else
+					if(_data != 0)
+					{
+						munmap((void*)_data, _size);
+					}
+#endif
+					_data = 0;
+					_size = 0;
+				}
+
+				bool is_open() const
+				{
+					return _data != 0;
+				}
+
+				const char * data() const
+				{
+					return _data;
+				}
+
+				std::size_t size() const
+				{
+					return _size;
+				}
+
+				/// Description of the last error.
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+			private:
+
+				bool fail(const char * what, const char * path)
+				{
+					_error = std::string(what) + " " + path;
+					close();
+					return false;
+				}
+
+#ifndef _WIN32
+				void advise(int advice)
+				{
+					// All hints are best-effort, errors are ignored.
+					void * data = (void*)_data;
+					if(advice & advice_random)
+					{
+						madvise(data, _size, MADV_RANDOM);
+					}
+					if(advice & advice_sequential)
+					{
+						madvise(data, _size, MADV_SEQUENTIAL);
+					}
+#ifdef MADV_HUGEPAGE
+					if(advice & advice_huge_pages)
+					{
+						madvise(data, _size, MADV_HUGEPAGE);
+					}
+#endif
+					if(advice & advice_will_need)
+					{
+						madvise(data, _size, MADV_WILLNEED);
+					}
+				}
+#endif
+
+				// Not copyable.
+				mapped_file(const mapped_file &);
+				mapped_file & operator = (const mapped_file &);
+
+				const char * _data;
+				std::size_t _size;
+				std::string _error;
+#ifdef _WIN32
+				HANDLE _file;
+				HANDLE _mapping;
+#endif
+			};
+
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,279 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+using System.IO;
+
+namespace ai.lib.utils
+{
+    /// <summary>
+    /// Access pattern hints for MappedFile.
+    /// </summary>
+    [Flags]
+    public enum MappedFileAdvice
+    {
+        Normal = 0,
+        /// <summary>Random access, disables read-ahead.</summary>
+        Random = 1,
+        /// <summary>Sequential access, aggressive read-ahead.</summary>
+        Sequential = 2,
+        /// <summary>Start reading the whole file in background (Unix only).</summary>
+        WillNeed = 4
+    }
+
+    /// <summary>
+    /// A memory mapping of a whole file (mmap() on Unix, MapViewOfFile() on Windows).
+    /// The pages are shared by all processes mapping the same file, so large read-only data
+    /// is kept in memory only once per host and is loaded by the OS on demand.
+    /// <para>By default the mapping is read-only, writing to it causes an access violation.
+    /// A copy-on-write mapping can be modified, the modified pages become private to the process
+    /// and are never written back to the file.</para>
+    /// <para>The mapping is released by a call of Dispose() (recommended) or in the destructor,
+    /// the same rules as for SmartPtr apply.</para>
+    /// </summary>
+    /// <seealso cref="SmartPtr"/>
+    public unsafe sealed class MappedFile : IDisposable
+    {
+        public MappedFile(string fileName) : this(fileName, MappedFileAdvice.Normal)
+        {
+        }
+
+        public MappedFile(string fileName, MappedFileAdvice advice) : this(fileName, advice, false)
+        {
+        }
+
+        public MappedFile(string fileName, MappedFileAdvice advice, bool isCopyOnWrite)
+        {
+            FileName = fileName;
+            IsCopyOnWrite = isCopyOnWrite;
+            Length = new FileInfo(fileName).Length;
+            if (IntPtr.Size == 4 && Length > int.MaxValue)
+            {
+                throw new ApplicationException(String.Format("File '{0}' is too large to be mapped in a 32-bit process", fileName));
+            }
+            if (Length == 0)
+            {
+                return;
+            }
+            if (EnvironmentExt.IsUnix())
+            {
+                MapUnix();
+                Advise(advice);
+            }
+            else
+            {
+                MapWindows(advice);
+            }
+        }
+
+        public string FileName
+        {
+            get;
+            private set;
+        }
+
+        public bool IsCopyOnWrite
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Pointer to the beginning of the file, null for an empty file.
+        /// </summary>
+        public byte* Ptr
+        {
+            get { return _ptr; }
+        }
+
+        /// <summary>
+        /// File length in bytes.
+        /// </summary>
+        public Int64 Length
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Changes the access pattern hint, e.g. to switch from a sequential pass to random lookups.
+        /// Hints are best-effort and are ignored on Windows, where they can be given only on opening the file.
+        /// </summary>
+        public void Advise(MappedFileAdvice advice)
+        {
+            if (_ptr == null || !EnvironmentExt.IsUnix())
+            {
+                return;
+            }
+            // Errors are ignored.
+            IntPtr p = new IntPtr(_ptr);
+            UIntPtr length = new UIntPtr((ulong)Length);
+            madvise(p, length, (advice & MappedFileAdvice.Random) != 0 ? MADV_RANDOM :
+                ((advice & MappedFileAdvice.Sequential) != 0 ? MADV_SEQUENTIAL : MADV_NORMAL));
+            if ((advice & MappedFileAdvice.WillNeed) != 0)
+            {
+                madvise(p, length, MADV_WILLNEED);
+            }
+        }
+
+        public void Dispose()
+        {
+            if (_ptr != null)
+            {
+                if (EnvironmentExt.IsUnix())
+                {
+                    munmap(new IntPtr(_ptr), new UIntPtr((ulong)Length));
+                }
+                else
+                {
+                    UnmapViewOfFile(new IntPtr(_ptr));
+                    CloseHandle(_mapping);
+                }
+                _ptr = null;
+            }
+            GC.SuppressFinalize(this);
+        }
+
+        ~MappedFile()
+        {
+            Dispose();
+        }
+
+        #region Implementation
+
+        void MapUnix()
+        {
+            int fd = open(FileName, O_RDONLY);
+            if (fd < 0)
+            {
+                ThrowError("Cannot open");
+            }
+            // A private mapping of a read-only file descriptor may be writable.
+            IntPtr p = IsCopyOnWrite ?
+                mmap(IntPtr.Zero, new UIntPtr((ulong)Length), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, IntPtr.Zero) :
+                mmap(IntPtr.Zero, new UIntPtr((ulong)Length), PROT_READ, MAP_SHARED, fd, IntPtr.Zero);
+            int error = Marshal.GetLastWin32Error();
+            // The mapping holds a reference to the file.
+            close(fd);
+            if (p == MAP_FAILED)
+            {
+                throw new ApplicationException(String.Format("Cannot map file '{0}', error {1}", FileName, error));
+            }
+            _ptr = (byte*)p;
+        }
+
+        void MapWindows(MappedFileAdvice advice)
+        {
+            uint flags = 0;
+            if ((advice & MappedFileAdvice.Random) != 0)
+            {
+                flags |= FILE_FLAG_RANDOM_ACCESS;
+            }
+            else if ((advice & MappedFileAdvice.Sequential) != 0)
+            {
+                flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+            }
+            IntPtr file = CreateFile(FileName, GENERIC_READ, FILE_SHARE_READ, IntPtr.Zero, OPEN_EXISTING, flags, IntPtr.Zero);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                ThrowError("Cannot open");
+            }
+            // The mapping holds a reference to the file.
+            _mapping = CreateFileMapping(file, IntPtr.Zero, IsCopyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, null);
+            int error = Marshal.GetLastWin32Error();
+            CloseHandle(file);
+            if (_mapping == IntPtr.Zero)
+            {
+                throw new ApplicationException(String.Format("Cannot map file '{0}', error {1}", FileName, error));
+            }
+            IntPtr p = MapViewOfFile(_mapping, IsCopyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, UIntPtr.Zero);
+            if (p == IntPtr.Zero)
+            {
+                error = Marshal.GetLastWin32Error();
+                CloseHandle(_mapping);
+                throw new ApplicationException(String.Format("Cannot map file '{0}', error {1}", FileName, error));
+            }
+            _ptr = (byte*)p;
+        }
+
+        void ThrowError(string what)
+        {
+            throw new ApplicationException(String.Format("{0} file '{1}', error {2}", what, FileName, Marshal.GetLastWin32Error()));
+        }
+
+        byte* _ptr;
+        IntPtr _mapping;
+
+        #region Unix
+
+        const int O_RDONLY = 0;
+        const int PROT_READ = 1;
+        const int PROT_WRITE = 2;
+        const int MAP_SHARED = 1;
+        const int MAP_PRIVATE = 2;
+        const int MADV_NORMAL = 0;
+        const int MADV_RANDOM = 1;
+        const int MADV_SEQUENTIAL = 2;
+        const int MADV_WILLNEED = 3;
+        static readonly IntPtr MAP_FAILED = new IntPtr(-1);
+
+        [DllImport("libc", SetLastError = true)]
+        static extern int open(string fileName, int flags);
+
+        [DllImport("libc", SetLastError = true)]
+        static extern int close(int fd);
+
+        /// <summary>
+        /// offset is off_t, it has the size of a pointer on Linux (32-bit off_t in 32-bit processes).
+        /// </summary>
+        [DllImport("libc", SetLastError = true)]
+        static extern IntPtr mmap(IntPtr addr, UIntPtr length, int prot, int flags, int fd, IntPtr offset);
+
+        [DllImport("libc", SetLastError = true)]
+        static extern int munmap(IntPtr addr, UIntPtr length);
+
+        [DllImport("libc", SetLastError = true)]
+        static extern int madvise(IntPtr addr, UIntPtr length, int advice);
+
+        #endregion
+
+        #region Windows
+
+        const uint GENERIC_READ = 0x80000000;
+        const uint FILE_SHARE_READ = 1;
+        const uint OPEN_EXISTING = 3;
+        const uint FILE_FLAG_SEQUENTIAL_SCAN = 0x08000000;
+        const uint FILE_FLAG_RANDOM_ACCESS = 0x10000000;
+        const uint PAGE_READONLY = 2;
+        const uint PAGE_WRITECOPY = 8;
+        const uint FILE_MAP_COPY = 1;
+        const uint FILE_MAP_READ = 4;
+        static readonly IntPtr INVALID_HANDLE_VALUE = new IntPtr(-1);
+
+        [DllImport("Kernel32.dll", SetLastError = true, CharSet = CharSet.Unicode)]
+        static extern IntPtr CreateFile(string fileName, uint desiredAccess, uint shareMode, IntPtr securityAttributes,
+            uint creationDisposition, uint flagsAndAttributes, IntPtr templateFile);
+
+        [DllImport("Kernel32.dll", SetLastError = true, CharSet = CharSet.Unicode)]
+        static extern IntPtr CreateFileMapping(IntPtr file, IntPtr attributes, uint protect,
+            uint maximumSizeHigh, uint maximumSizeLow, string name);
+
+        [DllImport("Kernel32.dll", SetLastError = true)]
+        static extern IntPtr MapViewOfFile(IntPtr mapping, uint desiredAccess, uint fileOffsetHigh,
+            uint fileOffsetLow, UIntPtr numberOfBytesToMap);
+
+        [DllImport("Kernel32.dll", SetLastError = true)]
+        static extern bool UnmapViewOfFile(IntPtr baseAddress);
+
+        [DllImport("Kernel32.dll", SetLastError = true)]
+        static extern bool CloseHandle(IntPtr handle);
+
+        #endregion
+
+        #endregion
+    }
+}
@@ -32,9 +32,18 @@ namespace ai.lib.utils
             private set;
         }
 
-        public SmartPtr(IntPtr ptr)
+        public SmartPtr(IntPtr ptr) : this(ptr, true)
+        {
+        }
+
+        /// <summary>
+        /// Creates a smart pointer. If isOwner is false, the memory is owned by someone else 
+        /// (for example it is a part of a MappedFile) and will not be freed.
+        /// </summary>
+        public SmartPtr(IntPtr ptr, bool isOwner)
         {
             Ptr = ptr;
+            _isOwner = isOwner;
         }
 
         /// <summary>
@@ -45,7 +54,10 @@ namespace ai.lib.utils
         {
             if (Ptr != IntPtr.Zero)
             {
-                UnmanagedMemory.FreeHGlobal(Ptr);
+                if (_isOwner)
+                {
+                    UnmanagedMemory.FreeHGlobal(Ptr);
+                }
                 Ptr = IntPtr.Zero;
             }
             GC.SuppressFinalize(this);
@@ -105,5 +117,7 @@ namespace ai.lib.utils
         {
             return (UInt64*)p.Ptr;
         }
+
+        private bool _isOwner;
     }
 }
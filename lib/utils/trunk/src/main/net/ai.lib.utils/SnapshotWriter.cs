@@ -0,0 +1,84 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Threading;
+
+namespace ai.lib.utils
+{
+    /// <summary>
+    /// Writes snapshots in a background thread, so that a long computation can continue
+    /// while the snapshot is being written.
+    /// The user freezes the data (makes a copy of everything that will change), 
+    /// then calls Write() with a function writing the frozen copy.
+    /// Only one snapshot is written at a time: Write() and Wait() block until the current one is done,
+    /// so the memory for the frozen copy can be reused.
+    /// </summary>
+    public class SnapshotWriter
+    {
+        #region Public API
+
+        public delegate void WriteDelegate();
+
+        /// <summary>
+        /// Returns true if a snapshot is being written.
+        /// </summary>
+        public bool IsBusy
+        {
+            get { return _thread != null && _thread.IsAlive; }
+        }
+
+        /// <summary>
+        /// Waits for the current snapshot, then starts writing a new one and returns immediately.
+        /// </summary>
+        public void Write(WriteDelegate write)
+        {
+            Wait();
+            _thread = new Thread(() =>
+                                     {
+                                         try
+                                         {
+                                             write();
+                                         }
+                                         catch (Exception e)
+                                         {
+                                             _exception = e;
+                                         }
+                                     });
+            _thread.IsBackground = true;
+            _thread.Priority = ThreadPriority.BelowNormal;
+            _thread.Start();
+        }
+
+        /// <summary>
+        /// Blocks until the current snapshot is written. 
+        /// If writing has failed, throws an ApplicationException with the original exception as the inner one.
+        /// </summary>
+        public void Wait()
+        {
+            if (_thread != null)
+            {
+                _thread.Join();
+                _thread = null;
+            }
+            if (_exception != null)
+            {
+                Exception e = _exception;
+                _exception = null;
+                throw new ApplicationException("Cannot write snapshot", e);
+            }
+        }
+
+        #endregion
+
+        #region Implementation
+
+        Thread _thread;
+        Exception _exception;
+
+        #endregion
+    }
+}
@@ -0,0 +1,104 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using System.IO;
+
+namespace ai.lib.utils.nunit
+{
+    /// <summary>
+    /// Unit tests for MappedFile. 
+    /// </summary>
+    [TestFixture]
+    public unsafe class MappedFile_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_Map()
+        {
+            string fileName = Path.Combine(_outDir, "data.bin");
+            byte[] data = new byte[100000];
+            new Random(1).NextBytes(data);
+            File.WriteAllBytes(fileName, data);
+
+            using (MappedFile mf = new MappedFile(fileName, MappedFileAdvice.Sequential))
+            {
+                Assert.AreEqual(data.Length, mf.Length);
+                for (int i = 0; i < data.Length; ++i)
+                {
+                    Assert.AreEqual(data[i], mf.Ptr[i]);
+                }
+                // Other mappings of the same file see the same data.
+                using (MappedFile mf1 = new MappedFile(fileName, MappedFileAdvice.Random))
+                {
+                    Assert.AreEqual(data[data.Length - 1], mf1.Ptr[data.Length - 1]);
+                }
+            }
+        }
+
+        [Test]
+        public void Test_CopyOnWrite()
+        {
+            string fileName = Path.Combine(_outDir, "cow.bin");
+            byte[] data = new byte[10000];
+            new Random(1).NextBytes(data);
+            File.WriteAllBytes(fileName, data);
+
+            using (MappedFile mf = new MappedFile(fileName, MappedFileAdvice.Normal, true))
+            {
+                Assert.IsTrue(mf.IsCopyOnWrite);
+                for (int i = 0; i < data.Length; ++i)
+                {
+                    Assert.AreEqual(data[i], mf.Ptr[i]);
+                    mf.Ptr[i] = (byte)(data[i] + 1);
+                }
+                mf.Advise(MappedFileAdvice.Sequential);
+                for (int i = 0; i < data.Length; ++i)
+                {
+                    Assert.AreEqual((byte)(data[i] + 1), mf.Ptr[i]);
+                }
+                // Changes are private to the mapping.
+                using (MappedFile mf1 = new MappedFile(fileName))
+                {
+                    Assert.AreEqual(data[0], mf1.Ptr[0]);
+                }
+            }
+            Assert.AreEqual(data, File.ReadAllBytes(fileName));
+        }
+
+        [Test]
+        public void Test_Empty()
+        {
+            string fileName = Path.Combine(_outDir, "empty.bin");
+            File.WriteAllBytes(fileName, new byte[0]);
+            using (MappedFile mf = new MappedFile(fileName))
+            {
+                Assert.AreEqual(0, mf.Length);
+                Assert.IsTrue(mf.Ptr == null);
+            }
+        }
+
+        [Test]
+        [ExpectedException(typeof(FileNotFoundException))]
+        public void Test_NotExisting()
+        {
+            new MappedFile(Path.Combine(_outDir, "not-existing.bin"));
+        }
+
+        #endregion
+
+        #region Benchmarks
+        #endregion
+
+        #region Implementation
+
+        string _outDir = UTHelperPrivate.MakeAndGetTestOutputDir("MappedFile_Test");
+
+        #endregion
+    }
+}
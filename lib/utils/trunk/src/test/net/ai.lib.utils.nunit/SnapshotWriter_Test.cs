@@ -0,0 +1,72 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using System.Threading;
+
+namespace ai.lib.utils.nunit
+{
+    /// <summary>
+    /// Unit tests for SnapshotWriter. 
+    /// </summary>
+    [TestFixture]
+    public class SnapshotWriter_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_Write()
+        {
+            SnapshotWriter sw = new SnapshotWriter();
+            // Nothing to wait for.
+            sw.Wait();
+            List<int> written = new List<int>();
+            for (int i = 0; i < 5; ++i)
+            {
+                int snapshot = i;
+                sw.Write(() =>
+                             {
+                                 Thread.Sleep(20);
+                                 lock (written)
+                                 {
+                                     written.Add(snapshot);
+                                 }
+                             });
+                // The caller is not blocked by the current snapshot.
+                Assert.IsTrue(sw.IsBusy);
+                lock (written)
+                {
+                    // The previous snapshots are done.
+                    Assert.AreEqual(i, written.Count);
+                }
+            }
+            sw.Wait();
+            Assert.IsFalse(sw.IsBusy);
+            Assert.AreEqual(new int[] {0, 1, 2, 3, 4}, written.ToArray());
+        }
+
+        [Test]
+        public void Test_Exception()
+        {
+            SnapshotWriter sw = new SnapshotWriter();
+            sw.Write(() => { throw new InvalidOperationException("test"); });
+            try
+            {
+                sw.Wait();
+                Assert.Fail("Exception expected");
+            }
+            catch (ApplicationException e)
+            {
+                Assert.AreEqual(typeof(InvalidOperationException), e.InnerException.GetType());
+            }
+            // The error is reported once.
+            sw.Wait();
+        }
+
+        #endregion
+    }
+}
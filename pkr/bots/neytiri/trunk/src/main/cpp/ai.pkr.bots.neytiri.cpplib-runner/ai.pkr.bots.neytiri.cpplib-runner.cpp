@@ -0,0 +1,742 @@
+// ai.pkr.bots.neytiri.cpplib-runner.cpp : Tests and benchmarks for ai.pkr.bots.neytiri.cpplib.
+//
+// Usage:
+//   ai.pkr.bots.neytiri.cpplib-runner test [temp-dir]
+//       Runs the tests (on synthetic data, no data files are required).
+//   ai.pkr.bots.neytiri.cpplib-runner benchmark-rollouts <LutEvaluator7.dat> [round] [samples] [streams]
+//       Runs rollouts on a random strategy tree and compares the speed with per-rollout
+//       bucketing (as in MonteCarloStrategyFinder.DoMonteCarlo()).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include "ai.pkr.bots.neytiri.cpplib.h"
+#include "rollout_engine.h"
+#include <ai.lib.utils.cpp/bds_version.h>
+
+using namespace std;
+using namespace ai::pkr::stdpoker;
+using namespace ai::pkr::holdem::strategy::hs;
+using namespace ai::pkr::bots::neytiri;
+
+static string _tempDir = ".";
+
+#define VERIFY(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); throw "Test failed"; }
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// A simple deterministic RNG (the tests must be reproducible).
+class Rng
+{
+public:
+	Rng(uint64_t seed) : _state(seed * 2862933555777941757ULL + 3037000493ULL)
+	{}
+
+	uint32_t Next(uint32_t n)
+	{
+		_state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (uint32_t)((_state >> 33) % n);
+	}
+private:
+	uint64_t _state;
+};
+
+/// Generates n hands of handLength distinct cards.
+static void GenerateHands(Rng & rng, size_t n, int handLength, vector<int32_t> & cards)
+{
+	cards.resize(n * handLength);
+	for(size_t i = 0; i < n; ++i)
+	{
+		uint64_t used = 0;
+		for(int c = 0; c < handLength; ++c)
+		{
+			int32_t card;
+			do
+			{
+				card = (int32_t)rng.Next(52);
+			} while(used & (1ULL << card));
+			used |= 1ULL << card;
+			cards[i * handLength + c] = card;
+		}
+	}
+}
+
+static void WriteInt32(string & s, uint32_t v)
+{
+	s.append((const char*)&v, 4);
+}
+
+static void WriteString(string & s, const string & v)
+{
+	// Strings are short here, 1-byte length prefix.
+	s.push_back((char)v.size());
+	s.append(v);
+}
+
+/// Writes a LUT file in the format of LutEvaluatorGenerator.SaveLut().
+static string WriteLutFile(const char * name, const vector<uint32_t> & lut)
+{
+	string fields;
+	WriteInt32(fields, 1);
+	WriteInt32(fields, 2);
+	WriteInt32(fields, 3);
+	WriteInt32(fields, 4);
+	WriteString(fields, "scm");
+	WriteString(fields, "build");
+	WriteString(fields, "RolloutEngine test data");
+	WriteString(fields, "");
+
+	string file;
+	WriteInt32(file, 5);
+	WriteInt32(file, (uint32_t)fields.size());
+	file += fields;
+	WriteInt32(file, ai::lib::utils::bds_version::crc32(fields.data(), fields.size()));
+	WriteInt32(file, lut_evaluator7::LUT_FILE_FORMAT_ID);
+	WriteInt32(file, (uint32_t)lut.size());
+	file.append((const char*)&lut[0], lut.size() * 4);
+
+	string path = _tempDir + "/" + name;
+	FILE * f = fopen(path.c_str(), "wb");
+	VERIFY(f != 0);
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+	return path;
+}
+
+/** Creates a small order-independent LUT (like a real one, the engine relies on it).
+The state of level l is the sum of random card weights modulo M, the hand value is
+a function of the sum of 7 cards with a small range, so that there are many ties.
+*/
+static string CreateTestLut()
+{
+	Rng rng(1);
+	const uint32_t M = 997;
+	uint32_t weights[52];
+	for(int c = 0; c < 52; ++c)
+	{
+		weights[c] = rng.Next(M);
+	}
+	uint32_t values[M];
+	for(uint32_t s = 0; s < M; ++s)
+	{
+		values[s] = rng.Next(300) + 1;
+	}
+	// Level 0 has one state, levels 1..6 have M states each.
+	vector<uint32_t> lut((1 + 6 * M) * 52);
+	for(int l = 0; l < 7; ++l)
+	{
+		uint32_t stateCount = l == 0 ? 1 : M;
+		for(uint32_t s = 0; s < stateCount; ++s)
+		{
+			uint32_t state = l == 0 ? 0 : 1 + (l - 1) * M + s;
+			for(int c = 0; c < 52; ++c)
+			{
+				uint32_t sum = (s + weights[c]) % M;
+				lut[state * 52 + c] = l < 6 ? 52 * (1 + l * M + sum) : values[sum];
+			}
+		}
+	}
+	return WriteLutFile("RolloutEngine-test.dat", lut);
+}
+
+static const int ROUNDS = 4;
+static const int SHARED_CARDS[ROUNDS] = {0, 3, 1, 1};
+
+/// Game, deal and strategy tree of a test.
+struct TestData
+{
+	int bucketCounts[ROUNDS];
+	vector<uint8_t> preflopBuckets;
+	int round;
+	int32_t pocket[2];
+	int32_t board[5];
+	vector<rollout_engine::node> nodes;
+	vector<int32_t> counts;
+	vector<rollout_engine::path_step> path;
+};
+
+/// Appends random opponent bucket counts for a round, returns the offset.
+static int32_t AddCounts(Rng & rng, TestData & d, int round, uint32_t minCount, uint32_t maxCount)
+{
+	int32_t offset = (int32_t)d.counts.size();
+	for(int b = 0; b < d.bucketCounts[round]; ++b)
+	{
+		d.counts.push_back((int32_t)(minCount + rng.Next(maxCount - minCount + 1)));
+	}
+	return offset;
+}
+
+static void AddNode(Rng & rng, TestData & d, int parent, int round, int depth)
+{
+	rollout_engine::node n;
+	n.parent = parent;
+	n.round = round;
+	n.counts = n.parent_counts = -1;
+	n.subtree_end = 0;
+	n.value = 0;
+	// The opponent acts in the parent in about half of the nodes.
+	if(parent >= 0 && rng.Next(2) == 0)
+	{
+		n.parent_counts = AddCounts(rng, d, round, 0, 5);
+		n.counts = AddCounts(rng, d, round, 0, 5);
+	}
+	const bool isTerminal = depth >= 5 || (depth > 0 && rng.Next(4) == 0);
+	n.kind = isTerminal ? (rng.Next(2) == 0 ? rollout_engine::NODE_FOLD : rollout_engine::NODE_SHOWDOWN) :
+		rollout_engine::NODE_INNER;
+	if(isTerminal)
+	{
+		n.value = n.kind == rollout_engine::NODE_FOLD ? (double)rng.Next(21) - 10 : (double)(rng.Next(20) + 1) / 2;
+	}
+	int index = (int)d.nodes.size();
+	d.nodes.push_back(n);
+	if(isTerminal)
+	{
+		return;
+	}
+	int childrenCount = 1 + rng.Next(3);
+	for(int c = 0; c < childrenCount; ++c)
+	{
+		int childRound = round < ROUNDS - 1 && rng.Next(3) == 0 ? round + 1 : round;
+		AddNode(rng, d, index, childRound, depth + 1);
+	}
+}
+
+static void CreateTestData(Rng & rng, int round, const int * bucketCounts, TestData & d)
+{
+	copy(bucketCounts, bucketCounts + ROUNDS, d.bucketCounts);
+	d.preflopBuckets.resize(hs_engine::POCKET_COUNT);
+	for(int p = 0; p < hs_engine::POCKET_COUNT; ++p)
+	{
+		d.preflopBuckets[p] = (uint8_t)rng.Next(bucketCounts[0]);
+	}
+	d.round = round;
+	vector<int32_t> cards;
+	GenerateHands(rng, 1, 7, cards);
+	copy(cards.begin(), cards.begin() + 2, d.pocket);
+	copy(cards.begin() + 2, cards.end(), d.board);
+	d.nodes.clear();
+	d.counts.clear();
+	d.path.clear();
+	AddNode(rng, d, -1, round, 0);
+	for(int p = 0; p < 3; ++p)
+	{
+		rollout_engine::path_step s;
+		s.round = (int32_t)rng.Next(round + 1);
+		// Some of the rollouts are rejected by zero counts preflop. The postflop buckets of the test LUT
+		// are concentrated around HS 0.5, zero counts there could reject all rollouts.
+		s.counts = AddCounts(rng, d, s.round, s.round == 0 ? 0 : 1, 4);
+		s.next_counts = AddCounts(rng, d, s.round, s.round == 0 ? 0 : 1, 4);
+		d.path.push_back(s);
+	}
+}
+
+static void SetUp(rollout_engine & engine, const TestData & d)
+{
+	VERIFY(engine.set_game(ROUNDS, SHARED_CARDS, d.bucketCounts, &d.preflopBuckets[0]));
+	VERIFY(engine.set_deal(d.round, d.pocket, d.board));
+	VERIFY(engine.set_tree((int)d.nodes.size(), &d.nodes[0], (int)d.counts.size(), &d.counts[0],
+		(int)d.path.size(), &d.path[0]));
+}
+
+/** Reference implementation with one stream, follows MonteCarloStrategyFinder.DoMonteCarlo() (C#):
+buckets are calculated for each rollout from the HS (the HS of each board is calculated once),
+the tree is traversed recursively like in ApplyMonteCarloData.
+*/
+class RolloutRef
+{
+public:
+	RolloutRef(const hs_engine & hs, const TestData & d, bool memoizeRiver) :
+		_hs(hs), _d(d), _memoizeRiver(memoizeRiver)
+	{
+		_values.assign(d.nodes.size(), 0);
+		for(size_t i = 1; i < d.nodes.size(); ++i)
+		{
+			_children[d.nodes[i].parent].push_back((int)i);
+		}
+	}
+
+	void Run(uint64_t samplesCount, uint64_t attemptsCount, uint64_t seed)
+	{
+		int boardSize = 0;
+		for(int r = 0; r <= _d.round; ++r)
+		{
+			boardSize += SHARED_CARDS[r];
+		}
+		const int unknownCount = 5 - boardSize;
+		uint64_t dead = (1ULL << _d.pocket[0]) | (1ULL << _d.pocket[1]);
+		for(int i = 0; i < boardSize; ++i)
+		{
+			dead |= 1ULL << _d.board[i];
+		}
+		int32_t deck[52];
+		int deckSize = 0;
+		for(int c = 0; c < 52; ++c)
+		{
+			if(!(dead & (1ULL << c)))
+			{
+				deck[deckSize++] = c;
+			}
+		}
+		rng_lanes random(seed * 0x2545F4914F6CDD1DULL);
+		uint32_t numbers[512];
+		int pos = 512;
+		_samples = 0;
+		for(_attempts = 0; _samples < samplesCount && _attempts < attemptsCount; ++_attempts)
+		{
+			if(pos + 2 + unknownCount > 512)
+			{
+				random.fill(numbers, 512);
+				pos = 0;
+			}
+			for(int i = 0; i < 2 + unknownCount; ++i)
+			{
+				int j = i + (int)rng_lanes::draw(numbers[pos++], (uint32_t)(deckSize - i));
+				swap(deck[i], deck[j]);
+			}
+			int32_t board[5];
+			copy(_d.board, _d.board + boardSize, board);
+			copy(deck + 2, deck + 2 + unknownCount, board + boardSize);
+			for(int r = 0, size = 0; r < ROUNDS; ++r)
+			{
+				size += SHARED_CARDS[r];
+				if(r == 0)
+				{
+					_buckets[r] = _d.preflopBuckets[hs_engine::pocket_index(deck[0], deck[1])];
+					continue;
+				}
+				float hs = Hs(board, size, deck[0], deck[1], r == 3 && !_memoizeRiver);
+				_buckets[r] = (int)(_d.bucketCounts[r] * hs);
+				if(_buckets[r] == _d.bucketCounts[r])
+				{
+					_buckets[r]--;
+				}
+			}
+			double strategyFactor = 1;
+			for(size_t p = 0; p < _d.path.size(); ++p)
+			{
+				const rollout_engine::path_step & s = _d.path[p];
+				int freq = _d.counts[s.counts + _buckets[s.round]];
+				int nextFreq = _d.counts[s.next_counts + _buckets[s.round]];
+				double coef = freq == 0 ? 0 : (double)nextFreq / freq;
+				strategyFactor *= coef;
+			}
+			if(strategyFactor > 0)
+			{
+				int32_t ourHand[7] = {_d.pocket[0], _d.pocket[1]};
+				int32_t oppHand[7] = {deck[0], deck[1]};
+				copy(board, board + 5, ourHand + 2);
+				copy(board, board + 5, oppHand + 2);
+				uint32_t ourRank = _hs.evaluator().evaluate(ourHand);
+				uint32_t oppRank = _hs.evaluator().evaluate(oppHand);
+				_showdown = ourRank > oppRank ? 1 : (ourRank < oppRank ? -1 : 0);
+				Apply(0, strategyFactor);
+				++_samples;
+			}
+		}
+	}
+
+	vector<double> _values;
+	uint64_t _samples;
+	uint64_t _attempts;
+
+private:
+
+	void Apply(int i, double factor)
+	{
+		const rollout_engine::node & n = _d.nodes[i];
+		if(n.counts >= 0)
+		{
+			int bucket = _buckets[n.round];
+			int parentFreq = _d.counts[n.parent_counts + bucket];
+			int nodeFreq = _d.counts[n.counts + bucket];
+			if(parentFreq != 0)
+			{
+				factor *= (double)nodeFreq / parentFreq;
+			}
+			else
+			{
+				factor = 0;
+			}
+		}
+		if(n.kind != rollout_engine::NODE_INNER)
+		{
+			double value = n.kind == rollout_engine::NODE_SHOWDOWN ? n.value * _showdown : n.value;
+			value *= factor;
+			_values[i] += value;
+		}
+		if(!(factor > 0))
+		{
+			return;
+		}
+		const vector<int> & children = _children[i];
+		for(size_t c = 0; c < children.size(); ++c)
+		{
+			Apply(children[c], factor);
+		}
+	}
+
+	float Hs(const int32_t * board, int boardSize, int c0, int c1, bool enumerate)
+	{
+		vector<int32_t> key(board, board + boardSize);
+		if(enumerate)
+		{
+			vector<float> hs(hs_engine::POCKET_COUNT);
+			_hs.calculate_boards(boardSize, 1, &key[0], &hs[0]);
+			return hs[hs_engine::pocket_index(c0, c1)];
+		}
+		sort(key.begin(), key.end());
+		vector<float> & hs = _hsCache[key];
+		if(hs.empty())
+		{
+			hs.resize(hs_engine::POCKET_COUNT);
+			_hs.calculate_boards(boardSize, 1, &key[0], &hs[0]);
+		}
+		return hs[hs_engine::pocket_index(c0, c1)];
+	}
+
+	const hs_engine & _hs;
+	const TestData & _d;
+	bool _memoizeRiver;
+	map<int, vector<int> > _children;
+	map<vector<int32_t>, vector<float> > _hsCache;
+	int _buckets[ROUNDS];
+	double _showdown;
+};
+
+static const int BUCKET_COUNTS_NEYTIRI[ROUNDS] = {169, 4, 3, 2};
+static const int BUCKET_COUNTS_TEST[ROUNDS] = {7, 5, 9, 8};
+
+/// With one stream the engine must give exactly the values of the reference.
+static void Test_Reference(const string & lutPath, int round, const int * bucketCounts, uint64_t seed)
+{
+	Rng rng(10 + round);
+	TestData d;
+	CreateTestData(rng, round, bucketCounts, d);
+	rollout_engine engine;
+	VERIFY(engine.open(lutPath.c_str(), 1));
+	SetUp(engine, d);
+	hs_engine hs;
+	VERIFY(hs.open(lutPath.c_str()));
+	hs.set_thread_count(1);
+	RolloutRef ref(hs, d, true);
+
+	const uint64_t samplesCount = 300, attemptsCount = 1500;
+	VERIFY(engine.run(samplesCount, attemptsCount, seed, 0));
+	ref.Run(samplesCount, attemptsCount, seed);
+	VERIFY(engine.samples_done() == ref._samples);
+	VERIFY(engine.attempts_done() == ref._attempts);
+	VERIFY(engine.samples_done() > 0);
+	VERIFY(engine.values() == ref._values);
+	bool hasValues = false;
+	for(size_t i = 0; i < ref._values.size(); ++i)
+	{
+		hasValues = hasValues || ref._values[i] != 0;
+	}
+	VERIFY(hasValues);
+}
+
+/// Streams: reproducible, the work is split as requested, runs accumulate.
+static void Test_Streams(const string & lutPath)
+{
+	Rng rng(20);
+	TestData d;
+	CreateTestData(rng, 2, BUCKET_COUNTS_TEST, d);
+	rollout_engine engine;
+	VERIFY(engine.open(lutPath.c_str(), 4));
+	SetUp(engine, d);
+
+	VERIFY(engine.run(1001, 1000000, 5, 0));
+	VERIFY(engine.samples_done() == 1001);
+	vector<double> values1 = engine.values();
+	uint64_t attempts1 = engine.attempts_done();
+
+	// Same seed after a new tree: same values.
+	VERIFY(engine.set_tree((int)d.nodes.size(), &d.nodes[0], (int)d.counts.size(), &d.counts[0],
+		(int)d.path.size(), &d.path[0]));
+	VERIFY(engine.values() == vector<double>(d.nodes.size(), 0));
+	VERIFY(engine.run(1001, 1000000, 5, 0));
+	VERIFY(engine.values() == values1);
+	VERIFY(engine.attempts_done() == attempts1);
+
+	// Another run adds to the values.
+	VERIFY(engine.run(500, 1000000, 6, 0));
+	VERIFY(engine.samples_done() == 1501);
+	bool isChanged = false;
+	for(size_t i = 0; i < values1.size(); ++i)
+	{
+		isChanged = isChanged || engine.values()[i] != values1[i];
+	}
+	VERIFY(isChanged);
+
+	// Limited by attempts.
+	VERIFY(engine.set_deal(d.round, d.pocket, d.board));
+	VERIFY(engine.run(1000000, 999, 7, 0));
+	VERIFY(engine.attempts_done() == 999);
+	VERIFY(engine.samples_done() < 999);
+}
+
+static void Test_TimeLimit(const string & lutPath)
+{
+	Rng rng(30);
+	TestData d;
+	CreateTestData(rng, 1, BUCKET_COUNTS_NEYTIRI, d);
+	rollout_engine engine;
+	VERIFY(engine.open(lutPath.c_str(), 2));
+	SetUp(engine, d);
+	const uint64_t huge = 1ULL << 50;
+	double start = Now();
+	VERIFY(engine.run(huge, huge, 1, 0.05));
+	double time = Now() - start;
+	VERIFY(time < 2);
+	VERIFY(engine.samples_done() > 0 && engine.samples_done() < huge);
+}
+
+/// Buckets of the precomputed tables match the HS of the hand.
+static void Test_Buckets(const string & lutPath)
+{
+	Rng rng(40);
+	TestData d;
+	CreateTestData(rng, 1, BUCKET_COUNTS_TEST, d);
+	rollout_engine engine;
+	VERIFY(engine.open(lutPath.c_str(), 1));
+	SetUp(engine, d);
+	hs_engine hs;
+	VERIFY(hs.open(lutPath.c_str()));
+	for(int i = 0; i < 20; ++i)
+	{
+		// Opponent pocket and turn and river cards.
+		int32_t cards[4];
+		for(int c = 0; c < 4; ++c)
+		{
+			do
+			{
+				cards[c] = (int32_t)rng.Next(52);
+			} while(find(d.pocket, d.pocket + 2, cards[c]) != d.pocket + 2 ||
+				find(d.board, d.board + 3, cards[c]) != d.board + 3 ||
+				find(cards, cards + c, cards[c]) != cards + c);
+		}
+		VERIFY(engine.bucket(0, cards[0], cards[1], cards + 2) ==
+			d.preflopBuckets[hs_engine::pocket_index(cards[0], cards[1])]);
+		for(int r = 1; r < ROUNDS; ++r)
+		{
+			int32_t hand[7] = {cards[0], cards[1], d.board[0], d.board[1], d.board[2], cards[2], cards[3]};
+			float value;
+			hs.calculate(4 + r, 1, hand, &value);
+			int bucket = min((int)(d.bucketCounts[r] * value), d.bucketCounts[r] - 1);
+			VERIFY(engine.bucket(r, cards[0], cards[1], cards + 2) == bucket);
+		}
+	}
+}
+
+static void Test_Errors(const string & lutPath)
+{
+	Rng rng(50);
+	TestData d;
+	CreateTestData(rng, 1, BUCKET_COUNTS_TEST, d);
+	rollout_engine engine;
+	VERIFY(!engine.open(lutPath.c_str(), 0));
+	VERIFY(engine.open(lutPath.c_str(), 1));
+	VERIFY(!engine.set_deal(1, d.pocket, d.board));
+
+	const int sharedCards4[ROUNDS] = {0, 3, 1, 0};
+	VERIFY(!engine.set_game(ROUNDS, sharedCards4, d.bucketCounts, &d.preflopBuckets[0]));
+	const int tooManyBuckets[ROUNDS] = {7, 300, 9, 8};
+	VERIFY(!engine.set_game(ROUNDS, SHARED_CARDS, tooManyBuckets, &d.preflopBuckets[0]));
+	VERIFY(engine.set_game(ROUNDS, SHARED_CARDS, d.bucketCounts, &d.preflopBuckets[0]));
+
+	// Preflop: 5 unknown board cards.
+	VERIFY(!engine.set_deal(0, d.pocket, d.board));
+	VERIFY(strstr(engine.error().c_str(), "unknown board cards") != 0);
+	int32_t badBoard[5] = {d.board[0], d.board[0], d.board[1]};
+	VERIFY(!engine.set_deal(1, d.pocket, badBoard));
+	VERIFY(!engine.run(1, 1, 1, 0));
+	VERIFY(engine.set_deal(1, d.pocket, d.board));
+	VERIFY(!engine.run(1, 1, 1, 0));
+
+	// Not in preorder: node 3 is a child of node 1, but node 2 (child of 0) is in between.
+	vector<rollout_engine::node> nodes(4, d.nodes[0]);
+	for(size_t i = 0; i < nodes.size(); ++i)
+	{
+		nodes[i].counts = nodes[i].parent_counts = -1;
+		nodes[i].kind = rollout_engine::NODE_INNER;
+	}
+	nodes[1].parent = 0;
+	nodes[2].parent = 0;
+	nodes[3].parent = 1;
+	VERIFY(!engine.set_tree(4, &nodes[0], 0, 0, 0, 0));
+	VERIFY(strstr(engine.error().c_str(), "preorder") != 0);
+	nodes[3].parent = 2;
+	VERIFY(engine.set_tree(4, &nodes[0], 0, 0, 0, 0));
+	nodes[3].counts = 0;
+	nodes[3].parent_counts = 0;
+	VERIFY(!engine.set_tree(4, &nodes[0], 0, 0, 0, 0));
+
+	// Path in a future round.
+	VERIFY(engine.set_tree((int)d.nodes.size(), &d.nodes[0], (int)d.counts.size(), &d.counts[0],
+		(int)d.path.size(), &d.path[0]));
+	vector<rollout_engine::path_step> path(1, d.path[0]);
+	path[0].round = 2;
+	path[0].counts = path[0].next_counts = 0;
+	VERIFY(engine.set_tree((int)d.nodes.size(), &d.nodes[0], (int)d.counts.size(), &d.counts[0], 1, &path[0]));
+	VERIFY(!engine.run(1, 1, 1, 0));
+}
+
+/// C interface gives the same results as the engine.
+static void Test_CApi(const string & lutPath)
+{
+	VERIFY(RolloutEngine_Open((_tempDir + "/no-such-file.dat").c_str(), 1) == 0);
+	VERIFY(strstr(RolloutEngine_GetLastError(), "no-such-file.dat") != 0);
+
+	Rng rng(60);
+	TestData d;
+	CreateTestData(rng, 2, BUCKET_COUNTS_NEYTIRI, d);
+	rollout_engine engine;
+	VERIFY(engine.open(lutPath.c_str(), 3));
+	SetUp(engine, d);
+	VERIFY(engine.run(700, 7000, 8, 0));
+
+	RolloutEngine * e = RolloutEngine_Open(lutPath.c_str(), 3);
+	VERIFY(e != 0);
+	VERIFY(RolloutEngine_SetGame(e, ROUNDS, SHARED_CARDS, d.bucketCounts, &d.preflopBuckets[0]));
+	VERIFY(RolloutEngine_SetDeal(e, d.round, d.pocket, d.board));
+	vector<int32_t> nodes;
+	vector<double> nodeValues;
+	for(size_t i = 0; i < d.nodes.size(); ++i)
+	{
+		const rollout_engine::node & n = d.nodes[i];
+		int32_t fields[5] = {n.parent, n.round, n.kind, n.counts, n.parent_counts};
+		nodes.insert(nodes.end(), fields, fields + 5);
+		nodeValues.push_back(n.value);
+	}
+	vector<int32_t> path;
+	for(size_t i = 0; i < d.path.size(); ++i)
+	{
+		int32_t fields[3] = {d.path[i].round, d.path[i].counts, d.path[i].next_counts};
+		path.insert(path.end(), fields, fields + 3);
+	}
+	VERIFY(RolloutEngine_SetTree(e, (int)d.nodes.size(), &nodes[0], &nodeValues[0], (int)d.counts.size(), &d.counts[0],
+		(int)d.path.size(), &path[0]));
+	VERIFY(RolloutEngine_Run(e, 700, 7000, 8, 0));
+	VERIFY(RolloutEngine_GetSamplesDone(e) == engine.samples_done());
+	VERIFY(RolloutEngine_GetAttemptsDone(e) == engine.attempts_done());
+	vector<double> values(d.nodes.size() + 1, 5);
+	RolloutEngine_GetValues(e, &values[0]);
+	VERIFY(values[d.nodes.size()] == 5);
+	values.pop_back();
+	VERIFY(values == engine.values());
+
+	VERIFY(!RolloutEngine_SetDeal(e, 0, d.pocket, d.board));
+	VERIFY(strstr(RolloutEngine_GetLastError(), "unknown board cards") != 0);
+	RolloutEngine_Close(e);
+}
+
+static int Test()
+{
+	try
+	{
+		string lutPath = CreateTestLut();
+		for(int round = 1; round < ROUNDS; ++round)
+		{
+			Test_Reference(lutPath, round, BUCKET_COUNTS_NEYTIRI, 1);
+			Test_Reference(lutPath, round, BUCKET_COUNTS_TEST, 2);
+		}
+		Test_Streams(lutPath);
+		Test_TimeLimit(lutPath);
+		Test_Buckets(lutPath);
+		Test_Errors(lutPath);
+		Test_CApi(lutPath);
+		remove(lutPath.c_str());
+	}
+	catch(const char * e)
+	{
+		printf("%s\n", e);
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+
+static int Benchmark_Rollouts(const char * path, int round, uint64_t samplesCount, int streamsCount)
+{
+	rollout_engine engine;
+	if(!engine.open(path, streamsCount))
+	{
+		printf("%s\n", engine.error().c_str());
+		return 1;
+	}
+	Rng rng(1);
+	TestData d;
+	// A tree of a realistic size.
+	do
+	{
+		CreateTestData(rng, round, BUCKET_COUNTS_NEYTIRI, d);
+	} while(d.nodes.size() < 30);
+	// No rejections, so that the numbers of rollouts are comparable.
+	d.path.clear();
+	VERIFY(engine.set_game(ROUNDS, SHARED_CARDS, d.bucketCounts, &d.preflopBuckets[0]));
+	double start = Now();
+	if(!engine.set_deal(round, d.pocket, d.board))
+	{
+		printf("%s\n", engine.error().c_str());
+		return 1;
+	}
+	double dealTime = Now() - start;
+	VERIFY(engine.set_tree((int)d.nodes.size(), &d.nodes[0], (int)d.counts.size(), &d.counts[0], 0, 0));
+	start = Now();
+	VERIFY(engine.run(samplesCount, samplesCount, 1, 0));
+	double runTime = Now() - start;
+	printf("engine:    round %d, %d nodes, %d streams, buckets %.3f s, %llu rollouts %.3f s, %.0f rollouts/s\n",
+		round, (int)d.nodes.size(), streamsCount, dealTime, (unsigned long long)samplesCount, runTime,
+		samplesCount / runTime);
+
+	// The HS of the river is enumerated for each rollout, as in the managed version.
+	hs_engine hs;
+	VERIFY(hs.open(path));
+	hs.set_thread_count(1);
+	RolloutRef ref(hs, d, false);
+	uint64_t refCount = max<uint64_t>(samplesCount / 1000, 100);
+	start = Now();
+	ref.Run(refCount, refCount, 1);
+	double refTime = Now() - start;
+	printf("per-rollout: %llu rollouts %.3f s, %.0f rollouts/s\n", (unsigned long long)refCount, refTime,
+		refCount / refTime);
+	printf("Speedup: %.1f\n", (samplesCount / runTime) / (refCount / refTime));
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "test") == 0)
+	{
+		if(argc >= 3)
+		{
+			_tempDir = argv[2];
+		}
+		return Test();
+	}
+	if(argc >= 3 && strcmp(argv[1], "benchmark-rollouts") == 0)
+	{
+		try
+		{
+			return Benchmark_Rollouts(argv[2], argc >= 4 ? atoi(argv[3]) : 1,
+				argc >= 5 ? (uint64_t)atoll(argv[4]) : 1000000, argc >= 6 ? atoi(argv[5]) : 4);
+		}
+		catch(const char * e)
+		{
+			printf("%s\n", e);
+			return 1;
+		}
+	}
+	printf("Usage:\n"
+		"%s test [temp-dir]\n"
+		"%s benchmark-rollouts LutEvaluator7.dat [round] [samples] [streams]\n", argv[0], argv[0]);
+	return 1;
+}
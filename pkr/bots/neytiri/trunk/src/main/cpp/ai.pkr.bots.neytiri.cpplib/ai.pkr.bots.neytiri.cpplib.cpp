@@ -0,0 +1,152 @@
+// ai.pkr.bots.neytiri.cpplib.cpp : Defines the exported functions of the library.
+//
+
+#include <string>
+#include <vector>
+#include "ai.pkr.bots.neytiri.cpplib.h"
+#include "rollout_engine.h"
+
+using namespace ai::pkr::bots::neytiri;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL char _lastError[256];
+
+static void SetError(const std::string & error)
+{
+	std::size_t length = error.copy(_lastError, sizeof(_lastError) - 1);
+	_lastError[length] = 0;
+}
+
+struct RolloutEngine
+{
+	rollout_engine engine;
+};
+
+extern "C"
+{
+
+AIPKRBOTSNEYTIRICPPLIB_API RolloutEngine * RolloutEngine_Open(const char * lutPath, int streamsCount)
+{
+	RolloutEngine * e = new RolloutEngine;
+	if(!e->engine.open(lutPath, streamsCount))
+	{
+		SetError(e->engine.error());
+		delete e;
+		return 0;
+	}
+	return e;
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API void RolloutEngine_Close(RolloutEngine * e)
+{
+	delete e;
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API const char * RolloutEngine_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API int RolloutEngine_SetGame(RolloutEngine * e, int roundsCount, const int32_t * sharedCards,
+	const int32_t * bucketCounts, const uint8_t * preflopBuckets)
+{
+	if(roundsCount < 1 || roundsCount > rollout_engine::MAX_ROUNDS)
+	{
+		SetError("unsupported number of rounds");
+		return 0;
+	}
+	int shared[rollout_engine::MAX_ROUNDS], buckets[rollout_engine::MAX_ROUNDS];
+	for(int r = 0; r < roundsCount; ++r)
+	{
+		shared[r] = sharedCards[r];
+		buckets[r] = bucketCounts[r];
+	}
+	if(!e->engine.set_game(roundsCount, shared, buckets, preflopBuckets))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API int RolloutEngine_SetDeal(RolloutEngine * e, int round, const int32_t * pocket,
+	const int32_t * board)
+{
+	if(!e->engine.set_deal(round, pocket, board))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API int RolloutEngine_SetTree(RolloutEngine * e, int nodesCount, const int32_t * nodes,
+	const double * nodeValues, int countsSize, const int32_t * counts, int pathLength, const int32_t * path)
+{
+	if(nodesCount < 1 || pathLength < 0 || countsSize < 0)
+	{
+		SetError("bad tree size");
+		return 0;
+	}
+	std::vector<rollout_engine::node> n(nodesCount);
+	for(int i = 0; i < nodesCount; ++i)
+	{
+		n[i].parent = nodes[5 * i];
+		n[i].round = nodes[5 * i + 1];
+		n[i].kind = nodes[5 * i + 2];
+		n[i].counts = nodes[5 * i + 3];
+		n[i].parent_counts = nodes[5 * i + 4];
+		n[i].subtree_end = 0;
+		n[i].value = nodeValues[i];
+	}
+	std::vector<rollout_engine::path_step> p(pathLength);
+	for(int i = 0; i < pathLength; ++i)
+	{
+		p[i].round = path[3 * i];
+		p[i].counts = path[3 * i + 1];
+		p[i].next_counts = path[3 * i + 2];
+	}
+	if(!e->engine.set_tree(nodesCount, &n[0], countsSize, counts, pathLength, p.empty() ? 0 : &p[0]))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API int RolloutEngine_Run(RolloutEngine * e, uint64_t samplesCount, uint64_t attemptsCount,
+	uint64_t seed, double timeLimit)
+{
+	if(!e->engine.run(samplesCount, attemptsCount, seed, timeLimit))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API uint64_t RolloutEngine_GetSamplesDone(const RolloutEngine * e)
+{
+	return e->engine.samples_done();
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API uint64_t RolloutEngine_GetAttemptsDone(const RolloutEngine * e)
+{
+	return e->engine.attempts_done();
+}
+
+AIPKRBOTSNEYTIRICPPLIB_API void RolloutEngine_GetValues(const RolloutEngine * e, double * values)
+{
+	const std::vector<double> & v = e->engine.values();
+	for(std::size_t i = 0; i < v.size(); ++i)
+	{
+		values[i] = v[i];
+	}
+}
+
+}
@@ -0,0 +1,91 @@
+// C interface of ai.pkr.bots.neytiri.cpplib (ai.pkr.bots.neytiri.cpplib.dll on Windows,
+// libai.pkr.bots.neytiri.cpplib.so on Linux). Used by ai.pkr.bots.neytiri.CppLib (C#).
+//
+// All files within this library are compiled with the AIPKRBOTSNEYTIRICPPLIB_EXPORTS
+// symbol defined. This symbol should not be defined on any project
+// that uses this library. This way any other project whose source files include
+// this file see AIPKRBOTSNEYTIRICPPLIB_API functions as being imported, whereas the library
+// sees symbols defined with this macro as being exported.
+
+#ifndef AI_PKR_BOTS_NEYTIRI_CPPLIB_H
+#define AI_PKR_BOTS_NEYTIRI_CPPLIB_H
+
+#if defined(_WIN32)
+	#ifdef AIPKRBOTSNEYTIRICPPLIB_EXPORTS
+		#define AIPKRBOTSNEYTIRICPPLIB_API __declspec(dllexport)
+	#else
+		#define AIPKRBOTSNEYTIRICPPLIB_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AIPKRBOTSNEYTIRICPPLIB_API __attribute__((visibility("default")))
+#else
+	#define AIPKRBOTSNEYTIRICPPLIB_API
+#endif
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Opaque handle of a Monte-Carlo rollout engine.
+typedef struct RolloutEngine RolloutEngine;
+
+/// Number of 2-card pockets, pocket (c0 < c1) has index c1*(c1-1)/2 + c0.
+#define ROLLOUT_ENGINE_POCKET_COUNT 1326
+
+/// Values of the 3rd int of a node in RolloutEngine_SetTree().
+#define ROLLOUT_ENGINE_NODE_INNER 0
+#define ROLLOUT_ENGINE_NODE_FOLD 1
+#define ROLLOUT_ENGINE_NODE_SHOWDOWN 2
+
+/// Creates an engine using LutEvaluator7.dat. The rollouts are split into streamsCount streams
+/// running in parallel (the thread pool of the engine), the result is reproducible for the same
+/// seed and streamsCount if there is no time limit.
+/// Returns 0 on error, see RolloutEngine_GetLastError().
+AIPKRBOTSNEYTIRICPPLIB_API RolloutEngine * RolloutEngine_Open(const char * lutPath, int streamsCount);
+
+AIPKRBOTSNEYTIRICPPLIB_API void RolloutEngine_Close(RolloutEngine * e);
+
+/// Description of the last error in this thread.
+AIPKRBOTSNEYTIRICPPLIB_API const char * RolloutEngine_GetLastError();
+
+/// Sets up the game: sharedCards[r] and bucketCounts[r] for each round, the preflop bucket of each pocket
+/// (ROLLOUT_ENGINE_POCKET_COUNT entries). Returns 0 on error.
+AIPKRBOTSNEYTIRICPPLIB_API int RolloutEngine_SetGame(RolloutEngine * e, int roundsCount, const int32_t * sharedCards,
+	const int32_t * bucketCounts, const uint8_t * preflopBuckets);
+
+/// Sets our pocket (2 cards) and the board known in the round, precomputes the bucket tables.
+/// Returns 0 on error.
+AIPKRBOTSNEYTIRICPPLIB_API int RolloutEngine_SetDeal(RolloutEngine * e, int round, const int32_t * pocket,
+	const int32_t * board);
+
+/// Sets the subtree of the current node in preorder. Node i is nodes[5*i .. 5*i+4]:
+/// parent (-1 for the root), round, kind (ROLLOUT_ENGINE_NODE_...), offset of the opponent bucket counts of the node
+/// and of its parent in counts if the opponent acted in the parent (-1 otherwise); nodeValues[i] is the value
+/// of a terminal node (fold: our win, showdown: our win if we win the showdown).
+/// The strategy path to the current node contains pathLength opponent actions, action i is path[3*i .. 3*i+2]:
+/// round, offset of the bucket counts of the node where the opponent acts and of the next node.
+/// Returns 0 on error.
+AIPKRBOTSNEYTIRICPPLIB_API int RolloutEngine_SetTree(RolloutEngine * e, int nodesCount, const int32_t * nodes,
+	const double * nodeValues, int countsSize, const int32_t * counts, int pathLength, const int32_t * path);
+
+/// Runs rollouts until samplesCount of them have a non-zero strategy factor, or attemptsCount rollouts
+/// are done, or timeLimit seconds are over (0: no limit). Returns 0 on error.
+AIPKRBOTSNEYTIRICPPLIB_API int RolloutEngine_Run(RolloutEngine * e, uint64_t samplesCount, uint64_t attemptsCount,
+	uint64_t seed, double timeLimit);
+
+/// Number of samples (rollouts with a non-zero strategy factor) since the last deal or tree.
+AIPKRBOTSNEYTIRICPPLIB_API uint64_t RolloutEngine_GetSamplesDone(const RolloutEngine * e);
+
+/// Number of rollouts since the last deal or tree.
+AIPKRBOTSNEYTIRICPPLIB_API uint64_t RolloutEngine_GetAttemptsDone(const RolloutEngine * e);
+
+/// Stores the sum of values of each node over all samples to values[0..nodesCount-1].
+AIPKRBOTSNEYTIRICPPLIB_API void RolloutEngine_GetValues(const RolloutEngine * e, double * values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include "rollout_engine.h"
+
+using namespace ai::pkr::holdem::strategy::hs;
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace bots
+		{
+			namespace neytiri
+			{
+
+				static double Now()
+				{
+					return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+				}
+
+				bool rollout_engine::open(const char * lut_path, int streams_count)
+				{
+					if(streams_count < 1)
+					{
+						return fail("the number of streams must be positive");
+					}
+					if(!_hs.open(lut_path))
+					{
+						return fail(_hs.error());
+					}
+					_hs.set_thread_count(streams_count);
+					_streams_count = streams_count;
+					_streams.clear();
+					_streams.resize(streams_count);
+					return true;
+				}
+
+				bool rollout_engine::set_game(int rounds_count, const int * shared_cards, const int * bucket_counts,
+					const uint8_t * preflop_buckets)
+				{
+					_rounds_count = 0;
+					_round = -1;
+					if(rounds_count < 1 || rounds_count > MAX_ROUNDS)
+					{
+						return fail("unsupported number of rounds");
+					}
+					if(shared_cards[0] != 0)
+					{
+						return fail("board cards preflop are not supported");
+					}
+					int boardSize = 0;
+					for(int r = 0; r < rounds_count; ++r)
+					{
+						if(bucket_counts[r] < 1 || bucket_counts[r] > 256)
+						{
+							return fail("the number of buckets must be in 1..256");
+						}
+						_shared_cards[r] = shared_cards[r];
+						_bucket_counts[r] = bucket_counts[r];
+						boardSize += shared_cards[r];
+					}
+					if(boardSize != 5)
+					{
+						return fail("showdown requires 7-card hands (2 pocket and 5 board cards)");
+					}
+					_preflop_buckets.assign(preflop_buckets, preflop_buckets + POCKET_COUNT);
+					for(int p = 0; p < POCKET_COUNT; ++p)
+					{
+						if(_preflop_buckets[p] >= bucket_counts[0])
+						{
+							return fail("bad preflop bucket");
+						}
+					}
+					_rounds_count = rounds_count;
+					return true;
+				}
+
+				bool rollout_engine::set_deal(int round, const int32_t * pocket, const int32_t * board)
+				{
+					_round = -1;
+					if(_rounds_count == 0)
+					{
+						return fail("the game is not set");
+					}
+					if(round < 0 || round >= _rounds_count)
+					{
+						return fail("bad round");
+					}
+					_board_size = 0;
+					for(int r = 0; r <= round; ++r)
+					{
+						_board_size += _shared_cards[r];
+					}
+					uint64_t dead = 0;
+					for(int i = 0; i < 2 + _board_size; ++i)
+					{
+						int32_t card = i < 2 ? pocket[i] : board[i - 2];
+						if(card < 0 || card >= 52 || (dead & (1ULL << card)))
+						{
+							return fail("bad or duplicate card");
+						}
+						dead |= 1ULL << card;
+					}
+					_pocket[0] = pocket[0];
+					_pocket[1] = pocket[1];
+					std::copy(board, board + _board_size, _board);
+					_board_state = 0;
+					for(int i = 0; i < _board_size; ++i)
+					{
+						_board_state = _hs.evaluator().entry(_board_state + _board[i]);
+					}
+					_deck.clear();
+					for(int32_t c = 0; c < 52; ++c)
+					{
+						if(!(dead & (1ULL << c)))
+						{
+							_deck.push_back(c);
+						}
+					}
+					for(int r = 0, size = 0; r < _rounds_count; ++r)
+					{
+						size += _shared_cards[r];
+						_unknown_cards[r] = std::max(size - _board_size, 0);
+						if(_unknown_cards[r] > 2)
+						{
+							std::ostringstream os;
+							os << "too many unknown board cards in round " << r << " to precompute the buckets";
+							return fail(os.str());
+						}
+					}
+					_round = round;
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						calculate_buckets(r);
+					}
+					_values.assign(_nodes.size(), 0);
+					_samples_done = 0;
+					_attempts_done = 0;
+					return true;
+				}
+
+				void rollout_engine::calculate_buckets(int round)
+				{
+					std::vector<uint8_t> & table = _buckets[round];
+					if(round == 0)
+					{
+						table = _preflop_buckets;
+						return;
+					}
+					int boardSize = 0;
+					for(int r = 0; r <= round; ++r)
+					{
+						boardSize += _shared_cards[r];
+					}
+					const int unknown = _unknown_cards[round];
+					const int known = boardSize - unknown;
+					const int deckSize = (int)_deck.size();
+
+					// All boards of the round with their table indexes.
+					std::vector<int32_t> boards;
+					std::vector<int32_t> tableIndexes;
+					int32_t future[2];
+					int32_t ids[2] = {0, 1};
+					for(;;)
+					{
+						for(int i = 0; i < unknown; ++i)
+						{
+							future[i] = _deck[ids[i]];
+						}
+						boards.insert(boards.end(), _board, _board + known);
+						boards.insert(boards.end(), future, future + unknown);
+						tableIndexes.push_back(table_index(round, future));
+						// Next combination of the unknown cards.
+						int i = unknown - 1;
+						while(i >= 0 && ids[i] == deckSize - unknown + i)
+						{
+							--i;
+						}
+						if(i < 0)
+						{
+							break;
+						}
+						++ids[i];
+						for(int j = i + 1; j < unknown; ++j)
+						{
+							ids[j] = ids[j - 1] + 1;
+						}
+					}
+					const std::size_t boardCount = tableIndexes.size();
+					std::vector<float> hs(boardCount * POCKET_COUNT);
+					_hs.calculate_boards(boardSize, boardCount, &boards[0], &hs[0]);
+
+					table.assign((std::size_t)POCKET_COUNT * (unknown == 0 ? 1 : (unknown == 1 ? 52 : POCKET_COUNT)), 0);
+					const int bucketCount = _bucket_counts[round];
+					for(std::size_t b = 0; b < boardCount; ++b)
+					{
+						const float * boardHs = &hs[b * POCKET_COUNT];
+						uint8_t * buckets = &table[tableIndexes[b]];
+						for(int p = 0; p < POCKET_COUNT; ++p)
+						{
+							// Like Bucketizer.GetBucket(), pockets intersecting the board (HS -1) are never dealt.
+							int bucket = (int)(bucketCount * boardHs[p]);
+							buckets[p] = (uint8_t)std::max(std::min(bucket, bucketCount - 1), 0);
+						}
+					}
+				}
+
+				bool rollout_engine::set_tree(int nodes_count, const node * nodes, int counts_size, const int32_t * counts,
+					int path_length, const path_step * path)
+				{
+					_nodes.clear();
+					_path.clear();
+					if(_rounds_count == 0)
+					{
+						return fail("the game is not set");
+					}
+					if(nodes_count < 1 || nodes[0].parent != -1 || nodes[0].counts != -1)
+					{
+						return fail("bad root node");
+					}
+					_nodes.assign(nodes, nodes + nodes_count);
+					_counts.assign(counts, counts + counts_size);
+					_path.assign(path, path + path_length);
+
+					// Check the preorder: the parent of a node is the previous node or one of its ancestors.
+					std::vector<int32_t> ancestors;
+					for(int i = 0; i < nodes_count; ++i)
+					{
+						node & n = _nodes[i];
+						while(!ancestors.empty() && ancestors.back() != n.parent)
+						{
+							_nodes[ancestors.back()].subtree_end = i;
+							ancestors.pop_back();
+						}
+						if(i > 0 && ancestors.empty())
+						{
+							_nodes.clear();
+							return fail("nodes are not in preorder");
+						}
+						ancestors.push_back(i);
+						const bool isRoundOk = n.round >= 0 && n.round < _rounds_count;
+						const bool isCountsOk = n.counts == -1 ? n.parent_counts == -1 :
+							isRoundOk && n.counts >= 0 && n.parent_counts >= 0 &&
+							n.counts + _bucket_counts[n.round] <= counts_size &&
+							n.parent_counts + _bucket_counts[n.round] <= counts_size;
+						if(!isRoundOk || !isCountsOk || n.kind < NODE_INNER || n.kind > NODE_SHOWDOWN)
+						{
+							_nodes.clear();
+							std::ostringstream os;
+							os << "bad node " << i;
+							return fail(os.str());
+						}
+					}
+					for(; !ancestors.empty(); ancestors.pop_back())
+					{
+						_nodes[ancestors.back()].subtree_end = nodes_count;
+					}
+					for(int i = 0; i < path_length; ++i)
+					{
+						const path_step & s = _path[i];
+						if(s.round < 0 || s.round >= _rounds_count || s.counts < 0 || s.next_counts < 0 ||
+							s.counts + _bucket_counts[s.round] > counts_size ||
+							s.next_counts + _bucket_counts[s.round] > counts_size)
+						{
+							_nodes.clear();
+							_path.clear();
+							std::ostringstream os;
+							os << "bad path step " << i;
+							return fail(os.str());
+						}
+					}
+					_values.assign(_nodes.size(), 0);
+					_samples_done = 0;
+					_attempts_done = 0;
+					return true;
+				}
+
+				bool rollout_engine::run(uint64_t samples_count, uint64_t attempts_count, uint64_t seed, double time_limit)
+				{
+					if(_round < 0)
+					{
+						return fail("the deal is not set");
+					}
+					if(_nodes.empty())
+					{
+						return fail("the tree is not set");
+					}
+					for(int p = 0; p < (int)_path.size(); ++p)
+					{
+						if(_path[p].round > _round)
+						{
+							return fail("the strategy path is in a future round");
+						}
+					}
+					const double deadline = time_limit > 0 ? Now() + time_limit : 0;
+					const int streamsCount = _streams_count;
+					for(int s = 0; s < streamsCount; ++s)
+					{
+						stream & st = _streams[s];
+						st.random = rng_lanes(seed * 0x2545F4914F6CDD1DULL + s);
+						st.values.assign(_nodes.size(), 0);
+						st.factors.resize(_nodes.size());
+						st.samples = 0;
+						st.attempts = 0;
+					}
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(streamsCount)
+#endif
+					for(int s = 0; s < streamsCount; ++s)
+					{
+						run_stream(_streams[s],
+							samples_count * (s + 1) / streamsCount - samples_count * s / streamsCount,
+							attempts_count * (s + 1) / streamsCount - attempts_count * s / streamsCount,
+							deadline);
+					}
+					// Merge in a fixed order, so that the result does not depend on the threads.
+					for(int s = 0; s < streamsCount; ++s)
+					{
+						const stream & st = _streams[s];
+						for(std::size_t i = 0; i < _values.size(); ++i)
+						{
+							_values[i] += st.values[i];
+						}
+						_samples_done += st.samples;
+						_attempts_done += st.attempts;
+					}
+					return true;
+				}
+
+				void rollout_engine::run_stream(stream & s, uint64_t samples_count, uint64_t attempts_count, double deadline) const
+				{
+					const ai::pkr::stdpoker::lut_evaluator7 & lut = _hs.evaluator();
+					const int deckSize = (int)_deck.size();
+					const int unknownCount = _unknown_cards[_rounds_count - 1];
+					const int dealCount = 2 + unknownCount;
+					const node * nodes = &_nodes[0];
+					const int nodesCount = (int)_nodes.size();
+					const int32_t * counts = &_counts[0];
+					double * values = &s.values[0];
+					double * factors = &s.factors[0];
+					const uint8_t * buckets[MAX_ROUNDS];
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						buckets[r] = &_buckets[r][0];
+					}
+
+					int32_t deck[52];
+					std::copy(_deck.begin(), _deck.end(), deck);
+					uint32_t random[RANDOM_BLOCK];
+					int randomPos = RANDOM_BLOCK;
+					int oppBuckets[MAX_ROUNDS];
+
+					for(; s.samples < samples_count && s.attempts < attempts_count; ++s.attempts)
+					{
+						if(deadline > 0 && s.attempts % DEADLINE_CHECK == 0 && Now() >= deadline)
+						{
+							break;
+						}
+						if(randomPos + dealCount > RANDOM_BLOCK)
+						{
+							s.random.fill(random, RANDOM_BLOCK);
+							randomPos = 0;
+						}
+						// Partial Fisher-Yates shuffle: opponent pocket, then the unknown board cards.
+						for(int i = 0; i < dealCount; ++i)
+						{
+							int j = i + (int)rng_lanes::draw(random[randomPos++], (uint32_t)(deckSize - i));
+							std::swap(deck[i], deck[j]);
+						}
+						const int pocketIndex = holdem::strategy::hs::hs_engine::pocket_index(deck[0], deck[1]);
+						for(int r = 0; r < _rounds_count; ++r)
+						{
+							oppBuckets[r] = buckets[r][table_index(r, deck + 2) + pocketIndex];
+						}
+
+						double strategyFactor = 1;
+						for(std::size_t p = 0; p < _path.size(); ++p)
+						{
+							const path_step & step = _path[p];
+							const int bucket = oppBuckets[step.round];
+							const int32_t freq = counts[step.counts + bucket];
+							strategyFactor *= freq == 0 ? 0 : (double)counts[step.next_counts + bucket] / freq;
+						}
+						if(!(strategyFactor > 0))
+						{
+							continue;
+						}
+						++s.samples;
+
+						// Showdown, the board part of the LUT chain is shared.
+						uint32_t boardState = _board_state;
+						for(int i = 0; i < unknownCount; ++i)
+						{
+							boardState = lut.entry(boardState + deck[2 + i]);
+						}
+						const uint32_t ourRank = lut.entry(lut.entry(boardState + _pocket[0]) + _pocket[1]);
+						const uint32_t oppRank = lut.entry(lut.entry(boardState + deck[0]) + deck[1]);
+						const double showdown = ourRank > oppRank ? 1 : (ourRank < oppRank ? -1 : 0);
+
+						// Subtree in preorder, subtrees with zero factor are skipped.
+						for(int i = 0; i < nodesCount; )
+						{
+							const node & n = nodes[i];
+							double factor = i == 0 ? strategyFactor : factors[n.parent];
+							if(n.counts >= 0)
+							{
+								const int bucket = oppBuckets[n.round];
+								const int32_t parentFreq = counts[n.parent_counts + bucket];
+								factor = parentFreq != 0 ? factor * ((double)counts[n.counts + bucket] / parentFreq) : 0;
+							}
+							factors[i] = factor;
+							if(n.kind == NODE_FOLD)
+							{
+								values[i] += n.value * factor;
+							}
+							else if(n.kind == NODE_SHOWDOWN)
+							{
+								values[i] += n.value * showdown * factor;
+							}
+							i = factor > 0 ? i + 1 : n.subtree_end;
+						}
+					}
+				}
+
+				bool rollout_engine::fail(const std::string & error)
+				{
+					_error = error;
+					return false;
+				}
+
+			}
+		}
+	}
+}
@@ -0,0 +1,291 @@
+#ifndef AI_PKR_BOTS_NEYTIRI_CPPLIB_ROLLOUT_ENGINE_H
+#define AI_PKR_BOTS_NEYTIRI_CPPLIB_ROLLOUT_ENGINE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <hs_engine.h>
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace bots
+		{
+			namespace neytiri
+			{
+
+				/** xoshiro128+ generators in LANES independent lanes, seeded by splitmix64.
+				fill() advances all lanes in an inner loop over the lanes (32-bit adds, xors and shifts),
+				which the compiler vectorizes. Only the high bits are used (see draw()),
+				so the weak low bits of xoshiro128+ do not matter.
+				*/
+				class rng_lanes
+				{
+				public:
+					static const int LANES = 8;
+
+					explicit rng_lanes(uint64_t seed = 0)
+					{
+						for(int l = 0; l < LANES; ++l)
+						{
+							uint64_t a = splitmix64(seed);
+							uint64_t b = splitmix64(seed);
+							_s0[l] = (uint32_t)a;
+							_s1[l] = (uint32_t)(a >> 32);
+							_s2[l] = (uint32_t)b;
+							_s3[l] = (uint32_t)(b >> 32) | 1;
+						}
+					}
+
+					/// Fills out[0..n-1] with random numbers, n must be a multiple of LANES.
+					void fill(uint32_t * out, std::size_t n)
+					{
+						for(std::size_t i = 0; i < n; i += LANES)
+						{
+							for(int l = 0; l < LANES; ++l)
+							{
+								out[i + l] = _s0[l] + _s3[l];
+								const uint32_t t = _s1[l] << 9;
+								_s2[l] ^= _s0[l];
+								_s3[l] ^= _s1[l];
+								_s1[l] ^= _s2[l];
+								_s0[l] ^= _s3[l];
+								_s2[l] ^= t;
+								_s3[l] = (_s3[l] << 11) | (_s3[l] >> 21);
+							}
+						}
+					}
+
+					/// Maps a random number to [0, n) by multiply-shift, the bias is below 2^-32 * n.
+					static uint32_t draw(uint32_t random, uint32_t n)
+					{
+						return (uint32_t)(((uint64_t)random * n) >> 32);
+					}
+
+				private:
+					static uint64_t splitmix64(uint64_t & state)
+					{
+						state += 0x9E3779B97F4A7C15ULL;
+						uint64_t z = state;
+						z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+						z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+						return z ^ (z >> 31);
+					}
+
+					uint32_t _s0[LANES];
+					uint32_t _s1[LANES];
+					uint32_t _s2[LANES];
+					uint32_t _s3[LANES];
+				};
+
+				/** Monte-Carlo rollouts of Neytiri, native version of MonteCarloStrategyFinder.DoMonteCarlo() (C#).
+
+				Each rollout deals the opponent pocket and the rest of the board, finds the opponent buckets
+				(preflop: a table given by the caller, postflop: floor(bucket_count * HS) like Bucketizer),
+				multiplies the opponent action frequencies along the strategy path and in the subtree of
+				the current node, and adds the weighted terminal values to the nodes (ApplyMonteCarloData).
+				The values are sums over the rollouts, the caller merges them up the tree (FinalizeMonteCarloData).
+
+				The managed version calculates the HS of the opponent pocket for each rollout. Here
+				set_deal() precomputes the buckets of all opponent pockets for all boards that can still
+				come (up to 2 unknown board cards, for example turn and river on the flop) with hs_engine,
+				so that a rollout only does table lookups and 2 showdown evaluations sharing the board part
+				of the LUT chain.
+
+				The rollouts are split into streams_count streams with their own RNG and value accumulators,
+				the streams run in parallel with OpenMP (if available), one thread per stream. Without a time
+				limit the result depends only on the seed and the number of streams. With a time limit each
+				stream stops at the deadline, run() returns what was done by then.
+				*/
+				class rollout_engine
+				{
+				public:
+
+					static const int MAX_ROUNDS = 4;
+					static const int POCKET_COUNT = holdem::strategy::hs::hs_engine::POCKET_COUNT;
+
+					/// Kind of a node.
+					enum node_kind
+					{
+						/// Not a terminal node.
+						NODE_INNER = 0,
+						/// Somebody folded, the value is our win (negative if we folded).
+						NODE_FOLD = 1,
+						/// Showdown, the value is our win if we win the showdown (half of the pot).
+						NODE_SHOWDOWN = 2
+					};
+
+					/// Node of the subtree of the current node, the nodes are in preorder.
+					struct node
+					{
+						/// Index of the parent, -1 for the root.
+						int32_t parent;
+						int32_t round;
+						int32_t kind;
+						/// Offsets of the opponent bucket counts of this node and of its parent in the counts,
+						/// if the opponent acted at the parent (the strategy factor is multiplied by
+						/// count / parent count of the bucket), otherwise -1.
+						int32_t counts;
+						int32_t parent_counts;
+						/// Index of the first node after the subtree.
+						int32_t subtree_end;
+						double value;
+					};
+
+					/// An opponent action on the strategy path to the current node.
+					struct path_step
+					{
+						int32_t round;
+						/// Offsets of the opponent bucket counts of the node where the opponent acts
+						/// and of the node of the action.
+						int32_t counts;
+						int32_t next_counts;
+					};
+
+					rollout_engine() : _streams_count(0), _rounds_count(0), _round(-1), _samples_done(0), _attempts_done(0)
+					{
+					}
+
+					/** Loads the LUT (LutEvaluator7.dat) and sets the number of streams.
+					@return false on error, see error().
+					*/
+					bool open(const char * lut_path, int streams_count);
+
+					/// Description of the last error.
+					const std::string & error() const
+					{
+						return _error;
+					}
+
+					/** Sets up the game: the number of shared cards and of buckets in each round
+					and the preflop buckets of all pockets (preflop_buckets[hs_engine::pocket_index(c0, c1)]).
+					The game must deal 2 pocket cards and 5 board cards, no board cards preflop.
+					*/
+					bool set_game(int rounds_count, const int * shared_cards, const int * bucket_counts,
+						const uint8_t * preflop_buckets);
+
+					/** Sets our pocket and the known board (the board cards of rounds 0..round),
+					precomputes the bucket tables. Resets the values.
+					*/
+					bool set_deal(int round, const int32_t * pocket, const int32_t * board);
+
+					/** Sets the subtree of the current node (nodes[0]) and the opponent actions on the path to it.
+					Resets the values.
+					*/
+					bool set_tree(int nodes_count, const node * nodes, int counts_size, const int32_t * counts,
+						int path_length, const path_step * path);
+
+					/** Runs rollouts until samples_count of them pass the strategy path (have a non-zero
+					strategy factor), or attempts_count rollouts are done, or time_limit seconds are over
+					(0: no limit). The values are added to the values of the previous runs.
+					*/
+					bool run(uint64_t samples_count, uint64_t attempts_count, uint64_t seed, double time_limit);
+
+					/// Sum of values of each node over all samples since set_deal() or set_tree().
+					const std::vector<double> & values() const
+					{
+						return _values;
+					}
+
+					/// Number of samples since set_deal() or set_tree().
+					uint64_t samples_done() const
+					{
+						return _samples_done;
+					}
+
+					/// Number of rollouts since set_deal() or set_tree().
+					uint64_t attempts_done() const
+					{
+						return _attempts_done;
+					}
+
+					/// Bucket of the opponent pocket (c0, c1) in the round. For rounds after the deal round
+					/// the unknown board cards are given in future (in the deal order).
+					int bucket(int round, int c0, int c1, const int32_t * future) const
+					{
+						return _buckets[round][table_index(round, future) + holdem::strategy::hs::hs_engine::pocket_index(c0, c1)];
+					}
+
+					/// The showdown evaluator.
+					const ai::pkr::stdpoker::lut_evaluator7 & evaluator() const
+					{
+						return _hs.evaluator();
+					}
+
+				private:
+
+					/// Number of random numbers generated at once.
+					static const int RANDOM_BLOCK = 512;
+					/// Number of rollouts between checks of the deadline.
+					static const int DEADLINE_CHECK = 64;
+
+					struct stream
+					{
+						rng_lanes random;
+						std::vector<double> values;
+						std::vector<double> factors;
+						uint64_t samples;
+						uint64_t attempts;
+					};
+
+					/// Offset of the table of the unknown board cards in _buckets[round].
+					int table_index(int round, const int32_t * future) const
+					{
+						switch(_unknown_cards[round])
+						{
+						case 1:
+							return POCKET_COUNT * future[0];
+						case 2:
+							return POCKET_COUNT * holdem::strategy::hs::hs_engine::pocket_index(future[0], future[1]);
+						}
+						return 0;
+					}
+
+					void calculate_buckets(int round);
+
+					void run_stream(stream & s, uint64_t samples_count, uint64_t attempts_count, double deadline) const;
+
+					bool fail(const std::string & error);
+
+					holdem::strategy::hs::hs_engine _hs;
+					int _streams_count;
+					std::vector<stream> _streams;
+
+					int _rounds_count;
+					int _shared_cards[MAX_ROUNDS];
+					int _bucket_counts[MAX_ROUNDS];
+					std::vector<uint8_t> _preflop_buckets;
+
+					/// The deal.
+					int _round;
+					int32_t _pocket[2];
+					int32_t _board[5];
+					int _board_size;
+					/// LUT state after the known board cards.
+					uint32_t _board_state;
+					/// Cards that can be dealt.
+					std::vector<int32_t> _deck;
+					/// Number of unknown board cards up to each round.
+					int _unknown_cards[MAX_ROUNDS];
+					/// Buckets [round][table_index() + pocket_index()].
+					std::vector<uint8_t> _buckets[MAX_ROUNDS];
+
+					std::vector<node> _nodes;
+					std::vector<int32_t> _counts;
+					std::vector<path_step> _path;
+
+					std::vector<double> _values;
+					uint64_t _samples_done;
+					uint64_t _attempts_done;
+
+					std::string _error;
+				};
+
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,151 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+using ai.lib.utils;
+using System.Reflection;
+using System.IO;
+
+namespace ai.pkr.bots.neytiri
+{
+    /// <summary>
+    /// Wrapper for the native library ai.pkr.bots.neytiri.cpplib.
+    /// </summary>
+    public unsafe class CppLib
+    {
+        #region RolloutEngine
+
+        /// <summary>
+        /// Number of 2-card pockets, pocket (c0 &lt; c1) has index c1*(c1-1)/2 + c0.
+        /// </summary>
+        public const int RolloutEnginePocketCount = 1326;
+
+        /// <summary>
+        /// Node kinds for RolloutEngine_SetTree().
+        /// </summary>
+        public const int RolloutEngineNodeInner = 0;
+        public const int RolloutEngineNodeFold = 1;
+        public const int RolloutEngineNodeShowdown = 2;
+
+        /// <summary>
+        /// Creates a Monte-Carlo rollout engine using LutEvaluator7.dat. The rollouts are split into 
+        /// streamsCount streams running in parallel, the result is reproducible for the same seed 
+        /// and streamsCount if there is no time limit.
+        /// Returns a handle or IntPtr.Zero on error (see RolloutEngine_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern IntPtr RolloutEngine_Open(string lutPath, int streamsCount);
+
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern void RolloutEngine_Close(IntPtr e);
+
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern IntPtr RolloutEngine_GetLastError();
+
+        /// <summary>
+        /// Sets up the game: sharedCards[r] and bucketCounts[r] for each round, the preflop bucket 
+        /// of each pocket (RolloutEnginePocketCount entries). Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern int RolloutEngine_SetGame(IntPtr e, int roundsCount, int* sharedCards, int* bucketCounts, 
+            byte* preflopBuckets);
+
+        /// <summary>
+        /// Sets our pocket (2 cards) and the board known in the round, precomputes the bucket tables
+        /// of the opponent for all boards that can come. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern int RolloutEngine_SetDeal(IntPtr e, int round, int* pocket, int* board);
+
+        /// <summary>
+        /// Sets the subtree of the current node in preorder. Node i is nodes[5*i .. 5*i+4]:
+        /// parent (-1 for the root), round, kind, offset of the opponent bucket counts of the node
+        /// and of its parent in counts if the opponent acted in the parent (-1 otherwise); 
+        /// nodeValues[i] is the value of a terminal node (fold: our win, showdown: our win if we win the showdown).
+        /// The strategy path contains pathLength opponent actions, action i is path[3*i .. 3*i+2]:
+        /// round, offset of the bucket counts of the node where the opponent acts and of the next node.
+        /// Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern int RolloutEngine_SetTree(IntPtr e, int nodesCount, int* nodes, double* nodeValues, 
+            int countsSize, int* counts, int pathLength, int* path);
+
+        /// <summary>
+        /// Runs rollouts until samplesCount of them have a non-zero strategy factor, or attemptsCount rollouts
+        /// are done, or timeLimit seconds are over (0: no limit). Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern int RolloutEngine_Run(IntPtr e, UInt64 samplesCount, UInt64 attemptsCount, 
+            UInt64 seed, double timeLimit);
+
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern UInt64 RolloutEngine_GetSamplesDone(IntPtr e);
+
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern UInt64 RolloutEngine_GetAttemptsDone(IntPtr e);
+
+        /// <summary>
+        /// Stores the sum of values of each node over all samples to values[0..nodesCount-1].
+        /// </summary>
+        [DllImport("ai.pkr.bots.neytiri.cpplib.dll")]
+        public static extern void RolloutEngine_GetValues(IntPtr e, double* values);
+
+        /// <summary>
+        /// Throws an exception with the last error of RolloutEngine.
+        /// </summary>
+        public static void RolloutEngine_ThrowLastError()
+        {
+            throw new ApplicationException(Marshal.PtrToStringAnsi(RolloutEngine_GetLastError()));
+        }
+
+        #endregion
+
+        [DllImport("libdl.so.2")]
+        static extern IntPtr dlopen(string fileName, int flags);
+
+        public static void Init()
+        {
+            bool isUnix = Environment.OSVersion.Platform == PlatformID.Unix;
+            string platform = isUnix ? (System.IntPtr.Size == 8 ? "linux64" : "linux32")
+                : (System.IntPtr.Size == 8 ? "win64" : "win32");
+            string codeBase = CodeBase.Get(Assembly.GetExecutingAssembly());
+            string dllDir = Path.Combine(Path.GetDirectoryName(codeBase), platform);
+
+            string dllName = isUnix ? "libai.pkr.bots.neytiri.cpplib.so" : "ai.pkr.bots.neytiri.cpplib.dll";
+
+            string dllPath = Path.Combine(dllDir, dllName);
+
+            if (!System.IO.File.Exists(dllPath))
+            {
+                // In case we are in development folder (debug or release) try to load from bin.   
+                dllDir = Props.Global.Expand("${bds.BinDir}") + platform;
+                dllPath = Path.Combine(dllDir, dllName);
+                if (!System.IO.File.Exists(dllPath))
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+            }
+            if (isUnix)
+            {
+                // Load by full path, the DllImports are then resolved by the soname 
+                // (see the dllmap in ai.pkr.bots.neytiri.dll.config).
+                const int RTLD_NOW = 2, RTLD_GLOBAL = 0x100;
+                if (dlopen(dllPath, RTLD_NOW | RTLD_GLOBAL) == IntPtr.Zero)
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+                return;
+            }
+            string envPath = Environment.GetEnvironmentVariable("PATH");
+            string envPathL = envPath.ToLower() + ";";
+            if (envPathL.IndexOf(dllDir.ToLower() + ";") < 0)
+            {
+                Environment.SetEnvironmentVariable("PATH", dllDir + ";" + envPath, EnvironmentVariableTarget.Process);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,220 @@
+/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using ai.pkr.metagame;
+using ai.pkr.stdpoker;
+
+namespace ai.pkr.bots.neytiri
+{
+    /// <summary>
+    /// Native version of MonteCarloStrategyFinder.DoMonteCarlo() (see RolloutEngine in CppLib).
+    /// <para>The opponent buckets are precomputed for all boards that can still come,
+    /// the rollouts run in parallel on threadsCount threads of the engine and can be limited by time.
+    /// Create one object per bot and game tree, it keeps the native engine open.</para>
+    /// </summary>
+    public unsafe class MonteCarloRolloutEngine : IDisposable
+    {
+        public MonteCarloRolloutEngine(ActionTree tree, int threadsCount)
+        {
+            CppLib.Init();
+            _tree = tree;
+            _engine = CppLib.RolloutEngine_Open(LutEvaluator7.LutPath, threadsCount);
+            if (_engine == IntPtr.Zero)
+            {
+                CppLib.RolloutEngine_ThrowLastError();
+            }
+
+            byte[] preflopBuckets = new byte[CppLib.RolloutEnginePocketCount];
+            for (int c1 = 1; c1 < 52; ++c1)
+            {
+                for (int c0 = 0; c0 < c1; ++c0)
+                {
+                    CardSet pocket = StdDeck.Descriptor.CardSets[c0] | StdDeck.Descriptor.CardSets[c1];
+                    preflopBuckets[c1 * (c1 - 1) / 2 + c0] = (byte)tree.Bucketizer.GetBucket(pocket, new CardSet(), 0);
+                }
+            }
+            GameDefinition gd = tree.GameDef;
+            fixed (int* sharedCards = gd.SharedCardsCount, bucketCounts = tree.Bucketizer.BucketCount)
+            {
+                fixed (byte* pPreflopBuckets = preflopBuckets)
+                {
+                    if (CppLib.RolloutEngine_SetGame(_engine, gd.RoundsCount, sharedCards, bucketCounts, pPreflopBuckets) == 0)
+                    {
+                        Dispose();
+                        CppLib.RolloutEngine_ThrowLastError();
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Like MonteCarloStrategyFinder.DoMonteCarlo(): runs up to repetitionsCount rollouts passing the
+        /// strategy path (and up to 10 times more rollouts in total), but stops after timeLimit seconds (0: no limit).
+        /// Sets the values of the subtree of the current node.
+        /// </summary>
+        /// <returns>Number of rollouts passing the strategy path.</returns>
+        public long DoMonteCarlo(
+            int ourPos,
+            CardSet pocket,
+            int round,
+            string sharedCardsAsString,
+            List<ActionTreeNode> strategyPath,
+            int repetitionsCount,
+            double timeLimit)
+        {
+            ActionTreeNode curStrategyNode = strategyPath[strategyPath.Count - 1];
+
+            int[] pocketCards = StdDeck.Descriptor.GetIndexesAscending(pocket).ToArray();
+            int[] board = StdDeck.Descriptor.GetIndexes(sharedCardsAsString);
+            Debug.Assert(pocketCards.Length == 2);
+            fixed (int* pPocket = pocketCards, pBoard = board.Length == 0 ? new int[1] : board)
+            {
+                if (CppLib.RolloutEngine_SetDeal(_engine, round, pPocket, pBoard) == 0)
+                {
+                    CppLib.RolloutEngine_ThrowLastError();
+                }
+            }
+
+            _ourPos = ourPos;
+            _nodes.Clear();
+            _nodeData.Clear();
+            _nodeValues.Clear();
+            _counts.Clear();
+            _countsOffsets.Clear();
+            AddNode(curStrategyNode, null, -1);
+
+            // Opponent actions on the path, skip the b-node and the deals (see MonteCarloStrategyFinder).
+            List<int> path = new List<int>();
+            Debug.Assert(strategyPath[0].ActionKind == Ak.b);
+            for (int pathIndex = 2; pathIndex < strategyPath.Count; pathIndex++)
+            {
+                ActionTreeNode pathNode = strategyPath[pathIndex];
+                if (pathNode.State.CurrentActor == 1 - ourPos)
+                {
+                    ActionTreeNode nextNode = strategyPath[pathIndex + 1];
+                    path.Add(pathNode.State.Round);
+                    path.Add(GetCountsOffset(pathNode.OppBuckets));
+                    path.Add(GetCountsOffset(nextNode.OppBuckets));
+                }
+            }
+
+            int[] nodeData = _nodeData.ToArray();
+            double[] nodeValues = _nodeValues.ToArray();
+            int[] counts = _counts.Count == 0 ? new int[1] : _counts.ToArray();
+            int[] pathData = path.Count == 0 ? new int[1] : path.ToArray();
+            fixed (int* pNodeData = nodeData, pCounts = counts, pPath = pathData)
+            {
+                fixed (double* pNodeValues = nodeValues)
+                {
+                    if (CppLib.RolloutEngine_SetTree(_engine, _nodes.Count, pNodeData, pNodeValues,
+                        _counts.Count, pCounts, path.Count / 3, pPath) == 0)
+                    {
+                        CppLib.RolloutEngine_ThrowLastError();
+                    }
+                }
+            }
+
+            if (CppLib.RolloutEngine_Run(_engine, (UInt64)repetitionsCount, (UInt64)repetitionsCount * 10,
+                (UInt64)_seedRng.Next(), timeLimit) == 0)
+            {
+                CppLib.RolloutEngine_ThrowLastError();
+            }
+
+            double[] values = new double[_nodes.Count];
+            fixed (double* pValues = values)
+            {
+                CppLib.RolloutEngine_GetValues(_engine, pValues);
+            }
+            for (int i = 0; i < _nodes.Count; ++i)
+            {
+                _nodes[i].Value = values[i];
+            }
+            FinalizeMonteCarloData finalizer = new FinalizeMonteCarloData();
+            finalizer.Finalize(_tree, curStrategyNode, ourPos);
+            return (long)CppLib.RolloutEngine_GetSamplesDone(_engine);
+        }
+
+        #region IDisposable Members
+
+        public void Dispose()
+        {
+            if (_engine != IntPtr.Zero)
+            {
+                CppLib.RolloutEngine_Close(_engine);
+                _engine = IntPtr.Zero;
+            }
+        }
+
+        #endregion
+
+        /// <summary>
+        /// Adds the subtree in preorder, with the same strategy factors and values as ApplyMonteCarloData.
+        /// </summary>
+        void AddNode(ActionTreeNode node, ActionTreeNode parent, int parentIndex)
+        {
+            int kind = CppLib.RolloutEngineNodeInner;
+            double value = 0;
+            if (node.Children.Count == 0)
+            {
+                Debug.Assert(node.State.IsGameOver);
+                if (node.State.IsShowdownRequired)
+                {
+                    kind = CppLib.RolloutEngineNodeShowdown;
+                    value = node.State.Pot / 2;
+                }
+                else
+                {
+                    kind = CppLib.RolloutEngineNodeFold;
+                    value = node.State.Players[_ourPos].IsFolded ? -node.State.Players[_ourPos].InPot :
+                        node.State.Players[1 - _ourPos].InPot;
+                }
+            }
+            int counts = -1, parentCounts = -1;
+            if (node.ActionKind != Ak.s && parent != null && parent.State.CurrentActor == 1 - _ourPos
+                && !parent.State.IsDealerActing)
+            {
+                counts = GetCountsOffset(node.OppBuckets);
+                parentCounts = GetCountsOffset(parent.OppBuckets);
+            }
+            int index = _nodes.Count;
+            _nodes.Add(node);
+            _nodeData.Add(parentIndex);
+            _nodeData.Add(node.State.Round);
+            _nodeData.Add(kind);
+            _nodeData.Add(counts);
+            _nodeData.Add(parentCounts);
+            _nodeValues.Add(value);
+            for (int c = 0; c < node.Children.Count; ++c)
+            {
+                AddNode(node.Children[c], node, index);
+            }
+        }
+
+        int GetCountsOffset(Buckets buckets)
+        {
+            int offset;
+            if (!_countsOffsets.TryGetValue(buckets, out offset))
+            {
+                offset = _counts.Count;
+                _counts.AddRange(buckets.Counts);
+                _countsOffsets.Add(buckets, offset);
+            }
+            return offset;
+        }
+
+        ActionTree _tree;
+        IntPtr _engine;
+        Random _seedRng = new Random();
+        int _ourPos;
+
+        // Flattened tree, reused between calls.
+        List<ActionTreeNode> _nodes = new List<ActionTreeNode>();
+        List<int> _nodeData = new List<int>();
+        List<double> _nodeValues = new List<double>();
+        List<int> _counts = new List<int>();
+        Dictionary<Buckets, int> _countsOffsets = new Dictionary<Buckets, int>();
+    }
+}
@@ -32,6 +32,11 @@ namespace ai.pkr.bots.neytiri
     /// <para>MonteCarloCount (string, optional): comma-separated list of MC 
     /// repetitions counts for each round, for example:<para>
     /// "-1, 5000, 3000, 3000"</para></para>
+    /// <para>MonteCarloNative (bool, optional, default: false): use the native rollout engine 
+    /// (ai.pkr.bots.neytiri.cpplib), see MonteCarloRolloutEngine.</para>
+    /// <para>MonteCarloThreads (int, optional, default: 2): number of threads of the native engine.</para>
+    /// <para>MonteCarloTimeLimit (double, optional, default: 0): time limit for Monte-Carlo in seconds 
+    /// for the native engine, 0 - no limit.</para>
     /// 
     /// </summary>
     /// <seealso cref="http://de.james-camerons-avatar.wikia.com/wiki/Neytiri"/>
@@ -61,6 +66,13 @@ namespace ai.pkr.bots.neytiri
 
         public void OnServerDisconnect(string reason)
         {
+            // Free the native rollout engine, it is created again in the next OnSessionBegin().
+            if (_rolloutEngine != null)
+            {
+                _rolloutEngine.Dispose();
+                _rolloutEngine = null;
+                _isInitialized = false;
+            }
         }
 
         public virtual void OnSessionBegin(string sessionName, GameDefinition gameDef, lib.utils.PropertyMap sessionParameters)
@@ -81,6 +93,12 @@ namespace ai.pkr.bots.neytiri
                 {
                     _monteCarloRepetitions[i] = int.Parse(mcReps[i]);
                 }
+                if (bool.Parse(_creationParams.GetValueDef("MonteCarloNative", "false")))
+                {
+                    _monteCarloTimeLimit = double.Parse(_creationParams.GetValueDef("MonteCarloTimeLimit", "0"));
+                    _rolloutEngine = new MonteCarloRolloutEngine(_strategy,
+                        int.Parse(_creationParams.GetValueDef("MonteCarloThreads", "2")));
+                }
                 _isInitialized = true;
             }
         }
@@ -120,9 +138,17 @@ namespace ai.pkr.bots.neytiri
             if (_roundWithKnownStrategy != _gameState.Round)
             {
                 // New round started, calcualate strategy
-                MonteCarloStrategyFinder.DoMonteCarlo(_strategy,
-                    _pos, _pocket, _gameState.Round, _gameState.SharedCards,
-                    _strategyPath, _monteCarloRepetitions[_gameState.Round]);
+                if (_rolloutEngine != null)
+                {
+                    _rolloutEngine.DoMonteCarlo(_pos, _pocket, _gameState.Round, _gameState.SharedCards,
+                        _strategyPath, _monteCarloRepetitions[_gameState.Round], _monteCarloTimeLimit);
+                }
+                else
+                {
+                    MonteCarloStrategyFinder.DoMonteCarlo(_strategy,
+                        _pos, _pocket, _gameState.Round, _gameState.SharedCards,
+                        _strategyPath, _monteCarloRepetitions[_gameState.Round]);
+                }
                 _roundWithKnownStrategy = _gameState.Round;
                 TraceState(_gameState);
             }
@@ -272,6 +298,8 @@ namespace ai.pkr.bots.neytiri
         private HePocketKind _pocketKind;
         NormSuit _sei = new NormSuit();
         private int[] _monteCarloRepetitions;
+        private MonteCarloRolloutEngine _rolloutEngine;
+        private double _monteCarloTimeLimit;
         private int _roundWithKnownStrategy;
         PropertyMap _creationParams;
         private GameDefinition _gameDef;
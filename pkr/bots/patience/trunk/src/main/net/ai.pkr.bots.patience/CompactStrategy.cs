@@ -0,0 +1,427 @@
+/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using ai.lib.utils;
+using ai.lib.algorithms.tree;
+using ai.pkr.metastrategy;
+
+namespace ai.pkr.bots.patience
+{
+    /// <summary>
+    /// Read-only runtime representation of a strategy tree for Patience. It is compiled once from a
+    /// StrategyTree file (see Compile()) and then memory-mapped, so all bot processes on a host
+    /// share one copy in the page cache and nothing is loaded at start-up.
+    /// <para>File layout (after the version of the strategy and a header):
+    /// nodes (StrategyTreeNode[NodesCount]), children begin indexes (int[NodesCount+1]),
+    /// children (int[NodesCount-1]) and cumulative probabilities of the children (double or UInt16,
+    /// same indexing as children). The sections are 8-byte aligned.</para>
+    /// <para>Children of a node with dealer children are sorted by card, so for dense abstract cards
+    /// a deal is found by one lookup. For a node with player children the probabilities are relative
+    /// to the siblings, moves with a relative probability less than RelProbabIgnoreLevel are removed
+    /// and the rest is normalized, exactly like Patience does it with a StrategyTree.</para>
+    /// </summary>
+    public unsafe class CompactStrategy : IDisposable
+    {
+        #region Compiler
+
+        /// <summary>
+        /// Compiles a strategy tree file to a compact strategy file.
+        /// The file is written under a temporary name and then renamed, so other processes
+        /// never see a partially written file.
+        /// </summary>
+        /// <param name="quantize">If true, stores cumulative probabilities in 16 bits. Moves with
+        /// a very small probability (less than about 1/65535) may be lost.</param>
+        public static void Compile(string strategyFileName, string fileName, double relProbabIgnoreLevel, bool quantize)
+        {
+            FileInfo strategyFile = new FileInfo(strategyFileName);
+            StrategyTree tree = UFTree.Read<StrategyTree>(strategyFileName);
+            if (tree.NodesCount > (Int64)int.MaxValue - 1)
+            {
+                throw new ApplicationException(String.Format("Strategy tree size {0} is too large.", tree.NodesCount));
+            }
+            int nodesCount = (int)tree.NodesCount;
+            UFTreeChildrenIndex index = new UFTreeChildrenIndex(tree);
+
+            int[] children = new int[nodesCount - 1];
+            double[] cumProbabs = new double[nodesCount - 1];
+            int[] childrenBegin = new int[nodesCount + 1];
+            for (int n = 0; n < nodesCount; ++n)
+            {
+                int chBegin, chCount;
+                index.GetChildrenBeginIdxAndCount(n, out chBegin, out chCount);
+                childrenBegin[n] = chBegin;
+                childrenBegin[n + 1] = chBegin + chCount;
+                if (chCount == 0)
+                {
+                    continue;
+                }
+                for (int c = 0; c < chCount; ++c)
+                {
+                    children[chBegin + c] = index.GetChildIdx(chBegin + c);
+                }
+                if (tree.Nodes[children[chBegin]].IsDealerAction)
+                {
+                    Array.Sort(children, chBegin, chCount, new DealerChildComparer(tree));
+                }
+                else
+                {
+                    CalculateCumProbabs(tree, children, cumProbabs, chBegin, chCount, relProbabIgnoreLevel);
+                }
+            }
+
+            string tmpFileName = String.Format("{0}.{1}.tmp", fileName, Process.GetCurrentProcess().Id);
+            using (BinaryWriter w = new BinaryWriter(File.Open(tmpFileName, FileMode.Create, FileAccess.Write)))
+            {
+                // Write version first to allow standard tools work.
+                tree.Version.Write(w);
+                w.Write(SERIALIZATION_FORMAT_VERSION);
+                w.Write(quantize ? FLAG_QUANTIZED : 0);
+                w.Write(relProbabIgnoreLevel);
+                w.Write(strategyFile.Length);
+                w.Write(strategyFile.LastWriteTimeUtc.Ticks);
+                w.Write(nodesCount);
+
+                // Section positions, are known after the header.
+                long nodesPos = Align(w.BaseStream.Position + 4 * 8);
+                long childrenBeginPos = Align(nodesPos + (long)nodesCount * sizeof(StrategyTreeNode));
+                long childrenPos = Align(childrenBeginPos + 4L * (nodesCount + 1));
+                long cumProbabsPos = Align(childrenPos + 4L * children.Length);
+                w.Write(nodesPos);
+                w.Write(childrenBeginPos);
+                w.Write(childrenPos);
+                w.Write(cumProbabsPos);
+
+                Pad(w, nodesPos);
+                StrategyTreeNode* nodes = tree.Nodes;
+                for (int n = 0; n < nodesCount; ++n)
+                {
+                    byte* p = (byte*)&nodes[n];
+                    for (int b = 0; b < sizeof(StrategyTreeNode); ++b)
+                    {
+                        w.Write(p[b]);
+                    }
+                }
+                Pad(w, childrenBeginPos);
+                for (int i = 0; i < childrenBegin.Length; ++i)
+                {
+                    w.Write(childrenBegin[i]);
+                }
+                Pad(w, childrenPos);
+                for (int i = 0; i < children.Length; ++i)
+                {
+                    w.Write(children[i]);
+                }
+                Pad(w, cumProbabsPos);
+                for (int i = 0; i < cumProbabs.Length; ++i)
+                {
+                    if (quantize)
+                    {
+                        w.Write((UInt16)Math.Round(cumProbabs[i] * QUANT_SCALE));
+                    }
+                    else
+                    {
+                        w.Write(cumProbabs[i]);
+                    }
+                }
+            }
+            tree.Dispose();
+
+            try
+            {
+                if (File.Exists(fileName))
+                {
+                    File.Delete(fileName);
+                }
+                File.Move(tmpFileName, fileName);
+            }
+            catch(Exception)
+            {
+                // Another process may have just created (and mapped) the file.
+                File.Delete(tmpFileName);
+                if (!IsUpToDate(fileName, strategyFileName, relProbabIgnoreLevel, quantize))
+                {
+                    throw;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Returns true if the compact strategy file exists and was compiled from the current version
+        /// of the strategy file with the given parameters.
+        /// </summary>
+        public static bool IsUpToDate(string fileName, string strategyFileName, double relProbabIgnoreLevel, bool quantize)
+        {
+            if (!File.Exists(fileName))
+            {
+                return false;
+            }
+            FileInfo strategyFile = new FileInfo(strategyFileName);
+            try
+            {
+                using (BinaryReader r = new BinaryReader(File.Open(fileName, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete)))
+                {
+                    new BdsVersion().Read(r);
+                    return r.ReadInt32() == SERIALIZATION_FORMAT_VERSION &&
+                           r.ReadInt32() == (quantize ? FLAG_QUANTIZED : 0) &&
+                           r.ReadDouble() == relProbabIgnoreLevel &&
+                           r.ReadInt64() == strategyFile.Length &&
+                           r.ReadInt64() == strategyFile.LastWriteTimeUtc.Ticks;
+                }
+            }
+            catch (EndOfStreamException)
+            {
+                return false;
+            }
+        }
+
+        #endregion
+
+        #region Public API
+
+        /// <summary>
+        /// Maps a compact strategy file.
+        /// </summary>
+        public CompactStrategy(string fileName)
+        {
+            _file = new MappedFile(fileName, MappedFileAdvice.Random);
+            try
+            {
+                using (BinaryReader r = new BinaryReader(new UnmanagedMemoryStream(_file.Ptr, _file.Length)))
+                {
+                    Version = new BdsVersion();
+                    Version.Read(r);
+                    int serFmtVer = r.ReadInt32();
+                    if (serFmtVer != SERIALIZATION_FORMAT_VERSION)
+                    {
+                        throw new ApplicationException(
+                            string.Format("{0}: unsupported serialization format '{1}', supported: '{2}'", fileName,
+                                          serFmtVer, SERIALIZATION_FORMAT_VERSION));
+                    }
+                    IsQuantized = (r.ReadInt32() & FLAG_QUANTIZED) != 0;
+                    RelProbabIgnoreLevel = r.ReadDouble();
+                    r.ReadInt64();
+                    r.ReadInt64();
+                    NodesCount = r.ReadInt32();
+                    long nodesPos = r.ReadInt64();
+                    long childrenBeginPos = r.ReadInt64();
+                    long childrenPos = r.ReadInt64();
+                    long cumProbabsPos = r.ReadInt64();
+                    if (cumProbabsPos + (NodesCount - 1L) * (IsQuantized ? 2 : 8) > _file.Length)
+                    {
+                        throw new ApplicationException(string.Format("{0}: file is truncated", fileName));
+                    }
+                    _nodes = (StrategyTreeNode*)(_file.Ptr + nodesPos);
+                    _childrenBegin = (int*)(_file.Ptr + childrenBeginPos);
+                    _children = (int*)(_file.Ptr + childrenPos);
+                    _cumProbabs = (double*)(_file.Ptr + cumProbabsPos);
+                    _cumProbabsQ = (UInt16*)(_file.Ptr + cumProbabsPos);
+                }
+            }
+            catch
+            {
+                _file.Dispose();
+                throw;
+            }
+        }
+
+        /// <summary>
+        /// Version of the original strategy tree.
+        /// </summary>
+        public BdsVersion Version
+        {
+            get;
+            private set;
+        }
+
+        public int NodesCount
+        {
+            get;
+            private set;
+        }
+
+        public double RelProbabIgnoreLevel
+        {
+            get;
+            private set;
+        }
+
+        public bool IsQuantized
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Nodes in the same order as in the strategy tree (read-only).
+        /// </summary>
+        public StrategyTreeNode* Nodes
+        {
+            get { return _nodes; }
+        }
+
+        /// <summary>
+        /// Returns number of children and index of the first child for GetChildIdx() (like UFTreeChildrenIndex).
+        /// </summary>
+        public void GetChildrenBeginIdxAndCount(long nodeIdx, out int childrenBeginIdx, out int childrenCount)
+        {
+            childrenBeginIdx = _childrenBegin[nodeIdx];
+            childrenCount = _childrenBegin[nodeIdx + 1] - childrenBeginIdx;
+        }
+
+        public int GetChildIdx(int i)
+        {
+            return _children[i];
+        }
+
+        /// <summary>
+        /// Returns the index of the dealer child with the given card or -1 if there is no such child.
+        /// </summary>
+        public int FindDealerChild(long nodeIdx, int card)
+        {
+            int chBegin = _childrenBegin[nodeIdx];
+            int chCount = _childrenBegin[nodeIdx + 1] - chBegin;
+            // Children are sorted by card, for dense cards this is the child.
+            if (card >= 0 && card < chCount)
+            {
+                int child = _children[chBegin + card];
+                if (_nodes[child].IsDealerAction && _nodes[child].Card == card)
+                {
+                    return child;
+                }
+            }
+            for (int c = 0; c < chCount; ++c)
+            {
+                int child = _children[chBegin + c];
+                if (_nodes[child].IsDealerAction && _nodes[child].Card == card)
+                {
+                    return child;
+                }
+            }
+            return -1;
+        }
+
+        /// <summary>
+        /// Chooses a move of the player acting in the node.
+        /// </summary>
+        /// <param name="random">A random number in [0, 1).</param>
+        /// <returns>Index of the child node or -1 if all moves have zero probability.</returns>
+        public int ChooseMove(long nodeIdx, double random)
+        {
+            int chBegin = _childrenBegin[nodeIdx];
+            int chEnd = _childrenBegin[nodeIdx + 1];
+            if (IsQuantized)
+            {
+                uint r = (uint)(random * QUANT_SCALE);
+                for (int c = chBegin; c < chEnd; ++c)
+                {
+                    if (r < _cumProbabsQ[c])
+                    {
+                        return _children[c];
+                    }
+                }
+            }
+            else
+            {
+                for (int c = chBegin; c < chEnd; ++c)
+                {
+                    if (random < _cumProbabs[c])
+                    {
+                        return _children[c];
+                    }
+                }
+            }
+            return -1;
+        }
+
+        #endregion
+
+        #region IDisposable Members
+
+        public void Dispose()
+        {
+            _file.Dispose();
+            _nodes = null;
+            _childrenBegin = _children = null;
+            _cumProbabs = null;
+            _cumProbabsQ = null;
+        }
+
+        #endregion
+
+        #region Implementation
+
+        /// <summary>
+        /// Converts the probabilities of the moves to a cumulative distribution, all zeros if all moves have
+        /// zero probability. The computation is the same as in Patience and DiscreteProbabilityRng.
+        /// </summary>
+        static void CalculateCumProbabs(StrategyTree tree, int[] children, double[] cumProbabs,
+            int chBegin, int chCount, double relProbabIgnoreLevel)
+        {
+            double sumProbab = 0;
+            for (int c = chBegin; c < chBegin + chCount; ++c)
+            {
+                sumProbab += tree.Nodes[children[c]].Probab;
+            }
+            double sum = 0;
+            for (int c = chBegin; c < chBegin + chCount; ++c)
+            {
+                double probab = tree.Nodes[children[c]].Probab / sumProbab;
+                if (probab < relProbabIgnoreLevel || double.IsNaN(probab))
+                {
+                    probab = 0;
+                }
+                sum += probab;
+                cumProbabs[c] = sum;
+            }
+            for (int c = chBegin; c < chBegin + chCount; ++c)
+            {
+                cumProbabs[c] = sum == 0 ? 0 : cumProbabs[c] / sum;
+            }
+        }
+
+        class DealerChildComparer : IComparer<int>
+        {
+            public DealerChildComparer(StrategyTree tree)
+            {
+                _tree = tree;
+            }
+
+            public int Compare(int x, int y)
+            {
+                return _tree.Nodes[x].Card.CompareTo(_tree.Nodes[y].Card);
+            }
+
+            StrategyTree _tree;
+        }
+
+        static long Align(long pos)
+        {
+            return (pos + 7) & ~7L;
+        }
+
+        static void Pad(BinaryWriter w, long pos)
+        {
+            while (w.BaseStream.Position < pos)
+            {
+                w.Write((byte)0);
+            }
+        }
+
+        const int SERIALIZATION_FORMAT_VERSION = 1;
+        const int FLAG_QUANTIZED = 1;
+        const double QUANT_SCALE = 65535;
+
+        MappedFile _file;
+        StrategyTreeNode* _nodes;
+        int* _childrenBegin;
+        int* _children;
+        double* _cumProbabs;
+        UInt16* _cumProbabsQ;
+
+        #endregion
+    }
+}
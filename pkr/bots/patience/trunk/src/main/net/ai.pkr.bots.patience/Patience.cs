@@ -32,6 +32,11 @@ namespace ai.pkr.bots.patience
     /// by a given poker action. Possible values: Equal, Closest</para>
     /// <para>RelProbabIgnoreLevel (double, optional, default: 0.0): ignores moves with probability less than this level. 
     /// This can be used to avoid folds with good cards due to the problems with fictitios play algorithm.</para>
+    /// <para>CompactStrategy (bool, optional, default: false): play from compact strategy files (see CompactStrategy)
+    /// shared by all processes on the host. A file strategy-N-compact.dat is compiled next to each strategy-N.dat 
+    /// if it does not exist or is outdated.</para>
+    /// <para>CompactStrategyQuantize (bool, optional, default: false): store probabilities in compact 
+    /// strategy files in 16 bits.</para>
     /// </summary>
     public unsafe class Patience : IPlayer
     {
@@ -82,7 +87,7 @@ namespace ai.pkr.bots.patience
                 {
                     _curStrNodeIdx = p + 1;
                     StrategyTreeNode stNode = new StrategyTreeNode();
-                    _strategies[_pos].GetNode(p + 1, &stNode);
+                    GetStrNode(_pos, p + 1, &stNode);
                     double strBlind = stNode.Amount;
                     double grBlind = _gameRecord.Players[p].Blind;
                     if (!FloatingPoint.AreEqual(grBlind, strBlind, AMOUNT_EPSILON))
@@ -117,50 +122,20 @@ namespace ai.pkr.bots.patience
             _gameRecord = new GameRecord(gameString);
             ProcessActions();
 
-            int chBegin, movesCount;
-            _strIndexes[_pos].GetChildrenBeginIdxAndCount(_curStrNodeIdx, out chBegin, out movesCount);
-            double[] probabs = new double[movesCount];
-            double sumProbab = 0;
-            for (int c = 0; c < movesCount; ++c)
+            int nextStrNode;
+            if (_isCompact)
             {
-                int stNodeIdx = _strIndexes[_pos].GetChildIdx(chBegin + c);
-                StrategyTreeNode stNode = new StrategyTreeNode();
-                _strategies[_pos].GetNode(stNodeIdx, &stNode);
-                // Verify we are in the correct position.
-                // This is proven to be very helpful in testing.
-                if (!stNode.IsPlayerAction(_pos))
+                nextStrNode = _compactStrategies[_pos].ChooseMove(_curStrNodeIdx, _rng.NextDouble());
+                if (nextStrNode == -1)
                 {
-                    throw new ApplicationException(String.Format("{0}: expected strategy child: player action for pos {1}, but was: '{2}'",
-                        GetBotStateDiagText(),
-                        _pos,
-                        stNode.ToStrategicString(null)));
-                }
-
-                probabs[c] = stNode.Probab;
-                sumProbab += probabs[c];
-            }
-            try
-            {
-                // Convert to relative probability and ignore if necessary
-                for (int c = 0; c < probabs.Length; ++c)
-                {
-                    probabs[c] /= sumProbab;
-                    if (probabs[c] < _relProbabIgnoreLevel)
-                    {
-                        probabs[c] = 0;
-                    }
+                    throw new ApplicationException(String.Format("{0} : all moves have zero probability",
+                                                                 GetBotStateDiagText()));
                 }
-                _moveSelector.SetWeights(probabs);
             }
-            catch (Exception e)
+            else
             {
-                // If there are problems with 0-probablities, add more info to it.
-                throw new ApplicationException(String.Format("{0} : see inner exception", GetBotStateDiagText()), e);
+                nextStrNode = ChooseMove();
             }
-
-            int moveIdx = _moveSelector.Next();
-            Debug.Assert(probabs[moveIdx] > 0, "0-probabs must not occur");
-            int nextStrNode = _strIndexes[_pos].GetChildIdx(chBegin + moveIdx);
             PokerAction move = ConvertStrActionToPokerAction(nextStrNode);
 
             log.InfoFormat("{0} OnActionRequired() returns {1}", _name, move);
@@ -185,7 +160,7 @@ namespace ai.pkr.bots.patience
         string GetBotStateDiagText()
         {
             StrategyTreeNode stNode = new StrategyTreeNode();
-            _strategies[_pos].GetNode(_curStrNodeIdx, &stNode);
+            GetStrNode(_pos, _curStrNodeIdx, &stNode);
             return String.Format("Player: {0}, pos: {1}, str. node: {2}({3})",
                 _name, _pos, _curStrNodeIdx, stNode.ToStrategicString(null));
         }
@@ -249,10 +224,14 @@ namespace ai.pkr.bots.patience
             _relProbabIgnoreLevel = double.Parse(_creationParams.GetDefault("RelProbabIgnoreLevel", "0.0"), CultureInfo.InvariantCulture);
             _playerInfoProps.Set("RelProbabIgnoreLevel", _relProbabIgnoreLevel.ToString());
 
+            _isCompact = bool.Parse(_creationParams.GetDefault("CompactStrategy", "false"));
+            bool quantize = bool.Parse(_creationParams.GetDefault("CompactStrategyQuantize", "false"));
+            _playerInfoProps.Set("CompactStrategy", _isCompact.ToString());
+
             // Use MersenneTwister because it is under our control on all platforms and 
             // is probably better than System.Random.
-            Random underlyingRng = new MersenneTwister(rngSeed);
-            _moveSelector = new DiscreteProbabilityRng(underlyingRng);
+            _rng = new MersenneTwister(rngSeed);
+            _moveSelector = new DiscreteProbabilityRng(_rng);
             _playerInfoProps.Set("RngSeed", rngSeed.ToString());
             
             _deckDescr = XmlSerializerExt.Deserialize<DeckDescriptor>(props.Get("DeckDescriptor"));
@@ -279,6 +258,7 @@ namespace ai.pkr.bots.patience
 
             _strategies = new StrategyTree[0];
             _strIndexes = new UFTreeChildrenIndex[0];
+            _compactStrategies = new CompactStrategy[0];
 
             // Load strategies, reuse if file is the same
             for (int pos = 0; ; pos++)
@@ -291,6 +271,7 @@ namespace ai.pkr.bots.patience
                 }
                 Array.Resize(ref _strategies, _strategies.Length + 1);
                 Array.Resize(ref _strIndexes, _strIndexes.Length + 1);
+                Array.Resize(ref _compactStrategies, _compactStrategies.Length + 1);
 
                 string absFileName = Path.Combine(strDir, relFileName);
                 int existingPos;
@@ -298,14 +279,29 @@ namespace ai.pkr.bots.patience
                 {
                     _strategies[pos] = _strategies[existingPos];
                     _strIndexes[pos] = _strIndexes[existingPos];
+                    _compactStrategies[pos] = _compactStrategies[existingPos];
+                }
+                else if (_isCompact)
+                {
+                    fileToPos.Add(absFileName, pos);
+                    string compactFileName = Path.ChangeExtension(absFileName, null) + "-compact.dat";
+                    if (!CompactStrategy.IsUpToDate(compactFileName, absFileName, _relProbabIgnoreLevel, quantize))
+                    {
+                        log.InfoFormat("{0} compiling {1}", _name, compactFileName);
+                        CompactStrategy.Compile(absFileName, compactFileName, _relProbabIgnoreLevel, quantize);
+                    }
+                    _compactStrategies[pos] = new CompactStrategy(compactFileName);
                 }
                 else
                 {
                     fileToPos.Add(absFileName, pos);
-                    _strategies[pos] = StrategyTree.ReadFDA<StrategyTree>(absFileName);
+                    _strategies[pos] = StrategyTree.ReadMapped<StrategyTree>(absFileName);
                     _strIndexes[pos] = new UFTreeChildrenIndex(_strategies[pos], Path.Combine(strDir, "strategy-idx.dat"), false);
+                    // The game follows one path from the root, the rest of the tree is not needed.
+                    _strategies[pos].AdviseMapped(MappedFileAdvice.Random);
                 }
-                _playerInfoProps.Set(strPropName+".Version", _strategies[pos].Version.ToString());
+                BdsVersion version = _isCompact ? _compactStrategies[pos].Version : _strategies[pos].Version;
+                _playerInfoProps.Set(strPropName+".Version", version.ToString());
             }
 
             // Read blinds
@@ -315,7 +311,7 @@ namespace ai.pkr.bots.patience
                 for (int playerPos = 0; playerPos < _strategies.Length; ++playerPos)
                 {
                     StrategyTreeNode stNode = new StrategyTreeNode();
-                    _strategies[strPos].GetNode(playerPos + 1, &stNode);
+                    GetStrNode(strPos, playerPos + 1, &stNode);
                     sb.AppendFormat("{0:0.000000 }", stNode.Amount);
                 }
                 _playerInfoProps.Set("Blinds." + strPos.ToString(), sb.ToString());
@@ -333,7 +329,7 @@ namespace ai.pkr.bots.patience
                 log.InfoFormat("{0} process {1} of pos {2}", _name, pa.Kind, pa.Position);
                 ProcessAction(pa);
                 StrategyTreeNode stNode = new StrategyTreeNode();
-                _strategies[_pos].GetNode(_curStrNodeIdx, &stNode);
+                GetStrNode(_pos, _curStrNodeIdx, &stNode);
                 if (stNode.IsPlayerAction(_pos))
                 {
                     _lastAbsStrProbab = stNode.Probab;
@@ -349,7 +345,7 @@ namespace ai.pkr.bots.patience
         void ProcessAction(PokerAction pa)
         {
             int chBegin, chCount;
-            _strIndexes[_pos].GetChildrenBeginIdxAndCount(_curStrNodeIdx, out chBegin, out chCount);
+            GetStrChildren(_curStrNodeIdx, out chBegin, out chCount);
             int nextStrNodeIdx = -1;
 
             if (pa.IsDealerAction())
@@ -366,11 +362,16 @@ namespace ai.pkr.bots.patience
 
                 int[] hand = _deckDescr.GetIndexes(_gameState.Players[_pos].Hand);
                 int abstrCard = _chanceAbsrtractions[_pos].GetAbstractCard(hand, hand.Length);
+                if (_isCompact)
+                {
+                    nextStrNodeIdx = _compactStrategies[_pos].FindDealerChild(_curStrNodeIdx, abstrCard);
+                    goto searchFinished;
+                }
                 for (int c = 0; c < chCount; ++c)
                 {
-                    int stNodeIdx = _strIndexes[_pos].GetChildIdx(chBegin + c);
+                    int stNodeIdx = GetStrChildIdx(chBegin + c);
                     StrategyTreeNode stNode = new StrategyTreeNode();
-                    _strategies[_pos].GetNode(stNodeIdx, &stNode);
+                    GetStrNode(_pos, stNodeIdx, &stNode);
                     if (!stNode.IsDealerAction)
                     {
                         throw new ApplicationException(
@@ -394,9 +395,9 @@ namespace ai.pkr.bots.patience
 
                 for (int c = 0; c < chCount; ++c)
                 {
-                    int stNodeIdx = _strIndexes[_pos].GetChildIdx(chBegin + c);
+                    int stNodeIdx = GetStrChildIdx(chBegin + c);
                     StrategyTreeNode stNode = new StrategyTreeNode();
-                    _strategies[_pos].GetNode(stNodeIdx, &stNode);
+                    GetStrNode(_pos, stNodeIdx, &stNode);
 
                     if (!stNode.IsPlayerAction(pa.Position))
                     {
@@ -435,10 +436,90 @@ namespace ai.pkr.bots.patience
             _curStrNodeIdx = nextStrNodeIdx;
         }
 
+        /// <summary>
+        /// Chooses our move in the current node of a StrategyTree.
+        /// </summary>
+        int ChooseMove()
+        {
+            int chBegin, movesCount;
+            _strIndexes[_pos].GetChildrenBeginIdxAndCount(_curStrNodeIdx, out chBegin, out movesCount);
+            double[] probabs = new double[movesCount];
+            double sumProbab = 0;
+            for (int c = 0; c < movesCount; ++c)
+            {
+                int stNodeIdx = _strIndexes[_pos].GetChildIdx(chBegin + c);
+                StrategyTreeNode stNode = new StrategyTreeNode();
+                _strategies[_pos].GetNode(stNodeIdx, &stNode);
+                // Verify we are in the correct position.
+                // This is proven to be very helpful in testing.
+                if (!stNode.IsPlayerAction(_pos))
+                {
+                    throw new ApplicationException(String.Format("{0}: expected strategy child: player action for pos {1}, but was: '{2}'",
+                        GetBotStateDiagText(),
+                        _pos,
+                        stNode.ToStrategicString(null)));
+                }
+
+                probabs[c] = stNode.Probab;
+                sumProbab += probabs[c];
+            }
+            try
+            {
+                // Convert to relative probability and ignore if necessary
+                for (int c = 0; c < probabs.Length; ++c)
+                {
+                    probabs[c] /= sumProbab;
+                    if (probabs[c] < _relProbabIgnoreLevel)
+                    {
+                        probabs[c] = 0;
+                    }
+                }
+                _moveSelector.SetWeights(probabs);
+            }
+            catch (Exception e)
+            {
+                // If there are problems with 0-probablities, add more info to it.
+                throw new ApplicationException(String.Format("{0} : see inner exception", GetBotStateDiagText()), e);
+            }
+
+            int moveIdx = _moveSelector.Next();
+            Debug.Assert(probabs[moveIdx] > 0, "0-probabs must not occur");
+            return _strIndexes[_pos].GetChildIdx(chBegin + moveIdx);
+        }
+
+        void GetStrNode(int strPos, Int64 nodeIdx, StrategyTreeNode* node)
+        {
+            if (_isCompact)
+            {
+                *node = _compactStrategies[strPos].Nodes[nodeIdx];
+            }
+            else
+            {
+                _strategies[strPos].GetNode(nodeIdx, node);
+            }
+        }
+
+        void GetStrChildren(Int64 nodeIdx, out int chBegin, out int chCount)
+        {
+            if (_isCompact)
+            {
+                _compactStrategies[_pos].GetChildrenBeginIdxAndCount(nodeIdx, out chBegin, out chCount);
+            }
+            else
+            {
+                _strIndexes[_pos].GetChildrenBeginIdxAndCount(nodeIdx, out chBegin, out chCount);
+            }
+        }
+
+        int GetStrChildIdx(int i)
+        {
+            return _isCompact ? _compactStrategies[_pos].GetChildIdx(i) : _strIndexes[_pos].GetChildIdx(i);
+        }
+
         private PokerAction ConvertStrActionToPokerAction(int nextStNodeIdx)
         {
             StrategyTreeNode nextStNode = new StrategyTreeNode();
-            _strategies[_pos].GetNode(nextStNodeIdx, &nextStNode);
+            GetStrNode(_pos, nextStNodeIdx, &nextStNode);
             if (!nextStNode.IsPlayerAction(_pos))
             {
                 throw new ApplicationException(String.Format("{0} : wrong move: {1}", GetBotStateDiagText(), nextStNode.ToStrategicString(null)));
@@ -473,10 +554,16 @@ namespace ai.pkr.bots.patience
         Props _creationParams;
         DeckDescriptor _deckDescr;
         private IChanceAbstraction[] _chanceAbsrtractions;
+        private Random _rng;
         private DiscreteProbabilityRng _moveSelector;
         private StrategyTree[] _strategies;
         UFTreeChildrenIndex[] _strIndexes;
         /// <summary>
+        /// Used instead of _strategies and _strIndexes if _isCompact is true.
+        /// </summary>
+        CompactStrategy[] _compactStrategies;
+        bool _isCompact;
+        /// <summary>
         /// Send to server some infomational properirties. 
         /// </summary>
         Props _playerInfoProps;
@@ -0,0 +1,186 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using ai.lib.utils;
+using System.Reflection;
+using System.IO;
+using ai.pkr.metagame;
+using ai.lib.algorithms.tree;
+using ai.pkr.metastrategy;
+using ai.pkr.metastrategy.algorithms;
+
+namespace ai.pkr.bots.patience.nunit
+{
+    /// <summary>
+    /// Unit tests for CompactStrategy. 
+    /// </summary>
+    [TestFixture]
+    public unsafe class CompactStrategy_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_Compile()
+        {
+            GameDefinition gd = XmlSerializerExt.Deserialize<GameDefinition>(
+                Props.Global.Expand("${bds.DataDir}ai.pkr.metastrategy/leduc-he.gamedef.xml"));
+            string strategyFile = CreateStrategy(gd);
+            StrategyTree st = UFTree.Read<StrategyTree>(strategyFile);
+            UFTreeChildrenIndex index = new UFTreeChildrenIndex(st);
+
+            foreach (double relProbabIgnoreLevel in new double[] { 0, 0.2 })
+            {
+                foreach (bool quantize in new bool[] { false, true })
+                {
+                    string compactFile = Path.Combine(_outDir, "strategy-compact.dat");
+                    CompactStrategy.Compile(strategyFile, compactFile, relProbabIgnoreLevel, quantize);
+                    Assert.IsTrue(CompactStrategy.IsUpToDate(compactFile, strategyFile, relProbabIgnoreLevel, quantize));
+                    Assert.IsFalse(CompactStrategy.IsUpToDate(compactFile, strategyFile, 0.1, quantize));
+                    Assert.IsFalse(CompactStrategy.IsUpToDate(compactFile, strategyFile, relProbabIgnoreLevel, !quantize));
+                    using (CompactStrategy cs = new CompactStrategy(compactFile))
+                    {
+                        Assert.AreEqual(st.Version, cs.Version);
+                        Assert.AreEqual(quantize, cs.IsQuantized);
+                        Assert.AreEqual(relProbabIgnoreLevel, cs.RelProbabIgnoreLevel);
+                        VerifyCompactStrategy(st, index, cs);
+                    }
+                }
+            }
+        }
+
+        [Test]
+        public void Test_IsUpToDate()
+        {
+            GameDefinition gd = XmlSerializerExt.Deserialize<GameDefinition>(
+                Props.Global.Expand("${bds.DataDir}ai.pkr.metastrategy/kuhn.gamedef.xml"));
+            string strategyFile = CreateStrategy(gd);
+            string compactFile = Path.Combine(_outDir, "strategy-compact.dat");
+            if (File.Exists(compactFile))
+            {
+                File.Delete(compactFile);
+            }
+            Assert.IsFalse(CompactStrategy.IsUpToDate(compactFile, strategyFile, 0, false));
+            CompactStrategy.Compile(strategyFile, compactFile, 0, false);
+            Assert.IsTrue(CompactStrategy.IsUpToDate(compactFile, strategyFile, 0, false));
+            // Strategy changed.
+            File.SetLastWriteTimeUtc(strategyFile, DateTime.UtcNow.AddMinutes(1));
+            Assert.IsFalse(CompactStrategy.IsUpToDate(compactFile, strategyFile, 0, false));
+        }
+
+        #endregion
+
+        #region Benchmarks
+        #endregion
+
+        #region Implementation
+
+        private string _outDir = UTHelper.MakeAndGetTestOutputDir(Assembly.GetExecutingAssembly(), "CompactStrategy_Test");
+
+        /// <summary>
+        /// Creates a strategy for position 0 with random probabilities (some of them zero) and writes it to a file.
+        /// </summary>
+        string CreateStrategy(GameDefinition gd)
+        {
+            ChanceTree ct = CreateChanceTreeByGameDef.Create(gd);
+            ChanceTree pct = ExtractPlayerChanceTree.ExtractS(ct, 0);
+            ActionTree at = CreateActionTreeByGameDef.Create(gd);
+            StrategyTree st = CreateStrategyTreeByChanceAndActionTrees.CreateS(pct, at);
+            Random rng = new Random(1);
+            for (long n = 0; n < st.NodesCount; ++n)
+            {
+                st.Nodes[n].Probab = rng.Next(4) == 0 ? 0 : rng.NextDouble();
+            }
+            string fileName = Path.Combine(_outDir, gd.Name + "-strategy.dat");
+            st.Write(fileName);
+            return fileName;
+        }
+
+        void VerifyCompactStrategy(StrategyTree st, UFTreeChildrenIndex index, CompactStrategy cs)
+        {
+            Assert.AreEqual(st.NodesCount, cs.NodesCount);
+            Random rng = new Random(1);
+            for (int n = 0; n < st.NodesCount; ++n)
+            {
+                Assert.AreEqual(st.Nodes[n].ToStrategicString(null), cs.Nodes[n].ToStrategicString(null));
+                Assert.AreEqual(st.Nodes[n].Probab, cs.Nodes[n].Probab);
+
+                int chBegin, chCount, csChBegin, csChCount;
+                index.GetChildrenBeginIdxAndCount(n, out chBegin, out chCount);
+                cs.GetChildrenBeginIdxAndCount(n, out csChBegin, out csChCount);
+                Assert.AreEqual(chCount, csChCount);
+                if (chCount == 0)
+                {
+                    continue;
+                }
+                List<int> children = new List<int>();
+                List<int> csChildren = new List<int>();
+                for (int c = 0; c < chCount; ++c)
+                {
+                    children.Add(index.GetChildIdx(chBegin + c));
+                    csChildren.Add(cs.GetChildIdx(csChBegin + c));
+                }
+                if (st.Nodes[children[0]].IsDealerAction)
+                {
+                    // Dealer children may be reordered.
+                    csChildren.Sort();
+                    Assert.AreEqual(children, csChildren);
+                    foreach (int child in children)
+                    {
+                        Assert.AreEqual(child, cs.FindDealerChild(n, st.Nodes[child].Card));
+                    }
+                    Assert.AreEqual(-1, cs.FindDealerChild(n, 1000));
+                    continue;
+                }
+                Assert.AreEqual(children, csChildren);
+
+                // Expected distribution, as in Patience.
+                double[] probabs = new double[chCount];
+                double sumProbab = 0;
+                for (int c = 0; c < chCount; ++c)
+                {
+                    probabs[c] = st.Nodes[children[c]].Probab;
+                    sumProbab += probabs[c];
+                }
+                double sum = 0;
+                for (int c = 0; c < chCount; ++c)
+                {
+                    probabs[c] /= sumProbab;
+                    if (!(probabs[c] >= cs.RelProbabIgnoreLevel))
+                    {
+                        probabs[c] = 0;
+                    }
+                    sum += probabs[c];
+                }
+                if (sum == 0)
+                {
+                    Assert.AreEqual(-1, cs.ChooseMove(n, 0.5));
+                    continue;
+                }
+                double epsilon = cs.IsQuantized ? 2.0 / 65535 : 1e-12;
+                for (int i = 0; i < 20; ++i)
+                {
+                    double random = rng.NextDouble();
+                    int move = cs.ChooseMove(n, random);
+                    int moveIdx = children.IndexOf(move);
+                    Assert.GreaterOrEqual(moveIdx, 0);
+                    Assert.Greater(probabs[moveIdx], 0);
+                    double cumBefore = 0;
+                    for (int c = 0; c < moveIdx; ++c)
+                    {
+                        cumBefore += probabs[c] / sum;
+                    }
+                    double cumAfter = cumBefore + probabs[moveIdx] / sum;
+                    Assert.GreaterOrEqual(random, cumBefore - epsilon);
+                    Assert.Less(random, cumAfter + epsilon);
+                }
+            }
+        }
+
+        #endregion
+    }
+}
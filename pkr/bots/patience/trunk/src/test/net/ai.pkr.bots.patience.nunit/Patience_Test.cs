@@ -40,7 +40,19 @@ namespace ai.pkr.bots.patience.nunit
             int repeatCount = 100;
             double relEpsion = 1;
             string[] bucketStrings = new string[] { LeducHeChanceAbstraction.Public, LeducHeChanceAbstraction.Public };
-            PlayEqVsBr(bucketStrings, LEDUC_ALL_GAMES_LOG_SIZE, repeatCount, relEpsion);
+            PlayEqVsBr(bucketStrings, LEDUC_ALL_GAMES_LOG_SIZE, repeatCount, relEpsion, false);
+        }
+
+        /// <summary>
+        /// Same as Test_EqVsBr_Leduc_Public_Quick() with compact strategies.
+        /// </summary>
+        [Test]
+        public void Test_EqVsBr_Leduc_Public_Quick_Compact()
+        {
+            int repeatCount = 100;
+            double relEpsion = 1;
+            string[] bucketStrings = new string[] { LeducHeChanceAbstraction.Public, LeducHeChanceAbstraction.Public };
+            PlayEqVsBr(bucketStrings, LEDUC_ALL_GAMES_LOG_SIZE, repeatCount, relEpsion, true);
         }
 
         /// <summary>
@@ -58,7 +70,7 @@ namespace ai.pkr.bots.patience.nunit
             double relEpsion = 0.06;
 #endif
             string[] bucketStrings = new string[] { LeducHeChanceAbstraction.Public, LeducHeChanceAbstraction.Public };
-            PlayEqVsBr(bucketStrings, LEDUC_ALL_GAMES_LOG_SIZE, repeatCount, relEpsion);
+            PlayEqVsBr(bucketStrings, LEDUC_ALL_GAMES_LOG_SIZE, repeatCount, relEpsion, false);
         }
 
         /// <summary>
@@ -76,7 +88,7 @@ namespace ai.pkr.bots.patience.nunit
             double relEpsion = 0.03;
 #endif
             string[] bucketStrings = new string[] { LeducHeChanceAbstraction.FullGame, LeducHeChanceAbstraction.FractionalResult };
-            PlayEqVsBr(bucketStrings, LEDUC_ALL_GAMES_LOG_SIZE, repeatCount, relEpsion);
+            PlayEqVsBr(bucketStrings, LEDUC_ALL_GAMES_LOG_SIZE, repeatCount, relEpsion, false);
         }
 
         #endregion
@@ -102,8 +114,10 @@ namespace ai.pkr.bots.patience.nunit
         /// if the abstraction is the same.
         /// <param name="baseDir">The function copies all config files from _testResourceDir/baseDir
         /// to _outDir/baseDir-eq and _outDir/baseDir-br, all intermediate files are also created here.</param>
+        /// <param name="isCompact">Play from compact strategies (CompactStrategy parameter of Patience).</param>
         /// </summary>
-        void PlayEqVsBr(string [] bucketizerStrings, int sessionGamesCount, int sessionRepetitionCount, double relativeTolerance)
+        void PlayEqVsBr(string [] bucketizerStrings, int sessionGamesCount, int sessionRepetitionCount, double relativeTolerance,
+            bool isCompact)
         {
             Console.WriteLine("Run eq vs eq for chance abstractions:");
             for (int p = 0; p < bucketizerStrings.Length; ++p)
@@ -138,6 +152,10 @@ namespace ai.pkr.bots.patience.nunit
             runner.Configuration = XmlSerializerExt.Deserialize<SessionSuiteCfg>(ssConfigFile);
             runner.Configuration.Sessions[0].GamesCount = sessionGamesCount;
             runner.Configuration.Sessions[0].RepeatCount = sessionRepetitionCount;
+            foreach (LocalPlayerCfg player in runner.Configuration.LocalPlayers)
+            {
+                player.CreationParameters.Set("CompactStrategy", isCompact.ToString());
+            }
             runner.IsLoggingEnabled = false;
             runner.OnGameEnd += new SessionSuiteRunner.OnGameEndHandler(runner_OnGameEnd);
             runner.Run();
@@ -0,0 +1,418 @@
+// ai.pkr.ctmcgen.cpplib-runner.cpp : Tests and benchmarks for ai.pkr.ctmcgen.cpplib.
+//
+// Usage:
+//   ai.pkr.ctmcgen.cpplib-runner test [temp-dir]
+//       Runs the tests (on synthetic data, no data files are required).
+//   ai.pkr.ctmcgen.cpplib-runner benchmark [samples] [streams] [LutEvaluator7.dat]
+//       Measures the sampling rate for Leduc HE and, if the LUT is given, for hold'em
+//       with bucket tables for preflop and flop.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "ai.pkr.ctmcgen.cpplib.h"
+#include "mc_generator.h"
+#include <ai.lib.utils.cpp/bds_version.h>
+
+using namespace std;
+using namespace ai::pkr::ctmcgen;
+
+static string _tempDir = ".";
+
+#define VERIFY(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); throw "Test failed"; }
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Leduc HE: 6 cards (J, Q, K of 2 suits, card / 2 is the rank), 1 private card, 1 shared card.
+static const int LEDUC_DECK = 6;
+static const int32_t LEDUC_PLAYER[] = {1, 0};
+static const int32_t LEDUC_SHARED[] = {0, 1};
+
+static uint32_t LeducRank(const int32_t * hand)
+{
+	int r0 = hand[0] / 2, r1 = hand[1] / 2;
+	return r0 == r1 ? 10 + r0 : 1 + r0;
+}
+
+/// Hold'em: 2 pocket cards, flop, turn, river.
+static const int32_t HE_PLAYER[] = {2, 0, 0, 0};
+static const int32_t HE_SHARED[] = {0, 3, 1, 1};
+
+static void CreateLeducRanks(const mc_generator & g, vector<uint32_t> & ranks)
+{
+	const hand_indexer & indexer = g.indexer();
+	ranks.resize((size_t)indexer.size(1));
+	for(uint64_t i = 0; i < indexer.size(1); ++i)
+	{
+		int32_t hand[2];
+		indexer.unindex(1, i, hand);
+		ranks[i] = LeducRank(hand);
+	}
+}
+
+static void WriteInt32(string & s, uint32_t v)
+{
+	s.append((const char*)&v, 4);
+}
+
+static void WriteString(string & s, const string & v)
+{
+	// Strings are short here, 1-byte length prefix.
+	s.push_back((char)v.size());
+	s.append(v);
+}
+
+/// Writes a LUT file in the format of LutEvaluatorGenerator.SaveLut().
+static string WriteLutFile(const char * name, const vector<uint32_t> & lut)
+{
+	string fields;
+	WriteInt32(fields, 1);
+	WriteInt32(fields, 2);
+	WriteInt32(fields, 3);
+	WriteInt32(fields, 4);
+	WriteString(fields, "scm");
+	WriteString(fields, "build");
+	WriteString(fields, "McGenerator test data");
+	WriteString(fields, "");
+
+	string file;
+	WriteInt32(file, 5);
+	WriteInt32(file, (uint32_t)fields.size());
+	file += fields;
+	WriteInt32(file, ai::lib::utils::bds_version::crc32(fields.data(), fields.size()));
+	WriteInt32(file, ai::pkr::stdpoker::lut_evaluator7::LUT_FILE_FORMAT_ID);
+	WriteInt32(file, (uint32_t)lut.size());
+	file.append((const char*)&lut[0], lut.size() * 4);
+
+	string path = _tempDir + "/" + name;
+	FILE * f = fopen(path.c_str(), "wb");
+	VERIFY(f != 0);
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+	return path;
+}
+
+/// Verifies that unindex() and index() are inverse for all hands of all rounds.
+static void VerifyIndexer(int deckSize, int roundsCount, const int32_t * player, const int32_t * shared)
+{
+	int p[hand_indexer::MAX_ROUNDS], s[hand_indexer::MAX_ROUNDS];
+	copy(player, player + roundsCount, p);
+	copy(shared, shared + roundsCount, s);
+	hand_indexer indexer;
+	VERIFY(indexer.init(deckSize, roundsCount, p, s));
+	for(int r = 0; r < roundsCount; ++r)
+	{
+		const int handSize = indexer.hand_size(r);
+		for(uint64_t i = 0; i < indexer.size(r); ++i)
+		{
+			int32_t hand[hand_indexer::MAX_HAND_SIZE];
+			indexer.unindex(r, i, hand);
+			uint64_t used = 0;
+			for(int c = 0; c < handSize; ++c)
+			{
+				VERIFY(hand[c] >= 0 && hand[c] < deckSize);
+				VERIFY(!(used & (1ULL << hand[c])));
+				used |= 1ULL << hand[c];
+			}
+			// Cards within a group are unordered.
+			int start = 0;
+			for(int gr = 0; gr <= r; ++gr)
+			{
+				reverse(hand + start, hand + start + p[gr]);
+				start += p[gr];
+				reverse(hand + start, hand + start + s[gr]);
+				start += s[gr];
+			}
+			uint64_t indexes[hand_indexer::MAX_ROUNDS];
+			indexer.index(hand, indexes);
+			VERIFY(indexes[r] == i);
+		}
+	}
+}
+
+static void Test_HandIndexer()
+{
+	VerifyIndexer(LEDUC_DECK, 2, LEDUC_PLAYER, LEDUC_SHARED);
+	// A small hold'em-like game.
+	const int32_t player[] = {2, 0, 1}, shared[] = {0, 3, 1};
+	VerifyIndexer(16, 3, player, shared);
+
+	hand_indexer indexer;
+	int p[4] = {2, 0, 0, 0}, s[4] = {0, 3, 1, 1};
+	VERIFY(indexer.init(52, 4, p, s));
+	VERIFY(indexer.size(0) == 1326);
+	VERIFY(indexer.size(1) == 1326ULL * 19600);
+	VERIFY(indexer.size(3) == 1326ULL * 19600 * 47 * 46);
+	VERIFY(indexer.hand_size(3) == 7);
+}
+
+/** Leduc HE with identity abstractions (abstract card = hand index): each of 120 deals is a leaf
+with probability 1/120 and a known result.
+*/
+static void Test_Leduc(bool symmetric, int streamsCount)
+{
+	McGenerator * g = McGenerator_Create(LEDUC_DECK, 2, LEDUC_PLAYER, LEDUC_SHARED, streamsCount, 7);
+	VERIFY(g != 0);
+	VERIFY(McGenerator_Run(g, 1000, false) == 0);
+	printf("Expected error: %s\n", McGenerator_GetLastError());
+
+	mc_generator ref;
+	int p[2] = {1, 0}, s[2] = {0, 1};
+	VERIFY(ref.init(LEDUC_DECK, 2, p, s, 1, 0));
+	vector<uint32_t> ranks;
+	CreateLeducRanks(ref, ranks);
+	VERIFY(McGenerator_SetShowdownRanks(g, &ranks[0], ranks.size() - 1) == 0);
+	VERIFY(McGenerator_SetShowdownRanks(g, &ranks[0], ranks.size()));
+	for(int r = 0; r < 2; ++r)
+	{
+		vector<uint8_t> buckets((size_t)McGenerator_GetHandsCount(g, r));
+		for(size_t i = 0; i < buckets.size(); ++i)
+		{
+			buckets[i] = (uint8_t)i;
+		}
+		VERIFY(McGenerator_SetAbstraction(g, 0, r, &buckets[0], buckets.size() + 1) == 0);
+		VERIFY(McGenerator_SetAbstraction(g, 0, r, &buckets[0], buckets.size()));
+		VERIFY(McGenerator_SetAbstraction(g, 1, r, &buckets[0], buckets.size()));
+	}
+
+	const uint64_t samplesCount = 1200000;
+	// Several runs, as done by CtMcGen.GenerateNative() between feedback calls.
+	for(int run = 0; run < 3; ++run)
+	{
+		VERIFY(McGenerator_Run(g, samplesCount / 3, symmetric));
+	}
+	VERIFY(McGenerator_GetSamplesCount(g) == samplesCount);
+	uint64_t leavesCount = McGenerator_MergeLeaves(g);
+	VERIFY(leavesCount == 120);
+	vector<uint8_t> cards(leavesCount * 4);
+	vector<uint64_t> counts(leavesCount), results(leavesCount);
+	McGenerator_GetLeaves(g, &cards[0], &counts[0], &results[0]);
+
+	uint64_t sumCount = 0;
+	const double expCount = (double)samplesCount / 120;
+	for(size_t l = 0; l < leavesCount; ++l)
+	{
+		const uint8_t * c = &cards[l * 4];
+		if(l > 0)
+		{
+			VERIFY(memcmp(c - 4, c, 4) < 0);
+		}
+		// Cards: pos 0 round 0, pos 1 round 0, pos 0 round 1, pos 1 round 1.
+		int32_t hand0[2], hand1[2];
+		ref.indexer().unindex(1, c[2], hand0);
+		ref.indexer().unindex(1, c[3], hand1);
+		VERIFY(hand0[0] == c[0] && hand1[0] == c[1] && hand0[1] == hand1[1]);
+		uint32_t r0 = LeducRank(hand0), r1 = LeducRank(hand1);
+		uint64_t outcome = r0 > r1 ? 2 : (r0 == r1 ? 1 : 0);
+		VERIFY(results[l] == outcome * counts[l]);
+		VERIFY(fabs(counts[l] - expCount) < 6 * sqrt(expCount));
+		sumCount += counts[l];
+	}
+	VERIFY(sumCount == samplesCount);
+	McGenerator_Destroy(g);
+}
+
+static void GetLeaves(mc_generator & g, vector<mc_leaf> & leaves)
+{
+	g.get_leaves(leaves);
+	VERIFY(!leaves.empty());
+}
+
+/// The result depends only on the seed and the number of streams.
+static void Test_Reproducible()
+{
+	int p[2] = {1, 0}, s[2] = {0, 1};
+	vector<mc_leaf> leaves[3];
+	for(int i = 0; i < 3; ++i)
+	{
+		mc_generator g;
+		VERIFY(g.init(LEDUC_DECK, 2, p, s, 5, i < 2 ? 1 : 2));
+		vector<uint32_t> ranks;
+		CreateLeducRanks(g, ranks);
+		VERIFY(g.set_showdown_ranks(&ranks[0], ranks.size()));
+		vector<uint8_t> buckets((size_t)g.indexer().size(1));
+		for(size_t b = 0; b < buckets.size(); ++b)
+		{
+			buckets[b] = (uint8_t)b;
+		}
+		VERIFY(g.set_abstraction(0, 1, &buckets[0], buckets.size()));
+		VERIFY(g.set_abstraction(1, 1, &buckets[0], buckets.size()));
+		VERIFY(g.run(10001, false));
+		GetLeaves(g, leaves[i]);
+	}
+	VERIFY(leaves[0].size() == leaves[1].size());
+	bool sameSeedEqual = true, otherSeedEqual = leaves[0].size() == leaves[2].size();
+	for(size_t l = 0; l < leaves[0].size(); ++l)
+	{
+		sameSeedEqual = sameSeedEqual && leaves[0][l].key == leaves[1][l].key && leaves[0][l].count == leaves[1][l].count;
+		otherSeedEqual = otherSeedEqual && leaves[0][l].count == leaves[2][l].count;
+	}
+	VERIFY(sameSeedEqual);
+	VERIFY(!otherSeedEqual);
+}
+
+/// Hold'em with a LUT showdown and a preflop abstraction only.
+static void Test_HoldemLut()
+{
+	// A LUT where all hands have the same value, so each deal is a tie.
+	vector<uint32_t> lut(52 * 7);
+	for(int l = 0; l < 7; ++l)
+	{
+		for(int c = 0; c < 52; ++c)
+		{
+			lut[l * 52 + c] = l < 6 ? 52 * (l + 1) : 1234;
+		}
+	}
+	string path = WriteLutFile("McGenerator-test.dat", lut);
+	McGenerator * g = McGenerator_Create(52, 4, HE_PLAYER, HE_SHARED, 3, 1);
+	VERIFY(g != 0);
+	VERIFY(McGenerator_SetShowdownLut(g, path.c_str()));
+	vector<uint8_t> buckets((size_t)McGenerator_GetHandsCount(g, 0));
+	for(size_t i = 0; i < buckets.size(); ++i)
+	{
+		int32_t hand[2];
+		McGenerator_GetHands(g, 0, i, 1, hand);
+		// Pair or not.
+		buckets[i] = hand[0] / 4 == hand[1] / 4 ? 1 : 0;
+	}
+	VERIFY(McGenerator_SetAbstraction(g, 0, 0, &buckets[0], buckets.size()));
+	VERIFY(McGenerator_SetAbstraction(g, 1, 0, &buckets[0], buckets.size()));
+	VERIFY(McGenerator_Run(g, 100000, true));
+	uint64_t leavesCount = McGenerator_MergeLeaves(g);
+	VERIFY(leavesCount == 4);
+	vector<uint8_t> cards(leavesCount * 8);
+	vector<uint64_t> counts(leavesCount), results(leavesCount);
+	McGenerator_GetLeaves(g, &cards[0], &counts[0], &results[0]);
+	uint64_t sumCount = 0;
+	for(size_t l = 0; l < leavesCount; ++l)
+	{
+		VERIFY(results[l] == counts[l]);
+		for(int c = 2; c < 8; ++c)
+		{
+			VERIFY(cards[l * 8 + c] == 0);
+		}
+		sumCount += counts[l];
+	}
+	VERIFY(sumCount == 100000);
+	McGenerator_Destroy(g);
+
+	// Bad configurations.
+	g = McGenerator_Create(LEDUC_DECK, 2, LEDUC_PLAYER, LEDUC_SHARED, 1, 1);
+	VERIFY(McGenerator_SetShowdownLut(g, path.c_str()) == 0);
+	printf("Expected error: %s\n", McGenerator_GetLastError());
+	McGenerator_Destroy(g);
+	const int32_t tooManyCards[] = {5, 0};
+	VERIFY(McGenerator_Create(LEDUC_DECK, 2, tooManyCards, LEDUC_SHARED, 1, 1) == 0);
+	printf("Expected error: %s\n", McGenerator_GetLastError());
+	remove(path.c_str());
+}
+
+static int Test()
+{
+	try
+	{
+		Test_HandIndexer();
+		Test_Leduc(false, 1);
+		Test_Leduc(false, 4);
+		Test_Leduc(true, 3);
+		Test_Reproducible();
+		Test_HoldemLut();
+	}
+	catch(const char * e)
+	{
+		printf("%s\n", e);
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+
+static void PrintResult(const char * name, const mc_generator & g, double time)
+{
+	vector<mc_leaf> leaves;
+	g.get_leaves(leaves);
+	printf("%-8s samples: %llu, leaves: %u, time: %.3f s, %.0f samples/s\n", name,
+		(unsigned long long)g.samples_count(), (unsigned)leaves.size(), time, g.samples_count() / time);
+}
+
+static int Benchmark(uint64_t samplesCount, int streamsCount, const char * lutPath)
+{
+	{
+		mc_generator g;
+		int p[2] = {1, 0}, s[2] = {0, 1};
+		g.init(LEDUC_DECK, 2, p, s, streamsCount, 1);
+		vector<uint32_t> ranks;
+		CreateLeducRanks(g, ranks);
+		g.set_showdown_ranks(&ranks[0], ranks.size());
+		// Identity abstraction, as for the exact game.
+		for(int r = 0; r < 2; ++r)
+		{
+			vector<uint8_t> buckets((size_t)g.indexer().size(r));
+			for(size_t i = 0; i < buckets.size(); ++i)
+			{
+				buckets[i] = (uint8_t)i;
+			}
+			g.set_abstraction(0, r, &buckets[0], buckets.size());
+			g.set_abstraction(1, r, &buckets[0], buckets.size());
+		}
+		double start = Now();
+		g.run(samplesCount, true);
+		PrintResult("leduc", g, Now() - start);
+	}
+	if(lutPath != 0)
+	{
+		mc_generator g;
+		int p[4] = {2, 0, 0, 0}, s[4] = {0, 3, 1, 1};
+		g.init(52, 4, p, s, streamsCount, 1);
+		if(!g.set_showdown_lut(lutPath))
+		{
+			printf("%s\n", g.error().c_str());
+			return 1;
+		}
+		// Random buckets of a typical size (8 per round) for preflop and flop.
+		rng random(1);
+		for(int r = 0; r < 2; ++r)
+		{
+			vector<uint8_t> buckets((size_t)g.indexer().size(r));
+			for(size_t i = 0; i < buckets.size(); ++i)
+			{
+				buckets[i] = (uint8_t)random.next(8);
+			}
+			g.set_abstraction(0, r, &buckets[0], buckets.size());
+			g.set_abstraction(1, r, &buckets[0], buckets.size());
+		}
+		double start = Now();
+		g.run(samplesCount, true);
+		PrintResult("holdem", g, Now() - start);
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "test") == 0)
+	{
+		if(argc >= 3)
+		{
+			_tempDir = argv[2];
+		}
+		return Test();
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark") == 0)
+	{
+		return Benchmark(argc >= 3 ? strtoull(argv[2], 0, 10) : 20000000,
+			argc >= 4 ? atoi(argv[3]) : 1, argc >= 5 ? argv[4] : 0);
+	}
+	printf("Usage:\n"
+		"%s test [temp-dir]\n"
+		"%s benchmark [samples] [streams] [LutEvaluator7.dat]\n", argv[0], argv[0]);
+	return 1;
+}
@@ -0,0 +1,157 @@
+// ai.pkr.ctmcgen.cpplib.cpp : Defines the exported functions of the library.
+//
+
+#include <string>
+#include <vector>
+#include "ai.pkr.ctmcgen.cpplib.h"
+#include "mc_generator.h"
+
+using namespace ai::pkr::ctmcgen;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL char _lastError[256];
+
+static void SetError(const std::string & error)
+{
+	std::size_t length = error.copy(_lastError, sizeof(_lastError) - 1);
+	_lastError[length] = 0;
+}
+
+struct McGenerator
+{
+	mc_generator generator;
+	std::vector<mc_leaf> leaves;
+};
+
+extern "C"
+{
+
+AIPKRCTMCGENCPPLIB_API McGenerator * McGenerator_Create(int deckSize, int roundsCount,
+	const int32_t * playerCards, const int32_t * sharedCards, int streamsCount, uint64_t seed)
+{
+	if(roundsCount < 1 || roundsCount > hand_indexer::MAX_ROUNDS)
+	{
+		SetError("unsupported number of rounds");
+		return 0;
+	}
+	int player[hand_indexer::MAX_ROUNDS], shared[hand_indexer::MAX_ROUNDS];
+	for(int r = 0; r < roundsCount; ++r)
+	{
+		player[r] = playerCards[r];
+		shared[r] = sharedCards[r];
+	}
+	McGenerator * g = new McGenerator;
+	if(!g->generator.init(deckSize, roundsCount, player, shared, streamsCount, seed))
+	{
+		SetError(g->generator.error());
+		delete g;
+		return 0;
+	}
+	return g;
+}
+
+AIPKRCTMCGENCPPLIB_API void McGenerator_Destroy(McGenerator * g)
+{
+	delete g;
+}
+
+AIPKRCTMCGENCPPLIB_API const char * McGenerator_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRCTMCGENCPPLIB_API uint64_t McGenerator_GetHandsCount(const McGenerator * g, int round)
+{
+	return g->generator.indexer().size(round);
+}
+
+AIPKRCTMCGENCPPLIB_API int McGenerator_GetHandSize(const McGenerator * g, int round)
+{
+	return g->generator.indexer().hand_size(round);
+}
+
+AIPKRCTMCGENCPPLIB_API void McGenerator_GetHands(const McGenerator * g, int round, uint64_t first, uint32_t count,
+	int32_t * hands)
+{
+	const hand_indexer & indexer = g->generator.indexer();
+	const int handSize = indexer.hand_size(round);
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		indexer.unindex(round, first + i, hands + (std::size_t)handSize * i);
+	}
+}
+
+AIPKRCTMCGENCPPLIB_API int McGenerator_SetAbstraction(McGenerator * g, int position, int round,
+	const uint8_t * buckets, uint64_t size)
+{
+	if(!g->generator.set_abstraction(position, round, buckets, size))
+	{
+		SetError(g->generator.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRCTMCGENCPPLIB_API int McGenerator_SetShowdownLut(McGenerator * g, const char * lutPath)
+{
+	if(!g->generator.set_showdown_lut(lutPath))
+	{
+		SetError(g->generator.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRCTMCGENCPPLIB_API int McGenerator_SetShowdownRanks(McGenerator * g, const uint32_t * ranks, uint64_t size)
+{
+	if(!g->generator.set_showdown_ranks(ranks, size))
+	{
+		SetError(g->generator.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRCTMCGENCPPLIB_API int McGenerator_Run(McGenerator * g, uint64_t samplesCount, int symmetric)
+{
+	if(!g->generator.run(samplesCount, symmetric != 0))
+	{
+		SetError(g->generator.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRCTMCGENCPPLIB_API uint64_t McGenerator_GetSamplesCount(const McGenerator * g)
+{
+	return g->generator.samples_count();
+}
+
+AIPKRCTMCGENCPPLIB_API uint64_t McGenerator_MergeLeaves(McGenerator * g)
+{
+	g->generator.get_leaves(g->leaves);
+	return g->leaves.size();
+}
+
+AIPKRCTMCGENCPPLIB_API void McGenerator_GetLeaves(const McGenerator * g, uint8_t * cards, uint64_t * counts,
+	uint64_t * results)
+{
+	const int cardsCount = g->generator.cards_count();
+	for(std::size_t i = 0; i < g->leaves.size(); ++i)
+	{
+		const mc_leaf & leaf = g->leaves[i];
+		for(int c = 0; c < cardsCount; ++c)
+		{
+			cards[cardsCount * i + c] = (uint8_t)(leaf.key >> (8 * (cardsCount - 1 - c)));
+		}
+		counts[i] = leaf.count;
+		results[i] = leaf.result;
+	}
+}
+
+}
@@ -0,0 +1,89 @@
+// C interface of ai.pkr.ctmcgen.cpplib (ai.pkr.ctmcgen.cpplib.dll on Windows,
+// libai.pkr.ctmcgen.cpplib.so on Linux). Used by ai.pkr.ctmcgen.CppLib (C#).
+//
+// All files within this library are compiled with the AIPKRCTMCGENCPPLIB_EXPORTS
+// symbol defined. This symbol should not be defined on any project
+// that uses this library. This way any other project whose source files include
+// this file see AIPKRCTMCGENCPPLIB_API functions as being imported, whereas the library
+// sees symbols defined with this macro as being exported.
+
+#ifndef AI_PKR_CTMCGEN_CPPLIB_H
+#define AI_PKR_CTMCGEN_CPPLIB_H
+
+#if defined(_WIN32)
+	#ifdef AIPKRCTMCGENCPPLIB_EXPORTS
+		#define AIPKRCTMCGENCPPLIB_API __declspec(dllexport)
+	#else
+		#define AIPKRCTMCGENCPPLIB_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AIPKRCTMCGENCPPLIB_API __attribute__((visibility("default")))
+#else
+	#define AIPKRCTMCGENCPPLIB_API
+#endif
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Opaque handle of a Monte-Carlo chance tree generator.
+typedef struct McGenerator McGenerator;
+
+/// Creates a generator for a heads-up game. playerCards[r], sharedCards[r]: number of cards
+/// of a player (private and public) and of shared cards dealt in round r.
+/// The samples are split into streamsCount independent streams (usually the number of cores),
+/// the result is reproducible for the same seed and streamsCount.
+/// Returns 0 on error, see McGenerator_GetLastError().
+AIPKRCTMCGENCPPLIB_API McGenerator * McGenerator_Create(int deckSize, int roundsCount,
+	const int32_t * playerCards, const int32_t * sharedCards, int streamsCount, uint64_t seed);
+
+AIPKRCTMCGENCPPLIB_API void McGenerator_Destroy(McGenerator * g);
+
+/// Description of the last error in this thread.
+AIPKRCTMCGENCPPLIB_API const char * McGenerator_GetLastError();
+
+/// Number of hands (indexes) up to and including the round.
+AIPKRCTMCGENCPPLIB_API uint64_t McGenerator_GetHandsCount(const McGenerator * g, int round);
+
+/// Number of cards of a hand up to and including the round.
+AIPKRCTMCGENCPPLIB_API int McGenerator_GetHandSize(const McGenerator * g, int round);
+
+/// Stores hands with indexes first .. first+count-1 of the round to hands
+/// (McGenerator_GetHandSize() cards each), in the deal order of McDealer.
+AIPKRCTMCGENCPPLIB_API void McGenerator_GetHands(const McGenerator * g, int round, uint64_t first, uint32_t count,
+	int32_t * hands);
+
+/// Sets the abstract cards (buckets[hand index]) of a position and round,
+/// size must be McGenerator_GetHandsCount(round). Returns 0 on error.
+AIPKRCTMCGENCPPLIB_API int McGenerator_SetAbstraction(McGenerator * g, int position, int round,
+	const uint8_t * buckets, uint64_t size);
+
+/// Showdown by a 7-card LUT (LutEvaluator7.dat). Returns 0 on error.
+AIPKRCTMCGENCPPLIB_API int McGenerator_SetShowdownLut(McGenerator * g, const char * lutPath);
+
+/// Showdown by hand ranks indexed by the hand index of the last round. Returns 0 on error.
+AIPKRCTMCGENCPPLIB_API int McGenerator_SetShowdownRanks(McGenerator * g, const uint32_t * ranks, uint64_t size);
+
+/// Adds samplesCount samples. If symmetric is not 0, each deal updates 2 leaves (equal abstractions).
+/// Returns 0 on error.
+AIPKRCTMCGENCPPLIB_API int McGenerator_Run(McGenerator * g, uint64_t samplesCount, int symmetric);
+
+/// Total number of samples done.
+AIPKRCTMCGENCPPLIB_API uint64_t McGenerator_GetSamplesCount(const McGenerator * g);
+
+/// Merges the leaves of all streams, returns the number of leaves.
+/// The leaves are then available by McGenerator_GetLeaves().
+AIPKRCTMCGENCPPLIB_API uint64_t McGenerator_MergeLeaves(McGenerator * g);
+
+/// Copies the merged leaves sorted by cards: cards[2*roundsCount*i ...] (abstract cards),
+/// counts[i], results[i] (player 0, win: 2, tie: 1).
+AIPKRCTMCGENCPPLIB_API void McGenerator_GetLeaves(const McGenerator * g, uint8_t * cards, uint64_t * counts,
+	uint64_t * results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
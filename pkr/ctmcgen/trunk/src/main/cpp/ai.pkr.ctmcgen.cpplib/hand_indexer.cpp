@@ -0,0 +1,130 @@
+#include <sstream>
+#include "hand_indexer.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace ctmcgen
+		{
+
+			bool hand_indexer::init(int deck_size, int rounds_count, const int * player_cards, const int * shared_cards)
+			{
+				_rounds_count = 0;
+				_groups_count = 0;
+				if(deck_size < 1 || deck_size > MAX_DECK_SIZE)
+				{
+					return fail("unsupported deck size");
+				}
+				if(rounds_count < 1 || rounds_count > MAX_ROUNDS)
+				{
+					return fail("unsupported number of rounds");
+				}
+				_deck_size = deck_size;
+				for(int n = 0; n <= MAX_DECK_SIZE; ++n)
+				{
+					for(int k = 0; k <= MAX_GROUP_SIZE; ++k)
+					{
+						_combin[n][k] = k == 0 ? 1 : (n == 0 ? 0 : _combin[n - 1][k - 1] + _combin[n - 1][k]);
+					}
+				}
+
+				int handSize = 0;
+				uint64_t size = 1;
+				for(int r = 0; r < rounds_count; ++r)
+				{
+					const int counts[2] = {player_cards[r], shared_cards[r]};
+					for(int i = 0; i < 2; ++i)
+					{
+						if(counts[i] < 0 || counts[i] > MAX_GROUP_SIZE)
+						{
+							return fail("unsupported number of cards in a round");
+						}
+						if(counts[i] == 0)
+						{
+							continue;
+						}
+						group & g = _groups[_groups_count++];
+						g.size = counts[i];
+						g.start = handSize;
+						g.available = deck_size - handSize;
+						if(g.available < g.size)
+						{
+							return fail("not enough cards in the deck");
+						}
+						g.count = _combin[g.available][g.size];
+						if(size > UINT64_MAX / g.count)
+						{
+							std::ostringstream os;
+							os << "too many hands in round " << r;
+							return fail(os.str());
+						}
+						size *= g.count;
+						handSize += g.size;
+					}
+					_round_groups_end[r] = _groups_count;
+					_hand_size[r] = handSize;
+					_size[r] = size;
+				}
+				_rounds_count = rounds_count;
+				return true;
+			}
+
+			void hand_indexer::unindex(int round, uint64_t index, int32_t * hand) const
+			{
+				const int groupsEnd = _round_groups_end[round];
+				uint64_t colex[2 * MAX_ROUNDS];
+				for(int g = groupsEnd - 1; g >= 0; --g)
+				{
+					colex[g] = index % _groups[g].count;
+					index /= _groups[g].count;
+				}
+				uint64_t used = 0;
+				for(int g = 0; g < groupsEnd; ++g)
+				{
+					const group & gr = _groups[g];
+					// Unrank the colex index to the positions among the available cards.
+					int cs[MAX_GROUP_SIZE];
+					uint64_t rest = colex[g];
+					int x = gr.available;
+					for(int i = gr.size - 1; i >= 0; --i)
+					{
+						do
+						{
+							--x;
+						} while(_combin[x][i + 1] > rest);
+						cs[i] = x;
+						rest -= _combin[x][i + 1];
+					}
+					// Map the positions to the cards, skipping the cards of the previous groups.
+					int pos = 0;
+					int i = 0;
+					for(int c = 0; c < _deck_size && i < gr.size; ++c)
+					{
+						if(used & (1ULL << c))
+						{
+							continue;
+						}
+						if(pos == cs[i])
+						{
+							hand[gr.start + i] = c;
+							++i;
+						}
+						++pos;
+					}
+					for(i = 0; i < gr.size; ++i)
+					{
+						used |= 1ULL << hand[gr.start + i];
+					}
+				}
+			}
+
+			bool hand_indexer::fail(const std::string & error)
+			{
+				_error = error;
+				return false;
+			}
+
+		}
+	}
+}
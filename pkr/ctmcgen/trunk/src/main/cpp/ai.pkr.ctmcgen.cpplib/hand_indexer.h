@@ -0,0 +1,158 @@
+#ifndef AI_PKR_CTMCGEN_CPPLIB_HAND_INDEXER_H
+#define AI_PKR_CTMCGEN_CPPLIB_HAND_INDEXER_H
+
+#include <stdint.h>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AI_PKR_CTMCGEN_POPCOUNT64(x) ((int)__popcnt64(x))
+#else
+#define AI_PKR_CTMCGEN_POPCOUNT64(x) __builtin_popcountll(x)
+#endif
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace ctmcgen
+		{
+
+			/** Maps hands of a game to dense indexes 0..size(round)-1 and back.
+
+			The cards of a hand are dealt as in McDealer (C#): for each round first the player's
+			(private and public) cards, then the shared cards. Each such group of cards is unordered,
+			so a group of k cards out of n remaining cards is indexed by its colex rank (0..C(n,k)-1),
+			the hand index is the mixed-radix number of the group ranks.
+
+			The index is exact (not suit-isomorphic), it is small enough for tables of model games and
+			of the first rounds of hold'em.
+			*/
+			class hand_indexer
+			{
+			public:
+
+				static const int MAX_DECK_SIZE = 64;
+				static const int MAX_ROUNDS = 8;
+				static const int MAX_GROUP_SIZE = 8;
+				static const int MAX_HAND_SIZE = 2 * MAX_ROUNDS * MAX_GROUP_SIZE;
+
+				hand_indexer() : _rounds_count(0), _groups_count(0)
+				{
+				}
+
+				/** Sets up the indexer for a game.
+				@param player_cards number of private and public cards of a player in each round.
+				@param shared_cards number of shared cards in each round.
+				@return false on error, see error().
+				*/
+				bool init(int deck_size, int rounds_count, const int * player_cards, const int * shared_cards);
+
+				/// Description of the last error.
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				int deck_size() const
+				{
+					return _deck_size;
+				}
+
+				int rounds_count() const
+				{
+					return _rounds_count;
+				}
+
+				/// Number of cards of a hand up to and including the round.
+				int hand_size(int round) const
+				{
+					return _hand_size[round];
+				}
+
+				/// Number of distinct hands up to and including the round.
+				uint64_t size(int round) const
+				{
+					return _size[round];
+				}
+
+				/// Calculates the index of the hand for each round (indexes[0..rounds_count()-1]).
+				void index(const int32_t * hand, uint64_t * indexes) const
+				{
+					uint64_t used = 0;
+					uint64_t idx = 0;
+					int g = 0;
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						for(; g < _round_groups_end[r]; ++g)
+						{
+							const group & gr = _groups[g];
+							int cs[MAX_GROUP_SIZE];
+							for(int i = 0; i < gr.size; ++i)
+							{
+								int c = hand[gr.start + i];
+								cs[i] = c - AI_PKR_CTMCGEN_POPCOUNT64(used & ((1ULL << c) - 1));
+							}
+							// Insertion sort, groups are small.
+							for(int i = 1; i < gr.size; ++i)
+							{
+								int c = cs[i];
+								int j = i;
+								for(; j > 0 && cs[j - 1] > c; --j)
+								{
+									cs[j] = cs[j - 1];
+								}
+								cs[j] = c;
+							}
+							uint64_t colex = 0;
+							for(int i = 0; i < gr.size; ++i)
+							{
+								colex += _combin[cs[i]][i + 1];
+							}
+							idx = idx * gr.count + colex;
+							for(int i = 0; i < gr.size; ++i)
+							{
+								used |= 1ULL << hand[gr.start + i];
+							}
+						}
+						indexes[r] = idx;
+					}
+				}
+
+				/** Restores the hand of the round from the index. The cards of each group
+				are stored in ascending order.
+				*/
+				void unindex(int round, uint64_t index, int32_t * hand) const;
+
+			private:
+
+				struct group
+				{
+					/// Number of cards.
+					int size;
+					/// Position of the first card in the hand.
+					int start;
+					/// Number of cards available for this group.
+					int available;
+					/// Number of combinations: C(available, size).
+					uint64_t count;
+				};
+
+				bool fail(const std::string & error);
+
+				int _deck_size;
+				int _rounds_count;
+				int _groups_count;
+				group _groups[2 * MAX_ROUNDS];
+				int _round_groups_end[MAX_ROUNDS];
+				int _hand_size[MAX_ROUNDS];
+				uint64_t _size[MAX_ROUNDS];
+				uint64_t _combin[MAX_DECK_SIZE + 1][MAX_GROUP_SIZE + 1];
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
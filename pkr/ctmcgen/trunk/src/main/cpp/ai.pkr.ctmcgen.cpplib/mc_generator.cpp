@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <sstream>
+#include "mc_generator.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace ctmcgen
+		{
+
+			void leaf_table::get_leaves(std::vector<mc_leaf> & result) const
+			{
+				for(std::size_t i = 0; i < _entries.size(); ++i)
+				{
+					if(_entries[i].count != 0)
+					{
+						result.push_back(_entries[i]);
+					}
+				}
+			}
+
+			void leaf_table::grow()
+			{
+				std::vector<mc_leaf> old(_entries.size() * 2);
+				old.swap(_entries);
+				_count = 0;
+				for(std::size_t i = 0; i < old.size(); ++i)
+				{
+					if(old[i].count != 0)
+					{
+						add(old[i].key, old[i].count, old[i].result);
+					}
+				}
+			}
+
+			static bool LessKey(const mc_leaf & a, const mc_leaf & b)
+			{
+				return a.key < b.key;
+			}
+
+			bool mc_generator::init(int deck_size, int rounds_count, const int * player_cards, const int * shared_cards,
+				int streams_count, uint64_t seed)
+			{
+				if(!_indexer.init(deck_size, rounds_count, player_cards, shared_cards))
+				{
+					return fail(_indexer.error());
+				}
+				if(PLAYERS_COUNT * rounds_count > 8)
+				{
+					return fail("too many rounds, the abstract cards of a leaf must fit in 64 bits");
+				}
+				if(streams_count < 1)
+				{
+					return fail("the number of streams must be positive");
+				}
+
+				// Deal order of McDealer: for each round player's cards first, then shared cards.
+				// The shuffled deck contains the shared cards first, then the cards of each player.
+				_player_cards_count = 0;
+				_shared_cards_count = 0;
+				for(int r = 0; r < rounds_count; ++r)
+				{
+					_player_cards_count += player_cards[r];
+					_shared_cards_count += shared_cards[r];
+				}
+				if(PLAYERS_COUNT * _player_cards_count + _shared_cards_count > deck_size)
+				{
+					return fail("not enough cards in the deck");
+				}
+				_deal_pos.clear();
+				_deal_shared.clear();
+				int dealtPlayer = 0, dealtShared = 0;
+				for(int r = 0; r < rounds_count; ++r)
+				{
+					for(int i = 0; i < player_cards[r]; ++i)
+					{
+						_deal_pos.push_back(_shared_cards_count + dealtPlayer++);
+						_deal_shared.push_back(false);
+					}
+					for(int i = 0; i < shared_cards[r]; ++i)
+					{
+						_deal_pos.push_back(dealtShared++);
+						_deal_shared.push_back(true);
+					}
+				}
+
+				_streams_count = streams_count;
+				_streams.clear();
+				_streams.resize(streams_count);
+				for(int s = 0; s < streams_count; ++s)
+				{
+					_streams[s].random = rng(seed * 0x2545F4914F6CDD1DULL + s);
+				}
+				_samples_count = 0;
+				for(int p = 0; p < PLAYERS_COUNT; ++p)
+				{
+					for(int r = 0; r < hand_indexer::MAX_ROUNDS; ++r)
+					{
+						_buckets[p][r].clear();
+					}
+				}
+				_use_lut = false;
+				_ranks.clear();
+				return true;
+			}
+
+			bool mc_generator::set_abstraction(int position, int round, const uint8_t * buckets, uint64_t size)
+			{
+				if(position < 0 || position >= PLAYERS_COUNT || round < 0 || round >= _indexer.rounds_count())
+				{
+					return fail("bad position or round");
+				}
+				if(size != _indexer.size(round))
+				{
+					std::ostringstream os;
+					os << "bucket table size " << size << " does not match the number of hands " << _indexer.size(round)
+						<< " in round " << round;
+					return fail(os.str());
+				}
+				_buckets[position][round].assign(buckets, buckets + size);
+				return true;
+			}
+
+			bool mc_generator::set_showdown_lut(const char * lut_path)
+			{
+				if(_indexer.deck_size() != 52 || _indexer.hand_size(_indexer.rounds_count() - 1) != 7)
+				{
+					return fail("LUT showdown requires 7-card hands from a 52-card deck");
+				}
+				if(!_lut.open(lut_path))
+				{
+					return fail(_lut.error());
+				}
+				_use_lut = true;
+				_ranks.clear();
+				return true;
+			}
+
+			bool mc_generator::set_showdown_ranks(const uint32_t * ranks, uint64_t size)
+			{
+				if(size != _indexer.size(_indexer.rounds_count() - 1))
+				{
+					return fail("rank table size does not match the number of final hands");
+				}
+				_ranks.assign(ranks, ranks + size);
+				_use_lut = false;
+				_lut.close();
+				return true;
+			}
+
+			bool mc_generator::run(uint64_t samples_count, bool symmetric)
+			{
+				if(!_use_lut && _ranks.empty())
+				{
+					return fail("no showdown is set");
+				}
+				// Like CtMcGen.Generate(): with symmetric abstractions a deal counts as 2 samples.
+				const uint64_t updateCount = symmetric ? 2 : 1;
+				const uint64_t dealsCount = (samples_count + updateCount - 1) / updateCount;
+				const int streamsCount = _streams_count;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+				for(int s = 0; s < streamsCount; ++s)
+				{
+					uint64_t begin = dealsCount * s / streamsCount;
+					uint64_t end = dealsCount * (s + 1) / streamsCount;
+					run_stream(_streams[s], end - begin, symmetric);
+				}
+				_samples_count += dealsCount * updateCount;
+				return true;
+			}
+
+			void mc_generator::run_stream(stream & s, uint64_t deals_count, bool symmetric) const
+			{
+				const int deckSize = _indexer.deck_size();
+				const int roundsCount = _indexer.rounds_count();
+				const int handSize = _indexer.hand_size(roundsCount - 1);
+				const int dealCount = PLAYERS_COUNT * _player_cards_count + _shared_cards_count;
+				const int cardsCount = PLAYERS_COUNT * roundsCount;
+
+				int32_t deck[hand_indexer::MAX_DECK_SIZE];
+				for(int c = 0; c < deckSize; ++c)
+				{
+					deck[c] = c;
+				}
+				const uint8_t * buckets[PLAYERS_COUNT][hand_indexer::MAX_ROUNDS];
+				for(int p = 0; p < PLAYERS_COUNT; ++p)
+				{
+					for(int r = 0; r < roundsCount; ++r)
+					{
+						buckets[p][r] = _buckets[p][r].empty() ? 0 : &_buckets[p][r][0];
+					}
+				}
+
+				int32_t hands[PLAYERS_COUNT][hand_indexer::MAX_HAND_SIZE];
+				uint64_t indexes[PLAYERS_COUNT][hand_indexer::MAX_ROUNDS];
+				uint32_t ranks[PLAYERS_COUNT];
+				for(uint64_t d = 0; d < deals_count; ++d)
+				{
+					// Partial Fisher-Yates shuffle of the cards to deal.
+					for(int i = 0; i < dealCount; ++i)
+					{
+						int j = i + (int)s.random.next((uint32_t)(deckSize - i));
+						std::swap(deck[i], deck[j]);
+					}
+					for(int p = 0; p < PLAYERS_COUNT; ++p)
+					{
+						const int playerOffset = p * _player_cards_count;
+						for(int i = 0; i < handSize; ++i)
+						{
+							hands[p][i] = deck[_deal_pos[i] + (_deal_shared[i] ? 0 : playerOffset)];
+						}
+						_indexer.index(hands[p], indexes[p]);
+						ranks[p] = _use_lut ? _lut.evaluate(hands[p]) : _ranks[indexes[p][roundsCount - 1]];
+					}
+
+					uint64_t key = 0, symmetricKey = 0;
+					for(int r = 0; r < roundsCount; ++r)
+					{
+						for(int p = 0; p < PLAYERS_COUNT; ++p)
+						{
+							uint64_t card = buckets[p][r] ? buckets[p][r][indexes[p][r]] : 0;
+							key |= card << (8 * (cardsCount - 1 - (PLAYERS_COUNT * r + p)));
+							symmetricKey |= card << (8 * (cardsCount - 1 - (PLAYERS_COUNT * r + 1 - p)));
+						}
+					}
+					uint64_t result = ranks[0] > ranks[1] ? 2 : (ranks[0] == ranks[1] ? 1 : 0);
+					s.leaves.add(key, 1, result);
+					if(symmetric)
+					{
+						s.leaves.add(symmetricKey, 1, 2 - result);
+					}
+				}
+			}
+
+			void mc_generator::get_leaves(std::vector<mc_leaf> & leaves) const
+			{
+				std::vector<mc_leaf> all;
+				for(int s = 0; s < _streams_count; ++s)
+				{
+					_streams[s].leaves.get_leaves(all);
+				}
+				std::sort(all.begin(), all.end(), LessKey);
+				leaves.clear();
+				for(std::size_t i = 0; i < all.size(); ++i)
+				{
+					if(!leaves.empty() && leaves.back().key == all[i].key)
+					{
+						leaves.back().count += all[i].count;
+						leaves.back().result += all[i].result;
+					}
+					else
+					{
+						leaves.push_back(all[i]);
+					}
+				}
+			}
+
+			bool mc_generator::fail(const std::string & error)
+			{
+				_error = error;
+				return false;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,240 @@
+#ifndef AI_PKR_CTMCGEN_CPPLIB_MC_GENERATOR_H
+#define AI_PKR_CTMCGEN_CPPLIB_MC_GENERATOR_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <lut_evaluator7.h>
+#include "hand_indexer.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace ctmcgen
+		{
+
+			/** xoshiro256** random number generator, seeded by splitmix64.
+			Fast and has independent streams for different seeds.
+			*/
+			class rng
+			{
+			public:
+				explicit rng(uint64_t seed = 0)
+				{
+					for(int i = 0; i < 4; ++i)
+					{
+						seed += 0x9E3779B97F4A7C15ULL;
+						uint64_t z = seed;
+						z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+						z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+						_s[i] = z ^ (z >> 31);
+					}
+				}
+
+				uint64_t next()
+				{
+					const uint64_t result = rotl(_s[1] * 5, 7) * 9;
+					const uint64_t t = _s[1] << 17;
+					_s[2] ^= _s[0];
+					_s[3] ^= _s[1];
+					_s[1] ^= _s[2];
+					_s[0] ^= _s[3];
+					_s[2] ^= t;
+					_s[3] = rotl(_s[3], 45);
+					return result;
+				}
+
+				/// Uniform random number in [0, n), n <= 2^32.
+				uint32_t next(uint32_t n)
+				{
+					// Multiply-shift, the bias is below 2^-32 * n, negligible for decks.
+					return (uint32_t)(((next() >> 32) * n) >> 32);
+				}
+
+			private:
+				static uint64_t rotl(uint64_t x, int k)
+				{
+					return (x << k) | (x >> (64 - k));
+				}
+
+				uint64_t _s[4];
+			};
+
+			/** Counts of a leaf of the chance tree, like CtMcGen.LeafT (C#).
+			*/
+			struct mc_leaf
+			{
+				/// Abstract cards of the leaf, card i is in byte (cards_count - 1 - i),
+				/// so that the order of keys is the lexicographical order of the cards.
+				uint64_t key;
+				/// Total visits count.
+				uint64_t count;
+				/// Total result of player 0, each win adds 2, each tie 1.
+				uint64_t result;
+			};
+
+			/** Open-addressing hash table of leaves. The leaves are never removed.
+			*/
+			class leaf_table
+			{
+			public:
+				leaf_table() : _count(0)
+				{
+					_entries.resize(1 << 10);
+				}
+
+				void add(uint64_t key, uint64_t count, uint64_t result)
+				{
+					if(2 * (_count + 1) > _entries.size())
+					{
+						grow();
+					}
+					const std::size_t mask = _entries.size() - 1;
+					for(std::size_t i = hash(key) & mask; ; i = (i + 1) & mask)
+					{
+						mc_leaf & e = _entries[i];
+						if(e.count == 0)
+						{
+							e.key = key;
+							e.count = count;
+							e.result = result;
+							++_count;
+							return;
+						}
+						if(e.key == key)
+						{
+							e.count += count;
+							e.result += result;
+							return;
+						}
+					}
+				}
+
+				/// Appends all leaves to result in unspecified order.
+				void get_leaves(std::vector<mc_leaf> & result) const;
+
+			private:
+				static std::size_t hash(uint64_t key)
+				{
+					return (std::size_t)((key * 0x9E3779B97F4A7C15ULL) >> 20);
+				}
+
+				void grow();
+
+				/// An entry with count 0 is empty.
+				std::vector<mc_leaf> _entries;
+				std::size_t _count;
+			};
+
+			/** Native Monte-Carlo generator of chance trees, native version of CtMcGen.Generate() (C#)
+			for heads-up games.
+
+			The work is split into thread_count streams, each with its own RNG (seeded by the seed and
+			the stream number) and leaf table. The streams run in parallel with OpenMP (if available),
+			the tables are merged when the leaves are retrieved. The result depends only on the seed,
+			the number of streams and the sequence of run() calls, not on the actual number of threads.
+
+			Abstract cards are looked up in bucket tables indexed by hand_indexer, one table for each
+			position and round. They are precomputed from any chance abstraction (see CtMcGen.GenerateNative()).
+			The showdown is done either by a 7-card LUT (LutEvaluator7.dat, for hold'em) or by a table
+			of hand ranks indexed by the index of the final hand (for model games).
+			*/
+			class mc_generator
+			{
+			public:
+
+				static const int PLAYERS_COUNT = 2;
+
+				mc_generator() : _streams_count(0), _samples_count(0), _use_lut(false)
+				{
+				}
+
+				/** Sets up the generator for a game (see hand_indexer::init()).
+				@return false on error, see error().
+				*/
+				bool init(int deck_size, int rounds_count, const int * player_cards, const int * shared_cards,
+					int streams_count, uint64_t seed);
+
+				/// Description of the last error.
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				const hand_indexer & indexer() const
+				{
+					return _indexer;
+				}
+
+				/** Sets the bucket table of a position and round (a copy is stored),
+				size must be indexer().size(round). Without a table all hands of the round have abstract card 0.
+				*/
+				bool set_abstraction(int position, int round, const uint8_t * buckets, uint64_t size);
+
+				/// Showdown by a 7-card LUT, the hands must have 7 cards from a 52-card deck.
+				bool set_showdown_lut(const char * lut_path);
+
+				/// Showdown by hand ranks, size must be indexer().size(rounds_count - 1).
+				bool set_showdown_ranks(const uint32_t * ranks, uint64_t size);
+
+				/** Adds samples_count samples (tree updates). With symmetric (equal) abstractions
+				each deal updates 2 leaves, the second one with swapped positions.
+				*/
+				bool run(uint64_t samples_count, bool symmetric);
+
+				/// Number of samples done (sum of leaf counts).
+				uint64_t samples_count() const
+				{
+					return _samples_count;
+				}
+
+				/// Number of abstract cards of a leaf (players * rounds).
+				int cards_count() const
+				{
+					return PLAYERS_COUNT * _indexer.rounds_count();
+				}
+
+				/// Merged leaves sorted by the cards.
+				void get_leaves(std::vector<mc_leaf> & leaves) const;
+
+			private:
+
+				struct stream
+				{
+					rng random;
+					leaf_table leaves;
+				};
+
+				void run_stream(stream & s, uint64_t deals_count, bool symmetric) const;
+
+				bool fail(const std::string & error);
+
+				hand_indexer _indexer;
+				/// Deal pattern as in McDealer: for each card of a hand, its position in the shuffled deck
+				/// for player 0, and whether it is shared.
+				std::vector<int> _deal_pos;
+				std::vector<bool> _deal_shared;
+				int _player_cards_count;
+				int _shared_cards_count;
+
+				std::vector<stream> _streams;
+				int _streams_count;
+				uint64_t _samples_count;
+
+				/// [position][round], empty: no abstraction.
+				std::vector<uint8_t> _buckets[PLAYERS_COUNT][hand_indexer::MAX_ROUNDS];
+
+				bool _use_lut;
+				ai::pkr::stdpoker::lut_evaluator7 _lut;
+				std::vector<uint32_t> _ranks;
+
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
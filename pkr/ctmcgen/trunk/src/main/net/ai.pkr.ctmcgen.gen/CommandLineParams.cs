@@ -30,6 +30,18 @@ namespace ai.pkr.ctmcgen.gen
         DefaultValue = new string[0], HelpText = "Chance abstraction property file. If the same file is used for all absractions, they are considered equal.")]
         public PropString[] ChanceAbstractionFiles;
 
+        [Argument(ArgumentType.AtMostOnce, LongName = "native",
+        DefaultValue = false, HelpText = "Generate in the native library (faster, abstract cards are precomputed for all hands of each round).")]
+        public bool Native;
+
+        [Argument(ArgumentType.AtMostOnce, LongName = "threads",
+        DefaultValue = 0, HelpText = "Number of parallel streams for --native. A non-positive number: number of processors.")]
+        public int ThreadsCount;
+
+        [Argument(ArgumentType.AtMostOnce, LongName = "showdown-lut",
+        DefaultValue = "", HelpText = "Showdown by LutEvaluator7.dat for --native (hold'em). If empty, hand ranks are precomputed by the game rules.")]
+        public PropString ShowdownLut;
+
         [Argument(ArgumentType.AtMostOnce, LongName = "add-ca-names",
         DefaultValue = true, HelpText = "Add names of CAs to the output file names.")]
         public bool AddCaNames;
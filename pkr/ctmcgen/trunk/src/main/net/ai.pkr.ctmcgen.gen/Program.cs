@@ -78,7 +78,18 @@ namespace ai.pkr.ctmcgen.gen
 
                 DateTime startTime = DateTime.Now;
 
-                CtMcGen.Tree tree = CtMcGen.Generate(gd, chanceAbstractions, areAbstractionsEqual, _cmdLine.SamplesCount, rngSeed, Feedback);
+                CtMcGen.Tree tree;
+                if (_cmdLine.Native)
+                {
+                    int streamsCount = _cmdLine.ThreadsCount > 0 ? _cmdLine.ThreadsCount : Environment.ProcessorCount;
+                    string lutPath = _cmdLine.ShowdownLut.Get(Props.Global);
+                    tree = CtMcGen.GenerateNative(gd, chanceAbstractions, areAbstractionsEqual, _cmdLine.SamplesCount, rngSeed, 
+                        streamsCount, lutPath == "" ? null : lutPath, Feedback);
+                }
+                else
+                {
+                    tree = CtMcGen.Generate(gd, chanceAbstractions, areAbstractionsEqual, _cmdLine.SamplesCount, rngSeed, Feedback);
+                }
 
                 double genTime = (DateTime.Now - startTime).TotalSeconds;
 
@@ -0,0 +1,148 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+using ai.lib.utils;
+using System.Reflection;
+using System.IO;
+
+namespace ai.pkr.ctmcgen
+{
+    /// <summary>
+    /// Wrapper for the native library ai.pkr.ctmcgen.cpplib.
+    /// </summary>
+    public unsafe class CppLib
+    {
+        #region McGenerator
+
+        /// <summary>
+        /// Creates a MC chance tree generator for a heads-up game. playerCards[r], sharedCards[r]: 
+        /// number of cards of a player (private and public) and of shared cards dealt in round r.
+        /// The samples are split into streamsCount streams, the result is reproducible for 
+        /// the same seed and streamsCount.
+        /// Returns a handle or IntPtr.Zero on error (see McGenerator_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern IntPtr McGenerator_Create(int deckSize, int roundsCount, int* playerCards, int* sharedCards, 
+            int streamsCount, UInt64 seed);
+
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern void McGenerator_Destroy(IntPtr g);
+
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern IntPtr McGenerator_GetLastError();
+
+        /// <summary>
+        /// Number of hands (indexes) up to and including the round.
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern UInt64 McGenerator_GetHandsCount(IntPtr g, int round);
+
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern int McGenerator_GetHandSize(IntPtr g, int round);
+
+        /// <summary>
+        /// Stores hands with indexes first .. first+count-1 of the round to hands 
+        /// (McGenerator_GetHandSize() cards each) in the deal order of McDealer.
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern void McGenerator_GetHands(IntPtr g, int round, UInt64 first, UInt32 count, int* hands);
+
+        /// <summary>
+        /// Sets the abstract cards (buckets[hand index]) of a position and round. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern int McGenerator_SetAbstraction(IntPtr g, int position, int round, byte* buckets, UInt64 size);
+
+        /// <summary>
+        /// Showdown by a 7-card LUT (LutEvaluator7.dat). Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern int McGenerator_SetShowdownLut(IntPtr g, string lutPath);
+
+        /// <summary>
+        /// Showdown by hand ranks indexed by the hand index of the last round. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern int McGenerator_SetShowdownRanks(IntPtr g, UInt32* ranks, UInt64 size);
+
+        /// <summary>
+        /// Adds samplesCount samples, symmetric != 0 for equal abstractions. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern int McGenerator_Run(IntPtr g, UInt64 samplesCount, int symmetric);
+
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern UInt64 McGenerator_GetSamplesCount(IntPtr g);
+
+        /// <summary>
+        /// Merges the leaves of all streams, returns the number of leaves.
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern UInt64 McGenerator_MergeLeaves(IntPtr g);
+
+        /// <summary>
+        /// Copies the merged leaves sorted by cards: cards[2*roundsCount*i ...], counts[i], results[i].
+        /// </summary>
+        [DllImport("ai.pkr.ctmcgen.cpplib.dll")]
+        public static extern void McGenerator_GetLeaves(IntPtr g, byte* cards, UInt64* counts, UInt64* results);
+
+        /// <summary>
+        /// Throws an exception with the last error of McGenerator.
+        /// </summary>
+        public static void McGenerator_ThrowLastError()
+        {
+            throw new ApplicationException(Marshal.PtrToStringAnsi(McGenerator_GetLastError()));
+        }
+
+        #endregion
+
+        [DllImport("libdl.so.2")]
+        static extern IntPtr dlopen(string fileName, int flags);
+
+        public static void Init()
+        {
+            bool isUnix = Environment.OSVersion.Platform == PlatformID.Unix;
+            string platform = isUnix ? (System.IntPtr.Size == 8 ? "linux64" : "linux32")
+                : (System.IntPtr.Size == 8 ? "win64" : "win32");
+            string codeBase = CodeBase.Get(Assembly.GetExecutingAssembly());
+            string dllDir = Path.Combine(Path.GetDirectoryName(codeBase), platform);
+
+            string dllName = isUnix ? "libai.pkr.ctmcgen.cpplib.so" : "ai.pkr.ctmcgen.cpplib.dll";
+
+            string dllPath = Path.Combine(dllDir, dllName);
+
+            if (!System.IO.File.Exists(dllPath))
+            {
+                // In case we are in development folder (debug or release) try to load from bin.   
+                dllDir = Props.Global.Expand("${bds.BinDir}") + platform;
+                dllPath = Path.Combine(dllDir, dllName);
+                if (!System.IO.File.Exists(dllPath))
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+            }
+            if (isUnix)
+            {
+                // Load by full path, the DllImports are then resolved by the soname 
+                // (see the dllmap in ai.pkr.ctmcgen.dll.config).
+                const int RTLD_NOW = 2, RTLD_GLOBAL = 0x100;
+                if (dlopen(dllPath, RTLD_NOW | RTLD_GLOBAL) == IntPtr.Zero)
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+                return;
+            }
+            string envPath = Environment.GetEnvironmentVariable("PATH");
+            string envPathL = envPath.ToLower() + ";";
+            if (envPathL.IndexOf(dllDir.ToLower() + ";") < 0)
+            {
+                Environment.SetEnvironmentVariable("PATH", dllDir + ";" + envPath, EnvironmentVariableTarget.Process);
+            }
+        }
+    }
+}
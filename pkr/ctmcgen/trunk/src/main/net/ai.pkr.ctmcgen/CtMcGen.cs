@@ -415,6 +415,77 @@ namespace ai.pkr.ctmcgen
             return tree;
         }
 
+        /// <summary>
+        /// Generate an internal chance tree by MC sampling in the native library ai.pkr.ctmcgen.cpplib.
+        /// <para>Does the same as Generate(), but much faster. The abstract cards of all hands of each round 
+        /// are precomputed to bucket tables, therefore the abstractions must not depend on the order of cards dealt 
+        /// in the same round, and the number of hands in a round is limited by MAX_NATIVE_TABLE_SIZE 
+        /// (for hold'em: preflop and flop). The samples are done in streamsCount streams in parallel.</para>
+        /// <para>The result is reproducible for the same rngSeed and streamsCount, but differs from the result of Generate().</para>
+        /// </summary>
+        /// <param name="streamsCount">Number of streams, usually the number of cores.</param>
+        /// <param name="showdownLutPath">Path to LutEvaluator7.dat for hold'em. If null, the hand ranks 
+        /// are precomputed by the game rules (for small games).</param>
+        public static Tree GenerateNative(GameDefinition gd, IChanceAbstraction[] chanceAbstractions, bool areAbstractionsEqual,
+            long samplesCount, int rngSeed, int streamsCount, string showdownLutPath, FeedbackDelegate feedback)
+        {
+            if (chanceAbstractions.Length != 2)
+            {
+                throw new ArgumentOutOfRangeException("Only heads up games are supported now");
+            }
+            CppLib.Init();
+
+            int[] playerCards = new int[gd.RoundsCount];
+            int[] sharedCards = new int[gd.RoundsCount];
+            for (int r = 0; r < gd.RoundsCount; ++r)
+            {
+                playerCards[r] = gd.PrivateCardsCount[r] + gd.PublicCardsCount[r];
+                sharedCards[r] = gd.SharedCardsCount[r];
+            }
+            IntPtr g;
+            fixed (int* pPlayerCards = playerCards, pSharedCards = sharedCards)
+            {
+                g = CppLib.McGenerator_Create(gd.DeckDescr.Size, gd.RoundsCount, pPlayerCards, pSharedCards, 
+                    streamsCount, (UInt64)rngSeed);
+            }
+            if (g == IntPtr.Zero)
+            {
+                CppLib.McGenerator_ThrowLastError();
+            }
+            try
+            {
+                SetNativeAbstractions(g, gd, chanceAbstractions, areAbstractionsEqual);
+                SetNativeShowdown(g, gd, showdownLutPath);
+
+                for (Int64 samplesDone = 0; samplesDone < samplesCount; )
+                {
+                    if (feedback != null && !feedback(samplesDone))
+                    {
+                        break;
+                    }
+                    long runSamplesCount = Math.Min(samplesCount - samplesDone, NATIVE_FEEDBACK_PERIOD);
+                    if (CppLib.McGenerator_Run(g, (UInt64)runSamplesCount, areAbstractionsEqual ? 1 : 0) == 0)
+                    {
+                        CppLib.McGenerator_ThrowLastError();
+                    }
+                    samplesDone = (Int64)CppLib.McGenerator_GetSamplesCount(g);
+                }
+
+                Tree tree = new Tree
+                {
+                    PlayersCount = chanceAbstractions.Length,
+                    RoundsCount = gd.RoundsCount,
+                    SourceInfo = GetSourceInfo(gd, chanceAbstractions)
+                };
+                CopyNativeLeaves(g, tree);
+                return tree;
+            }
+            finally
+            {
+                CppLib.McGenerator_Destroy(g);
+            }
+        }
+
 
         #endregion
 
@@ -426,6 +497,143 @@ namespace ai.pkr.ctmcgen
         /// </summary>
         const int FEEDBACK_PERIOD = 50000;
 
+        /// <summary>
+        /// Samples between feedback calls in GenerateNative(), the native sample rate is 10-20 Ms/s per core.
+        /// </summary>
+        const int NATIVE_FEEDBACK_PERIOD = 20000000;
+
+        /// <summary>
+        /// Max. number of hands in a round for GenerateNative() (size of a bucket table in bytes).
+        /// </summary>
+        const long MAX_NATIVE_TABLE_SIZE = 1L << 28;
+
+        /// <summary>
+        /// Number of hands retrieved from the native library at once.
+        /// </summary>
+        const int NATIVE_HANDS_CHUNK = 4096;
+
+        /// <summary>
+        /// Calls action(index, hand) for each hand of the round in the order of the native hand index.
+        /// </summary>
+        static void ForEachNativeHand(IntPtr g, int round, Action<long, int[]> action)
+        {
+            long handsCount = (long)CppLib.McGenerator_GetHandsCount(g, round);
+            if (handsCount > MAX_NATIVE_TABLE_SIZE)
+            {
+                throw new ApplicationException(String.Format(
+                    "Too many hands in round {0}: {1:#,#}, max: {2:#,#}", round, handsCount, MAX_NATIVE_TABLE_SIZE));
+            }
+            int handSize = CppLib.McGenerator_GetHandSize(g, round);
+            int[] chunk = new int[NATIVE_HANDS_CHUNK * handSize];
+            int[] hand = new int[handSize];
+            for (long first = 0; first < handsCount; first += NATIVE_HANDS_CHUNK)
+            {
+                int count = (int)Math.Min(NATIVE_HANDS_CHUNK, handsCount - first);
+                fixed (int* pChunk = chunk)
+                {
+                    CppLib.McGenerator_GetHands(g, round, (UInt64)first, (UInt32)count, pChunk);
+                }
+                for (int i = 0; i < count; ++i)
+                {
+                    Array.Copy(chunk, i * handSize, hand, 0, handSize);
+                    action(first + i, hand);
+                }
+            }
+        }
+
+        static void SetNativeAbstractions(IntPtr g, GameDefinition gd, IChanceAbstraction[] chanceAbstractions, bool areAbstractionsEqual)
+        {
+            for (int r = 0; r < gd.RoundsCount; ++r)
+            {
+                byte[] buckets = null;
+                for (int p = 0; p < chanceAbstractions.Length; ++p)
+                {
+                    if (p == 0 || !areAbstractionsEqual)
+                    {
+                        buckets = new byte[CppLib.McGenerator_GetHandsCount(g, r)];
+                        IChanceAbstraction ca = chanceAbstractions[p];
+                        ForEachNativeHand(g, r, (i, hand) =>
+                        {
+                            int abstrCard = ca.GetAbstractCard(hand, hand.Length);
+                            if (abstrCard < byte.MinValue || abstrCard > byte.MaxValue)
+                            {
+                                throw new ApplicationException(string.Format("Abstract card {0} out of byte range", abstrCard));
+                            }
+                            buckets[i] = (byte)abstrCard;
+                        });
+                    }
+                    fixed (byte* pBuckets = buckets)
+                    {
+                        if (CppLib.McGenerator_SetAbstraction(g, p, r, pBuckets, (UInt64)buckets.LongLength) == 0)
+                        {
+                            CppLib.McGenerator_ThrowLastError();
+                        }
+                    }
+                }
+            }
+        }
+
+        static void SetNativeShowdown(IntPtr g, GameDefinition gd, string showdownLutPath)
+        {
+            if (showdownLutPath != null)
+            {
+                if (CppLib.McGenerator_SetShowdownLut(g, showdownLutPath) == 0)
+                {
+                    CppLib.McGenerator_ThrowLastError();
+                }
+                return;
+            }
+            // The ranks of the hands are independent, rank each final hand alone.
+            int lastRound = gd.RoundsCount - 1;
+            UInt32[] ranks = new UInt32[CppLib.McGenerator_GetHandsCount(g, lastRound)];
+            int[][] hands = new int[1][];
+            UInt32[] handRank = new UInt32[1];
+            ForEachNativeHand(g, lastRound, (i, hand) =>
+            {
+                hands[0] = hand;
+                gd.GameRules.Showdown(gd, hands, handRank);
+                ranks[i] = handRank[0];
+            });
+            fixed (UInt32* pRanks = ranks)
+            {
+                if (CppLib.McGenerator_SetShowdownRanks(g, pRanks, (UInt64)ranks.LongLength) == 0)
+                {
+                    CppLib.McGenerator_ThrowLastError();
+                }
+            }
+        }
+
+        static void CopyNativeLeaves(IntPtr g, Tree tree)
+        {
+            long leavesCount = (long)CppLib.McGenerator_MergeLeaves(g);
+            int cardsCount = tree.PlayersCount * tree.RoundsCount;
+            byte[] cards = new byte[leavesCount * cardsCount];
+            UInt64[] counts = new UInt64[leavesCount];
+            UInt64[] results = new UInt64[leavesCount];
+            fixed (byte* pCards = cards)
+            {
+                fixed (UInt64* pCounts = counts, pResults = results)
+                {
+                    CppLib.McGenerator_GetLeaves(g, pCards, pCounts, pResults);
+                }
+            }
+            byte[] leafCards = new byte[cardsCount];
+            for (long l = 0; l < leavesCount; ++l)
+            {
+                if (counts[l] > UInt32.MaxValue || results[l] > UInt32.MaxValue)
+                {
+                    throw new ApplicationException(String.Format("Leaf overflow: count: {0}, result: {1}", counts[l], results[l]));
+                }
+                Array.Copy(cards, l * cardsCount, leafCards, 0, cardsCount);
+                LeafT[] leaves = tree.GetLeavesByCards(leafCards);
+                int lastCard = leafCards[cardsCount - 1];
+                leaves[lastCard].IncrementCount((UInt32)counts[l]);
+                leaves[lastCard].IncrementResult((UInt32)results[l]);
+            }
+            tree.SamplesCount = CppLib.McGenerator_GetSamplesCount(g);
+            tree.UpdateDescription();
+        }
+
 
         internal struct LeafT
         {
@@ -155,6 +155,29 @@ namespace ai.pkr.ctmcgen.nunit
             GenerateAndVerifyCT("fgfr", _leducHeGd, chanceAbstractions, false, 10, 10000, 0.05, 0, 0.05, true);
         }
 
+        [Test]
+        public void Test_Native_Leduc__FullGame()
+        {
+            IChanceAbstraction[] chanceAbstractions = new IChanceAbstraction[]
+            {
+                new LeducHeChanceAbstraction(LeducHeChanceAbstraction.FullGame),    
+                new LeducHeChanceAbstraction(LeducHeChanceAbstraction.FullGame)
+            };
+            GenerateAndVerifyCT("nfg", _leducHeGd, chanceAbstractions, true, 100000, 10, 0.01, 0.0, 0.005, true, true);
+            GenerateAndVerifyCT("nfg", _leducHeGd, chanceAbstractions, true, 10, 1000, 0.05, 0.0, 0.02, true, true);
+        }
+
+        [Test]
+        public void Test_Native_Leduc__FullGame_FractionalResult()
+        {
+            IChanceAbstraction[] chanceAbstractions = new IChanceAbstraction[]
+            {
+                new LeducHeChanceAbstraction(LeducHeChanceAbstraction.FullGame),    
+                new LeducHeChanceAbstraction(LeducHeChanceAbstraction.FractionalResult)
+            };
+            GenerateAndVerifyCT("nfgfr", _leducHeGd, chanceAbstractions, false, 1000000, 1, 0.01, 0, 0.01, true, true);
+        }
+
 
         #endregion
 
@@ -177,6 +200,23 @@ namespace ai.pkr.ctmcgen.nunit
             Console.WriteLine("Repetitions: {0:0,0}, time: {1:0.0} s, {2:0,0} r/s", repCount, time, repCount / time);
         }
 
+        [Test]
+        [Category("Benchmark")]
+        public void Benchmark_GenerateNative()
+        {
+            IChanceAbstraction[] chanceAbstractions = new IChanceAbstraction[]
+            {
+                new LeducHeChanceAbstraction(LeducHeChanceAbstraction.FullGame),    
+                new LeducHeChanceAbstraction(LeducHeChanceAbstraction.FullGame)
+            };
+
+            int repCount = 100000000;
+            DateTime startTime = DateTime.Now;
+            CtMcGen.GenerateNative(_leducHeGd, chanceAbstractions, false, repCount, 1, Environment.ProcessorCount, null, null);
+            double time = (DateTime.Now - startTime).TotalSeconds;
+            Console.WriteLine("Repetitions: {0:0,0}, time: {1:0.0} s, {2:0,0} r/s", repCount, time, repCount / time);
+        }
+
         #endregion
 
         #region Implementation
@@ -191,6 +231,14 @@ namespace ai.pkr.ctmcgen.nunit
         /// and merge into the master tree. The master tree is than verified.
         /// </summary>
         private void GenerateAndVerifyCT(string name, GameDefinition gd, IChanceAbstraction[] chanceAbstractions, bool areAbstractionsEqual, int samplesCount, int runsCount, double avRelProbabEps, double avPotShareEps, double eqValEps, bool visualize)
+        {
+            GenerateAndVerifyCT(name, gd, chanceAbstractions, areAbstractionsEqual, samplesCount, runsCount, avRelProbabEps, avPotShareEps, eqValEps, visualize, false);
+        }
+
+        /// <summary>
+        /// Same as above, if native is true, uses GenerateNative() with 3 streams.
+        /// </summary>
+        private void GenerateAndVerifyCT(string name, GameDefinition gd, IChanceAbstraction[] chanceAbstractions, bool areAbstractionsEqual, int samplesCount, int runsCount, double avRelProbabEps, double avPotShareEps, double eqValEps, bool visualize, bool native)
         {
             CtMcGen.Tree masterTree = new CtMcGen.Tree();
 
@@ -198,7 +246,9 @@ namespace ai.pkr.ctmcgen.nunit
 
             for (int run = 0; run < runsCount; ++run)
             {
-                CtMcGen.Tree runTree = CtMcGen.Generate(gd, chanceAbstractions, areAbstractionsEqual, samplesCount, rngSeed, null);
+                CtMcGen.Tree runTree = native ?
+                    CtMcGen.GenerateNative(gd, chanceAbstractions, areAbstractionsEqual, samplesCount, rngSeed, 3, null, null) :
+                    CtMcGen.Generate(gd, chanceAbstractions, areAbstractionsEqual, samplesCount, rngSeed, null);
                 string fileName = Path.Combine(_outDir, String.Format("{0}-{1}-ct.dat", gd.Name, name));
                 runTree.Write(fileName);
                 masterTree.Read(fileName);
@@ -1,16 +1,63 @@
-// ai.pkr.fictpl.cpplib-runner.cpp : Defines the entry point for the console application.
+// ai.pkr.fictpl.cpplib-runner.cpp : Tests and benchmarks for ai.pkr.fictpl.cpplib.
 //
+// Usage:
+//   ai.pkr.fictpl.cpplib-runner test
+//       Runs the tests.
+//   ai.pkr.fictpl.cpplib-runner benchmark [entries] [threads]
+//       Benchmarks IncrementGameValueNoMasks(), the chance factor store, the sort of the chance tree index and the card key index.
+//   ai.pkr.fictpl.cpplib-runner benchmark-finalize [deals per round ...]
+//       Benchmarks the walk of BestResponseFinalize() on the nodes of a player tree and on the hot data.
 
 #include "stdafx.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
 #include "ai.pkr.fictpl.cpplib.h"
+#include "player_tree.h"
+
+using namespace std;
 
 #define REP_COUNT 1000000
 #define ARR_SIZE  5000
 
+#define VERIFY(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); throw "Test failed"; }
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// A simple deterministic RNG (the tests must be reproducible).
+class Rng
+{
+public:
+	Rng(uint64_t seed) : _state(seed * 2862933555777941757ULL + 3037000493ULL)
+	{}
+
+	uint64_t Next64()
+	{
+		_state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+		uint64_t z = _state;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	uint32_t Next(uint32_t n)
+	{
+		return (uint32_t)(Next64() % n);
+	}
+private:
+	uint64_t _state;
+};
+
 class AlignedPtr
 {
 	char * ptr;
-	
+
 public:
 
 	AlignedPtr(): ptr(NULL)
@@ -25,17 +72,13 @@ public:
 	void Alloc(int size)
 	{
 		ptr = new char[size+15];
-		unsigned long mask = 0xF;
-		alignedPtr = (char*)((unsigned long)(ptr + 15)  &  ~mask);
-	}
-	void Free()
-	{
-		delete [] ptr;
+		uintptr_t mask = 0xF;
+		alignedPtr = (char*)((uintptr_t)(ptr + 15)  &  ~mask);
 	}
 	char * alignedPtr;
 };
 
-void Test_IncrementGameValueNoMasks()
+static void Test_IncrementGameValueNoMasks()
 {
 	AlignedPtr s, d;
 	s.Alloc(ARR_SIZE*8);
@@ -52,23 +95,553 @@ void Test_IncrementGameValueNoMasks()
 
 	IncrementGameValueNoMasks(dst, ARR_SIZE, src);
 
-    for(int i = 0; i < 20; ++i)
+	for(int i = 0; i < ARR_SIZE; ++i)
 	{
-		printf(" %f", dst[i]);
+		VERIFY(dst[i] == 3*i);
 	}
-	printf("\n");
+}
 
-	for(int i = 0; i < ARR_SIZE; ++i)
+/** Creates rows of chance factors of 2 kinds, the columns are non-zero with the probability fill.
+The factors of the second kind are zero in some non-zero columns (like the showdown factors of ties).
+*/
+static void CreateChanceFactorRows(Rng & rng, uint32_t count, double fill, vector<vector<ChanceValueT> > & rows)
+{
+	rows.assign(2, vector<ChanceValueT>(count + 4, 0));
+	for(uint32_t c = 0; c < count; ++c)
+	{
+		if(rng.Next(1000) < fill * 1000)
+		{
+			rows[0][c] = (ChanceValueT)(rng.Next(1000) + 1) / 1024;
+			rows[1][c] = rng.Next(4) == 0 ? 0 : (ChanceValueT)((int)rng.Next(2001) - 1000) / 512;
+		}
+	}
+}
+
+static void Test_ChanceFactorStore()
+{
+	Rng rng(6);
+	const double fills[] = {0, 0.05, 0.3, 0.6, 1};
+	const uint32_t counts[] = {0, 1, 3, 4, 7, 100, 1001};
+	const double maxSparseFills[] = {0, 0.5, 1};
+	for(int m = 0; m < 3; ++m)
+	{
+		ChanceFactorStore * store = ChanceFactorStore_Create(2, maxSparseFills[m]);
+		vector<vector<vector<ChanceValueT> > > rows;
+		uint32_t expectedSparseCount = 0;
+		uint64_t expectedColumnsCount = 0, expectedNonZeroCount = 0;
+		for(int f = 0; f < 5; ++f)
+		{
+			for(int c = 0; c < 7; ++c)
+			{
+				rows.push_back(vector<vector<ChanceValueT> >());
+				CreateChanceFactorRows(rng, counts[c], fills[f], rows.back());
+				const ChanceValueT * values[2] = {&rows.back()[0][0], &rows.back()[1][0]};
+				VERIFY(ChanceFactorStore_AddRow(store, values, counts[c]) == rows.size() - 1);
+				uint32_t nonZeroCount = 0;
+				for(uint32_t i = 0; i < counts[c]; ++i)
+				{
+					nonZeroCount += values[0][i] != 0 || values[1][i] != 0 ? 1 : 0;
+				}
+				expectedSparseCount += nonZeroCount <= maxSparseFills[m] * counts[c] ? 1 : 0;
+				expectedColumnsCount += counts[c];
+				expectedNonZeroCount += nonZeroCount;
+			}
+		}
+		ChanceFactorStore_Compact(store);
+
+		ChanceFactorStoreInfo info;
+		ChanceFactorStore_GetInfo(store, &info);
+		VERIFY(info.RowsCount == rows.size());
+		VERIFY(info.SparseRowsCount == expectedSparseCount);
+		VERIFY(info.ColumnsCount == expectedColumnsCount);
+		VERIFY(info.NonZeroCount == expectedNonZeroCount);
+		VERIFY(info.ByteSize > 0);
+
+		AlignedPtr d;
+		d.Alloc(1004 * sizeof(double));
+		double * gameValues = (double*)d.alignedPtr;
+		vector<double> expected(1004);
+		for(uint32_t r = 0; r < rows.size(); ++r)
+		{
+			for(int kind = 0; kind < 2; ++kind)
+			{
+				for(int scaled = 0; scaled < 2; ++scaled)
+				{
+					double scale = 3.0 / 7;
+					for(uint32_t i = 0; i < 1004; ++i)
+					{
+						gameValues[i] = expected[i] = (double)rng.Next(100) / 3;
+					}
+					const vector<ChanceValueT> & values = rows[r][kind];
+					for(uint32_t i = 0; i < values.size(); ++i)
+					{
+						expected[i] += scaled ? (double)values[i] * scale : values[i];
+					}
+					if(scaled)
+					{
+						ChanceFactorStore_IncrementGameValueScaled(store, kind, r, gameValues, scale);
+					}
+					else
+					{
+						ChanceFactorStore_IncrementGameValue(store, kind, r, gameValues);
+					}
+					VERIFY(memcmp(gameValues, &expected[0], expected.size() * sizeof(double)) == 0);
+				}
+			}
+		}
+		ChanceFactorStore_Destroy(store);
+	}
+}
+
+static bool KeyLess(const ChanceIndexEntry & a, const ChanceIndexEntry & b)
+{
+	return a.Key < b.Key;
+}
+
+/** Creates entries like in the chance tree index: two ranks of keyBits / 2 bits
+(or random 64-bit keys if keyBits is 64), NodeIdx is the original position.
+*/
+static void CreateEntries(Rng & rng, size_t count, int keyBits, vector<ChanceIndexEntry> & entries)
+{
+	entries.resize(count);
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(keyBits == 64)
+		{
+			entries[i].Key = rng.Next64();
+		}
+		else
+		{
+			uint64_t mask = (1ULL << (keyBits / 2)) - 1;
+			entries[i].Key = ((rng.Next64() & mask) << 32) | (rng.Next64() & mask);
+		}
+		entries[i].NodeIdx = (uint32_t)i;
+	}
+}
+
+static void Test_ChanceIndexSort()
+{
+	Rng rng(1);
+	const size_t counts[] = {0, 1, 2, 100, 70000, 300000};
+	const int keyBits[] = {2, 10, 24, 64};
+	const int threads[] = {0, 1, 3, 8};
+	vector<ChanceIndexEntry> entries, expected;
+	for(int c = 0; c < 6; ++c)
+	{
+		for(int k = 0; k < 4; ++k)
+		{
+			CreateEntries(rng, counts[c], keyBits[k], expected);
+			stable_sort(expected.begin(), expected.end(), KeyLess);
+			for(int t = 0; t < 4; ++t)
+			{
+				entries = expected;
+				Rng shuffle(t + 10);
+				for(size_t i = entries.size(); i > 1; --i)
+				{
+					swap(entries[i - 1], entries[shuffle.Next((uint32_t)i)]);
+				}
+				// Position before the sort by NodeIdx.
+				vector<size_t> position(entries.size());
+				for(size_t i = 0; i < entries.size(); ++i)
+				{
+					position[entries[i].NodeIdx] = i;
+				}
+				ChanceIndex_Sort(entries.empty() ? 0 : &entries[0], (uint32_t)entries.size(), threads[t]);
+				for(size_t i = 0; i < entries.size(); ++i)
+				{
+					VERIFY(entries[i].Key == expected[i].Key);
+					if(i > 0 && entries[i].Key == entries[i - 1].Key)
+					{
+						// Stable: equal keys keep the order they had before the sort.
+						VERIFY(position[entries[i - 1].NodeIdx] < position[entries[i].NodeIdx]);
+					}
+				}
+			}
+		}
+	}
+}
+
+/// The radix sort is stable: sorting by the low half, then by the high half sorts by the key.
+static void Test_ChanceIndexSortStable()
+{
+	Rng rng(2);
+	vector<ChanceIndexEntry> entries, expected;
+	CreateEntries(rng, 200000, 20, expected);
+	sort(expected.begin(), expected.end(), KeyLess);
+	entries = expected;
+	for(size_t i = entries.size(); i > 1; --i)
+	{
+		swap(entries[i - 1], entries[rng.Next((uint32_t)i)]);
+	}
+	for(int pass = 0; pass < 2; ++pass)
+	{
+		// Sort by one half, the other half is moved to the high bits and back.
+		for(size_t i = 0; i < entries.size(); ++i)
+		{
+			entries[i].Key = (entries[i].Key << 32) | (entries[i].Key >> 32);
+		}
+		ChanceIndex_Sort(&entries[0], (uint32_t)entries.size(), 3);
+	}
+	for(size_t i = 0; i < entries.size(); ++i)
+	{
+		VERIFY(entries[i].Key == expected[i].Key);
+	}
+}
+
+static void Test_CardKeyIndex()
+{
+	Rng rng(3);
+	// Start small to test the growth.
+	CardKeyIndex * index = CardKeyIndex_Create(1);
+	vector<uint64_t> keys;
+	for(uint32_t i = 0; i < 100000; ++i)
+	{
+		// Packed like in FictitiousPlay: round, rank of the parent, card.
+		uint64_t key = ((uint64_t)(i % 4) << 56) | ((uint64_t)(i / 7) << 24) | (i % 7);
+		keys.push_back(key);
+		VERIFY(CardKeyIndex_Add(index, key, i) == 1);
+	}
+	VERIFY(CardKeyIndex_Add(index, keys[5], 7) == 0);
+	VERIFY(CardKeyIndex_Add(index, ~0ULL, 7) == 0);
+	for(uint32_t i = 0; i < keys.size(); ++i)
+	{
+		VERIFY(CardKeyIndex_Find(index, keys[i]) == i);
+	}
+	vector<uint64_t> sorted = keys;
+	sort(sorted.begin(), sorted.end());
+	for(int i = 0; i < 10000; ++i)
+	{
+		uint64_t key = rng.Next64();
+		if(!binary_search(sorted.begin(), sorted.end(), key))
+		{
+			VERIFY(CardKeyIndex_Find(index, key) == CARD_KEY_NOT_FOUND);
+		}
+	}
+	VERIFY(CardKeyIndex_Find(index, ~0ULL) == CARD_KEY_NOT_FOUND);
+	CardKeyIndex_Destroy(index);
+
+	CardKeyIndex * empty = CardKeyIndex_Create(0);
+	VERIFY(CardKeyIndex_Find(empty, 0) == CARD_KEY_NOT_FOUND);
+	CardKeyIndex_Destroy(empty);
+}
+
+/** A player tree of 2 players like the ones created by FictitiousPlay: the root, 2 blinds,
+then in each round a dealer node with the given number of deals, each followed by a betting round
+(check/call, bet/raise up to maxBets, fold). The action tree indexes of the leaves are numbered by the action
+sequences, the best BR nodes are random.
+*/
+class TestPlayerTree
+{
+public:
+	static const int PLAYERS_COUNT = 2;
+	static const uint8_t HERO_ACTING = 0x80;
+
+	TestPlayerTree(Rng & rng, const vector<int> & dealsCount, int maxBets, int heroPos)
+		: _rng(rng), _dealsCount(dealsCount), _maxBets(maxBets), _heroPos(heroPos), _chanceId(0)
+	{
+		uint32_t root = AddNode(0, 0);
+		uint32_t blind0 = AddNode(1, 0);
+		uint32_t blind1 = AddNode(2, 1);
+		(void)root;
+		(void)blind0;
+		// The root of the action tree is 0, the blinds are 1 and 2.
+		_atIds[make_pair(0u, 0)] = 1;
+		_atIds[make_pair(1u, 0)] = 2;
+		Deal(blind1, 3, 0, 2);
+	}
+
+	vector<uint8_t> depths;
+	vector<PlayerTreeNode> nodes;
+	/// Nodes at depth PLAYERS_COUNT + 1.
+	vector<uint32_t> topNodes;
+
+private:
+	uint32_t AddNode(int depth, int position)
+	{
+		PlayerTreeNode node;
+		node.StrVar = _rng.Next(1000);
+		node.AtIdx = 0xFFFFFFFF;
+		node.ChanceId = 0;
+		node.PositionInfo = (uint8_t)position;
+		depths.push_back((uint8_t)depth);
+		nodes.push_back(node);
+		return (uint32_t)nodes.size() - 1;
+	}
+
+	uint32_t GetAtIdx(uint32_t parentAtIdx, int action)
+	{
+		map<pair<uint32_t, int>, uint32_t>::iterator it = _atIds.find(make_pair(parentAtIdx, action));
+		if(it != _atIds.end())
+		{
+			return it->second;
+		}
+		uint32_t atIdx = (uint32_t)_atIds.size() + 1;
+		_atIds[make_pair(parentAtIdx, action)] = atIdx;
+		return atIdx;
+	}
+
+	void Deal(uint32_t parent, int depth, int round, uint32_t atIdx)
+	{
+		for(int c = 0; c < _dealsCount[round]; ++c)
+		{
+			uint32_t n = AddNode(depth, PLAYERS_COUNT);
+			nodes[n].ChanceId = _chanceId++;
+			if(depth == PLAYERS_COUNT + 1)
+			{
+				topNodes.push_back(n);
+			}
+			Bet(n, depth + 1, 0, 0, round, true, atIdx);
+		}
+		(void)parent;
+	}
+
+	/// Adds the actions of the actor as children of the parent.
+	void Bet(uint32_t parent, int depth, int actor, int bets, int round, bool isFirst, uint32_t atIdx)
+	{
+		vector<uint32_t> children;
+		for(int action = 0; action < 3; ++action)
+		{
+			if((action == 0 && bets == 0) || (action == 2 && bets == _maxBets))
+			{
+				// Nothing to fold, no more raises.
+				continue;
+			}
+			uint32_t n = AddNode(depth, actor);
+			uint32_t childAtIdx = GetAtIdx(atIdx, action);
+			children.push_back(n);
+			if(action == 0)
+			{
+				nodes[n].AtIdx = childAtIdx;
+			}
+			else if(action == 1 && (bets > 0 || !isFirst))
+			{
+				if(round + 1 == (int)_dealsCount.size())
+				{
+					nodes[n].AtIdx = childAtIdx;
+				}
+				else
+				{
+					Deal(n, depth + 1, round + 1, childAtIdx);
+				}
+			}
+			else
+			{
+				Bet(n, depth + 1, 1 - actor, action == 2 ? bets + 1 : bets, round, false, childAtIdx);
+			}
+		}
+		if(actor == _heroPos)
+		{
+			nodes[parent].PositionInfo |= HERO_ACTING;
+			nodes[parent].StrVar = children[_rng.Next((uint32_t)children.size())];
+			nodes[parent].AtIdx = (uint32_t)nodes.size();
+		}
+	}
+
+	Rng & _rng;
+	vector<int> _dealsCount;
+	int _maxBets;
+	int _heroPos;
+	uint32_t _chanceId;
+	map<pair<uint32_t, int>, uint32_t> _atIds;
+};
+
+/// The walk of BestResponseFinalize() on the nodes, as in C# (WalkTreeWithSkipChildren()).
+template<class Trace> class ReferenceFinalize
+{
+public:
+	ReferenceFinalize(const uint8_t * depths, PlayerTreeNode * nodes, uint32_t nodesCount, int heroPos, Trace & trace)
+		: _depths(depths), _nodes(nodes), _nodesCount(nodesCount), _heroPos(heroPos), _trace(trace), VisitedCount(0)
+	{
+	}
+
+	void Walk(uint32_t startNode, vector<uint32_t> & leaves)
+	{
+		_trace(_depths + startNode, 1);
+		int startDepth = _depths[startNode];
+		for(uint32_t n = startNode; n < _nodesCount; ++n)
+		{
+			_trace(_depths + n, 1);
+			int depth = _depths[n];
+			if(depth <= startDepth && n > startNode)
+			{
+				break;
+			}
+			VisitedCount++;
+			PlayerTreeNode * pNode = _nodes + n;
+			_trace(&pNode->PositionInfo, 1);
+			int pos = pNode->PositionInfo & 0x7F;
+			if(pos == _heroPos)
+			{
+				_trace(&pNode->StrVar, 4);
+				pNode->StrVar++;
+			}
+			if(pos == TestPlayerTree::PLAYERS_COUNT)
+			{
+				_trace(&pNode->ChanceId, 4);
+				_chanceIds[depth] = pNode->ChanceId;
+			}
+			else if(depth > TestPlayerTree::PLAYERS_COUNT)
+			{
+				_chanceIds[depth] = _chanceIds[depth - 1];
+			}
+			if(pNode->PositionInfo & TestPlayerTree::HERO_ACTING)
+			{
+				_trace(&pNode->StrVar, 4);
+				_trace(&pNode->AtIdx, 4);
+				Walk(pNode->StrVar, leaves);
+				n = pNode->AtIdx - 1;
+			}
+			else
+			{
+				_trace(&pNode->AtIdx, 4);
+				if(pNode->AtIdx != 0xFFFFFFFF)
+				{
+					leaves.push_back(_chanceIds[depth]);
+					leaves.push_back(pNode->AtIdx);
+				}
+			}
+		}
+	}
+
+private:
+	const uint8_t * _depths;
+	PlayerTreeNode * _nodes;
+	uint32_t _nodesCount;
+	int _heroPos;
+	Trace & _trace;
+	uint32_t _chanceIds[256];
+
+public:
+	uint64_t VisitedCount;
+};
+
+static void Test_HotPlayerTree()
+{
+	Rng rng(4);
+	vector<int> dealsCount;
+	dealsCount.push_back(3);
+	dealsCount.push_back(4);
+	dealsCount.push_back(2);
+	for(int heroPos = 0; heroPos < 2; ++heroPos)
+	{
+		TestPlayerTree tree(rng, dealsCount, 3, heroPos);
+		uint32_t nodesCount = (uint32_t)tree.nodes.size();
+		vector<PlayerTreeNode> expectedNodes = tree.nodes;
+		vector<uint32_t> expectedLeaves;
+		ai::pkr::fictpl::no_access_trace trace;
+		ReferenceFinalize<ai::pkr::fictpl::no_access_trace> reference(&tree.depths[0], &expectedNodes[0], nodesCount,
+			heroPos, trace);
+		for(size_t t = 0; t < tree.topNodes.size(); ++t)
+		{
+			reference.Walk(tree.topNodes[t], expectedLeaves);
+		}
+		VERIFY(expectedLeaves.size() > 0);
+
+		for(int compress = 0; compress < 2; ++compress)
+		{
+			vector<PlayerTreeNode> nodes = tree.nodes;
+			ai::pkr::fictpl::hot_player_tree hotTree(&tree.depths[0], &nodes[0], nodesCount, 2, compress != 0);
+			VERIFY(hotTree.is_compressed() == (compress != 0));
+			VERIFY(hotTree.byte_size() == (size_t)nodesCount * (compress ? 8 : 12));
+			vector<uint32_t> leaves;
+			for(size_t t = 0; t < tree.topNodes.size(); ++t)
+			{
+				size_t begin = leaves.size();
+				uint32_t count = hotTree.finalize(&nodes[0], tree.topNodes[t], heroPos, leaves);
+				VERIFY(leaves.size() - begin == 2 * (size_t)count);
+			}
+			VERIFY(leaves == expectedLeaves);
+			VERIFY(memcmp(&nodes[0], &expectedNodes[0], nodesCount * sizeof(PlayerTreeNode)) == 0);
+		}
+	}
+}
+
+static void Test_PerfCounters()
+{
+	const int OUTER = 0, INNER = 1;
+	int isAvailable = PerfCounters_Enable(1);
+	PerfCounters_Reset();
+	volatile double sum = 0;
+	for(int r = 0; r < 3; ++r)
 	{
-		if(dst[i] != 3*i)
+		PerfCounters_Begin(OUTER);
+		for(int i = 0; i < 100000; ++i)
+		{
+			sum = sum + i;
+		}
+		PerfCounters_Begin(INNER);
+		for(int i = 0; i < 1000; ++i)
 		{
-			throw "Wrong sum";
+			sum = sum + i;
 		}
+		PerfCounters_End(INNER);
+		PerfCounters_End(OUTER);
+	}
+	PerfPhaseCounters outer, inner, unused;
+	PerfCounters_Get(OUTER, &outer);
+	PerfCounters_Get(INNER, &inner);
+	PerfCounters_Get(PERF_MAX_PHASES - 1, &unused);
+	VERIFY(outer.Count == 3 && inner.Count == 3 && unused.Count == 0);
+	VERIFY(outer.TimeNs > 0 && outer.TimeNs >= inner.TimeNs);
+	if(isAvailable)
+	{
+		VERIFY(outer.Instructions > inner.Instructions && inner.Instructions > 0);
+		VERIFY(outer.Cycles > 0);
+	}
+	else
+	{
+		VERIFY(outer.Instructions == 0 && outer.Cycles == 0 && outer.LlcMisses == 0);
+	}
+	// Invalid phases are ignored.
+	PerfCounters_Begin(-1);
+	PerfCounters_End(PERF_MAX_PHASES);
+
+	PerfCounters_Enable(0);
+	PerfCounters_Begin(OUTER);
+	PerfCounters_End(OUTER);
+	PerfCounters_Get(OUTER, &outer);
+	VERIFY(outer.Count == 3);
+	PerfCounters_Reset();
+	PerfCounters_Get(OUTER, &outer);
+	VERIFY(outer.Count == 0 && outer.TimeNs == 0);
+}
+
+static int Test()
+{
+	try
+	{
+		Test_IncrementGameValueNoMasks();
+		Test_ChanceFactorStore();
+		Test_ChanceIndexSort();
+		Test_ChanceIndexSortStable();
+		Test_CardKeyIndex();
+		Test_HotPlayerTree();
+		Test_PerfCounters();
+	}
+	catch(const char * e)
+	{
+		printf("%s\n", e);
+		return 1;
 	}
 	printf("OK\n");
+	return 0;
+}
+
+/// Prints the hardware counters of the phase per item, if they are available.
+static void PrintPerfCounters(int phase, double itemsCount)
+{
+	PerfPhaseCounters c;
+	PerfCounters_Get(phase, &c);
+	if(c.Cycles == 0)
+	{
+		return;
+	}
+	printf("  cycles/item: %.2f, instructions/item: %.2f, IPC: %.2f, LLC misses/item: %.4f, LLC miss traffic: %.2f GB/s\n",
+		c.Cycles / itemsCount, c.Instructions / itemsCount, (double)c.Instructions / c.Cycles, c.LlcMisses / itemsCount,
+		c.LlcMisses * 64.0 / c.TimeNs);
 }
 
-void Benchmark_IncrementGameValueNoMasks()
+static void Benchmark_IncrementGameValueNoMasks()
 {
 	AlignedPtr s, d;
 	s.Alloc(ARR_SIZE*8);
@@ -83,23 +656,234 @@ void Benchmark_IncrementGameValueNoMasks()
 		src[i] = (ChanceValueT)i;
 	}
 
-	unsigned start = GetTickCount();
+	PerfCounters_Reset();
+	double start = Now();
+	PerfCounters_Begin(0);
 
 	for(int i = 0; i < REP_COUNT; ++i)
 	{
 		IncrementGameValueNoMasks(dst, ARR_SIZE, src);
 	}
 
-	unsigned stop  = GetTickCount();
-	unsigned diff = stop - start;
-	printf("Ticks: %d\n", diff);
+	PerfCounters_End(0);
+	double time = Now() - start;
+	printf("IncrementGameValueNoMasks: %.3f s, %.1f M values/s\n", time, (double)REP_COUNT * ARR_SIZE / time / 1e6);
+	PrintPerfCounters(0, (double)REP_COUNT * ARR_SIZE);
 }
 
+/// Benchmarks ChanceFactorStore_IncrementGameValue() for rows of ARR_SIZE columns with dense and sparse rows.
+static void Benchmark_ChanceFactorStore()
+{
+	Rng rng(7);
+	const double fills[] = {0.05, 0.1, 0.25, 0.5, 0.75, 1};
+	const int ROWS_COUNT = 64;
+	AlignedPtr d;
+	d.Alloc((ARR_SIZE + 4) * sizeof(double));
+	double * gameValues = (double*)d.alignedPtr;
+	memset(gameValues, 0, (ARR_SIZE + 4) * sizeof(double));
+	for(int f = 0; f < 6; ++f)
+	{
+		double times[2];
+		for(int sparse = 0; sparse < 2; ++sparse)
+		{
+			ChanceFactorStore * store = ChanceFactorStore_Create(2, sparse);
+			Rng rowRng(8);
+			vector<vector<ChanceValueT> > row;
+			for(int r = 0; r < ROWS_COUNT; ++r)
+			{
+				CreateChanceFactorRows(rowRng, ARR_SIZE, fills[f], row);
+				const ChanceValueT * values[2] = {&row[0][0], &row[1][0]};
+				ChanceFactorStore_AddRow(store, values, ARR_SIZE);
+			}
+			double start = Now();
+			for(int i = 0; i < REP_COUNT / ROWS_COUNT; ++i)
+			{
+				for(uint32_t r = 0; r < (uint32_t)ROWS_COUNT; ++r)
+				{
+					ChanceFactorStore_IncrementGameValue(store, 0, r, gameValues);
+				}
+			}
+			times[sparse] = Now() - start;
+			ChanceFactorStore_Destroy(store);
+		}
+		double values = (double)(REP_COUNT / ROWS_COUNT) * ROWS_COUNT * ARR_SIZE;
+		printf("ChanceFactorStore, fill %.2f: dense: %.1f M columns/s, sparse: %.1f M columns/s\n", fills[f],
+			values / times[0] / 1e6, values / times[1] / 1e6);
+	}
+}
 
-int _tmain(int argc, _TCHAR* argv[])
+static void Benchmark_ChanceIndex(size_t count, int threadsCount)
 {
-	//IncrementGameValueNoMasks(0, 0, 0);
-	Test_IncrementGameValueNoMasks();
-	Benchmark_IncrementGameValueNoMasks();
-	return 0;
+	Rng rng(1);
+	vector<ChanceIndexEntry> original, entries;
+	// Ranks of 2 x 16 bits, as for an abstraction with some 10^4 card paths per round and player.
+	CreateEntries(rng, count, 32, original);
+	const int threads[] = {1, threadsCount};
+	for(int t = 0; t < (threadsCount > 1 ? 2 : 1); ++t)
+	{
+		entries = original;
+		double start = Now();
+		ChanceIndex_Sort(&entries[0], (uint32_t)entries.size(), threads[t]);
+		double time = Now() - start;
+		printf("ChanceIndex_Sort, %d thread(s): %llu entries, %.3f s, %.1f M entries/s\n", threads[t],
+			(unsigned long long)count, time, count / time / 1e6);
+	}
+	entries = original;
+	double start = Now();
+	stable_sort(entries.begin(), entries.end(), KeyLess);
+	double time = Now() - start;
+	printf("std::stable_sort: %.3f s\n", time);
+
+	CardKeyIndex * index = CardKeyIndex_Create((uint32_t)count);
+	start = Now();
+	for(size_t i = 0; i < count; ++i)
+	{
+		CardKeyIndex_Add(index, original[i].Key, (uint32_t)i);
+	}
+	time = Now() - start;
+	printf("CardKeyIndex_Add: %.3f s, %.1f M keys/s\n", time, count / time / 1e6);
+	start = Now();
+	uint64_t sum = 0;
+	for(size_t i = 0; i < count; ++i)
+	{
+		sum += CardKeyIndex_Find(index, original[i].Key);
+	}
+	time = Now() - start;
+	printf("CardKeyIndex_Find: %.3f s, %.1f M keys/s (%llu)\n", time, count / time / 1e6, (unsigned long long)sum);
+	CardKeyIndex_Destroy(index);
+}
+
+/// Counts the accessed bytes and the distinct accessed cache lines.
+class CacheLineTrace
+{
+public:
+	CacheLineTrace() : Bytes(0)
+	{
+	}
+
+	void operator()(const void * p, size_t size)
+	{
+		uintptr_t address = (uintptr_t)p;
+		for(uintptr_t line = address / CACHE_LINE; line <= (address + size - 1) / CACHE_LINE; ++line)
+		{
+			_lines.push_back(line);
+		}
+		Bytes += size;
+	}
+
+	uint64_t GetLinesCount()
+	{
+		sort(_lines.begin(), _lines.end());
+		return (uint64_t)(unique(_lines.begin(), _lines.end()) - _lines.begin());
+	}
+
+	static const int CACHE_LINE = 64;
+	uint64_t Bytes;
+
+private:
+	vector<uintptr_t> _lines;
+};
+
+static void PrintFinalizeWalk(const char * name, double time, int repCount, uint64_t visitedCount, CacheLineTrace & trace)
+{
+	printf("%-28s %8.3f s, %6.1f M nodes/s, loaded: %5.2f bytes/node, touched: %5.2f bytes/node\n", name, time,
+		(double)visitedCount * repCount / time / 1e6, (double)trace.Bytes / visitedCount, 
+		(double)trace.GetLinesCount() * CacheLineTrace::CACHE_LINE / visitedCount);
+}
+
+/** Benchmarks the walk of BestResponseFinalize() on the nodes of the player tree (as in C#) and on the hot data
+(hot_player_tree). Prints the speed and the memory traffic per visited node: the loaded bytes
+and the touched bytes (distinct cache lines of 64 bytes).
+*/
+static void Benchmark_FinalizeWalk(const vector<int> & dealsCount)
+{
+	Rng rng(5);
+	TestPlayerTree tree(rng, dealsCount, 3, 0);
+	uint32_t nodesCount = (uint32_t)tree.nodes.size();
+	printf("Finalize walk: player tree nodes: %u, node: %d bytes + 1 byte depth\n", nodesCount, (int)sizeof(PlayerTreeNode));
+	const int REP = 10;
+	vector<uint32_t> leaves;
+
+	ai::pkr::fictpl::no_access_trace noTrace;
+	CacheLineTrace aosTrace;
+	ReferenceFinalize<ai::pkr::fictpl::no_access_trace> aos(&tree.depths[0], &tree.nodes[0], nodesCount, 0, noTrace);
+	ReferenceFinalize<CacheLineTrace> aosTraced(&tree.depths[0], &tree.nodes[0], nodesCount, 0, aosTrace);
+	for(size_t t = 0; t < tree.topNodes.size(); ++t)
+	{
+		leaves.clear();
+		aosTraced.Walk(tree.topNodes[t], leaves);
+	}
+	double start = Now();
+	for(int r = 0; r < REP; ++r)
+	{
+		for(size_t t = 0; t < tree.topNodes.size(); ++t)
+		{
+			leaves.clear();
+			aos.Walk(tree.topNodes[t], leaves);
+		}
+	}
+	PrintFinalizeWalk("nodes (AoS):", Now() - start, REP, aosTraced.VisitedCount, aosTrace);
+
+	for(int compress = 0; compress < 2; ++compress)
+	{
+		ai::pkr::fictpl::hot_player_tree hotTree(&tree.depths[0], &tree.nodes[0], nodesCount, 2, compress != 0);
+		CacheLineTrace trace;
+		for(size_t t = 0; t < tree.topNodes.size(); ++t)
+		{
+			leaves.clear();
+			hotTree.finalize(&tree.nodes[0], tree.topNodes[t], 0, leaves, trace);
+		}
+		start = Now();
+		for(int r = 0; r < REP; ++r)
+		{
+			for(size_t t = 0; t < tree.topNodes.size(); ++t)
+			{
+				leaves.clear();
+				hotTree.finalize(&tree.nodes[0], tree.topNodes[t], 0, leaves);
+			}
+		}
+		PrintFinalizeWalk(compress ? "hot records (4 bytes):" : "hot records (8 bytes):", 
+			Now() - start, REP, aosTraced.VisitedCount, trace);
+		if(compress)
+		{
+			printf("Long links: %u\n", (unsigned)hotTree.long_links_count());
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "test") == 0)
+	{
+		return Test();
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark") == 0)
+	{
+		PerfCounters_Enable(1);
+		Benchmark_IncrementGameValueNoMasks();
+		Benchmark_ChanceFactorStore();
+		Benchmark_ChanceIndex(argc >= 3 ? (size_t)atol(argv[2]) : 10000000, argc >= 4 ? atoi(argv[3]) : 4);
+		return 0;
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark-finalize") == 0)
+	{
+		vector<int> dealsCount;
+		for(int i = 2; i < argc; ++i)
+		{
+			dealsCount.push_back(atoi(argv[i]));
+		}
+		if(dealsCount.empty())
+		{
+			dealsCount.push_back(30);
+			dealsCount.push_back(10);
+			dealsCount.push_back(10);
+		}
+		Benchmark_FinalizeWalk(dealsCount);
+		return 0;
+	}
+	printf("Usage:\n"
+		"%s test\n"
+		"%s benchmark [entries] [threads]\n"
+		"%s benchmark-finalize [deals per round ...]\n", argv[0], argv[0], argv[0]);
+	return 1;
 }
@@ -0,0 +1,305 @@
+#ifndef AI_PKR_FICTPL_CPPLIB_PLAYER_TREE_H
+#define AI_PKR_FICTPL_CPPLIB_PLAYER_TREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "ai.pkr.fictpl.cpplib.h"
+
+#pragma pack(push, 1)
+
+/// A node of the player tree (FictitiousPlay.Node in C#), the unions of C# are represented by one field.
+typedef struct PlayerTreeNode
+{
+	/// StrVar for the nodes of the hero, BestBrNode for the nodes where the hero acts.
+	uint32_t StrVar;
+	/// AtIdx for the leaves, NextNodeToSkipChildren for the nodes where the hero acts.
+	uint32_t AtIdx;
+	uint32_t ChanceId;
+	uint8_t PositionInfo;
+} PlayerTreeNode;
+
+#pragma pack(pop)
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace fictpl
+		{
+
+			/// An array aligned at 16 bytes.
+			template<class T> class aligned_array
+			{
+			public:
+				aligned_array() : _data(0), _size(0)
+				{
+				}
+
+				void resize(std::size_t size)
+				{
+					_storage.assign(size * sizeof(T) + 15, 0);
+					_data = (T*)(((uintptr_t)&_storage[0] + 15) & ~(uintptr_t)0xF);
+					_size = size;
+				}
+
+				T & operator[](std::size_t i)
+				{
+					return _data[i];
+				}
+
+				const T & operator[](std::size_t i) const
+				{
+					return _data[i];
+				}
+
+				const T * data() const
+				{
+					return _data;
+				}
+
+				std::size_t size() const
+				{
+					return _size;
+				}
+
+				std::size_t byte_size() const
+				{
+					return _size * sizeof(T);
+				}
+
+			private:
+				std::vector<char> _storage;
+				T * _data;
+				std::size_t _size;
+			};
+
+			/// Does not trace the memory accesses of the walk.
+			struct no_access_trace
+			{
+				void operator()(const void *, std::size_t)
+				{
+				}
+			};
+
+			/** Hot data of a player tree for the walk of FictitiousPlay.BestResponseFinalize(). The walk visits
+			only the nodes of the best response, the nodes (PlayerTreeNode, 13 bytes) and their depths
+			(1 byte in a separate array) are replaced by a compact array of hot records with the fields it reads
+			at each node: depth, PositionInfo and a link:
+			<p>For the nodes where the hero acts the link is NextNodeToSkipChildren as a distance to the node,
+			for the leaves AtIdx (never 0, this is the root of the action tree), for other nodes 0.</p>
+			<p>If compression is allowed, a record is 4 bytes with a 2-byte link, larger links are marked by
+			LONG_LINK and stored in a sorted table (they are rare: the skips of the nodes near the root).
+			Otherwise a record is 8 bytes with a 4-byte link.</p>
+			<p>ChanceId of the dealer nodes is in a separate array, it is read at dealer nodes only.</p>
+			<p>The arrays are aligned at 16 bytes. The data do not change during iterations:
+			BestBrNode is set by the values-up walk and StrVar is incremented in the nodes.</p>
+			<p>Benchmark_FinalizeWalk() shows that the walk over the nodes is faster (the walk is sparse,
+			a hot record does not save cache lines), therefore this layout is not a part of the cpp lib.</p>
+			*/
+			class hot_player_tree
+			{
+			public:
+				static const int MAX_DEPTH = 256;
+
+				hot_player_tree(const uint8_t * depths, const PlayerTreeNode * nodes, uint32_t nodes_count,
+					int players_count, bool compress_links) : _players_count(players_count)
+				{
+					if(compress_links)
+					{
+						_records16.resize(nodes_count);
+					}
+					else
+					{
+						_records32.resize(nodes_count);
+					}
+					_chance_id.resize(nodes_count);
+					for(uint32_t n = 0; n < nodes_count; ++n)
+					{
+						const PlayerTreeNode & node = nodes[n];
+						uint32_t link = 0;
+						if(node.PositionInfo & HERO_ACTING)
+						{
+							link = node.AtIdx - n;
+						}
+						else if(node.AtIdx != INVALID_AT_IDX)
+						{
+							link = node.AtIdx;
+						}
+						if(compress_links)
+						{
+							set_record(_records16[n], depths[n], node.PositionInfo, link);
+						}
+						else
+						{
+							set_record(_records32[n], depths[n], node.PositionInfo, link);
+						}
+						if((node.PositionInfo & POSITION_MASK) == players_count)
+						{
+							_chance_id[n] = node.ChanceId;
+						}
+					}
+				}
+
+				uint32_t nodes_count() const
+				{
+					return (uint32_t)_chance_id.size();
+				}
+
+				bool is_compressed() const
+				{
+					return _records16.size() > 0;
+				}
+
+				/// Number of links not fitting into 2 bytes.
+				std::size_t long_links_count() const
+				{
+					return _long_links.size();
+				}
+
+				std::size_t byte_size() const
+				{
+					return _records16.byte_size() + _records32.byte_size() + _chance_id.byte_size()
+						+ _long_links.size() * sizeof(_long_links[0]);
+				}
+
+				/** Walks the subtree of start_node like BestResponseFinalize(): increments StrVar of the nodes
+				of the hero, follows BestBrNode in the nodes where the hero acts,
+				appends (chance id, action tree index) of the final BR leaves to leaves.
+				start_node must be a node at depth players_count + 1 (a top tree node).
+				Returns the number of the leaves.
+				*/
+				template<class Trace> uint32_t finalize(PlayerTreeNode * nodes, uint32_t start_node, int hero_pos,
+					std::vector<uint32_t> & leaves, Trace & trace) const
+				{
+					std::size_t begin = leaves.size();
+					uint32_t chance_ids[MAX_DEPTH];
+					if(is_compressed())
+					{
+						walk(_records16, nodes, start_node, hero_pos, chance_ids, leaves, trace);
+					}
+					else
+					{
+						walk(_records32, nodes, start_node, hero_pos, chance_ids, leaves, trace);
+					}
+					return (uint32_t)((leaves.size() - begin) / 2);
+				}
+
+				uint32_t finalize(PlayerTreeNode * nodes, uint32_t start_node, int hero_pos,
+					std::vector<uint32_t> & leaves) const
+				{
+					no_access_trace trace;
+					return finalize(nodes, start_node, hero_pos, leaves, trace);
+				}
+
+			private:
+				static const uint8_t POSITION_MASK = 0x7F;
+				static const uint8_t HERO_ACTING = 0x80;
+				static const uint32_t INVALID_AT_IDX = 0xFFFFFFFF;
+				static const uint16_t LONG_LINK = 0xFFFF;
+
+				struct record16
+				{
+					uint8_t depth;
+					uint8_t position_info;
+					uint16_t link;
+				};
+
+				struct record32
+				{
+					uint8_t depth;
+					uint8_t position_info;
+					uint32_t link;
+				};
+
+				void set_record(record16 & r, uint8_t depth, uint8_t position_info, uint32_t link)
+				{
+					r.depth = depth;
+					r.position_info = position_info;
+					r.link = link < LONG_LINK ? (uint16_t)link : LONG_LINK;
+					if(link >= LONG_LINK)
+					{
+						// The nodes come in order, the table stays sorted.
+						_long_links.push_back(std::make_pair((uint32_t)(&r - &_records16[0]), link));
+					}
+				}
+
+				void set_record(record32 & r, uint8_t depth, uint8_t position_info, uint32_t link)
+				{
+					r.depth = depth;
+					r.position_info = position_info;
+					r.link = link;
+				}
+
+				uint32_t get_link(const record16 & r, uint32_t n) const
+				{
+					if(r.link != LONG_LINK)
+					{
+						return r.link;
+					}
+					return std::lower_bound(_long_links.begin(), _long_links.end(), std::make_pair(n, 0u))->second;
+				}
+
+				uint32_t get_link(const record32 & r, uint32_t) const
+				{
+					return r.link;
+				}
+
+				template<class RecordT, class Trace> void walk(const aligned_array<RecordT> & records, PlayerTreeNode * nodes,
+					uint32_t start_node, int hero_pos, uint32_t * chance_ids, std::vector<uint32_t> & leaves, Trace & trace) const
+				{
+					int start_depth = records[start_node].depth;
+					uint32_t nodes_count = (uint32_t)records.size();
+					for(uint32_t n = start_node; n < nodes_count; ++n)
+					{
+						const RecordT & r = records[n];
+						trace(&r, sizeof(RecordT));
+						int depth = r.depth;
+						if(depth <= start_depth && n > start_node)
+						{
+							break;
+						}
+						int pos = r.position_info & POSITION_MASK;
+						if(pos == hero_pos)
+						{
+							trace(&nodes[n].StrVar, sizeof(uint32_t));
+							nodes[n].StrVar++;
+						}
+						if(pos == _players_count)
+						{
+							trace(&_chance_id[n], sizeof(uint32_t));
+							chance_ids[depth] = _chance_id[n];
+						}
+						else if(depth > _players_count)
+						{
+							chance_ids[depth] = chance_ids[depth - 1];
+						}
+						if(r.position_info & HERO_ACTING)
+						{
+							// StrVar contains BestBrNode here.
+							trace(&nodes[n].StrVar, sizeof(uint32_t));
+							walk(records, nodes, nodes[n].StrVar, hero_pos, chance_ids, leaves, trace);
+							n += get_link(r, n) - 1;
+						}
+						else if(r.link != 0)
+						{
+							leaves.push_back(chance_ids[depth]);
+							leaves.push_back(get_link(r, n));
+						}
+					}
+				}
+
+				int _players_count;
+				aligned_array<record16> _records16;
+				aligned_array<record32> _records32;
+				aligned_array<uint32_t> _chance_id;
+				/// Pairs (node, link) for the links of _records16 marked by LONG_LINK, sorted by node.
+				std::vector<std::pair<uint32_t, uint32_t> > _long_links;
+			};
+
+		}
+	}
+}
+
+#endif
@@ -5,9 +5,12 @@
 
 #pragma once
 
+#include <stdio.h>
+
+#ifdef _WIN32
 #include "targetver.h"
 
-#include <stdio.h>
 #include <tchar.h>
 #include <windows.h>
+#endif
 
@@ -3,8 +3,12 @@
 
 #include "stdafx.h"
 #include "ai.pkr.fictpl.cpplib.h"
+#include "chance_factors.h"
+#include "chance_index.h"
+#include "perf_counters.h"
 //#include <stdio.h>
 #include <assert.h>
+#include <string.h>
 #include <emmintrin.h>
 #include <xmmintrin.h>
 
@@ -14,6 +18,26 @@
 
 #pragma pack (pop)
 
+using namespace ai::pkr::fictpl;
+
+struct CardKeyIndex
+{
+	CardKeyIndex(uint32_t expectedCount) : index(expectedCount)
+	{
+	}
+
+	card_key_index index;
+};
+
+struct ChanceFactorStore
+{
+	ChanceFactorStore(int kindsCount, double maxSparseFill) : store(kindsCount, maxSparseFill)
+	{
+	}
+
+	chance_factor_store store;
+};
+
 class FastBitArray
 {
 
@@ -111,5 +135,105 @@ AIPKRFICTPLCPPLIB_API void IncrementGameValueNoMasks(double * pGameValues, uint3
 
 }
 
+AIPKRFICTPLCPPLIB_API void ChanceIndex_Sort(ChanceIndexEntry * entries, uint32_t count, int threadsCount)
+{
+	radix_sort(entries, count, threadsCount);
+}
+
+AIPKRFICTPLCPPLIB_API CardKeyIndex * CardKeyIndex_Create(uint32_t expectedCount)
+{
+	return new CardKeyIndex(expectedCount);
+}
+
+AIPKRFICTPLCPPLIB_API void CardKeyIndex_Destroy(CardKeyIndex * index)
+{
+	delete index;
+}
+
+AIPKRFICTPLCPPLIB_API int CardKeyIndex_Add(CardKeyIndex * index, uint64_t key, uint32_t value)
+{
+	return index->index.add(key, value) ? 1 : 0;
+}
+
+AIPKRFICTPLCPPLIB_API uint32_t CardKeyIndex_Find(const CardKeyIndex * index, uint64_t key)
+{
+	return index->index.find(key);
+}
+
+AIPKRFICTPLCPPLIB_API ChanceFactorStore * ChanceFactorStore_Create(int kindsCount, double maxSparseFill)
+{
+	return new ChanceFactorStore(kindsCount, maxSparseFill);
+}
+
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_Destroy(ChanceFactorStore * store)
+{
+	delete store;
+}
+
+AIPKRFICTPLCPPLIB_API uint32_t ChanceFactorStore_AddRow(ChanceFactorStore * store, const ChanceValueT * const * values, 
+	uint32_t count)
+{
+	return store->store.add_row(values, count);
+}
+
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_Compact(ChanceFactorStore * store)
+{
+	store->store.compact();
+}
+
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_IncrementGameValue(const ChanceFactorStore * store, int kind, uint32_t row, 
+	double * pGameValues)
+{
+	store->store.increment(kind, row, pGameValues);
+}
+
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_IncrementGameValueScaled(const ChanceFactorStore * store, int kind, 
+	uint32_t row, double * pGameValues, double scale)
+{
+	store->store.increment(kind, row, pGameValues, scale);
+}
+
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_GetInfo(const ChanceFactorStore * store, ChanceFactorStoreInfo * info)
+{
+	store->store.get_info(info);
+}
+
+AIPKRFICTPLCPPLIB_API int PerfCounters_Enable(int enable)
+{
+	return perf_counters::enable(enable != 0) ? 1 : 0;
+}
+
+AIPKRFICTPLCPPLIB_API void PerfCounters_Reset()
+{
+	perf_counters::reset();
+}
+
+AIPKRFICTPLCPPLIB_API void PerfCounters_Begin(int phase)
+{
+	if(phase >= 0 && phase < PERF_MAX_PHASES)
+	{
+		perf_counters::begin(phase);
+	}
+}
+
+AIPKRFICTPLCPPLIB_API void PerfCounters_End(int phase)
+{
+	if(phase >= 0 && phase < PERF_MAX_PHASES)
+	{
+		perf_counters::end(phase);
+	}
+}
+
+AIPKRFICTPLCPPLIB_API void PerfCounters_Get(int phase, PerfPhaseCounters * counters)
+{
+	if(phase >= 0 && phase < PERF_MAX_PHASES)
+	{
+		perf_counters::get(phase, counters);
+	}
+	else
+	{
+		memset(counters, 0, sizeof(*counters));
+	}
+}
 
-}
\ No newline at end of file
+}
@@ -4,10 +4,19 @@
 // that uses this DLL. This way any other project whose source files include this file see 
 // AIPKRFICTPLAYCPPLIB_API functions as being imported from a DLL, whereas this DLL sees symbols
 // defined with this macro as being exported.
-#ifdef AIPKRFICTPLCPPLIB_EXPORTS
-#define AIPKRFICTPLCPPLIB_API __declspec(dllexport)
+#ifndef AI_PKR_FICTPL_CPPLIB_H
+#define AI_PKR_FICTPL_CPPLIB_H
+
+#if defined(_WIN32)
+	#ifdef AIPKRFICTPLCPPLIB_EXPORTS
+		#define AIPKRFICTPLCPPLIB_API __declspec(dllexport)
+	#else
+		#define AIPKRFICTPLCPPLIB_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AIPKRFICTPLCPPLIB_API __attribute__((visibility("default")))
 #else
-#define AIPKRFICTPLCPPLIB_API __declspec(dllimport)
+	#define AIPKRFICTPLCPPLIB_API
 #endif
 
 #include <stdint.h>
@@ -22,6 +31,112 @@ AIPKRFICTPLCPPLIB_API void IncrementGameValue(double * pGameValues, uint32_t gam
 
 AIPKRFICTPLCPPLIB_API void IncrementGameValueNoMasks(double * pGameValues, uint32_t gameValuesCount, ChanceValueT * pChanceFactors);
 
+/// An entry of the chance tree index (ChanceTreeIndexEntry in C#): packed card keys of the players and the chance tree node.
+typedef struct ChanceIndexEntry
+{
+	uint64_t Key;
+	uint32_t NodeIdx;
+} ChanceIndexEntry;
+
+/// Sorts the entries by key (stable), threadsCount < 1 is 1 thread.
+AIPKRFICTPLCPPLIB_API void ChanceIndex_Sort(ChanceIndexEntry * entries, uint32_t count, int threadsCount);
+
+/// Opaque handle of a store of chance factors with dense and sparse rows.
+typedef struct ChanceFactorStore ChanceFactorStore;
+
+/// Statistics and memory usage of a chance factor store.
+typedef struct ChanceFactorStoreInfo
+{
+	uint32_t RowsCount;
+	uint32_t SparseRowsCount;
+	/// Sum of the numbers of the columns of the rows.
+	uint64_t ColumnsCount;
+	/// Number of the columns with a non-zero factor of any kind.
+	uint64_t NonZeroCount;
+	uint64_t ByteSize;
+	/// Size of the factors if all rows were dense.
+	uint64_t DenseByteSize;
+} ChanceFactorStoreInfo;
+
+/** Creates a store of kindsCount kinds of chance factors. The rows with a fill ratio (non-zero columns / columns)
+up to maxSparseFill are stored sparse, other rows dense.
+*/
+AIPKRFICTPLCPPLIB_API ChanceFactorStore * ChanceFactorStore_Create(int kindsCount, double maxSparseFill);
+
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_Destroy(ChanceFactorStore * store);
+
+/// Adds a row of count factors for each kind, returns the index of the row.
+AIPKRFICTPLCPPLIB_API uint32_t ChanceFactorStore_AddRow(ChanceFactorStore * store, const ChanceValueT * const * values, 
+	uint32_t count);
+
+/// Frees the memory reserved for more row infos, call after the last row is added.
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_Compact(ChanceFactorStore * store);
+
+/** Adds the factors of the row to the game values (16-byte aligned, padded to 4 values).
+Like IncrementGameValueNoMasks(), for sparse rows only the non-zero columns are updated.
+*/
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_IncrementGameValue(const ChanceFactorStore * store, int kind, uint32_t row, 
+	double * pGameValues);
+
+/// Adds the factors of the row multiplied by scale to the game values.
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_IncrementGameValueScaled(const ChanceFactorStore * store, int kind, 
+	uint32_t row, double * pGameValues, double scale);
+
+AIPKRFICTPLCPPLIB_API void ChanceFactorStore_GetInfo(const ChanceFactorStore * store, ChanceFactorStoreInfo * info);
+
+/// Max. number of the phases of the performance counters.
+#define PERF_MAX_PHASES 8
+
+/// Performance counters of a phase, summed over all threads and all executions of the phase.
+typedef struct PerfPhaseCounters
+{
+	/// Number of the executions.
+	uint64_t Count;
+	/// Time of the executions.
+	uint64_t TimeNs;
+	/// Hardware counters (user space), 0 if they are not available.
+	uint64_t Cycles;
+	uint64_t Instructions;
+	/// Last level cache misses, each of them transfers a cache line from the memory.
+	uint64_t LlcMisses;
+} PerfPhaseCounters;
+
+/** Enables (enable != 0) or disables the performance counters of the phases. Returns 1 if the hardware counters
+are available (Linux perf_event_open()), otherwise only the times and the counts are collected.
+The counters are global for the process. When they are disabled, PerfCounters_Begin() and PerfCounters_End()
+do nothing.
+*/
+AIPKRFICTPLCPPLIB_API int PerfCounters_Enable(int enable);
+
+/// Clears the counters of all phases.
+AIPKRFICTPLCPPLIB_API void PerfCounters_Reset();
+
+/** Begins a phase (0 <= phase < PERF_MAX_PHASES) in the calling thread. The phase ends by PerfCounters_End()
+in the same thread. Phases can nest, the counters of a phase include the nested ones.
+*/
+AIPKRFICTPLCPPLIB_API void PerfCounters_Begin(int phase);
+
+AIPKRFICTPLCPPLIB_API void PerfCounters_End(int phase);
+
+AIPKRFICTPLCPPLIB_API void PerfCounters_Get(int phase, PerfPhaseCounters * counters);
+
+/// Opaque handle of an index of packed card keys (hash table key -> value).
+typedef struct CardKeyIndex CardKeyIndex;
+
+#define CARD_KEY_NOT_FOUND 0xFFFFFFFF
+
+AIPKRFICTPLCPPLIB_API CardKeyIndex * CardKeyIndex_Create(uint32_t expectedCount);
+
+AIPKRFICTPLCPPLIB_API void CardKeyIndex_Destroy(CardKeyIndex * index);
+
+/// Adds a key (not ~0), returns 0 if it is already in the index.
+AIPKRFICTPLCPPLIB_API int CardKeyIndex_Add(CardKeyIndex * index, uint64_t key, uint32_t value);
+
+/// Returns the value of the key or CARD_KEY_NOT_FOUND.
+AIPKRFICTPLCPPLIB_API uint32_t CardKeyIndex_Find(const CardKeyIndex * index, uint64_t key);
+
 #ifdef __cplusplus
 } 
 #endif
+
+#endif
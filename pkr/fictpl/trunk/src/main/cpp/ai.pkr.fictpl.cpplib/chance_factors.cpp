@@ -0,0 +1,220 @@
+#include "stdafx.h"
+#include <assert.h>
+#include <algorithm>
+#include <emmintrin.h>
+#include "chance_factors.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace fictpl
+		{
+
+			namespace
+			{
+				/// Adds 4 dense factors (converted to double and multiplied by scale) to 4 aligned game values.
+				inline void add_dense_4(double * game_values, const ChanceValueT * factors, __m128d scale)
+				{
+					__m128 f = _mm_loadu_ps(factors);
+					__m128d lo = _mm_mul_pd(_mm_cvtps_pd(f), scale);
+					__m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(f, f)), scale);
+					_mm_store_pd(game_values, _mm_add_pd(_mm_load_pd(game_values), lo));
+					_mm_store_pd(game_values + 2, _mm_add_pd(_mm_load_pd(game_values + 2), hi));
+				}
+
+				inline void add_dense_4(double * game_values, const ChanceValueT * factors)
+				{
+					__m128 f = _mm_loadu_ps(factors);
+					_mm_store_pd(game_values, _mm_add_pd(_mm_load_pd(game_values), _mm_cvtps_pd(f)));
+					_mm_store_pd(game_values + 2, _mm_add_pd(_mm_load_pd(game_values + 2), _mm_cvtps_pd(_mm_movehl_ps(f, f))));
+				}
+
+				/// Gathers the game values of 2 columns, adds 2 factors and scatters the sums back.
+				inline void add_sparse_2(double * game_values, const uint32_t * columns, __m128d f)
+				{
+					double * g0 = game_values + columns[0];
+					double * g1 = game_values + columns[1];
+					__m128d g = _mm_loadh_pd(_mm_load_sd(g0), g1);
+					g = _mm_add_pd(g, f);
+					_mm_storel_pd(g0, g);
+					_mm_storeh_pd(g1, g);
+				}
+
+				inline __m128d load_2(const ChanceValueT * factors)
+				{
+					return _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd((const double *)factors)));
+				}
+			}
+
+			// Definitions for the uses by reference (std::min()).
+			const std::size_t chance_factor_store::MIN_CHUNK_SIZE;
+			const std::size_t chance_factor_store::MAX_CHUNK_SIZE;
+
+			chance_factor_store::chance_factor_store(int kinds_count, double max_sparse_fill)
+				: _kinds_count(kinds_count), _max_sparse_fill(max_sparse_fill), _chunk_used(0),
+				_columns_count(0), _nonzero_count(0)
+			{
+			}
+
+			char * chance_factor_store::allocate(std::size_t size)
+			{
+				size = (size + 15) & ~(std::size_t)15;
+				if(_chunks.empty() || _chunk_used + size > _chunks.back().size)
+				{
+					std::size_t chunk_size = _chunks.empty() ? MIN_CHUNK_SIZE : std::min(2 * _chunks.back().size, MAX_CHUNK_SIZE);
+					chunk c;
+					c.size = std::max(chunk_size, size);
+					// The default alignment of new is at least 16 bytes on the supported platforms.
+					c.data.reset(new char[c.size]);
+					_chunks.push_back(std::move(c));
+					_chunk_used = 0;
+				}
+				char * p = _chunks.back().data.get() + _chunk_used;
+				_chunk_used += size;
+				return p;
+			}
+
+			uint32_t chance_factor_store::add_row(const ChanceValueT * const * values, uint32_t count)
+			{
+				row_info r;
+				r.count = count;
+				r.nonzero_count = 0;
+				for(uint32_t c = 0; c < count; ++c)
+				{
+					for(int k = 0; k < _kinds_count; ++k)
+					{
+						if(values[k][c] != 0)
+						{
+							r.nonzero_count++;
+							break;
+						}
+					}
+				}
+				_columns_count += count;
+				_nonzero_count += r.nonzero_count;
+				if(r.nonzero_count <= _max_sparse_fill * count)
+				{
+					ChanceValueT * v = (ChanceValueT *)allocate(
+						r.nonzero_count * (_kinds_count * sizeof(ChanceValueT) + sizeof(uint32_t)));
+					uint32_t * columns = (uint32_t *)(v + _kinds_count * r.nonzero_count);
+					uint32_t i = 0;
+					for(uint32_t c = 0; c < count; ++c)
+					{
+						bool is_zero = true;
+						for(int k = 0; k < _kinds_count && is_zero; ++k)
+						{
+							is_zero = values[k][c] == 0;
+						}
+						if(!is_zero)
+						{
+							columns[i] = c;
+							for(int k = 0; k < _kinds_count; ++k)
+							{
+								v[k * r.nonzero_count + i] = values[k][c];
+							}
+							i++;
+						}
+					}
+					r.values = v;
+				}
+				else
+				{
+					r.nonzero_count = DENSE;
+					uint32_t padded_count = (count + 3) & ~3U;
+					ChanceValueT * v = (ChanceValueT *)allocate(_kinds_count * padded_count * sizeof(ChanceValueT));
+					for(int k = 0; k < _kinds_count; ++k)
+					{
+						ChanceValueT * dst = v + k * padded_count;
+						std::copy(values[k], values[k] + count, dst);
+						std::fill(dst + count, dst + padded_count, (ChanceValueT)0);
+					}
+					r.values = v;
+				}
+				_rows.push_back(r);
+				return (uint32_t)(_rows.size() - 1);
+			}
+
+			void chance_factor_store::compact()
+			{
+				_rows.shrink_to_fit();
+			}
+
+			void chance_factor_store::increment(int kind, uint32_t row, double * game_values) const
+			{
+				const row_info & r = _rows[row];
+				assert((((uintptr_t)game_values) & 0xF) == 0);
+				if(r.nonzero_count == DENSE)
+				{
+					const ChanceValueT * f = r.values + kind * ((r.count + 3) & ~3U);
+					for(uint32_t c = 0; c < r.count; c += 4)
+					{
+						add_dense_4(game_values + c, f + c);
+					}
+					return;
+				}
+				const ChanceValueT * f = r.values + kind * r.nonzero_count;
+				const uint32_t * columns = (const uint32_t *)(r.values + _kinds_count * r.nonzero_count);
+				uint32_t i = 0;
+				for(; i + 2 <= r.nonzero_count; i += 2)
+				{
+					add_sparse_2(game_values, columns + i, load_2(f + i));
+				}
+				if(i < r.nonzero_count)
+				{
+					game_values[columns[i]] += f[i];
+				}
+			}
+
+			void chance_factor_store::increment(int kind, uint32_t row, double * game_values, double scale) const
+			{
+				const row_info & r = _rows[row];
+				const __m128d s = _mm_set1_pd(scale);
+				assert((((uintptr_t)game_values) & 0xF) == 0);
+				if(r.nonzero_count == DENSE)
+				{
+					const ChanceValueT * f = r.values + kind * ((r.count + 3) & ~3U);
+					for(uint32_t c = 0; c < r.count; c += 4)
+					{
+						add_dense_4(game_values + c, f + c, s);
+					}
+					return;
+				}
+				const ChanceValueT * f = r.values + kind * r.nonzero_count;
+				const uint32_t * columns = (const uint32_t *)(r.values + _kinds_count * r.nonzero_count);
+				uint32_t i = 0;
+				for(; i + 2 <= r.nonzero_count; i += 2)
+				{
+					add_sparse_2(game_values, columns + i, _mm_mul_pd(load_2(f + i), s));
+				}
+				if(i < r.nonzero_count)
+				{
+					game_values[columns[i]] += (double)f[i] * scale;
+				}
+			}
+
+			void chance_factor_store::get_info(ChanceFactorStoreInfo * info) const
+			{
+				info->RowsCount = (uint32_t)_rows.size();
+				info->SparseRowsCount = 0;
+				info->DenseByteSize = 0;
+				for(std::size_t i = 0; i < _rows.size(); ++i)
+				{
+					if(_rows[i].nonzero_count != DENSE)
+					{
+						info->SparseRowsCount++;
+					}
+					info->DenseByteSize += ((_rows[i].count + 3) & ~3U) * sizeof(ChanceValueT) * _kinds_count;
+				}
+				info->ColumnsCount = _columns_count;
+				info->NonZeroCount = _nonzero_count;
+				info->ByteSize = _rows.capacity() * sizeof(row_info);
+				for(std::size_t i = 0; i < _chunks.size(); ++i)
+				{
+					info->ByteSize += _chunks[i].size;
+				}
+			}
+
+		}
+	}
+}
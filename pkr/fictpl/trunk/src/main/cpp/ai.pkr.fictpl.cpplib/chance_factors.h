@@ -0,0 +1,88 @@
+#ifndef AI_PKR_FICTPL_CPPLIB_CHANCE_FACTORS_H
+#define AI_PKR_FICTPL_CPPLIB_CHANCE_FACTORS_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "ai.pkr.fictpl.cpplib.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace fictpl
+		{
+
+			/** Chance factors of a player: for each chance info of the hero (a row) and each kind
+			(non-showdown, showdown) a factor for each opponent card combination of the shard (a column).
+			<p>The card combinations impossible for the hero cards have zero factors in all kinds.
+			A row with a fill ratio (non-zero columns / columns) up to max_sparse_fill is stored sparse
+			(compressed sparse row: column indexes shared by the kinds, values of each kind),
+			other rows are stored dense as before. Zeros are not added to the game values, so the results
+			are the same for both storages.</p>
+			<p>Dense rows are padded to 4 values, the game values must be 16-byte aligned and padded
+			to 4 values (as for IncrementGameValueNoMasks()).</p>
+			<p>The rows are written one after another into chunks of memory growing up to MAX_CHUNK_SIZE
+			and are never moved. The memory used while the store is built is the final size plus the free tail
+			of the last chunk, there are no reallocations.</p>
+			*/
+			class chance_factor_store
+			{
+			public:
+				chance_factor_store(int kinds_count, double max_sparse_fill);
+
+				/// Adds a row, values[k] are count factors of kind k. Returns the index of the row.
+				uint32_t add_row(const ChanceValueT * const * values, uint32_t count);
+
+				/// Frees the memory reserved for more row infos, call after the last row is added.
+				void compact();
+
+				/// game_values[c] += factor of kind, row, column c.
+				void increment(int kind, uint32_t row, double * game_values) const;
+
+				/// game_values[c] += scale * factor of kind, row, column c.
+				void increment(int kind, uint32_t row, double * game_values, double scale) const;
+
+				void get_info(ChanceFactorStoreInfo * info) const;
+
+			private:
+				/// nonzero_count of a dense row.
+				static const uint32_t DENSE = 0xFFFFFFFF;
+
+				static const std::size_t MIN_CHUNK_SIZE = 64 << 10;
+				static const std::size_t MAX_CHUNK_SIZE = 4 << 20;
+
+				/** Values of each kind (count padded to 4 for a dense row, nonzero_count for a sparse row),
+				for a sparse row followed by nonzero_count column indexes.
+				*/
+				struct row_info
+				{
+					const ChanceValueT * values;
+					uint32_t count;
+					uint32_t nonzero_count;
+				};
+
+				struct chunk
+				{
+					std::unique_ptr<char[]> data;
+					std::size_t size;
+				};
+
+				/// Returns 16-byte aligned memory for a row.
+				char * allocate(std::size_t size);
+
+				int _kinds_count;
+				double _max_sparse_fill;
+				std::vector<row_info> _rows;
+				std::vector<chunk> _chunks;
+				/// Bytes used in the last chunk.
+				std::size_t _chunk_used;
+				uint64_t _columns_count;
+				uint64_t _nonzero_count;
+			};
+
+		}
+	}
+}
+
+#endif
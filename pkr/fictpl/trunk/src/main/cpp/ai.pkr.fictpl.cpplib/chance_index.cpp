@@ -0,0 +1,178 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <cstring>
+#include "chance_index.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace fictpl
+		{
+
+			namespace
+			{
+				/// Smaller arrays are not worth to be split between threads.
+				const std::size_t MIN_ENTRIES_PER_THREAD = 65536;
+			}
+
+			void radix_sort(ChanceIndexEntry * entries, std::size_t count, int thread_count)
+			{
+				if(count < 2)
+				{
+					return;
+				}
+				uint64_t orKeys = 0, andKeys = ~(uint64_t)0;
+				for(std::size_t i = 0; i < count; ++i)
+				{
+					orKeys |= entries[i].Key;
+					andKeys &= entries[i].Key;
+				}
+				// A digit has to be sorted only if it differs in some keys.
+				const uint64_t varying = orKeys ^ andKeys;
+
+				thread_count = (int)(std::max)((std::size_t)1,
+					(std::min)((std::size_t)(std::max)(thread_count, 1), count / MIN_ENTRIES_PER_THREAD + 1));
+				std::vector<ChanceIndexEntry> buffer;
+				std::vector<std::size_t> offsets(thread_count * 256);
+				ChanceIndexEntry * src = entries;
+				ChanceIndexEntry * dst = 0;
+
+				for(int shift = 0; shift < 64; shift += 8)
+				{
+					if(((varying >> shift) & 0xFF) == 0)
+					{
+						continue;
+					}
+					if(buffer.empty())
+					{
+						buffer.resize(count);
+						dst = &buffer[0];
+					}
+#ifdef _OPENMP
+					#pragma omp parallel num_threads(thread_count)
+#endif
+					{
+#ifdef _OPENMP
+						const int t = omp_get_thread_num();
+						const int n = omp_get_num_threads();
+#else
+						const int t = 0;
+						const int n = 1;
+#endif
+						const std::size_t begin = count * t / n;
+						const std::size_t end = count * (t + 1) / n;
+						std::size_t * positions = &offsets[t * 256];
+						std::fill(positions, positions + 256, (std::size_t)0);
+						for(std::size_t i = begin; i < end; ++i)
+						{
+							positions[(src[i].Key >> shift) & 0xFF]++;
+						}
+#ifdef _OPENMP
+						#pragma omp barrier
+						#pragma omp single
+#endif
+						{
+							// Digit d of thread t follows digit d of threads 0..t-1, the sort is stable.
+							std::size_t sum = 0;
+							for(int d = 0; d < 256; ++d)
+							{
+								for(int t2 = 0; t2 < n; ++t2)
+								{
+									std::size_t c = offsets[t2 * 256 + d];
+									offsets[t2 * 256 + d] = sum;
+									sum += c;
+								}
+							}
+						}
+						for(std::size_t i = begin; i < end; ++i)
+						{
+							dst[positions[(src[i].Key >> shift) & 0xFF]++] = src[i];
+						}
+					}
+					std::swap(src, dst);
+				}
+				if(src != entries)
+				{
+					memcpy(entries, src, count * sizeof(ChanceIndexEntry));
+				}
+			}
+
+			// Definitions for the uses by reference (e.g. std::vector::assign()).
+			const uint32_t card_key_index::NOT_FOUND;
+			const uint64_t card_key_index::EMPTY;
+
+			card_key_index::card_key_index(std::size_t expected_count) : _count(0)
+			{
+				std::size_t capacity = 16;
+				while(capacity < expected_count * 2)
+				{
+					capacity *= 2;
+				}
+				rehash(capacity);
+			}
+
+			bool card_key_index::add(uint64_t key, uint32_t value)
+			{
+				if(key == EMPTY)
+				{
+					return false;
+				}
+				// Keep the load factor at most 1/2.
+				if((_count + 1) * 2 > _keys.size())
+				{
+					rehash(_keys.size() * 2);
+				}
+				std::size_t i = slot(key);
+				for(;;)
+				{
+					if(_keys[i] == key)
+					{
+						return false;
+					}
+					if(_keys[i] == EMPTY)
+					{
+						_keys[i] = key;
+						_values[i] = value;
+						++_count;
+						return true;
+					}
+					i = (i + 1) & _mask;
+				}
+			}
+
+			void card_key_index::rehash(std::size_t capacity)
+			{
+				std::vector<uint64_t> keys(capacity, EMPTY);
+				std::vector<uint32_t> values(capacity, 0);
+				keys.swap(_keys);
+				values.swap(_values);
+				_mask = capacity - 1;
+				_shift = 64;
+				for(std::size_t c = capacity; c > 1; c >>= 1)
+				{
+					--_shift;
+				}
+				for(std::size_t j = 0; j < keys.size(); ++j)
+				{
+					if(keys[j] == EMPTY)
+					{
+						continue;
+					}
+					std::size_t i = slot(keys[j]);
+					while(_keys[i] != EMPTY)
+					{
+						i = (i + 1) & _mask;
+					}
+					_keys[i] = keys[j];
+					_values[i] = values[j];
+				}
+			}
+
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef AI_PKR_FICTPL_CPPLIB_CHANCE_INDEX_H
+#define AI_PKR_FICTPL_CPPLIB_CHANCE_INDEX_H
+
+#include <cstddef>
+#include <vector>
+#include "ai.pkr.fictpl.cpplib.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace fictpl
+		{
+
+			/** Sorts the entries of the chance tree index by key (stable LSD radix sort, 8-bit digits).
+			Digits that are equal in all keys are skipped, so keys using few bits take few passes.
+			Each pass is done by thread_count threads, each of them histograms and scatters a contiguous range.
+			*/
+			void radix_sort(ChanceIndexEntry * entries, std::size_t count, int thread_count);
+
+			/** Open-addressing hash table (linear probing) mapping packed card keys to indexes.
+			The key ~0 is reserved.
+			*/
+			class card_key_index
+			{
+			public:
+				static const uint32_t NOT_FOUND = 0xFFFFFFFF;
+
+				/// Reserves space for expected_count keys, grows when it is exceeded.
+				explicit card_key_index(std::size_t expected_count);
+
+				/// Adds a key, returns false if it is already there (the value is not changed).
+				bool add(uint64_t key, uint32_t value);
+
+				/// Returns the value of the key or NOT_FOUND.
+				uint32_t find(uint64_t key) const
+				{
+					std::size_t i = slot(key);
+					for(;;)
+					{
+						uint64_t k = _keys[i];
+						if(k == EMPTY)
+						{
+							return NOT_FOUND;
+						}
+						if(k == key)
+						{
+							return _values[i];
+						}
+						i = (i + 1) & _mask;
+					}
+				}
+
+				std::size_t size() const
+				{
+					return _count;
+				}
+
+			private:
+				static const uint64_t EMPTY = ~(uint64_t)0;
+
+				std::size_t slot(uint64_t key) const
+				{
+					// Fibonacci hashing, the keys are sequential in their lower bits.
+					return (std::size_t)((key * 0x9E3779B97F4A7C15ULL) >> _shift) & _mask;
+				}
+
+				void rehash(std::size_t capacity);
+
+				std::vector<uint64_t> _keys;
+				std::vector<uint32_t> _values;
+				std::size_t _mask;
+				int _shift;
+				std::size_t _count;
+			};
+
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,189 @@
+#include "stdafx.h"
+#include <chrono>
+#include <cstring>
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace fictpl
+		{
+
+			namespace
+			{
+				const int HW_COUNTERS_COUNT = 3;
+
+				/// Counters of a thread, opened at the first use.
+				class thread_counters
+				{
+				public:
+					thread_counters() : _is_open_tried(false)
+					{
+						for(int i = 0; i < HW_COUNTERS_COUNT; ++i)
+						{
+							_fds[i] = -1;
+						}
+					}
+
+					~thread_counters()
+					{
+						close();
+					}
+
+					bool is_available()
+					{
+						if(!_is_open_tried)
+						{
+							_is_open_tried = true;
+							open();
+						}
+						return _fds[0] != -1;
+					}
+
+					/// Reads cycles, instructions and LLC misses, returns false if they are not available.
+					bool read(uint64_t * values)
+					{
+#ifdef __linux__
+						if(!is_available())
+						{
+							return false;
+						}
+						// PERF_FORMAT_GROUP: the number of the counters, then their values.
+						uint64_t data[1 + HW_COUNTERS_COUNT];
+						if(::read(_fds[0], data, sizeof(data)) != (ssize_t)sizeof(data) || data[0] != HW_COUNTERS_COUNT)
+						{
+							return false;
+						}
+						memcpy(values, data + 1, sizeof(uint64_t) * HW_COUNTERS_COUNT);
+						return true;
+#else
+						(void)values;
+						return false;
+#endif
+					}
+
+					/// Time and counters at begin() of each phase.
+					uint64_t start[PERF_MAX_PHASES][1 + HW_COUNTERS_COUNT];
+
+				private:
+					void open()
+					{
+#ifdef __linux__
+						const uint64_t configs[HW_COUNTERS_COUNT] =
+						{
+							PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+						};
+						for(int i = 0; i < HW_COUNTERS_COUNT; ++i)
+						{
+							perf_event_attr attr;
+							memset(&attr, 0, sizeof(attr));
+							attr.size = sizeof(attr);
+							attr.type = PERF_TYPE_HARDWARE;
+							attr.config = configs[i];
+							attr.read_format = PERF_FORMAT_GROUP;
+							// User space only, allowed with the default perf_event_paranoid.
+							attr.exclude_kernel = 1;
+							attr.exclude_hv = 1;
+							// This thread on any CPU.
+							_fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : _fds[0], 0);
+							if(_fds[i] == -1)
+							{
+								close();
+								return;
+							}
+						}
+#endif
+					}
+
+					void close()
+					{
+#ifdef __linux__
+						for(int i = HW_COUNTERS_COUNT - 1; i >= 0; --i)
+						{
+							if(_fds[i] != -1)
+							{
+								::close(_fds[i]);
+								_fds[i] = -1;
+							}
+						}
+#endif
+					}
+
+					bool _is_open_tried;
+					int _fds[HW_COUNTERS_COUNT];
+				};
+
+				thread_local thread_counters t_counters;
+
+				uint64_t now_ns()
+				{
+					return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now().time_since_epoch()).count();
+				}
+			}
+
+			std::atomic<bool> perf_counters::_is_enabled(false);
+			std::atomic<uint64_t> perf_counters::_totals[PERF_MAX_PHASES][VALUES_COUNT];
+
+			bool perf_counters::enable(bool is_enabled)
+			{
+				_is_enabled.store(is_enabled);
+				return t_counters.is_available();
+			}
+
+			void perf_counters::reset()
+			{
+				for(int p = 0; p < PERF_MAX_PHASES; ++p)
+				{
+					for(int v = 0; v < VALUES_COUNT; ++v)
+					{
+						_totals[p][v].store(0);
+					}
+				}
+			}
+
+			void perf_counters::do_begin(int phase)
+			{
+				uint64_t * start = t_counters.start[phase];
+				if(!t_counters.read(start + 1))
+				{
+					memset(start + 1, 0, sizeof(uint64_t) * HW_COUNTERS_COUNT);
+				}
+				// The time last, it is cheap and should not include reading the counters.
+				start[0] = now_ns();
+			}
+
+			void perf_counters::do_end(int phase)
+			{
+				uint64_t time = now_ns();
+				const uint64_t * start = t_counters.start[phase];
+				uint64_t values[HW_COUNTERS_COUNT];
+				_totals[phase][COUNT].fetch_add(1, std::memory_order_relaxed);
+				_totals[phase][TIME_NS].fetch_add(time - start[0], std::memory_order_relaxed);
+				if(t_counters.read(values))
+				{
+					_totals[phase][CYCLES].fetch_add(values[0] - start[1], std::memory_order_relaxed);
+					_totals[phase][INSTRUCTIONS].fetch_add(values[1] - start[2], std::memory_order_relaxed);
+					_totals[phase][LLC_MISSES].fetch_add(values[2] - start[3], std::memory_order_relaxed);
+				}
+			}
+
+			void perf_counters::get(int phase, PerfPhaseCounters * counters)
+			{
+				counters->Count = _totals[phase][COUNT].load();
+				counters->TimeNs = _totals[phase][TIME_NS].load();
+				counters->Cycles = _totals[phase][CYCLES].load();
+				counters->Instructions = _totals[phase][INSTRUCTIONS].load();
+				counters->LlcMisses = _totals[phase][LLC_MISSES].load();
+			}
+
+		}
+	}
+}
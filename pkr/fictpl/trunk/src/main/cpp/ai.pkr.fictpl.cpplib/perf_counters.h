@@ -0,0 +1,76 @@
+#ifndef AI_PKR_FICTPL_CPPLIB_PERF_COUNTERS_H
+#define AI_PKR_FICTPL_CPPLIB_PERF_COUNTERS_H
+
+#include <atomic>
+#include "ai.pkr.fictpl.cpplib.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace fictpl
+		{
+
+			/** Hardware performance counters (cycles, instructions, last level cache misses) of phases
+			of the computation, summed over all threads of the process.
+			<p>A thread brackets the code of a phase with begin() and end(), the phases may nest.
+			Each thread opens its own counters with perf_event_open() (Linux) when it begins a phase for the first time.
+			If they cannot be opened (other platforms, no PMU in a VM, perf_event_paranoid), only the time
+			and the number of the phases are counted.</p>
+			<p>When disabled, begin() and end() only check a flag.</p>
+			*/
+			class perf_counters
+			{
+			public:
+				/// Enables or disables the counting, returns true if the hardware counters are available.
+				static bool enable(bool is_enabled);
+
+				static bool is_enabled()
+				{
+					return _is_enabled.load(std::memory_order_relaxed);
+				}
+
+				/// Clears the counters of all phases.
+				static void reset();
+
+				static void begin(int phase)
+				{
+					if(is_enabled())
+					{
+						do_begin(phase);
+					}
+				}
+
+				static void end(int phase)
+				{
+					if(is_enabled())
+					{
+						do_end(phase);
+					}
+				}
+
+				static void get(int phase, PerfPhaseCounters * counters);
+
+			private:
+				enum value
+				{
+					COUNT,
+					TIME_NS,
+					CYCLES,
+					INSTRUCTIONS,
+					LLC_MISSES,
+					VALUES_COUNT
+				};
+
+				static void do_begin(int phase);
+				static void do_end(int phase);
+
+				static std::atomic<bool> _is_enabled;
+				static std::atomic<uint64_t> _totals[PERF_MAX_PHASES][VALUES_COUNT];
+			};
+
+		}
+	}
+}
+
+#endif
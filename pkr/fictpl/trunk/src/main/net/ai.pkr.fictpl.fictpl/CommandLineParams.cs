@@ -11,16 +11,16 @@ namespace ai.pkr.fictpl.fictpl
 @"Solve eq by fictitious play.")]
     public class CommandLineParams : StandardCmdLine
     {
-        [Argument(ArgumentType.Required, ShortName = "", LongName = "chance-tree",
-            HelpText = "Chance tree file.")]
+        [Argument(ArgumentType.AtMostOnce, ShortName = "", LongName = "chance-tree",
+            HelpText = "Chance tree file, required except for a worker.")]
         public PropString ChanceTree = "";
 
         [Argument(ArgumentType.AtMostOnce, LongName = "equal-ca", ShortName = "",
         DefaultValue = false, HelpText = "If true, optimize for equal chance abstractions.")]
         public bool EqualCa;
 
-        [Argument(ArgumentType.Required, ShortName = "", LongName = "action-tree",
-        HelpText = "Action tree file.")]
+        [Argument(ArgumentType.AtMostOnce, ShortName = "", LongName = "action-tree",
+        HelpText = "Action tree file, required except for a worker.")]
         public PropString ActionTree = null;
 
 
@@ -52,6 +52,18 @@ namespace ai.pkr.fictpl.fictpl
         DefaultValue = 0, HelpText = "Number threads in the thread pool.")]
         public int ThreadCount = 0;
 
+        [Argument(ArgumentType.AtMostOnce, ShortName = "", LongName = "workers",
+        DefaultValue = "", HelpText = "Comma-separated list of workers (host:port) for distributed solving. The input and output paths must be accessible by the workers.")]
+        public PropString Workers = "";
+
+        [Argument(ArgumentType.AtMostOnce, ShortName = "", LongName = "worker-port",
+        DefaultValue = "", HelpText = "If specified, run as a worker listening on this port until the coordinator stops it.")]
+        public string WorkerPort = "";
+
+        [Argument(ArgumentType.AtMostOnce, LongName = "perf-counters", ShortName = "",
+        DefaultValue = false, HelpText = "Collect performance counters of the phases of BR and print them with the iteration status.")]
+        public bool PerfCounters;
+
 
         #region Options
         
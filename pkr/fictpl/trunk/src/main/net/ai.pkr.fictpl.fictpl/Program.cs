@@ -40,6 +40,25 @@ namespace ai.pkr.fictpl.fictpl
                 Console.WriteLine("Unmanaged memory diagnostics is on");
             }
 
+            if (_cmdLine.WorkerPort != "")
+            {
+                FictitiousPlay worker = new FictitiousPlay
+                                            {
+                                                ThreadsCount = _cmdLine.ThreadCount,
+                                                IsVerbose = true
+                                            };
+                worker.Work(_cmdLine.WorkerPort);
+                return 0;
+            }
+
+            if (_cmdLine.ChanceTree.Get() == "" || _cmdLine.ActionTree == null)
+            {
+                Console.WriteLine("ERROR: chance tree and action tree are required");
+                return 1;
+            }
+
+            string[] workers = _cmdLine.Workers.Get().Split(new char[] { ',' }, StringSplitOptions.RemoveEmptyEntries);
+
             Console.WriteLine("Chance abstractions are {0}.", _cmdLine.EqualCa ? "equal" : "unequal");
 
 
@@ -64,6 +83,8 @@ namespace ai.pkr.fictpl.fictpl
                                                 OnIterationDone = OnIterationDone,
                                                 IterationVerbosity = _cmdLine.IterationVerbosity,
                                                 ThreadsCount = _cmdLine.ThreadCount,
+                                                Workers = workers,
+                                                IsPerfCountersOn = _cmdLine.PerfCounters,
                                                 IsVerbose = true
                                             };
 
@@ -88,6 +109,11 @@ namespace ai.pkr.fictpl.fictpl
                 }
             }
 
+            if (workers.Length > 0)
+            {
+                FictitiousPlay.ShutdownWorkers(workers);
+            }
+
             return 0;
         }
 
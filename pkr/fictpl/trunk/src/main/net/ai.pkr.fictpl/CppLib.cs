@@ -23,14 +23,165 @@ namespace ai.pkr.fictpl
         public static extern void IncrementGameValueNoMasks(double* pGameValues, UInt32 gameValuesCount,
             ChanceValueT* pChanceFactors);
 
+        #region Chance factor store
+
+        /// <summary>
+        /// Statistics and memory usage of a chance factor store.
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        public struct ChanceFactorStoreInfo
+        {
+            public UInt32 RowsCount;
+            public UInt32 SparseRowsCount;
+            /// <summary>
+            /// Sum of the numbers of the columns of the rows.
+            /// </summary>
+            public UInt64 ColumnsCount;
+            /// <summary>
+            /// Number of the columns with a non-zero factor of any kind.
+            /// </summary>
+            public UInt64 NonZeroCount;
+            public UInt64 ByteSize;
+            /// <summary>
+            /// Size of the factors if all rows were dense.
+            /// </summary>
+            public UInt64 DenseByteSize;
+        }
+
+        /// <summary>
+        /// Creates a store of kindsCount kinds of chance factors. The rows with a fill ratio 
+        /// (non-zero columns / columns) up to maxSparseFill are stored sparse, other rows dense.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern IntPtr ChanceFactorStore_Create(int kindsCount, double maxSparseFill);
+
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void ChanceFactorStore_Destroy(IntPtr store);
+
+        /// <summary>
+        /// Adds a row of count factors for each kind, returns the index of the row.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern UInt32 ChanceFactorStore_AddRow(IntPtr store, ChanceValueT** values, UInt32 count);
+
+        /// <summary>
+        /// Frees the memory reserved for more row infos, call after the last row is added.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void ChanceFactorStore_Compact(IntPtr store);
+
+        /// <summary>
+        /// Adds the factors of the row to the game values (16-byte aligned, padded to 4 values).
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void ChanceFactorStore_IncrementGameValue(IntPtr store, int kind, UInt32 row, 
+            double* pGameValues);
+
+        /// <summary>
+        /// Adds the factors of the row multiplied by scale to the game values.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void ChanceFactorStore_IncrementGameValueScaled(IntPtr store, int kind, UInt32 row,
+            double* pGameValues, double scale);
+
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void ChanceFactorStore_GetInfo(IntPtr store, out ChanceFactorStoreInfo info);
+
+        #endregion
+
+        #region Performance counters
+
+        /// <summary>
+        /// Max. number of the phases of the performance counters.
+        /// </summary>
+        public const int PerfMaxPhases = 8;
+
+        /// <summary>
+        /// Performance counters of a phase, summed over all threads and all executions of the phase.
+        /// Cycles, Instructions and LlcMisses are 0 if the hardware counters are not available.
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        public struct PerfPhaseCounters
+        {
+            public UInt64 Count;
+            public UInt64 TimeNs;
+            public UInt64 Cycles;
+            public UInt64 Instructions;
+            public UInt64 LlcMisses;
+        }
+
+        /// <summary>
+        /// Enables (enable != 0) or disables the performance counters, returns 1 if the hardware counters 
+        /// are available, otherwise only the times and the counts are collected.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern int PerfCounters_Enable(int enable);
+
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void PerfCounters_Reset();
+
+        /// <summary>
+        /// Begins a phase in the calling thread, the phases may nest.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void PerfCounters_Begin(int phase);
+
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void PerfCounters_End(int phase);
+
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void PerfCounters_Get(int phase, out PerfPhaseCounters counters);
+
+        #endregion
+
+        #region Chance tree index
+
+        /// <summary>
+        /// Sorts the entries by key (stable parallel radix sort), threadsCount &lt; 1 is 1 thread.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        internal static extern void ChanceIndex_Sort(FictitiousPlay.ChanceTreeIndexEntry* entries, UInt32 count, int threadsCount);
+
+        /// <summary>
+        /// Returned by CardKeyIndex_Find() for an unknown key.
+        /// </summary>
+        public const UInt32 CardKeyNotFound = 0xFFFFFFFF;
+
+        /// <summary>
+        /// Creates an index of packed card keys (an open-addressing hash table key -> value).
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern IntPtr CardKeyIndex_Create(UInt32 expectedCount);
+
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern void CardKeyIndex_Destroy(IntPtr index);
+
+        /// <summary>
+        /// Adds a key (not ~0), returns 0 if it is already in the index.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern int CardKeyIndex_Add(IntPtr index, UInt64 key, UInt32 value);
+
+        /// <summary>
+        /// Returns the value of the key or CardKeyNotFound.
+        /// </summary>
+        [DllImport("ai.pkr.fictpl.cpplib.dll")]
+        public static extern UInt32 CardKeyIndex_Find(IntPtr index, UInt64 key);
+
+        #endregion
+
+        [DllImport("libdl.so.2")]
+        static extern IntPtr dlopen(string fileName, int flags);
 
         public static void Init()
         {
-            string platform = System.IntPtr.Size == 8 ? "win64" : "win32";
+            bool isUnix = Environment.OSVersion.Platform == PlatformID.Unix;
+            string platform = isUnix ? (System.IntPtr.Size == 8 ? "linux64" : "linux32")
+                : (System.IntPtr.Size == 8 ? "win64" : "win32");
             string codeBase = CodeBase.Get(Assembly.GetExecutingAssembly());
             string dllDir = Path.Combine(Path.GetDirectoryName(codeBase),  platform);
 
-            string dllName = "ai.pkr.fictpl.cpplib.dll";
+            string dllName = isUnix ? "libai.pkr.fictpl.cpplib.so" : "ai.pkr.fictpl.cpplib.dll";
 
             string dllPath = Path.Combine(dllDir, dllName);
 
@@ -44,6 +195,17 @@ namespace ai.pkr.fictpl
                     throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
                 }
             }
+            if (isUnix)
+            {
+                // Load by full path, the DllImports are then resolved by the soname 
+                // (see the dllmap in ai.pkr.fictpl.dll.config).
+                const int RTLD_NOW = 2, RTLD_GLOBAL = 0x100;
+                if (dlopen(dllPath, RTLD_NOW | RTLD_GLOBAL) == IntPtr.Zero)
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+                return;
+            }
             string envPath = Environment.GetEnvironmentVariable("PATH");
             string envPathL = envPath.ToLower() + ";";
             if (envPathL.IndexOf(dllDir.ToLower() + ";") < 0)
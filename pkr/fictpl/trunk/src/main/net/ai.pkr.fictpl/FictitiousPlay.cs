@@ -10,6 +10,10 @@
 
 #define USE_CPP_LIB
 
+// If defined, the chance factors are stored in the cpp lib with sparse rows for rows with many
+// impossible card combinations (see MaxSparseChanceFactorFill). Requires USE_CPP_LIB.
+#define USE_SPARSE_CHANCE_FACTORS
+
 // This is no more suppoted !!!
 //#define USE_CHANCE_MASKS
 
@@ -36,6 +40,11 @@ using ai.lib.algorithms.parallel;
 using System.Threading;
 using ai.lib.algorithms.strings;
 using ai.lib.algorithms.numbers;
+using ai.lib.ipc;
+
+#if USE_SPARSE_CHANCE_FACTORS && !USE_CPP_LIB
+#error USE_SPARSE_CHANCE_FACTORS requires USE_CPP_LIB
+#endif
 
 #if DEBUG_PRINT 
 #warning Compiling with debug information influencing performance and memory requirements.
@@ -354,6 +363,17 @@ namespace ai.pkr.fictpl
             get;
         }
 
+        /// <summary>
+        /// Period of intermediate snapshots, s. The state is frozen (copied in memory) after an iteration
+        /// and written to the next snapshot in background while the iterations continue.
+        /// Set to 0 to save only the final snapshot. Default: 0.
+        /// </summary>
+        public double SnapshotPeriod
+        {
+            set;
+            get;
+        }
+
 
         /// <summary>
         /// Specifies the directory for intermediate trace output. null - no tracing.
@@ -431,6 +451,57 @@ namespace ai.pkr.fictpl
             get;
         }
 
+        /// <summary>
+        /// If a thread pool is used, large subtrees of the player trees are split into smaller jobs,
+        /// so that there are about JobsPerThread jobs per thread. Default: 8.
+        /// </summary>
+        public int JobsPerThread
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// A row of chance factors (a deal of the hero, the deals of the opponent) with the fill ratio 
+        /// (possible card combinations / all combinations) up to this value is stored sparse. 
+        /// This saves memory and time for abstractions with many impossible card combinations
+        /// and does not change the results. Default: 0.4.
+        /// </summary>
+        public double MaxSparseChanceFactorFill
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// If true, the performance counters of the cpp lib are collected for the phases of BR
+        /// (values-up in the top tree nodes, finalize walk, game value accumulation) and printed 
+        /// with the iteration status: the thread time, and if the hardware counters are available (Linux perf_event_open()),
+        /// cycles, IPC, LLC misses and the memory traffic of the misses (64 bytes each) per thread second.
+        /// <para>This adds a few native calls per node and per final BR leaf and slows down the iterations. 
+        /// If false (default), nothing is called. In distributed mode the BR runs in the workers and is not counted.</para>
+        /// </summary>
+        public bool IsPerfCountersOn
+        {
+            set;
+            get;
+        }
+
+
+        /// <summary>
+        /// Addresses (host:port) of the workers for distributed solving, null or empty - solve in this process (default).
+        /// <para>The deals of the player chance trees are split between the workers (see Shard). Each worker 
+        /// keeps the game values and the chance factors of its deals only and does BR for them. This object coordinates 
+        /// the iterations and forwards the final BR leaves of each worker to all workers to update the game values.</para>
+        /// <para>The workers read the input files and write the game values of the snapshots themselves, 
+        /// therefore the files must be available at the same paths on the hosts of the workers (e.g. a shared file system).
+        /// A worker is started by Work().</para>
+        /// </summary>
+        public string[] Workers
+        {
+            set;
+            get;
+        }
 
         /// <summary>
         /// Add new entry to EpsilonLog if CurrentEpsilon &lt;= previous-epsilon * EpsilonLogThreshold.
@@ -455,20 +526,129 @@ namespace ai.pkr.fictpl
             ThreadsCount = 0;
             SnapshotsCount = 2;
             OutputPath = "./FictPlay";
-            //JobsPerThread = 1;
+            JobsPerThread = 8;
+            MaxSparseChanceFactorFill = 0.4;
         }
 
         public void Solve()
         {
             Initialize();
             DoIterations();
+            WaitIntermediateSnapshot();
             SwitchSnapshot();
-            SaveSnapshot();
-            FreeActionGroupsAndChanceFactors();
-            SaveStrategies();
+            if (IsDistributed)
+            {
+                SaveSnapshotDistributed();
+            }
+            else
+            {
+                SaveSnapshot();
+                FreeActionGroupsAndChanceFactors();
+                SaveStrategies();
+            }
             CleanUp();
         }
 
+        /// <summary>
+        /// Runs a worker for distributed solving (see Workers) listening on the port. 
+        /// Serves the coordinators one after another, returns after ShutdownWorkers().
+        /// The parameters of the solving are received from the coordinator, 
+        /// ThreadsCount, JobsPerThread, MaxSparseChanceFactorFill and IsVerbose are taken from this object.
+        /// </summary>
+        public void Work(string port)
+        {
+            Server server = new Server();
+            server.Start(port);
+            if (IsVerbose)
+            {
+                Console.WriteLine("Worker is listening on port {0}", server.Port);
+            }
+            try
+            {
+                Work(server);
+            }
+            finally
+            {
+                server.Stop();
+            }
+        }
+
+        /// <summary>
+        /// Runs a worker on a started server, see Work(string).
+        /// </summary>
+        public void Work(Server server)
+        {
+            for (; ; )
+            {
+                Server.Event e;
+                if (!server.DequeInputEvent(out e))
+                {
+                    server.WaitEvent.WaitOne();
+                    continue;
+                }
+                FictitiousPlay session = (FictitiousPlay)e.Connection.UserData;
+                if (e.Kind == EventKind.Disconnect)
+                {
+                    EndWorkerSession(e.Connection);
+                    continue;
+                }
+                if (e.Kind != EventKind.RxMessage)
+                {
+                    continue;
+                }
+                WorkerMessage kind = GetMessageKind(e.Message);
+                if (kind == WorkerMessage.Shutdown)
+                {
+                    EndWorkerSession(e.Connection);
+                    return;
+                }
+                try
+                {
+                    if (kind == WorkerMessage.Init)
+                    {
+                        EndWorkerSession(e.Connection);
+                        session = new FictitiousPlay
+                                      {
+                                          ThreadsCount = ThreadsCount,
+                                          JobsPerThread = JobsPerThread,
+                                          MaxSparseChanceFactorFill = MaxSparseChanceFactorFill,
+                                          IsVerbose = IsVerbose
+                                      };
+                        e.Connection.UserData = session;
+                        session.InitializeWorker(e.Connection, ReadMessage(e.Message, WorkerMessage.Init));
+                    }
+                    else if (session == null)
+                    {
+                        throw new ApplicationException(String.Format("Unexpected message {0}, worker is not initialized", kind));
+                    }
+                    else
+                    {
+                        session.ProcessWorkerMessage(e.Message);
+                    }
+                }
+                catch (Exception ex)
+                {
+                    if (IsVerbose)
+                    {
+                        Console.WriteLine("Worker error: {0}", ex);
+                    }
+                    e.Connection.Send(CreateMessage(WorkerMessage.Error, w => w.Write(ex.Message)));
+                    EndWorkerSession(e.Connection);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Stops the workers started by Work().
+        /// </summary>
+        public static void ShutdownWorkers(string[] workers)
+        {
+            FictitiousPlay coordinator = new FictitiousPlay { Workers = workers };
+            coordinator.ConnectWorkers();
+            coordinator.SendToWorkers(CreateMessage(WorkerMessage.Shutdown, null));
+            coordinator.DisconnectWorkers();
+        }
+
         #endregion
 
         #region Implementation - main data types
@@ -663,6 +843,9 @@ namespace ai.pkr.fictpl
         struct ChanceInfoEntryT
         {
             public UInt32 ChanceMaskIdx;
+            /// <summary>
+            /// Index of the first factor in _chanceFactors or the row in _chanceFactorStores.
+            /// </summary>
             public UInt32 ChanceFactorIdx;
             /// <summary>
             /// This is the id of the leaves of the player tree in the corresponding action group.
@@ -678,14 +861,29 @@ namespace ai.pkr.fictpl
             _Count = 2
         }
 
+        /// <summary>
+        /// Phases of the performance counters (see IsPerfCountersOn).
+        /// </summary>
+        enum PerfPhase
+        {
+            ValuesUp = 0,
+            Finalize = 1,
+            GameValue = 2,
+            _Count = 3
+        }
+
+        static readonly string[] PerfPhaseNames = new string[] { "v-up", "fin", "gv" };
+
         struct ActionGroup
         {
             public double PotFactor;
             
             public CfKind ChanceInfoKind;
 
+            public int Round;
+
             /// <summary>
-            /// Game value without pot factor.
+            /// Game value without pot factor. Contains only the deals of the shard.
             /// </summary>
             public double * GameValues;
             public int GameValuesLength;
@@ -720,37 +918,105 @@ namespace ai.pkr.fictpl
         /// This is always a deal node. This class calculates the game value in its own subtree of the player tree.
         /// This can be done is a separate thread.
         /// The total game value is the sum of the game values of all top tree nodes.
+        /// <para>A large subtree is split at deal nodes into child nodes (see TopTree.Split()).
+        /// They are processed first, the parent takes their game values instead of walking their subtrees.</para>
         /// </summary>
         class TopTreeNode
         {
-            public TopTreeNode(FictitiousPlay solver, int heroPos, Int64 rootNode)
+            public TopTreeNode(FictitiousPlay solver, int heroPos, Int64 rootNode, TopTreeNode parent)
             {
                 Debug.Assert(solver._playerTrees[heroPos].Nodes[rootNode].Position == solver._playersCount, 
                     "The root must be a deal node");
                 _solver = solver;
                 _heroPos = heroPos;
-                Job.Param1 = rootNode;
-                Job.Execute = BestResponseValuesUp;
-                _wt.OnNodeBegin = BestResponseValuesUp_OnNodeBegin;
-                _wt.OnNodeEnd = BestResponseValuesUp_OnNodeEnd;
-                _startDepth = 1 + solver._playersCount;
+                RootNode = rootNode;
+                Parent = parent;
+                _startDepth = solver._playerTrees[heroPos].GetDepth(rootNode);
             }
 
-            public ThreadPoolBase.Job<Int64> Job = new ThreadPoolBase.Job<Int64>();
+            public Int64 RootNode;
+
+            /// <summary>
+            /// Index of the node following the subtree in pre-order.
+            /// </summary>
+            public Int64 EndNode;
+
+            /// <summary>
+            /// Node containing this one, null for the nodes at depth 1.
+            /// </summary>
+            public TopTreeNode Parent;
+
+            /// <summary>
+            /// Split subtrees, in pre-order.
+            /// </summary>
+            public List<TopTreeNode> Children = new List<TopTreeNode>();
+
+            /// <summary>
+            /// Estimated execution time: the time of the last execution, 
+            /// before the first one - number of nodes in the subtree.
+            /// </summary>
+            public double Cost;
+
+            /// <summary>
+            /// Number of children not yet processed in the current iteration.
+            /// </summary>
+            public int PendingChildrenCount;
+
+            /// <summary>
+            /// The game value for the nodes at depth 1, the internal game value of the root for the children.
+            /// </summary>
             public double GameValue;
 
             int _startDepth;
             FictitiousPlay _solver;
             int _heroPos;
-            WalkUFTreePP<PlayerTree, BestResponseValuesUpContext> _wt = new WalkUFTreePP<PlayerTree, BestResponseValuesUpContext>();
+            BestResponseValuesUpContext[] _stack;
             ActionGroup * _actionGroup;
 
-            void BestResponseValuesUp(Int64 rootNode)
+            /// <summary>
+            /// Walks the subtree like WalkUFTreePP, but skips the subtrees of the children.
+            /// </summary>
+            public void BestResponseValuesUp()
             {
+                PlayerTree t = _solver._playerTrees[_heroPos];
+                if (_stack == null)
+                {
+                    _stack = new BestResponseValuesUpContext[256].Fill(i => new BestResponseValuesUpContext());
+                }
                 fixed(ActionGroup * pAg = &(_solver._actionGroups[_heroPos][0]))
                 {
                     _actionGroup = pAg;
-                    _wt.Walk(_solver._playerTrees[_heroPos], rootNode);
+                    int childIdx = 0;
+                    Int64 nextChildRoot = Children.Count > 0 ? Children[0].RootNode : Int64.MaxValue;
+                    int depth = -1;
+                    for (Int64 i = RootNode; i < EndNode; ++i)
+                    {
+                        int curDepth = t.GetDepth(i);
+                        for (; depth >= curDepth; --depth)
+                        {
+                            BestResponseValuesUp_OnNodeEnd(t, _stack, depth);
+                        }
+                        depth = curDepth;
+                        BestResponseValuesUpContext c = _stack[depth];
+                        c.NodeIdx = i;
+                        c.ChildrenCount = 0;
+                        c.Child = null;
+                        if (i > RootNode)
+                        {
+                            _stack[depth - 1].ChildrenCount++;
+                        }
+                        BestResponseValuesUp_OnNodeBegin(t, _stack, depth);
+                        if (i == nextChildRoot)
+                        {
+                            c.Child = Children[childIdx++];
+                            i = c.Child.EndNode - 1;
+                            nextChildRoot = childIdx < Children.Count ? Children[childIdx].RootNode : Int64.MaxValue;
+                        }
+                    }
+                    for (; depth >= _startDepth; --depth)
+                    {
+                        BestResponseValuesUp_OnNodeEnd(t, _stack, depth);
+                    }
                 }
             }
 
@@ -758,6 +1024,10 @@ namespace ai.pkr.fictpl
             {
                 public double GameValue;
                 public int IdInActionGroup = -1;
+                /// <summary>
+                /// If not null, the subtree is processed by this child.
+                /// </summary>
+                public TopTreeNode Child;
             }
 
             void BestResponseValuesUp_OnNodeBegin(PlayerTree t, BestResponseValuesUpContext[] s, int d)
@@ -783,7 +1053,11 @@ namespace ai.pkr.fictpl
                 Debug.Assert(d > 0, "Root cannot be processed in the top tree");
                 BestResponseValuesUpContext c = s[d];
                 Node* pNode = t.Nodes + c.NodeIdx;
-                if (c.ChildrenCount == 0)
+                if (c.Child != null)
+                {
+                    c.GameValue = c.Child.GameValue;
+                }
+                else if (c.ChildrenCount == 0)
                 {
                     // A leaf
                     ActionGroup * pAg = _actionGroup + pNode->AtIdx;
@@ -816,6 +1090,10 @@ namespace ai.pkr.fictpl
                         }
                     }
                 }
+                else if (Parent != null)
+                {
+                    GameValue = c.GameValue;
+                }
                 else
                 {
                     double gameValue = _solver.ConvertGameValue(c.GameValue, _heroPos);
@@ -826,10 +1104,36 @@ namespace ai.pkr.fictpl
 
         /// <summary>
         /// A top of the main player tree used for parallel processing.
+        /// <para>The nodes are processed by a scheduler: each worker takes the most expensive ready node
+        /// (by the cost of the last iteration). A parent node is ready when all its children are done.</para>
         /// </summary>
         class TopTree
         {
+            /// <summary>
+            /// Nodes at depth 1.
+            /// </summary>
             public List<TopTreeNode> Nodes = new List<TopTreeNode>();
+
+            /// <summary>
+            /// All nodes including split children.
+            /// </summary>
+            public List<TopTreeNode> AllNodes = new List<TopTreeNode>();
+
+            /// <summary>
+            /// For each worker: time spent in the nodes during the last execution, s.
+            /// </summary>
+            public double[] WorkerBusyTime = new double[0];
+
+            /// <summary>
+            /// Duration of the last execution, s.
+            /// </summary>
+            public double ExecutionTime;
+
+            /// <summary>
+            /// If true, each node is counted in the phase ValuesUp of the performance counters.
+            /// </summary>
+            public bool IsPerfCountersOn;
+
             internal double SumAndClearValues()
             {
                 double sum = 0;
@@ -840,55 +1144,356 @@ namespace ai.pkr.fictpl
                 }
                 return sum;
             }
-        }
 
-        #endregion
-
-        #region Implementation - main data fields
+            /// <summary>
+            /// Splits the nodes larger than 1 / jobsCount of the tree at the next deal nodes, recursively.
+            /// </summary>
+            public void Split(FictitiousPlay solver, int heroPos, int jobsCount)
+            {
+                PlayerTree t = solver._playerTrees[heroPos];
+                AllNodes.Clear();
+                Int64 totalSize = 0;
+                foreach (TopTreeNode node in Nodes)
+                {
+                    node.EndNode = GetSubtreeEnd(t, node.RootNode);
+                    totalSize += node.EndNode - node.RootNode;
+                }
+                Int64 maxSize = Math.Max(1, totalSize / Math.Max(1, jobsCount));
+                foreach (TopTreeNode node in Nodes)
+                {
+                    SplitNode(solver, heroPos, node, maxSize);
+                }
+            }
 
-        List<EpsilonLogEntry> _epsilonLog = new List<EpsilonLogEntry>();
-        SnapshotSwitcher _snapshotSwitcher;
-        private SnapshotInfo _curSnapshotInfo;
-        /// <summary>
-        /// A copy of last loaded snapshot info.
-        /// </summary>
-        private SnapshotInfo _loadedSnapshotInfo;
-        int _playersCount;
-        PlayerTree[] _playerTrees;
-        TopTree[] _topTrees;
+            /// <summary>
+            /// Processes all nodes. If threadPool is null, does it in the calling thread.
+            /// If a node fails, the other workers stop and the error is rethrown here.
+            /// </summary>
+            public void Execute(AssigningThreadPool threadPool)
+            {
+                int workersCount = threadPool == null ? 1 : threadPool.ThreadsCount;
+                if (WorkerBusyTime.Length != workersCount)
+                {
+                    WorkerBusyTime = new double[workersCount];
+                    _workerJobs = new ThreadPoolBase.Job<int>[workersCount].Fill(
+                        i => new ThreadPoolBase.Job<int> { Execute = ExecuteNodes, Param1 = i });
+                }
+                Array.Clear(WorkerBusyTime, 0, workersCount);
+                _readyNodes.Clear();
+                foreach (TopTreeNode node in AllNodes)
+                {
+                    node.PendingChildrenCount = node.Children.Count;
+                    if (node.PendingChildrenCount == 0)
+                    {
+                        _readyNodes.Add(node);
+                    }
+                }
+                // The most expensive nodes go last, they are taken first.
+                _readyNodes.Sort((a, b) => a.Cost.CompareTo(b.Cost));
+                _doneCount = 0;
 
-#if USE_CHANCE_MASKS
-        /// <summary>
-        /// For each player: bit masks of possible card comibnations.
-        /// </summary>
-        FastBitArray[] _chanceMasks;
-#endif
-        struct ChanceFactorArray
-        {
-            public ChanceValueT * Data;
-            IntPtr _unalignedPtr;
+                long start = Stopwatch.GetTimestamp();
+                if (threadPool == null)
+                {
+                    ExecuteNodes(0);
+                }
+                else
+                {
+                    for (int w = 0; w < workersCount; ++w)
+                    {
+                        threadPool.QueueJob(_workerJobs[w], w);
+                    }
+                    threadPool.WaitAllJobs();
+                }
+                ExecutionTime = (double)(Stopwatch.GetTimestamp() - start) / Stopwatch.Frequency;
+                if (_error != null)
+                {
+                    Exception error = _error;
+                    _error = null;
+                    throw new ApplicationException("Processing a top tree node failed, see inner exception for details.", error);
+                }
+            }
 
-            public uint Length
+            void ExecuteNodes(int worker)
             {
-                get;
-                private set;
+                for (; ; )
+                {
+                    TopTreeNode node;
+                    lock (_readyNodes)
+                    {
+                        while (_readyNodes.Count == 0 || _error != null)
+                        {
+                            if (_doneCount == AllNodes.Count || _error != null)
+                            {
+                                return;
+                            }
+                            Monitor.Wait(_readyNodes);
+                        }
+                        node = _readyNodes[_readyNodes.Count - 1];
+                        _readyNodes.RemoveAt(_readyNodes.Count - 1);
+                    }
+                    long start = Stopwatch.GetTimestamp();
+                    Exception error = null;
+                    try
+                    {
+                        if (IsPerfCountersOn)
+                        {
+                            CppLib.PerfCounters_Begin((int)PerfPhase.ValuesUp);
+                            try
+                            {
+                                node.BestResponseValuesUp();
+                            }
+                            finally
+                            {
+                                CppLib.PerfCounters_End((int)PerfPhase.ValuesUp);
+                            }
+                        }
+                        else
+                        {
+                            node.BestResponseValuesUp();
+                        }
+                    }
+                    catch (Exception e)
+                    {
+                        error = e;
+                    }
+                    node.Cost = (double)(Stopwatch.GetTimestamp() - start) / Stopwatch.Frequency;
+                    WorkerBusyTime[worker] += node.Cost;
+                    lock (_readyNodes)
+                    {
+                        if (error != null)
+                        {
+                            // The parent will never be ready: keep the first error and wake up 
+                            // the waiting workers, they stop.
+                            if (_error == null)
+                            {
+                                _error = error;
+                            }
+                            Monitor.PulseAll(_readyNodes);
+                            return;
+                        }
+                        _doneCount++;
+                        TopTreeNode parent = node.Parent;
+                        if (parent != null && --parent.PendingChildrenCount == 0)
+                        {
+                            // The parent is usually cheap, take it next.
+                            _readyNodes.Add(parent);
+                            Monitor.PulseAll(_readyNodes);
+                        }
+                        else if (_doneCount == AllNodes.Count)
+                        {
+                            Monitor.PulseAll(_readyNodes);
+                        }
+                    }
+                }
             }
 
-            internal void Allocate(uint length)
+            void SplitNode(FictitiousPlay solver, int heroPos, TopTreeNode node, Int64 maxSize)
             {
-                // Allocate memory aligned at 16-byte addresses
-                // Make sure the size is aligned at 4 elements and 16 bytes (required for SSE code in cpp lib).
-                Length = length;
-                length = (length + 3) & (~0x3U);
-                Int64 byteSize = length * sizeof(ChanceValueT) + 15;
-                _unalignedPtr = UnmanagedMemory.AllocHGlobalEx(byteSize);
-                UnmanagedMemory.SetMemory(_unalignedPtr, byteSize, 0);
-                Data = (ChanceValueT*)((_unalignedPtr.ToInt64() + 15) & (~0xFL));
+                AllNodes.Add(node);
+                node.Cost = node.EndNode - node.RootNode;
+                if (node.EndNode - node.RootNode <= maxSize)
+                {
+                    return;
+                }
+                PlayerTree t = solver._playerTrees[heroPos];
+                for (Int64 n = node.RootNode + 1; n < node.EndNode; ++n)
+                {
+                    if (t.Nodes[n].Position == solver._playersCount)
+                    {
+                        TopTreeNode child = new TopTreeNode(solver, heroPos, n, node);
+                        child.EndNode = GetSubtreeEnd(t, n);
+                        node.Children.Add(child);
+                        // Deeper deal nodes are split by the child.
+                        n = child.EndNode - 1;
+                    }
+                }
+                foreach (TopTreeNode child in node.Children)
+                {
+                    SplitNode(solver, heroPos, child, maxSize);
+                }
             }
 
-            internal void Free()
+            static Int64 GetSubtreeEnd(PlayerTree t, Int64 root)
             {
-                if (_unalignedPtr != IntPtr.Zero)
+                int rootDepth = t.GetDepth(root);
+                Int64 n = root + 1;
+                for (; n < t.NodesCount && t.GetDepth(n) > rootDepth; ++n)
+                {
+                }
+                return n;
+            }
+
+            /// <summary>
+            /// Ready nodes sorted by cost, also used as the lock.
+            /// </summary>
+            List<TopTreeNode> _readyNodes = new List<TopTreeNode>();
+            int _doneCount;
+            /// <summary>
+            /// The first error of a node, guarded by _readyNodes.
+            /// </summary>
+            Exception _error;
+            ThreadPoolBase.Job<int>[] _workerJobs;
+        }
+
+        /// <summary>
+        /// The part of the deals processed by a worker of distributed fictitious play (see Workers).
+        /// <para>For each position, the deals of round 0 are split into Count contiguous ranges of about 
+        /// equal number of final deals. The shard contains the range Index and all the deals following 
+        /// them in the next rounds. The ranks (see FindPlayerCtRank()) of these deals are contiguous 
+        /// in each round, because the ranks are pre-order numbers.</para>
+        /// <para>A worker keeps in the action groups only the game values of the deals of its shard, 
+        /// and in the chance factors of the hero only the columns of the deals of the opponent in the shard.
+        /// The top tree of the worker contains only the nodes of its deals.
+        /// A single process has one shard containing all deals.</para>
+        /// </summary>
+        class Shard
+        {
+            public Shard(InitData init, int index, int count)
+            {
+                Index = index;
+                Count = count;
+                int playersCount = init.PlayerCts.Length;
+                Begin = new int[playersCount][];
+                Length = new int[playersCount][];
+                FullLength = new int[playersCount][];
+                for (int p = 0; p < playersCount; ++p)
+                {
+                    ChanceTree ct = init.PlayerCts[p];
+                    int roundsCount = init.RoundsCount;
+                    int lastRound = roundsCount - 1;
+                    FullLength[p] = (int[])init.PlayerCtNodesCount[p].Clone();
+
+                    // Number of final deals after each deal of round 0.
+                    int[] weights = new int[FullLength[p][0]];
+                    int r0Rank = -1;
+                    for (Int64 n = 1; n < ct.NodesCount; ++n)
+                    {
+                        int round = ct.GetDepth(n) - 1;
+                        if (round == 0)
+                        {
+                            r0Rank++;
+                        }
+                        if (round == lastRound)
+                        {
+                            weights[r0Rank]++;
+                        }
+                    }
+
+                    // Find the range of deals of round 0 [r0Begin, r0End).
+                    Int64 totalWeight = 0;
+                    for (int i = 0; i < weights.Length; ++i)
+                    {
+                        totalWeight += weights[i];
+                    }
+                    int r0Begin = weights.Length, r0End = weights.Length;
+                    Int64 cumWeight = 0;
+                    for (int i = 0; i < weights.Length; ++i)
+                    {
+                        if (r0Begin == weights.Length && cumWeight * count >= totalWeight * index)
+                        {
+                            r0Begin = i;
+                        }
+                        if (cumWeight * count >= totalWeight * (index + 1))
+                        {
+                            r0End = i;
+                            break;
+                        }
+                        cumWeight += weights[i];
+                    }
+
+                    // Count the deals of each round before and in the range.
+                    Begin[p] = new int[roundsCount];
+                    Length[p] = new int[roundsCount];
+                    r0Rank = -1;
+                    for (Int64 n = 1; n < ct.NodesCount; ++n)
+                    {
+                        int round = ct.GetDepth(n) - 1;
+                        if (round == 0)
+                        {
+                            r0Rank++;
+                        }
+                        if (r0Rank < r0Begin)
+                        {
+                            Begin[p][round]++;
+                        }
+                        else if (r0Rank < r0End)
+                        {
+                            Length[p][round]++;
+                        }
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Index of the shard in [0, Count).
+            /// </summary>
+            public int Index;
+            public int Count;
+
+            /// <summary>
+            /// For each position, round: the rank of the first deal of the shard.
+            /// </summary>
+            public int[][] Begin;
+
+            /// <summary>
+            /// For each position, round: the number of deals of the shard.
+            /// </summary>
+            public int[][] Length;
+
+            /// <summary>
+            /// For each position, round: the number of all deals (nodes of the player chance tree).
+            /// </summary>
+            public int[][] FullLength;
+        }
+
+        #endregion
+
+        #region Implementation - main data fields
+
+        List<EpsilonLogEntry> _epsilonLog = new List<EpsilonLogEntry>();
+        SnapshotSwitcher _snapshotSwitcher;
+        private SnapshotInfo _curSnapshotInfo;
+        /// <summary>
+        /// A copy of last loaded snapshot info.
+        /// </summary>
+        private SnapshotInfo _loadedSnapshotInfo;
+        int _playersCount;
+        PlayerTree[] _playerTrees;
+        TopTree[] _topTrees;
+
+#if USE_CHANCE_MASKS
+        /// <summary>
+        /// For each player: bit masks of possible card comibnations.
+        /// </summary>
+        FastBitArray[] _chanceMasks;
+#endif
+        struct ChanceFactorArray
+        {
+            public ChanceValueT * Data;
+            IntPtr _unalignedPtr;
+
+            public uint Length
+            {
+                get;
+                private set;
+            }
+
+            internal void Allocate(uint length)
+            {
+                // Allocate memory aligned at 16-byte addresses
+                // Make sure the size is aligned at 4 elements and 16 bytes (required for SSE code in cpp lib).
+                Length = length;
+                length = (length + 3) & (~0x3U);
+                Int64 byteSize = length * sizeof(ChanceValueT) + 15;
+                _unalignedPtr = UnmanagedMemory.AllocHGlobalEx(byteSize);
+                UnmanagedMemory.SetMemory(_unalignedPtr, byteSize, 0);
+                Data = (ChanceValueT*)((_unalignedPtr.ToInt64() + 15) & (~0xFL));
+            }
+
+            internal void Free()
+            {
+                if (_unalignedPtr != IntPtr.Zero)
                 {
                     UnmanagedMemory.FreeHGlobal(_unalignedPtr);
                     _unalignedPtr = IntPtr.Zero;
@@ -905,7 +1510,14 @@ namespace ai.pkr.fictpl
         /// <para>For 2 players pot == 2*inPot => pot * potShare - inPot = 2 * inPot * potShare - inPot = inPot * (2*potShare - 1)</para>
         /// <para>So, chanceFactor = chanceProbab * ( 2 * potShare - 1)</para>
         /// </summary>
+#if USE_SPARSE_CHANCE_FACTORS
+        /// <summary>
+        /// For each player: a store of the chance factors (see _chanceFactors) in the cpp lib, a row for each chance info.
+        /// </summary>
+        IntPtr[] _chanceFactorStores;
+#else
         ChanceFactorArray[][] _chanceFactors;
+#endif
 
         double _minCfOrder = double.MaxValue;
         double _maxCfOrder = double.MinValue;
@@ -921,6 +1533,11 @@ namespace ai.pkr.fictpl
         /// </summary>
         ActionGroup [][]_actionGroups;
 
+        /// <summary>
+        /// Deals processed by this process.
+        /// </summary>
+        Shard _shard;
+
         /// <summary>
         /// Position of the player currently doing BR.
         /// </summary>
@@ -939,13 +1556,16 @@ namespace ai.pkr.fictpl
             CppLib.Init();
         }
 
-        struct ChanceTreeIndexEntry
+        /// <summary>
+        /// Entry of the chance tree index, must match ChanceIndexEntry in the cpp lib.
+        /// </summary>
+        internal struct ChanceTreeIndexEntry
         {
             /// <summary>
-            /// Contains stringizised card paths for each player. 
-            /// First N cards - player 0, next N - player 1, etc.
+            /// Card paths of the players as ranks in the player chance trees (see FindPlayerCtRank()).
+            /// The rank of the hero is in the high 32 bits, the rank of the opponent in the low 32 bits.
             /// </summary>
-            public string Key;
+            public UInt64 Key;
 
             /// <summary>
             /// Index of the node in the chance tree.
@@ -954,7 +1574,7 @@ namespace ai.pkr.fictpl
 
             public override string ToString()
             {
-                return string.Format("{0} -> {1}", Key, NodeIdx);
+                return string.Format("{0:X16} -> {1}", Key, NodeIdx);
             }
         }
 
@@ -996,8 +1616,6 @@ namespace ai.pkr.fictpl
 
                 PlayerCtNodesCount = new int[playersCount][].Fill(i => new int[RoundsCount]);
 
-                PlayerCtKeys = new string[playersCount][][];
-
                 for (int p = 0; p < playersCount; ++p)
                 {
                     PlayerCtMinCard[p] = new int[RoundsCount].Fill(int.MaxValue);
@@ -1012,12 +1630,6 @@ namespace ai.pkr.fictpl
                         PlayerCtMaxCard[p][round] = Math.Max(PlayerCtMaxCard[p][round], card);
                         PlayerCtNodesCount[p][round]++;
                     }
-                    PlayerCtKeys[p] = new string[RoundsCount][];
-                    for (int r = 0; r < RoundsCount; ++r)
-                    {
-                        PlayerCtKeys[p][r] = new string[PlayerCtNodesCount[p][r]];
-                    }
-                    BuildPlayerCtKeys(p);
                 }
 
                 if (solver.EqualCa)
@@ -1045,6 +1657,16 @@ namespace ai.pkr.fictpl
                 Ct = ChanceTree.Read<ChanceTree>(solver.ChanceTreeFile);
 
                 int playersCount = Ct.PlayersCount;
+                if (playersCount != 2)
+                {
+                    throw new ApplicationException(String.Format("Only 2 players are supported, ct has {0}", playersCount));
+                }
+                _sortThreadsCount = solver.ThreadsCount;
+                PlayerCtKeyIndex = new IntPtr[playersCount];
+                for (int p = 0; p < playersCount; ++p)
+                {
+                    BuildPlayerCtKeyIndex(p);
+                }
                 BuildCtIndex(solver, playersCount);
 
                 ChanceMasksCount = new uint[playersCount];
@@ -1060,7 +1682,8 @@ namespace ai.pkr.fictpl
                             {
                                 continue;
                             }
-                            int oppCtNodesCount = PlayerCtNodesCount[oppPos][r];
+                            // Only the columns of the deals of the opponent in the shard.
+                            int oppCtNodesCount = solver._shard.Length[oppPos][r];
                             oppCtNodesCount = (oppCtNodesCount + 3) & (~0x3); // 4-blocks alignment for SSE commands in cpp lib
                             ChanceFactorsCount[heroPos] += (UInt32)(PlayerCtNodesCount[heroPos][r] * oppCtNodesCount);
                         }
@@ -1073,14 +1696,22 @@ namespace ai.pkr.fictpl
                 Ct.Dispose();
                 Ct = null;
                 ChanceTreeIndex = null;
+                for (int p = 0; p < PlayerCtKeyIndex.Length; ++p)
+                {
+                    if (PlayerCtKeyIndex[p] != IntPtr.Zero)
+                    {
+                        CppLib.CardKeyIndex_Destroy(PlayerCtKeyIndex[p]);
+                    }
+                }
+                PlayerCtKeyIndex = null;
             }
 
             class BuildChanceTreeIndexContext : WalkUFTreePPContext
             {
                 /// <summary>
-                /// Cards for each player.
+                /// Rank of the card path for each player.
                 /// </summary>
-                public List<int>[] Cards;
+                public UInt32[] Ranks;
             }
 
             private void BuildCtIndex(FictitiousPlay solver, int playersCount)
@@ -1108,110 +1739,122 @@ namespace ai.pkr.fictpl
                 WalkUFTreePP<ChanceTree, BuildChanceTreeIndexContext> wt = new WalkUFTreePP<ChanceTree, BuildChanceTreeIndexContext>();
                 wt.OnNodeBegin = (t, s, d) =>
                  {
-                     if (s[d].Cards == null)
+                     if (s[d].Ranks == null)
                      {
-                         s[d].Cards = new List<int>[playersCount].Fill(i => new List<int>());
+                         s[d].Ranks = new UInt32[playersCount];
                      }
                      if (d == 0)
                      {
                          return;
                      }
 
-                     for (int p = 0; p < s[d].Cards.Length; ++p)
-                     {
-                         s[d].Cards[p].Clear();
-                         s[d].Cards[p].AddRange(s[d - 1].Cards[p]);
-                     }
+                     Array.Copy(s[d - 1].Ranks, s[d].Ranks, playersCount);
                      int card = t.Nodes[s[d].NodeIdx].Card;
                      int pos = t.Nodes[s[d].NodeIdx].Position;
-                     s[d].Cards[pos].Add(card);
+                     int round = (d - 1) / playersCount;
+                     s[d].Ranks[pos] = FindPlayerCtRank(pos, round, s[d - 1].Ranks[pos], card);
                      if (d % playersCount == 0)
                      {
-                         int round = (d - 1) / playersCount;
-                         for (int p = 0; p < playersCount; ++p)
-                         {
-                             ChanceTreeIndex[round][count[round]].Key += CardsToKey(s[d].Cards[p]);
-                         }
-                         ChanceTreeIndex[round][count[round]].NodeIdx += (UInt32)s[d].NodeIdx;
+                         // Note: only 2 players are supported.
+                         ChanceTreeIndex[round][count[round]].Key = ((UInt64)s[d].Ranks[0] << 32) | s[d].Ranks[1];
+                         ChanceTreeIndex[round][count[round]].NodeIdx = (UInt32)s[d].NodeIdx;
                          count[round]++;
                      }
                  };
                 wt.Walk(Ct);
             }
 
-            class BuildPlayerCtKeysContext : WalkUFTreePPContext
+            class BuildPlayerCtKeyIndexContext : WalkUFTreePPContext
+            {
+                public UInt32 Rank;
+            }
+
+            /// <summary>
+            /// Packs a card path step into a key: round, rank of the path to the parent node, card.
+            /// </summary>
+            static UInt64 PackCardKey(int round, UInt32 parentRank, int card)
             {
-                public List<int> Cards = new List<int>();
+                if ((UInt32)card > 0xFFFFFF)
+                {
+                    throw new ApplicationException(String.Format("Card {0} cannot be packed into a key", card));
+                }
+                return ((UInt64)round << 56) | ((UInt64)parentRank << 24) | (UInt32)card;
             }
 
-            private void BuildPlayerCtKeys(int p)
+            /// <summary>
+            /// Indexes the card paths of the player chance tree. The rank of a path is its pre-order number 
+            /// among the nodes of its round.
+            /// </summary>
+            private void BuildPlayerCtKeyIndex(int p)
             {
                 UInt32 [] count = new UInt32[RoundsCount];
-                WalkUFTreePP<ChanceTree, BuildPlayerCtKeysContext> wt =
-                    new WalkUFTreePP<ChanceTree, BuildPlayerCtKeysContext>();
+                PlayerCtKeyIndex[p] = CppLib.CardKeyIndex_Create((UInt32)(PlayerCts[p].NodesCount - 1));
+                WalkUFTreePP<ChanceTree, BuildPlayerCtKeyIndexContext> wt =
+                    new WalkUFTreePP<ChanceTree, BuildPlayerCtKeyIndexContext>();
                 wt.OnNodeBegin = (t, s, d)
                     =>
                     {
                         Int64 n = s[d].NodeIdx;
                         if (d == 0)
                         {
+                            s[d].Rank = 0;
                             return;
                         }
-                        s[d].Cards.Clear();
-                        s[d].Cards.AddRange(s[d - 1].Cards);
                         int round = d - 1; 
                         int card = t.Nodes[n].Card;
-                        s[d].Cards.Add(card);
-                        PlayerCtKeys[p][round][count[round]] = CardsToKey(s[d].Cards);
-                        count[round]++;
+                        s[d].Rank = count[round]++;
+                        if (CppLib.CardKeyIndex_Add(PlayerCtKeyIndex[p], PackCardKey(round, s[d - 1].Rank, card), s[d].Rank) == 0)
+                        {
+                            throw new ApplicationException(String.Format("Duplicate card {0} in player {1} chance tree, node {2}", card, p, n));
+                        }
                     };
                 wt.Walk(PlayerCts[p]);
             }
 
-            class ChanceTreeIndexEntryComparer : IComparer<ChanceTreeIndexEntry>
+            /// <summary>
+            /// Returns the rank of the card path in the player chance tree.
+            /// </summary>
+            /// <param name="parentRank">Rank of the path in the previous round (0 for round 0).</param>
+            public UInt32 FindPlayerCtRank(int p, int round, UInt32 parentRank, int card)
             {
-                public ChanceTreeIndexEntryComparer(int heroPos, int round)
+                UInt32 rank = CppLib.CardKeyIndex_Find(PlayerCtKeyIndex[p], PackCardKey(round, parentRank, card));
+                if (rank == CppLib.CardKeyNotFound)
                 {
-                    _heroPos = heroPos;
-                    // One card per round, each card occupies 1 char.
-                    _playerCardsLength = round + 1;
+                    throw new ApplicationException(String.Format("Card {0} in round {1} is not in player {2} chance tree", card, round, p));
                 }
+                return rank;
+            }
 
-                public int Compare(ChanceTreeIndexEntry x, ChanceTreeIndexEntry y)
+            /// <summary>
+            /// Sorts the chance tree index by the cards of the hero, then by the cards of the opponent.
+            /// </summary>
+            public void SortChanceTreeIndex(int pos)
+            {
+                for (int r = 0; r < RoundsCount; ++r)
                 {
-                    // Sort first by cards of the hero
-                    int startHero = _heroPos * _playerCardsLength;
-                    int r = string.Compare(x.Key, startHero, y.Key, startHero, _playerCardsLength, StringComparison.Ordinal);
-                    if (r != 0)
-                    {
-                        return r;
-                    }
-                    // Sort by the rest of players.
-                    for (int start = 0; start < x.Key.Length; start += _playerCardsLength)
+                    ChanceTreeIndexEntry[] index = ChanceTreeIndex[r];
+                    if (pos != _ctIndexHeroPos)
                     {
-                        if (start == startHero)
+                        // Move the rank of the hero to the high bits.
+                        for (int i = 0; i < index.Length; ++i)
                         {
-                            continue;
-                        }
-                        r = string.Compare(x.Key, start, y.Key, start, _playerCardsLength, StringComparison.Ordinal);
-                        if (r != 0)
-                        {
-                            return r;
+                            index[i].Key = (index[i].Key << 32) | (index[i].Key >> 32);
                         }
                     }
-                    return 0;
+                    fixed (ChanceTreeIndexEntry* pIndex = index)
+                    {
+                        CppLib.ChanceIndex_Sort(pIndex, (UInt32)index.Length, _sortThreadsCount);
+                    }
                 }
-                readonly int _heroPos;
-                readonly int _playerCardsLength;
+                _ctIndexHeroPos = pos;
             }
 
-            public void SortChanceTreeIndex(int pos)
-            {
-                for (int r = 0; r < RoundsCount; ++r)
-                {
-                    Array.Sort(ChanceTreeIndex[r], new ChanceTreeIndexEntryComparer(pos, r));
-                }
-            }
+            /// <summary>
+            /// Position of the player whose rank is in the high bits of the chance tree index keys.
+            /// </summary>
+            int _ctIndexHeroPos = 0;
+
+            int _sortThreadsCount;
             
             public int RoundsCount;
             
@@ -1237,9 +1880,10 @@ namespace ai.pkr.fictpl
             public int[][] PlayerCtNodesCount;
 
             /// <summary>
-            /// For each player, round: an array of card keys for the player chance tree, in pre-order.
+            /// For each player: index of the card paths of the player chance tree (see FindPlayerCtRank()). 
+            /// Is created by LoadCt().
             /// </summary>
-            public string[][][] PlayerCtKeys;
+            public IntPtr[] PlayerCtKeyIndex;
 
 
             /// <summary>
@@ -1270,21 +1914,6 @@ namespace ai.pkr.fictpl
 
         InitData _init;
 
-        static private string CardsToKey(List<int> cards)
-        {
-            StringBuilder sb = new StringBuilder();
-            int cardsLength = cards.Count;
-            for (int i = 0; i < cardsLength; )
-            {
-                char ch = (char)(cards[i++]);
-                sb.Append(ch);
-                /* Old variant used 2 chars per card:
-                sb.AppendFormat("{0:00}", cards[i++]);
-                */
-            }
-            return sb.ToString();
-        }
-
         static string GetSnapshotHeaderFileName()
         {
             return string.Format("header.txt");
@@ -1309,12 +1938,41 @@ namespace ai.pkr.fictpl
             }
             LoadSnapshot();
 
+            if (IsDistributed)
+            {
+                InitializeCoordinator(isNewSnapshot);
+            }
+            else
+            {
+                _shard = new Shard(_init, 0, 1);
+                CreateDataStructures(isNewSnapshot);
+            }
+
+            // Clean-up
+            _init = null;
+            double time = (DateTime.Now - startTime).TotalSeconds;
+            if (IsVerbose)
+            {
+                Console.WriteLine("Initialization done in {0:0.0} s", time);
+            }
+        }
+
+        /// <summary>
+        /// Creates the player trees, the chance data and the action groups for _shard, 
+        /// sets or loads the game values. Requires _init.
+        /// </summary>
+        void CreateDataStructures(bool isNewSnapshot)
+        {
             _playerTrees = new PlayerTree[_playersCount];
             _topTrees = new TopTree[_playersCount].Fill(i => new TopTree());
 #if USE_CHANCE_MASKS
             _chanceMasks = new FastBitArray[_playersCount];
 #endif
+#if USE_SPARSE_CHANCE_FACTORS
+            _chanceFactorStores = new IntPtr[_playersCount];
+#else
             _chanceFactors = new ChanceFactorArray[_playersCount][];
+#endif
             _chanceInfos = new ChanceInfoEntryT[_playersCount][];
             _actionGroups = new ActionGroup[_playersCount][];
 
@@ -1342,6 +2000,10 @@ namespace ai.pkr.fictpl
             {
                 CreateSkipChildIndexes(p);
                 CreateActionGroups(p);
+                if (_shard.Count > 1)
+                {
+                    RemoveForeignTopTreeNodes(p);
+                }
             }
 
 
@@ -1385,13 +2047,32 @@ namespace ai.pkr.fictpl
                 }
             }
 
+            InitializePerfCounters();
 
-            // Clean-up
-            _init = null;
-            double time = (DateTime.Now - startTime).TotalSeconds;
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                _topTrees[p].IsPerfCountersOn = IsPerfCountersOn;
+                _topTrees[p].Split(this, p, _threadPool == null ? 1 : ThreadsCount * JobsPerThread);
+                if (IsVerbose)
+                {
+                    Console.WriteLine("Top tree pos {0}: nodes: {1}, jobs: {2}", p, _topTrees[p].Nodes.Count,
+                                      _topTrees[p].AllNodes.Count);
+                }
+            }
+        }
+
+        private void InitializePerfCounters()
+        {
+            if (!IsPerfCountersOn)
+            {
+                return;
+            }
+            bool isHwAvailable = CppLib.PerfCounters_Enable(1) != 0;
+            CppLib.PerfCounters_Reset();
             if (IsVerbose)
             {
-                Console.WriteLine("Initialization done in {0:0.0} s", time);
+                Console.WriteLine("Performance counters are on, hardware counters are {0}",
+                    isHwAvailable ? "available" : "not available (time only)");
             }
         }
 
@@ -1421,11 +2102,17 @@ namespace ai.pkr.fictpl
                             agTotalSize += _actionGroups[p][i].GameValuesLength;
                         }
                     }
-                    int cfCount = 0;
+                    Int64 cfCount = 0;
+#if USE_SPARSE_CHANCE_FACTORS
+                    CppLib.ChanceFactorStoreInfo cfInfo;
+                    CppLib.ChanceFactorStore_GetInfo(_chanceFactorStores[p], out cfInfo);
+                    cfCount = (Int64)cfInfo.NonZeroCount * (int)CfKind._Count;
+#else
                     for (int i = 0; i < (int)CfKind._Count; ++i)
                     {
-                        cfCount += (int)_chanceFactors[p][i].Length;
+                        cfCount += _chanceFactors[p][i].Length;
                     }
+#endif
                     uint chanceMasksCount = 0;
 #if USE_CHANCE_MASKS
                     chanceMasksCount = _chanceMasks[p].Length;
@@ -1439,6 +2126,13 @@ namespace ai.pkr.fictpl
                                       cfCount);
                     Console.WriteLine("Action groups: count: {0:#,#}, total leaves: {1:#,#}", agCount, agTotalSize);
                     Console.WriteLine("Chance factors order: min: {0}, max: {1}", _minCfOrder, _maxCfOrder);
+#if USE_SPARSE_CHANCE_FACTORS
+                    Console.WriteLine("Chance factor rows: {0:#,0}, sparse: {1:#,0}, fill: {2:0.0}%, memory: {3:#,0} bytes, dense: {4:#,0} bytes, saved: {5:0.0}%",
+                                      cfInfo.RowsCount, cfInfo.SparseRowsCount,
+                                      100.0 * cfInfo.NonZeroCount / Math.Max(cfInfo.ColumnsCount, 1),
+                                      cfInfo.ByteSize, cfInfo.DenseByteSize,
+                                      100.0 * (1 - (double)cfInfo.ByteSize / Math.Max(cfInfo.DenseByteSize, 1)));
+#endif
                 }
             }
         }
@@ -1500,7 +2194,7 @@ namespace ai.pkr.fictpl
                                          if (d == _playersCount + 1)
                                          {
                                              // Set up the top tree. Do it at the end when the node is initialized
-                                             TopTreeNode ttn = new TopTreeNode(this, heroPos, n);
+                                             TopTreeNode ttn = new TopTreeNode(this, heroPos, n, null);
                                              _topTrees[heroPos].Nodes.Add(ttn);
                                          }
                                      };
@@ -1557,7 +2251,10 @@ namespace ai.pkr.fictpl
 
         class CreateChanceInfoContext : WalkUFTreePPContext
         {
-            public List<int> HeroCards = new List<int>();
+            /// <summary>
+            /// Rank of the card path of the hero in the player chance tree.
+            /// </summary>
+            public UInt32 HeroRank;
             public int Round = -1;
         }
 
@@ -1575,7 +2272,11 @@ namespace ai.pkr.fictpl
             if (EqualCa && heroPos > 0)
             {
                 // Copy chance data from pos 0 to hero position.
+#if USE_SPARSE_CHANCE_FACTORS
+                _chanceFactorStores[heroPos] = _chanceFactorStores[0];
+#else
                 _chanceFactors[heroPos] = _chanceFactors[0];
+#endif
                 _chanceInfos[heroPos] = _chanceInfos[0];
 #if USE_CHANCE_MASKS
                 _chanceMasks[heroPos] = _chanceMasks[0];
@@ -1600,9 +2301,23 @@ namespace ai.pkr.fictpl
 #if USE_CHANCE_MASKS
             _chanceMasks[heroPos] = new FastBitArray(_init.ChanceMasksCount[heroPos]);
 #endif
+#if USE_SPARSE_CHANCE_FACTORS
+            _chanceFactorStores[heroPos] = CppLib.ChanceFactorStore_Create((int)CfKind._Count, MaxSparseChanceFactorFill);
+            // The factors of a chance info are collected in a row and then added to the store.
+            int maxRowLength = 0;
+            for (int r = 0; r < _init.RoundsCount; ++r)
+            {
+                maxRowLength = Math.Max(maxRowLength, _shard.Length[1 - heroPos][r]);
+            }
+            ChanceFactorArray[] cf = new ChanceFactorArray[(int)CfKind._Count];
+            cf[(int)CfKind.NoSd].Allocate((uint)maxRowLength);
+            cf[(int)CfKind.Sd].Allocate((uint)maxRowLength);
+#else
             _chanceFactors[heroPos] = new ChanceFactorArray[(int)CfKind._Count];
             _chanceFactors[heroPos][(int)CfKind.NoSd].Allocate(_init.ChanceFactorsCount[heroPos]);
             _chanceFactors[heroPos][(int)CfKind.Sd].Allocate(_init.ChanceFactorsCount[heroPos]);
+            ChanceFactorArray[] cf = _chanceFactors[heroPos];
+#endif
 
 
             int[] heroPlayerCtKeyIdx = new int[_init.RoundsCount];
@@ -1612,7 +2327,12 @@ namespace ai.pkr.fictpl
             UInt32 chanceInfoIdx = 0;
             UInt32 [] ctIndexIdx = new UInt32[_init.RoundsCount];
 
-            Dictionary<string, UInt32> heroKeyToChanceId = new Dictionary<string, uint>(new CardKeyComparer());
+            // For each round, rank of the hero card path -> chance id.
+            UInt32[][] heroRankToChanceId = new UInt32[_init.RoundsCount][];
+            for (int r = 0; r < _init.RoundsCount; ++r)
+            {
+                heroRankToChanceId[r] = new UInt32[_init.PlayerCtNodesCount[heroPos][r]].Fill(UInt32.MaxValue);
+            }
             double[] potShares = new double[_playersCount];
 
             int[] chanceInfoInRoundCount = new int[_init.RoundsCount];
@@ -1625,8 +2345,7 @@ namespace ai.pkr.fictpl
                      return;
                  }
                  s[d].Round = s[d - 1].Round;
-                 s[d].HeroCards.Clear();
-                 s[d].HeroCards.AddRange(s[d - 1].HeroCards);
+                 s[d].HeroRank = s[d - 1].HeroRank;
                  byte pos = t.Nodes[n].Position;
                  if (pos == _playersCount)
                  {
@@ -1635,11 +2354,11 @@ namespace ai.pkr.fictpl
                      int round = s[d].Round;
                      // Do some verification
                      int card = (int)t.Nodes[n].ChanceId;
-                     s[d].HeroCards.Add(card);
-                     string heroKey = CardsToKey(s[d].HeroCards);
+                     UInt32 heroRank = _init.FindPlayerCtRank(heroPos, round, s[d - 1].HeroRank, card);
+                     s[d].HeroRank = heroRank;
 
-                     UInt32 chanceId;
-                     if (heroKeyToChanceId.TryGetValue(heroKey, out chanceId))
+                     UInt32 chanceId = heroRankToChanceId[round][heroRank];
+                     if (chanceId != UInt32.MaxValue)
                      {
                          // This chance info is already created.
                          t.Nodes[n].ChanceId = chanceId;
@@ -1647,11 +2366,15 @@ namespace ai.pkr.fictpl
                      else
                      {
                          // Create new chance info entry.
+#if USE_SPARSE_CHANCE_FACTORS
+                         chanceFactorIdx = 0;
+#endif
                          _chanceInfos[heroPos][chanceInfoIdx].ChanceFactorIdx = chanceFactorIdx;
                          _chanceInfos[heroPos][chanceInfoIdx].ChanceMaskIdx = chanceMaskIdx;
-                         _chanceInfos[heroPos][chanceInfoIdx].IdInActionGroup = chanceInfoInRoundCount[round];
+                         _chanceInfos[heroPos][chanceInfoIdx].IdInActionGroup = 
+                             chanceInfoInRoundCount[round] - _shard.Begin[heroPos][round];
                          chanceInfoInRoundCount[round]++;
-                         heroKeyToChanceId.Add(heroKey, chanceInfoIdx);
+                         heroRankToChanceId[round][heroRank] = chanceInfoIdx;
                          t.Nodes[n].ChanceId = chanceInfoIdx++;
 
                          //if (InitData.CardToString[card] != heroKey.Substring(heroKey.Length - 2))
@@ -1660,17 +2383,27 @@ namespace ai.pkr.fictpl
                          //}
 
                          // Iterate through all card combinations of opponents
-                         // For each combination generate a key consisting of the hero key and opponent keys.
+                         // For each combination generate a key consisting of the hero rank and opponent rank.
                          // The order of these keys corresponds to the order in the chance index.
                          // Therefore we can make a single comparison to find out if the chance index
                          // contains this combination.
                          ChanceTreeIndexEntry[] ctIndex = _init.ChanceTreeIndex[round];
                          // Note: only 2 players are supported.
-                         foreach (string oppKey in _init.PlayerCtKeys[1 - heroPos][round])
+                         UInt32 oppRanksCount = (UInt32)_init.PlayerCtNodesCount[1 - heroPos][round];
+                         // Only the opponent ranks of the shard are stored.
+                         UInt32 shardBegin = (UInt32)_shard.Begin[1 - heroPos][round];
+                         UInt32 shardEnd = shardBegin + (UInt32)_shard.Length[1 - heroPos][round];
+                         for (UInt32 oppRank = 0; oppRank < oppRanksCount; ++oppRank)
                          {
-                             string key = CombineKey(heroKey, oppKey, heroPos);
+                             UInt64 key = ((UInt64)heroRank << 32) | oppRank;
+                             bool isInShard = oppRank >= shardBegin && oppRank < shardEnd;
                              if (ctIndexIdx[round] < ctIndex.Length && ctIndex[ctIndexIdx[round]].Key == key)
                              {
+                                 if (!isInShard)
+                                 {
+                                     ctIndexIdx[round]++;
+                                     continue;
+                                 }
                                  // Opponent can have this combination of cards
 #if USE_CHANCE_MASKS
                                  _chanceMasks[heroPos].Set(chanceMaskIdx, true);
@@ -1680,7 +2413,7 @@ namespace ai.pkr.fictpl
                                  double chanceProbab = chanceTreeNode.Probab;
                                  // non-showdown
                                  UpdateCfOrders(chanceProbab);
-                                 _chanceFactors[heroPos][(int)CfKind.NoSd].Data[chanceFactorIdx] = (ChanceValueT)chanceProbab; 
+                                 cf[(int)CfKind.NoSd].Data[chanceFactorIdx] = (ChanceValueT)chanceProbab; 
                                  // showdown - only for last round, othewise set to 0. This is not a big overhead,
                                  // because the most of the chance factros are in the last round.
                                  double sdcf = 0;
@@ -1692,24 +2425,27 @@ namespace ai.pkr.fictpl
                                      sdcf = (ChanceValueT) (chanceProbab*(2*potShares[1 - heroPos] - 1));
                                  }
                                  UpdateCfOrders(sdcf);
-                                 _chanceFactors[heroPos][(int)CfKind.Sd].Data[chanceFactorIdx] = (ChanceValueT)sdcf;
+                                 cf[(int)CfKind.Sd].Data[chanceFactorIdx] = (ChanceValueT)sdcf;
                                  chanceFactorIdx++;
                                  // Go to the next combination
                                  ctIndexIdx[round]++;
                              }
-                             else
+                             else if (isInShard)
                              {
 #if USE_CHANCE_MASKS
                                  // Opponent can not have this combination of cards
                                  _chanceMasks[heroPos].Set(chanceMaskIdx, false);
                                  chanceMaskIdx++;
 #else
-                                 _chanceFactors[heroPos][(int)CfKind.NoSd].Data[chanceFactorIdx] = 0;
-                                 _chanceFactors[heroPos][(int)CfKind.Sd].Data[chanceFactorIdx] = 0;
+                                 cf[(int)CfKind.NoSd].Data[chanceFactorIdx] = 0;
+                                 cf[(int)CfKind.Sd].Data[chanceFactorIdx] = 0;
                                  chanceFactorIdx++;
 #endif
                              }
                          }
+#if USE_SPARSE_CHANCE_FACTORS
+                         _chanceInfos[heroPos][t.Nodes[n].ChanceId].ChanceFactorIdx = AddChanceFactorRow(heroPos, cf, chanceFactorIdx);
+#endif
                          chanceFactorIdx = (chanceFactorIdx + 3) & (~0x3U); // 4-blocks alignment for SSE commands in cpp lib
                          //heroPlayerCtKeyIdx[round]++;
                      }
@@ -1719,11 +2455,29 @@ namespace ai.pkr.fictpl
 #if USE_CHANCE_MASKS
             Debug.Assert(chanceMaskIdx == _chanceMasks[heroPos].Length);
 #endif
+#if USE_SPARSE_CHANCE_FACTORS
+            cf[(int)CfKind.NoSd].Free();
+            cf[(int)CfKind.Sd].Free();
+            CppLib.ChanceFactorStore_Compact(_chanceFactorStores[heroPos]);
+#else
             Debug.Assert(chanceFactorIdx == _chanceFactors[heroPos][(int)CfKind.NoSd].Length);
             Debug.Assert(chanceFactorIdx == _chanceFactors[heroPos][(int)CfKind.Sd].Length);
+#endif
             Debug.Assert(chanceInfoIdx == _chanceInfos[heroPos].Length);
         }
 
+#if USE_SPARSE_CHANCE_FACTORS
+        private UInt32 AddChanceFactorRow(int heroPos, ChanceFactorArray[] cf, UInt32 count)
+        {
+            ChanceValueT** values = stackalloc ChanceValueT*[(int)CfKind._Count];
+            for (int k = 0; k < (int)CfKind._Count; ++k)
+            {
+                values[k] = cf[k].Data;
+            }
+            return CppLib.ChanceFactorStore_AddRow(_chanceFactorStores[heroPos], values, count);
+        }
+#endif
+
         private void UpdateCfOrders(double chanceFactor)
         {
             double a = Math.Abs(chanceFactor);
@@ -1736,27 +2490,6 @@ namespace ai.pkr.fictpl
             _maxCfOrder = Math.Max(_maxCfOrder, log);
         }
 
-        /// <summary>
-        /// Use a special comparer for keys. It uses ordinal comparison
-        /// and a fast hashing function.
-        /// </summary>
-        class CardKeyComparer : IEqualityComparer<string>
-        {
-            #region IEqualityComparer<string> Members
-
-            public bool Equals(string x, string y)
-            {
-                return StringComparer.Ordinal.Equals(x, y);
-            }
-
-            public int GetHashCode(string s)
-            {
-                return StringHashCode.Get(s);
-            }
-
-
-            #endregion
-        }
 
         class CreateActionGroupsContext : WalkUFTreePPContext
         {
@@ -1817,7 +2550,8 @@ namespace ai.pkr.fictpl
                         chanceInfoKind = CfKind.Sd;
                     }
                     int round = t.Nodes[n].Round;
-                    _actionGroups[heroPos][n].Allocate(_init.PlayerCtNodesCount[heroPos][round]);
+                    _actionGroups[heroPos][n].Allocate(_shard.Length[heroPos][round]);
+                    _actionGroups[heroPos][n].Round = round;
                     //_actionGroups[heroPos][n].Leaves = new uint[_init.PlayerCtNodesCount[heroPos][round]];
                     _actionGroups[heroPos][n].PotFactor = potFactor;
                     _actionGroups[heroPos][n].ChanceInfoKind = chanceInfoKind;
@@ -1827,6 +2561,21 @@ namespace ai.pkr.fictpl
         }
 
 
+        /// <summary>
+        /// Removes the top tree nodes with the deals of other shards.
+        /// </summary>
+        void RemoveForeignTopTreeNodes(int heroPos)
+        {
+            PlayerTree pt = _playerTrees[heroPos];
+            ChanceInfoEntryT[] chanceInfos = _chanceInfos[heroPos];
+            int length = _shard.Length[heroPos][0];
+            _topTrees[heroPos].Nodes.RemoveAll(n =>
+                                                   {
+                                                       int id = chanceInfos[pt.Nodes[n.RootNode].ChanceId].IdInActionGroup;
+                                                       return id < 0 || id >= length;
+                                                   });
+        }
+
         private const UInt32 SV_VARLESS = 0xFFFFFFFF;
         private const UInt32 SV_ZERO_MASK = 0x10000000;
 
@@ -1965,16 +2714,21 @@ namespace ai.pkr.fictpl
             int oppPos = 1 - heroPos;
             ActionGroup[] oppAg = _actionGroups[oppPos];
             UInt32 cfIdx = _chanceInfos[heroPos][chIdx].ChanceFactorIdx;
-#if USE_CHANCE_MASKS
-            UInt32 cmIdx = _chanceInfos[heroPos][chIdx].ChanceMaskIdx;
-            FastBitArray cm = _chanceMasks[heroPos];
-#endif
-            ChanceValueT * cf = _chanceFactors[heroPos][(int)oppAg[actIdx].ChanceInfoKind].Data;
-            PlayerTree oppTree = _playerTrees[oppPos];
             double * gameValues = oppAg[actIdx].GameValues;
 
             double almostZero = 1e-50*absProbabForAlmostZero;
 
+#if USE_SPARSE_CHANCE_FACTORS
+            // Like the loop below (see there for almostZero), zero factors do not change the game values.
+            CppLib.ChanceFactorStore_IncrementGameValueScaled(_chanceFactorStores[heroPos], 
+                (int)oppAg[actIdx].ChanceInfoKind, cfIdx, gameValues, strVar != 0 ? strVar : almostZero);
+#else
+#if USE_CHANCE_MASKS
+            UInt32 cmIdx = _chanceInfos[heroPos][chIdx].ChanceMaskIdx;
+            FastBitArray cm = _chanceMasks[heroPos];
+#endif
+            ChanceValueT * cf = _chanceFactors[heroPos][(int)oppAg[actIdx].ChanceInfoKind].Data;
+
             for (UInt32 i = 0; i < oppAg[actIdx].GameValuesLength; ++i)
             {
 #if USE_CHANCE_MASKS
@@ -2003,18 +2757,10 @@ namespace ai.pkr.fictpl
                     gameValues[i] += gameValue;
                 }
             }
+#endif
         }
 
 
-        private string CombineKey(string heroKey, string oppKey, int heroPos)
-        {
-            // Note: only 2 players are supported.
-            if (heroPos == 0)
-            {
-                return heroKey + oppKey;
-            }
-            return oppKey + heroKey;
-        }
 
 
         /// <summary>
@@ -2104,6 +2850,7 @@ namespace ai.pkr.fictpl
         private void DoIterations()
         {
             DateTime start = DateTime.Now;
+            _lastSnapshotTime = start;
 
             // Start from the player with minimal iteration count, if equal, start from 0.
             int minIterCount = int.MaxValue;
@@ -2154,6 +2901,18 @@ namespace ai.pkr.fictpl
                 {
                     break;
                 }
+
+                if (SnapshotPeriod > 0 && (DateTime.Now - _lastSnapshotTime).TotalSeconds >= SnapshotPeriod)
+                {
+                    if (IsDistributed)
+                    {
+                        SaveIntermediateSnapshotDistributed();
+                    }
+                    else
+                    {
+                        SaveSnapshotAsync();
+                    }
+                }
             }
 
             if (IsVerbose)
@@ -2190,11 +2949,25 @@ namespace ai.pkr.fictpl
 
         private void BestResponse()
         {
+            if (IsDistributed)
+            {
+                BestResponseDistributed();
+                return;
+            }
             DateTime time1 = DateTime.Now;
             BestResponseValuesUp();
             DateTime time2 = DateTime.Now;
             _timeInBrValuesUp += (time2 - time1).TotalSeconds;
-            BestResponseFinalize();
+            if (IsPerfCountersOn)
+            {
+                CppLib.PerfCounters_Begin((int)PerfPhase.Finalize);
+                BestResponseFinalize();
+                CppLib.PerfCounters_End((int)PerfPhase.Finalize);
+            }
+            else
+            {
+                BestResponseFinalize();
+            }
             _timeInBrFinalize += (DateTime.Now - time2).TotalSeconds;
 
             if (TraceDir != null)
@@ -2205,22 +2978,7 @@ namespace ai.pkr.fictpl
 
         void BestResponseValuesUp()
         {
-            TopTree topTree = _topTrees[_heroPos];
-            if (_threadPool == null)
-            {
-                for(int i = 0; i < topTree.Nodes.Count; ++i)
-                {
-                    topTree.Nodes[i].Job.Do();
-                }
-            }
-            else
-            {
-                for (int i = 0; i < topTree.Nodes.Count; ++i)
-                {
-                    _threadPool.QueueJob(topTree.Nodes[i].Job, i % _threadPool.ThreadsCount);
-                }
-                _threadPool.WaitAllJobs();
-            }
+            _topTrees[_heroPos].Execute(_threadPool);
             LastSbrValues[_heroPos] = _topTrees[_heroPos].SumAndClearValues();
         }
 
@@ -2249,7 +3007,23 @@ namespace ai.pkr.fictpl
 
         void BestResponseFinalize()
         {
-            WalkTreeWithSkipChildren(_playerTrees[_heroPos], (uint)_playersCount);
+            PlayerTree tree = _playerTrees[_heroPos];
+            if (_shard.Count == 1)
+            {
+                WalkTreeWithSkipChildren(tree, (uint)_playersCount);
+            }
+            else
+            {
+                // The same as above, but only for the deals of the shard.
+                if (tree.Nodes[_playersCount].Position == _heroPos)
+                {
+                    tree.Nodes[_playersCount].StrVar++;
+                }
+                foreach (TopTreeNode node in _topTrees[_heroPos].Nodes)
+                {
+                    WalkTreeWithSkipChildren(tree, (UInt32)node.RootNode);
+                }
+            }
             if (_threadPool != null)
             {
                 _threadPool.WaitAllJobs();
@@ -2305,7 +3079,15 @@ namespace ai.pkr.fictpl
             {
                 // This leaf belongs to BR (otherwise we would have skipped it).
                 _finalBrLeavesCount++;
-                QueueIncrementGameValueJob(_brfStack[d].ChanceId, pNode->AtIdx);
+                if (_workList != null)
+                {
+                    // Send to the coordinator, it will be applied by all workers.
+                    _workList.Add(_brfStack[d].ChanceId, pNode->AtIdx);
+                }
+                else
+                {
+                    QueueIncrementGameValueJob(_brfStack[d].ChanceId, pNode->AtIdx);
+                }
             }
         }
 
@@ -2345,8 +3127,16 @@ namespace ai.pkr.fictpl
             int gvCount = oppAg[actIdx].GameValuesLength;
 
             UInt32 cfIdx = _chanceInfos[_heroPos][chIdx].ChanceFactorIdx;
-            ChanceValueT* pCf = _chanceFactors[_heroPos][(int)oppAg[actIdx].ChanceInfoKind].Data + cfIdx;
             double* pGameValues = oppAg[actIdx].GameValues;
+            if (IsPerfCountersOn)
+            {
+                CppLib.PerfCounters_Begin((int)PerfPhase.GameValue);
+            }
+#if USE_SPARSE_CHANCE_FACTORS
+            CppLib.ChanceFactorStore_IncrementGameValue(_chanceFactorStores[_heroPos], (int)oppAg[actIdx].ChanceInfoKind, 
+                cfIdx, pGameValues);
+#else
+            ChanceValueT* pCf = _chanceFactors[_heroPos][(int)oppAg[actIdx].ChanceInfoKind].Data + cfIdx;
 #if USE_CPP_LIB
 #if USE_CHANCE_MASKS
             fixed(UInt32 * pChanceMaskBits = &(cm.Bits[0]))
@@ -2378,7 +3168,11 @@ namespace ai.pkr.fictpl
 #endif
             }
 #endif
-
+#endif
+            if (IsPerfCountersOn)
+            {
+                CppLib.PerfCounters_End((int)PerfPhase.GameValue);
+            }
         }
 
         private void UpdateEpsilonLog()
@@ -2426,20 +3220,65 @@ namespace ai.pkr.fictpl
             }
             output.Write("; time in BR: v-up: {0:0.0} s, fin: {1:0.0} s", _timeInBrValuesUp, _timeInBrFinalize);
             output.Write("; fin BR leaves: {0:#,#}K", _finalBrLeavesCount * 1e-3);
+            if (IsDistributed)
+            {
+                output.Write("; workers: {0}", Workers.Length);
+            }
+            if (_intermediateSnapshotsCount > 0)
+            {
+                output.Write("; snapshots: {0}, stall: last: {1:0.000} s, total: {2:0.0} s", 
+                    _intermediateSnapshotsCount, _lastSnapshotStall, _totalSnapshotStall);
+            }
+            if (IsPerfCountersOn)
+            {
+                PrintPerfCounters(output);
+            }
+            if (_threadPool != null)
+            {
+                // Utilization of the workers in the last v-up.
+                TopTree topTree = _topTrees[_heroPos];
+                output.Write("; v-up idle, ms:");
+                for (int w = 0; w < topTree.WorkerBusyTime.Length; ++w)
+                {
+                    output.Write(" {0}:{1:0.0}", w, (topTree.ExecutionTime - topTree.WorkerBusyTime[w]) * 1000);
+                }
+            }
             output.WriteLine();
         }
 
+        private void PrintPerfCounters(TextWriter output)
+        {
+            output.Write("; perf:");
+            for (int p = 0; p < (int)PerfPhase._Count; ++p)
+            {
+                CppLib.PerfPhaseCounters c;
+                CppLib.PerfCounters_Get(p, out c);
+                output.Write("{0} {1}: {2:#,0}x {3:0.0} s", p == 0 ? "" : ",", PerfPhaseNames[p], c.Count, c.TimeNs * 1e-9);
+                if (c.Cycles > 0)
+                {
+                    output.Write(" {0:0.0} Gcyc IPC {1:0.00} LLC miss {2:0.0}M {3:0.00} GB/s",
+                        c.Cycles * 1e-9, (double)c.Instructions / c.Cycles, c.LlcMisses * 1e-6,
+                        c.LlcMisses * 64.0 / Math.Max(1, c.TimeNs));
+                }
+            }
+        }
+
         #endregion
 
         #region Implementation - other
 
         void CleanUp()
         {
+            if (IsPerfCountersOn)
+            {
+                CppLib.PerfCounters_Enable(0);
+            }
             if (_threadPool != null)
             {
                 _threadPool.Dispose();
                 _threadPool = null;
             }
+            DisconnectWorkers();
         }
 
         private void FreeActionGroupsAndChanceFactors()
@@ -2450,11 +3289,50 @@ namespace ai.pkr.fictpl
                 {
                     _actionGroups[p][g].Free();
                 }
+#if !USE_SPARSE_CHANCE_FACTORS
                 for (int c = 0; c < _chanceFactors[p].Length; ++c)
                 {
                     _chanceFactors[p][c].Free();
                 }
+#endif
+            }
+#if USE_SPARSE_CHANCE_FACTORS
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                // With EqualCa all positions share the store of position 0.
+                if (_chanceFactorStores[p] != IntPtr.Zero && (p == 0 || _chanceFactorStores[p] != _chanceFactorStores[0]))
+                {
+                    CppLib.ChanceFactorStore_Destroy(_chanceFactorStores[p]);
+                }
+            }
+            Array.Clear(_chanceFactorStores, 0, _chanceFactorStores.Length);
+#endif
+        }
+
+        /// <summary>
+        /// Returns the memory used by the chance factors of all players.
+        /// </summary>
+        private Int64 GetChanceFactorsByteSize()
+        {
+            Int64 byteSize = 0;
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                if (EqualCa && p > 0)
+                {
+                    continue;
+                }
+#if USE_SPARSE_CHANCE_FACTORS
+                CppLib.ChanceFactorStoreInfo info;
+                CppLib.ChanceFactorStore_GetInfo(_chanceFactorStores[p], out info);
+                byteSize += (Int64)info.ByteSize;
+#else
+                for (int c = 0; c < _chanceFactors[p].Length; ++c)
+                {
+                    byteSize += (Int64)_chanceFactors[p][c].Length * sizeof(ChanceValueT);
+                }
+#endif
             }
+            return byteSize;
         }
 
         private void WriteEpsilonLog(TextWriter tw)
@@ -2482,8 +3360,16 @@ namespace ai.pkr.fictpl
             {
                 Console.WriteLine("Saving game values for pos {0}", heroPos);
             }
-            using (BinaryWriter bw = new BinaryWriter(File.Open(_curSnapshotInfo.GameValuesFile[heroPos],
-                FileMode.Create, FileAccess.Write)))
+            WriteGameValues(_curSnapshotInfo.GameValuesFile[heroPos], heroPos, null);
+        }
+
+        /// <summary>
+        /// Writes the game values of the action groups or, if frozenGameValues is not null, 
+        /// their copy made by FreezeSnapshot().
+        /// </summary>
+        private void WriteGameValues(string fileName, int heroPos, double * frozenGameValues)
+        {
+            using (BinaryWriter bw = new BinaryWriter(File.Open(fileName, FileMode.Create, FileAccess.Write)))
             {
                 for(int i = 0; i < _actionGroups[heroPos].Length; ++i)
                 {
@@ -2492,6 +3378,11 @@ namespace ai.pkr.fictpl
                     bw.Write(length);
                     if (gameValues != null)
                     {
+                        if (frozenGameValues != null)
+                        {
+                            gameValues = frozenGameValues;
+                            frozenGameValues += length;
+                        }
                         UnmanagedMemory.Write(bw, new IntPtr(gameValues), length*sizeof (double));
                     }
                 }
@@ -2513,14 +3404,25 @@ namespace ai.pkr.fictpl
                     double* gameValues = _actionGroups[heroPos][i].GameValues;
                     int actLength = _actionGroups[heroPos][i].GameValuesLength;
                     int length = br.ReadInt32();
-                    if (length != actLength)
+                    if (gameValues == null)
                     {
-                        throw new ApplicationException("Wrong action group length");
+                        if (length != 0)
+                        {
+                            throw new ApplicationException("Wrong action group length");
+                        }
+                        continue;
                     }
-                    if (gameValues != null)
+                    // Read the part of the shard, the file contains all game values.
+                    int round = _actionGroups[heroPos][i].Round;
+                    if (length != _shard.FullLength[heroPos][round] || actLength != _shard.Length[heroPos][round])
                     {
-                        UnmanagedMemory.Read(br, new IntPtr(gameValues), length * sizeof(double));
+                        throw new ApplicationException("Wrong action group length");
                     }
+                    Int64 skipBefore = (Int64)_shard.Begin[heroPos][round] * sizeof(double);
+                    Int64 skipAfter = (Int64)(length - actLength) * sizeof(double) - skipBefore;
+                    br.BaseStream.Seek(skipBefore, SeekOrigin.Current);
+                    UnmanagedMemory.Read(br, new IntPtr(gameValues), actLength * sizeof(double));
+                    br.BaseStream.Seek(skipAfter, SeekOrigin.Current);
                 }
             }
         }
@@ -2532,12 +3434,21 @@ namespace ai.pkr.fictpl
         }
 
         private void SaveStrategies()
+        {
+            WriteStrategies(_curSnapshotInfo, null, null);
+        }
+
+        /// <summary>
+        /// Writes the strategies of the player trees or, if strVars is not null, 
+        /// the strategic variables frozen by FreezeSnapshot().
+        /// </summary>
+        private void WriteStrategies(SnapshotInfo snapshotInfo, UInt32[][] strVars, int[] iterationCounts)
         {
             StrategyTree st = null;
 
             for (int pos = 0; pos < _playersCount; ++pos)
             {
-                if (IsVerbose)
+                if (IsVerbose && strVars == null)
                 {
                     Console.WriteLine("Save strategy for pos {0}", pos);
                 }
@@ -2552,39 +3463,197 @@ namespace ai.pkr.fictpl
                                          Int64 n = s[d].NodeIdx;
                                          if (t.Nodes[n].IsPlayerAction(pos))
                                          {
-                                             t.Nodes[n].Probab = _playerTrees[pos].Nodes[n].GetStrVar(this);
+                                             if (strVars == null)
+                                             {
+                                                 t.Nodes[n].Probab = _playerTrees[pos].Nodes[n].GetStrVar(this);
+                                             }
+                                             else
+                                             {
+                                                 t.Nodes[n].Probab = iterationCounts[pos] == 0
+                                                     ? 0 : (double)strVars[pos][n] / iterationCounts[pos];
+                                             }
                                          }
                                      };
                 wt.Walk(st);
                 if (!EqualCa)
                 {
-                    st.Write(_curSnapshotInfo.StrategyFile[pos]);
+                    st.Write(snapshotInfo.StrategyFile[pos]);
+                    st.Dispose();
                 }
             }
             if (EqualCa)
             {
-                st.Write(_curSnapshotInfo.StrategyFile[0]);
+                st.Write(snapshotInfo.StrategyFile[0]);
+                st.Dispose();
             }
         }
 
         void SaveSnapshotAuxData()
         {
-            using (TextWriter tw = new StreamWriter(_curSnapshotInfo.HeaderFile))
+            WriteSnapshotAuxData(_curSnapshotInfo, GetSnapshotAuxData());
+        }
+
+        /// <summary>
+        /// Contents of the text files of a snapshot.
+        /// </summary>
+        class SnapshotAuxData
+        {
+            public string Header;
+            public string EpsilonLog;
+            public string Info;
+        }
+
+        SnapshotAuxData GetSnapshotAuxData()
+        {
+            SnapshotAuxData data = new SnapshotAuxData();
+            using (StringWriter tw = new StringWriter())
             {
                 for (int pos = 0; pos < _playersCount; ++pos)
                 {
                     tw.WriteLine("{0}", IterationCounts[pos]);
                 }
+                data.Header = tw.ToString();
             }
 
-            using (TextWriter tw = new StreamWriter(_curSnapshotInfo.EpsilonLog))
+            using (StringWriter tw = new StringWriter())
             {
                 WriteEpsilonLog(tw);
+                data.EpsilonLog = tw.ToString();
             }
 
-            using (TextWriter tw = new StreamWriter(_curSnapshotInfo.InfoFile))
+            using (StringWriter tw = new StringWriter())
             {
                 PrintIterationStatus(tw);
+                data.Info = tw.ToString();
+            }
+            return data;
+        }
+
+        static void WriteSnapshotAuxData(SnapshotInfo snapshotInfo, SnapshotAuxData data)
+        {
+            File.WriteAllText(snapshotInfo.EpsilonLog, data.EpsilonLog);
+            File.WriteAllText(snapshotInfo.InfoFile, data.Info);
+            // Write the header last, SnapshotSwitcher finds the newest snapshot by it.
+            File.WriteAllText(snapshotInfo.HeaderFile, data.Header);
+        }
+
+        /// <summary>
+        /// A copy of the state made by FreezeSnapshot() to write an intermediate snapshot.
+        /// </summary>
+        class FrozenSnapshot
+        {
+            public int[] IterationCounts;
+            /// <summary>
+            /// For each position: StrVar of the nodes of the player tree.
+            /// </summary>
+            public UInt32[][] StrVars;
+            /// <summary>
+            /// For each position: game values of all action groups, one after another.
+            /// </summary>
+            public IntPtr[] GameValues;
+            public SnapshotAuxData AuxData;
+        }
+
+        /// <summary>
+        /// Freezes the current state and writes it to the next snapshot in background.
+        /// The iterations are stalled only for the copying (and for the previous snapshot if it is not written yet).
+        /// </summary>
+        void SaveSnapshotAsync()
+        {
+            long start = Stopwatch.GetTimestamp();
+            // The frozen copy is reused, wait until it is written.
+            _snapshotWriter.Wait();
+            SwitchSnapshot();
+            if (IsVerbose)
+            {
+                Console.WriteLine("Saving snapshot to {0} in background", _curSnapshotInfo.BaseDir);
+            }
+            FreezeSnapshot();
+            SnapshotInfo snapshotInfo = _curSnapshotInfo;
+            _snapshotWriter.Write(() => WriteFrozenSnapshot(snapshotInfo));
+            _lastSnapshotStall = (double)(Stopwatch.GetTimestamp() - start) / Stopwatch.Frequency;
+            _totalSnapshotStall += _lastSnapshotStall;
+            _intermediateSnapshotsCount++;
+            _lastSnapshotTime = DateTime.Now;
+        }
+
+        void FreezeSnapshot()
+        {
+            if (_frozenSnapshot == null)
+            {
+                _frozenSnapshot = new FrozenSnapshot
+                                      {
+                                          StrVars = new UInt32[_playersCount][],
+                                          GameValues = new IntPtr[_playersCount]
+                                      };
+                for (int p = 0; p < _playersCount; ++p)
+                {
+                    _frozenSnapshot.StrVars[p] = new UInt32[_playerTrees[p].NodesCount];
+                    Int64 length = 0;
+                    for (int g = 0; g < _actionGroups[p].Length; ++g)
+                    {
+                        if (_actionGroups[p][g].GameValues != null)
+                        {
+                            length += _actionGroups[p][g].GameValuesLength;
+                        }
+                    }
+                    _frozenSnapshot.GameValues[p] = UnmanagedMemory.AllocHGlobalEx(Math.Max(length, 1) * sizeof(double));
+                }
+            }
+            _frozenSnapshot.IterationCounts = (int[])IterationCounts.Clone();
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                double* dst = (double*)_frozenSnapshot.GameValues[p];
+                for (int g = 0; g < _actionGroups[p].Length; ++g)
+                {
+                    double* src = _actionGroups[p][g].GameValues;
+                    if (src == null)
+                    {
+                        continue;
+                    }
+                    int length = _actionGroups[p][g].GameValuesLength;
+                    for (int i = 0; i < length; ++i)
+                    {
+                        *dst++ = src[i];
+                    }
+                }
+                UInt32[] strVars = _frozenSnapshot.StrVars[p];
+                Node* nodes = _playerTrees[p].Nodes;
+                for (int n = 0; n < strVars.Length; ++n)
+                {
+                    strVars[n] = nodes[n].StrVar;
+                }
+            }
+            _frozenSnapshot.AuxData = GetSnapshotAuxData();
+        }
+
+        /// <summary>
+        /// Is called in the thread of the snapshot writer. 
+        /// Uses only the frozen copy and the data that do not change during iterations.
+        /// </summary>
+        void WriteFrozenSnapshot(SnapshotInfo snapshotInfo)
+        {
+            WriteStrategies(snapshotInfo, _frozenSnapshot.StrVars, _frozenSnapshot.IterationCounts);
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                WriteGameValues(snapshotInfo.GameValuesFile[p], p, (double*)_frozenSnapshot.GameValues[p]);
+            }
+            WriteSnapshotAuxData(snapshotInfo, _frozenSnapshot.AuxData);
+        }
+
+        /// <summary>
+        /// Waits until the intermediate snapshot is written and frees the frozen copy.
+        /// </summary>
+        void WaitIntermediateSnapshot()
+        {
+            _snapshotWriter.Wait();
+            if (_frozenSnapshot != null)
+            {
+                for (int p = 0; p < _playersCount; ++p)
+                {
+                    UnmanagedMemory.FreeHGlobal(_frozenSnapshot.GameValues[p]);
+                }
+                _frozenSnapshot = null;
             }
         }
 
@@ -2647,41 +3716,727 @@ namespace ai.pkr.fictpl
 
         #endregion
 
-        #region Trace
-
-#if DEBUG_PRINT
-        const bool IsDebugPrintOn = true;
-#else
-        const bool IsDebugPrintOn = false;
-#endif
-
-        UInt64 _finalBrLeavesCount;
-
-        double _timeInBrValuesUp = 0;
-        double _timeInBrFinalize = 0;
+        #region Implementation - distributed
 
-        private string GetTraceFileName(int pos, string kind, string substep, string ext)
+        bool IsDistributed
         {
-            string fileName = string.Format("{0}\\{1:00000}-{2}-{3}{4}.{5}",
-                                            TraceDir, IterationCounts[pos], pos,
-                                            kind,
-                                            string.IsNullOrEmpty(substep) ? "" : "-" + substep,
-                                            ext);
-            return fileName;
+            get
+            {
+                return Workers != null && Workers.Length > 0;
+            }
         }
 
-        bool IsIterationVerbose()
+        /// <summary>
+        /// Kinds of the messages between the coordinator and the workers. 
+        /// A message begins with the kind (Int32), followed by the parameters written by BinaryWriter.
+        /// </summary>
+        enum WorkerMessage
         {
-            return IsVerbose &&
-                IterationVerbosity > 0 &&
-                (CurrentIterationCount % IterationVerbosity == 0);
+            /// <summary>
+            /// Coordinator -> worker: the parameters and the shard, see InitializeWorker().
+            /// </summary>
+            Init,
+            /// <summary>
+            /// Worker -> coordinator: initialization done. Int64 bytes of game values, Int64 bytes of chance factors.
+            /// </summary>
+            Ready,
+            /// <summary>
+            /// Coordinator -> worker: do BR of the shard. Int32 hero position.
+            /// </summary>
+            Iterate,
+            /// <summary>
+            /// Worker -> coordinator: a part of the final BR leaves of the shard, see WorkList.
+            /// </summary>
+            WorkList,
+            /// <summary>
+            /// Worker -> coordinator: BR of the shard done. Double SBR value, UInt64 final BR leaves count, 
+            /// Double time in values-up, s, Double time in finalize, s.
+            /// </summary>
+            Result,
+            /// <summary>
+            /// Coordinator -> worker: a work list to update the game values, the same layout as WorkList.
+            /// </summary>
+            Apply,
+            /// <summary>
+            /// Coordinator -> worker: write the game values of the shard. String snapshot directory.
+            /// </summary>
+            Save,
+            /// <summary>
+            /// Worker -> coordinator: game values are written. For each position: Int64 player tree nodes count, 
+            /// Int32 ranges count, for each range of nodes: Int64 begin, Int64 end, UInt32 StrVar of each node.
+            /// </summary>
+            Saved,
+            /// <summary>
+            /// Worker -> coordinator: an error. String text.
+            /// </summary>
+            Error,
+            /// <summary>
+            /// Coordinator -> worker: exit Work().
+            /// </summary>
+            Shutdown
         }
 
-        private void PrintChanceInfo(int pos, string fileName)
+        /// <summary>
+        /// Collects the final BR leaves of the shard as pairs (chance index, action tree index) and sends them
+        /// to the coordinator in batches. Layout: Int32 kind, Int32 pairs count, pairs as UInt32.
+        /// </summary>
+        class WorkList
         {
-            using (TextWriter tw = new StreamWriter(fileName))
+            public const int BATCH_SIZE = 64 * 1024;
+            public const int HEADER_SIZE = 8;
+
+            public WorkList(Connection coordinator)
             {
-                for (int i = 0; i < _chanceInfos[pos].Length; ++i)
+                _coordinator = coordinator;
+            }
+
+            public void Add(UInt32 chIdx, UInt32 actIdx)
+            {
+                _pairs[2 * _count] = chIdx;
+                _pairs[2 * _count + 1] = actIdx;
+                if (++_count == BATCH_SIZE)
+                {
+                    Flush();
+                }
+            }
+
+            public void Flush()
+            {
+                if (_count == 0)
+                {
+                    return;
+                }
+                byte[] message = new byte[HEADER_SIZE + _count * 2 * sizeof(UInt32)];
+                SetMessageKind(message, WorkerMessage.WorkList);
+                Buffer.BlockCopy(BitConverter.GetBytes(_count), 0, message, 4, 4);
+                Buffer.BlockCopy(_pairs, 0, message, HEADER_SIZE, _count * 2 * sizeof(UInt32));
+                _count = 0;
+                if (!_coordinator.Send(message))
+                {
+                    throw new ApplicationException("Coordinator is disconnected");
+                }
+            }
+
+            Connection _coordinator;
+            UInt32[] _pairs = new UInt32[2 * BATCH_SIZE];
+            int _count;
+        }
+
+        /// <summary>
+        /// Maximal time to connect to the workers, s.
+        /// </summary>
+        const double WORKER_CONNECT_TIMEOUT = 60;
+
+        /// <summary>
+        /// Coordinator: connections to the workers.
+        /// </summary>
+        Client[] _workerClients;
+
+        /// <summary>
+        /// Coordinator: for each position, action group: the number of all game values.
+        /// </summary>
+        int[][] _gameValuesLengths;
+
+        /// <summary>
+        /// Worker: connection to the coordinator.
+        /// </summary>
+        Connection _coordinator;
+
+        /// <summary>
+        /// Worker: collects the final BR leaves, null if not a worker.
+        /// </summary>
+        WorkList _workList;
+
+        /// <summary>
+        /// Worker: time spent to queue game value updates since the last Result, s.
+        /// </summary>
+        double _applyTime;
+
+        static byte[] CreateMessage(WorkerMessage kind, Action<BinaryWriter> writeParameters)
+        {
+            using (MemoryStream ms = new MemoryStream())
+            {
+                using (BinaryWriter bw = new BinaryWriter(ms))
+                {
+                    bw.Write((int)kind);
+                    if (writeParameters != null)
+                    {
+                        writeParameters(bw);
+                    }
+                }
+                return ms.ToArray();
+            }
+        }
+
+        static WorkerMessage GetMessageKind(byte[] message)
+        {
+            return (WorkerMessage)BitConverter.ToInt32(message, 0);
+        }
+
+        static void SetMessageKind(byte[] message, WorkerMessage kind)
+        {
+            Buffer.BlockCopy(BitConverter.GetBytes((int)kind), 0, message, 0, 4);
+        }
+
+        /// <summary>
+        /// Checks the kind of the message and returns a reader of its parameters.
+        /// </summary>
+        static BinaryReader ReadMessage(byte[] message, WorkerMessage expectedKind)
+        {
+            BinaryReader br = new BinaryReader(new MemoryStream(message));
+            WorkerMessage kind = (WorkerMessage)br.ReadInt32();
+            if (kind != expectedKind)
+            {
+                throw new ApplicationException(String.Format("Unexpected message {0}, expected {1}", kind, expectedKind));
+            }
+            return br;
+        }
+
+        #region Coordinator
+
+        void ConnectWorkers()
+        {
+            _workerClients = new Client[Workers.Length];
+            for (int w = 0; w < Workers.Length; ++w)
+            {
+                _workerClients[w] = new Client();
+                _workerClients[w].Start(Workers[w]);
+            }
+            DateTime start = DateTime.Now;
+            for (int w = 0; w < Workers.Length; ++w)
+            {
+                for (; ; )
+                {
+                    Client.Event e;
+                    if (_workerClients[w].DequeInputEvent(out e))
+                    {
+                        if (e.Kind == EventKind.Connect)
+                        {
+                            break;
+                        }
+                        continue;
+                    }
+                    int timeLeft = (int)((WORKER_CONNECT_TIMEOUT - (DateTime.Now - start).TotalSeconds) * 1000);
+                    if (timeLeft <= 0 || !_workerClients[w].WaitEvent.WaitOne(timeLeft, false))
+                    {
+                        DisconnectWorkers();
+                        throw new ApplicationException(String.Format("Cannot connect to worker {0}", Workers[w]));
+                    }
+                }
+            }
+            if (IsVerbose)
+            {
+                Console.WriteLine("Connected to {0} workers", Workers.Length);
+            }
+        }
+
+        void DisconnectWorkers()
+        {
+            if (_workerClients == null)
+            {
+                return;
+            }
+            for (int w = 0; w < _workerClients.Length; ++w)
+            {
+                _workerClients[w].Stop();
+            }
+            _workerClients = null;
+        }
+
+        void SendToWorker(int w, byte[] message)
+        {
+            if (!_workerClients[w].Send(message))
+            {
+                string worker = Workers[w];
+                DisconnectWorkers();
+                throw new ApplicationException(String.Format("Cannot send to worker {0}", worker));
+            }
+        }
+
+        void SendToWorkers(byte[] message)
+        {
+            for (int w = 0; w < _workerClients.Length; ++w)
+            {
+                SendToWorker(w, message);
+            }
+        }
+
+        /// <summary>
+        /// Waits for the next message from a worker. Throws an exception if the worker is disconnected 
+        /// or sends an error.
+        /// </summary>
+        byte[] ReceiveFromWorker(int w)
+        {
+            Client client = _workerClients[w];
+            for (; ; )
+            {
+                Client.Event e;
+                if (!client.DequeInputEvent(out e))
+                {
+                    client.WaitEvent.WaitOne();
+                    continue;
+                }
+                string error = null;
+                if (e.Kind == EventKind.Disconnect)
+                {
+                    error = "disconnected";
+                }
+                else if (e.Kind == EventKind.RxMessage)
+                {
+                    if (GetMessageKind(e.Message) != WorkerMessage.Error)
+                    {
+                        return e.Message;
+                    }
+                    error = ReadMessage(e.Message, WorkerMessage.Error).ReadString();
+                }
+                if (error != null)
+                {
+                    string worker = Workers[w];
+                    DisconnectWorkers();
+                    throw new ApplicationException(String.Format("Worker {0}: {1}", worker, error));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Connects to the workers and initializes them. The coordinator creates only the snapshot,
+        /// the data structures are created by the workers for their shards.
+        /// </summary>
+        void InitializeCoordinator(bool isNewSnapshot)
+        {
+            _gameValuesLengths = new int[_playersCount][];
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                _gameValuesLengths[p] = new int[_init.At.NodesCount];
+                for (Int64 n = 0; n < _init.At.NodesCount; ++n)
+                {
+                    bool isLeaf = n == _init.At.NodesCount - 1 || _init.At.GetDepth(n + 1) <= _init.At.GetDepth(n);
+                    if (isLeaf)
+                    {
+                        _gameValuesLengths[p][n] = _init.PlayerCtNodesCount[p][_init.At.Nodes[n].Round];
+                    }
+                }
+            }
+
+            ConnectWorkers();
+
+            string actionTreeFile = Path.GetFullPath(ActionTreeFile);
+            string chanceTreeFile = Path.GetFullPath(ChanceTreeFile);
+            string snapshotDir = Path.GetFullPath(_curSnapshotInfo.BaseDir);
+            for (int w = 0; w < Workers.Length; ++w)
+            {
+                int shardIndex = w;
+                SendToWorker(w, CreateMessage(WorkerMessage.Init, bw =>
+                    {
+                        bw.Write(shardIndex);
+                        bw.Write(Workers.Length);
+                        bw.Write(actionTreeFile);
+                        bw.Write(chanceTreeFile);
+                        bw.Write(EqualCa);
+                        bw.Write(snapshotDir);
+                        bw.Write(isNewSnapshot);
+                        for (int p = 0; p < _playersCount; ++p)
+                        {
+                            bw.Write(IterationCounts[p]);
+                        }
+                    }));
+            }
+            for (int w = 0; w < Workers.Length; ++w)
+            {
+                BinaryReader br = ReadMessage(ReceiveFromWorker(w), WorkerMessage.Ready);
+                Int64 gameValuesSize = br.ReadInt64();
+                Int64 chanceFactorsSize = br.ReadInt64();
+                if (IsVerbose)
+                {
+                    Console.WriteLine("Worker {0} is ready, game values: {1:#,0} bytes, chance factors: {2:#,0} bytes",
+                                      Workers[w], gameValuesSize, chanceFactorsSize);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Does BR with the workers. The work lists of the workers are forwarded to all workers 
+        /// in the order of the workers, so that all of them update the game values in the same order.
+        /// </summary>
+        void BestResponseDistributed()
+        {
+            SendToWorkers(CreateMessage(WorkerMessage.Iterate, bw => bw.Write(_heroPos)));
+            double sbrValue = 0;
+            double valuesUpTime = 0;
+            double finalizeTime = 0;
+            for (int w = 0; w < _workerClients.Length; ++w)
+            {
+                for (; ; )
+                {
+                    byte[] message = ReceiveFromWorker(w);
+                    if (GetMessageKind(message) == WorkerMessage.WorkList)
+                    {
+                        SetMessageKind(message, WorkerMessage.Apply);
+                        SendToWorkers(message);
+                        continue;
+                    }
+                    BinaryReader br = ReadMessage(message, WorkerMessage.Result);
+                    sbrValue += br.ReadDouble();
+                    _finalBrLeavesCount += br.ReadUInt64();
+                    valuesUpTime = Math.Max(valuesUpTime, br.ReadDouble());
+                    finalizeTime = Math.Max(finalizeTime, br.ReadDouble());
+                    break;
+                }
+            }
+            LastSbrValues[_heroPos] = sbrValue;
+            _timeInBrValuesUp += valuesUpTime;
+            _timeInBrFinalize += finalizeTime;
+        }
+
+        /// <summary>
+        /// Writes the current snapshot with the workers: the coordinator creates the game value files,
+        /// the workers write their parts into them and send their strategic variables, 
+        /// the coordinator writes the strategies and the header.
+        /// </summary>
+        void SaveSnapshotDistributed()
+        {
+            if (IsVerbose)
+            {
+                Console.WriteLine("Saving snapshot to {0}", _curSnapshotInfo.BaseDir);
+            }
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                using (FileStream fs = File.Open(_curSnapshotInfo.GameValuesFile[p], FileMode.Create, FileAccess.Write))
+                {
+                    Int64 fileSize = 0;
+                    for (int g = 0; g < _gameValuesLengths[p].Length; ++g)
+                    {
+                        fileSize += sizeof(int) + (Int64)_gameValuesLengths[p][g] * sizeof(double);
+                    }
+                    fs.SetLength(fileSize);
+                    BinaryWriter bw = new BinaryWriter(fs);
+                    for (int g = 0; g < _gameValuesLengths[p].Length; ++g)
+                    {
+                        int length = _gameValuesLengths[p][g];
+                        bw.Write(length);
+                        bw.Flush();
+                        fs.Seek((Int64)length * sizeof(double), SeekOrigin.Current);
+                    }
+                    bw.Flush();
+                }
+            }
+
+            string snapshotDir = Path.GetFullPath(_curSnapshotInfo.BaseDir);
+            SendToWorkers(CreateMessage(WorkerMessage.Save, bw => bw.Write(snapshotDir)));
+            UInt32[][] strVars = new UInt32[_playersCount][];
+            for (int w = 0; w < _workerClients.Length; ++w)
+            {
+                BinaryReader br = ReadMessage(ReceiveFromWorker(w), WorkerMessage.Saved);
+                for (int p = 0; p < _playersCount; ++p)
+                {
+                    Int64 nodesCount = br.ReadInt64();
+                    if (strVars[p] == null)
+                    {
+                        strVars[p] = new UInt32[nodesCount];
+                    }
+                    int rangesCount = br.ReadInt32();
+                    for (int r = 0; r < rangesCount; ++r)
+                    {
+                        Int64 begin = br.ReadInt64();
+                        Int64 end = br.ReadInt64();
+                        for (Int64 n = begin; n < end; ++n)
+                        {
+                            strVars[p][n] = br.ReadUInt32();
+                        }
+                    }
+                }
+            }
+            WriteStrategies(_curSnapshotInfo, strVars, IterationCounts);
+            SaveSnapshotAuxData();
+        }
+
+        /// <summary>
+        /// Writes an intermediate snapshot with the workers. 
+        /// Unlike SaveSnapshotAsync(), the iterations are stalled until the snapshot is written.
+        /// </summary>
+        void SaveIntermediateSnapshotDistributed()
+        {
+            long start = Stopwatch.GetTimestamp();
+            SwitchSnapshot();
+            SaveSnapshotDistributed();
+            _lastSnapshotStall = (double)(Stopwatch.GetTimestamp() - start) / Stopwatch.Frequency;
+            _totalSnapshotStall += _lastSnapshotStall;
+            _intermediateSnapshotsCount++;
+            _lastSnapshotTime = DateTime.Now;
+        }
+
+        #endregion
+
+        #region Worker
+
+        void InitializeWorker(Connection coordinator, BinaryReader br)
+        {
+            DateTime startTime = DateTime.Now;
+
+            _coordinator = coordinator;
+            int shardIndex = br.ReadInt32();
+            int shardCount = br.ReadInt32();
+            ActionTreeFile = br.ReadString();
+            ChanceTreeFile = br.ReadString();
+            EqualCa = br.ReadBoolean();
+            string snapshotDir = br.ReadString();
+            bool isNewSnapshot = br.ReadBoolean();
+
+            _init = new InitData(this);
+            _playersCount = _init.At.PlayersCount;
+            IterationCounts = new int[_playersCount];
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                IterationCounts[p] = br.ReadInt32();
+            }
+            LastSbrValues = new double[_playersCount];
+            _curSnapshotInfo = new SnapshotInfo(snapshotDir, _playersCount, EqualCa);
+            _loadedSnapshotInfo = _curSnapshotInfo;
+            _shard = new Shard(_init, shardIndex, shardCount);
+            if (IsVerbose)
+            {
+                Console.WriteLine("Worker: shard {0} of {1}, snapshot {2}", shardIndex, shardCount, snapshotDir);
+            }
+
+            CreateDataStructures(isNewSnapshot);
+            _init = null;
+            _workList = new WorkList(_coordinator);
+
+            Int64 gameValuesSize = 0;
+            Int64 chanceFactorsSize = GetChanceFactorsByteSize();
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                for (int g = 0; g < _actionGroups[p].Length; ++g)
+                {
+                    gameValuesSize += (Int64)_actionGroups[p][g].GameValuesLength * sizeof(double);
+                }
+            }
+            SendToCoordinator(CreateMessage(WorkerMessage.Ready, bw =>
+                {
+                    bw.Write(gameValuesSize);
+                    bw.Write(chanceFactorsSize);
+                }));
+
+            if (IsVerbose)
+            {
+                Console.WriteLine("Worker initialization done in {0:0.0} s", (DateTime.Now - startTime).TotalSeconds);
+            }
+        }
+
+        void SendToCoordinator(byte[] message)
+        {
+            if (!_coordinator.Send(message))
+            {
+                throw new ApplicationException("Coordinator is disconnected");
+            }
+        }
+
+        void ProcessWorkerMessage(byte[] message)
+        {
+            WorkerMessage kind = GetMessageKind(message);
+            switch (kind)
+            {
+                case WorkerMessage.Iterate:
+                    IterateWorker(ReadMessage(message, kind).ReadInt32());
+                    break;
+                case WorkerMessage.Apply:
+                    ApplyWorkList(message);
+                    break;
+                case WorkerMessage.Save:
+                    SaveWorker(ReadMessage(message, kind).ReadString());
+                    break;
+                default:
+                    throw new ApplicationException(String.Format("Unexpected message {0}", kind));
+            }
+        }
+
+        /// <summary>
+        /// Does BR for the deals of the shard, sends the final BR leaves and the result to the coordinator.
+        /// </summary>
+        void IterateWorker(int heroPos)
+        {
+            long time0 = Stopwatch.GetTimestamp();
+            // Finish the updates of the game values from the previous iteration.
+            if (_threadPool != null)
+            {
+                _threadPool.WaitAllJobs();
+            }
+            long time1 = Stopwatch.GetTimestamp();
+            _heroPos = heroPos;
+            IterationCounts[_heroPos]++;
+            UInt64 finalBrLeavesCount = _finalBrLeavesCount;
+            BestResponseValuesUp();
+            long time2 = Stopwatch.GetTimestamp();
+            BestResponseFinalize();
+            _workList.Flush();
+            long time3 = Stopwatch.GetTimestamp();
+
+            double valuesUpTime = (double)(time2 - time1) / Stopwatch.Frequency;
+            double finalizeTime = _applyTime + (double)(time1 - time0 + time3 - time2) / Stopwatch.Frequency;
+            _applyTime = 0;
+            SendToCoordinator(CreateMessage(WorkerMessage.Result, bw =>
+                {
+                    bw.Write(LastSbrValues[_heroPos]);
+                    bw.Write(_finalBrLeavesCount - finalBrLeavesCount);
+                    bw.Write(valuesUpTime);
+                    bw.Write(finalizeTime);
+                }));
+        }
+
+        void ApplyWorkList(byte[] message)
+        {
+            long start = Stopwatch.GetTimestamp();
+            int count = BitConverter.ToInt32(message, 4);
+            fixed (byte* pMessage = message)
+            {
+                UInt32* pPairs = (UInt32*)(pMessage + WorkList.HEADER_SIZE);
+                for (int i = 0; i < count; ++i)
+                {
+                    QueueIncrementGameValueJob(pPairs[2 * i], pPairs[2 * i + 1]);
+                }
+            }
+            _applyTime += (double)(Stopwatch.GetTimestamp() - start) / Stopwatch.Frequency;
+        }
+
+        /// <summary>
+        /// Writes the game values of the shard to the files created by the coordinator, 
+        /// sends the strategic variables of the shard.
+        /// </summary>
+        void SaveWorker(string snapshotDir)
+        {
+            if (_threadPool != null)
+            {
+                _threadPool.WaitAllJobs();
+            }
+            SnapshotInfo snapshotInfo = new SnapshotInfo(snapshotDir, _playersCount, EqualCa);
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                using (FileStream fs = new FileStream(snapshotInfo.GameValuesFile[p], FileMode.Open, 
+                    FileAccess.Write, FileShare.ReadWrite))
+                {
+                    BinaryWriter bw = new BinaryWriter(fs);
+                    Int64 offset = 0;
+                    for (int g = 0; g < _actionGroups[p].Length; ++g)
+                    {
+                        offset += sizeof(int);
+                        ActionGroup ag = _actionGroups[p][g];
+                        if (ag.GameValues == null)
+                        {
+                            continue;
+                        }
+                        int round = ag.Round;
+                        fs.Seek(offset + (Int64)_shard.Begin[p][round] * sizeof(double), SeekOrigin.Begin);
+                        UnmanagedMemory.Write(bw, new IntPtr(ag.GameValues), ag.GameValuesLength * sizeof(double));
+                        bw.Flush();
+                        offset += (Int64)_shard.FullLength[p][round] * sizeof(double);
+                    }
+                }
+            }
+
+            SendToCoordinator(CreateMessage(WorkerMessage.Saved, bw =>
+                {
+                    for (int p = 0; p < _playersCount; ++p)
+                    {
+                        PlayerTree tree = _playerTrees[p];
+                        List<Int64> ranges = new List<Int64>();
+                        if (_shard.Index == 0)
+                        {
+                            // The nodes above the deals of round 0 are updated by all workers equally.
+                            ranges.Add(0);
+                            ranges.Add(_playersCount + 1);
+                        }
+                        foreach (TopTreeNode node in _topTrees[p].Nodes)
+                        {
+                            ranges.Add(node.RootNode);
+                            ranges.Add(node.EndNode);
+                        }
+                        bw.Write(tree.NodesCount);
+                        bw.Write(ranges.Count / 2);
+                        for (int r = 0; r < ranges.Count; r += 2)
+                        {
+                            bw.Write(ranges[r]);
+                            bw.Write(ranges[r + 1]);
+                            for (Int64 n = ranges[r]; n < ranges[r + 1]; ++n)
+                            {
+                                bw.Write(tree.Nodes[n].StrVar);
+                            }
+                        }
+                    }
+                }));
+        }
+
+        /// <summary>
+        /// Frees the data of the session of a coordinator.
+        /// </summary>
+        static void EndWorkerSession(Connection connection)
+        {
+            FictitiousPlay session = (FictitiousPlay)connection.UserData;
+            if (session == null)
+            {
+                return;
+            }
+            connection.UserData = null;
+            if (session._threadPool != null)
+            {
+                session._threadPool.WaitAllJobs();
+            }
+            if (session._actionGroups != null)
+            {
+                session.FreeActionGroupsAndChanceFactors();
+            }
+            session.CleanUp();
+            if (session.IsVerbose)
+            {
+                Console.WriteLine("Worker session is finished");
+            }
+        }
+
+        #endregion
+
+        #endregion
+
+        #region Trace
+
+#if DEBUG_PRINT
+        const bool IsDebugPrintOn = true;
+#else
+        const bool IsDebugPrintOn = false;
+#endif
+
+        UInt64 _finalBrLeavesCount;
+
+        double _timeInBrValuesUp = 0;
+        double _timeInBrFinalize = 0;
+
+        SnapshotWriter _snapshotWriter = new SnapshotWriter();
+        FrozenSnapshot _frozenSnapshot;
+        DateTime _lastSnapshotTime;
+        int _intermediateSnapshotsCount;
+        double _lastSnapshotStall;
+        double _totalSnapshotStall;
+
+        private string GetTraceFileName(int pos, string kind, string substep, string ext)
+        {
+            string fileName = string.Format("{0}\\{1:00000}-{2}-{3}{4}.{5}",
+                                            TraceDir, IterationCounts[pos], pos,
+                                            kind,
+                                            string.IsNullOrEmpty(substep) ? "" : "-" + substep,
+                                            ext);
+            return fileName;
+        }
+
+        bool IsIterationVerbose()
+        {
+            return IsVerbose &&
+                IterationVerbosity > 0 &&
+                (CurrentIterationCount % IterationVerbosity == 0);
+        }
+
+        private void PrintChanceInfo(int pos, string fileName)
+        {
+            using (TextWriter tw = new StreamWriter(fileName))
+            {
+                for (int i = 0; i < _chanceInfos[pos].Length; ++i)
                 {
                     int maskIdx = (int)_chanceInfos[pos][i].ChanceMaskIdx;
                     tw.WriteLine("CI: {0,6} mask: {1,5} factor: {2,5} id in ag: {3, 5}", i,
@@ -2709,8 +4464,10 @@ namespace ai.pkr.fictpl
                         if (_chanceMasks[pos].Get((uint)m))
                         {
 #endif
+#if !USE_SPARSE_CHANCE_FACTORS
                             tw.Write(": cf nsd: {0:0.00000}, cf sd: {1:0.00000}",
                                 _chanceFactors[pos][chanceFactorIdx], _chanceFactors[pos][chanceFactorIdx + 1]);
+#endif
                             chanceFactorIdx += 2;
 #if USE_CHANCE_MAKSS
                         }
@@ -15,6 +15,8 @@ using System.Reflection;
 using ai.pkr.metastrategy.algorithms;
 using ai.pkr.metastrategy.vis;
 using System.IO;
+using System.Threading;
+using ai.lib.ipc;
 
 namespace ai.pkr.fictpl.nunit
 {
@@ -314,6 +316,61 @@ namespace ai.pkr.fictpl.nunit
             }
         }
 
+        /// <summary>
+        /// Makes sure that an intermediate snapshot written in background can be resumed 
+        /// and gives exactly the same strategies.
+        /// </summary>
+        [Test]
+        public void Test_IntermediateSnapshot_LeducHe()
+        {
+            bool isVerbose = false;
+
+            var testParams = new GameDefParams(this, "leduc-he.gamedef.xml",
+                0.002);
+            testParams.Name = "LeducHe-NoSh";
+            StrategyTree[] trees = RunFictPlay(testParams, false, false, new int[] { -1 },
+                s => { s.IsVerbose = isVerbose; s.ThreadsCount = 0; });
+            testParams.Name = "LeducHe-ISh";
+            FictitiousPlay solver = null;
+            RunFictPlay(testParams, false, false, new int[] { -1 },
+                s =>
+                    {
+                        s.IsVerbose = isVerbose;
+                        s.ThreadsCount = 0;
+                        s.SnapshotsCount = 3;
+                        s.SnapshotPeriod = 0.01;
+                        solver = s;
+                    });
+            int totalIterationCount = solver.TotalIterationCount;
+
+            // Remove the final snapshot, the newest one is now an intermediate snapshot.
+            File.Delete(solver.CurrentSnapshotInfo.HeaderFile);
+            FictitiousPlay resumed = new FictitiousPlay
+                                         {
+                                             ChanceTreeFile = solver.ChanceTreeFile,
+                                             ActionTreeFile = solver.ActionTreeFile,
+                                             EqualCa = solver.EqualCa,
+                                             OutputPath = solver.OutputPath,
+                                             SnapshotsCount = 3,
+                                             Epsilon = solver.Epsilon,
+                                             ThreadsCount = 0,
+                                             IsVerbose = isVerbose
+                                         };
+            resumed.Solve();
+            int loadedIterationCount = resumed.TotalIterationCount - resumed.CurrentIterationCount;
+            Assert.Greater(loadedIterationCount, 0);
+            Assert.Less(loadedIterationCount, totalIterationCount);
+            Assert.AreEqual(totalIterationCount, resumed.TotalIterationCount);
+
+            for (int p = 0; p < testParams.GameDef.MinPlayers; ++p)
+            {
+                StrategyTree treeSn = StrategyTree.Read<StrategyTree>(resumed.CurrentSnapshotInfo.StrategyFile[p]);
+                CompareStrategyTrees cmp = new CompareStrategyTrees { IsVerbose = isVerbose };
+                cmp.Compare(trees[p], treeSn);
+                Assert.AreEqual(new double[] { 0, 0 }, cmp.SumProbabDiff);
+            }
+        }
+
         /// <summary>
         /// Makes sure that the strategies generated with and without multithreading are exactly the same.
         /// </summary>
@@ -328,11 +385,78 @@ namespace ai.pkr.fictpl.nunit
                 s => { s.IsVerbose = isVerbose; s.ThreadsCount = 0; });
             StrategyTree[] treesMt = RunFictPlay(testParams, false, false, new int[] { 10000, -1 },
                 s => { s.IsVerbose = isVerbose; s.ThreadsCount = 7; });
+            // Split the player trees at all deal nodes.
+            StrategyTree[] treesMtSplit = RunFictPlay(testParams, false, false, new int[] { 10000, -1 },
+                s => { s.IsVerbose = isVerbose; s.ThreadsCount = 3; s.JobsPerThread = 100000; });
+            // The performance counters must not change the results.
+            StrategyTree[] treesMtPerf = RunFictPlay(testParams, false, false, new int[] { 10000, -1 },
+                s => { s.IsVerbose = isVerbose; s.ThreadsCount = 3; s.IsPerfCountersOn = true; });
             for (int p = 0; p < testParams.GameDef.MinPlayers; ++p)
             {
                 CompareStrategyTrees cmp = new CompareStrategyTrees { IsVerbose = isVerbose };
                 cmp.Compare(treesSt[p], treesMt[p]);
                 Assert.AreEqual(new double[] { 0, 0 }, cmp.SumProbabDiff);
+                cmp.Compare(treesSt[p], treesMtSplit[p]);
+                Assert.AreEqual(new double[] { 0, 0 }, cmp.SumProbabDiff);
+                cmp.Compare(treesSt[p], treesMtPerf[p]);
+                Assert.AreEqual(new double[] { 0, 0 }, cmp.SumProbabDiff);
+            }
+        }
+
+        /// <summary>
+        /// Makes sure that the strategies generated by distributed solving are exactly the same 
+        /// as in a single process, including resuming from a snapshot written by the workers.
+        /// </summary>
+        [Test]
+        public void Test_Distributed_LeducHe()
+        {
+            bool isVerbose = false;
+            int[] iterCounts = new int[] { 3000, 4000 };
+
+            var testParams = new GameDefParams(this, "leduc-he.gamedef.xml",
+                0.002);
+            testParams.Name = "LeducHe-Single";
+            StrategyTree[] trees = RunFictPlay(testParams, false, false, iterCounts,
+                s => { s.IsVerbose = isVerbose; s.ThreadsCount = 0; });
+
+            const int WORKERS_COUNT = 3;
+            string[] workers = new string[WORKERS_COUNT];
+            Thread[] workerThreads = new Thread[WORKERS_COUNT];
+            for (int w = 0; w < WORKERS_COUNT; ++w)
+            {
+                Server server = new Server();
+                server.Start("0");
+                workers[w] = "localhost:" + server.Port;
+                FictitiousPlay worker = new FictitiousPlay { IsVerbose = isVerbose, ThreadsCount = w };
+                workerThreads[w] = new Thread(() =>
+                                                  {
+                                                      worker.Work(server);
+                                                      server.Stop();
+                                                  });
+                workerThreads[w].Start();
+            }
+
+            testParams.Name = "LeducHe-Distributed";
+            StrategyTree[] treesDist;
+            try
+            {
+                treesDist = RunFictPlay(testParams, false, false, iterCounts,
+                    s => { s.IsVerbose = isVerbose; s.Workers = workers; });
+            }
+            finally
+            {
+                FictitiousPlay.ShutdownWorkers(workers);
+                for (int w = 0; w < WORKERS_COUNT; ++w)
+                {
+                    workerThreads[w].Join();
+                }
+            }
+
+            for (int p = 0; p < testParams.GameDef.MinPlayers; ++p)
+            {
+                CompareStrategyTrees cmp = new CompareStrategyTrees { IsVerbose = isVerbose };
+                cmp.Compare(trees[p], treesDist[p]);
+                Assert.AreEqual(new double[] { 0, 0 }, cmp.SumProbabDiff);
             }
         }
 
@@ -68,6 +68,38 @@ void Test_IncrementGameValueNoMasks()
 	printf("OK\n");
 }
 
+void Test_IncrementGameValues()
+{
+	// Odd size and offset to test unaligned access and the tail.
+	const int size = ARR_SIZE + 3;
+	double * src = new double[size + 1];
+	double * dst = new double[size + 1];
+
+	for(int i = 0; i < size; ++i)
+	{
+		dst[i + 1] = i;
+		src[i + 1] = 2*i;
+	}
+	dst[0] = -1;
+
+	IncrementGameValues(dst + 1, size, src + 1);
+
+	for(int i = 0; i < size; ++i)
+	{
+		if(dst[i + 1] != 3*i)
+		{
+			throw "Wrong sum";
+		}
+	}
+	if(dst[0] != -1)
+	{
+		throw "Wrong sum";
+	}
+	delete [] src;
+	delete [] dst;
+	printf("OK\n");
+}
+
 void Benchmark_IncrementGameValueNoMasks()
 {
 	AlignedPtr s, d;
@@ -100,6 +132,7 @@ int _tmain(int argc, _TCHAR* argv[])
 {
 	//IncrementGameValueNoMasks(0, 0, 0);
 	Test_IncrementGameValueNoMasks();
+	Test_IncrementGameValues();
 	Benchmark_IncrementGameValueNoMasks();
 	return 0;
 }
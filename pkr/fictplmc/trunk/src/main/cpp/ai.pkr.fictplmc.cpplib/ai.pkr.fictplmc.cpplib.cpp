@@ -77,5 +77,30 @@ AIPKRFICTPLMCCPPLIB_API void IncrementGameValueNoMasks(double * pGameValues, uin
 
 }
 
+AIPKRFICTPLMCCPPLIB_API void IncrementGameValues(double * pGameValues, uint32_t gameValuesCount, const double * pIncrements)
+{
+	// Used to sum up the buffers of worker threads, which are managed arrays, so use unaligned access.
+	__m128d a, b;
+	for(; gameValuesCount >= 4; gameValuesCount -= 4)
+	{
+		a = _mm_loadu_pd(pGameValues);
+		b = _mm_loadu_pd(pIncrements);
+		a = _mm_add_pd(a, b);
+		_mm_storeu_pd(pGameValues, a);
+
+		a = _mm_loadu_pd(pGameValues + 2);
+		b = _mm_loadu_pd(pIncrements + 2);
+		a = _mm_add_pd(a, b);
+		_mm_storeu_pd(pGameValues + 2, a);
+
+		pIncrements += 4;
+		pGameValues += 4;
+	}
+	for(; gameValuesCount > 0; --gameValuesCount)
+	{
+		*pGameValues++ += *pIncrements++;
+	}
+}
+
 
 }
\ No newline at end of file
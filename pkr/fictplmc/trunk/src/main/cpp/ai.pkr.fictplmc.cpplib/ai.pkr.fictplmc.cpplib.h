@@ -20,6 +20,9 @@ extern "C" {
 
 AIPKRFICTPLMCCPPLIB_API void IncrementGameValueNoMasks(double * pGameValues, uint32_t gameValuesCount, ChanceValueT * pChanceFactors);
 
+/// Adds pIncrements to pGameValues. No alignment or padding is required.
+AIPKRFICTPLMCCPPLIB_API void IncrementGameValues(double * pGameValues, uint32_t gameValuesCount, const double * pIncrements);
+
 #ifdef __cplusplus
 } 
 #endif
@@ -19,6 +19,10 @@ namespace ai.pkr.fictpl
         public static extern void IncrementGameValueNoMasks(double* pGameValues, UInt32 gameValuesCount,
             ChanceValueT* pChanceFactors);
 
+        [DllImport("ai.pkr.fictplmc.cpplib.dll")]
+        public static extern void IncrementGameValues(double* pGameValues, UInt32 gameValuesCount,
+            double* pIncrements);
+
 
         public static void Init()
         {
@@ -340,7 +340,10 @@ namespace ai.pkr.fictpl
         /// Number of threads in a thread pool for parallel execution. 
         /// The main thread is not included in this count.
         /// Default: 0, in this case no thread pool is created.
-        /// Todo: is not used not, left here for backwards compatibility with UTs.
+        /// The opponent deals of each iteration are split between the threads, each thread accumulates
+        /// the game values in its own buffer. The buffers are summed up in a fixed order, therefore
+        /// the result is deterministic for given RngSeed and ThreadsCount.
+        /// GameDef.GameRules and ChanceAbstraction must be thread-safe.
         /// </summary>
         public int ThreadsCount
         {
@@ -532,6 +535,33 @@ namespace ai.pkr.fictpl
         /// </summary>
         private double[] _oppGv;
 
+        /// <summary>
+        /// Opponent hands dealt in the current iteration.
+        /// </summary>
+        private List<int[]> _oppDeals = new List<int[]>();
+
+        /// <summary>
+        /// Calculates opponent game values for a range of _oppDeals. 
+        /// Has its own copy of the hands and its own game values buffer.
+        /// </summary>
+        class OppDealWorker
+        {
+            public OppDealWorker(FictitiousPlayMc solver)
+            {
+                Hands = new int[solver._playersCount][].Fill(i => new int[solver._mcDealer.HandSize]);
+                OppGv = new double[solver._at.NodesCount];
+            }
+
+            public int[][] Hands;
+            public double[] OppGv;
+            public int BeginDeal;
+            public int EndDeal;
+        }
+
+        OppDealWorker[] _oppDealWorkers;
+        ThreadPoolBase.Job<OppDealWorker>[] _oppDealJobs;
+        AssigningThreadPool _threadPool;
+
         #endregion
 
         #region Implementation - initialization
@@ -638,6 +668,21 @@ namespace ai.pkr.fictpl
             _handSizes = GameDef.GetHandSizes();
             _oppGv = new double[_at.NodesCount];
 
+            int workersCount = Math.Max(ThreadsCount, 1);
+            _oppDealWorkers = new OppDealWorker[workersCount].Fill(i => new OppDealWorker(this));
+            _oppDealJobs = new ThreadPoolBase.Job<OppDealWorker>[workersCount].Fill(
+                i => new ThreadPoolBase.Job<OppDealWorker> { Execute = CalculateOppGv, Param1 = _oppDealWorkers[i] });
+            if (ThreadsCount > 0)
+            {
+                // Create thread pool only if we really need it, 
+                // use single threaded mode for debugging and profiling.
+                _threadPool = new AssigningThreadPool(ThreadsCount);
+                if (IsVerbose)
+                {
+                    Console.WriteLine("Thread pool is created, threads: {0}", ThreadsCount);
+                }
+            }
+
             bool isNewSnapshot = !_snapshotSwitcher.IsSnapshotAvailable;
             if (isNewSnapshot)
             {
@@ -951,6 +996,7 @@ namespace ai.pkr.fictpl
         void DealOppCardsAndCalculateGV()
         {
             _oppGv.Fill(0);
+            _oppDeals.Clear();
             _hands[_heroPos].CopyTo(_hands[1 - _heroPos], 0);
 #if true // full enum
             CardEnum.Combin(GameDef.DeckDescr, _handSizes[0], _hands[1 - _heroPos], 0, _hands[_heroPos],
@@ -965,6 +1011,62 @@ namespace ai.pkr.fictpl
             int oppCard = _rng.Next(restDeck.Count);
             _hands[1 - _heroPos][0] = oppCard;
             OnOppDeal(_hands[1 - _heroPos], 0);
+#endif
+            int dealsCount = _oppDeals.Count;
+            int workersCount = _oppDealWorkers.Length;
+            for (int w = 0; w < workersCount; ++w)
+            {
+                OppDealWorker worker = _oppDealWorkers[w];
+                worker.BeginDeal = dealsCount * w / workersCount;
+                worker.EndDeal = dealsCount * (w + 1) / workersCount;
+                if (_threadPool != null)
+                {
+                    _threadPool.QueueJob(_oppDealJobs[w], w);
+                }
+                else
+                {
+                    CalculateOppGv(worker);
+                }
+            }
+            if (_threadPool != null)
+            {
+                _threadPool.WaitAllJobs();
+            }
+            // Sum up in the order of workers to get the same result in each run.
+            for (int w = 0; w < workersCount; ++w)
+            {
+                AddOppGv(_oppDealWorkers[w].OppGv);
+            }
+        }
+
+        void OnOppDeal(int[] cards, int param)
+        {
+            _oppDeals.Add(cards.ShallowCopy());
+        }
+
+        void CalculateOppGv(OppDealWorker worker)
+        {
+            worker.OppGv.Fill(0);
+            _hands[_heroPos].CopyTo(worker.Hands[_heroPos], 0);
+            for (int i = worker.BeginDeal; i < worker.EndDeal; ++i)
+            {
+                _oppDeals[i].CopyTo(worker.Hands[1 - _heroPos], 0);
+                CalculateOppGv(worker.Hands, worker.OppGv);
+            }
+        }
+
+        void AddOppGv(double[] oppGv)
+        {
+#if USE_CPP_LIB
+            fixed (double* pDst = _oppGv, pSrc = oppGv)
+            {
+                CppLib.IncrementGameValues(pDst, (uint)_oppGv.Length, pSrc);
+            }
+#else
+            for (int i = 0; i < _oppGv.Length; ++i)
+            {
+                _oppGv[i] += oppGv[i];
+            }
 #endif
         }
 
@@ -974,11 +1076,14 @@ namespace ai.pkr.fictpl
             public double StrProbab = 1.0;
         }
 
-        void OnOppDeal(int [] cards, int param)
+        /// <summary>
+        /// Calculates game values of the opponent for the given hands, can be called from a worker thread.
+        /// </summary>
+        void CalculateOppGv(int[][] hands, double[] oppGv)
         {
             int oppPos = 1 - _heroPos;
             uint[] ranks = new uint[_playersCount]; 
-            GameDef.GameRules.Showdown(GameDef, _hands, ranks);
+            GameDef.GameRules.Showdown(GameDef, hands, ranks);
             double oppShowdown = 0;
             if(ranks[_heroPos] > ranks[oppPos])
             {
@@ -988,7 +1093,7 @@ namespace ai.pkr.fictpl
             {
                 oppShowdown = 1;
             }
-            int[] oppAbstrCards = HandToAbstractCards(_hands[oppPos]);
+            int[] oppAbstrCards = HandToAbstractCards(hands[oppPos]);
             var wt = new WalkUFTreePP<StrategyTree, CalcOppValuesContext>();
             wt.OnNodeBegin = (t, s, d) =>
                                  {
@@ -1041,7 +1146,7 @@ namespace ai.pkr.fictpl
                                            // Showdown (inpots are equal)
                                            gv = gvPS*oppShowdown;
                                        }
-                                       _oppGv[atIdx] += gv;
+                                       oppGv[atIdx] += gv;
                                    }
                                };
             wt.Walk(_pt);
@@ -1329,6 +1434,11 @@ namespace ai.pkr.fictpl
 
         void CleanUp()
         {
+            if (_threadPool != null)
+            {
+                _threadPool.Dispose();
+                _threadPool = null;
+            }
         }
 
         private void WriteEpsilonLog(TextWriter tw)
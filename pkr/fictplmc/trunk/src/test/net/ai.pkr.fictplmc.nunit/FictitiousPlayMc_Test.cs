@@ -187,6 +187,32 @@ namespace ai.pkr.fictpl.nunit
         #endregion
 
         #region Verification tests
+
+        /// <summary>
+        /// Makes sure that the strategies generated with multithreading are the same for the same
+        /// number of threads and are equal to the single-threaded ones up to the rounding errors.
+        /// </summary>
+        [Test]
+        public void Test_Multithreaded_Kuhn()
+        {
+            bool isVerbose = false;
+            TestParams testParams = new TestParams(this, "kuhn.gamedef.xml",
+                new KuhnChanceAbstraction(), new int[] { 3 }, 0.001);
+            StrategyTree treeSt = RunFictPlay(testParams, false, false, new int[] { 2000 },
+                s => { s.IsVerbose = isVerbose; s.ThreadsCount = 0; });
+            StrategyTree treeMt1 = RunFictPlay(testParams, false, false, new int[] { 2000 },
+                s => { s.IsVerbose = isVerbose; s.ThreadsCount = 3; });
+            StrategyTree treeMt2 = RunFictPlay(testParams, false, false, new int[] { 2000 },
+                s => { s.IsVerbose = isVerbose; s.ThreadsCount = 3; });
+            CompareStrategyTrees cmp = new CompareStrategyTrees { IsVerbose = isVerbose };
+            cmp.Compare(treeMt1, treeMt2);
+            Assert.AreEqual(new double[] { 0, 0 }, cmp.SumProbabDiff);
+            cmp.Compare(treeSt, treeMt1);
+            for (int p = 0; p < 2; ++p)
+            {
+                Assert.Less(cmp.MaxProbabDiff[p], 1e-10);
+            }
+        }
         /*
         /// <summary>
         /// Makes sure that the strategies generated with an intermediate snapshot are exactly the same
@@ -272,6 +298,27 @@ namespace ai.pkr.fictpl.nunit
         */
         #endregion
 
+        #region Benchmarks
+
+        [Test]
+        [Category("Benchmark")]
+        public void Benchmark_Multithreaded_Kuhn()
+        {
+            TestParams testParams = new TestParams(this, "kuhn.gamedef.xml",
+                new KuhnChanceAbstraction(), new int[] { 3 }, 0);
+            int iterationCount = 20000;
+            foreach (int threadsCount in new int[] { 0, 1, 2, 4, 8 })
+            {
+                DateTime startTime = DateTime.Now;
+                RunFictPlay(testParams, false, false, new int[] { iterationCount },
+                    s => { s.ThreadsCount = threadsCount; });
+                double time = (DateTime.Now - startTime).TotalSeconds;
+                Console.WriteLine("Threads: {0}, {1} iterations in {2:0.000} s, {3:0.0} it/s",
+                    threadsCount, iterationCount, time, iterationCount / time);
+            }
+        }
+
+        #endregion
 
         #region Implementation
 
@@ -60,23 +60,19 @@ namespace ai.pkr.holdem.strategy.ahvo
 
         public static float CalculateFast(int[] board, int start, int length)
         {
-            CardSet cs = StdDeck.Descriptor.GetCardSet(board, start, length);
-            return CalculateFast(cs);
+            int round = HeHelper.HandSizeToRound[length + 2];
+            HandIsoIndexer indexer = _indexers[round - 1];
+            if (indexer == null)
+            {
+                indexer = _indexers[round - 1] = HandIsoIndexer.GetBoard(length);
+            }
+            return _luts[round - 1][indexer.Index(board, start)];
         }
 
         public static float CalculateFast(CardSet board)
         {
-            NormSuit ns = new NormSuit();
-            Entry searchEntry = new Entry();
-            searchEntry.CardSet = ns.Convert(board).bits;
-            int round = HeHelper.HandSizeToRound[board.CountCards() + 2];
-            Entry [] lut = _luts[round - 1];
-            int idx = Array.BinarySearch(lut, searchEntry);
-            if (idx < 0)
-            {
-                throw new ApplicationException(string.Format("Cannot find LUT entry for board: '{0}'", StdDeck.Descriptor.GetCardNames(board)));
-            }
-            return lut[idx].Ahvo;
+            int[] cards = StdDeck.Descriptor.GetIndexesAscending(board).ToArray();
+            return CalculateFast(cards, 0, cards.Length);
         }
 
         public static void Precalculate(int round)
@@ -96,7 +92,7 @@ namespace ai.pkr.holdem.strategy.ahvo
             PrecalulateParam p = new PrecalulateParam();
             int boardSize = HeHelper.RoundToHandSize[round] - 2;
             CardEnum.Combin(StdDeck.Descriptor, boardSize, CardSet.Empty, CardSet.Empty, OnPrecalculateBoard, p);
-            Entry[] lut = p.Entries.ToArray();
+            float[] lut = ToIndexedTable(p.Entries.ToArray(), boardSize);
             WriteLut(lut, lutPath);
             Console.WriteLine("LUT {0} created.", lutPath);
         }
@@ -170,9 +166,45 @@ namespace ai.pkr.holdem.strategy.ahvo
                 p.Entries.Add(newEntry);
             }
         }
-        static readonly int SER_FMT_VER = 1;
+        /// <summary>
+        /// Converts a table sorted by normalized boards to a table indexed by HandIsoIndexer:
+        /// the value of each class of boards is looked up by a representative board.
+        /// </summary>
+        static float[] ToIndexedTable(Entry[] entries, int boardSize)
+        {
+            HandIsoIndexer indexer = HandIsoIndexer.GetBoard(boardSize);
+            float[] lut = new float[indexer.Size];
+            int[] board = new int[boardSize];
+            // Normalize suits with the native NormSuit.
+            UInt64[] boards = new UInt64[indexer.Size];
+            UInt64[] seBoards = new UInt64[indexer.Size];
+            for (UInt64 i = 0; i < indexer.Size; ++i)
+            {
+                indexer.Unindex(i, board);
+                boards[i] = StdDeck.Descriptor.GetCardSet(board).bits;
+            }
+            CppLib.NormSuit_ConvertBatch(boards.Length, 1, boards, seBoards);
+            for (UInt64 i = 0; i < indexer.Size; ++i)
+            {
+                Entry searchEntry = new Entry();
+                searchEntry.CardSet = seBoards[i];
+                int idx = Array.BinarySearch(entries, searchEntry);
+                if (idx < 0)
+                {
+                    throw new ApplicationException(string.Format("Cannot find LUT entry for board: '{0}'", 
+                        StdDeck.Descriptor.GetCardNames(new CardSet { bits = boards[i] })));
+                }
+                lut[i] = entries[idx].Ahvo;
+            }
+            return lut;
+        }
 
-        static void WriteLut(Entry[] lut, string path)
+        /// <summary>
+        /// Version 2: a value for each index of HandIsoIndexer, no keys.
+        /// </summary>
+        static readonly int SER_FMT_VER = 2;
+
+        static void WriteLut(float[] lut, string path)
         {
             BdsVersion fileVersion = new BdsVersion();
             BdsVersion assemblyVersion = new BdsVersion(Assembly.GetExecutingAssembly());
@@ -193,26 +225,24 @@ namespace ai.pkr.holdem.strategy.ahvo
                 wr.Write(lut.Length);
                 for (int i = 0; i < lut.Length; ++i)
                 {
-                    wr.Write(lut[i].CardSet);
-                    wr.Write(lut[i].Ahvo);
+                    wr.Write(lut[i]);
                 }
             }
         }
 
-        static Entry[] ReadLut(string path)
+        static float[] ReadLut(string path)
         {
-            Entry[] lut = null;
+            float[] lut = null;
             using (BinaryReader r = new BinaryReader(File.Open(path, FileMode.Open, FileAccess.Read, FileShare.Read)))
             {
                 BdsVersion fileVersion;
                 int serFmtVersion;
                 DataSerializationHelper.ReadHeader(r, out fileVersion, out serFmtVersion, SER_FMT_VER);
                 int count = r.ReadInt32();
-                lut = new Entry[count];
+                lut = new float[count];
                 for (int i = 0; i < count; ++i)
                 {
-                    lut[i].CardSet = r.ReadUInt64();
-                    lut[i].Ahvo = r.ReadSingle();
+                    lut[i] = r.ReadSingle();
                 }
             }
             return lut;
@@ -224,7 +254,12 @@ namespace ai.pkr.holdem.strategy.ahvo
             return Path.Combine(dataDir, string.Format("AHVO-{0}.dat", round));
         }
 
-        static readonly Entry[][] _luts = new Entry[3][];
+        /// <summary>
+        /// Look-up tables for rounds 1 to 3, the value of a board is stored at its index in _indexers[round - 1].
+        /// </summary>
+        static readonly float[][] _luts = new float[3][];
+
+        static readonly HandIsoIndexer[] _indexers = new HandIsoIndexer[3];
 
         #endregion
     }
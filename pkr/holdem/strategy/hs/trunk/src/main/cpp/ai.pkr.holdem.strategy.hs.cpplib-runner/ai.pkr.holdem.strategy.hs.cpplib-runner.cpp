@@ -0,0 +1,460 @@
+// ai.pkr.holdem.strategy.hs.cpplib-runner.cpp : Tests and benchmarks for ai.pkr.holdem.strategy.hs.cpplib.
+//
+// Usage:
+//   ai.pkr.holdem.strategy.hs.cpplib-runner test [temp-dir]
+//       Runs the tests (on synthetic data, no data files are required).
+//   ai.pkr.holdem.strategy.hs.cpplib-runner benchmark-hs <LutEvaluator7.dat> [board-size] [boards]
+//       Calculates HS of all pockets on random boards and compares with the
+//       per-hand enumeration (as in HandStrength.Calculate()).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "ai.pkr.holdem.strategy.hs.cpplib.h"
+#include "hs_engine.h"
+#include <ai.lib.utils.cpp/bds_version.h>
+
+using namespace std;
+using namespace ai::pkr::stdpoker;
+using namespace ai::pkr::holdem::strategy::hs;
+
+static string _tempDir = ".";
+
+#define VERIFY(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); throw "Test failed"; }
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// A simple deterministic RNG (the tests must be reproducible).
+class Rng
+{
+public:
+	Rng(uint64_t seed) : _state(seed * 2862933555777941757ULL + 3037000493ULL)
+	{}
+
+	uint32_t Next(uint32_t n)
+	{
+		_state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (uint32_t)((_state >> 33) % n);
+	}
+private:
+	uint64_t _state;
+};
+
+/// Generates n hands of handLength distinct cards.
+static void GenerateHands(Rng & rng, size_t n, int handLength, vector<int32_t> & cards)
+{
+	cards.resize(n * handLength);
+	for(size_t i = 0; i < n; ++i)
+	{
+		uint64_t used = 0;
+		for(int c = 0; c < handLength; ++c)
+		{
+			int32_t card;
+			do
+			{
+				card = (int32_t)rng.Next(52);
+			} while(used & (1ULL << card));
+			used |= 1ULL << card;
+			cards[i * handLength + c] = card;
+		}
+	}
+}
+
+static void WriteInt32(string & s, uint32_t v)
+{
+	s.append((const char*)&v, 4);
+}
+
+static void WriteString(string & s, const string & v)
+{
+	// Strings are short here, 1-byte length prefix.
+	s.push_back((char)v.size());
+	s.append(v);
+}
+
+/// Writes a LUT file in the format of LutEvaluatorGenerator.SaveLut().
+static string WriteLutFile(const char * name, const vector<uint32_t> & lut)
+{
+	string fields;
+	WriteInt32(fields, 1);
+	WriteInt32(fields, 2);
+	WriteInt32(fields, 3);
+	WriteInt32(fields, 4);
+	WriteString(fields, "scm");
+	WriteString(fields, "build");
+	WriteString(fields, "HsEngine test data");
+	WriteString(fields, "");
+
+	string file;
+	WriteInt32(file, 5);
+	WriteInt32(file, (uint32_t)fields.size());
+	file += fields;
+	WriteInt32(file, ai::lib::utils::bds_version::crc32(fields.data(), fields.size()));
+	WriteInt32(file, lut_evaluator7::LUT_FILE_FORMAT_ID);
+	WriteInt32(file, (uint32_t)lut.size());
+	file.append((const char*)&lut[0], lut.size() * 4);
+
+	string path = _tempDir + "/" + name;
+	FILE * f = fopen(path.c_str(), "wb");
+	VERIFY(f != 0);
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+	return path;
+}
+
+/** Creates a small order-independent LUT (like a real one, the hand engine relies on it).
+The state of level l is the sum of random card weights modulo M, the hand value is
+a function of the sum of 7 cards with a small range, so that there are many ties.
+*/
+static void CreateSetLut(Rng & rng, vector<uint32_t> & lut)
+{
+	const uint32_t M = 997;
+	uint32_t weights[52];
+	for(int c = 0; c < 52; ++c)
+	{
+		weights[c] = rng.Next(M);
+	}
+	uint32_t values[M];
+	for(uint32_t s = 0; s < M; ++s)
+	{
+		values[s] = rng.Next(300) + 1;
+	}
+	// Level 0 has one state, levels 1..6 have M states each.
+	lut.resize((1 + 6 * M) * 52);
+	for(int l = 0; l < 7; ++l)
+	{
+		uint32_t stateCount = l == 0 ? 1 : M;
+		for(uint32_t s = 0; s < stateCount; ++s)
+		{
+			uint32_t state = l == 0 ? 0 : 1 + (l - 1) * M + s;
+			for(int c = 0; c < 52; ++c)
+			{
+				uint32_t sum = (s + weights[c]) % M;
+				lut[state * 52 + c] = l < 6 ? 52 * (1 + l * M + sum) : values[sum];
+			}
+		}
+	}
+}
+
+static uint64_t CountCombin(int n, int k)
+{
+	uint64_t result = 1;
+	for(int i = 1; i <= k; ++i)
+	{
+		result = result * (n - k + i) / i;
+	}
+	return result;
+}
+
+/// Reference implementation, enumerates for one hand like HandStrength.Calculate() (C#).
+static float CalculateRef(const lut_evaluator7 & e, const int32_t * hand, int handLength)
+{
+	uint64_t dead = 0;
+	for(int i = 0; i < handLength; ++i)
+	{
+		dead |= 1ULL << hand[i];
+	}
+	const int boardSize = handLength - 2;
+	uint64_t result = 0;
+	// Deal the missing board cards as combinations, then the opponent pocket.
+	int32_t deck[52];
+	int deckSize = 0;
+	for(int card = 0; card < 52; ++card)
+	{
+		if(!(dead & (1ULL << card)))
+		{
+			deck[deckSize++] = card;
+		}
+	}
+	const int missing = 5 - boardSize;
+	int idx[5] = {0, 1, 2, 3, 4};
+	for(;;)
+	{
+		int32_t cards[7];
+		uint64_t boardDead = dead;
+		for(int i = 0; i < boardSize; ++i)
+		{
+			cards[i] = hand[2 + i];
+		}
+		for(int i = 0; i < missing; ++i)
+		{
+			cards[boardSize + i] = deck[idx[i]];
+			boardDead |= 1ULL << deck[idx[i]];
+		}
+		cards[5] = min(hand[0], hand[1]);
+		cards[6] = max(hand[0], hand[1]);
+		uint32_t heroRank = e.evaluate(cards);
+		for(int o0 = 0; o0 < 52; ++o0)
+		{
+			for(int o1 = o0 + 1; o1 < 52; ++o1)
+			{
+				if(boardDead & ((1ULL << o0) | (1ULL << o1)))
+				{
+					continue;
+				}
+				cards[5] = o0;
+				cards[6] = o1;
+				uint32_t oppRank = e.evaluate(cards);
+				if(heroRank > oppRank)
+				{
+					result += 2;
+				}
+				else if(heroRank == oppRank)
+				{
+					result++;
+				}
+			}
+		}
+		int i = missing - 1;
+		while(i >= 0 && idx[i] == deckSize - missing + i)
+		{
+			--i;
+		}
+		if(i < 0)
+		{
+			break;
+		}
+		++idx[i];
+		for(int j = i + 1; j < missing; ++j)
+		{
+			idx[j] = idx[j - 1] + 1;
+		}
+	}
+	float count = (float)(CountCombin(52 - handLength, missing) * CountCombin(45, 2));
+	return (float)result / count / 2;
+}
+
+static string CreateTestLut()
+{
+	Rng rng(1);
+	vector<uint32_t> lut;
+	CreateSetLut(rng, lut);
+	return WriteLutFile("HsEngine-test.dat", lut);
+}
+
+static void Test_CalculateBoards(const string & lutPath)
+{
+	hs_engine engine;
+	VERIFY(engine.open(lutPath.c_str()));
+	Rng rng(2);
+	for(int boardSize = 5; boardSize >= 3; --boardSize)
+	{
+		const size_t boardCount = 3;
+		vector<int32_t> boards;
+		GenerateHands(rng, boardCount, boardSize, boards);
+		vector<float> hs(boardCount * hs_engine::POCKET_COUNT);
+		engine.calculate_boards(boardSize, boardCount, &boards[0], &hs[0]);
+		for(size_t b = 0; b < boardCount; ++b)
+		{
+			const int32_t * board = &boards[b * boardSize];
+			uint64_t dead = 0;
+			for(int i = 0; i < boardSize; ++i)
+			{
+				dead |= 1ULL << board[i];
+			}
+			int checked = 0;
+			for(int c1 = 1; c1 < 52; ++c1)
+			{
+				for(int c0 = 0; c0 < c1; ++c0)
+				{
+					float value = hs[b * hs_engine::POCKET_COUNT + hs_engine::pocket_index(c0, c1)];
+					if(dead & ((1ULL << c0) | (1ULL << c1)))
+					{
+						VERIFY(value == -1);
+						continue;
+					}
+					// The reference is slow for incomplete boards, check a sample.
+					if(boardSize < 5 && rng.Next(100) != 0)
+					{
+						continue;
+					}
+					int32_t hand[7] = {c1, c0};
+					copy(board, board + boardSize, hand + 2);
+					VERIFY(value == CalculateRef(engine.evaluator(), hand, boardSize + 2));
+					++checked;
+				}
+			}
+			VERIFY(checked > 0);
+		}
+	}
+}
+
+/// The results must not depend on the number of threads.
+static void Test_ThreadCount(const string & lutPath, int boardSize, size_t boardCount)
+{
+	hs_engine engine;
+	VERIFY(engine.open(lutPath.c_str()));
+	Rng rng(3);
+	vector<int32_t> boards;
+	GenerateHands(rng, boardCount, boardSize, boards);
+	vector<float> hs1(boardCount * hs_engine::POCKET_COUNT), hs(boardCount * hs_engine::POCKET_COUNT);
+	engine.set_thread_count(1);
+	engine.calculate_boards(boardSize, boardCount, &boards[0], &hs1[0]);
+	engine.set_thread_count(0);
+	engine.calculate_boards(boardSize, boardCount, &boards[0], &hs[0]);
+	VERIFY(hs == hs1);
+}
+
+static void Test_Calculate(const string & lutPath)
+{
+	HsEngine * e = HsEngine_Open(lutPath.c_str(), 0);
+	VERIFY(e != 0);
+	hs_engine engine;
+	VERIFY(engine.open(lutPath.c_str()));
+	Rng rng(4);
+	// More distinct boards than one chunk, some boards repeated with different pockets.
+	for(int handLength = 7; handLength >= 5; --handLength)
+	{
+		const size_t n = handLength == 7 ? 700 : 20;
+		vector<int32_t> hands;
+		GenerateHands(rng, n, handLength, hands);
+		for(size_t i = 1; i < n; i += 3)
+		{
+			// Same board as the previous hand, board cards in another order.
+			int32_t * prev = &hands[(i - 1) * handLength];
+			int32_t * hand = &hands[i * handLength];
+			copy(prev, prev + handLength, hand);
+			reverse(hand + 2, hand + handLength);
+			for(int c = 0; c < 52; ++c)
+			{
+				if(find(hand, hand + handLength, c) == hand + handLength)
+				{
+					hand[1] = c;
+					break;
+				}
+			}
+		}
+		vector<float> hs(n + 1, 5);
+		VERIFY(HsEngine_Calculate(e, handLength, (uint32_t)n, &hands[0], &hs[0]) == 1);
+		for(size_t i = 0; i < n; ++i)
+		{
+			VERIFY(hs[i] == CalculateRef(engine.evaluator(), &hands[i * handLength], handLength));
+		}
+		VERIFY(hs[n] == 5);
+	}
+	HsEngine_Close(e);
+}
+
+static void Test_BadSize(const string & lutPath)
+{
+	HsEngine * e = HsEngine_Open(lutPath.c_str(), 0);
+	VERIFY(e != 0);
+	int32_t cards[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+	float hs[1] = {5};
+	VERIFY(HsEngine_Calculate(e, 8, 1, cards, hs) == 0);
+	VERIFY(strstr(HsEngine_GetLastError(), "Hand length") != 0);
+	VERIFY(HsEngine_Calculate(e, 1, 1, cards, hs) == 0);
+	VERIFY(HsEngine_CalculateBoards(e, 6, 1, cards, hs) == 0);
+	VERIFY(strstr(HsEngine_GetLastError(), "Board size") != 0);
+	VERIFY(HsEngine_CalculateBoards(e, -1, 1, cards, hs) == 0);
+	VERIFY(hs[0] == 5);
+	HsEngine_Close(e);
+}
+
+static void Test_BadFile()
+{
+	VERIFY(HsEngine_Open((_tempDir + "/no-such-file.dat").c_str(), 0) == 0);
+	VERIFY(strstr(HsEngine_GetLastError(), "no-such-file.dat") != 0);
+}
+
+static int Test()
+{
+	try
+	{
+		string lutPath = CreateTestLut();
+		Test_CalculateBoards(lutPath);
+		// One board (parallel over board completions) and many boards (parallel over boards).
+		Test_ThreadCount(lutPath, 3, 1);
+		Test_ThreadCount(lutPath, 4, 200);
+		Test_Calculate(lutPath);
+		Test_BadSize(lutPath);
+		Test_BadFile();
+		remove(lutPath.c_str());
+	}
+	catch(const char * e)
+	{
+		printf("%s\n", e);
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+
+static int Benchmark_Hs(const char * path, int boardSize, size_t boardCount)
+{
+	hs_engine engine;
+	if(!engine.open(path))
+	{
+		printf("%s\n", engine.error().c_str());
+		return 1;
+	}
+	Rng rng(1);
+	vector<int32_t> boards;
+	GenerateHands(rng, boardCount, boardSize, boards);
+	vector<float> hs(boardCount * hs_engine::POCKET_COUNT);
+
+	double start = Now();
+	engine.calculate_boards(boardSize, boardCount, boards.empty() ? 0 : &boards[0], &hs[0]);
+	double engineTime = Now() - start;
+	size_t pocketCount = boardCount * CountCombin(52 - boardSize, 2);
+	printf("engine:    %u boards of %d cards, %.3f s, %.1f pockets/s\n",
+		(unsigned)boardCount, boardSize, engineTime, pocketCount / engineTime);
+
+	// Per-hand enumeration on a few pockets of the first board.
+	const int refCount = boardSize >= 4 ? 50 : (boardSize == 3 ? 5 : 1);
+	double checksum = 0;
+	start = Now();
+	int done = 0;
+	for(int c1 = 1; c1 < 52 && done < refCount; ++c1)
+	{
+		for(int c0 = 0; c0 < c1 && done < refCount; ++c0)
+		{
+			int32_t hand[7] = {c0, c1};
+			copy(boards.begin(), boards.begin() + boardSize, hand + 2);
+			if(find(hand + 2, hand + 2 + boardSize, c0) != hand + 2 + boardSize ||
+				find(hand + 2, hand + 2 + boardSize, c1) != hand + 2 + boardSize)
+			{
+				continue;
+			}
+			float value = CalculateRef(engine.evaluator(), hand, boardSize + 2);
+			checksum += value;
+			if(value != hs[hs_engine::pocket_index(c0, c1)])
+			{
+				printf("Mismatch for pocket %d %d: %f != %f\n", c0, c1, value, hs[hs_engine::pocket_index(c0, c1)]);
+				return 1;
+			}
+			++done;
+		}
+	}
+	double refTime = Now() - start;
+	printf("per-hand:  %d pockets, %.3f s, %.1f pockets/s, checksum: %f\n", done, refTime, done / refTime, checksum);
+	printf("Speedup: %.1f\n", (pocketCount / engineTime) / (done / refTime));
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "test") == 0)
+	{
+		if(argc >= 3)
+		{
+			_tempDir = argv[2];
+		}
+		return Test();
+	}
+	if(argc >= 3 && strcmp(argv[1], "benchmark-hs") == 0)
+	{
+		return Benchmark_Hs(argv[2], argc >= 4 ? atoi(argv[3]) : 3, argc >= 5 ? (size_t)atol(argv[4]) : 100);
+	}
+	printf("Usage:\n"
+		"%s test [temp-dir]\n"
+		"%s benchmark-hs LutEvaluator7.dat [board-size] [boards]\n", argv[0], argv[0]);
+	return 1;
+}
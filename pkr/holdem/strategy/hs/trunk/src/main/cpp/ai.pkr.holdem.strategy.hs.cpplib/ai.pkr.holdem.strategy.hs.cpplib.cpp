@@ -0,0 +1,77 @@
+// ai.pkr.holdem.strategy.hs.cpplib.cpp : Defines the exported functions of the library.
+//
+
+#include <string>
+#include "ai.pkr.holdem.strategy.hs.cpplib.h"
+#include "hs_engine.h"
+
+using namespace ai::pkr::holdem::strategy::hs;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL char _lastError[256];
+
+static void SetError(const std::string & error)
+{
+	std::size_t length = error.copy(_lastError, sizeof(_lastError) - 1);
+	_lastError[length] = 0;
+}
+
+struct HsEngine
+{
+	hs_engine engine;
+};
+
+extern "C"
+{
+
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API HsEngine * HsEngine_Open(const char * lutPath, int threadCount)
+{
+	HsEngine * e = new HsEngine;
+	if(!e->engine.open(lutPath))
+	{
+		SetError(e->engine.error());
+		delete e;
+		return 0;
+	}
+	e->engine.set_thread_count(threadCount);
+	return e;
+}
+
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API void HsEngine_Close(HsEngine * e)
+{
+	delete e;
+}
+
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API const char * HsEngine_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API int HsEngine_CalculateBoards(const HsEngine * e, int boardSize, uint32_t boardCount,
+	const int32_t * boards, float * hs)
+{
+	if(!e->engine.calculate_boards(boardSize, boardCount, boards, hs))
+	{
+		SetError("Board size must be 0..5, was " + std::to_string(boardSize));
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API int HsEngine_Calculate(const HsEngine * e, int handLength, uint32_t n,
+	const int32_t * hands, float * hs)
+{
+	if(!e->engine.calculate(handLength, n, hands, hs))
+	{
+		SetError("Hand length must be 2..7, was " + std::to_string(handLength));
+		return 0;
+	}
+	return 1;
+}
+
+}
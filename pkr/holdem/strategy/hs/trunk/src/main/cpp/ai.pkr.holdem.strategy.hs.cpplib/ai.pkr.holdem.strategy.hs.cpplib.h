@@ -0,0 +1,64 @@
+// C interface of ai.pkr.holdem.strategy.hs.cpplib (ai.pkr.holdem.strategy.hs.cpplib.dll on Windows,
+// libai.pkr.holdem.strategy.hs.cpplib.so on Linux). Used by ai.pkr.holdem.strategy.hs.CppLib (C#).
+//
+// All files within this library are compiled with the AIPKRHOLDEMSTRATEGYHSCPPLIB_EXPORTS
+// symbol defined. This symbol should not be defined on any project
+// that uses this library. This way any other project whose source files include
+// this file see AIPKRHOLDEMSTRATEGYHSCPPLIB_API functions as being imported, whereas the library
+// sees symbols defined with this macro as being exported.
+
+#ifndef AI_PKR_HOLDEM_STRATEGY_HS_CPPLIB_H
+#define AI_PKR_HOLDEM_STRATEGY_HS_CPPLIB_H
+
+#if defined(_WIN32)
+	#ifdef AIPKRHOLDEMSTRATEGYHSCPPLIB_EXPORTS
+		#define AIPKRHOLDEMSTRATEGYHSCPPLIB_API __declspec(dllexport)
+	#else
+		#define AIPKRHOLDEMSTRATEGYHSCPPLIB_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AIPKRHOLDEMSTRATEGYHSCPPLIB_API __attribute__((visibility("default")))
+#else
+	#define AIPKRHOLDEMSTRATEGYHSCPPLIB_API
+#endif
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Opaque handle of a hand strength engine.
+typedef struct HsEngine HsEngine;
+
+/// Number of pockets in the results of HsEngine_CalculateBoards().
+#define HS_ENGINE_POCKET_COUNT 1326
+
+/// Creates an engine using LutEvaluator7.dat, threadCount 0 uses all cores.
+/// Returns 0 on error, see HsEngine_GetLastError().
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API HsEngine * HsEngine_Open(const char * lutPath, int threadCount);
+
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API void HsEngine_Close(HsEngine * e);
+
+/// Description of the last error of HsEngine_Open(), HsEngine_CalculateBoards() or HsEngine_Calculate()
+/// in this thread.
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API const char * HsEngine_GetLastError();
+
+/// Calculates HS of all pockets on boardCount boards of boardSize (0..5) cards, board b is
+/// boards[boardSize*b .. boardSize*b+boardSize-1]. HS of pocket (c0 < c1) is stored to
+/// hs[HS_ENGINE_POCKET_COUNT*b + c1*(c1-1)/2 + c0], pockets intersecting the board get -1.
+/// Returns 0 if boardSize is out of range, see HsEngine_GetLastError().
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API int HsEngine_CalculateBoards(const HsEngine * e, int boardSize, uint32_t boardCount,
+	const int32_t * boards, float * hs);
+
+/// Calculates HS of n hands (pocket followed by the board) of handLength (2..7) cards,
+/// hand i is hands[handLength*i .. handLength*i+handLength-1], the result is stored to hs[i].
+/// Returns 0 if handLength is out of range, see HsEngine_GetLastError().
+AIPKRHOLDEMSTRATEGYHSCPPLIB_API int HsEngine_Calculate(const HsEngine * e, int handLength, uint32_t n,
+	const int32_t * hands, float * hs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <vector>
+#include "hs_engine.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace ai::pkr::stdpoker;
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace holdem
+		{
+			namespace strategy
+			{
+				namespace hs
+				{
+
+					static uint64_t CountCombin(int n, int k)
+					{
+						uint64_t result = 1;
+						for(int i = 1; i <= k; ++i)
+						{
+							result = result * (n - k + i) / i;
+						}
+						return result;
+					}
+
+					static int ThreadCount(int threadCount)
+					{
+#ifdef _OPENMP
+						return threadCount > 0 ? threadCount : omp_get_max_threads();
+#else
+						return 1;
+#endif
+					}
+
+					/// Packs all k-combinations of cards[0..n-1] (6 bits per card, ascending).
+					static void Combin(const int32_t * cards, int n, int k, std::vector<uint32_t> & result)
+					{
+						result.clear();
+						int idx[5];
+						for(int i = 0; i < k; ++i)
+						{
+							idx[i] = i;
+						}
+						for(;;)
+						{
+							uint32_t packed = 0;
+							for(int i = 0; i < k; ++i)
+							{
+								packed |= (uint32_t)cards[idx[i]] << (6 * i);
+							}
+							result.push_back(packed);
+							int i = k - 1;
+							while(i >= 0 && idx[i] == n - k + i)
+							{
+								--i;
+							}
+							if(i < 0)
+							{
+								break;
+							}
+							++idx[i];
+							for(int j = i + 1; j < k; ++j)
+							{
+								idx[j] = idx[j - 1] + 1;
+							}
+						}
+					}
+
+					bool hs_engine::open(const char * lut_path)
+					{
+						if(!_evaluator.open(lut_path))
+						{
+							_error = _evaluator.error();
+							return false;
+						}
+						return true;
+					}
+
+					void hs_engine::close()
+					{
+						_evaluator.close();
+					}
+
+					bool hs_engine::calculate_boards(int board_size, std::size_t board_count, const int32_t * boards, float * hs) const
+					{
+						if(board_size < 0 || board_size > 5)
+						{
+							return false;
+						}
+						int threadCount = ThreadCount(_thread_count);
+						if(board_count >= (std::size_t)(4 * threadCount))
+						{
+							// Enough boards to keep all threads busy, calculate each board in one thread.
+							long count = (long)board_count;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threadCount)
+#endif
+							for(long b = 0; b < count; ++b)
+							{
+								calculate_board(board_size, boards + board_size * b, false, hs + (std::size_t)POCKET_COUNT * b);
+							}
+						}
+						else
+						{
+							for(std::size_t b = 0; b < board_count; ++b)
+							{
+								calculate_board(board_size, boards + board_size * b, true, hs + (std::size_t)POCKET_COUNT * b);
+							}
+						}
+						return true;
+					}
+
+					bool hs_engine::calculate(int hand_length, std::size_t n, const int32_t * hands, float * hs) const
+					{
+						if(hand_length < 2 || hand_length > 7)
+						{
+							return false;
+						}
+						const int boardSize = hand_length - 2;
+						// Sort the hands by the board (cards ascending, packed like in Combin()).
+						std::vector<std::pair<uint32_t, uint32_t> > order(n);
+						for(std::size_t i = 0; i < n; ++i)
+						{
+							int32_t board[5];
+							std::copy(hands + hand_length * i + 2, hands + hand_length * (i + 1), board);
+							std::sort(board, board + boardSize);
+							uint32_t packed = 0;
+							for(int c = 0; c < boardSize; ++c)
+							{
+								packed |= (uint32_t)board[c] << (6 * c);
+							}
+							order[i] = std::make_pair(packed, (uint32_t)i);
+						}
+						std::sort(order.begin(), order.end());
+
+						// Calculate distinct boards in chunks, this limits the memory for the results.
+						const std::size_t CHUNK = 256;
+						std::vector<int32_t> boards;
+						std::vector<float> results;
+						for(std::size_t begin = 0; begin < n; )
+						{
+							boards.clear();
+							std::size_t end = begin;
+							for(; end < n; ++end)
+							{
+								if(end == begin || order[end].first != order[end - 1].first)
+								{
+									if(boards.size() == CHUNK * boardSize && boardSize > 0)
+									{
+										break;
+									}
+									for(int c = 0; c < boardSize; ++c)
+									{
+										boards.push_back((order[end].first >> (6 * c)) & 63);
+									}
+								}
+							}
+							std::size_t boardCount = boardSize > 0 ? boards.size() / boardSize : 1;
+							results.resize(boardCount * POCKET_COUNT);
+							calculate_boards(boardSize, boardCount, boards.empty() ? 0 : &boards[0], &results[0]);
+							std::size_t b = 0;
+							for(std::size_t i = begin; i < end; ++i)
+							{
+								if(i > begin && order[i].first != order[i - 1].first)
+								{
+									++b;
+								}
+								const int32_t * hand = hands + hand_length * order[i].second;
+								hs[order[i].second] = results[POCKET_COUNT * b + pocket_index(hand[0], hand[1])];
+							}
+							begin = end;
+						}
+						return true;
+					}
+
+					void hs_engine::calculate_board(int board_size, const int32_t * board, bool parallel, float * hs) const
+					{
+						uint64_t dead = 0;
+						uint32_t state = 0;
+						for(int i = 0; i < board_size; ++i)
+						{
+							dead |= 1ULL << board[i];
+							state = _evaluator.entry(state + board[i]);
+						}
+						int32_t live[52];
+						int liveCount = 0;
+						for(int c = 0; c < 52; ++c)
+						{
+							if(!(dead & (1ULL << c)))
+							{
+								live[liveCount++] = c;
+							}
+						}
+
+						const int missing = 5 - board_size;
+						std::vector<uint32_t> completions;
+						Combin(live, liveCount, missing, completions);
+						const long completionCount = (long)completions.size();
+
+						std::vector<uint64_t> acc(POCKET_COUNT, 0);
+#ifdef _OPENMP
+#pragma omp parallel if(parallel) num_threads(ThreadCount(_thread_count))
+#endif
+						{
+							std::vector<uint64_t> threadAcc(POCKET_COUNT, 0);
+							showdown_kernel kernel;
+							std::vector<int32_t> cards(2 * MAX_POCKETS);
+							std::vector<uint32_t> ranks(MAX_POCKETS);
+							int32_t full[5];
+							std::copy(board, board + board_size, full);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+							for(long r = 0; r < completionCount; ++r)
+							{
+								uint32_t fullState = state;
+								for(int i = 0; i < missing; ++i)
+								{
+									full[board_size + i] = (completions[r] >> (6 * i)) & 63;
+									fullState = _evaluator.entry(fullState + full[board_size + i]);
+								}
+								accumulate(fullState, full, kernel, &cards[0], &ranks[0], &threadAcc[0]);
+							}
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+							for(int p = 0; p < POCKET_COUNT; ++p)
+							{
+								acc[p] += threadAcc[p];
+							}
+						}
+
+						// The same formula as in HandStrength.Calculate(), to get the same floats.
+						const float count = (float)(CountCombin(52 - 2 - board_size, missing) * CountCombin(45, 2));
+						for(int c1 = 1; c1 < 52; ++c1)
+						{
+							for(int c0 = 0; c0 < c1; ++c0)
+							{
+								int p = pocket_index(c0, c1);
+								hs[p] = (dead & ((1ULL << c0) | (1ULL << c1))) ? -1.0f : (float)acc[p] / count / 2;
+							}
+						}
+					}
+
+					/** Adds 2 * wins + ties of each pocket on the complete board to acc.
+					state is the LUT state after the 5 board cards, kernel, cards (2 * MAX_POCKETS)
+					and ranks (MAX_POCKETS) are per-thread buffers.
+					*/
+					void hs_engine::accumulate(uint32_t state, const int32_t * board, showdown_kernel & kernel,
+						int32_t * cards, uint32_t * ranks, uint64_t * acc) const
+					{
+						uint64_t dead = 0;
+						for(int i = 0; i < 5; ++i)
+						{
+							dead |= 1ULL << board[i];
+						}
+						int32_t live[47];
+						uint32_t states[47];
+						int liveCount = 0;
+						for(int c = 0; c < 52; ++c)
+						{
+							if(!(dead & (1ULL << c)))
+							{
+								live[liveCount] = c;
+								states[liveCount] = _evaluator.entry(state + c);
+								++liveCount;
+							}
+						}
+
+						int pocketCount = 0;
+						for(int i0 = 0; i0 < liveCount - 1; ++i0)
+						{
+							for(int i1 = i0 + 1; i1 < liveCount; ++i1)
+							{
+								cards[2 * pocketCount] = live[i0];
+								cards[2 * pocketCount + 1] = live[i1];
+								ranks[pocketCount++] = _evaluator.entry(states[i0] + live[i1]);
+							}
+						}
+						kernel.set_hands(2, pocketCount, cards, ranks);
+
+						// Each opponent pocket is counted once: reach 1.
+						uint64_t ones[MAX_POCKETS], wins[MAX_POCKETS], ties[MAX_POCKETS];
+						std::fill(ones, ones + pocketCount, 1);
+						kernel.evaluate(ones, wins, ties, (uint64_t *)0);
+						for(int p = 0; p < pocketCount; ++p)
+						{
+							acc[pocket_index(cards[2 * p], cards[2 * p + 1])] += 2 * wins[p] + ties[p];
+						}
+					}
+
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#ifndef AI_PKR_HOLDEM_STRATEGY_HS_CPPLIB_HS_ENGINE_H
+#define AI_PKR_HOLDEM_STRATEGY_HS_CPPLIB_HS_ENGINE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <lut_evaluator7.h>
+#include <showdown_kernel.h>
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace holdem
+		{
+			namespace strategy
+			{
+				namespace hs
+				{
+
+					/** Hand strength calculator, native version of HandStrength.Calculate() (C#).
+					HS = (2 * wins + ties) / (2 * (wins + ties + loses)) against all opponent pockets
+					over all completions of the board.
+
+					The managed version enumerates the board completions and the opponent pockets for each
+					hero pocket separately. This engine calculates all pockets of a board at once:
+					for each complete 5-card board the ranks of all 1081 remaining pockets are evaluated
+					(2 lookups each, the board part of the chain is shared), sorted, and every pocket gets its
+					wins and ties from one sweep over the rank groups. The lookup and sort costs are shared by all
+					hero pockets, which is what makes the precalculation of the HS tables fast.
+
+					Boards are processed in parallel with OpenMP (if available). The results are accumulated in
+					integers, so they do not depend on the number of threads.
+
+					The LUT must be order-independent (a real LutEvaluator7.dat). The chain order used is:
+					board cards as given, missing board cards ascending, pocket cards ascending.
+					*/
+					class hs_engine
+					{
+					public:
+
+						/// Number of 2-card pockets, see pocket_index().
+						static const int POCKET_COUNT = 1326;
+
+						hs_engine() : _thread_count(0)
+						{
+						}
+
+						/** Loads the LUT file (LutEvaluator7.dat).
+						@return false on error, see error().
+						*/
+						bool open(const char * lut_path);
+
+						void close();
+
+						/// Description of the last error.
+						const std::string & error() const
+						{
+							return _error;
+						}
+
+						/// The evaluator used by the engine.
+						const ai::pkr::stdpoker::lut_evaluator7 & evaluator() const
+						{
+							return _evaluator;
+						}
+
+						/// Number of threads, 0 (default) lets OpenMP decide.
+						void set_thread_count(int thread_count)
+						{
+							_thread_count = thread_count;
+						}
+
+						/// Index of the pocket of cards c0 != c1 in the results of calculate_boards().
+						static int pocket_index(int c0, int c1)
+						{
+							if(c0 > c1)
+							{
+								int t = c0; c0 = c1; c1 = t;
+							}
+							return c1 * (c1 - 1) / 2 + c0;
+						}
+
+						/** Calculates HS of all pockets for each of board_count boards of board_size (0..5) cards.
+						The cards of board b are boards[board_size * b .. board_size * b + board_size - 1],
+						HS of the pocket (c0, c1) is stored to hs[POCKET_COUNT * b + pocket_index(c0, c1)],
+						pockets intersecting the board get -1.
+						@return false if board_size is out of range, nothing is calculated.
+						*/
+						bool calculate_boards(int board_size, std::size_t board_count, const int32_t * boards, float * hs) const;
+
+						/** Calculates HS of n hands of hand_length (2..7) cards each: pocket followed by the board,
+						hand i is hands[hand_length * i .. hand_length * i + hand_length - 1].
+						Hands are grouped by board, each distinct board is calculated once for all pockets.
+						Therefore this pays off if there are many pockets per board, or for preflop and flop
+						where the cost of a board is only slightly higher than the cost of one managed calculation.
+						@return false if hand_length is out of range, nothing is calculated.
+						*/
+						bool calculate(int hand_length, std::size_t n, const int32_t * hands, float * hs) const;
+
+					private:
+
+						/// Number of opponent pockets on a complete board.
+						static const int MAX_POCKETS = 47 * 46 / 2;
+
+						void calculate_board(int board_size, const int32_t * board, bool parallel, float * hs) const;
+
+						void accumulate(uint32_t state, const int32_t * board, ai::pkr::stdpoker::showdown_kernel & kernel,
+							int32_t * cards, uint32_t * ranks, uint64_t * acc) const;
+
+						ai::pkr::stdpoker::lut_evaluator7 _evaluator;
+						int _thread_count;
+						std::string _error;
+					};
+
+				}
+			}
+		}
+	}
+}
+
+#endif
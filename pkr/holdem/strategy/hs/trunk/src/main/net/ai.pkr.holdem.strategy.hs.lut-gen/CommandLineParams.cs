@@ -19,5 +19,9 @@ namespace ai.pkr.holdem.strategy.hs.lut_gen
         [Argument(ArgumentType.AtMostOnce, LongName = "output-dir", ShortName = "o",
         DefaultValue = "${bds.DataDir}", HelpText = "Output directory.")]
         public PropString OutputDir = "";
+
+        [Argument(ArgumentType.AtMostOnce, LongName = "managed", ShortName = "",
+        DefaultValue = false, HelpText = "Use the managed calculation instead of the native engine (takes hours).")]
+        public bool Managed = false;
     }
 }
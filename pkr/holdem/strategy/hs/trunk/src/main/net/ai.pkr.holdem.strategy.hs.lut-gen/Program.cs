@@ -20,7 +20,7 @@ namespace ai.pkr.holdem.strategy.hs.lut_gen
 
         /// <summary>
         /// Calculate LUTs for class HandStrength.
-        /// It takes a long time (~ 10 hours) to run.
+        /// With the native engine it takes some minutes, with the managed calculation (--managed) ~ 10 hours.
         /// </summary>
         static int Main(string[] args)
         {
@@ -41,8 +41,8 @@ namespace ai.pkr.holdem.strategy.hs.lut_gen
             Directory.CreateDirectory(dataDir);
 
             DateTime startTime = DateTime.Now;
-            Console.WriteLine("Start time {0}, will take some hours to finish.", startTime);
-            HandStrength.PrecalcuateTables(dataDir, -1);
+            Console.WriteLine("Start time {0}, will take some {1} to finish.", startTime, _cmdLine.Managed ? "hours" : "minutes");
+            HandStrength.PrecalcuateTables(dataDir, -1, !_cmdLine.Managed);
             TimeSpan time = DateTime.Now - startTime;
             Console.WriteLine("Calculated in {0} s", time.TotalSeconds);
 
@@ -0,0 +1,131 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+using ai.lib.utils;
+using System.Reflection;
+using System.IO;
+using ai.pkr.stdpoker;
+
+namespace ai.pkr.holdem.strategy.hs
+{
+    /// <summary>
+    /// Wrapper for the native library ai.pkr.holdem.strategy.hs.cpplib.
+    /// </summary>
+    public unsafe class CppLib
+    {
+        #region HsEngine
+
+        /// <summary>
+        /// Number of pockets in the results of HsEngine_CalculateBoards().
+        /// </summary>
+        public const int HsEnginePocketCount = 1326;
+
+        /// <summary>
+        /// Creates a hand strength engine using LutEvaluator7.dat, threadCount 0 uses all cores.
+        /// Returns a handle or IntPtr.Zero on error (see HsEngine_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.holdem.strategy.hs.cpplib.dll")]
+        public static extern IntPtr HsEngine_Open(string lutPath, int threadCount);
+
+        [DllImport("ai.pkr.holdem.strategy.hs.cpplib.dll")]
+        public static extern void HsEngine_Close(IntPtr e);
+
+        [DllImport("ai.pkr.holdem.strategy.hs.cpplib.dll")]
+        public static extern IntPtr HsEngine_GetLastError();
+
+        /// <summary>
+        /// Calculates HS of all pockets on boardCount boards of boardSize (0..5) cards, board b is
+        /// boards[boardSize*b .. boardSize*b+boardSize-1]. HS of pocket (c0 &lt; c1) is stored to
+        /// hs[HsEnginePocketCount*b + HsEnginePocketIndex(c0, c1)], pockets intersecting the board get -1.
+        /// Returns 0 if boardSize is out of range (see HsEngine_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.holdem.strategy.hs.cpplib.dll")]
+        public static extern int HsEngine_CalculateBoards(IntPtr e, int boardSize, UInt32 boardCount, int* boards, float* hs);
+
+        /// <summary>
+        /// Calculates HS of n hands (pocket followed by the board) of handLength (2..7) cards,
+        /// hand i is hands[handLength*i .. handLength*i+handLength-1], the result is stored to hs[i].
+        /// Hands with the same board share the calculation.
+        /// Returns 0 if handLength is out of range (see HsEngine_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.holdem.strategy.hs.cpplib.dll")]
+        public static extern int HsEngine_Calculate(IntPtr e, int handLength, UInt32 n, int* hands, float* hs);
+
+        /// <summary>
+        /// Index of pocket (c0, c1) in the results of HsEngine_CalculateBoards().
+        /// </summary>
+        public static int HsEnginePocketIndex(int c0, int c1)
+        {
+            if (c0 > c1)
+            {
+                int t = c0; c0 = c1; c1 = t;
+            }
+            return c1 * (c1 - 1) / 2 + c0;
+        }
+
+        /// <summary>
+        /// Opens an engine with the default LUT (LutEvaluator7.LutPath) and all cores, 
+        /// throws an exception on error.
+        /// </summary>
+        public static IntPtr HsEngine_Open()
+        {
+            IntPtr e = HsEngine_Open(LutEvaluator7.LutPath, 0);
+            if (e == IntPtr.Zero)
+            {
+                throw new ApplicationException(Marshal.PtrToStringAnsi(HsEngine_GetLastError()));
+            }
+            return e;
+        }
+
+        #endregion
+
+        [DllImport("libdl.so.2")]
+        static extern IntPtr dlopen(string fileName, int flags);
+
+        public static void Init()
+        {
+            bool isUnix = Environment.OSVersion.Platform == PlatformID.Unix;
+            string platform = isUnix ? (System.IntPtr.Size == 8 ? "linux64" : "linux32")
+                : (System.IntPtr.Size == 8 ? "win64" : "win32");
+            string codeBase = CodeBase.Get(Assembly.GetExecutingAssembly());
+            string dllDir = Path.Combine(Path.GetDirectoryName(codeBase), platform);
+
+            string dllName = isUnix ? "libai.pkr.holdem.strategy.hs.cpplib.so" : "ai.pkr.holdem.strategy.hs.cpplib.dll";
+
+            string dllPath = Path.Combine(dllDir, dllName);
+
+            if (!System.IO.File.Exists(dllPath))
+            {
+                // In case we are in development folder (debug or release) try to load from bin.   
+                dllDir = Props.Global.Expand("${bds.BinDir}") + platform;
+                dllPath = Path.Combine(dllDir, dllName);
+                if (!System.IO.File.Exists(dllPath))
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+            }
+            if (isUnix)
+            {
+                // Load by full path, the DllImports are then resolved by the soname 
+                // (see the dllmap in ai.pkr.holdem.strategy.hs.dll.config).
+                const int RTLD_NOW = 2, RTLD_GLOBAL = 0x100;
+                if (dlopen(dllPath, RTLD_NOW | RTLD_GLOBAL) == IntPtr.Zero)
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+                return;
+            }
+            string envPath = Environment.GetEnvironmentVariable("PATH");
+            string envPathL = envPath.ToLower() + ";";
+            if (envPathL.IndexOf(dllDir.ToLower() + ";") < 0)
+            {
+                Environment.SetEnvironmentVariable("PATH", dllDir + ";" + envPath, EnvironmentVariableTarget.Process);
+            }
+        }
+    }
+}
@@ -39,14 +39,25 @@ namespace ai.pkr.holdem.strategy.hs
 
         static readonly string DATA_SUBDIR = "ai.pkr.holdem.strategy.hs-lut";
 
+        /// <summary>
+        /// Number of hands normalized by one call of the native NormSuit in the precalculation.
+        /// </summary>
+        const int NORM_SUIT_CHUNK = 1 << 16;
+
         // Version of precalculated files, should be the same as the version
         // of hs-lut pom.
-        private static readonly BdsVersion Version = new BdsVersion(1, 1, 1);
+        private static readonly BdsVersion Version = new BdsVersion(1, 3, 0);
 
         /// <summary>
         /// Look-up tables for each round from 0 to 2, round 3 is too large.
+        /// HS of a hand is stored at the index of the hand in _indexers[round].
+        /// </summary>
+        private static float[][] _luts = new float[3][];
+
+        /// <summary>
+        /// Indexers of pocket + board for each round from 0 to 2.
         /// </summary>
-        private static Entry[][] _luts = new Entry[3][];   
+        private static HandIsoIndexer[] _indexers = new HandIsoIndexer[3];
 
         /// <summary>
         /// Load precalcuation table for fast calculation.
@@ -59,7 +70,8 @@ namespace ai.pkr.holdem.strategy.hs
             dataDir = Path.Combine(dataDir, DATA_SUBDIR);
             for (int r = 0; r < 3; ++r)
             {
-                _luts[r] = ReadTable(Path.Combine(dataDir, _lutNames[r]));
+                _indexers[r] = HandIsoIndexer.GetPocketBoard(HeHelper.RoundToHandSize[r] - 2);
+                _luts[r] = ReadTable(Path.Combine(dataDir, _lutNames[r]), _indexers[r]);
             }
         }
 
@@ -102,10 +114,15 @@ namespace ai.pkr.holdem.strategy.hs
             if (handLength == 7)
                 return Calculate(hand, handLength);
 
-            CardSet pocket = StdDeck.Descriptor.GetCardSet(hand, 0, 2);
-            CardSet board = StdDeck.Descriptor.GetCardSet(hand, 2, handLength - 2);
-
-            return CalculateFast(pocket, board, handLength);
+            if (_luts[1] == null)
+            {
+                LoadPrecalculationTables();
+            }
+            int round = HeHelper.HandSizeToRound[handLength];
+            fixed (int* pHand = hand)
+            {
+                return _luts[round][_indexers[round].Index(pHand)];
+            }
         }
 
         public static float CalculateFast(CardSet pocket, CardSet board)
@@ -125,25 +142,10 @@ namespace ai.pkr.holdem.strategy.hs
 
         private static float CalculateFast(CardSet pocket, CardSet board, int handLength)
         {
-            if (_luts[1] == null)
-            {
-                LoadPrecalculationTables();
-            }
-
-            int round = HeHelper.HandSizeToRound[handLength];
-            Entry[] lookup = _luts[round];
-
-            NormSuit se = new NormSuit();
-            CardSet sePocket = se.Convert(pocket);
-            CardSet seBoard = se.Convert(board);
-            Entry keyEntry = new Entry(HePocket.CardSetToKind(sePocket), seBoard);
-            int idx = Array.BinarySearch<Entry>(lookup, keyEntry);
-            if (idx < 0)
-            {
-                throw new ApplicationException(String.Format("No entry in lookup table for pocket {{{0}}} board {{{1}}}",
-                                                             sePocket, seBoard));
-            }
-            return lookup[idx].value;
+            int[] hand = new int[handLength];
+            StdDeck.Descriptor.GetIndexesAscending(pocket).CopyTo(hand, 0);
+            StdDeck.Descriptor.GetIndexesAscending(board).CopyTo(hand, 2);
+            return CalculateFast(hand, handLength);
         }
 
         /// <summary>
@@ -166,13 +168,13 @@ namespace ai.pkr.holdem.strategy.hs
                 LoadPrecalculationTables();
             }
 
-            Entry[] lookup = _luts[round];
+            float[] lookup = _luts[round];
             min = float.MaxValue;
             max = float.MinValue;
             for(int i = 0; i < lookup.Length; ++i)
             {
-                min = Math.Min(min, lookup[i].value);
-                max = Math.Max(max, lookup[i].value);
+                min = Math.Min(min, lookup[i]);
+                max = Math.Max(max, lookup[i]);
             }
         }
 
@@ -281,9 +283,51 @@ namespace ai.pkr.holdem.strategy.hs
             public int count = 0;
             public NormSuit pocketSei = new NormSuit();
             public List<Entry> list;
+            /// <summary>
+            /// If false, only the keys are created, the values are calculated later.
+            /// </summary>
+            public bool calculateValues = true;
+        }
+
+        /// <summary>
+        /// Converts a table sorted by keys to a table indexed by HandIsoIndexer:
+        /// the value of each class of hands is looked up by a representative hand.
+        /// </summary>
+        static float[] ToIndexedTable(List<Entry> list, int boardSize)
+        {
+            HandIsoIndexer indexer = HandIsoIndexer.GetPocketBoard(boardSize);
+            float[] table = new float[indexer.Size];
+            int[] hand = new int[indexer.HandSize];
+            // Normalize suits of pocket and board with the native NormSuit in chunks.
+            UInt64[] parts = new UInt64[2 * NORM_SUIT_CHUNK];
+            UInt64[] seParts = new UInt64[2 * NORM_SUIT_CHUNK];
+            for (UInt64 begin = 0; begin < indexer.Size; begin += NORM_SUIT_CHUNK)
+            {
+                int count = (int)Math.Min(NORM_SUIT_CHUNK, indexer.Size - begin);
+                for (int j = 0; j < count; ++j)
+                {
+                    indexer.Unindex(begin + (UInt64)j, hand);
+                    parts[2 * j] = StdDeck.Descriptor.GetCardSet(hand, 0, 2).bits;
+                    parts[2 * j + 1] = StdDeck.Descriptor.GetCardSet(hand, 2, boardSize).bits;
+                }
+                ai.pkr.stdpoker.CppLib.NormSuit_ConvertBatch(count, 2, parts, seParts);
+                for (int j = 0; j < count; ++j)
+                {
+                    CardSet sePocket = new CardSet { bits = seParts[2 * j] };
+                    CardSet seBoard = new CardSet { bits = seParts[2 * j + 1] };
+                    int idx = list.BinarySearch(new Entry(HePocket.CardSetToKind(sePocket), seBoard));
+                    if (idx < 0)
+                    {
+                        throw new ApplicationException(String.Format("No entry in lookup table for pocket {{{0}}} board {{{1}}}",
+                                                                     sePocket, seBoard));
+                    }
+                    table[begin + (UInt64)j] = list[idx].value;
+                }
+            }
+            return table;
         }
 
-        static void WriteTable(List<Entry> table, string path)
+        static void WriteTable(float[] table, string path)
         {
             BdsVersion fileVersion = new BdsVersion(Version);
             BdsVersion assemblyVersion = new BdsVersion(Assembly.GetExecutingAssembly());
@@ -292,18 +336,17 @@ namespace ai.pkr.holdem.strategy.hs
             using(BinaryWriter wr = new BinaryWriter(File.Open(path, FileMode.Create)))
             {
                 fileVersion.Write(wr);
-                wr.Write(table.Count);
-                for(int i = 0; i < table.Count; ++i)
+                wr.Write(table.Length);
+                for(int i = 0; i < table.Length; ++i)
                 {
-                    wr.Write(table[i].key);
-                    wr.Write(table[i].value);
+                    wr.Write(table[i]);
                 }
             }
         }
 
-        static Entry[] ReadTable(string path)
+        static float[] ReadTable(string path, HandIsoIndexer indexer)
         {
-            Entry[] table = null;
+            float[] table = null;
             using (BinaryReader r = new BinaryReader(File.Open(path, FileMode.Open, FileAccess.Read, FileShare.Read)))
             {
                 BdsVersion fileVersion = new BdsVersion();
@@ -317,19 +360,23 @@ namespace ai.pkr.holdem.strategy.hs
                                       Version, fileVersion, path));
                 }
                 int count = r.ReadInt32();
-                table = new Entry[count];
+                if ((UInt64)count != indexer.Size)
+                {
+                    throw new ApplicationException(
+                        String.Format("Wrong table size: expected: {0}, was: {1}, file: {2}", indexer.Size, count, path));
+                }
+                table = new float[count];
 
                 for (int i = 0; i < count; ++i)
                 {
-                    table[i].key = r.ReadUInt32();
-                    table[i].value = r.ReadSingle();
+                    table[i] = r.ReadSingle();
                 }
             }
             return table;
         }
 
         /// <summary>
-        /// Precalculate tables. 
+        /// Precalculate tables with the managed calculation. 
         /// <remarks>Long-running (~10 hours).
         /// </remarks>
         /// </summary>
@@ -337,6 +384,22 @@ namespace ai.pkr.holdem.strategy.hs
         /// and files will be stored there.</param>
         /// <param name="round">Calculate for one round only (0, 1 or 2). Specify -1 to calculate for all.</param>
         public static void PrecalcuateTables(string outputDir, int round)
+        {
+            PrecalcuateTables(outputDir, round, false);
+        }
+
+        /// <summary>
+        /// Precalculate tables. 
+        /// <remarks>With the native engine (ai.pkr.holdem.strategy.hs.cpplib, see CppLib) it takes minutes 
+        /// instead of hours: HS of all pockets of a board is calculated at once, 
+        /// boards are calculated in parallel.
+        /// </remarks>
+        /// </summary>
+        /// <param name="outputDir">Output directory. A subdir named after the library will be created in it,
+        /// and files will be stored there.</param>
+        /// <param name="round">Calculate for one round only (0, 1 or 2). Specify -1 to calculate for all.</param>
+        /// <param name="useNativeEngine">Use the native engine.</param>
+        public static void PrecalcuateTables(string outputDir, int round, bool useNativeEngine)
         {
             List<Entry> table;
             int[] boardSizes = {0, 3, 4, 5};
@@ -345,12 +408,12 @@ namespace ai.pkr.holdem.strategy.hs
 
             for (int r = firstRound; r <= lastRound; ++r)
             {
-                table = Precalculate(boardSizes[r]);
-                WriteTable(table, Path.Combine(outputDir, _lutNames[r]));
+                table = Precalculate(boardSizes[r], useNativeEngine);
+                WriteTable(ToIndexedTable(table, boardSizes[r]), Path.Combine(outputDir, _lutNames[r]));
             }
         }
 
-        static List<Entry> Precalculate(int boardSize)
+        static List<Entry> Precalculate(int boardSize, bool useNativeEngine)
         {
             int POCKETS_COUNT = (int)HePocketKind.__Count;
             //POCKETS_COUNT = 1; // Test
@@ -358,6 +421,7 @@ namespace ai.pkr.holdem.strategy.hs
             PrecalculationContext context = new PrecalculationContext();
             int[] listSize = new int[] {169, -1, -1, 1361802, 15111642};
             context.list = new List<Entry>(listSize[boardSize]);
+            context.calculateValues = !useNativeEngine;
 
             for (int p = 0; p < POCKETS_COUNT; ++p)
             {
@@ -365,14 +429,104 @@ namespace ai.pkr.holdem.strategy.hs
                 context.pocket = HePocket.KindToCardSet((HePocketKind)p);
                 context.pocketSei.Reset();
                 context.pocketSei.Convert(context.pocket);
-                Console.WriteLine("Calculating for board size {0}, pocket {1}", boardSize, context.pocket);
+                Console.WriteLine("{0} board size {1}, pocket {2}", useNativeEngine ? "Enumerating" : "Calculating", 
+                    boardSize, context.pocket);
                 CardEnum.Combin(StdDeck.Descriptor, boardSize, CardSet.Empty, context.pocket, OnPrecalculateBoard, context);
             }
 
             Debug.Assert(EnumAlgos.CountCombin(50, boardSize) * POCKETS_COUNT == context.count);
+            if (useNativeEngine)
+            {
+                PrecalculateNative(context.list, boardSize);
+            }
             return context.list;
         }
 
+        /// <summary>
+        /// Calculates the values of the entries with the native engine. 
+        /// HS does not change if the suits of both pocket and board are permuted, 
+        /// therefore the suits are normalized by the board only. This way the entries are mapped
+        /// to a few distinct boards (1755 flops, 16432 turns), the engine calculates HS of all pockets for each of them.
+        /// </summary>
+        static void PrecalculateNative(List<Entry> list, int boardSize)
+        {
+            Dictionary<UInt64, int> boardIndexes = new Dictionary<UInt64, int>();
+            List<int> boardCards = new List<int>();
+            int[] entryBoards = new int[list.Count];
+            int[] entryPockets = new int[list.Count];
+            int[] cards = new int[boardSize];
+            // Normalize suits of board and pocket with the native NormSuit in chunks.
+            ai.pkr.stdpoker.CppLib.Init();
+            UInt64[] parts = new UInt64[2 * NORM_SUIT_CHUNK];
+            UInt64[] seParts = new UInt64[2 * NORM_SUIT_CHUNK];
+            for (int begin = 0; begin < list.Count; begin += NORM_SUIT_CHUNK)
+            {
+                int count = Math.Min(NORM_SUIT_CHUNK, list.Count - begin);
+                for (int j = 0; j < count; ++j)
+                {
+                    UInt32 key = list[begin + j].key;
+                    for (int c = 0; c < boardSize; ++c)
+                    {
+                        cards[c] = (int)(key >> (6 * c)) & 63;
+                    }
+                    parts[2 * j] = StdDeck.Descriptor.GetCardSet(cards, 0, boardSize).bits;
+                    parts[2 * j + 1] = HePocket.KindToCardSet((HePocketKind)(key >> 24)).bits;
+                }
+                ai.pkr.stdpoker.CppLib.NormSuit_ConvertBatch(count, 2, parts, seParts);
+                for (int j = 0; j < count; ++j)
+                {
+                    CardSet seBoard = new CardSet { bits = seParts[2 * j] };
+                    CardSet sePocket = new CardSet { bits = seParts[2 * j + 1] };
+                    int boardIdx;
+                    if (!boardIndexes.TryGetValue(seBoard.bits, out boardIdx))
+                    {
+                        boardIdx = boardIndexes.Count;
+                        boardIndexes.Add(seBoard.bits, boardIdx);
+                        boardCards.AddRange(StdDeck.Descriptor.GetIndexesAscending(seBoard));
+                    }
+                    List<int> pocketCards = StdDeck.Descriptor.GetIndexesAscending(sePocket);
+                    entryBoards[begin + j] = boardIdx;
+                    entryPockets[begin + j] = CppLib.HsEnginePocketIndex(pocketCards[0], pocketCards[1]);
+                }
+            }
+            int boardCount = boardIndexes.Count;
+            Console.WriteLine("Calculating {0} entries on {1} boards of size {2}", list.Count, boardCount, boardSize);
+
+            CppLib.Init();
+            IntPtr engine = CppLib.HsEngine_Open();
+            try
+            {
+                float[] hs = new float[boardCount * CppLib.HsEnginePocketCount];
+                int[] boardCardsArray = boardCards.ToArray();
+                // Calculate in chunks to show the progress.
+                const int CHUNK = 256;
+                fixed (float* pHs = hs)
+                {
+                    fixed (int* pBoards = boardCardsArray.Length > 0 ? boardCardsArray : new int[1])
+                    {
+                        for (int b = 0; b < boardCount; b += CHUNK)
+                        {
+                            int count = Math.Min(CHUNK, boardCount - b);
+                            CppLib.HsEngine_CalculateBoards(engine, boardSize, (UInt32)count, pBoards + b * boardSize,
+                                pHs + b * CppLib.HsEnginePocketCount);
+                            Console.WriteLine("Calculated {0} of {1} boards", b + count, boardCount);
+                        }
+                    }
+                }
+                for (int i = 0; i < list.Count; ++i)
+                {
+                    Entry entry = list[i];
+                    entry.value = hs[entryBoards[i] * CppLib.HsEnginePocketCount + entryPockets[i]];
+                    Debug.Assert(entry.value >= 0);
+                    list[i] = entry;
+                }
+            }
+            finally
+            {
+                CppLib.HsEngine_Close(engine);
+            }
+        }
+
         static void OnPrecalculateBoard(ref CardSet board, PrecalculationContext d)
         {
             NormSuit sei = new NormSuit(d.pocketSei);
@@ -389,6 +543,12 @@ namespace ai.pkr.holdem.strategy.hs
                     throw new ApplicationException(
                         "Algorithm error, new value must be greater than all existing values.");
                 }
+                if (!d.calculateValues)
+                {
+                    d.list.Add(keyEntry);
+                    d.count++;
+                    return;
+                }
                 List<int> pocketIdxs = StdDeck.Descriptor.GetIndexesAscending(d.pocket);
                 List<int> boardIdxs = StdDeck.Descriptor.GetIndexesAscending(seBoard);
                 int[] hand = new int[pocketIdxs.Count + boardIdxs.Count];
@@ -191,6 +191,65 @@ namespace ai.pkr.holdem.strategy.hs.nunit
             RandomTest(rngSeed, 1000, 5, 8); 
         }
 
+        [Test]
+        public unsafe void Test_Native_Calculate()
+        {
+            int rngSeed = (int)DateTime.Now.Ticks;
+            Console.WriteLine("RNG seed {0}", rngSeed);
+            SequenceRng dealer = new SequenceRng(rngSeed, StdDeck.Descriptor.FullDeckIndexes);
+            CppLib.Init();
+            IntPtr e = CppLib.HsEngine_Open();
+            try
+            {
+                // Flop to river, preflop is too slow for the managed calculation.
+                for (int handLength = 5; handLength <= 7; ++handLength)
+                {
+                    int handCount = handLength == 5 ? 10 : 200;
+                    int[] hands = new int[handCount * handLength];
+                    for (int i = 0; i < handCount; ++i)
+                    {
+                        dealer.Shuffle(handLength);
+                        Array.Copy(dealer.Sequence, 0, hands, i * handLength, handLength);
+                    }
+                    float[] hs = new float[handCount];
+                    fixed (int* pHands = hands)
+                    {
+                        fixed (float* pHs = hs)
+                        {
+                            CppLib.HsEngine_Calculate(e, handLength, (uint)handCount, pHands, pHs);
+                        }
+                    }
+                    for (int i = 0; i < handCount; ++i)
+                    {
+                        int[] hand = hands.Slice(i * handLength, handLength);
+                        Assert.AreEqual(HandStrength.Calculate(hand), hs[i], _deck.GetCardNames(hand));
+                    }
+                }
+            }
+            finally
+            {
+                CppLib.HsEngine_Close(e);
+            }
+        }
+
+        [Test]
+        [Category("Benchmark")]
+        public unsafe void Benchmark_Native_CalculateBoards()
+        {
+            CppLib.Init();
+            IntPtr e = CppLib.HsEngine_Open();
+            try
+            {
+                DoBenchmarkNative(e, _deck.GetIndexes("Ac Td 4h"), 10);
+                DoBenchmarkNative(e, _deck.GetIndexes("Ac Td 4h Js"), 200);
+                DoBenchmarkNative(e, _deck.GetIndexes("Ac Td 4h Js 9c"), 10000);
+            }
+            finally
+            {
+                CppLib.HsEngine_Close(e);
+            }
+        }
+
         [Test]
         [Category("Benchmark")]
         public void Benchmark_Caluclate()
@@ -278,6 +337,32 @@ namespace ai.pkr.holdem.strategy.hs.nunit
                 boardName, repetitions, time.TotalSeconds, repetitions / time.TotalSeconds);
         }
 
+        /// <summary>
+        /// Calculates all pockets on the board, repeated repetitions times.
+        /// </summary>
+        private unsafe void DoBenchmarkNative(IntPtr e, int[] board, int repetitions)
+        {
+            int[] boards = new int[board.Length * repetitions];
+            for (int r = 0; r < repetitions; ++r)
+            {
+                board.CopyTo(boards, r * board.Length);
+            }
+            float[] hs = new float[CppLib.HsEnginePocketCount * repetitions];
+            DateTime startTime = DateTime.Now;
+            fixed (int* pBoards = boards)
+            {
+                fixed (float* pHs = hs)
+                {
+                    CppLib.HsEngine_CalculateBoards(e, board.Length, (uint)repetitions, pBoards, pHs);
+                }
+            }
+            TimeSpan time = DateTime.Now - startTime;
+            int pocketCount = (int)EnumAlgos.CountCombin(52 - board.Length, 2) * repetitions;
+            string boardName = new string[] { "PREFLOP", "", "", "FLOP", "TURN", "RIVER" }[board.Length];
+            Console.WriteLine("Native hand strength of all pockets on {0} calculated {1} times in {2} s, {3:0,0} val/s",
+                boardName, repetitions, time.TotalSeconds, pocketCount / time.TotalSeconds);
+        }
+
         private float VerifyCalculateFast(int [] hand)
         {
             float s1 = HandStrength.Calculate(hand);
@@ -14,7 +14,7 @@ namespace ai.pkr.holdem.strategy.hssd.lut_gen
         {
             for (int r = 0; r < 3; ++r)
             {
-                HsSd.Precalculate(0);
+                HsSd.Precalculate(r);
             }
         }
     }
@@ -16,6 +16,7 @@ using System.IO;
 using System.Runtime.InteropServices;
 using System.Reflection;
 using ai.lib.algorithms;
+using ai.pkr.stdpoker;
 
 namespace ai.pkr.holdem.strategy.hssd
 {
@@ -69,54 +70,39 @@ namespace ai.pkr.holdem.strategy.hssd
         };
 
         public static float[] CalculateFast(int[] hand, int handLength, SdKind sdKind)
+        {
+            float[] hssd = new float[2];
+            CalculateFast(hand, handLength, sdKind, hssd);
+            return hssd;
+        }
+
+        /// <summary>
+        /// Stores HS to hssd[0] and SD to hssd[1]. Does not allocate memory (except on the river).
+        /// </summary>
+        public static void CalculateFast(int[] hand, int handLength, SdKind sdKind, float[] hssd)
         {
             Debug.Assert(handLength >= 0 && handLength <= 7);
             if (handLength == 7)
             {
                 // SdKind.SdPlus1 will throw an exception, this is exactly what we want.
-                return Calculate(hand, handLength, sdKind == SdKind.SdPlus1 ? 4 : 3);
+                float[] result = Calculate(hand, handLength, sdKind == SdKind.SdPlus1 ? 4 : 3);
+                hssd[0] = result[0];
+                hssd[1] = result[1];
+                return;
             }
 
-            if (_lut2 == null)
+            if (_luts[2] == null)
             {
                 LoadLuts();
             }
 
-            float[] hssd = new float[2];
-
             int round = HeHelper.HandSizeToRound[handLength];
-            CardSet pocket = StdDeck.Descriptor.GetCardSet(hand, 0, 2);
-            CardSet board = StdDeck.Descriptor.GetCardSet(hand, 2, handLength - 2);
-            NormSuit se = new NormSuit();
-            CardSet sePocket = se.Convert(pocket);
-            CardSet seBoard = se.Convert(board);
-
-            if(round == 2)
-            {
-
-                Entry2 keyEntry = new Entry2(HePocket.CardSetToKind(sePocket), seBoard);
-                int idx = Array.BinarySearch(_lut2, keyEntry);
-                if (idx < 0)
-                {
-                    ThrowNoEntryException(sePocket, seBoard);
-                }
-                hssd[0] = _lut2[idx].Hs;
-                // For turn, there is no difference between SD kinds.
-                hssd[1] = _lut2[idx].SdPlus1;
-            }
-            else
-            {
-                Entry01 keyEntry = new Entry01(HePocket.CardSetToKind(sePocket), seBoard);
-                int idx = Array.BinarySearch(_lut01[round], keyEntry);
-                if (idx < 0)
-                {
-                    ThrowNoEntryException(sePocket, seBoard);
-                }
-                // For turn, there is no difference between SD kinds.
-                hssd[0] = _lut01[round][idx].Hs;
-                hssd[1] = sdKind == SdKind.SdPlus1 ? _lut01[round][idx].SdPlus1 : _lut01[round][idx].Sd3;
-            }
-            return hssd;
+            UInt64 idx = _indexers[round].Index(hand);
+            float[] lut = _luts[round];
+            int stride = ValuesCount[round];
+            hssd[0] = lut[idx * (UInt64)stride];
+            // For turn, there is no difference between SD kinds, there is only SdPlus1.
+            hssd[1] = lut[idx * (UInt64)stride + (sdKind == SdKind.SdPlus1 || round == 2 ? 1UL : 2UL)];
         }
 
         /// <summary>
@@ -160,11 +146,11 @@ namespace ai.pkr.holdem.strategy.hssd
             Debug.Assert(EnumAlgos.CountCombin(50, boardSize) * POCKETS_COUNT == context.count);
             if (round < 2)
             {
-                WriteTable((List<Entry01>)context.list, lutPath);
+                WriteTable(ToIndexedTable((List<Entry01>)context.list, round), lutPath);
             }
             else
             {
-                WriteTable((List<Entry2>)context.list, lutPath);
+                WriteTable(ToIndexedTable((List<Entry2>)context.list, round), lutPath);
             }
             Console.WriteLine("LUT file {0} written, calculated in {1:0.0} s", lutPath, (DateTime.Now - startTime).TotalSeconds);
         }
@@ -222,14 +208,18 @@ namespace ai.pkr.holdem.strategy.hssd
             return key;
         }
 
-        interface IPersistent
+        interface IEntry
         {
-            void Write(BinaryWriter w);
-            void Read(BinaryReader r);
+            UInt32 EntryKey { get; }
+
+            /// <summary>
+            /// Copies the values (HS, SD, ...) to table[pos..].
+            /// </summary>
+            void CopyValues(float[] table, UInt64 pos);
         }
 
         [StructLayout(LayoutKind.Sequential, Pack = 1)]
-        struct Entry2 : IComparable<Entry2>, IPersistent
+        struct Entry2 : IComparable<Entry2>, IEntry
         {
             public UInt32 Key;
             public float Hs;
@@ -246,23 +236,20 @@ namespace ai.pkr.holdem.strategy.hssd
                 return Key.CompareTo(other.Key);
             }
 
-            public void  Write(BinaryWriter w)
+            public UInt32 EntryKey
             {
-                w.Write(Key);
-                w.Write(Hs);
-                w.Write(SdPlus1);
+                get { return Key; }
             }
 
-            public void  Read(BinaryReader r)
+            public void CopyValues(float[] table, UInt64 pos)
             {
-                Key = r.ReadUInt32();
-                Hs = r.ReadSingle();
-                SdPlus1 = r.ReadSingle();
+                table[pos] = Hs;
+                table[pos + 1] = SdPlus1;
             }
         }
 
         [StructLayout(LayoutKind.Sequential, Pack = 1)]
-        struct Entry01 : IComparable<Entry01>, IPersistent
+        struct Entry01 : IComparable<Entry01>, IEntry
         {
             public UInt32 Key;
             public float Hs;
@@ -280,20 +267,16 @@ namespace ai.pkr.holdem.strategy.hssd
                 return Key.CompareTo(other.Key);
             }
 
-            public void Write(BinaryWriter w)
+            public UInt32 EntryKey
             {
-                w.Write(Key);
-                w.Write(Hs);
-                w.Write(SdPlus1);
-                w.Write(Sd3);
+                get { return Key; }
             }
 
-            public void Read(BinaryReader r)
+            public void CopyValues(float[] table, UInt64 pos)
             {
-                Key = r.ReadUInt32();
-                Hs = r.ReadSingle();
-                SdPlus1 = r.ReadSingle();
-                Sd3 = r.ReadSingle();
+                table[pos] = Hs;
+                table[pos + 1] = SdPlus1;
+                table[pos + 2] = Sd3;
             }
         }
 
@@ -315,17 +298,24 @@ namespace ai.pkr.holdem.strategy.hssd
 
         // Version of precalculated files, should be the same as the version
         // of the pom.
-        private static readonly BdsVersion Version = new BdsVersion(1, 0, 0);
+        private static readonly BdsVersion Version = new BdsVersion(1, 1, 0);
+
+        /// <summary>
+        /// Number of values of a hand in the look-up table of each round: 
+        /// HS, SdPlus1, Sd3 for rounds 0 and 1, HS, SdPlus1 for round 2.
+        /// </summary>
+        private static readonly int[] ValuesCount = new int[] { 3, 3, 2 };
 
         /// <summary>
-        /// Look-up tables for each round from 0 to 1.
+        /// Look-up tables for each round from 0 to 2. The values of a hand are stored at
+        /// the index of the hand in _indexers[round] times ValuesCount[round].
         /// </summary>
-        private static Entry01[][] _lut01 = new Entry01[2][];
+        private static float[][] _luts = new float[3][];
 
         /// <summary>
-        /// Look-up table for round 2.
+        /// Indexers of pocket + board for each round from 0 to 2.
         /// </summary>
-        private static Entry2[] _lut2;
+        private static HandIsoIndexer[] _indexers = new HandIsoIndexer[3];
 
         /// <summary>
         /// Load precalcuation table for fast calculation.
@@ -334,11 +324,11 @@ namespace ai.pkr.holdem.strategy.hssd
         /// </summary>
         public static void LoadLuts()
         {
-            for (int r = 0; r < 2; ++r)
+            for (int r = 0; r < 3; ++r)
             {
-                _lut01[r] = ReadTable<Entry01>(GetLutPath(r));
+                _indexers[r] = HandIsoIndexer.GetPocketBoard(HeHelper.RoundToHandSize[r] - 2);
+                _luts[r] = ReadTable(GetLutPath(r), _indexers[r].Size * (UInt64)ValuesCount[r]);
             }
-            _lut2 = ReadTable<Entry2>(GetLutPath(2));
         }
 
         private static void ThrowNoEntryException(CardSet sePocket, CardSet seBoard)
@@ -348,7 +338,71 @@ namespace ai.pkr.holdem.strategy.hssd
                                                sePocket, seBoard));
         }
 
-        static void WriteTable<T>(List<T> table, string path) where T: IPersistent
+        /// <summary>
+        /// Converts a list sorted by keys to a table indexed by HandIsoIndexer:
+        /// the values of each class of hands are looked up by a representative hand.
+        /// </summary>
+        static float[] ToIndexedTable<T>(List<T> list, int round) where T : IEntry
+        {
+            int boardSize = HeHelper.RoundToHandSize[round] - 2;
+            HandIsoIndexer indexer = HandIsoIndexer.GetPocketBoard(boardSize);
+            int stride = ValuesCount[round];
+            float[] table = new float[indexer.Size * (UInt64)stride];
+            int[] hand = new int[indexer.HandSize];
+            // Normalize suits of pocket and board with the native NormSuit in chunks.
+            const int CHUNK = 1 << 16;
+            UInt64[] parts = new UInt64[2 * CHUNK];
+            UInt64[] seParts = new UInt64[2 * CHUNK];
+            for (UInt64 begin = 0; begin < indexer.Size; begin += CHUNK)
+            {
+                int count = (int)Math.Min(CHUNK, indexer.Size - begin);
+                for (int j = 0; j < count; ++j)
+                {
+                    indexer.Unindex(begin + (UInt64)j, hand);
+                    parts[2 * j] = StdDeck.Descriptor.GetCardSet(hand, 0, 2).bits;
+                    parts[2 * j + 1] = StdDeck.Descriptor.GetCardSet(hand, 2, boardSize).bits;
+                }
+                ai.pkr.stdpoker.CppLib.NormSuit_ConvertBatch(count, 2, parts, seParts);
+                for (int j = 0; j < count; ++j)
+                {
+                    CardSet sePocket = new CardSet { bits = seParts[2 * j] };
+                    CardSet seBoard = new CardSet { bits = seParts[2 * j + 1] };
+                    UInt32 key = GetKey((int)HePocket.CardSetToKind(sePocket), seBoard);
+                    int idx = BinarySearch(list, key);
+                    if (idx < 0)
+                    {
+                        ThrowNoEntryException(sePocket, seBoard);
+                    }
+                    list[idx].CopyValues(table, (begin + (UInt64)j) * (UInt64)stride);
+                }
+            }
+            return table;
+        }
+
+        static int BinarySearch<T>(List<T> list, UInt32 key) where T : IEntry
+        {
+            int lo = 0, hi = list.Count - 1;
+            while (lo <= hi)
+            {
+                int mid = lo + (hi - lo) / 2;
+                UInt32 midKey = list[mid].EntryKey;
+                if (midKey == key)
+                {
+                    return mid;
+                }
+                if (midKey < key)
+                {
+                    lo = mid + 1;
+                }
+                else
+                {
+                    hi = mid - 1;
+                }
+            }
+            return -1;
+        }
+
+        static void WriteTable(float[] table, string path)
         {
             BdsVersion fileVersion = new BdsVersion(Version);
             BdsVersion assemblyVersion = new BdsVersion(Assembly.GetExecutingAssembly());
@@ -362,17 +416,17 @@ namespace ai.pkr.holdem.strategy.hssd
             using(BinaryWriter wr = new BinaryWriter(File.Open(path, FileMode.Create)))
             {
                 fileVersion.Write(wr);
-                wr.Write(table.Count);
-                for(int i = 0; i < table.Count; ++i)
+                wr.Write(table.Length);
+                for(int i = 0; i < table.Length; ++i)
                 {
-                    table[i].Write(wr);
+                    wr.Write(table[i]);
                 }
             }
         }
 
-        static T[] ReadTable<T>(string path) where T: IPersistent, new()
+        static float[] ReadTable(string path, UInt64 expectedCount)
         {
-            T[] table = null;
+            float[] table = null;
             using (BinaryReader r = new BinaryReader(File.Open(path, FileMode.Open, FileAccess.Read, FileShare.Read)))
             {
                 BdsVersion fileVersion = new BdsVersion();
@@ -386,11 +440,16 @@ namespace ai.pkr.holdem.strategy.hssd
                                       Version, fileVersion, path));
                 }
                 int count = r.ReadInt32();
-                table = new T[count];
+                if ((UInt64)count != expectedCount)
+                {
+                    throw new ApplicationException(
+                        String.Format("Wrong table size: expected: {0}, was: {1}, file: {2}", expectedCount, count, path));
+                }
+                table = new float[count];
 
                 for (int i = 0; i < count; ++i)
                 {
-                    table[i].Read(r);
+                    table[i] = r.ReadSingle();
                 }
             }
             return table;
@@ -209,6 +209,7 @@ namespace ai.pkr.holdem.strategy.hssd.nunit
             Random rng = new Random(rngSeed);
             SequenceRng dealer = new SequenceRng(rngSeed, StdDeck.Descriptor.FullDeckIndexes);
             int handLength = HeHelper.RoundToHandSize[round];
+            float[] hssdNoAlloc = new float[2];
             for (int r = 0; r < repCount; ++r)
             {
                 dealer.Shuffle(handLength);
@@ -218,6 +219,8 @@ namespace ai.pkr.holdem.strategy.hssd.nunit
                 float[] hssd = HsSd.Calculate(dealer.Sequence, handLength, sdRound);
                 Assert.AreEqual(hssd[0], hssdFast[0], 1e-6);
                 Assert.AreEqual(hssd[1], hssdFast[1], 1e-6);
+                HsSd.CalculateFast(dealer.Sequence, handLength, sdKind, hssdNoAlloc);
+                Assert.AreEqual(hssdFast, hssdNoAlloc);
             }
         }
 
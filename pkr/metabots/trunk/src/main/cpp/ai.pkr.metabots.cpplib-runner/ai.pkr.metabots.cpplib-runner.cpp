@@ -0,0 +1,710 @@
+// ai.pkr.metabots.cpplib-runner.cpp : Tests and benchmarks for ai.pkr.metabots.cpplib.
+//
+// Usage:
+//   ai.pkr.metabots.cpplib-runner test [temp-dir] [example-bot-library]
+//       Runs the tests (on a synthetic LUT, no data files are required).
+//   ai.pkr.metabots.cpplib-runner match <LutEvaluator7.dat> <bot0-library> <bot1-library> <deals> [threads] [binary-log]
+//       Plays a duplicate match of two bot libraries.
+//   ai.pkr.metabots.cpplib-runner benchmark [deals] [threads] [LutEvaluator7.dat]
+//       Plays a duplicate match of two in-process bots with and without a game log.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "ai.pkr.metabots.cpplib.h"
+#include "match_engine.h"
+#include <game_log_file.h>
+#include <game_log_writer.h>
+#include <log_scanner.h>
+#include <ai.lib.utils.cpp/bds_version.h>
+
+using namespace std;
+using namespace ai::pkr::stdpoker;
+using namespace ai::pkr::metatools;
+using namespace ai::pkr::metabots;
+
+static string _tempDir = ".";
+static string _exampleBot;
+
+#define VERIFY(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); throw "Test failed"; }
+
+/// A simple deterministic RNG (the tests must be reproducible).
+class Rng
+{
+public:
+	Rng(uint64_t seed) : _state(seed * 2862933555777941757ULL + 3037000493ULL)
+	{}
+
+	uint32_t Next(uint32_t n)
+	{
+		_state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (uint32_t)((_state >> 33) % n);
+	}
+private:
+	uint64_t _state;
+};
+
+static void WriteInt32(string & s, uint32_t v)
+{
+	s.append((const char*)&v, 4);
+}
+
+static void WriteString(string & s, const string & v)
+{
+	// Strings are short here, 1-byte length prefix.
+	s.push_back((char)v.size());
+	s.append(v);
+}
+
+/// Writes a LUT file in the format of LutEvaluatorGenerator.SaveLut().
+static string WriteLutFile(const char * name, const vector<uint32_t> & lut)
+{
+	string fields;
+	WriteInt32(fields, 1);
+	WriteInt32(fields, 2);
+	WriteInt32(fields, 3);
+	WriteInt32(fields, 4);
+	WriteString(fields, "scm");
+	WriteString(fields, "build");
+	WriteString(fields, "MatchEngine test data");
+	WriteString(fields, "");
+
+	string file;
+	WriteInt32(file, 5);
+	WriteInt32(file, (uint32_t)fields.size());
+	file += fields;
+	WriteInt32(file, ai::lib::utils::bds_version::crc32(fields.data(), fields.size()));
+	WriteInt32(file, lut_evaluator7::LUT_FILE_FORMAT_ID);
+	WriteInt32(file, (uint32_t)lut.size());
+	file.append((const char*)&lut[0], lut.size() * 4);
+
+	string path = _tempDir + "/" + name;
+	FILE * f = fopen(path.c_str(), "wb");
+	VERIFY(f != 0);
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+	return path;
+}
+
+/** Creates a small order-independent LUT (like a real one).
+The state of level l is the sum of random card weights modulo M, the hand value is
+a function of the sum of 7 cards with a small range, so that there are many ties.
+*/
+static void CreateSetLut(Rng & rng, vector<uint32_t> & lut)
+{
+	const uint32_t M = 997;
+	uint32_t weights[52];
+	for(int c = 0; c < 52; ++c)
+	{
+		weights[c] = rng.Next(M);
+	}
+	uint32_t values[M];
+	for(uint32_t s = 0; s < M; ++s)
+	{
+		values[s] = rng.Next(300) + 1;
+	}
+	// Level 0 has one state, levels 1..6 have M states each.
+	lut.resize((1 + 6 * M) * 52);
+	for(int l = 0; l < 7; ++l)
+	{
+		uint32_t stateCount = l == 0 ? 1 : M;
+		for(uint32_t s = 0; s < stateCount; ++s)
+		{
+			uint32_t state = l == 0 ? 0 : 1 + (l - 1) * M + s;
+			for(int c = 0; c < 52; ++c)
+			{
+				uint32_t sum = (s + weights[c]) % M;
+				lut[state * 52 + c] = l < 6 ? 52 * (1 + l * M + sum) : values[sum];
+			}
+		}
+	}
+}
+
+static string CreateTestLut()
+{
+	Rng rng(1);
+	vector<uint32_t> lut;
+	CreateSetLut(rng, lut);
+	return WriteLutFile("MatchEngine-test.dat", lut);
+}
+
+static string ReadFile(const string & path)
+{
+	string data;
+	FILE * f = fopen(path.c_str(), "rb");
+	VERIFY(f != 0);
+	char buffer[65536];
+	size_t read;
+	while((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+	{
+		data.append(buffer, read);
+	}
+	fclose(f);
+	return data;
+}
+
+//------------------------------------------------------------------------------
+// In-process bots.
+//------------------------------------------------------------------------------
+
+/// A bot always doing the same action (MATCH_FOLD, MATCH_CALL or MATCH_RAISE, the parameter),
+/// records its game results if the parameter has a '+' (use with 1 thread only).
+struct ConstBot
+{
+	int action;
+	bool record;
+};
+
+static vector<double> _recorded;
+
+static void * ConstBot_Create(const char * parameters, int /*threadIndex*/)
+{
+	ConstBot * bot = new ConstBot;
+	bot->action = atoi(parameters);
+	bot->record = strchr(parameters, '+') != 0;
+	return bot;
+}
+
+static void ConstBot_Destroy(void * bot)
+{
+	delete (ConstBot *)bot;
+}
+
+static int ConstBot_Act(void * bot, const MatchState * /*state*/)
+{
+	return ((ConstBot *)bot)->action;
+}
+
+static void ConstBot_OnGameEnd(void * bot, const MatchState * /*state*/, double result)
+{
+	if(((ConstBot *)bot)->record)
+	{
+		_recorded.push_back(result);
+	}
+}
+
+static const MatchBotFunctions CONST_BOT = {ConstBot_Create, ConstBot_Destroy, ConstBot_Act, ConstBot_OnGameEnd};
+
+/// A stateless bot acting by a hash of the state, plays all kinds of games
+/// and gives the same results with any number of threads.
+static void * HashBot_Create(const char * parameters, int /*threadIndex*/)
+{
+	return new uint64_t(atoi(parameters));
+}
+
+static void HashBot_Destroy(void * bot)
+{
+	delete (uint64_t *)bot;
+}
+
+static int HashBot_Act(void * bot, const MatchState * state)
+{
+	uint64_t h = *(uint64_t *)bot * 0x9E3779B97F4A7C15ULL + (uint64_t)state->pocket[0] * 53 + state->pocket[1];
+	for(int i = 0; i < state->boardCount; ++i)
+	{
+		h = h * 1099511628211ULL + state->board[i];
+	}
+	for(int i = 0; i < state->actionsCount; ++i)
+	{
+		h = h * 1099511628211ULL + state->actions[i];
+	}
+	h ^= h >> 29;
+	h *= 0xBF58476D1CE4E5B9ULL;
+	h ^= h >> 32;
+	int r = (int)(h % 8);
+	return r == 0 ? MATCH_FOLD : (r < 4 ? MATCH_RAISE : MATCH_CALL);
+}
+
+static const MatchBotFunctions HASH_BOT = {HashBot_Create, HashBot_Destroy, HashBot_Act, 0};
+
+static void * NullBot_Create(const char * /*parameters*/, int /*threadIndex*/)
+{
+	return 0;
+}
+
+static const MatchBotFunctions NULL_BOT = {NullBot_Create, HashBot_Destroy, HashBot_Act, 0};
+
+//------------------------------------------------------------------------------
+// Tests.
+//------------------------------------------------------------------------------
+
+static void Test_DeckStream()
+{
+	const int DEALS = 52000;
+	vector<int> counts(deck_stream::DEAL_SIZE * 52, 0);
+	int32_t cards[deck_stream::DEAL_SIZE], again[deck_stream::DEAL_SIZE], other[deck_stream::DEAL_SIZE];
+	int sameAsOtherSeed = 0;
+	for(int d = 0; d < DEALS; ++d)
+	{
+		deck_stream::deal(7, d, cards);
+		uint64_t used = 0;
+		for(int i = 0; i < deck_stream::DEAL_SIZE; ++i)
+		{
+			VERIFY(cards[i] >= 0 && cards[i] < 52);
+			VERIFY(!(used & (1ULL << cards[i])));
+			used |= 1ULL << cards[i];
+			counts[i * 52 + cards[i]]++;
+		}
+		deck_stream::deal(7, d, again);
+		VERIFY(equal(cards, cards + deck_stream::DEAL_SIZE, again));
+		deck_stream::deal(8, d, other);
+		sameAsOtherSeed += equal(cards, cards + deck_stream::DEAL_SIZE, other) ? 1 : 0;
+	}
+	VERIFY(sameAsOtherSeed == 0);
+	// Each card is expected 1000 times at each index, the standard deviation is about 31.
+	for(size_t i = 0; i < counts.size(); ++i)
+	{
+		VERIFY(counts[i] > 850 && counts[i] < 1150);
+	}
+}
+
+/// Plays a match of two ConstBots, bot 0 records its results.
+static match_result PlayConst(match_engine & engine, int action0, int action1, int64_t deals, bool duplicate)
+{
+	char p0[16], p1[16];
+	sprintf(p0, "%d+", action0);
+	sprintf(p1, "%d", action1);
+	VERIFY(engine.set_bot(0, CONST_BOT, p0, "bot0"));
+	VERIFY(engine.set_bot(1, CONST_BOT, p1, "bot1"));
+	_recorded.clear();
+	match_result result;
+	VERIFY(engine.run(1, deals, duplicate, 0, result));
+	VERIFY(result.games_count == (duplicate ? 2 : 1) * deals);
+	VERIFY((int64_t)_recorded.size() == result.games_count);
+	double sum = 0;
+	for(size_t g = 0; g < _recorded.size(); ++g)
+	{
+		sum += _recorded[g];
+	}
+	VERIFY(sum == result.result);
+	return result;
+}
+
+static bool AllIn(const vector<double> & values, double a, double b)
+{
+	for(size_t i = 0; i < values.size(); ++i)
+	{
+		double v = fabs(values[i]);
+		if(v != a && v != b)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void Test_Rules(const string & lutPath)
+{
+	match_engine engine;
+	VERIFY(engine.load_evaluator(lutPath.c_str()));
+
+	// Check down: a showdown for 1 big blind.
+	match_result r = PlayConst(engine, MATCH_CALL, MATCH_CALL, 1000, false);
+	VERIFY(AllIn(_recorded, 0, 1));
+	VERIFY(r.std_error() > 0);
+	VERIFY(r.duplicate_std_error() == 0);
+
+	// 4 bets in each round: 4 + 4 + 8 + 8.
+	PlayConst(engine, MATCH_RAISE, MATCH_RAISE, 1000, false);
+	VERIFY(AllIn(_recorded, 0, 24));
+
+	// A bet and a call in each round: 2 + 1 + 2 + 2.
+	PlayConst(engine, MATCH_RAISE, MATCH_CALL, 1000, false);
+	VERIFY(AllIn(_recorded, 0, 7));
+
+	// The bots change the seats every game: the small blind, then the big blind is lost.
+	r = PlayConst(engine, MATCH_FOLD, MATCH_CALL, 1000, false);
+	for(size_t g = 0; g < _recorded.size(); ++g)
+	{
+		VERIFY(_recorded[g] == (g % 2 == 0 ? -0.5 : -1));
+	}
+	VERIFY(r.result == -750);
+	VERIFY(r.rate() == -750);
+
+	// Invalid actions are folds.
+	PlayConst(engine, 17, MATCH_CALL, 10, false);
+	VERIFY(AllIn(_recorded, 0.5, 1));
+
+	// In a duplicate match the cards of the bots are swapped, symmetric bots always break even.
+	r = PlayConst(engine, MATCH_CALL, MATCH_CALL, 1000, true);
+	VERIFY(r.result == 0);
+	VERIFY(r.pairs_count == 1000);
+	VERIFY(r.duplicate_std_error() == 0);
+	VERIFY(r.std_error() > 0);
+	for(size_t g = 0; g < _recorded.size(); g += 2)
+	{
+		VERIFY(_recorded[g] == -_recorded[g + 1]);
+	}
+}
+
+static int32_t ParseCard(const string & s, size_t pos)
+{
+	const char * ranks = "23456789TJQKA";
+	const char * suits = "cdhs";
+	const char * r = strchr(ranks, s[pos]);
+	const char * u = strchr(suits, s[pos + 1]);
+	VERIFY(r && u && s[pos] && s[pos + 1]);
+	return (int32_t)(u - suits) * 13 + (int32_t)(r - ranks);
+}
+
+static vector<int32_t> ParseCards(const string & s)
+{
+	vector<int32_t> cards;
+	for(size_t pos = 0; pos < s.size(); pos += 3)
+	{
+		cards.push_back(ParseCard(s, pos));
+	}
+	return cards;
+}
+
+/** Replays the games of a log written by the engine: verifies the deals, the amounts
+and the results (recalculated with the evaluator). Returns the result of the player name0.
+*/
+static double VerifyLog(const string & path, const lut_evaluator7 & evaluator, uint64_t seed, bool duplicate,
+	int64_t gamesCount, const string & name0)
+{
+	game_log_file file;
+	VERIFY(file.open(path.c_str()));
+	VERIFY(file.games_count() == gamesCount);
+	double total0 = 0;
+	int64_t g = 0;
+	for(size_t c = 0; c < file.chunks_count(); ++c)
+	{
+		const game_log_chunk & chunk = file.chunk(c);
+		int32_t player = 0, action = 0;
+		for(int32_t i = 0; i < chunk.games_count; ++i, ++g)
+		{
+			VERIFY(chunk.first_game + i == g);
+			VERIFY(chunk.game_session[i] == 1);
+			VERIFY(chunk.string(chunk.game_id[i]) == to_string(g));
+			VERIFY(chunk.game_players[i] == 2);
+			int32_t deal[deck_stream::DEAL_SIZE];
+			deck_stream::deal(seed, duplicate ? g / 2 : g, deal);
+
+			double inPot[2] = {0.5, 1};
+			vector<int32_t> board;
+			bool folded = false;
+			double result0 = 0;
+			for(int32_t a = 0; a < chunk.game_actions[i]; ++a, ++action)
+			{
+				int p = chunk.action_position[action];
+				string cards = chunk.string(chunk.action_cards[action]);
+				switch(chunk.action_kind[action])
+				{
+				case ak_d:
+					if(p >= 0)
+					{
+						vector<int32_t> pocket = ParseCards(cards);
+						VERIFY(pocket.size() == 2 && pocket[0] == deal[2 * p] && pocket[1] == deal[2 * p + 1]);
+					}
+					else
+					{
+						vector<int32_t> dealt = ParseCards(cards);
+						board.insert(board.end(), dealt.begin(), dealt.end());
+					}
+					break;
+				case ak_c:
+					inPot[p] = inPot[1 - p];
+					break;
+				case ak_r:
+					VERIFY(chunk.action_amount[action] == (board.size() < 4 ? 1 : 2));
+					inPot[p] = inPot[1 - p] + chunk.action_amount[action];
+					break;
+				case ak_f:
+					VERIFY(!folded);
+					folded = true;
+					result0 = p == 0 ? -inPot[0] : inPot[1];
+					break;
+				default:
+					VERIFY(false);
+				}
+			}
+			if(!folded)
+			{
+				VERIFY(board.size() == 5 && equal(board.begin(), board.end(), deal + 4));
+				VERIFY(inPot[0] == inPot[1]);
+				int32_t hands[2][7];
+				for(int p = 0; p < 2; ++p)
+				{
+					hands[p][0] = deal[2 * p];
+					hands[p][1] = deal[2 * p + 1];
+					copy(deal + 4, deal + 9, hands[p] + 2);
+				}
+				uint32_t rank0 = evaluator.evaluate(hands[0]), rank1 = evaluator.evaluate(hands[1]);
+				result0 = rank0 > rank1 ? inPot[0] : (rank0 < rank1 ? -inPot[0] : 0);
+			}
+			VERIFY(chunk.player_blind[player] == 0.5 && chunk.player_blind[player + 1] == 1);
+			VERIFY(chunk.player_result[player] == result0 && chunk.player_result[player + 1] == -result0);
+			VERIFY(chunk.string(chunk.player_name[player]) != chunk.string(chunk.player_name[player + 1]));
+			total0 += chunk.string(chunk.player_name[player]) == name0 ? result0 : -result0;
+			player += 2;
+		}
+	}
+	VERIFY(g == gamesCount);
+	return total0;
+}
+
+/** The results do not depend on the number of threads and the chunk size,
+the log does not depend on the number of threads.
+*/
+static void Test_Parallel(const string & lutPath)
+{
+	lut_evaluator7 evaluator;
+	VERIFY(evaluator.open(lutPath.c_str()));
+	const int64_t DEALS = 3001;
+	// Runs 2k and 2k + 1 have the same chunk size.
+	const int threads[] = {1, 3, 1, 4, 2, 1};
+	const int chunkSizes[] = {1000, 1000, 7, 7, 16384, 16384};
+	for(int duplicate = 0; duplicate < 2; ++duplicate)
+	{
+		string previousLog;
+		match_result reference;
+		for(int t = 0; t < 6; ++t)
+		{
+			match_engine engine;
+			VERIFY(engine.load_evaluator(lutPath.c_str()));
+			VERIFY(engine.set_thread_count(threads[t]));
+			VERIFY(engine.set_chunk_size(chunkSizes[t]));
+			VERIFY(engine.set_bot(0, HASH_BOT, "1", "Hash1"));
+			VERIFY(engine.set_bot(1, HASH_BOT, "2", "Hash2"));
+			string log = _tempDir + "/MatchEngine-test.bgl";
+			match_result r;
+			VERIFY(engine.run(3, DEALS, duplicate != 0, log.c_str(), r));
+			VERIFY(r.games_count == (duplicate ? 2 : 1) * DEALS);
+			VERIFY(r.result != 0);
+			string data = ReadFile(log);
+			if(t % 2 == 1)
+			{
+				VERIFY(data == previousLog);
+			}
+			previousLog = data;
+			if(t > 0)
+			{
+				VERIFY(r.result == reference.result);
+				VERIFY(r.result_sq == reference.result_sq);
+				VERIFY(r.pair_result_sq == reference.pair_result_sq);
+				continue;
+			}
+			reference = r;
+			double logResult = VerifyLog(log, evaluator, 3, duplicate != 0, r.games_count, "Hash1");
+			VERIFY(logResult == r.result);
+
+			// The same totals as pkrlogstat.
+			game_log_file file;
+			VERIFY(file.open(log.c_str()));
+			log_scanner scanner;
+			VERIFY(scanner.scan(file, INT64_MAX));
+			VERIFY(scanner.sessions().size() == 1);
+			const session_result & session = scanner.sessions()[0];
+			VERIFY(session.index == 1 && session.name == "Hash1 vs Hash2");
+			VERIFY(session.games_over_count == r.games_count);
+			VERIFY(session.players.size() == 2 && session.players[0].name == "Hash1");
+			double scanned = 0;
+			for(size_t p = 0; p < session.players[0].result.size(); ++p)
+			{
+				scanned += session.players[0].result[p];
+			}
+			VERIFY(scanned == r.result);
+		}
+	}
+}
+
+static void Test_ExampleBot(const string & lutPath)
+{
+	if(_exampleBot.empty())
+	{
+		printf("Example bot library is not given, skipped.\n");
+		return;
+	}
+	match_engine engine;
+	VERIFY(engine.load_evaluator(lutPath.c_str()));
+	VERIFY(engine.set_thread_count(2));
+	VERIFY(engine.load_bot(0, _exampleBot.c_str(), "", "Example"));
+	VERIFY(engine.set_bot(1, CONST_BOT, "3", "Calling station"));
+	match_result r;
+	VERIFY(engine.run(1, 5000, true, 0, r));
+	VERIFY(r.games_count == 10000);
+	VERIFY(r.result != 0);
+
+	// Passive bots never raise and therefore never fold, all games are checked down.
+	VERIFY(engine.load_bot(0, _exampleBot.c_str(), "passive", "Passive"));
+	VERIFY(engine.load_bot(1, _exampleBot.c_str(), "passive", "Passive2"));
+	VERIFY(engine.run(1, 2000, true, 0, r));
+	VERIFY(r.result == 0);
+}
+
+static void Test_Errors(const string & lutPath)
+{
+	match_engine engine;
+	match_result r;
+	VERIFY(!engine.load_evaluator((_tempDir + "/no-such-file.dat").c_str()));
+	VERIFY(!engine.run(1, 10, false, 0, r));
+	VERIFY(engine.error().find("both bots") != string::npos);
+	VERIFY(engine.set_bot(0, CONST_BOT, "3", "a"));
+	VERIFY(engine.set_bot(1, CONST_BOT, "3", "b"));
+	VERIFY(!engine.run(1, 10, false, 0, r));
+	VERIFY(engine.error().find("evaluator") != string::npos);
+	VERIFY(engine.load_evaluator(lutPath.c_str()));
+	VERIFY(!engine.run(1, -1, false, 0, r));
+	VERIFY(engine.run(1, 0, false, 0, r));
+	VERIFY(r.games_count == 0 && r.rate() == 0);
+
+	VERIFY(!engine.set_bot(2, CONST_BOT, "3", "c"));
+	MatchBotFunctions incomplete = CONST_BOT;
+	incomplete.act = 0;
+	VERIFY(!engine.set_bot(0, incomplete, "3", "c"));
+	VERIFY(!engine.set_thread_count(0));
+	VERIFY(!engine.set_chunk_size(1));
+	VERIFY(!engine.load_bot(0, (_tempDir + "/no-such-bot.so").c_str(), "", "c"));
+	VERIFY(engine.error().find("cannot load") != string::npos);
+	VERIFY(!engine.load_bot(2, "", "", "c"));
+
+	VERIFY(!engine.run(1, 10, false, (_tempDir + "/no-such-dir/log.bgl").c_str(), r));
+	VERIFY(engine.set_bot(1, NULL_BOT, "", "null"));
+	VERIFY(!engine.run(1, 10, false, 0, r));
+	VERIFY(engine.error().find("cannot create bot null") != string::npos);
+}
+
+static void Test_CApi(const string & lutPath)
+{
+	VERIFY(MatchEngine_Open((_tempDir + "/no-such-file.dat").c_str(), 1) == 0);
+	VERIFY(strlen(MatchEngine_GetLastError()) > 0);
+	VERIFY(MatchEngine_Open(lutPath.c_str(), 0) == 0);
+
+	MatchEngine * e = MatchEngine_Open(lutPath.c_str(), 2);
+	VERIFY(e != 0);
+	VERIFY(MatchEngine_SetBot(e, 0, &HASH_BOT, "1", "Hash1"));
+	VERIFY(!MatchEngine_SetBot(e, 3, &HASH_BOT, "1", "Hash1"));
+	VERIFY(strstr(MatchEngine_GetLastError(), "seat") != 0);
+	VERIFY(MatchEngine_SetBot(e, 1, &HASH_BOT, "2", "Hash2"));
+	VERIFY(!MatchEngine_SetChunkSize(e, 0));
+	VERIFY(MatchEngine_SetChunkSize(e, 100));
+	VERIFY(!MatchEngine_LoadBot(e, 0, (_tempDir + "/no-such-bot.so").c_str(), "", "x"));
+	MatchResult result;
+	VERIFY(!MatchEngine_Run(e, 1, -1, 1, 0, &result));
+	VERIFY(MatchEngine_Run(e, 1, 1000, 1, 0, &result));
+
+	match_engine engine;
+	VERIFY(engine.load_evaluator(lutPath.c_str()));
+	VERIFY(engine.set_bot(0, HASH_BOT, "1", "Hash1"));
+	VERIFY(engine.set_bot(1, HASH_BOT, "2", "Hash2"));
+	match_result r;
+	VERIFY(engine.run(1, 1000, true, 0, r));
+	VERIFY(result.gamesCount == 2000 && result.pairsCount == 1000);
+	VERIFY(result.result == r.result);
+	VERIFY(result.rate == r.rate());
+	VERIFY(result.stdError == r.std_error());
+	VERIFY(result.duplicateStdError == r.duplicate_std_error());
+	VERIFY(result.duplicateStdError > 0);
+	MatchEngine_Close(e);
+}
+
+static int Test()
+{
+	try
+	{
+		string lutPath = CreateTestLut();
+		Test_DeckStream();
+		Test_Rules(lutPath);
+		Test_Parallel(lutPath);
+		Test_ExampleBot(lutPath);
+		Test_Errors(lutPath);
+		Test_CApi(lutPath);
+	}
+	catch(const char * e)
+	{
+		printf("%s\n", e);
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+
+static void PrintResult(const MatchResult & r, const char * name0)
+{
+	printf("%lld games, %.3f s, %.0f games/s\n", (long long)r.gamesCount, r.seconds, r.gamesCount / r.seconds);
+	printf("%s: %.2f b, %.2f +- %.2f mb/g (duplicate: +- %.2f mb/g)\n", name0, r.result, r.rate,
+		r.stdError, r.duplicateStdError);
+}
+
+static int Match(const char * lutPath, const char * bot0, const char * bot1, int64_t deals, int threads,
+	const char * log)
+{
+	MatchEngine * e = MatchEngine_Open(lutPath, threads);
+	MatchResult r;
+	if(!e || !MatchEngine_LoadBot(e, 0, bot0, "", bot0) || !MatchEngine_LoadBot(e, 1, bot1, "", bot1) ||
+		!MatchEngine_Run(e, (uint64_t)time(0), deals, 1, log, &r))
+	{
+		printf("%s\n", MatchEngine_GetLastError());
+		MatchEngine_Close(e);
+		return 1;
+	}
+	PrintResult(r, bot0);
+	MatchEngine_Close(e);
+	return 0;
+}
+
+static int Benchmark(int64_t deals, int threads, const char * lutPath)
+{
+	string lut = lutPath ? string(lutPath) : CreateTestLut();
+	MatchEngine * e = MatchEngine_Open(lut.c_str(), threads);
+	VERIFY(e != 0);
+	VERIFY(MatchEngine_SetBot(e, 0, &HASH_BOT, "1", "Hash1"));
+	VERIFY(MatchEngine_SetBot(e, 1, &HASH_BOT, "2", "Hash2"));
+	string log = _tempDir + "/MatchEngine-benchmark.bgl";
+	for(int withLog = 0; withLog < 2; ++withLog)
+	{
+		MatchResult r;
+		VERIFY(MatchEngine_Run(e, 1, deals, 1, withLog ? log.c_str() : 0, &r));
+		printf("%d thread(s)%s: ", threads, withLog ? ", with log" : "");
+		PrintResult(r, "Hash1");
+		printf("%.1f M games/min\n", r.gamesCount / r.seconds * 60 / 1e6);
+	}
+	MatchEngine_Close(e);
+	remove(log.c_str());
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "test") == 0)
+	{
+		if(argc >= 3)
+		{
+			_tempDir = argv[2];
+		}
+		if(argc >= 4)
+		{
+			_exampleBot = argv[3];
+		}
+		return Test();
+	}
+	if(argc >= 6 && strcmp(argv[1], "match") == 0)
+	{
+		return Match(argv[2], argv[3], argv[4], atoll(argv[5]), argc >= 7 ? atoi(argv[6]) : 1,
+			argc >= 8 ? argv[7] : 0);
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark") == 0)
+	{
+		try
+		{
+			return Benchmark(argc >= 3 ? atoll(argv[2]) : 500000, argc >= 4 ? atoi(argv[3]) : 4,
+				argc >= 5 ? argv[4] : 0);
+		}
+		catch(const char * e)
+		{
+			printf("%s\n", e);
+			return 1;
+		}
+	}
+	printf("Usage:\n"
+		"%s test [temp-dir] [example-bot-library]\n"
+		"%s match LutEvaluator7.dat bot0-library bot1-library deals [threads] [binary-log]\n"
+		"%s benchmark [deals] [threads] [LutEvaluator7.dat]\n", argv[0], argv[0], argv[0]);
+	return 1;
+}
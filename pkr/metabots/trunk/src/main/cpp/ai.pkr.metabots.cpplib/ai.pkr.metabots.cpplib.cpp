@@ -0,0 +1,105 @@
+// ai.pkr.metabots.cpplib.cpp : Defines the exported functions of the library.
+//
+
+#include <string>
+#include "ai.pkr.metabots.cpplib.h"
+#include "match_engine.h"
+
+using namespace ai::pkr::metabots;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL char _lastError[256];
+
+static void SetError(const std::string & error)
+{
+	std::size_t length = error.copy(_lastError, sizeof(_lastError) - 1);
+	_lastError[length] = 0;
+}
+
+struct MatchEngine
+{
+	match_engine engine;
+};
+
+extern "C"
+{
+
+AIPKRMETABOTSCPPLIB_API MatchEngine * MatchEngine_Open(const char * lutPath, int threadsCount)
+{
+	MatchEngine * e = new MatchEngine;
+	if(!e->engine.load_evaluator(lutPath) || !e->engine.set_thread_count(threadsCount))
+	{
+		SetError(e->engine.error());
+		delete e;
+		return 0;
+	}
+	return e;
+}
+
+AIPKRMETABOTSCPPLIB_API void MatchEngine_Close(MatchEngine * e)
+{
+	delete e;
+}
+
+AIPKRMETABOTSCPPLIB_API const char * MatchEngine_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRMETABOTSCPPLIB_API int MatchEngine_SetBot(MatchEngine * e, int seat, const MatchBotFunctions * functions,
+	const char * parameters, const char * name)
+{
+	if(!e->engine.set_bot(seat, *functions, parameters, name))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETABOTSCPPLIB_API int MatchEngine_LoadBot(MatchEngine * e, int seat, const char * libraryPath,
+	const char * parameters, const char * name)
+{
+	if(!e->engine.load_bot(seat, libraryPath, parameters, name))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETABOTSCPPLIB_API int MatchEngine_SetChunkSize(MatchEngine * e, int chunkSize)
+{
+	if(!e->engine.set_chunk_size(chunkSize))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETABOTSCPPLIB_API int MatchEngine_Run(MatchEngine * e, uint64_t seed, int64_t dealsCount, int duplicate,
+	const char * logFile, MatchResult * result)
+{
+	match_result r;
+	if(!e->engine.run(seed, dealsCount, duplicate != 0, logFile, r))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	result->gamesCount = r.games_count;
+	result->result = r.result;
+	result->rate = r.rate();
+	result->stdError = r.std_error();
+	result->pairsCount = r.pairs_count;
+	result->duplicateStdError = r.duplicate_std_error();
+	result->seconds = r.seconds;
+	return 1;
+}
+
+}
@@ -0,0 +1,75 @@
+// C interface of ai.pkr.metabots.cpplib (ai.pkr.metabots.cpplib.dll on Windows,
+// libai.pkr.metabots.cpplib.so on Linux): the native match engine (see match_engine.h).
+//
+// All files within this library are compiled with the AIPKRMETABOTSCPPLIB_EXPORTS
+// symbol defined. This symbol should not be defined on any project
+// that uses this library. This way any other project whose source files include
+// this file see AIPKRMETABOTSCPPLIB_API functions as being imported, whereas the library
+// sees symbols defined with this macro as being exported.
+
+#ifndef AI_PKR_METABOTS_CPPLIB_H
+#define AI_PKR_METABOTS_CPPLIB_H
+
+#if defined(_WIN32)
+	#ifdef AIPKRMETABOTSCPPLIB_EXPORTS
+		#define AIPKRMETABOTSCPPLIB_API __declspec(dllexport)
+	#else
+		#define AIPKRMETABOTSCPPLIB_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AIPKRMETABOTSCPPLIB_API __attribute__((visibility("default")))
+#else
+	#define AIPKRMETABOTSCPPLIB_API
+#endif
+
+#include <stdint.h>
+#include "match_bot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Opaque handle of a match engine.
+typedef struct MatchEngine MatchEngine;
+
+/// Result of a match for bot 0 (see match_result), amounts in big blinds, rates in milli-big-blinds per game.
+typedef struct MatchResult
+{
+	int64_t gamesCount;
+	double result;
+	double rate;
+	double stdError;
+	int64_t pairsCount;
+	double duplicateStdError;
+	double seconds;
+} MatchResult;
+
+/// Creates an engine with the evaluator LutEvaluator7.dat and threadsCount threads.
+/// Returns 0 on error, see MatchEngine_GetLastError().
+AIPKRMETABOTSCPPLIB_API MatchEngine * MatchEngine_Open(const char * lutPath, int threadsCount);
+
+AIPKRMETABOTSCPPLIB_API void MatchEngine_Close(MatchEngine * e);
+
+/// Description of the last error in this thread.
+AIPKRMETABOTSCPPLIB_API const char * MatchEngine_GetLastError();
+
+/// Sets bot 0 or 1 to in-process functions. Returns 0 on error.
+AIPKRMETABOTSCPPLIB_API int MatchEngine_SetBot(MatchEngine * e, int seat, const MatchBotFunctions * functions,
+	const char * parameters, const char * name);
+
+/// Loads bot 0 or 1 from a shared library exporting the MatchBot_* functions. Returns 0 on error.
+AIPKRMETABOTSCPPLIB_API int MatchEngine_LoadBot(MatchEngine * e, int seat, const char * libraryPath,
+	const char * parameters, const char * name);
+
+/// Sets the number of games in a chunk of the game log. Returns 0 on error.
+AIPKRMETABOTSCPPLIB_API int MatchEngine_SetChunkSize(MatchEngine * e, int chunkSize);
+
+/// Plays a match, writes a binary game log unless logFile is 0. Returns 0 on error.
+AIPKRMETABOTSCPPLIB_API int MatchEngine_Run(MatchEngine * e, uint64_t seed, int64_t dealsCount, int duplicate,
+	const char * logFile, MatchResult * result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
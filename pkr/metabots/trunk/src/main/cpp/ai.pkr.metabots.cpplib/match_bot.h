@@ -0,0 +1,87 @@
+/*  C interface of the bots played by the native match engine (heads-up fixed limit hold'em,
+    see match_engine.h).
+
+    A bot is either a shared library exporting the functions below (MatchBot_Create() etc.), or
+    a MatchBotFunctions table registered in-process. In contrast to ai.pkr.bifaces.capi the bot
+    gets a compact game state instead of a game string, so that millions of games can be played.
+
+    The engine creates an instance of a bot for each of its threads, an instance is called
+    from one thread only. The game follows holdem-gd-fl-2.xml: blinds 0.5 and 1, bets 1, 1, 2, 2,
+    at most 4 bets per round (the big blind counts), no stacks.
+*/
+
+#ifndef AI_PKR_METABOTS_CPPLIB_MATCH_BOT_H
+#define AI_PKR_METABOTS_CPPLIB_MATCH_BOT_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+	#define MATCH_BOT_EXPORT __declspec(dllexport)
+#elif defined(__GNUC__)
+	#define MATCH_BOT_EXPORT __attribute__((visibility("default")))
+#else
+	#define MATCH_BOT_EXPORT
+#endif
+
+/// Player actions, the values of Ak (C#).
+#define MATCH_FOLD 2
+#define MATCH_CALL 3
+#define MATCH_RAISE 4
+
+/// Maximal number of player actions in a game.
+#define MATCH_MAX_ACTIONS 32
+
+/// Fields of MatchState.actions[i].
+#define MATCH_ACTION_KIND(a) ((a) & 7)
+#define MATCH_ACTION_POSITION(a) (((a) >> 3) & 1)
+#define MATCH_ACTION_ROUND(a) (((a) >> 4) & 3)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// State of a game from the point of view of a bot.
+typedef struct MatchState
+{
+	/// Position of the bot: 0 - small blind (acts first pre-flop), 1 - big blind (acts first post-flop).
+	int32_t position;
+	/// 0: pre-flop, 1: flop, 2: turn, 3: river.
+	int32_t round;
+	/// Cards are StdDeck indexes: 0: 2c, 1: 3c, ..., 12: Ac, 13: 2d, ..., 51: As.
+	int32_t pocket[2];
+	/// Cards of the opponent, shown at the showdown in MatchBot_OnGameEnd(), otherwise -1.
+	int32_t oppPocket[2];
+	int32_t board[5];
+	int32_t boardCount;
+	/// Number of bets in the current round, a raise is not allowed (becomes a call) at 4.
+	int32_t betsCount;
+	/// Amount in pot by position.
+	double inPot[2];
+	int32_t actionsCount;
+	/// Player actions of the game so far, kind | position << 3 | round << 4.
+	uint8_t actions[MATCH_MAX_ACTIONS];
+} MatchState;
+
+/// A bot registered in-process, the same functions as exported by a bot library.
+typedef struct MatchBotFunctions
+{
+	/// Creates an instance for thread threadIndex of the engine. Returns 0 on error.
+	void * (*create)(const char * parameters, int threadIndex);
+	void (*destroy)(void * bot);
+	/// Returns MATCH_FOLD, MATCH_CALL or MATCH_RAISE (other values are a fold).
+	int (*act)(void * bot, const MatchState * state);
+	/// Optional (can be 0), called at the end of each game with the result of the bot.
+	void (*onGameEnd)(void * bot, const MatchState * state, double result);
+} MatchBotFunctions;
+
+/// Functions exported by a bot library, MatchBot_OnGameEnd() is optional.
+MATCH_BOT_EXPORT void * MatchBot_Create(const char * parameters, int threadIndex);
+MATCH_BOT_EXPORT void MatchBot_Destroy(void * bot);
+MATCH_BOT_EXPORT int MatchBot_Act(void * bot, const MatchState * state);
+MATCH_BOT_EXPORT void MatchBot_OnGameEnd(void * bot, const MatchState * state, double result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,523 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <game_log_writer.h>
+#include "match_engine.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace ai::pkr::stdpoker;
+using namespace ai::pkr::metatools;
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metabots
+		{
+
+			namespace
+			{
+				// The game of holdem-gd-fl-2.xml.
+				const double BLINDS[2] = {0.5, 1};
+				const double BET_SIZES[4] = {1, 1, 2, 2};
+				const int MAX_BETS = 4;
+				/// Number of board cards dealt in round 1..3.
+				const int BOARD_DEALS[4] = {0, 3, 1, 1};
+
+				const char * const CARD_NAMES[52] =
+				{
+					"2c", "3c", "4c", "5c", "6c", "7c", "8c", "9c", "Tc", "Jc", "Qc", "Kc", "Ac",
+					"2d", "3d", "4d", "5d", "6d", "7d", "8d", "9d", "Td", "Jd", "Qd", "Kd", "Ad",
+					"2h", "3h", "4h", "5h", "6h", "7h", "8h", "9h", "Th", "Jh", "Qh", "Kh", "Ah",
+					"2s", "3s", "4s", "5s", "6s", "7s", "8s", "9s", "Ts", "Js", "Qs", "Ks", "As"
+				};
+
+				uint64_t SplitMix64(uint64_t & state)
+				{
+					uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+					z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+					z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+					return z ^ (z >> 31);
+				}
+
+				/// Cards as in a game string, e.g. "Ac Ad".
+				std::string CardsToString(const int32_t * cards, int count)
+				{
+					std::string s;
+					for(int i = 0; i < count; ++i)
+					{
+						if(i > 0)
+						{
+							s += ' ';
+						}
+						s += CARD_NAMES[cards[i]];
+					}
+					return s;
+				}
+
+				/// The bots of a game by position.
+				struct game_bots
+				{
+					const MatchBotFunctions * functions[2];
+					void * instances[2];
+				};
+
+				void EndGame(MatchState & s, const int32_t * deal, const game_bots & bots, double result0, bool showdown)
+				{
+					for(int p = 0; p < 2; ++p)
+					{
+						if(!bots.functions[p]->onGameEnd)
+						{
+							continue;
+						}
+						s.position = p;
+						s.pocket[0] = deal[2 * p];
+						s.pocket[1] = deal[2 * p + 1];
+						s.oppPocket[0] = showdown ? deal[2 * (1 - p)] : -1;
+						s.oppPocket[1] = showdown ? deal[2 * (1 - p) + 1] : -1;
+						bots.functions[p]->onGameEnd(bots.instances[p], &s, p == 0 ? result0 : -result0);
+					}
+				}
+
+				/** Plays a game of a deal (see deck_stream), adds the actions to log (if not 0).
+				@return the result of position 0.
+				*/
+				double PlayGame(const int32_t * deal, const game_bots & bots, const lut_evaluator7 & evaluator,
+					game_log_chunk_builder * log)
+				{
+					MatchState s;
+					s.round = 0;
+					s.oppPocket[0] = s.oppPocket[1] = -1;
+					s.boardCount = 0;
+					s.betsCount = 1;
+					s.inPot[0] = BLINDS[0];
+					s.inPot[1] = BLINDS[1];
+					s.actionsCount = 0;
+					if(log)
+					{
+						log->add_action(ak_d, 0, 0, CardsToString(deal, 2));
+						log->add_action(ak_d, 1, 0, CardsToString(deal + 2, 2));
+					}
+					int actor = 0;
+					int roundActions = 0;
+					for(;;)
+					{
+						s.position = actor;
+						s.pocket[0] = deal[2 * actor];
+						s.pocket[1] = deal[2 * actor + 1];
+						int kind = bots.functions[actor]->act(bots.instances[actor], &s);
+						// Adjust the action like GameRunner.AdjustAction() (C#).
+						if(kind == MATCH_RAISE && s.betsCount >= MAX_BETS)
+						{
+							kind = MATCH_CALL;
+						}
+						else if(kind != MATCH_CALL && kind != MATCH_RAISE)
+						{
+							kind = MATCH_FOLD;
+						}
+						s.actions[s.actionsCount++] = (uint8_t)(kind | actor << 3 | s.round << 4);
+						if(kind == MATCH_FOLD)
+						{
+							if(log)
+							{
+								log->add_action(ak_f, actor, 0, std::string());
+							}
+							double result0 = actor == 0 ? -s.inPot[0] : s.inPot[1];
+							EndGame(s, deal, bots, result0, false);
+							return result0;
+						}
+						double amount = 0;
+						if(kind == MATCH_RAISE)
+						{
+							amount = BET_SIZES[s.round];
+							s.betsCount++;
+						}
+						s.inPot[actor] = s.inPot[1 - actor] + amount;
+						if(log)
+						{
+							log->add_action((action_kind)kind, actor, amount, std::string());
+						}
+						actor = 1 - actor;
+						if(++roundActions >= 2 && kind == MATCH_CALL)
+						{
+							if(s.round == 3)
+							{
+								break;
+							}
+							s.round++;
+							int count = BOARD_DEALS[s.round];
+							if(log)
+							{
+								log->add_action(ak_d, -1, 0, CardsToString(deal + 4 + s.boardCount, count));
+							}
+							for(int i = 0; i < count; ++i, ++s.boardCount)
+							{
+								s.board[s.boardCount] = deal[4 + s.boardCount];
+							}
+							s.betsCount = 0;
+							roundActions = 0;
+							actor = 1;
+						}
+					}
+					int32_t hands[2][7];
+					for(int p = 0; p < 2; ++p)
+					{
+						hands[p][0] = deal[2 * p];
+						hands[p][1] = deal[2 * p + 1];
+						std::copy(deal + 4, deal + 9, hands[p] + 2);
+					}
+					uint32_t rank0 = evaluator.evaluate(hands[0]);
+					uint32_t rank1 = evaluator.evaluate(hands[1]);
+					// Equal amounts in pot after the last call.
+					double result0 = rank0 > rank1 ? s.inPot[1] : (rank0 < rank1 ? -s.inPot[0] : 0);
+					EndGame(s, deal, bots, result0, true);
+					return result0;
+				}
+
+				void * LoadBotLibrary(const char * path, std::string & error)
+				{
+#ifdef _WIN32
+					void * library = (void *)::LoadLibraryA(path);
+					if(!library)
+					{
+						error = std::string("cannot load ") + path;
+					}
+#else
+					void * library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+					if(!library)
+					{
+						error = std::string("cannot load ") + path + ": " + dlerror();
+					}
+#endif
+					return library;
+				}
+
+				void * GetBotSymbol(void * library, const char * name)
+				{
+#ifdef _WIN32
+					return (void *)::GetProcAddress((HMODULE)library, name);
+#else
+					return dlsym(library, name);
+#endif
+				}
+
+				void FreeBotLibrary(void * library)
+				{
+#ifdef _WIN32
+					::FreeLibrary((HMODULE)library);
+#else
+					dlclose(library);
+#endif
+				}
+			}
+
+			void deck_stream::deal(uint64_t seed, int64_t index, int32_t * cards)
+			{
+				uint64_t state = seed;
+				state = SplitMix64(state) + (uint64_t)index * 0xD1B54A32D192ED03ULL;
+				int32_t deck[52];
+				for(int i = 0; i < 52; ++i)
+				{
+					deck[i] = i;
+				}
+				// Partial Fisher-Yates shuffle.
+				for(int i = 0; i < DEAL_SIZE; ++i)
+				{
+					uint64_t r = SplitMix64(state);
+					int j = i + (int)(((r >> 32) * (uint64_t)(52 - i)) >> 32);
+					std::swap(deck[i], deck[j]);
+					cards[i] = deck[i];
+				}
+			}
+
+			double match_result::std_error() const
+			{
+				if(games_count < 2)
+				{
+					return 0;
+				}
+				double mean = result / games_count;
+				double variance = (std::max)(0.0, result_sq / games_count - mean * mean);
+				return 1000 * std::sqrt(variance / games_count);
+			}
+
+			double match_result::duplicate_std_error() const
+			{
+				if(pairs_count < 2)
+				{
+					return 0;
+				}
+				double mean = result / pairs_count;
+				double variance = (std::max)(0.0, pair_result_sq / pairs_count - mean * mean);
+				// A pair has 2 games.
+				return 1000 * std::sqrt(variance / pairs_count) / 2;
+			}
+
+			match_engine::match_engine() : _thread_count(1), _chunk_size(16384)
+			{
+			}
+
+			match_engine::~match_engine()
+			{
+				unload_bot(0);
+				unload_bot(1);
+			}
+
+			bool match_engine::load_evaluator(const char * lut_path)
+			{
+				if(!_evaluator.open(lut_path))
+				{
+					return fail(_evaluator.error());
+				}
+				return true;
+			}
+
+			bool match_engine::set_bot(int seat, const MatchBotFunctions & functions, const char * parameters,
+				const char * name)
+			{
+				if(seat < 0 || seat > 1)
+				{
+					return fail("the seat must be 0 or 1");
+				}
+				if(!functions.create || !functions.destroy || !functions.act)
+				{
+					return fail("the bot functions create, destroy and act are required");
+				}
+				unload_bot(seat);
+				_bots[seat].functions = functions;
+				_bots[seat].parameters = parameters ? parameters : "";
+				_bots[seat].name = name ? name : "";
+				return true;
+			}
+
+			bool match_engine::load_bot(int seat, const char * library_path, const char * parameters, const char * name)
+			{
+				if(seat < 0 || seat > 1)
+				{
+					return fail("the seat must be 0 or 1");
+				}
+				std::string error;
+				void * library = LoadBotLibrary(library_path, error);
+				if(!library)
+				{
+					return fail(error);
+				}
+				MatchBotFunctions functions;
+				functions.create = (void * (*)(const char *, int))GetBotSymbol(library, "MatchBot_Create");
+				functions.destroy = (void (*)(void *))GetBotSymbol(library, "MatchBot_Destroy");
+				functions.act = (int (*)(void *, const MatchState *))GetBotSymbol(library, "MatchBot_Act");
+				functions.onGameEnd = (void (*)(void *, const MatchState *, double))GetBotSymbol(library, "MatchBot_OnGameEnd");
+				if(!set_bot(seat, functions, parameters, name))
+				{
+					FreeBotLibrary(library);
+					return fail(std::string("cannot find the MatchBot functions in ") + library_path);
+				}
+				_bots[seat].library = library;
+				return true;
+			}
+
+			void match_engine::unload_bot(int seat)
+			{
+				if(_bots[seat].library)
+				{
+					FreeBotLibrary(_bots[seat].library);
+				}
+				_bots[seat] = bot();
+			}
+
+			bool match_engine::set_thread_count(int thread_count)
+			{
+				if(thread_count < 1)
+				{
+					return fail("the number of threads must be positive");
+				}
+				_thread_count = thread_count;
+				return true;
+			}
+
+			bool match_engine::set_chunk_size(int chunk_size)
+			{
+				if(chunk_size < 2)
+				{
+					return fail("the chunk size must be at least 2");
+				}
+				_chunk_size = chunk_size;
+				return true;
+			}
+
+			bool match_engine::run(uint64_t seed, int64_t deals_count, bool duplicate, const char * log_file,
+				match_result & result)
+			{
+				result = match_result();
+				if(!_bots[0].functions.act || !_bots[1].functions.act)
+				{
+					return fail("both bots must be set");
+				}
+				if(!_evaluator.lut())
+				{
+					return fail("the evaluator is not loaded");
+				}
+				if(deals_count < 0)
+				{
+					return fail("the number of deals must not be negative");
+				}
+				game_log_writer writer;
+				if(log_file && !writer.open(log_file))
+				{
+					return fail(writer.error());
+				}
+				const double start = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+				const int gamesPerDeal = duplicate ? 2 : 1;
+				const int64_t blockDeals = _chunk_size / gamesPerDeal;
+				const int64_t blocksCount = (deals_count + blockDeals - 1) / blockDeals;
+				const std::string sessionName = _bots[0].name + " vs " + _bots[1].name;
+				bool ok = true;
+				std::string error;
+
+#ifdef _OPENMP
+				#pragma omp parallel num_threads(_thread_count)
+#endif
+				{
+#ifdef _OPENMP
+					const int threadIndex = omp_get_thread_num();
+#else
+					const int threadIndex = 0;
+#endif
+					void * instances[2] = {0, 0};
+					for(int b = 0; b < 2; ++b)
+					{
+						instances[b] = _bots[b].functions.create(_bots[b].parameters.c_str(), threadIndex);
+						if(!instances[b])
+						{
+#ifdef _OPENMP
+							#pragma omp critical
+#endif
+							{
+								ok = false;
+								error = "cannot create bot " + _bots[b].name;
+							}
+						}
+					}
+					match_result acc;
+					game_log_chunk_builder chunk;
+					int32_t deal[deck_stream::DEAL_SIZE];
+
+#ifdef _OPENMP
+					#pragma omp for schedule(dynamic, 1) ordered
+#endif
+					for(int64_t block = 0; block < blocksCount; ++block)
+					{
+						if(instances[0] && instances[1])
+						{
+							game_log_chunk_builder * log = log_file ? &chunk : 0;
+							if(log)
+							{
+								chunk.clear();
+								chunk.set_session(1);
+								if(block == 0)
+								{
+									chunk.begin_session(1, sessionName);
+								}
+							}
+							const int64_t end = (std::min)(deals_count, (block + 1) * blockDeals);
+							for(int64_t d = block * blockDeals; d < end; ++d)
+							{
+								deck_stream::deal(seed, d, deal);
+								double pairResult = 0;
+								for(int g = 0; g < gamesPerDeal; ++g)
+								{
+									// Seat of the bot in position 0, in a duplicate pair the seats are swapped.
+									const int first = duplicate ? g : (int)(d & 1);
+									game_bots bots;
+									for(int p = 0; p < 2; ++p)
+									{
+										bots.functions[p] = &_bots[first ^ p].functions;
+										bots.instances[p] = instances[first ^ p];
+									}
+									if(log)
+									{
+										log->add_game(std::to_string(d * gamesPerDeal + g), true);
+									}
+									double result0 = PlayGame(deal, bots, _evaluator, log);
+									if(log)
+									{
+										log->add_player(_bots[first].name, 0, BLINDS[0], result0);
+										log->add_player(_bots[1 - first].name, 0, BLINDS[1], -result0);
+									}
+									double botResult = first == 0 ? result0 : -result0;
+									acc.result += botResult;
+									acc.result_sq += botResult * botResult;
+									pairResult += botResult;
+								}
+								acc.games_count += gamesPerDeal;
+								if(duplicate)
+								{
+									acc.pairs_count++;
+									acc.pair_result_sq += pairResult * pairResult;
+								}
+							}
+						}
+#ifdef _OPENMP
+						#pragma omp ordered
+#endif
+						{
+							if(log_file && ok && !writer.write(chunk))
+							{
+								ok = false;
+								error = writer.error();
+							}
+						}
+					}
+
+#ifdef _OPENMP
+					#pragma omp critical
+#endif
+					{
+						result.games_count += acc.games_count;
+						result.result += acc.result;
+						result.result_sq += acc.result_sq;
+						result.pairs_count += acc.pairs_count;
+						result.pair_result_sq += acc.pair_result_sq;
+					}
+					for(int b = 0; b < 2; ++b)
+					{
+						if(instances[b])
+						{
+							_bots[b].functions.destroy(instances[b]);
+						}
+					}
+				}
+
+				if(log_file && !writer.close() && ok)
+				{
+					ok = false;
+					error = writer.error();
+				}
+				result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count() - start;
+				if(!ok)
+				{
+					return fail(error);
+				}
+				return true;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,141 @@
+#ifndef AI_PKR_METABOTS_CPPLIB_MATCH_ENGINE_H
+#define AI_PKR_METABOTS_CPPLIB_MATCH_ENGINE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <lut_evaluator7.h>
+#include "match_bot.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metabots
+		{
+
+			/** Stream of preshuffled decks: deal i is a function of (seed, i) only, therefore a match
+			is reproducible with any number of threads, and both games of a duplicate pair get the same deal.
+			*/
+			class deck_stream
+			{
+			public:
+				/// Cards of a deal: pocket of position 0, pocket of position 1, board.
+				static const int DEAL_SIZE = 9;
+
+				static void deal(uint64_t seed, int64_t index, int32_t * cards);
+			};
+
+			/// Result of a match from the point of view of bot 0 (bot 1 has the opposite result), in big blinds.
+			struct match_result
+			{
+				match_result() : games_count(0), result(0), result_sq(0), pairs_count(0), pair_result_sq(0), seconds(0)
+				{
+				}
+
+				int64_t games_count;
+				double result;
+				/// Sum of the squared game results.
+				double result_sq;
+				/// Number of duplicate pairs (games of a deal with swapped seats).
+				int64_t pairs_count;
+				/// Sum of the squared results of the pairs.
+				double pair_result_sq;
+				double seconds;
+
+				/// Result in milli-big-blinds per game (like TotalResult.Player.Rate()).
+				double rate() const
+				{
+					return games_count == 0 ? 0 : 1000 * result / games_count;
+				}
+
+				/// Standard error of rate() estimated by the variance of the games.
+				double std_error() const;
+
+				/// Standard error of rate() estimated by the variance of the duplicate pairs, 0 without pairs.
+				double duplicate_std_error() const;
+			};
+
+			/** Plays matches of two bots in heads-up fixed limit hold'em at a high rate,
+			a native alternative to SessionSuiteRunner for bot-vs-bot evaluation of native bots.
+
+			The games are played by blocks of deals in parallel, each thread has its own instances of the bots.
+			In a duplicate match each deal is played twice, the second time with the seats swapped,
+			so that each bot gets the cards of the other, which removes most of the luck of the cards.
+			The games can be written to a binary game log (see BinaryGameLogWriter in C#), which can be
+			analyzed with pkrlogstat --binary.
+			*/
+			class match_engine
+			{
+			public:
+				match_engine();
+				~match_engine();
+
+				/// Loads LutEvaluator7.dat for the showdowns.
+				bool load_evaluator(const char * lut_path);
+
+				/// Sets bot 0 or 1 to in-process functions.
+				bool set_bot(int seat, const MatchBotFunctions & functions, const char * parameters, const char * name);
+
+				/// Loads bot 0 or 1 from a shared library exporting the MatchBot_* functions.
+				bool load_bot(int seat, const char * library_path, const char * parameters, const char * name);
+
+				/// Sets the number of threads, default: 1.
+				bool set_thread_count(int thread_count);
+
+				/// Sets the number of games in a chunk of the game log (and in a block of work of a thread), default: 16384.
+				bool set_chunk_size(int chunk_size);
+
+				/** Plays deals_count deals (2 * deals_count games if duplicate, otherwise the bots change
+				the seats every game). Writes the games to log_file unless it is 0.
+				@return false on error, see error().
+				*/
+				bool run(uint64_t seed, int64_t deals_count, bool duplicate, const char * log_file, match_result & result);
+
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+			private:
+				struct bot
+				{
+					bot() : library(0)
+					{
+						functions.create = 0;
+						functions.destroy = 0;
+						functions.act = 0;
+						functions.onGameEnd = 0;
+					}
+
+					MatchBotFunctions functions;
+					std::string parameters;
+					std::string name;
+					/// Handle of the loaded library or 0.
+					void * library;
+				};
+
+				bool fail(const std::string & error)
+				{
+					_error = error;
+					return false;
+				}
+
+				void unload_bot(int seat);
+
+				// Not copyable.
+				match_engine(const match_engine &);
+				match_engine & operator = (const match_engine &);
+
+				bot _bots[2];
+				int _thread_count;
+				int _chunk_size;
+				ai::pkr::stdpoker::lut_evaluator7 _evaluator;
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,108 @@
+// example_bot.cpp : An example of a bot library for the native match engine (see match_bot.h).
+//
+// A simple rule bot: pre-flop it raises with pairs and two high cards, calls with an ace or
+// suited connectors and folds the rest to a raise; post-flop it raises if a pocket card pairs
+// the board (or with a pocket pair), calls one bet and folds to more.
+// Parameters: "passive" never raises.
+
+#include <cstring>
+#include "match_bot.h"
+
+namespace
+{
+	struct ExampleBot
+	{
+		bool passive;
+	};
+
+	int Rank(int32_t card)
+	{
+		return card % 13;
+	}
+
+	int Suit(int32_t card)
+	{
+		return card / 13;
+	}
+
+	/// Number of bets the opponent made in the current round.
+	int OppBets(const MatchState * s)
+	{
+		int bets = 0;
+		for(int i = 0; i < s->actionsCount; ++i)
+		{
+			uint8_t a = s->actions[i];
+			if(MATCH_ACTION_ROUND(a) == s->round && MATCH_ACTION_POSITION(a) != s->position &&
+				MATCH_ACTION_KIND(a) == MATCH_RAISE)
+			{
+				++bets;
+			}
+		}
+		return bets;
+	}
+
+	int PreFlop(const MatchState * s)
+	{
+		int r0 = Rank(s->pocket[0]), r1 = Rank(s->pocket[1]);
+		int high = r0 > r1 ? r0 : r1, low = r0 > r1 ? r1 : r0;
+		// Ranks: 0 is a deuce, 8 a ten, 12 an ace.
+		if(r0 == r1 || low >= 8)
+		{
+			return MATCH_RAISE;
+		}
+		bool suitedConnectors = Suit(s->pocket[0]) == Suit(s->pocket[1]) && high - low == 1;
+		if(high == 12 || suitedConnectors || s->inPot[s->position] == s->inPot[1 - s->position])
+		{
+			return MATCH_CALL;
+		}
+		return s->betsCount > 1 ? MATCH_FOLD : MATCH_CALL;
+	}
+
+	int PostFlop(const MatchState * s)
+	{
+		bool pair = Rank(s->pocket[0]) == Rank(s->pocket[1]);
+		for(int i = 0; i < s->boardCount; ++i)
+		{
+			for(int p = 0; p < 2; ++p)
+			{
+				pair = pair || Rank(s->pocket[p]) == Rank(s->board[i]);
+			}
+		}
+		if(pair)
+		{
+			return MATCH_RAISE;
+		}
+		if(s->inPot[s->position] == s->inPot[1 - s->position])
+		{
+			return MATCH_CALL;
+		}
+		return OppBets(s) <= 1 ? MATCH_CALL : MATCH_FOLD;
+	}
+}
+
+extern "C"
+{
+
+MATCH_BOT_EXPORT void * MatchBot_Create(const char * parameters, int /*threadIndex*/)
+{
+	ExampleBot * bot = new ExampleBot;
+	bot->passive = parameters && strstr(parameters, "passive") != 0;
+	return bot;
+}
+
+MATCH_BOT_EXPORT void MatchBot_Destroy(void * bot)
+{
+	delete (ExampleBot *)bot;
+}
+
+MATCH_BOT_EXPORT int MatchBot_Act(void * bot, const MatchState * state)
+{
+	int action = state->round == 0 ? PreFlop(state) : PostFlop(state);
+	if(action == MATCH_RAISE && ((ExampleBot *)bot)->passive)
+	{
+		action = MATCH_CALL;
+	}
+	return action;
+}
+
+}
@@ -0,0 +1,1309 @@
+// ai.pkr.metastrategy.cpplib-runner.cpp : Tests and benchmarks for ai.pkr.metastrategy.cpplib.
+//
+// Usage:
+//   ai.pkr.metastrategy.cpplib-runner test [temp-dir]
+//       Runs the tests (on synthetic games, no data files are required).
+//   ai.pkr.metastrategy.cpplib-runner br <threads> <action-tree> <chance-tree> <strategy-tree-0> <strategy-tree-1> ...
+//       Calculates the best responses against the strategies from the files written by UFTree.Write()
+//       (absolute strategy trees, one per position).
+//   ai.pkr.metastrategy.cpplib-runner cfr <threads> <iterations> <action-tree> <chance-tree>
+//       Solves a heads-up game with CFR+, prints the exploitability of the average strategy.
+//   ai.pkr.metastrategy.cpplib-runner mccfr <threads> <iterations> <action-tree> <chance-tree>
+//       Runs Monte-Carlo CFR on a heads-up game, prints the speed (the exploitability is checked by McCfr, C#).
+//   ai.pkr.metastrategy.cpplib-runner benchmark [threads] [cards]
+//       Calculates the best response in a large synthetic game with 1 and with the given number of threads.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include "ai.pkr.metastrategy.cpplib.h"
+#include "br_engine.h"
+#include "cfr_engine.h"
+#include "mccfr_engine.h"
+#include <ai.lib.utils.cpp/bds_version.h>
+
+using namespace std;
+using namespace ai::pkr::metastrategy;
+
+static string _tempDir = ".";
+
+#define VERIFY(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); throw "Test failed"; }
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// A simple deterministic RNG (the tests must be reproducible).
+class Rng
+{
+public:
+	Rng(uint64_t seed) : _state(seed * 2862933555777941757ULL + 3037000493ULL)
+	{}
+
+	uint32_t Next(uint32_t n)
+	{
+		_state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (uint32_t)((_state >> 33) % n);
+	}
+
+	double NextDouble()
+	{
+		return (Next(1 << 30) + 0.5) / (1 << 30);
+	}
+private:
+	uint64_t _state;
+};
+
+/// A tree in preorder, as stored in UFTree.
+template<class NodeT> struct Tree
+{
+	vector<uint8_t> depths;
+	vector<NodeT> nodes;
+	/// Children of each node (not stored in UFTree, used by the test code).
+	vector<vector<int> > children;
+
+	int Add(int parent, const NodeT & node)
+	{
+		int i = (int)nodes.size();
+		nodes.push_back(node);
+		depths.push_back(parent < 0 ? 0 : (uint8_t)(depths[parent] + 1));
+		children.push_back(vector<int>());
+		if(parent >= 0)
+		{
+			children[parent].push_back(i);
+		}
+		return i;
+	}
+};
+
+/** A game for the tests: the trees and the conditional strategies of all players.
+The nodes of the action tree are added in preorder by the generators.
+*/
+struct Game
+{
+	int playersCount;
+	int roundsCount;
+	/// cardsCount[p][r]: number of cards of player p in round r.
+	vector<vector<int> > cardsCount;
+	Tree<action_tree_node> at;
+	Tree<chance_tree_node> ct;
+	/// Conditional strategy: strategy[p][(action node, chance index of p)] - probabilities of the children.
+	vector<map<pair<int, int>, vector<double> > > strategy;
+	vector<Tree<strategy_tree_node> > st;
+
+	int IndexSize(int p, int round) const
+	{
+		int size = 1;
+		for(int r = 0; r <= round; ++r)
+		{
+			size *= cardsCount[p][r];
+		}
+		return size;
+	}
+};
+
+static action_tree_node ActionNode(int position, int round, double amount, uint16_t activePlayers)
+{
+	action_tree_node n;
+	n.position = (int8_t)position;
+	n.round = (int8_t)round;
+	n.amount = amount;
+	n.active_players = activePlayers;
+	return n;
+}
+
+static int AddBlinds(Game & g)
+{
+	uint16_t active = (uint16_t)((1 << g.playersCount) - 1);
+	int node = g.at.Add(-1, ActionNode(g.playersCount, -1, 0, active));
+	for(int p = 0; p < g.playersCount; ++p)
+	{
+		node = g.at.Add(node, ActionNode(p, -1, 1, active));
+	}
+	return node;
+}
+
+/** Adds random actions of a round. Each child is either a fold (a leaf), the next action
+of the round or the last action of the round (followed by the next round or the showdown).
+*/
+static void AddRandomActions(Rng & rng, Game & g, int parent, int round, int actor, int step)
+{
+	uint16_t active = g.at.nodes[parent].active_players;
+	int count = step >= 2 ? 1 : 2 + rng.Next(2);
+	for(int i = 0; i < count; ++i)
+	{
+		// A fold is a leaf, so it is allowed only if one player remains.
+		uint16_t foldActive = (uint16_t)(active & ~(1 << actor));
+		bool isFold = i == 0 && count > 1 && (foldActive & (foldActive - 1)) == 0 && rng.Next(2) == 0;
+		uint16_t childActive = isFold ? foldActive : active;
+		int child = g.at.Add(parent, ActionNode(actor, round, i + rng.Next(2) * 0.5, childActive));
+		if(isFold)
+		{
+			continue;
+		}
+		bool isLast = step >= 2 || rng.Next(2) == 0;
+		if(!isLast)
+		{
+			AddRandomActions(rng, g, child, round, (actor + 1) % g.playersCount, step + 1);
+		}
+		else if(round + 1 < g.roundsCount)
+		{
+			AddRandomActions(rng, g, child, round + 1, 0, 0);
+		}
+	}
+}
+
+/** Adds the chance nodes of a round to the chance node, each player gets a card independently
+with random probabilities.
+*/
+static void AddRandomChance(Rng & rng, Game & g, int parent, int round, int position)
+{
+	if(round == g.roundsCount)
+	{
+		return;
+	}
+	int count = g.cardsCount[position][round];
+	vector<double> weights(count);
+	double sum = 0;
+	for(int c = 0; c < count; ++c)
+	{
+		sum += weights[c] = 0.1 + rng.NextDouble();
+	}
+	for(int c = 0; c < count; ++c)
+	{
+		chance_tree_node n;
+		n.probab = g.ct.nodes[parent].probab * weights[c] / sum;
+		n.pot_share0 = rng.Next(3) * 0.5;
+		n.card = (uint8_t)c;
+		n.position = (int8_t)position;
+		int child = g.ct.Add(parent, n);
+		int next = (position + 1) % g.playersCount;
+		AddRandomChance(rng, g, child, next == 0 ? round + 1 : round, next);
+	}
+}
+
+static void AddChanceRoot(Game & g)
+{
+	chance_tree_node root;
+	root.probab = 1;
+	root.pot_share0 = 0;
+	root.card = 0;
+	root.position = (int8_t)g.playersCount;
+	g.ct.Add(-1, root);
+}
+
+/// Sets a random conditional strategy of player p in all his nodes.
+static void SetRandomStrategy(Rng & rng, Game & g, int p)
+{
+	for(size_t a = 0; a < g.at.nodes.size(); ++a)
+	{
+		const vector<int> & ch = g.at.children[a];
+		if(ch.empty() || g.at.nodes[ch[0]].position != p || g.at.nodes[ch[0]].round < 0)
+		{
+			continue;
+		}
+		int round = g.at.nodes[ch[0]].round;
+		for(int idx = 0; idx < g.IndexSize(p, round); ++idx)
+		{
+			vector<double> s(ch.size());
+			double sum = 0;
+			for(size_t i = 0; i < ch.size(); ++i)
+			{
+				// Sometimes pure strategies, to have zero reaches.
+				sum += s[i] = rng.Next(4) == 0 ? 0 : rng.NextDouble();
+			}
+			for(size_t i = 0; i < ch.size(); ++i)
+			{
+				s[i] = sum == 0 ? (i == 0 ? 1 : 0) : s[i] / sum;
+			}
+			g.strategy[p][make_pair((int)a, idx)] = s;
+		}
+	}
+}
+
+static strategy_tree_node StrategyNode(bool isDealer, int position, int value, double probab)
+{
+	strategy_tree_node n;
+	n.id = (isDealer ? 1 : 0) | (position << 1) | (value << 4);
+	n.probab = probab;
+	return n;
+}
+
+static void AddStrategyActions(const Game & g, int p, Tree<strategy_tree_node> & st, int sParent, int a, int idx,
+	double probab);
+
+/// Adds the strategy nodes for the children of action node a, with the dealer nodes if a round begins.
+static void AddStrategyChildren(const Game & g, int p, Tree<strategy_tree_node> & st, int sParent, int a, int idx,
+	double probab)
+{
+	const vector<int> & ch = g.at.children[a];
+	if(ch.empty())
+	{
+		return;
+	}
+	int round = g.at.nodes[ch[0]].round;
+	if(round == g.at.nodes[a].round)
+	{
+		AddStrategyActions(g, p, st, sParent, a, idx, probab);
+		return;
+	}
+	for(int c = 0; c < g.cardsCount[p][round]; ++c)
+	{
+		int s = st.Add(sParent, StrategyNode(true, p, c, probab));
+		AddStrategyActions(g, p, st, s, a, idx + g.IndexSize(p, round - 1) * c, probab);
+	}
+}
+
+static void AddStrategyActions(const Game & g, int p, Tree<strategy_tree_node> & st, int sParent, int a, int idx,
+	double probab)
+{
+	const vector<int> & ch = g.at.children[a];
+	for(size_t i = 0; i < ch.size(); ++i)
+	{
+		const action_tree_node & n = g.at.nodes[ch[i]];
+		double childProbab = probab;
+		if(n.position == p && n.round >= 0)
+		{
+			childProbab *= g.strategy[p].find(make_pair(a, idx))->second[i];
+		}
+		int units = (int)floor(n.amount / strategy_tree_node::AMOUNT_FACTOR + 0.5);
+		int s = st.Add(sParent, StrategyNode(false, n.position, units, childProbab));
+		AddStrategyChildren(g, p, st, s, ch[i], idx, childProbab);
+	}
+}
+
+/// Creates the absolute strategy trees from the conditional strategies.
+static void CreateStrategyTrees(Game & g)
+{
+	g.st.assign(g.playersCount, Tree<strategy_tree_node>());
+	for(int p = 0; p < g.playersCount; ++p)
+	{
+		int root = g.st[p].Add(-1, StrategyNode(false, g.playersCount, 0, 1));
+		AddStrategyChildren(g, p, g.st[p], root, 0, 0, 1);
+	}
+}
+
+static void CreateRandomGame(Rng & rng, int playersCount, int roundsCount, int maxCards, Game & g)
+{
+	g = Game();
+	g.playersCount = playersCount;
+	g.roundsCount = roundsCount;
+	g.cardsCount.assign(playersCount, vector<int>(roundsCount));
+	for(int p = 0; p < playersCount; ++p)
+	{
+		for(int r = 0; r < roundsCount; ++r)
+		{
+			g.cardsCount[p][r] = r == 0 ? maxCards : 1 + rng.Next(maxCards);
+		}
+	}
+	int blinds = AddBlinds(g);
+	AddRandomActions(rng, g, blinds, 0, 0, 0);
+	AddChanceRoot(g);
+	AddRandomChance(rng, g, 0, 0, 0);
+	g.strategy.assign(playersCount, map<pair<int, int>, vector<double> >());
+	for(int p = 0; p < playersCount; ++p)
+	{
+		SetRandomStrategy(rng, g, p);
+	}
+	CreateStrategyTrees(g);
+}
+
+/** Kuhn poker: cards J, Q, K (0, 1, 2) dealt without replacement, ante 1, one bet of 1.
+The strategies are the equilibrium with alpha = 0, the game value for position 0 is -1/18.
+*/
+static void CreateKuhn(Game & g)
+{
+	g = Game();
+	g.playersCount = 2;
+	g.roundsCount = 1;
+	g.cardsCount.assign(2, vector<int>(1, 3));
+	int b = AddBlinds(g);
+	int check = g.at.Add(b, ActionNode(0, 0, 0, 3));
+	g.at.Add(check, ActionNode(1, 0, 0, 3));
+	int checkBet = g.at.Add(check, ActionNode(1, 0, 1, 3));
+	g.at.Add(checkBet, ActionNode(0, 0, 0, 2));
+	g.at.Add(checkBet, ActionNode(0, 0, 1, 3));
+	int bet = g.at.Add(b, ActionNode(0, 0, 1, 3));
+	g.at.Add(bet, ActionNode(1, 0, 0, 1));
+	g.at.Add(bet, ActionNode(1, 0, 1, 3));
+
+	AddChanceRoot(g);
+	for(int c0 = 0; c0 < 3; ++c0)
+	{
+		chance_tree_node n0 = {1.0 / 3, 0, (uint8_t)c0, 0};
+		int i0 = g.ct.Add(0, n0);
+		for(int c1 = 0; c1 < 3; ++c1)
+		{
+			if(c1 != c0)
+			{
+				chance_tree_node n1 = {1.0 / 6, c0 > c1 ? 1.0 : 0.0, (uint8_t)c1, 1};
+				g.ct.Add(i0, n1);
+			}
+		}
+	}
+
+	g.strategy.assign(2, map<pair<int, int>, vector<double> >());
+	// Position 0: bet never, call with Q 1/3, with K always.
+	double call0[3] = {0, 1.0 / 3, 1};
+	// Position 1: after a check bet with J 1/3, with K always; after a bet call with Q 1/3, with K always.
+	double bet1[3] = {1.0 / 3, 0, 1};
+	double call1[3] = {0, 1.0 / 3, 1};
+	for(int c = 0; c < 3; ++c)
+	{
+		g.strategy[0][make_pair(b, c)] = vector<double>({1, 0});
+		g.strategy[0][make_pair(checkBet, c)] = vector<double>({1 - call0[c], call0[c]});
+		g.strategy[1][make_pair(check, c)] = vector<double>({1 - bet1[c], bet1[c]});
+		g.strategy[1][make_pair(bet, c)] = vector<double>({1 - call1[c], call1[c]});
+	}
+	CreateStrategyTrees(g);
+}
+
+/** Reference: the expected value of the hero playing a pure strategy (choice per information set)
+against the conditional strategies of the opponents, by walking the game tree.
+*/
+class BrReference
+{
+public:
+	BrReference(const Game & g, int hero) : _g(g), _hero(hero)
+	{
+		for(size_t a = 0; a < g.at.nodes.size(); ++a)
+		{
+			const vector<int> & ch = g.at.children[a];
+			if(ch.empty() || g.at.nodes[ch[0]].position != hero || g.at.nodes[ch[0]].round < 0)
+			{
+				continue;
+			}
+			int size = g.IndexSize(hero, g.at.nodes[ch[0]].round);
+			for(int idx = 0; idx < size; ++idx)
+			{
+				_infoSets[make_pair((int)a, idx)] = (int)_radix.size();
+				_radix.push_back((int)ch.size());
+			}
+		}
+	}
+
+	/// Number of pure strategies of the hero.
+	double StrategiesCount() const
+	{
+		double count = 1;
+		for(size_t i = 0; i < _radix.size(); ++i)
+		{
+			count *= _radix[i];
+		}
+		return count;
+	}
+
+	/// Value of the best pure strategy.
+	double Calculate()
+	{
+		_choice.assign(_radix.size(), 0);
+		double best = -1e100;
+		for(;;)
+		{
+			vector<double> inPot(_g.playersCount, 0);
+			vector<int> idx(_g.playersCount, 0);
+			best = max(best, Walk(0, 0, idx, inPot, 1));
+			size_t i = 0;
+			for(; i < _choice.size(); ++i)
+			{
+				if(++_choice[i] < _radix[i])
+				{
+					break;
+				}
+				_choice[i] = 0;
+			}
+			if(i == _choice.size())
+			{
+				break;
+			}
+		}
+		return best;
+	}
+
+private:
+	double Walk(int a, int c, vector<int> & idx, vector<double> & inPot, double probab)
+	{
+		const vector<int> & ch = _g.at.children[a];
+		if(ch.empty())
+		{
+			return Payoff(a, c, inPot) * probab * _g.ct.nodes[c].probab;
+		}
+		int round = _g.at.nodes[ch[0]].round;
+		if(round != _g.at.nodes[a].round)
+		{
+			return Deal(a, c, 0, round, idx, inPot, probab);
+		}
+		double value = 0;
+		for(size_t i = 0; i < ch.size(); ++i)
+		{
+			const action_tree_node & n = _g.at.nodes[ch[i]];
+			double p = 1;
+			if(n.round >= 0)
+			{
+				if(n.position == _hero)
+				{
+					p = _choice[_infoSets.find(make_pair(a, idx[_hero]))->second] == (int)i ? 1 : 0;
+				}
+				else
+				{
+					p = _g.strategy[n.position].find(make_pair(a, idx[n.position]))->second[i];
+				}
+			}
+			if(p == 0)
+			{
+				continue;
+			}
+			inPot[n.position] += n.amount;
+			value += Walk(ch[i], c, idx, inPot, probab * p);
+			inPot[n.position] -= n.amount;
+		}
+		return value;
+	}
+
+	/// Deals the cards of the round to the positions pos..n-1, then continues with the actions.
+	double Deal(int a, int c, int pos, int round, vector<int> & idx, vector<double> & inPot, double probab)
+	{
+		if(pos == _g.playersCount)
+		{
+			double value = 0;
+			const vector<int> & ch = _g.at.children[a];
+			// Walk the children as if the round did not change.
+			for(size_t i = 0; i < ch.size(); ++i)
+			{
+				const action_tree_node & n = _g.at.nodes[ch[i]];
+				double p;
+				if(n.position == _hero)
+				{
+					p = _choice[_infoSets.find(make_pair(a, idx[_hero]))->second] == (int)i ? 1 : 0;
+				}
+				else
+				{
+					p = _g.strategy[n.position].find(make_pair(a, idx[n.position]))->second[i];
+				}
+				if(p == 0)
+				{
+					continue;
+				}
+				inPot[n.position] += n.amount;
+				value += Walk(ch[i], c, idx, inPot, probab * p);
+				inPot[n.position] -= n.amount;
+			}
+			return value;
+		}
+		double value = 0;
+		const vector<int> & cch = _g.ct.children[c];
+		int offset = _g.IndexSize(pos, round - 1);
+		for(size_t i = 0; i < cch.size(); ++i)
+		{
+			int card = _g.ct.nodes[cch[i]].card;
+			idx[pos] += offset * card;
+			value += Deal(a, cch[i], pos + 1, round, idx, inPot, probab);
+			idx[pos] -= offset * card;
+		}
+		return value;
+	}
+
+	double Payoff(int a, int c, const vector<double> & inPot) const
+	{
+		const action_tree_node & n = _g.at.nodes[a];
+		double pot = 0;
+		int activeCount = 0;
+		for(int p = 0; p < _g.playersCount; ++p)
+		{
+			pot += inPot[p];
+			activeCount += (n.active_players >> p) & 1;
+		}
+		double share;
+		if(activeCount == 1)
+		{
+			share = (n.active_players >> _hero) & 1;
+		}
+		else
+		{
+			double ps0 = _g.ct.nodes[c].pot_share0;
+			share = _hero == 0 ? ps0 : (_hero == 1 ? 1 - ps0 : 0);
+		}
+		return pot * share - inPot[_hero];
+	}
+
+	const Game & _g;
+	int _hero;
+	map<pair<int, int>, int> _infoSets;
+	vector<int> _radix;
+	vector<int> _choice;
+};
+
+template<class NodeT> static void SetTree(br_engine & engine, br_engine::tree_kind kind, int position,
+	const Tree<NodeT> & tree)
+{
+	VERIFY(engine.set_tree(kind, position, (int64_t)tree.nodes.size(), &tree.depths[0], &tree.nodes[0],
+		sizeof(NodeT)));
+}
+
+static void SetGame(br_engine & engine, const Game & g)
+{
+	SetTree(engine, br_engine::ACTION_TREE, 0, g.at);
+	SetTree(engine, br_engine::CHANCE_TREE, 0, g.ct);
+	for(int p = 0; p < g.playersCount; ++p)
+	{
+		SetTree(engine, br_engine::STRATEGY_TREE, p, g.st[p]);
+	}
+}
+
+static void WriteInt32(string & s, uint32_t v)
+{
+	s.append((const char*)&v, 4);
+}
+
+static void WriteString(string & s, const string & v)
+{
+	// Strings are short here, 1-byte length prefix.
+	s.push_back((char)v.size());
+	s += v;
+}
+
+/// Writes a tree in the format of UFTree.Write().
+template<class NodeT> static string WriteTree(const char * name, const Tree<NodeT> & tree)
+{
+	string fields;
+	WriteInt32(fields, 1);
+	WriteInt32(fields, 2);
+	WriteInt32(fields, 3);
+	WriteInt32(fields, 4);
+	WriteString(fields, "scm");
+	WriteString(fields, "build");
+	WriteString(fields, "BrEngine test data");
+	WriteString(fields, "");
+
+	string file;
+	WriteInt32(file, 5);
+	WriteInt32(file, (uint32_t)fields.size());
+	file += fields;
+	WriteInt32(file, ai::lib::utils::bds_version::crc32(fields.data(), fields.size()));
+	WriteInt32(file, 1);
+	int64_t nodesCount = (int64_t)tree.nodes.size();
+	int64_t nodesByteSize = nodesCount * (int64_t)sizeof(NodeT);
+	file.append((const char*)&nodesByteSize, 8);
+	file.append((const char*)&nodesCount, 8);
+	file.append((const char*)&tree.depths[0], tree.depths.size());
+	file.append((const char*)&tree.nodes[0], (size_t)nodesByteSize);
+
+	string path = _tempDir + "/" + name;
+	FILE * f = fopen(path.c_str(), "wb");
+	VERIFY(f != 0);
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+	return path;
+}
+
+static void Test_Kuhn()
+{
+	Game g;
+	CreateKuhn(g);
+	for(int threads = 1; threads <= 2; ++threads)
+	{
+		br_engine engine;
+		VERIFY(engine.set_thread_count(threads));
+		SetGame(engine, g);
+		VERIFY(engine.players_count() == 0);
+		double value;
+		VERIFY(engine.solve(0, value));
+		VERIFY(engine.players_count() == 2);
+		VERIFY(fabs(value - (-1.0 / 18)) < 1e-12);
+		VERIFY(engine.solve(1, value));
+		VERIFY(fabs(value - 1.0 / 18) < 1e-12);
+	}
+	BrReference ref0(g, 0), ref1(g, 1);
+	VERIFY(fabs(ref0.Calculate() - (-1.0 / 18)) < 1e-12);
+	VERIFY(fabs(ref1.Calculate() - 1.0 / 18) < 1e-12);
+}
+
+static void Test_Reference(int playersCount, int roundsCount, int maxCards, int repetitions, uint64_t seed)
+{
+	Rng rng(seed);
+	for(int rep = 0; rep < repetitions; ++rep)
+	{
+		Game g;
+		BrReference * refs[br_engine::MAX_PLAYERS];
+		double strategiesCount;
+		// The reference enumerates the pure strategies of the hero, the game must be small.
+		for(;;)
+		{
+			CreateRandomGame(rng, playersCount, roundsCount, maxCards, g);
+			strategiesCount = 0;
+			for(int p = 0; p < playersCount; ++p)
+			{
+				refs[p] = new BrReference(g, p);
+				strategiesCount = max(strategiesCount, refs[p]->StrategiesCount());
+			}
+			if(strategiesCount <= 20000)
+			{
+				break;
+			}
+			for(int p = 0; p < playersCount; ++p)
+			{
+				delete refs[p];
+			}
+		}
+		br_engine engine1, engine3;
+		VERIFY(engine3.set_thread_count(3));
+		SetGame(engine1, g);
+		SetGame(engine3, g);
+		for(int p = 0; p < playersCount; ++p)
+		{
+			double expected = refs[p]->Calculate();
+			double value1, value3;
+			VERIFY(engine1.solve(p, value1));
+			VERIFY(engine3.solve(p, value3));
+			VERIFY(fabs(value1 - expected) < 1e-10);
+			// Each leaf is calculated by one thread, the result does not depend on the number of threads.
+			VERIFY(value3 == value1);
+			delete refs[p];
+		}
+		// A new strategy of one player.
+		SetRandomStrategy(rng, g, 1);
+		CreateStrategyTrees(g);
+		SetTree(engine1, br_engine::STRATEGY_TREE, 1, g.st[1]);
+		BrReference ref(g, 0);
+		double value;
+		VERIFY(engine1.solve(0, value));
+		VERIFY(fabs(value - ref.Calculate()) < 1e-10);
+	}
+}
+
+static void Test_Files()
+{
+	Rng rng(5);
+	Game g;
+	CreateRandomGame(rng, 2, 2, 3, g);
+	vector<string> paths;
+	paths.push_back(WriteTree("br-test-at.dat", g.at));
+	paths.push_back(WriteTree("br-test-ct.dat", g.ct));
+	paths.push_back(WriteTree("br-test-st-0.dat", g.st[0]));
+	paths.push_back(WriteTree("br-test-st-1.dat", g.st[1]));
+
+	br_engine fromMemory, fromFiles;
+	SetGame(fromMemory, g);
+	VERIFY(fromFiles.load_tree(br_engine::ACTION_TREE, 0, paths[0].c_str()));
+	VERIFY(fromFiles.load_tree(br_engine::CHANCE_TREE, 0, paths[1].c_str()));
+	VERIFY(fromFiles.load_tree(br_engine::STRATEGY_TREE, 0, paths[2].c_str()));
+	VERIFY(fromFiles.load_tree(br_engine::STRATEGY_TREE, 1, paths[3].c_str()));
+	for(int p = 0; p < 2; ++p)
+	{
+		double v1, v2;
+		VERIFY(fromMemory.solve(p, v1));
+		VERIFY(fromFiles.solve(p, v2));
+		VERIFY(v1 == v2);
+	}
+
+	// Wrong node size: a chance tree is not an action tree.
+	VERIFY(!fromFiles.load_tree(br_engine::ACTION_TREE, 0, paths[1].c_str()));
+	VERIFY(fromFiles.error().find("wrong node size") != string::npos);
+	double value;
+	VERIFY(!fromFiles.solve(0, value));
+	VERIFY(!fromFiles.load_tree(br_engine::ACTION_TREE, 0, (_tempDir + "/no-such-file.dat").c_str()));
+	VERIFY(fromFiles.error().find("no-such-file.dat") != string::npos);
+
+	// The C interface.
+	BrEngine * e = BrEngine_Open(2);
+	VERIFY(e != 0);
+	VERIFY(BrEngine_LoadTree(e, BR_ENGINE_ACTION_TREE, 0, paths[0].c_str()));
+	VERIFY(BrEngine_LoadTree(e, BR_ENGINE_CHANCE_TREE, 0, paths[1].c_str()));
+	VERIFY(BrEngine_SetTree(e, BR_ENGINE_STRATEGY_TREE, 0, (int64_t)g.st[0].nodes.size(), &g.st[0].depths[0],
+		&g.st[0].nodes[0], sizeof(strategy_tree_node)));
+	VERIFY(BrEngine_LoadTree(e, BR_ENGINE_STRATEGY_TREE, 1, paths[3].c_str()));
+	for(int p = 0; p < 2; ++p)
+	{
+		double v1, v2;
+		VERIFY(fromMemory.solve(p, v1));
+		VERIFY(BrEngine_Solve(e, p, &v2));
+		VERIFY(v1 == v2);
+	}
+	VERIFY(!BrEngine_SetTree(e, BR_ENGINE_STRATEGY_TREE, 0, (int64_t)g.st[0].nodes.size(), &g.st[0].depths[0],
+		&g.st[0].nodes[0], 10));
+	VERIFY(strstr(BrEngine_GetLastError(), "wrong node size") != 0);
+	// The hero does not need his own strategy.
+	VERIFY(BrEngine_Solve(e, 0, &value));
+	VERIFY(!BrEngine_Solve(e, 1, &value));
+	VERIFY(strstr(BrEngine_GetLastError(), "strategy trees of the opponents") != 0);
+	VERIFY(!BrEngine_LoadTree(e, 7, 0, paths[0].c_str()));
+	VERIFY(strstr(BrEngine_GetLastError(), "unknown tree kind") != 0);
+	VERIFY(!BrEngine_Solve(e, 2, &value));
+	VERIFY(strstr(BrEngine_GetLastError(), "hero position") != 0);
+	BrEngine_Close(e);
+	VERIFY(BrEngine_Open(0) == 0);
+	VERIFY(strstr(BrEngine_GetLastError(), "number of threads") != 0);
+
+	for(size_t i = 0; i < paths.size(); ++i)
+	{
+		remove(paths[i].c_str());
+	}
+}
+
+static void Test_Errors()
+{
+	Rng rng(7);
+	Game g;
+	CreateRandomGame(rng, 2, 2, 2, g);
+	br_engine engine;
+	double value;
+	VERIFY(!engine.solve(0, value));
+	VERIFY(engine.error().find("action and chance trees") != string::npos);
+	SetGame(engine, g);
+	VERIFY(!engine.set_tree(br_engine::STRATEGY_TREE, br_engine::MAX_PLAYERS, 1, &g.st[0].depths[0],
+		&g.st[0].nodes[0], sizeof(strategy_tree_node)));
+	VERIFY(engine.error().find("position is out of range") != string::npos);
+
+	// A strategy tree with an amount that is not in the action tree.
+	Tree<strategy_tree_node> st = g.st[1];
+	st.nodes[1].id += 16;
+	SetTree(engine, br_engine::STRATEGY_TREE, 1, st);
+	VERIFY(!engine.solve(0, value));
+	VERIFY(engine.error().find("cannot find action tree node") != string::npos);
+	SetTree(engine, br_engine::STRATEGY_TREE, 1, g.st[1]);
+	VERIFY(engine.solve(0, value));
+
+	// A chance tree of another number of players.
+	Tree<chance_tree_node> ct = g.ct;
+	ct.nodes[0].position = 3;
+	SetTree(engine, br_engine::CHANCE_TREE, 0, ct);
+	VERIFY(!engine.solve(0, value));
+	VERIFY(engine.error().find("inconsistent number of players") != string::npos);
+}
+
+template<class NodeT> static void SetTree(cfr_engine & engine, cfr_engine::tree_kind kind, const Tree<NodeT> & tree)
+{
+	VERIFY(engine.set_tree(kind, (int64_t)tree.nodes.size(), &tree.depths[0], &tree.nodes[0], sizeof(NodeT)));
+}
+
+static void SetGame(cfr_engine & engine, const Game & g)
+{
+	SetTree(engine, cfr_engine::ACTION_TREE, g.at);
+	SetTree(engine, cfr_engine::CHANCE_TREE, g.ct);
+}
+
+/** Checks the solution of the cfr engine: the average strategies are written into the strategy trees
+of the game, the best responses calculated by br_engine must match the values of the cfr engine.
+Returns the exploitability.
+*/
+static double VerifyCfrSolution(cfr_engine & engine, Game & g)
+{
+	double cfrValues[2];
+	VERIFY(engine.best_response_values(cfrValues));
+	for(int p = 0; p < 2; ++p)
+	{
+		Tree<strategy_tree_node> & st = g.st[p];
+		VERIFY(engine.get_strategy(p, (int64_t)st.nodes.size(), &st.depths[0], &st.nodes[0]));
+	}
+	br_engine br;
+	SetGame(br, g);
+	double sum = 0;
+	for(int p = 0; p < 2; ++p)
+	{
+		double value;
+		VERIFY(br.solve(p, value));
+		VERIFY(fabs(value - cfrValues[p]) < 1e-10);
+		sum += value;
+	}
+	// Exploitability is not negative.
+	VERIFY(sum > -1e-10);
+	return sum;
+}
+
+static void Test_CfrKuhn()
+{
+	Game g;
+	CreateKuhn(g);
+	cfr_engine engine;
+	SetGame(engine, g);
+	VERIFY(engine.iterate(1000));
+	VERIFY(engine.iteration_count() == 1000);
+	double epsilon = VerifyCfrSolution(engine, g);
+	VERIFY(epsilon < 1e-3);
+	// The game value is -1/18 for each equilibrium.
+	br_engine br;
+	SetGame(br, g);
+	double value;
+	VERIFY(br.solve(0, value));
+	VERIFY(fabs(value - (-1.0 / 18)) < 1e-3);
+}
+
+static void Test_CfrRandom(int roundsCount, int maxCards, int repetitions, uint64_t seed)
+{
+	Rng rng(seed);
+	for(int rep = 0; rep < repetitions; ++rep)
+	{
+		Game g;
+		CreateRandomGame(rng, 2, roundsCount, maxCards, g);
+		cfr_engine engine1, engine3;
+		VERIFY(engine3.set_thread_count(3));
+		SetGame(engine1, g);
+		SetGame(engine3, g);
+		// Before the first iteration the average strategy is uniform.
+		VerifyCfrSolution(engine1, g);
+		VERIFY(engine1.iterate(20));
+		double epsilon20 = VerifyCfrSolution(engine1, g);
+		VERIFY(engine1.iterate(480));
+		double epsilon500 = VerifyCfrSolution(engine1, g);
+		VERIFY(epsilon500 <= epsilon20 + 1e-12);
+		VERIFY(epsilon500 < 0.05);
+
+		// Each value is calculated by one thread, the result does not depend on the number of threads.
+		VERIFY(engine3.iterate(500));
+		double values1[2], values3[2];
+		VERIFY(engine1.best_response_values(values1));
+		VERIFY(engine3.best_response_values(values3));
+		VERIFY(values1[0] == values3[0] && values1[1] == values3[1]);
+
+		// Setting a tree resets the solution.
+		SetTree(engine1, cfr_engine::CHANCE_TREE, g.ct);
+		VERIFY(engine1.iterate(20));
+		VERIFY(engine1.iteration_count() == 20);
+		VERIFY(VerifyCfrSolution(engine1, g) == epsilon20);
+	}
+}
+
+static void Test_CfrFiles()
+{
+	Rng rng(9);
+	Game g;
+	CreateRandomGame(rng, 2, 2, 3, g);
+	string at = WriteTree("cfr-test-at.dat", g.at);
+	string ct = WriteTree("cfr-test-ct.dat", g.ct);
+
+	cfr_engine fromMemory;
+	SetGame(fromMemory, g);
+	VERIFY(fromMemory.iterate(50));
+	double expected[2];
+	VERIFY(fromMemory.best_response_values(expected));
+
+	cfr_engine fromFiles;
+	VERIFY(fromFiles.load_tree(cfr_engine::ACTION_TREE, at.c_str()));
+	VERIFY(fromFiles.load_tree(cfr_engine::CHANCE_TREE, ct.c_str()));
+	VERIFY(fromFiles.iterate(50));
+	double values[2];
+	VERIFY(fromFiles.best_response_values(values));
+	VERIFY(values[0] == expected[0] && values[1] == expected[1]);
+
+	// The C interface.
+	CfrEngine * e = CfrEngine_Open(2);
+	VERIFY(e != 0);
+	VERIFY(CfrEngine_LoadTree(e, CFR_ENGINE_ACTION_TREE, at.c_str()));
+	VERIFY(CfrEngine_SetTree(e, CFR_ENGINE_CHANCE_TREE, (int64_t)g.ct.nodes.size(), &g.ct.depths[0],
+		&g.ct.nodes[0], sizeof(chance_tree_node)));
+	VERIFY(CfrEngine_Iterate(e, 30));
+	VERIFY(CfrEngine_Iterate(e, 20));
+	VERIFY(CfrEngine_GetIterationCount(e) == 50);
+	VERIFY(CfrEngine_GetBestResponseValues(e, values));
+	VERIFY(values[0] == expected[0] && values[1] == expected[1]);
+	Tree<strategy_tree_node> st = g.st[1];
+	VERIFY(CfrEngine_GetStrategy(e, 1, (int64_t)st.nodes.size(), &st.depths[0], &st.nodes[0],
+		sizeof(strategy_tree_node)));
+	VERIFY(!CfrEngine_GetStrategy(e, 1, (int64_t)st.nodes.size(), &st.depths[0], &st.nodes[0], 10));
+	VERIFY(strstr(CfrEngine_GetLastError(), "wrong node size") != 0);
+	VERIFY(!CfrEngine_GetStrategy(e, 2, (int64_t)st.nodes.size(), &st.depths[0], &st.nodes[0],
+		sizeof(strategy_tree_node)));
+	VERIFY(strstr(CfrEngine_GetLastError(), "position is out of range") != 0);
+	VERIFY(!CfrEngine_LoadTree(e, 2, at.c_str()));
+	VERIFY(strstr(CfrEngine_GetLastError(), "unknown tree kind") != 0);
+	VERIFY(!CfrEngine_LoadTree(e, CFR_ENGINE_ACTION_TREE, ct.c_str()));
+	VERIFY(strstr(CfrEngine_GetLastError(), "wrong node size") != 0);
+	VERIFY(!CfrEngine_Iterate(e, 1));
+	CfrEngine_Close(e);
+	VERIFY(CfrEngine_Open(0) == 0);
+	VERIFY(strstr(CfrEngine_GetLastError(), "number of threads") != 0);
+
+	remove(at.c_str());
+	remove(ct.c_str());
+}
+
+static void Test_CfrErrors()
+{
+	Rng rng(11);
+	cfr_engine engine;
+	VERIFY(!engine.iterate(1));
+	VERIFY(engine.error().find("action and chance trees") != string::npos);
+
+	Game g;
+	CreateRandomGame(rng, 3, 1, 2, g);
+	SetGame(engine, g);
+	VERIFY(!engine.iterate(1));
+	VERIFY(engine.error().find("only heads-up") != string::npos);
+
+	CreateRandomGame(rng, 2, 2, 2, g);
+	SetGame(engine, g);
+	VERIFY(engine.iterate(1));
+	// A strategy tree with an amount that is not in the action tree.
+	Tree<strategy_tree_node> st = g.st[1];
+	st.nodes[1].id += 16;
+	VERIFY(!engine.get_strategy(1, (int64_t)st.nodes.size(), &st.depths[0], &st.nodes[0]));
+	VERIFY(engine.error().find("cannot find action tree node") != string::npos);
+}
+
+template<class NodeT> static void SetTree(mccfr_engine & engine, mccfr_engine::tree_kind kind, const Tree<NodeT> & tree)
+{
+	VERIFY(engine.set_tree(kind, (int64_t)tree.nodes.size(), &tree.depths[0], &tree.nodes[0], sizeof(NodeT)));
+}
+
+static void SetGame(mccfr_engine & engine, const Game & g)
+{
+	SetTree(engine, mccfr_engine::ACTION_TREE, g.at);
+	SetTree(engine, mccfr_engine::CHANCE_TREE, g.ct);
+}
+
+/// Writes the average strategies of the mccfr engine into the strategy trees of the game, returns the exploitability.
+static double McCfrExploitability(mccfr_engine & engine, Game & g)
+{
+	for(int p = 0; p < 2; ++p)
+	{
+		Tree<strategy_tree_node> & st = g.st[p];
+		VERIFY(engine.get_strategy(p, (int64_t)st.nodes.size(), &st.depths[0], &st.nodes[0]));
+	}
+	br_engine br;
+	SetGame(br, g);
+	double sum = 0;
+	for(int p = 0; p < 2; ++p)
+	{
+		double value;
+		VERIFY(br.solve(p, value));
+		sum += value;
+	}
+	VERIFY(sum > -1e-10);
+	return sum;
+}
+
+static void Test_McCfrKuhn()
+{
+	Game g;
+	CreateKuhn(g);
+	mccfr_engine engine;
+	engine.set_seed(1);
+	SetGame(engine, g);
+	VERIFY(engine.iterate(100000));
+	VERIFY(engine.iteration_count() == 100000);
+	// 4 nodes with 2 actions and 3 cards.
+	VERIFY(engine.table_size() == 24);
+	VERIFY(McCfrExploitability(engine, g) < 0.01);
+	br_engine br;
+	SetGame(br, g);
+	double value;
+	VERIFY(br.solve(0, value));
+	VERIFY(fabs(value - (-1.0 / 18)) < 0.01);
+
+	// The samples depend only on the seed, with 1 thread the result is reproducible.
+	Game g2 = g;
+	mccfr_engine engine2;
+	engine2.set_seed(1);
+	SetGame(engine2, g2);
+	VERIFY(engine2.iterate(60000));
+	VERIFY(engine2.iterate(40000));
+	McCfrExploitability(engine2, g2);
+	for(int p = 0; p < 2; ++p)
+	{
+		for(size_t i = 0; i < g.st[p].nodes.size(); ++i)
+		{
+			VERIFY(g.st[p].nodes[i].probab == g2.st[p].nodes[i].probab);
+		}
+	}
+}
+
+static void Test_McCfrRandom(int roundsCount, int maxCards, int repetitions, uint64_t seed)
+{
+	Rng rng(seed);
+	for(int rep = 0; rep < repetitions; ++rep)
+	{
+		Game g;
+		CreateRandomGame(rng, 2, roundsCount, maxCards, g);
+		// Compare with the exploitability of the uniform strategy, before the first iteration.
+		mccfr_engine engine1, engine3;
+		VERIFY(engine3.set_thread_count(3));
+		engine1.set_seed(rep);
+		engine3.set_seed(rep);
+		SetGame(engine1, g);
+		SetGame(engine3, g);
+		double epsilon0 = McCfrExploitability(engine1, g);
+		VERIFY(engine1.iterate(100000));
+		double epsilon1 = McCfrExploitability(engine1, g);
+		VERIFY(engine3.iterate(100000));
+		double epsilon3 = McCfrExploitability(engine3, g);
+		// Not exact: the solution is sampled, the threads update the tables in another order.
+		VERIFY(epsilon1 < 0.01 + 0.01 * epsilon0);
+		VERIFY(epsilon3 < 0.01 + 0.01 * epsilon0);
+	}
+}
+
+static void Test_McCfrFiles()
+{
+	Rng rng(13);
+	Game g;
+	CreateRandomGame(rng, 2, 2, 3, g);
+	string at = WriteTree("mccfr-test-at.dat", g.at);
+	string ct = WriteTree("mccfr-test-ct.dat", g.ct);
+
+	mccfr_engine fromMemory;
+	fromMemory.set_seed(5);
+	SetGame(fromMemory, g);
+	VERIFY(fromMemory.iterate(1000));
+	Tree<strategy_tree_node> expected = g.st[0];
+	VERIFY(fromMemory.get_strategy(0, (int64_t)expected.nodes.size(), &expected.depths[0], &expected.nodes[0]));
+
+	// The C interface.
+	McCfrEngine * e = McCfrEngine_Open(1, 5);
+	VERIFY(e != 0);
+	VERIFY(McCfrEngine_LoadTree(e, MCCFR_ENGINE_ACTION_TREE, at.c_str()));
+	VERIFY(McCfrEngine_LoadTree(e, MCCFR_ENGINE_CHANCE_TREE, ct.c_str()));
+	VERIFY(McCfrEngine_Iterate(e, 1000));
+	VERIFY(McCfrEngine_GetIterationCount(e) == 1000);
+	VERIFY(McCfrEngine_GetTableSize(e) == fromMemory.table_size());
+	Tree<strategy_tree_node> st = g.st[0];
+	VERIFY(McCfrEngine_GetStrategy(e, 0, (int64_t)st.nodes.size(), &st.depths[0], &st.nodes[0],
+		sizeof(strategy_tree_node)));
+	for(size_t i = 0; i < st.nodes.size(); ++i)
+	{
+		VERIFY(st.nodes[i].probab == expected.nodes[i].probab);
+	}
+	VERIFY(!McCfrEngine_GetStrategy(e, 0, (int64_t)st.nodes.size(), &st.depths[0], &st.nodes[0], 10));
+	VERIFY(strstr(McCfrEngine_GetLastError(), "wrong node size") != 0);
+	VERIFY(!McCfrEngine_LoadTree(e, 2, at.c_str()));
+	VERIFY(strstr(McCfrEngine_GetLastError(), "unknown tree kind") != 0);
+	VERIFY(!McCfrEngine_SetTree(e, MCCFR_ENGINE_ACTION_TREE, (int64_t)g.ct.nodes.size(), &g.ct.depths[0],
+		&g.ct.nodes[0], sizeof(chance_tree_node)));
+	VERIFY(strstr(McCfrEngine_GetLastError(), "wrong node size") != 0);
+	VERIFY(!McCfrEngine_Iterate(e, 1));
+	VERIFY(strstr(McCfrEngine_GetLastError(), "action and chance trees") != 0);
+	McCfrEngine_Close(e);
+	VERIFY(McCfrEngine_Open(0, 0) == 0);
+	VERIFY(strstr(McCfrEngine_GetLastError(), "number of threads") != 0);
+
+	// Another number of players.
+	mccfr_engine engine;
+	CreateRandomGame(rng, 3, 1, 2, g);
+	SetGame(engine, g);
+	VERIFY(!engine.iterate(1));
+	VERIFY(engine.error().find("only heads-up") != string::npos);
+
+	remove(at.c_str());
+	remove(ct.c_str());
+}
+
+static int Test()
+{
+	try
+	{
+		Test_Kuhn();
+		Test_Reference(2, 1, 3, 20, 1);
+		Test_Reference(2, 2, 2, 20, 2);
+		Test_Reference(2, 3, 2, 10, 3);
+		Test_Reference(3, 1, 2, 10, 4);
+		Test_Reference(3, 2, 2, 5, 5);
+		Test_Files();
+		Test_Errors();
+		Test_CfrKuhn();
+		Test_CfrRandom(1, 3, 10, 1);
+		Test_CfrRandom(2, 2, 10, 2);
+		Test_CfrRandom(3, 2, 5, 3);
+		Test_CfrFiles();
+		Test_CfrErrors();
+		Test_McCfrKuhn();
+		Test_McCfrRandom(1, 3, 5, 1);
+		Test_McCfrRandom(2, 2, 5, 2);
+		Test_McCfrFiles();
+	}
+	catch(const char * e)
+	{
+		printf("%s\n", e);
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+
+static int Br(int threadsCount, int argc, char * argv[])
+{
+	br_engine engine;
+	if(!engine.set_thread_count(threadsCount) ||
+		!engine.load_tree(br_engine::ACTION_TREE, 0, argv[0]) ||
+		!engine.load_tree(br_engine::CHANCE_TREE, 0, argv[1]))
+	{
+		printf("%s\n", engine.error().c_str());
+		return 1;
+	}
+	for(int p = 0; p + 2 < argc; ++p)
+	{
+		if(!engine.load_tree(br_engine::STRATEGY_TREE, p, argv[p + 2]))
+		{
+			printf("%s\n", engine.error().c_str());
+			return 1;
+		}
+	}
+	double sum = 0;
+	for(int p = 0; p + 2 < argc; ++p)
+	{
+		double value;
+		double start = Now();
+		if(!engine.solve(p, value))
+		{
+			printf("%s\n", engine.error().c_str());
+			return 1;
+		}
+		printf("Br pos %d: %.10f, %.3f s\n", p, value, Now() - start);
+		sum += value;
+	}
+	printf("Sum of br values: %.10f\n", sum);
+	return 0;
+}
+
+static int Cfr(int threadsCount, int iterationsCount, const char * actionTree, const char * chanceTree)
+{
+	cfr_engine engine;
+	if(!engine.set_thread_count(threadsCount) ||
+		!engine.load_tree(cfr_engine::ACTION_TREE, actionTree) ||
+		!engine.load_tree(cfr_engine::CHANCE_TREE, chanceTree))
+	{
+		printf("%s\n", engine.error().c_str());
+		return 1;
+	}
+	double start = Now();
+	for(int done = 0; done < iterationsCount;)
+	{
+		// Report the exploitability at powers of 2.
+		int step = max(1, min(done, iterationsCount - done));
+		double values[2];
+		if(!engine.iterate(step) || !engine.best_response_values(values))
+		{
+			printf("%s\n", engine.error().c_str());
+			return 1;
+		}
+		done += step;
+		printf("Iteration %d: br values %.10f %.10f, epsilon %.10f, %.3f s\n", done, values[0], values[1],
+			values[0] + values[1], Now() - start);
+	}
+	return 0;
+}
+
+static int McCfr(int threadsCount, int64_t iterationsCount, const char * actionTree, const char * chanceTree)
+{
+	mccfr_engine engine;
+	if(!engine.set_thread_count(threadsCount) ||
+		!engine.load_tree(mccfr_engine::ACTION_TREE, actionTree) ||
+		!engine.load_tree(mccfr_engine::CHANCE_TREE, chanceTree))
+	{
+		printf("%s\n", engine.error().c_str());
+		return 1;
+	}
+	double start = Now();
+	for(int64_t done = 0; done < iterationsCount;)
+	{
+		// Report at powers of 2.
+		int64_t step = max((int64_t)1000, min(done, iterationsCount - done));
+		if(!engine.iterate(step))
+		{
+			printf("%s\n", engine.error().c_str());
+			return 1;
+		}
+		done += step;
+		printf("Iteration %lld: %.3f s, %lld table entries\n", (long long)done, Now() - start,
+			(long long)engine.table_size());
+	}
+	return 0;
+}
+
+static int Benchmark(int threadsCount, int cardsCount)
+{
+	Rng rng(1);
+	Game g;
+	// A game with many leaves and chance indexes.
+	do
+	{
+		CreateRandomGame(rng, 2, 2, 1, g);
+	} while(g.at.nodes.size() < 100);
+	for(int p = 0; p < 2; ++p)
+	{
+		g.cardsCount[p][0] = cardsCount;
+		g.cardsCount[p][1] = cardsCount / 4;
+	}
+	g.ct = Tree<chance_tree_node>();
+	AddChanceRoot(g);
+	AddRandomChance(rng, g, 0, 0, 0);
+	for(int p = 0; p < 2; ++p)
+	{
+		SetRandomStrategy(rng, g, p);
+	}
+	CreateStrategyTrees(g);
+	printf("Action tree: %d nodes, chance tree: %d nodes, strategy tree: %d nodes\n",
+		(int)g.at.nodes.size(), (int)g.ct.nodes.size(), (int)g.st[0].nodes.size());
+	double time1 = 0;
+	int counts[2] = {1, threadsCount};
+	for(int t = 0; t < 2; ++t)
+	{
+		br_engine engine;
+		VERIFY(engine.set_thread_count(counts[t]));
+		SetGame(engine, g);
+		double value;
+		// The first call prepares the game and the reaches.
+		double start = Now();
+		VERIFY(engine.solve(0, value));
+		double prepareTime = Now() - start;
+		start = Now();
+		VERIFY(engine.solve(0, value));
+		VERIFY(engine.solve(1, value));
+		double time = (Now() - start) / 2;
+		if(t == 0)
+		{
+			time1 = time;
+		}
+		printf("%d threads: first solve %.3f s, solve %.3f s, speedup %.1f\n", counts[t], prepareTime, time,
+			time1 / time);
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "test") == 0)
+	{
+		if(argc >= 3)
+		{
+			_tempDir = argv[2];
+		}
+		return Test();
+	}
+	if(argc >= 6 && strcmp(argv[1], "br") == 0)
+	{
+		return Br(atoi(argv[2]), argc - 3, argv + 3);
+	}
+	if(argc >= 6 && strcmp(argv[1], "cfr") == 0)
+	{
+		return Cfr(atoi(argv[2]), atoi(argv[3]), argv[4], argv[5]);
+	}
+	if(argc >= 6 && strcmp(argv[1], "mccfr") == 0)
+	{
+		return McCfr(atoi(argv[2]), atoll(argv[3]), argv[4], argv[5]);
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark") == 0)
+	{
+		try
+		{
+			return Benchmark(argc >= 3 ? atoi(argv[2]) : 4, argc >= 4 ? atoi(argv[3]) : 40);
+		}
+		catch(const char * e)
+		{
+			printf("%s\n", e);
+			return 1;
+		}
+	}
+	printf("Usage:\n"
+		"%s test [temp-dir]\n"
+		"%s br threads action-tree chance-tree strategy-tree-0 strategy-tree-1 ...\n"
+		"%s cfr threads iterations action-tree chance-tree\n"
+		"%s mccfr threads iterations action-tree chance-tree\n"
+		"%s benchmark [threads] [cards]\n", argv[0], argv[0], argv[0], argv[0], argv[0]);
+	return 1;
+}
@@ -0,0 +1,299 @@
+// ai.pkr.metastrategy.cpplib.cpp : Defines the exported functions of the library.
+//
+
+#include <string>
+#include "ai.pkr.metastrategy.cpplib.h"
+#include "br_engine.h"
+#include "cfr_engine.h"
+#include "mccfr_engine.h"
+
+using namespace ai::pkr::metastrategy;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL char _lastError[256];
+
+static void SetError(const std::string & error)
+{
+	std::size_t length = error.copy(_lastError, sizeof(_lastError) - 1);
+	_lastError[length] = 0;
+}
+
+struct BrEngine
+{
+	br_engine engine;
+};
+
+struct CfrEngine
+{
+	cfr_engine engine;
+};
+
+struct McCfrEngine
+{
+	mccfr_engine engine;
+};
+
+static bool IsValidKind(int kind)
+{
+	if(kind < BR_ENGINE_ACTION_TREE || kind > BR_ENGINE_STRATEGY_TREE)
+	{
+		SetError("unknown tree kind");
+		return false;
+	}
+	return true;
+}
+
+extern "C"
+{
+
+AIPKRMETASTRATEGYCPPLIB_API BrEngine * BrEngine_Open(int threadsCount)
+{
+	BrEngine * e = new BrEngine;
+	if(!e->engine.set_thread_count(threadsCount))
+	{
+		SetError(e->engine.error());
+		delete e;
+		return 0;
+	}
+	return e;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API void BrEngine_Close(BrEngine * e)
+{
+	delete e;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API const char * BrEngine_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int BrEngine_LoadTree(BrEngine * e, int kind, int position, const char * fileName)
+{
+	if(!IsValidKind(kind))
+	{
+		return 0;
+	}
+	if(!e->engine.load_tree((br_engine::tree_kind)kind, position, fileName))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int BrEngine_SetTree(BrEngine * e, int kind, int position, int64_t nodesCount,
+	const uint8_t * depths, const void * nodes, int nodeByteSize)
+{
+	if(!IsValidKind(kind))
+	{
+		return 0;
+	}
+	if(!e->engine.set_tree((br_engine::tree_kind)kind, position, nodesCount, depths, nodes, nodeByteSize))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int BrEngine_Solve(BrEngine * e, int heroPosition, double * value)
+{
+	if(!e->engine.solve(heroPosition, *value))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API CfrEngine * CfrEngine_Open(int threadsCount)
+{
+	CfrEngine * e = new CfrEngine;
+	if(!e->engine.set_thread_count(threadsCount))
+	{
+		SetError(e->engine.error());
+		delete e;
+		return 0;
+	}
+	return e;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API void CfrEngine_Close(CfrEngine * e)
+{
+	delete e;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API const char * CfrEngine_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_LoadTree(CfrEngine * e, int kind, const char * fileName)
+{
+	if(kind != CFR_ENGINE_ACTION_TREE && kind != CFR_ENGINE_CHANCE_TREE)
+	{
+		SetError("unknown tree kind");
+		return 0;
+	}
+	if(!e->engine.load_tree((cfr_engine::tree_kind)kind, fileName))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_SetTree(CfrEngine * e, int kind, int64_t nodesCount,
+	const uint8_t * depths, const void * nodes, int nodeByteSize)
+{
+	if(kind != CFR_ENGINE_ACTION_TREE && kind != CFR_ENGINE_CHANCE_TREE)
+	{
+		SetError("unknown tree kind");
+		return 0;
+	}
+	if(!e->engine.set_tree((cfr_engine::tree_kind)kind, nodesCount, depths, nodes, nodeByteSize))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_Iterate(CfrEngine * e, int iterationsCount)
+{
+	if(!e->engine.iterate(iterationsCount))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_GetIterationCount(CfrEngine * e)
+{
+	return e->engine.iteration_count();
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_GetBestResponseValues(CfrEngine * e, double * values)
+{
+	if(!e->engine.best_response_values(values))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_GetStrategy(CfrEngine * e, int position, int64_t nodesCount,
+	const uint8_t * depths, void * nodes, int nodeByteSize)
+{
+	if(nodeByteSize != (int)sizeof(strategy_tree_node))
+	{
+		SetError("wrong node size of the strategy tree");
+		return 0;
+	}
+	if(!e->engine.get_strategy(position, nodesCount, depths, (strategy_tree_node *)nodes))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API McCfrEngine * McCfrEngine_Open(int threadsCount, uint64_t seed)
+{
+	McCfrEngine * e = new McCfrEngine;
+	if(!e->engine.set_thread_count(threadsCount))
+	{
+		SetError(e->engine.error());
+		delete e;
+		return 0;
+	}
+	e->engine.set_seed(seed);
+	return e;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API void McCfrEngine_Close(McCfrEngine * e)
+{
+	delete e;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API const char * McCfrEngine_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int McCfrEngine_LoadTree(McCfrEngine * e, int kind, const char * fileName)
+{
+	if(kind != MCCFR_ENGINE_ACTION_TREE && kind != MCCFR_ENGINE_CHANCE_TREE)
+	{
+		SetError("unknown tree kind");
+		return 0;
+	}
+	if(!e->engine.load_tree((mccfr_engine::tree_kind)kind, fileName))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int McCfrEngine_SetTree(McCfrEngine * e, int kind, int64_t nodesCount,
+	const uint8_t * depths, const void * nodes, int nodeByteSize)
+{
+	if(kind != MCCFR_ENGINE_ACTION_TREE && kind != MCCFR_ENGINE_CHANCE_TREE)
+	{
+		SetError("unknown tree kind");
+		return 0;
+	}
+	if(!e->engine.set_tree((mccfr_engine::tree_kind)kind, nodesCount, depths, nodes, nodeByteSize))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int McCfrEngine_Iterate(McCfrEngine * e, int64_t iterationsCount)
+{
+	if(!e->engine.iterate(iterationsCount))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int64_t McCfrEngine_GetIterationCount(McCfrEngine * e)
+{
+	return e->engine.iteration_count();
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int64_t McCfrEngine_GetTableSize(McCfrEngine * e)
+{
+	return e->engine.table_size();
+}
+
+AIPKRMETASTRATEGYCPPLIB_API int McCfrEngine_GetStrategy(McCfrEngine * e, int position, int64_t nodesCount,
+	const uint8_t * depths, void * nodes, int nodeByteSize)
+{
+	if(nodeByteSize != (int)sizeof(strategy_tree_node))
+	{
+		SetError("wrong node size of the strategy tree");
+		return 0;
+	}
+	if(!e->engine.get_strategy(position, nodesCount, depths, (strategy_tree_node *)nodes))
+	{
+		SetError(e->engine.error());
+		return 0;
+	}
+	return 1;
+}
+
+}
@@ -0,0 +1,141 @@
+// C interface of ai.pkr.metastrategy.cpplib (ai.pkr.metastrategy.cpplib.dll on Windows,
+// libai.pkr.metastrategy.cpplib.so on Linux). Used by ai.pkr.metastrategy.CppLib (C#).
+//
+// All files within this library are compiled with the AIPKRMETASTRATEGYCPPLIB_EXPORTS
+// symbol defined. This symbol should not be defined on any project
+// that uses this library. This way any other project whose source files include
+// this file see AIPKRMETASTRATEGYCPPLIB_API functions as being imported, whereas the library
+// sees symbols defined with this macro as being exported.
+
+#ifndef AI_PKR_METASTRATEGY_CPPLIB_H
+#define AI_PKR_METASTRATEGY_CPPLIB_H
+
+#if defined(_WIN32)
+	#ifdef AIPKRMETASTRATEGYCPPLIB_EXPORTS
+		#define AIPKRMETASTRATEGYCPPLIB_API __declspec(dllexport)
+	#else
+		#define AIPKRMETASTRATEGYCPPLIB_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AIPKRMETASTRATEGYCPPLIB_API __attribute__((visibility("default")))
+#else
+	#define AIPKRMETASTRATEGYCPPLIB_API
+#endif
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Opaque handle of a best response engine.
+typedef struct BrEngine BrEngine;
+
+/// Tree kinds for BrEngine_LoadTree() and BrEngine_SetTree().
+#define BR_ENGINE_ACTION_TREE 0
+#define BR_ENGINE_CHANCE_TREE 1
+#define BR_ENGINE_STRATEGY_TREE 2
+
+/// Creates an engine calculating with threadsCount threads.
+/// Returns 0 on error, see BrEngine_GetLastError().
+AIPKRMETASTRATEGYCPPLIB_API BrEngine * BrEngine_Open(int threadsCount);
+
+AIPKRMETASTRATEGYCPPLIB_API void BrEngine_Close(BrEngine * e);
+
+/// Description of the last error in this thread.
+AIPKRMETASTRATEGYCPPLIB_API const char * BrEngine_GetLastError();
+
+/// Loads a tree written by UFTree.Write(). Position is the position of a strategy tree,
+/// it is ignored for other kinds. Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int BrEngine_LoadTree(BrEngine * e, int kind, int position, const char * fileName);
+
+/// Copies a tree from memory: depths[0..nodesCount-1] and the nodes (nodeByteSize bytes each,
+/// the layout of ActionTreeNode, ChanceTreeNode or StrategyTreeNode). Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int BrEngine_SetTree(BrEngine * e, int kind, int position, int64_t nodesCount,
+	const uint8_t * depths, const void * nodes, int nodeByteSize);
+
+/// Calculates the value of the best response of the hero against the strategies of the other positions
+/// (absolute strategy trees). Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int BrEngine_Solve(BrEngine * e, int heroPosition, double * value);
+
+/// Opaque handle of a CFR+ solver (heads-up games).
+typedef struct CfrEngine CfrEngine;
+
+/// Tree kinds for CfrEngine_LoadTree() and CfrEngine_SetTree().
+#define CFR_ENGINE_ACTION_TREE 0
+#define CFR_ENGINE_CHANCE_TREE 1
+
+/// Creates a solver calculating with threadsCount threads.
+/// Returns 0 on error, see CfrEngine_GetLastError().
+AIPKRMETASTRATEGYCPPLIB_API CfrEngine * CfrEngine_Open(int threadsCount);
+
+AIPKRMETASTRATEGYCPPLIB_API void CfrEngine_Close(CfrEngine * e);
+
+/// Description of the last error in this thread.
+AIPKRMETASTRATEGYCPPLIB_API const char * CfrEngine_GetLastError();
+
+/// Loads a tree written by UFTree.Write(). Resets the solution. Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_LoadTree(CfrEngine * e, int kind, const char * fileName);
+
+/// Copies a tree from memory, like BrEngine_SetTree(). Resets the solution. Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_SetTree(CfrEngine * e, int kind, int64_t nodesCount,
+	const uint8_t * depths, const void * nodes, int nodeByteSize);
+
+/// Does iterationsCount iterations. Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_Iterate(CfrEngine * e, int iterationsCount);
+
+/// Number of iterations done since the trees were set.
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_GetIterationCount(CfrEngine * e);
+
+/// Calculates the values of the best responses of both positions against the average strategy
+/// of the other (values[0], values[1]). Their sum is the exploitability. Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_GetBestResponseValues(CfrEngine * e, double * values);
+
+/// Writes the average strategy of the position into its strategy tree (depths[0..nodesCount-1], nodes
+/// with the layout of StrategyTreeNode), sets the absolute probabilities of the nodes of the position.
+/// Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int CfrEngine_GetStrategy(CfrEngine * e, int position, int64_t nodesCount,
+	const uint8_t * depths, void * nodes, int nodeByteSize);
+
+/// Opaque handle of a Monte-Carlo CFR solver with external sampling (heads-up games).
+typedef struct McCfrEngine McCfrEngine;
+
+/// Tree kinds for McCfrEngine_LoadTree() and McCfrEngine_SetTree().
+#define MCCFR_ENGINE_ACTION_TREE 0
+#define MCCFR_ENGINE_CHANCE_TREE 1
+
+/// Creates a solver calculating with threadsCount threads, the samples are determined by the seed.
+/// Returns 0 on error, see McCfrEngine_GetLastError().
+AIPKRMETASTRATEGYCPPLIB_API McCfrEngine * McCfrEngine_Open(int threadsCount, uint64_t seed);
+
+AIPKRMETASTRATEGYCPPLIB_API void McCfrEngine_Close(McCfrEngine * e);
+
+/// Description of the last error in this thread.
+AIPKRMETASTRATEGYCPPLIB_API const char * McCfrEngine_GetLastError();
+
+/// Loads a tree written by UFTree.Write(). Resets the solution. Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int McCfrEngine_LoadTree(McCfrEngine * e, int kind, const char * fileName);
+
+/// Copies a tree from memory, like BrEngine_SetTree(). Resets the solution. Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int McCfrEngine_SetTree(McCfrEngine * e, int kind, int64_t nodesCount,
+	const uint8_t * depths, const void * nodes, int nodeByteSize);
+
+/// Does iterationsCount iterations (a sampled deal for each position). Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int McCfrEngine_Iterate(McCfrEngine * e, int64_t iterationsCount);
+
+/// Number of iterations done since the trees were set.
+AIPKRMETASTRATEGYCPPLIB_API int64_t McCfrEngine_GetIterationCount(McCfrEngine * e);
+
+/// Number of entries in each of the tables of the regrets and of the average (floats).
+AIPKRMETASTRATEGYCPPLIB_API int64_t McCfrEngine_GetTableSize(McCfrEngine * e);
+
+/// Writes the average strategy of the position into its strategy tree, like CfrEngine_GetStrategy().
+/// Returns 0 on error.
+AIPKRMETASTRATEGYCPPLIB_API int McCfrEngine_GetStrategy(McCfrEngine * e, int position, int64_t nodesCount,
+	const uint8_t * depths, void * nodes, int nodeByteSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,631 @@
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "br_engine.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metastrategy
+		{
+
+			static int CountBits(uint16_t mask)
+			{
+				int count = 0;
+				for(; mask; mask &= mask - 1)
+				{
+					++count;
+				}
+				return count;
+			}
+
+			bool br_engine::set_thread_count(int thread_count)
+			{
+				if(thread_count < 1)
+				{
+					return fail("the number of threads must be positive");
+				}
+				_thread_count = thread_count;
+				return true;
+			}
+
+			int br_engine::node_byte_size(tree_kind kind)
+			{
+				switch(kind)
+				{
+				case ACTION_TREE:
+					return sizeof(action_tree_node);
+				case CHANCE_TREE:
+					return sizeof(chance_tree_node);
+				default:
+					return sizeof(strategy_tree_node);
+				}
+			}
+
+			uf_tree * br_engine::get_tree(tree_kind kind, int position)
+			{
+				switch(kind)
+				{
+				case ACTION_TREE:
+					return &_action_tree;
+				case CHANCE_TREE:
+					return &_chance_tree;
+				case STRATEGY_TREE:
+					if(position < 0 || position >= MAX_PLAYERS)
+					{
+						fail("position is out of range");
+						return 0;
+					}
+					return &_strategy_trees[position];
+				}
+				fail("unknown tree kind");
+				return 0;
+			}
+
+			void br_engine::tree_changed(tree_kind kind, int position)
+			{
+				if(kind == STRATEGY_TREE)
+				{
+					_is_reach_ready[position] = false;
+					_reach[position].clear();
+					return;
+				}
+				_is_game_ready = false;
+				for(int p = 0; p < MAX_PLAYERS; ++p)
+				{
+					_is_reach_ready[p] = false;
+					_reach[p].clear();
+				}
+			}
+
+			bool br_engine::load_tree(tree_kind kind, int position, const char * file_name)
+			{
+				uf_tree * tree = get_tree(kind, position);
+				if(!tree)
+				{
+					return false;
+				}
+				tree_changed(kind, position);
+				if(!tree->read(file_name, node_byte_size(kind)))
+				{
+					return fail(tree->error());
+				}
+				return true;
+			}
+
+			bool br_engine::set_tree(tree_kind kind, int position, int64_t nodes_count, const uint8_t * depths,
+				const void * nodes, int node_byte_size)
+			{
+				uf_tree * tree = get_tree(kind, position);
+				if(!tree)
+				{
+					return false;
+				}
+				tree_changed(kind, position);
+				if(node_byte_size != br_engine::node_byte_size(kind))
+				{
+					tree->clear();
+					std::ostringstream os;
+					os << "wrong node size " << node_byte_size << ", expected " << br_engine::node_byte_size(kind);
+					return fail(os.str());
+				}
+				if(!tree->set(nodes_count, depths, nodes, node_byte_size))
+				{
+					return fail(tree->error());
+				}
+				return true;
+			}
+
+			bool br_engine::prepare_game()
+			{
+				if(_action_tree.nodes_count() == 0 || _chance_tree.nodes_count() == 0)
+				{
+					return fail("action and chance trees must be set");
+				}
+				_players_count = _action_tree.node<action_tree_node>(0).position;
+				if(_players_count < 2 || _players_count > MAX_PLAYERS)
+				{
+					return fail("unsupported number of players");
+				}
+				if(_chance_tree.node<chance_tree_node>(0).position != _players_count)
+				{
+					return fail("inconsistent number of players in the input trees");
+				}
+				int n = _players_count;
+
+				// Chance tree: number of rounds and max. card of each player in each round.
+				int maxDepth = 0;
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					int d = _chance_tree.depth(i);
+					if(_chance_tree.node<chance_tree_node>(i).position != (d - 1) % n)
+					{
+						return fail("unexpected position in the chance tree");
+					}
+					maxDepth = std::max(maxDepth, d);
+				}
+				if(maxDepth == 0 || maxDepth % n != 0)
+				{
+					return fail("the chance tree must deal cards to all players in each round");
+				}
+				_rounds_count = maxDepth / n;
+				std::vector<std::vector<int> > maxCard(n, std::vector<int>(_rounds_count, 0));
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					const chance_tree_node & node = _chance_tree.node<chance_tree_node>(i);
+					int & mc = maxCard[node.position][(_chance_tree.depth(i) - 1) / n];
+					mc = std::max(mc, (int)node.card);
+				}
+				_index_sizes.assign(n, std::vector<int>(_rounds_count, 0));
+				for(int p = 0; p < n; ++p)
+				{
+					int64_t size = 1;
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						size *= maxCard[p][r] + 1;
+						if(size > (1 << 24))
+						{
+							return fail("too many chance indexes");
+						}
+						_index_sizes[p][r] = (int)size;
+					}
+				}
+
+				// Action tree: children index and leaves with pot and in-pot amounts.
+				int64_t count = _action_tree.nodes_count();
+				std::vector<int64_t> parents((std::size_t)count, -1);
+				std::vector<int64_t> stack(256, 0);
+				_children_begin.assign((std::size_t)count + 1, 0);
+				for(int64_t i = 1; i < count; ++i)
+				{
+					int d = _action_tree.depth(i);
+					if(d < 1 || d > _action_tree.depth(i - 1) + 1)
+					{
+						return fail("the action tree is not in preorder");
+					}
+					parents[(std::size_t)i] = stack[d - 1];
+					stack[d] = i;
+					_children_begin[(std::size_t)parents[(std::size_t)i] + 1]++;
+				}
+				for(int64_t i = 0; i < count; ++i)
+				{
+					_children_begin[(std::size_t)i + 1] += _children_begin[(std::size_t)i];
+				}
+				_children.assign((std::size_t)(count - 1), 0);
+				std::vector<int64_t> fill(_children_begin.begin(), _children_begin.end() - 1);
+				for(int64_t i = 1; i < count; ++i)
+				{
+					_children[(std::size_t)fill[(std::size_t)parents[(std::size_t)i]]++] = i;
+				}
+
+				_leaves.clear();
+				_leaf_idx.assign((std::size_t)count, -1);
+				std::vector<double> inPot((std::size_t)(256 * n), 0.0);
+				for(int64_t i = 1; i < count; ++i)
+				{
+					const action_tree_node & node = _action_tree.node<action_tree_node>(i);
+					const action_tree_node & parent = _action_tree.node<action_tree_node>(parents[(std::size_t)i]);
+					int d = _action_tree.depth(i);
+					if(node.position < 0 || node.position >= n)
+					{
+						return fail("unexpected position in the action tree");
+					}
+					if(node.round < parent.round || node.round >= _rounds_count)
+					{
+						return fail("unexpected round in the action tree");
+					}
+					double * ip = &inPot[d * n];
+					std::copy(&inPot[(d - 1) * n], &inPot[d * n], ip);
+					ip[node.position] += node.amount;
+					if(_children_begin[(std::size_t)i] != _children_begin[(std::size_t)i + 1])
+					{
+						continue;
+					}
+					leaf l;
+					l.node = i;
+					l.round = node.round;
+					l.active_players = node.active_players;
+					l.is_showdown = CountBits(node.active_players) > 1;
+					if(l.round < 0)
+					{
+						return fail("a leaf of the action tree before the first round");
+					}
+					if(l.is_showdown && l.round != _rounds_count - 1)
+					{
+						return fail("must be either chance leaf or single active player");
+					}
+					l.pot = 0;
+					for(int p = 0; p < n; ++p)
+					{
+						l.in_pot[p] = ip[p];
+						l.pot += ip[p];
+					}
+					_leaf_idx[(std::size_t)i] = (int64_t)_leaves.size();
+					_leaves.push_back(l);
+				}
+				_is_game_ready = true;
+				return true;
+			}
+
+			int64_t br_engine::find_action_child(int64_t action_node, int amount_units) const
+			{
+				for(int64_t c = _children_begin[(std::size_t)action_node]; c < _children_begin[(std::size_t)action_node + 1]; ++c)
+				{
+					int64_t child = _children[(std::size_t)c];
+					double amount = _action_tree.node<action_tree_node>(child).amount;
+					if((int64_t)floor(amount / strategy_tree_node::AMOUNT_FACTOR + 0.5) == amount_units)
+					{
+						return child;
+					}
+				}
+				return -1;
+			}
+
+			bool br_engine::prepare_reach(int p)
+			{
+				const uf_tree & tree = _strategy_trees[p];
+				if(tree.nodes_count() == 0)
+				{
+					return fail("strategy trees of the opponents must be set");
+				}
+				if(tree.node<strategy_tree_node>(0).position() != _players_count)
+				{
+					return fail("inconsistent number of players in the input trees");
+				}
+				std::vector<std::vector<double> > & reach = _reach[p];
+				reach.resize(_leaves.size());
+				for(std::size_t l = 0; l < _leaves.size(); ++l)
+				{
+					reach[l].assign(index_size(p, _leaves[l].round), 0.0);
+				}
+
+				// Walk the strategy tree in parallel with the action tree, like Br.PrepareStrategicProbabs.
+				struct context
+				{
+					int64_t action_node;
+					double probab;
+					int round;
+					int chance_idx;
+				};
+				std::vector<context> stack(256);
+				stack[0].action_node = 0;
+				stack[0].probab = 1;
+				stack[0].round = -1;
+				stack[0].chance_idx = 0;
+				for(int64_t i = 1; i < tree.nodes_count(); ++i)
+				{
+					int d = tree.depth(i);
+					if(d < 1 || d > tree.depth(i - 1) + 1)
+					{
+						return fail("the strategy tree is not in preorder");
+					}
+					const strategy_tree_node & node = tree.node<strategy_tree_node>(i);
+					context & c = stack[d];
+					c = stack[d - 1];
+					if(node.is_dealer_action())
+					{
+						c.round++;
+						if(c.round >= _rounds_count)
+						{
+							return fail("the strategy tree has too many rounds");
+						}
+						c.chance_idx += index_size(p, c.round - 1) * node.card();
+						if(c.chance_idx >= index_size(p, c.round))
+						{
+							return fail("a card of the strategy tree is not in the chance tree");
+						}
+						continue;
+					}
+					if(node.position() == p && i > _players_count)
+					{
+						c.probab = node.probab;
+					}
+					c.action_node = find_action_child(c.action_node, node.amount_units());
+					if(c.action_node == -1)
+					{
+						std::ostringstream os;
+						os << "cannot find action tree node for player " << p << ", strategy node " << i;
+						return fail(os.str());
+					}
+					int64_t l = _leaf_idx[(std::size_t)c.action_node];
+					if(l >= 0)
+					{
+						if(_leaves[(std::size_t)l].round != c.round)
+						{
+							return fail("rounds of the strategy and action trees do not match");
+						}
+						reach[(std::size_t)l][c.chance_idx] = c.probab;
+					}
+				}
+				_is_reach_ready[p] = true;
+				return true;
+			}
+
+			void br_engine::prepare_chance_matrices(int hero, std::vector<std::vector<double> > & p,
+				std::vector<std::vector<double> > & q) const
+			{
+				int n = _players_count;
+				p.assign(_rounds_count, std::vector<double>());
+				q.assign(_rounds_count, std::vector<double>());
+				std::vector<int> oppSizes(_rounds_count, 1);
+				for(int r = 0; r < _rounds_count; ++r)
+				{
+					for(int pl = 0; pl < n; ++pl)
+					{
+						if(pl != hero)
+						{
+							oppSizes[r] *= index_size(pl, r);
+						}
+					}
+					p[r].assign((std::size_t)index_size(hero, r) * oppSizes[r], 0.0);
+				}
+				for(std::size_t l = 0; l < _leaves.size(); ++l)
+				{
+					int r = _leaves[l].round;
+					if(_leaves[l].is_showdown && q[r].empty())
+					{
+						q[r].assign(p[r].size(), 0.0);
+					}
+				}
+
+				// Chance indexes of all players for each depth.
+				std::vector<int> stack((std::size_t)(_rounds_count * n + 1) * n, 0);
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					const chance_tree_node & node = _chance_tree.node<chance_tree_node>(i);
+					int d = _chance_tree.depth(i);
+					int r = (d - 1) / n;
+					int * idx = &stack[(std::size_t)d * n];
+					std::copy(&stack[(std::size_t)(d - 1) * n], &stack[(std::size_t)d * n], idx);
+					idx[node.position] += index_size(node.position, r - 1) * node.card;
+					if(node.position != n - 1)
+					{
+						continue;
+					}
+					// All players got cards in this round.
+					int o = 0;
+					int oOffset = 1;
+					for(int pl = 0; pl < n; ++pl)
+					{
+						if(pl == hero)
+						{
+							continue;
+						}
+						o += oOffset * idx[pl];
+						oOffset *= index_size(pl, r);
+					}
+					std::size_t e = (std::size_t)idx[hero] * oppSizes[r] + o;
+					p[r][e] = node.probab;
+					if(!q[r].empty())
+					{
+						double share = hero == 0 ? node.pot_share0 : (hero == 1 ? 1.0 - node.pot_share0 : 0.0);
+						q[r][e] = node.probab * share;
+					}
+				}
+			}
+
+			void br_engine::evaluate_block(int hero, const leaf * const * block, int block_size,
+				const std::vector<double> & p, const std::vector<double> & q,
+				std::vector<std::vector<double> > & values) const
+			{
+				const int B = LEAF_BLOCK;
+				int round = block[0]->round;
+				int heroSize = index_size(hero, round);
+				int oppSize = (int)(p.size() / heroSize);
+
+				// Reaches of the opponents, r[o * B + j] for leaf j.
+				std::vector<double> r((std::size_t)oppSize * B, 0.0);
+				for(int j = 0; j < block_size; ++j)
+				{
+					std::size_t l = (std::size_t)_leaf_idx[(std::size_t)block[j]->node];
+					int digits[MAX_PLAYERS] = {0};
+					for(int o = 0; o < oppSize; ++o)
+					{
+						double reach = 1;
+						for(int pl = 0, k = 0; pl < _players_count; ++pl)
+						{
+							if(pl != hero)
+							{
+								reach *= _reach[pl][l][digits[k++]];
+							}
+						}
+						r[(std::size_t)o * B + j] = reach;
+						// Next combination of the opponent indexes.
+						for(int pl = 0, k = 0; pl < _players_count; ++pl)
+						{
+							if(pl == hero)
+							{
+								continue;
+							}
+							if(++digits[k] < index_size(pl, round))
+							{
+								break;
+							}
+							digits[k++] = 0;
+						}
+					}
+				}
+
+				bool isShowdown = block[0]->is_showdown;
+				double coeffP[B], coeffQ[B];
+				for(int j = 0; j < B; ++j)
+				{
+					coeffP[j] = coeffQ[j] = 0;
+					if(j >= block_size)
+					{
+						continue;
+					}
+					const leaf & l = *block[j];
+					if(isShowdown)
+					{
+						coeffQ[j] = l.pot;
+						coeffP[j] = -l.in_pot[hero];
+					}
+					else
+					{
+						double share = (l.active_players & (1 << hero)) ? 1.0 : 0.0;
+						coeffP[j] = l.pot * share - l.in_pot[hero];
+					}
+					values[(std::size_t)l.node].assign(heroSize, 0.0);
+				}
+
+				const double * rp = &r[0];
+				for(int h = 0; h < heroSize; ++h)
+				{
+					double accP[B], accQ[B];
+					for(int j = 0; j < B; ++j)
+					{
+						accP[j] = accQ[j] = 0;
+					}
+					const double * pRow = &p[(std::size_t)h * oppSize];
+					if(isShowdown)
+					{
+						const double * qRow = &q[(std::size_t)h * oppSize];
+						for(int o = 0; o < oppSize; ++o)
+						{
+							double pv = pRow[o], qv = qRow[o];
+							if(pv == 0)
+							{
+								continue;
+							}
+							const double * ro = rp + (std::size_t)o * B;
+							for(int j = 0; j < B; ++j)
+							{
+								accP[j] += pv * ro[j];
+								accQ[j] += qv * ro[j];
+							}
+						}
+					}
+					else
+					{
+						for(int o = 0; o < oppSize; ++o)
+						{
+							double pv = pRow[o];
+							if(pv == 0)
+							{
+								continue;
+							}
+							const double * ro = rp + (std::size_t)o * B;
+							for(int j = 0; j < B; ++j)
+							{
+								accP[j] += pv * ro[j];
+							}
+						}
+					}
+					for(int j = 0; j < block_size; ++j)
+					{
+						values[(std::size_t)block[j]->node][h] = coeffQ[j] * accQ[j] + coeffP[j] * accP[j];
+					}
+				}
+			}
+
+			bool br_engine::solve(int hero_position, double & value)
+			{
+				if(!_is_game_ready && !prepare_game())
+				{
+					return false;
+				}
+				if(hero_position < 0 || hero_position >= _players_count)
+				{
+					return fail("hero position is out of range");
+				}
+				for(int p = 0; p < _players_count; ++p)
+				{
+					if(p != hero_position && !_is_reach_ready[p] && !prepare_reach(p))
+					{
+						return false;
+					}
+				}
+
+				std::vector<std::vector<double> > p, q;
+				prepare_chance_matrices(hero_position, p, q);
+
+				// Group the leaves by round and kind, cut the groups into blocks.
+				std::vector<const leaf *> sorted(_leaves.size());
+				for(std::size_t l = 0; l < _leaves.size(); ++l)
+				{
+					sorted[l] = &_leaves[l];
+				}
+				struct by_group
+				{
+					bool operator()(const leaf * a, const leaf * b) const
+					{
+						if(a->round != b->round)
+						{
+							return a->round < b->round;
+						}
+						if(a->is_showdown != b->is_showdown)
+						{
+							return a->is_showdown < b->is_showdown;
+						}
+						return a->node < b->node;
+					}
+				};
+				std::sort(sorted.begin(), sorted.end(), by_group());
+				std::vector<int> blockBegin;
+				for(std::size_t l = 0; l < sorted.size(); ++l)
+				{
+					if(blockBegin.empty() || (int)l - blockBegin.back() == LEAF_BLOCK ||
+						sorted[l]->round != sorted[l - 1]->round || sorted[l]->is_showdown != sorted[l - 1]->is_showdown)
+					{
+						blockBegin.push_back((int)l);
+					}
+				}
+				int blocksCount = (int)blockBegin.size();
+				blockBegin.push_back((int)sorted.size());
+
+				std::vector<std::vector<double> > values((std::size_t)_action_tree.nodes_count());
+#ifdef _OPENMP
+				#pragma omp parallel for schedule(dynamic, 1) num_threads(_thread_count)
+#endif
+				for(int b = 0; b < blocksCount; ++b)
+				{
+					int r = sorted[blockBegin[b]]->round;
+					evaluate_block(hero_position, &sorted[blockBegin[b]], blockBegin[b + 1] - blockBegin[b],
+						p[r], q[r], values);
+				}
+
+				// Propagate the values to the root. The children follow the parent in preorder.
+				for(int64_t i = _action_tree.nodes_count() - 1; i >= 0; --i)
+				{
+					int64_t chBegin = _children_begin[(std::size_t)i], chEnd = _children_begin[(std::size_t)i + 1];
+					if(chBegin == chEnd)
+					{
+						continue;
+					}
+					const action_tree_node & first = _action_tree.node<action_tree_node>(_children[(std::size_t)chBegin]);
+					bool isHero = first.position == hero_position;
+					std::vector<double> combined;
+					combined.swap(values[(std::size_t)_children[(std::size_t)chBegin]]);
+					for(int64_t c = chBegin + 1; c < chEnd; ++c)
+					{
+						std::vector<double> & v = values[(std::size_t)_children[(std::size_t)c]];
+						for(std::size_t h = 0; h < combined.size(); ++h)
+						{
+							combined[h] = isHero ? std::max(combined[h], v[h]) : combined[h] + v[h];
+						}
+						std::vector<double>().swap(v);
+					}
+					int round = _action_tree.node<action_tree_node>(i).round;
+					if(first.round == round)
+					{
+						values[(std::size_t)i].swap(combined);
+						continue;
+					}
+					// Sum over the cards dealt to the hero after this node.
+					int size = index_size(hero_position, round);
+					std::vector<double> & v = values[(std::size_t)i];
+					v.assign(size, 0.0);
+					for(std::size_t h = 0; h < combined.size(); ++h)
+					{
+						v[h % size] += combined[h];
+					}
+				}
+				value = values[0][0];
+				return true;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,164 @@
+#ifndef AI_PKR_METASTRATEGY_CPPLIB_BR_ENGINE_H
+#define AI_PKR_METASTRATEGY_CPPLIB_BR_ENGINE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "uf_tree.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metastrategy
+		{
+
+			/** Best response, native version of Br (C#). Input: the action tree, the chance tree and the
+			absolute strategy trees of the opponents, the same data as for Br (the trees can be loaded
+			from the files written by UFTree.Write()). Output: the game value of the best response of the hero.
+			<p>Br walks the strategy tree of the hero and evaluates each leaf by enumerating the chance indexes
+			of the opponents. Here the work is organized by public states (action tree nodes) instead:</p>
+			<p>1. The reach of each opponent is calculated once per action tree leaf for all his chance indexes
+			(the same index as in Br: cards of the rounds 0..r with offsets prod(maxCard + 1)).
+			The reach vectors do not depend on the hero and are kept until the strategy changes.</p>
+			<p>2. For each round the chance tree is turned into dense matrices over (hero index, opponents index):
+			P - probability of the deal, Q - P times the pot share of the hero. The values of the leaves
+			are then matrix-vector products: fold: (pot * share - inPot) * P * reach,
+			showdown: pot * Q * reach - inPot * P * reach. The leaves of a round are processed in blocks
+			of LEAF_BLOCK, so that a row of the matrices is multiplied by the reaches of all leaves
+			of the block at once (the inner loop over the leaves is vectorized).
+			The blocks are processed in parallel with OpenMP (if available).</p>
+			<p>3. The value vectors (over the hero index) are propagated to the root: maximum over
+			the actions of the hero, sum over the actions of the opponents and over the cards of the hero
+			dealt between the rounds.</p>
+			<p>The pot share is calculated like ChanceTreeNode.GetPotShare(): a single active player gets
+			the pot, otherwise position 0 gets pot_share0 and position 1 the rest.</p>
+			*/
+			class br_engine
+			{
+			public:
+				enum tree_kind
+				{
+					ACTION_TREE = 0,
+					CHANCE_TREE = 1,
+					STRATEGY_TREE = 2
+				};
+
+				static const int MAX_PLAYERS = 8;
+				static const int LEAF_BLOCK = 8;
+
+				br_engine() : _thread_count(1), _players_count(0), _rounds_count(0), _is_game_ready(false)
+				{
+					for(int p = 0; p < MAX_PLAYERS; ++p)
+					{
+						_is_reach_ready[p] = false;
+					}
+				}
+
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				/// Sets the number of threads, default: 1.
+				bool set_thread_count(int thread_count);
+
+				int thread_count() const
+				{
+					return _thread_count;
+				}
+
+				/// Loads a tree from a file written by UFTree.Write(). Position is used for strategy trees only.
+				bool load_tree(tree_kind kind, int position, const char * file_name);
+
+				/// Copies a tree from memory. node_byte_size must match the layout of the node of this kind.
+				bool set_tree(tree_kind kind, int position, int64_t nodes_count, const uint8_t * depths,
+					const void * nodes, int node_byte_size);
+
+				/** Calculates the value of the best response of the hero against the strategy trees
+				of the other positions.
+				*/
+				bool solve(int hero_position, double & value);
+
+				int players_count() const
+				{
+					return _players_count;
+				}
+
+			private:
+				/// A leaf of the action tree.
+				struct leaf
+				{
+					int64_t node;
+					int round;
+					bool is_showdown;
+					double pot;
+					double in_pot[MAX_PLAYERS];
+					uint16_t active_players;
+				};
+
+				bool fail(const std::string & error)
+				{
+					_error = error;
+					return false;
+				}
+
+				static int node_byte_size(tree_kind kind);
+
+				uf_tree * get_tree(tree_kind kind, int position);
+
+				void tree_changed(tree_kind kind, int position);
+
+				/// Indexes the action and the chance trees.
+				bool prepare_game();
+
+				/// Calculates the reach vectors of the opponent at position p.
+				bool prepare_reach(int p);
+
+				/// Number of chance indexes of the player up to the round (1 for round -1).
+				int index_size(int p, int round) const
+				{
+					return round < 0 ? 1 : _index_sizes[p][round];
+				}
+
+				/// Finds the child of the action tree node with the amount of the strategy node.
+				int64_t find_action_child(int64_t action_node, int amount_units) const;
+
+				/// Calculates the matrices P and Q of the round for the hero.
+				void prepare_chance_matrices(int hero, std::vector<std::vector<double> > & p,
+					std::vector<std::vector<double> > & q) const;
+
+				/// Calculates the values of the leaves of a block, stores them in values.
+				void evaluate_block(int hero, const leaf * const * block, int block_size,
+					const std::vector<double> & p, const std::vector<double> & q,
+					std::vector<std::vector<double> > & values) const;
+
+				int _thread_count;
+				std::string _error;
+
+				uf_tree _action_tree;
+				uf_tree _chance_tree;
+				uf_tree _strategy_trees[MAX_PLAYERS];
+
+				int _players_count;
+				int _rounds_count;
+				bool _is_game_ready;
+				/// _index_sizes[p][r]: number of chance indexes of player p in round r.
+				std::vector<std::vector<int> > _index_sizes;
+				/// Children of the action tree nodes: _children[_children_begin[n] .. _children_begin[n + 1] - 1].
+				std::vector<int64_t> _children_begin;
+				std::vector<int64_t> _children;
+				std::vector<leaf> _leaves;
+				/// Index in _leaves of each action tree node, -1 for inner nodes.
+				std::vector<int64_t> _leaf_idx;
+				/// _reach[p][l]: reach of the opponent p for the chance indexes of the round of leaf l.
+				std::vector<std::vector<double> > _reach[MAX_PLAYERS];
+				bool _is_reach_ready[MAX_PLAYERS];
+			};
+
+		}
+	}
+}
+
+#endif
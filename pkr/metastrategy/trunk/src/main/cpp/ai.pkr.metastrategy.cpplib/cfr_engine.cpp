@@ -0,0 +1,749 @@
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "cfr_engine.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metastrategy
+		{
+
+			static int CountBits(uint16_t mask)
+			{
+				int count = 0;
+				for(; mask; mask &= mask - 1)
+				{
+					++count;
+				}
+				return count;
+			}
+
+			bool cfr_engine::set_thread_count(int thread_count)
+			{
+				if(thread_count < 1)
+				{
+					return fail("the number of threads must be positive");
+				}
+				_thread_count = thread_count;
+				return true;
+			}
+
+			int cfr_engine::node_byte_size(tree_kind kind)
+			{
+				return kind == ACTION_TREE ? (int)sizeof(action_tree_node) : (int)sizeof(chance_tree_node);
+			}
+
+			uf_tree * cfr_engine::get_tree(tree_kind kind)
+			{
+				switch(kind)
+				{
+				case ACTION_TREE:
+					return &_action_tree;
+				case CHANCE_TREE:
+					return &_chance_tree;
+				}
+				fail("unknown tree kind");
+				return 0;
+			}
+
+			bool cfr_engine::load_tree(tree_kind kind, const char * file_name)
+			{
+				uf_tree * tree = get_tree(kind);
+				if(!tree)
+				{
+					return false;
+				}
+				_is_game_ready = false;
+				if(!tree->read(file_name, node_byte_size(kind)))
+				{
+					return fail(tree->error());
+				}
+				return true;
+			}
+
+			bool cfr_engine::set_tree(tree_kind kind, int64_t nodes_count, const uint8_t * depths,
+				const void * nodes, int node_byte_size)
+			{
+				uf_tree * tree = get_tree(kind);
+				if(!tree)
+				{
+					return false;
+				}
+				_is_game_ready = false;
+				if(node_byte_size != cfr_engine::node_byte_size(kind))
+				{
+					tree->clear();
+					std::ostringstream os;
+					os << "wrong node size " << node_byte_size << ", expected " << cfr_engine::node_byte_size(kind);
+					return fail(os.str());
+				}
+				if(!tree->set(nodes_count, depths, nodes, node_byte_size))
+				{
+					return fail(tree->error());
+				}
+				return true;
+			}
+
+			bool cfr_engine::prepare_game()
+			{
+				const int n = PLAYERS_COUNT;
+				if(_action_tree.nodes_count() == 0 || _chance_tree.nodes_count() == 0)
+				{
+					return fail("action and chance trees must be set");
+				}
+				if(_action_tree.node<action_tree_node>(0).position != n)
+				{
+					return fail("only heads-up games are supported");
+				}
+				if(_chance_tree.node<chance_tree_node>(0).position != n)
+				{
+					return fail("inconsistent number of players in the input trees");
+				}
+
+				// Chance tree: number of rounds and max. card of each player in each round.
+				int maxDepth = 0;
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					int d = _chance_tree.depth(i);
+					if(_chance_tree.node<chance_tree_node>(i).position != (d - 1) % n)
+					{
+						return fail("unexpected position in the chance tree");
+					}
+					maxDepth = std::max(maxDepth, d);
+				}
+				if(maxDepth == 0 || maxDepth % n != 0)
+				{
+					return fail("the chance tree must deal cards to all players in each round");
+				}
+				_rounds_count = maxDepth / n;
+				std::vector<std::vector<int> > maxCard(n, std::vector<int>(_rounds_count, 0));
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					const chance_tree_node & node = _chance_tree.node<chance_tree_node>(i);
+					int & mc = maxCard[node.position][(_chance_tree.depth(i) - 1) / n];
+					mc = std::max(mc, (int)node.card);
+				}
+				_index_sizes.assign(n, std::vector<int>(_rounds_count, 0));
+				for(int p = 0; p < n; ++p)
+				{
+					int64_t size = 1;
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						size *= maxCard[p][r] + 1;
+						if(size > (1 << 24))
+						{
+							return fail("too many chance indexes");
+						}
+						_index_sizes[p][r] = (int)size;
+					}
+				}
+
+				// Action tree: children index.
+				int64_t count = _action_tree.nodes_count();
+				std::vector<int64_t> stack(256, 0);
+				_parents.assign((std::size_t)count, -1);
+				_children_begin.assign((std::size_t)count + 1, 0);
+				for(int64_t i = 1; i < count; ++i)
+				{
+					int d = _action_tree.depth(i);
+					if(d < 1 || d > _action_tree.depth(i - 1) + 1)
+					{
+						return fail("the action tree is not in preorder");
+					}
+					_parents[(std::size_t)i] = stack[d - 1];
+					stack[d] = i;
+					_children_begin[(std::size_t)_parents[(std::size_t)i] + 1]++;
+				}
+				for(int64_t i = 0; i < count; ++i)
+				{
+					_children_begin[(std::size_t)i + 1] += _children_begin[(std::size_t)i];
+				}
+				_children.assign((std::size_t)(count - 1), 0);
+				std::vector<int64_t> fill(_children_begin.begin(), _children_begin.end() - 1);
+				for(int64_t i = 1; i < count; ++i)
+				{
+					_children[(std::size_t)fill[(std::size_t)_parents[(std::size_t)i]]++] = i;
+				}
+
+				// Nodes and leaves.
+				_nodes.assign((std::size_t)count, node_info());
+				_leaves.clear();
+				std::vector<double> inPot((std::size_t)(256 * n), 0.0);
+				std::size_t strategySize = 0;
+				std::size_t vectorSizes[PLAYERS_COUNT] = {0, 0};
+				for(int64_t i = 0; i < count; ++i)
+				{
+					const action_tree_node & node = _action_tree.node<action_tree_node>(i);
+					node_info & info = _nodes[(std::size_t)i];
+					int d = _action_tree.depth(i);
+					info.round = node.round;
+					info.action = 0;
+					if(i > 0)
+					{
+						int64_t parent = _parents[(std::size_t)i];
+						if(node.position < 0 || node.position >= n)
+						{
+							return fail("unexpected position in the action tree");
+						}
+						if(node.round < _action_tree.node<action_tree_node>(parent).round || node.round >= _rounds_count)
+						{
+							return fail("unexpected round in the action tree");
+						}
+						info.action = (int)(std::find(&_children[(std::size_t)_children_begin[(std::size_t)parent]],
+							&_children[0] + _children_begin[(std::size_t)parent + 1], i) -
+							&_children[(std::size_t)_children_begin[(std::size_t)parent]]);
+						double * ip = &inPot[d * n];
+						std::copy(&inPot[(d - 1) * n], &inPot[d * n], ip);
+						ip[node.position] += node.amount;
+					}
+					for(int p = 0; p < n; ++p)
+					{
+						info.vector_offset[p] = vectorSizes[p];
+						vectorSizes[p] += index_size(p, info.round);
+					}
+					int childrenCount = children_count(i);
+					if(childrenCount > 0)
+					{
+						const action_tree_node & first = _action_tree.node<action_tree_node>(
+							_children[(std::size_t)_children_begin[(std::size_t)i]]);
+						for(int c = 1; c < childrenCount; ++c)
+						{
+							const action_tree_node & child = _action_tree.node<action_tree_node>(
+								_children[(std::size_t)_children_begin[(std::size_t)i] + c]);
+							if(child.position != first.position || child.round != first.round)
+							{
+								return fail("the children of a node must have the same position and round");
+							}
+						}
+						info.actor = first.position;
+						info.child_round = first.round;
+						info.strategy_offset = strategySize;
+						strategySize += (std::size_t)childrenCount * index_size(info.actor, info.child_round);
+						continue;
+					}
+					info.actor = -1;
+					info.child_round = info.round;
+					info.strategy_offset = 0;
+					leaf l;
+					l.node = i;
+					l.round = node.round;
+					l.active_players = node.active_players;
+					l.is_showdown = CountBits(node.active_players) > 1;
+					if(l.round < 0)
+					{
+						return fail("a leaf of the action tree before the first round");
+					}
+					if(l.is_showdown && l.round != _rounds_count - 1)
+					{
+						return fail("must be either chance leaf or single active player");
+					}
+					l.pot = 0;
+					const double * ip = &inPot[d * n];
+					for(int p = 0; p < n; ++p)
+					{
+						l.in_pot[p] = ip[p];
+						l.pot += ip[p];
+					}
+					_leaves.push_back(l);
+				}
+
+				// Group the leaves by round and kind, cut the groups into blocks.
+				_sorted_leaves.resize(_leaves.size());
+				for(std::size_t l = 0; l < _leaves.size(); ++l)
+				{
+					_sorted_leaves[l] = &_leaves[l];
+				}
+				struct by_group
+				{
+					bool operator()(const leaf * a, const leaf * b) const
+					{
+						if(a->round != b->round)
+						{
+							return a->round < b->round;
+						}
+						if(a->is_showdown != b->is_showdown)
+						{
+							return a->is_showdown < b->is_showdown;
+						}
+						return a->node < b->node;
+					}
+				};
+				std::sort(_sorted_leaves.begin(), _sorted_leaves.end(), by_group());
+				_block_begin.clear();
+				for(std::size_t l = 0; l < _sorted_leaves.size(); ++l)
+				{
+					if(_block_begin.empty() || (int)l - _block_begin.back() == LEAF_BLOCK ||
+						_sorted_leaves[l]->round != _sorted_leaves[l - 1]->round ||
+						_sorted_leaves[l]->is_showdown != _sorted_leaves[l - 1]->is_showdown)
+					{
+						_block_begin.push_back((int)l);
+					}
+				}
+				_block_begin.push_back((int)_sorted_leaves.size());
+
+				prepare_chance_matrices();
+
+				_regrets.assign(strategySize, 0.0);
+				_average.assign(strategySize, 0.0);
+				_strategy.assign(strategySize, 0.0);
+				for(int p = 0; p < n; ++p)
+				{
+					_reach[p].assign(vectorSizes[p], 0.0);
+					_values[p].assign(vectorSizes[p], 0.0);
+				}
+				_iteration_count = 0;
+				_is_game_ready = true;
+				return true;
+			}
+
+			int64_t cfr_engine::find_action_child(int64_t action_node, int amount_units) const
+			{
+				for(int64_t c = _children_begin[(std::size_t)action_node]; c < _children_begin[(std::size_t)action_node + 1]; ++c)
+				{
+					int64_t child = _children[(std::size_t)c];
+					double amount = _action_tree.node<action_tree_node>(child).amount;
+					if((int64_t)floor(amount / strategy_tree_node::AMOUNT_FACTOR + 0.5) == amount_units)
+					{
+						return child;
+					}
+				}
+				return -1;
+			}
+
+			void cfr_engine::prepare_chance_matrices()
+			{
+				const int n = PLAYERS_COUNT;
+				std::vector<bool> isShowdownRound(_rounds_count, false);
+				for(std::size_t l = 0; l < _leaves.size(); ++l)
+				{
+					if(_leaves[l].is_showdown)
+					{
+						isShowdownRound[_leaves[l].round] = true;
+					}
+				}
+				for(int hero = 0; hero < n; ++hero)
+				{
+					int opp = 1 - hero;
+					_p[hero].assign(_rounds_count, std::vector<double>());
+					_q[hero].assign(_rounds_count, std::vector<double>());
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						_p[hero][r].assign((std::size_t)index_size(hero, r) * index_size(opp, r), 0.0);
+						if(isShowdownRound[r])
+						{
+							_q[hero][r].assign(_p[hero][r].size(), 0.0);
+						}
+					}
+				}
+
+				// Chance indexes of both players for each depth.
+				std::vector<int> stack((std::size_t)(_rounds_count * n + 1) * n, 0);
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					const chance_tree_node & node = _chance_tree.node<chance_tree_node>(i);
+					int d = _chance_tree.depth(i);
+					int r = (d - 1) / n;
+					int * idx = &stack[(std::size_t)d * n];
+					std::copy(&stack[(std::size_t)(d - 1) * n], &stack[(std::size_t)d * n], idx);
+					idx[node.position] += index_size(node.position, r - 1) * node.card;
+					if(node.position != n - 1)
+					{
+						continue;
+					}
+					// Both players got cards in this round.
+					for(int hero = 0; hero < n; ++hero)
+					{
+						int opp = 1 - hero;
+						std::size_t e = (std::size_t)idx[hero] * index_size(opp, r) + idx[opp];
+						_p[hero][r][e] = node.probab;
+						if(!_q[hero][r].empty())
+						{
+							double share = hero == 0 ? node.pot_share0 : 1.0 - node.pot_share0;
+							_q[hero][r][e] = node.probab * share;
+						}
+					}
+				}
+			}
+
+			void cfr_engine::calculate_strategy(bool average)
+			{
+				const std::vector<double> & source = average ? _average : _regrets;
+				int64_t count = _action_tree.nodes_count();
+#ifdef _OPENMP
+				#pragma omp parallel for schedule(dynamic, 64) num_threads(_thread_count)
+#endif
+				for(int64_t i = 0; i < count; ++i)
+				{
+					const node_info & info = _nodes[(std::size_t)i];
+					int k = children_count(i);
+					if(k == 0)
+					{
+						continue;
+					}
+					int size = index_size(info.actor, info.child_round);
+					const double * src = &source[info.strategy_offset];
+					double * dst = &_strategy[info.strategy_offset];
+					for(int h = 0; h < size; ++h)
+					{
+						// The regrets of CFR+ and the average are non-negative.
+						double sum = 0;
+						for(int a = 0; a < k; ++a)
+						{
+							sum += src[a * size + h];
+						}
+						for(int a = 0; a < k; ++a)
+						{
+							dst[a * size + h] = sum > 0 ? src[a * size + h] / sum : 1.0 / k;
+						}
+					}
+				}
+			}
+
+			void cfr_engine::calculate_reach()
+			{
+				for(int p = 0; p < PLAYERS_COUNT; ++p)
+				{
+					_reach[p][0] = 1;
+				}
+				// The parent precedes the children in preorder.
+				for(int64_t i = 1; i < _action_tree.nodes_count(); ++i)
+				{
+					const node_info & info = _nodes[(std::size_t)i];
+					const node_info & parent = _nodes[(std::size_t)_parents[(std::size_t)i]];
+					for(int p = 0; p < PLAYERS_COUNT; ++p)
+					{
+						const double * src = &_reach[p][parent.vector_offset[p]];
+						double * dst = &_reach[p][info.vector_offset[p]];
+						int srcSize = index_size(p, parent.round);
+						int size = index_size(p, info.round);
+						// A chance index of a later round continues the index of the previous rounds.
+						if(p == parent.actor)
+						{
+							const double * s = &_strategy[parent.strategy_offset + (std::size_t)info.action * size];
+							for(int j = 0; j < size; ++j)
+							{
+								dst[j] = src[j % srcSize] * s[j];
+							}
+						}
+						else
+						{
+							for(int j = 0; j < size; ++j)
+							{
+								dst[j] = src[j % srcSize];
+							}
+						}
+					}
+				}
+			}
+
+			void cfr_engine::evaluate_block(int hero, const leaf * const * block, int block_size)
+			{
+				const int B = LEAF_BLOCK;
+				int opp = 1 - hero;
+				int round = block[0]->round;
+				int heroSize = index_size(hero, round);
+				int oppSize = index_size(opp, round);
+				const std::vector<double> & p = _p[hero][round];
+				const std::vector<double> & q = _q[hero][round];
+
+				// Reaches of the opponent, r[o * B + j] for leaf j.
+				std::vector<double> r((std::size_t)oppSize * B, 0.0);
+				for(int j = 0; j < block_size; ++j)
+				{
+					const double * reach = &_reach[opp][_nodes[(std::size_t)block[j]->node].vector_offset[opp]];
+					for(int o = 0; o < oppSize; ++o)
+					{
+						r[(std::size_t)o * B + j] = reach[o];
+					}
+				}
+
+				bool isShowdown = block[0]->is_showdown;
+				double coeffP[B], coeffQ[B];
+				double * values[B];
+				for(int j = 0; j < B; ++j)
+				{
+					coeffP[j] = coeffQ[j] = 0;
+					if(j >= block_size)
+					{
+						continue;
+					}
+					const leaf & l = *block[j];
+					if(isShowdown)
+					{
+						coeffQ[j] = l.pot;
+						coeffP[j] = -l.in_pot[hero];
+					}
+					else
+					{
+						double share = (l.active_players & (1 << hero)) ? 1.0 : 0.0;
+						coeffP[j] = l.pot * share - l.in_pot[hero];
+					}
+					values[j] = &_values[hero][_nodes[(std::size_t)l.node].vector_offset[hero]];
+				}
+
+				const double * rp = &r[0];
+				for(int h = 0; h < heroSize; ++h)
+				{
+					double accP[B], accQ[B];
+					for(int j = 0; j < B; ++j)
+					{
+						accP[j] = accQ[j] = 0;
+					}
+					const double * pRow = &p[(std::size_t)h * oppSize];
+					if(isShowdown)
+					{
+						const double * qRow = &q[(std::size_t)h * oppSize];
+						for(int o = 0; o < oppSize; ++o)
+						{
+							double pv = pRow[o], qv = qRow[o];
+							if(pv == 0)
+							{
+								continue;
+							}
+							const double * ro = rp + (std::size_t)o * B;
+							for(int j = 0; j < B; ++j)
+							{
+								accP[j] += pv * ro[j];
+								accQ[j] += qv * ro[j];
+							}
+						}
+					}
+					else
+					{
+						for(int o = 0; o < oppSize; ++o)
+						{
+							double pv = pRow[o];
+							if(pv == 0)
+							{
+								continue;
+							}
+							const double * ro = rp + (std::size_t)o * B;
+							for(int j = 0; j < B; ++j)
+							{
+								accP[j] += pv * ro[j];
+							}
+						}
+					}
+					for(int j = 0; j < block_size; ++j)
+					{
+						values[j][h] = coeffQ[j] * accQ[j] + coeffP[j] * accP[j];
+					}
+				}
+			}
+
+			void cfr_engine::calculate_values(int hero, pass_kind kind)
+			{
+				int blocksCount = (int)_block_begin.size() - 1;
+#ifdef _OPENMP
+				#pragma omp parallel for schedule(dynamic, 1) num_threads(_thread_count)
+#endif
+				for(int b = 0; b < blocksCount; ++b)
+				{
+					evaluate_block(hero, &_sorted_leaves[_block_begin[b]], _block_begin[b + 1] - _block_begin[b]);
+				}
+
+				// Linear averaging: the weight of the strategy of iteration t (1, 2, ...) is t.
+				double weight = _iteration_count + 1;
+				std::vector<double> combined;
+				// Propagate the values to the root. The children follow the parent in preorder.
+				for(int64_t i = _action_tree.nodes_count() - 1; i >= 0; --i)
+				{
+					const node_info & info = _nodes[(std::size_t)i];
+					int k = children_count(i);
+					if(k == 0)
+					{
+						continue;
+					}
+					int size = index_size(hero, info.child_round);
+					const int64_t * children = &_children[(std::size_t)_children_begin[(std::size_t)i]];
+					const double * first = &_values[hero][_nodes[(std::size_t)children[0]].vector_offset[hero]];
+					combined.assign(first, first + size);
+					if(info.actor != hero)
+					{
+						for(int a = 1; a < k; ++a)
+						{
+							const double * v = &_values[hero][_nodes[(std::size_t)children[a]].vector_offset[hero]];
+							for(int h = 0; h < size; ++h)
+							{
+								combined[h] += v[h];
+							}
+						}
+					}
+					else if(kind == BEST_RESPONSE)
+					{
+						for(int a = 1; a < k; ++a)
+						{
+							const double * v = &_values[hero][_nodes[(std::size_t)children[a]].vector_offset[hero]];
+							for(int h = 0; h < size; ++h)
+							{
+								combined[h] = std::max(combined[h], v[h]);
+							}
+						}
+					}
+					else
+					{
+						const double * s = &_strategy[info.strategy_offset];
+						for(int h = 0; h < size; ++h)
+						{
+							combined[h] *= s[h];
+						}
+						for(int a = 1; a < k; ++a)
+						{
+							const double * v = &_values[hero][_nodes[(std::size_t)children[a]].vector_offset[hero]];
+							const double * sa = s + (std::size_t)a * size;
+							for(int h = 0; h < size; ++h)
+							{
+								combined[h] += sa[h] * v[h];
+							}
+						}
+						double * regrets = &_regrets[info.strategy_offset];
+						double * average = &_average[info.strategy_offset];
+						const double * reach = &_reach[hero][info.vector_offset[hero]];
+						int reachSize = index_size(hero, info.round);
+						for(int a = 0; a < k; ++a)
+						{
+							const double * v = &_values[hero][_nodes[(std::size_t)children[a]].vector_offset[hero]];
+							double * ra = regrets + (std::size_t)a * size;
+							double * wa = average + (std::size_t)a * size;
+							const double * sa = s + (std::size_t)a * size;
+							for(int h = 0; h < size; ++h)
+							{
+								ra[h] = std::max(ra[h] + v[h] - combined[h], 0.0);
+								wa[h] += weight * reach[h % reachSize] * sa[h];
+							}
+						}
+					}
+					double * out = &_values[hero][info.vector_offset[hero]];
+					int outSize = index_size(hero, info.round);
+					if(outSize == size)
+					{
+						std::copy(combined.begin(), combined.end(), out);
+						continue;
+					}
+					// Sum over the cards dealt to the hero after this node.
+					std::fill(out, out + outSize, 0.0);
+					for(int h = 0; h < size; ++h)
+					{
+						out[h % outSize] += combined[h];
+					}
+				}
+			}
+
+			bool cfr_engine::iterate(int iterations_count)
+			{
+				if(!_is_game_ready && !prepare_game())
+				{
+					return false;
+				}
+				for(int it = 0; it < iterations_count; ++it)
+				{
+					// Alternating updates: the second player plays against the updated strategy of the first.
+					for(int hero = 0; hero < PLAYERS_COUNT; ++hero)
+					{
+						calculate_strategy(false);
+						calculate_reach();
+						calculate_values(hero, UPDATE);
+					}
+					++_iteration_count;
+				}
+				return true;
+			}
+
+			bool cfr_engine::best_response_values(double values[PLAYERS_COUNT])
+			{
+				if(!_is_game_ready && !prepare_game())
+				{
+					return false;
+				}
+				calculate_strategy(true);
+				calculate_reach();
+				for(int hero = 0; hero < PLAYERS_COUNT; ++hero)
+				{
+					calculate_values(hero, BEST_RESPONSE);
+					values[hero] = _values[hero][0];
+				}
+				return true;
+			}
+
+			bool cfr_engine::get_strategy(int position, int64_t nodes_count, const uint8_t * depths, strategy_tree_node * nodes)
+			{
+				if(!_is_game_ready && !prepare_game())
+				{
+					return false;
+				}
+				if(position < 0 || position >= PLAYERS_COUNT)
+				{
+					return fail("position is out of range");
+				}
+				if(nodes_count <= 0 || nodes[0].position() != PLAYERS_COUNT)
+				{
+					return fail("inconsistent number of players in the input trees");
+				}
+				calculate_strategy(true);
+
+				// Walk the strategy tree in parallel with the action tree, like br_engine::prepare_reach().
+				struct context
+				{
+					int64_t action_node;
+					double probab;
+					int round;
+					int chance_idx;
+				};
+				std::vector<context> stack(256);
+				stack[0].action_node = 0;
+				stack[0].probab = 1;
+				stack[0].round = -1;
+				stack[0].chance_idx = 0;
+				for(int64_t i = 1; i < nodes_count; ++i)
+				{
+					int d = depths[i];
+					if(d < 1 || d > depths[i - 1] + 1)
+					{
+						return fail("the strategy tree is not in preorder");
+					}
+					strategy_tree_node & node = nodes[i];
+					context & c = stack[d];
+					c = stack[d - 1];
+					if(node.is_dealer_action())
+					{
+						c.round++;
+						if(c.round >= _rounds_count)
+						{
+							return fail("the strategy tree has too many rounds");
+						}
+						c.chance_idx += index_size(position, c.round - 1) * node.card();
+						if(c.chance_idx >= index_size(position, c.round))
+						{
+							return fail("a card of the strategy tree is not in the chance tree");
+						}
+						continue;
+					}
+					int64_t parent = c.action_node;
+					c.action_node = find_action_child(parent, node.amount_units());
+					if(c.action_node == -1)
+					{
+						std::ostringstream os;
+						os << "cannot find action tree node for player " << position << ", strategy node " << i;
+						return fail(os.str());
+					}
+					const node_info & info = _nodes[(std::size_t)parent];
+					if(info.child_round != c.round)
+					{
+						return fail("rounds of the strategy and action trees do not match");
+					}
+					if(node.position() == position)
+					{
+						int size = index_size(position, info.child_round);
+						c.probab *= _strategy[info.strategy_offset +
+							(std::size_t)_nodes[(std::size_t)c.action_node].action * size + c.chance_idx];
+						node.probab = c.probab;
+					}
+				}
+				return true;
+			}
+
+		}
+	}
+}
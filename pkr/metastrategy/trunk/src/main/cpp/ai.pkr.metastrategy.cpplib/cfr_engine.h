@@ -0,0 +1,203 @@
+#ifndef AI_PKR_METASTRATEGY_CPPLIB_CFR_ENGINE_H
+#define AI_PKR_METASTRATEGY_CPPLIB_CFR_ENGINE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "uf_tree.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metastrategy
+		{
+
+			/** CFR+ equilibrium solver for heads-up games. Input: the action tree and the chance tree
+			(the same as for br_engine, can be loaded from the files written by UFTree.Write()).
+			Output: the average strategy, written into strategy trees of the players (absolute probabilities).
+			<p>The regrets are stored in vector form: for each node of the action tree where a player acts,
+			for each action, for each chance index of the player in the round of the action
+			(the same index as in br_engine). An iteration updates the players in turn:</p>
+			<p>1. Top-down: the reach vectors of both players for each node, the strategy is obtained
+			from the regrets by regret matching.</p>
+			<p>2. The values of the leaves for the updated player are matrix-vector products of the chance
+			matrices P and Q with the reach of the opponent, like in br_engine. The leaves are processed
+			in blocks in parallel with OpenMP (if available).</p>
+			<p>3. Bottom-up: the values are propagated to the root, at the nodes of the updated player
+			the regrets are updated and clipped at 0 (regret matching+), the current strategy weighted by the
+			own reach and by the iteration number is added to the average (linear averaging).</p>
+			<p>best_response_values() evaluates the average strategy in the same way, with the maximum
+			over the actions of the hero instead of the strategy.</p>
+			*/
+			class cfr_engine
+			{
+			public:
+				enum tree_kind
+				{
+					ACTION_TREE = 0,
+					CHANCE_TREE = 1
+				};
+
+				static const int PLAYERS_COUNT = 2;
+				static const int LEAF_BLOCK = 8;
+
+				cfr_engine() : _thread_count(1), _rounds_count(0), _is_game_ready(false), _iteration_count(0)
+				{
+				}
+
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				/// Sets the number of threads, default: 1.
+				bool set_thread_count(int thread_count);
+
+				int thread_count() const
+				{
+					return _thread_count;
+				}
+
+				/// Loads a tree from a file written by UFTree.Write(). Resets the solution.
+				bool load_tree(tree_kind kind, const char * file_name);
+
+				/// Copies a tree from memory. node_byte_size must match the layout of the node of this kind.
+				/// Resets the solution.
+				bool set_tree(tree_kind kind, int64_t nodes_count, const uint8_t * depths,
+					const void * nodes, int node_byte_size);
+
+				/// Does iterations_count iterations, each of them updates both players.
+				bool iterate(int iterations_count);
+
+				/// Number of iterations done since the trees were set.
+				int iteration_count() const
+				{
+					return _iteration_count;
+				}
+
+				/** Calculates the values of the best responses of each player against the average strategy
+				of the other. The sum of the values is the exploitability, 0 for an equilibrium.
+				*/
+				bool best_response_values(double values[PLAYERS_COUNT]);
+
+				/** Writes the average strategy of the position to a strategy tree of the position
+				(created for the action tree and the chance tree of the position, like in br_engine).
+				Sets the absolute probabilities of the nodes of the position, other nodes are not changed.
+				*/
+				bool get_strategy(int position, int64_t nodes_count, const uint8_t * depths, strategy_tree_node * nodes);
+
+			private:
+				/// A leaf of the action tree.
+				struct leaf
+				{
+					int64_t node;
+					int round;
+					bool is_showdown;
+					double pot;
+					double in_pot[PLAYERS_COUNT];
+					uint16_t active_players;
+				};
+
+				/// A node of the action tree with the offsets of its data.
+				struct node_info
+				{
+					int round;
+					/// Round of the children.
+					int child_round;
+					/// Position acting in the children, -1 for a leaf.
+					int actor;
+					/// Index of this node among the children of the parent.
+					int action;
+					/// Offset in _regrets, _average and _strategy (actions x chance indexes of the actor).
+					std::size_t strategy_offset;
+					/// Offset in _reach[p] and _values[p].
+					std::size_t vector_offset[PLAYERS_COUNT];
+				};
+
+				enum pass_kind
+				{
+					/// Regret matching, updates of the regrets and of the average.
+					UPDATE,
+					/// The average strategy for the opponent, best response for the hero.
+					BEST_RESPONSE
+				};
+
+				bool fail(const std::string & error)
+				{
+					_error = error;
+					return false;
+				}
+
+				static int node_byte_size(tree_kind kind);
+
+				uf_tree * get_tree(tree_kind kind);
+
+				/// Indexes the trees and allocates the data.
+				bool prepare_game();
+
+				/// Number of chance indexes of the player up to the round (1 for round -1).
+				int index_size(int p, int round) const
+				{
+					return round < 0 ? 1 : _index_sizes[p][round];
+				}
+
+				int children_count(int64_t n) const
+				{
+					return (int)(_children_begin[(std::size_t)n + 1] - _children_begin[(std::size_t)n]);
+				}
+
+				/// Finds the child of the action tree node with the amount of the strategy node.
+				int64_t find_action_child(int64_t action_node, int amount_units) const;
+
+				/// Calculates the matrices P and Q of each round for each player (like br_engine).
+				void prepare_chance_matrices();
+
+				/// Sets _strategy to the current strategy (regret matching) or to the average strategy.
+				void calculate_strategy(bool average);
+
+				/// Calculates the reach vectors of both players with _strategy.
+				void calculate_reach();
+
+				/// Calculates the values of the hero in the leaves of a block.
+				void evaluate_block(int hero, const leaf * const * block, int block_size);
+
+				/// Calculates the values of the hero in all nodes, for UPDATE updates the regrets and the average.
+				void calculate_values(int hero, pass_kind kind);
+
+				int _thread_count;
+				std::string _error;
+
+				uf_tree _action_tree;
+				uf_tree _chance_tree;
+
+				int _rounds_count;
+				bool _is_game_ready;
+				int _iteration_count;
+				/// _index_sizes[p][r]: number of chance indexes of player p in round r.
+				std::vector<std::vector<int> > _index_sizes;
+				/// Children of the action tree nodes: _children[_children_begin[n] .. _children_begin[n + 1] - 1].
+				std::vector<int64_t> _children_begin;
+				std::vector<int64_t> _children;
+				std::vector<int64_t> _parents;
+				std::vector<node_info> _nodes;
+				std::vector<leaf> _leaves;
+				/// The leaves sorted by round and kind, the blocks: _sorted_leaves[_block_begin[b] .. _block_begin[b + 1] - 1].
+				std::vector<const leaf *> _sorted_leaves;
+				std::vector<int> _block_begin;
+				/// _p[hero][r], _q[hero][r]: chance matrices (hero index x opponent index) of round r.
+				std::vector<std::vector<double> > _p[PLAYERS_COUNT];
+				std::vector<std::vector<double> > _q[PLAYERS_COUNT];
+				std::vector<double> _regrets;
+				std::vector<double> _average;
+				std::vector<double> _strategy;
+				std::vector<double> _reach[PLAYERS_COUNT];
+				std::vector<double> _values[PLAYERS_COUNT];
+			};
+
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,509 @@
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "mccfr_engine.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metastrategy
+		{
+
+			static int CountBits(uint16_t mask)
+			{
+				int count = 0;
+				for(; mask; mask &= mask - 1)
+				{
+					++count;
+				}
+				return count;
+			}
+
+			bool mccfr_engine::set_thread_count(int thread_count)
+			{
+				if(thread_count < 1)
+				{
+					return fail("the number of threads must be positive");
+				}
+				_thread_count = thread_count;
+				return true;
+			}
+
+			int mccfr_engine::node_byte_size(tree_kind kind)
+			{
+				return kind == ACTION_TREE ? (int)sizeof(action_tree_node) : (int)sizeof(chance_tree_node);
+			}
+
+			uf_tree * mccfr_engine::get_tree(tree_kind kind)
+			{
+				switch(kind)
+				{
+				case ACTION_TREE:
+					return &_action_tree;
+				case CHANCE_TREE:
+					return &_chance_tree;
+				}
+				fail("unknown tree kind");
+				return 0;
+			}
+
+			bool mccfr_engine::load_tree(tree_kind kind, const char * file_name)
+			{
+				uf_tree * tree = get_tree(kind);
+				if(!tree)
+				{
+					return false;
+				}
+				_is_game_ready = false;
+				if(!tree->read(file_name, node_byte_size(kind)))
+				{
+					return fail(tree->error());
+				}
+				return true;
+			}
+
+			bool mccfr_engine::set_tree(tree_kind kind, int64_t nodes_count, const uint8_t * depths,
+				const void * nodes, int node_byte_size)
+			{
+				uf_tree * tree = get_tree(kind);
+				if(!tree)
+				{
+					return false;
+				}
+				_is_game_ready = false;
+				if(node_byte_size != mccfr_engine::node_byte_size(kind))
+				{
+					tree->clear();
+					std::ostringstream os;
+					os << "wrong node size " << node_byte_size << ", expected " << mccfr_engine::node_byte_size(kind);
+					return fail(os.str());
+				}
+				if(!tree->set(nodes_count, depths, nodes, node_byte_size))
+				{
+					return fail(tree->error());
+				}
+				return true;
+			}
+
+			bool mccfr_engine::prepare_game()
+			{
+				const int n = PLAYERS_COUNT;
+				if(_action_tree.nodes_count() == 0 || _chance_tree.nodes_count() == 0)
+				{
+					return fail("action and chance trees must be set");
+				}
+				if(_action_tree.node<action_tree_node>(0).position != n)
+				{
+					return fail("only heads-up games are supported");
+				}
+				if(_chance_tree.node<chance_tree_node>(0).position != n)
+				{
+					return fail("inconsistent number of players in the input trees");
+				}
+
+				// Chance tree: number of rounds and max. card of each player in each round.
+				int maxDepth = 0;
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					int d = _chance_tree.depth(i);
+					if(_chance_tree.node<chance_tree_node>(i).position != (d - 1) % n)
+					{
+						return fail("unexpected position in the chance tree");
+					}
+					maxDepth = std::max(maxDepth, d);
+				}
+				if(maxDepth == 0 || maxDepth % n != 0)
+				{
+					return fail("the chance tree must deal cards to all players in each round");
+				}
+				_rounds_count = maxDepth / n;
+				std::vector<std::vector<int> > maxCard(n, std::vector<int>(_rounds_count, 0));
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					const chance_tree_node & node = _chance_tree.node<chance_tree_node>(i);
+					int & mc = maxCard[node.position][(_chance_tree.depth(i) - 1) / n];
+					mc = std::max(mc, (int)node.card);
+				}
+				_index_sizes.assign(n, std::vector<int>(_rounds_count, 0));
+				for(int p = 0; p < n; ++p)
+				{
+					int64_t size = 1;
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						size *= maxCard[p][r] + 1;
+						if(size > (1 << 30))
+						{
+							return fail("too many chance indexes");
+						}
+						_index_sizes[p][r] = (int)size;
+					}
+				}
+
+				// Deals: the leaves of the chance tree.
+				_deal_cdf.clear();
+				_deal_pot_share0.clear();
+				_deal_indexes.clear();
+				std::vector<int> stack((std::size_t)(maxDepth + 1) * n, 0);
+				double probabSum = 0;
+				for(int64_t i = 1; i < _chance_tree.nodes_count(); ++i)
+				{
+					const chance_tree_node & node = _chance_tree.node<chance_tree_node>(i);
+					int d = _chance_tree.depth(i);
+					int r = (d - 1) / n;
+					int * idx = &stack[(std::size_t)d * n];
+					std::copy(&stack[(std::size_t)(d - 1) * n], &stack[(std::size_t)d * n], idx);
+					idx[node.position] += index_size(node.position, r - 1) * node.card;
+					bool isLeaf = i + 1 == _chance_tree.nodes_count() || _chance_tree.depth(i + 1) <= d;
+					if(!isLeaf)
+					{
+						continue;
+					}
+					if(d != maxDepth)
+					{
+						return fail("the chance tree must deal cards to all players in each round");
+					}
+					probabSum += node.probab;
+					_deal_cdf.push_back(probabSum);
+					// Copy, push_back() would bind a reference to the field of the packed node.
+					double potShare0 = node.pot_share0;
+					_deal_pot_share0.push_back(potShare0);
+					// The index of each round is the one of the depth of the last card of the round.
+					for(int p = 0; p < n; ++p)
+					{
+						for(int round = 0; round < _rounds_count; ++round)
+						{
+							_deal_indexes.push_back(stack[(std::size_t)(round * n + n) * n + p]);
+						}
+					}
+				}
+				if(probabSum <= 0)
+				{
+					return fail("the sum of the probabilities of the deals must be positive");
+				}
+
+				// Action tree.
+				int64_t count = _action_tree.nodes_count();
+				std::vector<int64_t> parents((std::size_t)count, -1);
+				std::vector<int64_t> path(256, 0);
+				_nodes.assign((std::size_t)count, node_info());
+				for(int64_t i = 1; i < count; ++i)
+				{
+					int d = _action_tree.depth(i);
+					if(d < 1 || d > _action_tree.depth(i - 1) + 1)
+					{
+						return fail("the action tree is not in preorder");
+					}
+					parents[(std::size_t)i] = path[d - 1];
+					path[d] = i;
+					_nodes[(std::size_t)parents[(std::size_t)i]].children_count++;
+				}
+				int64_t childrenBegin = 0;
+				for(int64_t i = 0; i < count; ++i)
+				{
+					_nodes[(std::size_t)i].children_begin = childrenBegin;
+					childrenBegin += _nodes[(std::size_t)i].children_count;
+					_nodes[(std::size_t)i].children_count = 0;
+				}
+				_children.assign((std::size_t)(count - 1), 0);
+				for(int64_t i = 1; i < count; ++i)
+				{
+					node_info & parent = _nodes[(std::size_t)parents[(std::size_t)i]];
+					_children[(std::size_t)(parent.children_begin + parent.children_count++)] = i;
+				}
+
+				std::vector<double> inPot((std::size_t)(256 * n), 0.0);
+				_table_size = 0;
+				for(int64_t i = 0; i < count; ++i)
+				{
+					const action_tree_node & node = _action_tree.node<action_tree_node>(i);
+					node_info & info = _nodes[(std::size_t)i];
+					int d = _action_tree.depth(i);
+					info.round = node.round;
+					if(i > 0)
+					{
+						if(node.position < 0 || node.position >= n)
+						{
+							return fail("unexpected position in the action tree");
+						}
+						if(node.round < _nodes[(std::size_t)parents[(std::size_t)i]].round || node.round >= _rounds_count)
+						{
+							return fail("unexpected round in the action tree");
+						}
+						double * ip = &inPot[d * n];
+						std::copy(&inPot[(d - 1) * n], &inPot[d * n], ip);
+						ip[node.position] += node.amount;
+					}
+					info.is_showdown = false;
+					info.active_players = node.active_players;
+					info.pot = 0;
+					for(int p = 0; p < n; ++p)
+					{
+						info.in_pot[p] = inPot[d * n + p];
+						info.pot += info.in_pot[p];
+					}
+					if(info.children_count > MAX_ACTIONS)
+					{
+						return fail("too many actions in a node of the action tree");
+					}
+					if(info.children_count > 0)
+					{
+						const action_tree_node & first = _action_tree.node<action_tree_node>(_children[(std::size_t)info.children_begin]);
+						for(int c = 1; c < info.children_count; ++c)
+						{
+							const action_tree_node & child = _action_tree.node<action_tree_node>(
+								_children[(std::size_t)info.children_begin + c]);
+							if(child.position != first.position || child.round != first.round)
+							{
+								return fail("the children of a node must have the same position and round");
+							}
+						}
+						info.actor = first.position;
+						info.child_round = first.round;
+						info.table_offset = _table_size;
+						// A single action (e.g. a blind) needs no entries.
+						if(info.children_count > 1)
+						{
+							_table_size += (std::size_t)info.children_count * index_size(info.actor, info.child_round);
+						}
+						continue;
+					}
+					info.actor = -1;
+					info.child_round = info.round;
+					info.table_offset = 0;
+					info.is_showdown = CountBits(node.active_players) > 1;
+					if(info.round < 0)
+					{
+						return fail("a leaf of the action tree before the first round");
+					}
+					if(info.is_showdown && info.round != _rounds_count - 1)
+					{
+						return fail("must be either chance leaf or single active player");
+					}
+				}
+
+				_regrets.reset(new std::atomic<float>[_table_size]);
+				_average.reset(new std::atomic<float>[_table_size]);
+				for(std::size_t e = 0; e < _table_size; ++e)
+				{
+					_regrets[e].store(0, std::memory_order_relaxed);
+					_average[e].store(0, std::memory_order_relaxed);
+				}
+				_iteration_count = 0;
+				_is_game_ready = true;
+				return true;
+			}
+
+			int64_t mccfr_engine::find_action_child(int64_t action_node, int amount_units) const
+			{
+				const node_info & info = _nodes[(std::size_t)action_node];
+				for(int c = 0; c < info.children_count; ++c)
+				{
+					int64_t child = _children[(std::size_t)info.children_begin + c];
+					double amount = _action_tree.node<action_tree_node>(child).amount;
+					if((int64_t)floor(amount / strategy_tree_node::AMOUNT_FACTOR + 0.5) == amount_units)
+					{
+						return child;
+					}
+				}
+				return -1;
+			}
+
+			std::size_t mccfr_engine::sample_deal(rng & r) const
+			{
+				double u = r.next_double() * _deal_cdf.back();
+				std::size_t deal = (std::size_t)(std::upper_bound(_deal_cdf.begin(), _deal_cdf.end(), u) - _deal_cdf.begin());
+				return std::min(deal, _deal_cdf.size() - 1);
+			}
+
+			double mccfr_engine::traverse(int hero, int64_t node, std::size_t deal, rng & r)
+			{
+				const node_info & info = _nodes[(std::size_t)node];
+				int k = info.children_count;
+				if(k == 0)
+				{
+					// The deal and the actions of the opponent are sampled by their probabilities,
+					// so the value is not weighted by them.
+					double share;
+					if(info.is_showdown)
+					{
+						share = hero == 0 ? _deal_pot_share0[deal] : 1.0 - _deal_pot_share0[deal];
+					}
+					else
+					{
+						share = (info.active_players & (1 << hero)) ? 1.0 : 0.0;
+					}
+					return info.pot * share - info.in_pot[hero];
+				}
+				const int64_t * children = &_children[(std::size_t)info.children_begin];
+				if(k == 1)
+				{
+					return traverse(hero, children[0], deal, r);
+				}
+				int idx = info.child_round < 0 ? 0 :
+					_deal_indexes[(deal * PLAYERS_COUNT + info.actor) * _rounds_count + info.child_round];
+				std::size_t offset = info.table_offset + (std::size_t)idx * k;
+				std::atomic<float> * regrets = &_regrets[offset];
+
+				// Regret matching.
+				double strategy[MAX_ACTIONS];
+				double sum = 0;
+				for(int a = 0; a < k; ++a)
+				{
+					sum += strategy[a] = std::max((double)regrets[a].load(std::memory_order_relaxed), 0.0);
+				}
+				for(int a = 0; a < k; ++a)
+				{
+					strategy[a] = sum > 0 ? strategy[a] / sum : 1.0 / k;
+				}
+
+				if(info.actor == hero)
+				{
+					double values[MAX_ACTIONS];
+					double value = 0;
+					for(int a = 0; a < k; ++a)
+					{
+						values[a] = traverse(hero, children[a], deal, r);
+						value += strategy[a] * values[a];
+					}
+					for(int a = 0; a < k; ++a)
+					{
+						add(regrets[a], values[a] - value);
+					}
+					return value;
+				}
+
+				// The opponent: the average is updated where his actions are sampled.
+				std::atomic<float> * average = &_average[offset];
+				for(int a = 0; a < k; ++a)
+				{
+					add(average[a], strategy[a]);
+				}
+				double u = r.next_double();
+				int a = 0;
+				for(; a < k - 1; ++a)
+				{
+					u -= strategy[a];
+					if(u < 0)
+					{
+						break;
+					}
+				}
+				return traverse(hero, children[a], deal, r);
+			}
+
+			bool mccfr_engine::iterate(int64_t iterations_count)
+			{
+				if(!_is_game_ready && !prepare_game())
+				{
+					return false;
+				}
+				int64_t first = _iteration_count;
+#ifdef _OPENMP
+				#pragma omp parallel for schedule(dynamic, 64) num_threads(_thread_count)
+#endif
+				for(int64_t it = 0; it < iterations_count; ++it)
+				{
+					rng r(_seed * 0x2545F4914F6CDD1DULL + (uint64_t)(first + it));
+					for(int hero = 0; hero < PLAYERS_COUNT; ++hero)
+					{
+						traverse(hero, 0, sample_deal(r), r);
+					}
+				}
+				_iteration_count += iterations_count;
+				return true;
+			}
+
+			bool mccfr_engine::get_strategy(int position, int64_t nodes_count, const uint8_t * depths, strategy_tree_node * nodes)
+			{
+				if(!_is_game_ready && !prepare_game())
+				{
+					return false;
+				}
+				if(position < 0 || position >= PLAYERS_COUNT)
+				{
+					return fail("position is out of range");
+				}
+				if(nodes_count <= 0 || nodes[0].position() != PLAYERS_COUNT)
+				{
+					return fail("inconsistent number of players in the input trees");
+				}
+
+				// Walk the strategy tree in parallel with the action tree, like br_engine::prepare_reach().
+				struct context
+				{
+					int64_t action_node;
+					double probab;
+					int round;
+					int chance_idx;
+				};
+				std::vector<context> stack(256);
+				stack[0].action_node = 0;
+				stack[0].probab = 1;
+				stack[0].round = -1;
+				stack[0].chance_idx = 0;
+				for(int64_t i = 1; i < nodes_count; ++i)
+				{
+					int d = depths[i];
+					if(d < 1 || d > depths[i - 1] + 1)
+					{
+						return fail("the strategy tree is not in preorder");
+					}
+					strategy_tree_node & node = nodes[i];
+					context & c = stack[d];
+					c = stack[d - 1];
+					if(node.is_dealer_action())
+					{
+						c.round++;
+						if(c.round >= _rounds_count)
+						{
+							return fail("the strategy tree has too many rounds");
+						}
+						c.chance_idx += index_size(position, c.round - 1) * node.card();
+						if(c.chance_idx >= index_size(position, c.round))
+						{
+							return fail("a card of the strategy tree is not in the chance tree");
+						}
+						continue;
+					}
+					int64_t parent = c.action_node;
+					c.action_node = find_action_child(parent, node.amount_units());
+					if(c.action_node == -1)
+					{
+						std::ostringstream os;
+						os << "cannot find action tree node for player " << position << ", strategy node " << i;
+						return fail(os.str());
+					}
+					const node_info & info = _nodes[(std::size_t)parent];
+					if(info.child_round != c.round)
+					{
+						return fail("rounds of the strategy and action trees do not match");
+					}
+					if(node.position() != position)
+					{
+						continue;
+					}
+					int k = info.children_count;
+					if(k > 1)
+					{
+						const std::atomic<float> * average = &_average[info.table_offset + (std::size_t)c.chance_idx * k];
+						double sum = 0;
+						for(int a = 0; a < k; ++a)
+						{
+							sum += average[a].load(std::memory_order_relaxed);
+						}
+						int action = 0;
+						while(_children[(std::size_t)info.children_begin + action] != c.action_node)
+						{
+							++action;
+						}
+						c.probab *= sum > 0 ? average[action].load(std::memory_order_relaxed) / sum : 1.0 / k;
+					}
+					node.probab = c.probab;
+				}
+				return true;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,213 @@
+#ifndef AI_PKR_METASTRATEGY_CPPLIB_MCCFR_ENGINE_H
+#define AI_PKR_METASTRATEGY_CPPLIB_MCCFR_ENGINE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "uf_tree.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metastrategy
+		{
+
+			/** Monte-Carlo CFR with external sampling for heads-up games too big for the full traversal
+			of cfr_engine. Input: the action tree and the chance tree (the same as for cfr_engine; for a chance
+			abstraction the chance tree created by CreateChanceTreeByAbstraction contains the buckets).
+			Output: the average strategy, written into strategy trees of the players (absolute probabilities),
+			the exploitability is checked with br_engine.
+			<p>An iteration samples a deal (a leaf of the chance tree) for each player in turn, walks all actions
+			of this player and samples the actions of the opponent by his current strategy. The regrets are updated
+			at the nodes of the player, the current strategy is added to the average at the nodes of the opponent.</p>
+			<p>The regrets and the average are floats, for each action tree node where a player acts, for each
+			chance index of the player (the same index as in br_engine), for each action. The iterations
+			are done in parallel with OpenMP (if available), the threads update the tables with atomic adds.
+			The samples of an iteration depend only on the seed and on the number of the iteration.</p>
+			*/
+			class mccfr_engine
+			{
+			public:
+				enum tree_kind
+				{
+					ACTION_TREE = 0,
+					CHANCE_TREE = 1
+				};
+
+				static const int PLAYERS_COUNT = 2;
+				static const int MAX_ACTIONS = 64;
+
+				mccfr_engine() : _thread_count(1), _seed(0), _rounds_count(0), _is_game_ready(false),
+					_iteration_count(0), _table_size(0)
+				{
+				}
+
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				/// Sets the number of threads, default: 1.
+				bool set_thread_count(int thread_count);
+
+				int thread_count() const
+				{
+					return _thread_count;
+				}
+
+				/// Sets the seed of the random numbers. Resets the solution.
+				void set_seed(uint64_t seed)
+				{
+					_seed = seed;
+					_is_game_ready = false;
+				}
+
+				/// Loads a tree from a file written by UFTree.Write(). Resets the solution.
+				bool load_tree(tree_kind kind, const char * file_name);
+
+				/// Copies a tree from memory. node_byte_size must match the layout of the node of this kind.
+				/// Resets the solution.
+				bool set_tree(tree_kind kind, int64_t nodes_count, const uint8_t * depths,
+					const void * nodes, int node_byte_size);
+
+				/// Does iterations_count iterations, each of them samples a deal for each player.
+				bool iterate(int64_t iterations_count);
+
+				/// Number of iterations done since the trees were set.
+				int64_t iteration_count() const
+				{
+					return _iteration_count;
+				}
+
+				/// Number of entries in each of the tables of the regrets and of the average (0 before the first iteration).
+				int64_t table_size() const
+				{
+					return (int64_t)_table_size;
+				}
+
+				/** Writes the average strategy of the position to a strategy tree of the position
+				(created for the action tree and the chance tree of the position, like in br_engine).
+				Sets the absolute probabilities of the nodes of the position, other nodes are not changed.
+				*/
+				bool get_strategy(int position, int64_t nodes_count, const uint8_t * depths, strategy_tree_node * nodes);
+
+			private:
+				/// A node of the action tree.
+				struct node_info
+				{
+					/// Offset of the children in _children.
+					int64_t children_begin;
+					int children_count;
+					int round;
+					/// Round of the children.
+					int child_round;
+					/// Position acting in the children, -1 for a leaf.
+					int actor;
+					/// Offset in _regrets and _average (chance indexes of the actor x actions).
+					std::size_t table_offset;
+					/// Leaves only.
+					bool is_showdown;
+					uint16_t active_players;
+					double pot;
+					double in_pot[PLAYERS_COUNT];
+				};
+
+				/// A deterministic random number generator (SplitMix64).
+				class rng
+				{
+				public:
+					rng(uint64_t seed) : _state(seed)
+					{
+					}
+
+					uint64_t next()
+					{
+						uint64_t z = (_state += 0x9E3779B97F4A7C15ULL);
+						z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+						z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+						return z ^ (z >> 31);
+					}
+
+					/// Uniform in [0, 1).
+					double next_double()
+					{
+						return (next() >> 11) * (1.0 / 9007199254740992.0);
+					}
+				private:
+					uint64_t _state;
+				};
+
+				bool fail(const std::string & error)
+				{
+					_error = error;
+					return false;
+				}
+
+				static int node_byte_size(tree_kind kind);
+
+				uf_tree * get_tree(tree_kind kind);
+
+				/// Indexes the trees and allocates the tables.
+				bool prepare_game();
+
+				/// Number of chance indexes of the player up to the round (1 for round -1).
+				int index_size(int p, int round) const
+				{
+					return round < 0 ? 1 : _index_sizes[p][round];
+				}
+
+				/// Finds the child of the action tree node with the amount of the strategy node.
+				int64_t find_action_child(int64_t action_node, int amount_units) const;
+
+				/// Samples a deal, returns its index.
+				std::size_t sample_deal(rng & r) const;
+
+				/// Walks the game for one deal, returns the sampled counterfactual value of the hero.
+				double traverse(int hero, int64_t node, std::size_t deal, rng & r);
+
+				void add(std::atomic<float> & entry, double value)
+				{
+					float old = entry.load(std::memory_order_relaxed);
+					if(_thread_count == 1)
+					{
+						entry.store(old + (float)value, std::memory_order_relaxed);
+						return;
+					}
+					while(!entry.compare_exchange_weak(old, old + (float)value, std::memory_order_relaxed))
+					{
+					}
+				}
+
+				int _thread_count;
+				uint64_t _seed;
+				std::string _error;
+
+				uf_tree _action_tree;
+				uf_tree _chance_tree;
+
+				int _rounds_count;
+				bool _is_game_ready;
+				int64_t _iteration_count;
+				/// _index_sizes[p][r]: number of chance indexes of player p in round r.
+				std::vector<std::vector<int> > _index_sizes;
+				std::vector<node_info> _nodes;
+				std::vector<int64_t> _children;
+				/// The leaves of the chance tree: cumulative probabilities, pot shares of position 0 and
+				/// the chance indexes of the players, _deal_indexes[(deal * PLAYERS_COUNT + p) * _rounds_count + r].
+				std::vector<double> _deal_cdf;
+				std::vector<double> _deal_pot_share0;
+				std::vector<int> _deal_indexes;
+				std::size_t _table_size;
+				std::unique_ptr<std::atomic<float>[]> _regrets;
+				std::unique_ptr<std::atomic<float>[]> _average;
+			};
+
+		}
+	}
+}
+
+#endif
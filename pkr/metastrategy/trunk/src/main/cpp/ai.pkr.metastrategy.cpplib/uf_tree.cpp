@@ -0,0 +1,85 @@
+#include <cstring>
+#include <sstream>
+#include <ai.lib.utils.cpp/bds_version.h>
+#include "uf_tree.h"
+
+using namespace ai::lib::utils;
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metastrategy
+		{
+
+			const double strategy_tree_node::AMOUNT_FACTOR = 0.00001;
+
+			bool uf_tree::read(const char * file_name, int node_byte_size)
+			{
+				clear();
+				if(!_file.open(file_name, mapped_file::advice_sequential))
+				{
+					return fail(_file.error());
+				}
+				const char * data = _file.data();
+				std::size_t size = _file.size();
+				bds_version version;
+				std::size_t pos = version.read(data, size);
+				if(pos == 0)
+				{
+					return fail(std::string("wrong version in ") + file_name);
+				}
+
+				// Format version, byte size of the nodes, number of nodes.
+				const std::size_t HEADER_SIZE = 4 + 8 + 8;
+				if(pos + HEADER_SIZE > size)
+				{
+					return fail(std::string("cannot read header of ") + file_name);
+				}
+				int32_t formatVersion;
+				int64_t nodesByteSize, nodesCount;
+				memcpy(&formatVersion, data + pos, 4);
+				memcpy(&nodesByteSize, data + pos + 4, 8);
+				memcpy(&nodesCount, data + pos + 12, 8);
+				pos += HEADER_SIZE;
+				if(formatVersion != 1)
+				{
+					return fail(std::string("unsupported tree format in ") + file_name);
+				}
+				if(nodesCount <= 0 || nodesByteSize != nodesCount * node_byte_size)
+				{
+					std::ostringstream os;
+					os << "wrong node size in " << file_name << ", expected " << node_byte_size;
+					return fail(os.str());
+				}
+				if((uint64_t)(size - pos) < (uint64_t)(nodesCount + nodesByteSize))
+				{
+					return fail(std::string("unexpected end of ") + file_name);
+				}
+				_nodes_count = nodesCount;
+				_node_byte_size = node_byte_size;
+				_depths = (const uint8_t *)data + pos;
+				_nodes = _depths + nodesCount;
+				return true;
+			}
+
+			bool uf_tree::set(int64_t nodes_count, const uint8_t * depths, const void * nodes, int node_byte_size)
+			{
+				clear();
+				if(nodes_count <= 0)
+				{
+					return fail("a tree must not be empty");
+				}
+				_storage.resize((std::size_t)(nodes_count * (1 + node_byte_size)));
+				memcpy(&_storage[0], depths, (std::size_t)nodes_count);
+				memcpy(&_storage[(std::size_t)nodes_count], nodes, (std::size_t)(nodes_count * node_byte_size));
+				_nodes_count = nodes_count;
+				_node_byte_size = node_byte_size;
+				_depths = &_storage[0];
+				_nodes = _depths + nodes_count;
+				return true;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,145 @@
+#ifndef AI_PKR_METASTRATEGY_CPPLIB_UF_TREE_H
+#define AI_PKR_METASTRATEGY_CPPLIB_UF_TREE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <ai.lib.utils.cpp/mapped_file.h>
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metastrategy
+		{
+
+#pragma pack(push, 1)
+
+			/// Node of ActionTree, the same layout as ActionTreeNode (C#).
+			struct action_tree_node
+			{
+				double amount;
+				uint16_t active_players;
+				int8_t position;
+				int8_t round;
+			};
+
+			/// Node of ChanceTree, the same layout as ChanceTreeNode (C#).
+			struct chance_tree_node
+			{
+				/// Absolute probability of the cards dealt so far.
+				double probab;
+				/// Pot share of position 0 if more than one player is active.
+				double pot_share0;
+				uint8_t card;
+				int8_t position;
+			};
+
+			/// Node of StrategyTree, the same layout as StrategyTreeNode (C#).
+			struct strategy_tree_node
+			{
+				/// Bit 0: dealer action, bits 1..3: position,
+				/// bits 4..31: card for the dealer, amount / AMOUNT_FACTOR for a player.
+				uint32_t id;
+				double probab;
+
+				bool is_dealer_action() const
+				{
+					return (id & 1) != 0;
+				}
+
+				int position() const
+				{
+					return (int)((id & 0xE) >> 1);
+				}
+
+				int card() const
+				{
+					return (int)(id >> 4);
+				}
+
+				/// Amount in units of AMOUNT_FACTOR.
+				int amount_units() const
+				{
+					return (int)(id >> 4);
+				}
+
+				static const double AMOUNT_FACTOR;
+			};
+
+#pragma pack(pop)
+
+			/** A tree stored in preorder: an array of depths and an array of nodes (UFTree in C#).
+			read() maps a file written by UFTree.Write() (the data is used in place, like UFTree.ReadMapped()),
+			set() copies a tree from memory.
+			*/
+			class uf_tree
+			{
+			public:
+				uf_tree() : _nodes_count(0), _node_byte_size(0), _depths(0), _nodes(0)
+				{
+				}
+
+				/** Maps a tree file: BdsVersion, format version, byte size of the nodes,
+				number of nodes, depths, nodes. The node byte size must be node_byte_size.
+				@return false on error, see error().
+				*/
+				bool read(const char * file_name, int node_byte_size);
+
+				/// Copies a tree from memory.
+				bool set(int64_t nodes_count, const uint8_t * depths, const void * nodes, int node_byte_size);
+
+				void clear()
+				{
+					_nodes_count = 0;
+					_depths = 0;
+					_nodes = 0;
+					_storage.clear();
+					_file.close();
+				}
+
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				int64_t nodes_count() const
+				{
+					return _nodes_count;
+				}
+
+				int depth(int64_t i) const
+				{
+					return _depths[i];
+				}
+
+				template<class NodeT> const NodeT & node(int64_t i) const
+				{
+					return reinterpret_cast<const NodeT *>(_nodes)[i];
+				}
+
+			private:
+				bool fail(const std::string & error)
+				{
+					_error = error;
+					clear();
+					return false;
+				}
+
+				int64_t _nodes_count;
+				int _node_byte_size;
+				const uint8_t * _depths;
+				const uint8_t * _nodes;
+				/// Data of a tree copied by set().
+				std::vector<uint8_t> _storage;
+				/// Data of a tree read by read().
+				ai::lib::utils::mapped_file _file;
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
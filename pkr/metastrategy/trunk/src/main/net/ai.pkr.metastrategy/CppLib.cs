@@ -0,0 +1,253 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+using ai.lib.utils;
+using System.Reflection;
+using System.IO;
+
+namespace ai.pkr.metastrategy
+{
+    /// <summary>
+    /// Wrapper for the native library ai.pkr.metastrategy.cpplib.
+    /// </summary>
+    public unsafe class CppLib
+    {
+        #region BrEngine
+
+        /// <summary>
+        /// Tree kinds for BrEngine_LoadTree() and BrEngine_SetTree().
+        /// </summary>
+        public const int BrEngineActionTree = 0;
+        public const int BrEngineChanceTree = 1;
+        public const int BrEngineStrategyTree = 2;
+
+        /// <summary>
+        /// Creates a best response engine calculating with threadsCount threads.
+        /// Returns a handle or IntPtr.Zero on error (see BrEngine_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern IntPtr BrEngine_Open(int threadsCount);
+
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern void BrEngine_Close(IntPtr e);
+
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern IntPtr BrEngine_GetLastError();
+
+        /// <summary>
+        /// Loads a tree written by UFTree.Write(). Position is the position of a strategy tree, 
+        /// it is ignored for other kinds. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int BrEngine_LoadTree(IntPtr e, int kind, int position, string fileName);
+
+        /// <summary>
+        /// Copies a tree from memory: nodesCount depths and nodes of nodeByteSize bytes 
+        /// (ActionTreeNode, ChanceTreeNode or StrategyTreeNode). Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int BrEngine_SetTree(IntPtr e, int kind, int position, Int64 nodesCount,
+            byte* depths, void* nodes, int nodeByteSize);
+
+        /// <summary>
+        /// Calculates the game value of the best response of the hero against the strategies 
+        /// of the other positions. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int BrEngine_Solve(IntPtr e, int heroPosition, double* value);
+
+        /// <summary>
+        /// Throws an exception with the last error of BrEngine.
+        /// </summary>
+        public static void BrEngine_ThrowLastError()
+        {
+            throw new ApplicationException(Marshal.PtrToStringAnsi(BrEngine_GetLastError()));
+        }
+
+        #endregion
+
+        #region CfrEngine
+
+        /// <summary>
+        /// Tree kinds for CfrEngine_LoadTree() and CfrEngine_SetTree().
+        /// </summary>
+        public const int CfrEngineActionTree = 0;
+        public const int CfrEngineChanceTree = 1;
+
+        /// <summary>
+        /// Creates a CFR+ solver for heads-up games calculating with threadsCount threads.
+        /// Returns a handle or IntPtr.Zero on error (see CfrEngine_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern IntPtr CfrEngine_Open(int threadsCount);
+
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern void CfrEngine_Close(IntPtr e);
+
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern IntPtr CfrEngine_GetLastError();
+
+        /// <summary>
+        /// Loads a tree written by UFTree.Write(). Resets the solution. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int CfrEngine_LoadTree(IntPtr e, int kind, string fileName);
+
+        /// <summary>
+        /// Copies a tree from memory (ActionTreeNode or ChanceTreeNode). Resets the solution. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int CfrEngine_SetTree(IntPtr e, int kind, Int64 nodesCount,
+            byte* depths, void* nodes, int nodeByteSize);
+
+        /// <summary>
+        /// Does iterationsCount iterations. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int CfrEngine_Iterate(IntPtr e, int iterationsCount);
+
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int CfrEngine_GetIterationCount(IntPtr e);
+
+        /// <summary>
+        /// Calculates the values of the best responses of both positions against the average strategy
+        /// (values[0], values[1]). Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int CfrEngine_GetBestResponseValues(IntPtr e, double* values);
+
+        /// <summary>
+        /// Sets the absolute probabilities of the nodes of the position in its strategy tree
+        /// to the average strategy. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int CfrEngine_GetStrategy(IntPtr e, int position, Int64 nodesCount,
+            byte* depths, void* nodes, int nodeByteSize);
+
+        /// <summary>
+        /// Throws an exception with the last error of CfrEngine.
+        /// </summary>
+        public static void CfrEngine_ThrowLastError()
+        {
+            throw new ApplicationException(Marshal.PtrToStringAnsi(CfrEngine_GetLastError()));
+        }
+
+        #endregion
+
+        #region McCfrEngine
+
+        /// <summary>
+        /// Tree kinds for McCfrEngine_LoadTree() and McCfrEngine_SetTree().
+        /// </summary>
+        public const int McCfrEngineActionTree = 0;
+        public const int McCfrEngineChanceTree = 1;
+
+        /// <summary>
+        /// Creates a Monte-Carlo CFR solver for heads-up games calculating with threadsCount threads.
+        /// Returns a handle or IntPtr.Zero on error (see McCfrEngine_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern IntPtr McCfrEngine_Open(int threadsCount, UInt64 seed);
+
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern void McCfrEngine_Close(IntPtr e);
+
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern IntPtr McCfrEngine_GetLastError();
+
+        /// <summary>
+        /// Loads a tree written by UFTree.Write(). Resets the solution. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int McCfrEngine_LoadTree(IntPtr e, int kind, string fileName);
+
+        /// <summary>
+        /// Copies a tree from memory (ActionTreeNode or ChanceTreeNode). Resets the solution. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int McCfrEngine_SetTree(IntPtr e, int kind, Int64 nodesCount,
+            byte* depths, void* nodes, int nodeByteSize);
+
+        /// <summary>
+        /// Does iterationsCount iterations. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int McCfrEngine_Iterate(IntPtr e, Int64 iterationsCount);
+
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern Int64 McCfrEngine_GetIterationCount(IntPtr e);
+
+        /// <summary>
+        /// Number of entries in each of the tables of the regrets and of the average (floats).
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern Int64 McCfrEngine_GetTableSize(IntPtr e);
+
+        /// <summary>
+        /// Sets the absolute probabilities of the nodes of the position in its strategy tree
+        /// to the average strategy. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metastrategy.cpplib.dll")]
+        public static extern int McCfrEngine_GetStrategy(IntPtr e, int position, Int64 nodesCount,
+            byte* depths, void* nodes, int nodeByteSize);
+
+        /// <summary>
+        /// Throws an exception with the last error of McCfrEngine.
+        /// </summary>
+        public static void McCfrEngine_ThrowLastError()
+        {
+            throw new ApplicationException(Marshal.PtrToStringAnsi(McCfrEngine_GetLastError()));
+        }
+
+        #endregion
+
+        [DllImport("libdl.so.2")]
+        static extern IntPtr dlopen(string fileName, int flags);
+
+        public static void Init()
+        {
+            bool isUnix = Environment.OSVersion.Platform == PlatformID.Unix;
+            string platform = isUnix ? (System.IntPtr.Size == 8 ? "linux64" : "linux32")
+                : (System.IntPtr.Size == 8 ? "win64" : "win32");
+            string codeBase = CodeBase.Get(Assembly.GetExecutingAssembly());
+            string dllDir = Path.Combine(Path.GetDirectoryName(codeBase), platform);
+
+            string dllName = isUnix ? "libai.pkr.metastrategy.cpplib.so" : "ai.pkr.metastrategy.cpplib.dll";
+
+            string dllPath = Path.Combine(dllDir, dllName);
+
+            if (!System.IO.File.Exists(dllPath))
+            {
+                // In case we are in development folder (debug or release) try to load from bin.   
+                dllDir = Props.Global.Expand("${bds.BinDir}") + platform;
+                dllPath = Path.Combine(dllDir, dllName);
+                if (!System.IO.File.Exists(dllPath))
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+            }
+            if (isUnix)
+            {
+                // Load by full path, the DllImports are then resolved by the soname 
+                // (see the dllmap in ai.pkr.metastrategy.dll.config).
+                const int RTLD_NOW = 2, RTLD_GLOBAL = 0x100;
+                if (dlopen(dllPath, RTLD_NOW | RTLD_GLOBAL) == IntPtr.Zero)
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+                return;
+            }
+            string envPath = Environment.GetEnvironmentVariable("PATH");
+            string envPathL = envPath.ToLower() + ";";
+            if (envPathL.IndexOf(dllDir.ToLower() + ";") < 0)
+            {
+                Environment.SetEnvironmentVariable("PATH", dllDir + ";" + envPath, EnvironmentVariableTarget.Process);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -68,6 +68,7 @@ namespace ai.pkr.metastrategy.algorithms
         {
             Output = Console.Out;
             IsAbsolute = true;
+            ThreadsCount = 1;
         }
 
         public StrategyTree StrategyTree
@@ -98,6 +99,16 @@ namespace ai.pkr.metastrategy.algorithms
             get;
         }
 
+        /// <summary>
+        /// Number of threads to walk the strategy tree.
+        /// Default: 1.
+        /// </summary>
+        public int ThreadsCount
+        {
+            set;
+            get;
+        }
+
         /// <summary>
         /// Writes informational messages to this writer, default: Console.Out.
         /// </summary>
@@ -159,11 +170,16 @@ namespace ai.pkr.metastrategy.algorithms
                 MovesCount = 0;
                 ZaspMovesCount = 0;
 
-                var walkTree = new WalkUFTreePP<StrategyTree, AnalyzeContext>();
-
-                walkTree.OnNodeBegin = OnNodeBegin;
-                walkTree.OnNodeEnd = OnNodeEnd;
-                walkTree.Walk(StrategyTree);
+                using (var walkTree = new WalkUFTreePPParallel<StrategyTree, AnalyzeContext>())
+                {
+                    walkTree.ThreadsCount = Math.Max(1, ThreadsCount);
+                    _workers = new WorkerData[walkTree.ThreadsCount].Fill(i => new WorkerData());
+                    walkTree.OnNodeBegin = OnNodeBegin;
+                    walkTree.OnNodeEnd = OnNodeEnd;
+                    walkTree.OnReduce = OnReduce;
+                    walkTree.Walk(StrategyTree);
+                    _workers = null;
+                }
 
                 if (IsVerbose)
                 {
@@ -218,8 +234,34 @@ namespace ai.pkr.metastrategy.algorithms
             public bool IsHeroActingWithNonZeroProbab;
         }
 
+        /// <summary>
+        /// Results accumulated by a worker thread.
+        /// </summary>
+        private class WorkerData
+        {
+            public int MovesCount;
+            public int LeavesCount;
+            public UInt32 ZaspMovesCount;
+            public UInt32 ZaspLeavesCount;
+            public List<Stats> Stats = new List<Stats>();
+
+            /// <summary>
+            /// Returns the stats of the round, adds the missing rounds (a worker may start in a later round
+            /// and the calling thread ends the upper nodes whose children were processed by other workers).
+            /// </summary>
+            public Stats GetStats(int round)
+            {
+                while (Stats.Count <= round)
+                {
+                    Stats.Add(new Stats());
+                }
+                return Stats[round];
+            }
+        }
+
         private void OnNodeBegin(StrategyTree tree, AnalyzeContext[] stack, int depth)
         {
+            WorkerData wd = _workers[WalkUFTreePPParallel<StrategyTree, AnalyzeContext>.CurrentWorker];
             AnalyzeContext context = stack[depth];
             Int64 n = context.NodeIdx;
             if (depth == 0)
@@ -246,7 +288,7 @@ namespace ai.pkr.metastrategy.algorithms
             {
                 if (tree.Nodes[n].Probab == 0)
                 {
-                    ZaspMovesCount++;
+                    wd.ZaspMovesCount++;
                 }
                 if (IsAbsolute)
                 {
@@ -256,54 +298,73 @@ namespace ai.pkr.metastrategy.algorithms
                 {
                     context.AbsStrProbab *= tree.Nodes[n].Probab;
                 }
-                if (_stats.Count <= context.Round)
-                {
-                    _stats.Add(new Stats());
-                }
+                Stats stats = wd.GetStats(context.Round);
                 if (stack[depth - 1].AbsStrProbab > 0)
                 {
                     stack[depth - 1].IsHeroActingWithNonZeroProbab = true;
                     double condStrProbab = context.AbsStrProbab/stack[depth - 1].AbsStrProbab;
                     if (context.State.HasStrictMaxInPot(HeroPosition))
                     {
-                        _stats[context.Round].SumNZaspRaise += condStrProbab;
+                        stats.SumNZaspRaise += condStrProbab;
                     }
                     else if (tree.Nodes[n].Amount > 0 || context.State.HasMaxOrEqualInPot(HeroPosition))
                     {
-                        _stats[context.Round].SumNZaspCall += condStrProbab;
+                        stats.SumNZaspCall += condStrProbab;
                     }
                     else
                     {
-                        _stats[context.Round].SumNZaspFold += condStrProbab;
+                        stats.SumNZaspFold += condStrProbab;
                     }
                 }
-                MovesCount++;
+                wd.MovesCount++;
             }
         }
 
         private void OnNodeEnd(StrategyTree tree, AnalyzeContext[] stack, int depth)
         {
+            WorkerData wd = _workers[WalkUFTreePPParallel<StrategyTree, AnalyzeContext>.CurrentWorker];
             AnalyzeContext context = stack[depth];
             Int64 n = context.NodeIdx;
             if (context.ChildrenCount == 0)
             {
-                LeavesCount++;
+                wd.LeavesCount++;
                 if (tree.Nodes[n].IsPlayerAction(HeroPosition))
                 {
                     if (tree.Nodes[n].Probab == 0)
                     {
-                        ZaspLeavesCount++;
+                        wd.ZaspLeavesCount++;
                     }
                 }
             }
             if (context.IsHeroActingWithNonZeroProbab)
             {
-                _stats[context.Round].NZaspMovesCount++;
+                wd.GetStats(context.Round).NZaspMovesCount++;
+            }
+        }
+
+        private void OnReduce(StrategyTree tree, int worker)
+        {
+            WorkerData wd = _workers[worker];
+            MovesCount += wd.MovesCount;
+            LeavesCount += wd.LeavesCount;
+            ZaspMovesCount += wd.ZaspMovesCount;
+            ZaspLeavesCount += wd.ZaspLeavesCount;
+            for (int r = 0; r < wd.Stats.Count; ++r)
+            {
+                if (_stats.Count <= r)
+                {
+                    _stats.Add(new Stats());
+                }
+                _stats[r].SumNZaspFold += wd.Stats[r].SumNZaspFold;
+                _stats[r].SumNZaspCall += wd.Stats[r].SumNZaspCall;
+                _stats[r].SumNZaspRaise += wd.Stats[r].SumNZaspRaise;
+                _stats[r].NZaspMovesCount += wd.Stats[r].NZaspMovesCount;
             }
         }
 
         int _playersCount;
         List<Stats> _stats = new List<Stats>();
+        WorkerData[] _workers;
 
         #endregion
     }
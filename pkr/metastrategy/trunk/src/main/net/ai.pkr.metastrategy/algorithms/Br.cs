@@ -185,6 +185,17 @@ namespace ai.pkr.metastrategy.algorithms
             get;
         }
 
+        /// <summary>
+        /// Number of threads to prepare the strategic probabilities of the opponents
+        /// and to calculate the node values of the hero strategy tree.
+        /// Default: 1.
+        /// </summary>
+        public int ThreadsCount
+        {
+            set { _threadsCount = value; }
+            get { return _threadsCount; }
+        }
+
         public void Solve()
         {
             CheckPreconditions();
@@ -314,15 +325,20 @@ namespace ai.pkr.metastrategy.algorithms
             }
 
             // Fill strategic probability for each player except the hero.
-            for (_curPlayer = 0; _curPlayer < _playersCount; ++_curPlayer)
+            // Each strategy leaf sets its own element of _strategicProbabs, therefore the trees
+            // can be walked in parallel.
+            using (WalkUFTreePPParallel<StrategyTree, PrepareStrategicProbabsContext> wt = new WalkUFTreePPParallel<StrategyTree, PrepareStrategicProbabsContext>())
             {
-                if (_curPlayer == HeroPosition)
+                wt.ThreadsCount = ThreadsCount;
+                wt.OnNodeBegin = PrepareStrategicProbabs_OnNodeBegin;
+                for (_curPlayer = 0; _curPlayer < _playersCount; ++_curPlayer)
                 {
-                    continue;
+                    if (_curPlayer == HeroPosition)
+                    {
+                        continue;
+                    }
+                    wt.Walk(Strategies[_curPlayer]);
                 }
-                WalkUFTreePP<StrategyTree, PrepareStrategicProbabsContext> wt = new WalkUFTreePP<StrategyTree, PrepareStrategicProbabsContext>();
-                wt.OnNodeBegin = PrepareStrategicProbabs_OnNodeBegin;
-                wt.Walk(Strategies[_curPlayer]);
             }
 
             _chanceTreeNodes = new int[_roundsCount][][];
@@ -461,10 +477,15 @@ namespace ai.pkr.metastrategy.algorithms
         private void Calculate()
         {
 
-            WalkUFTreePP<StrategyTree, CalculateValuesContext> wt = new WalkUFTreePP<StrategyTree, CalculateValuesContext>();
-            wt.OnNodeBegin = CalculateValues_OnNodeBegin;
-            wt.OnNodeEnd = CalculateValues_OnNodeEnd;
-            wt.Walk(Strategies[HeroPosition]);
+            // The callbacks modify only the current and the parent node, therefore the values
+            // can be calculated in parallel.
+            using (WalkUFTreePPParallel<StrategyTree, CalculateValuesContext> wt = new WalkUFTreePPParallel<StrategyTree, CalculateValuesContext>())
+            {
+                wt.ThreadsCount = ThreadsCount;
+                wt.OnNodeBegin = CalculateValues_OnNodeBegin;
+                wt.OnNodeEnd = CalculateValues_OnNodeEnd;
+                wt.Walk(Strategies[HeroPosition]);
+            }
 
             Value = Strategies[HeroPosition].Nodes[0].Probab;
 
@@ -671,6 +692,7 @@ namespace ai.pkr.metastrategy.algorithms
 
         int _playersCount;
         int _curPlayer;
+        int _threadsCount = 1;
         /// <summary>
         /// Children index of the action tree.
         /// </summary>
@@ -0,0 +1,192 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+using ai.lib.algorithms.tree;
+
+namespace ai.pkr.metastrategy.algorithms
+{
+    /// <summary>
+    /// Calculates the game value of the best response with the native engine (ai.pkr.metastrategy.cpplib).
+    /// Input: action and chance trees of the game, hero position, absolute strategy trees of the opponents,
+    /// the same as for Br. Output: the game value of the hero (the best response strategy itself is not calculated, 
+    /// use Br for it).
+    /// <para>The engine calculates the reach of each opponent once per leaf of the action tree 
+    /// and evaluates the leaves by the chance tree converted into dense matrices, see br_engine.h.
+    /// The trees are copied to the engine on the first call of Solve() and when a property is set to another tree,
+    /// the data of the opponents is reused for other hero positions. The trees must not be modified in between.</para>
+    /// <para>The trees must be in memory or memory-mapped (FDA is not supported).</para>
+    /// </summary>
+    public unsafe class BrNative : IDisposable
+    {
+        #region Public API
+
+        public BrNative()
+        {
+            ThreadsCount = 1;
+        }
+
+        public ActionTree ActionTree
+        {
+            set;
+            get;
+        }
+
+        public ChanceTree ChanceTree
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Strategy trees of the opponents. Strategy tree of the hero is ignored.
+        /// </summary>
+        public StrategyTree[] Strategies
+        {
+            set;
+            get;
+        }
+
+        public int HeroPosition
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Number of threads. Is applied on the first call of Solve().
+        /// Default: 1.
+        /// </summary>
+        public int ThreadsCount
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Game value of the hero.
+        /// </summary> 
+        public double Value
+        {
+            get;
+            protected set;
+        }
+
+        public void Solve()
+        {
+            CheckPreconditions();
+            if (_engine == IntPtr.Zero)
+            {
+                CppLib.Init();
+                _engine = CppLib.BrEngine_Open(ThreadsCount);
+                if (_engine == IntPtr.Zero)
+                {
+                    CppLib.BrEngine_ThrowLastError();
+                }
+            }
+            if (!ReferenceEquals(_actionTree, ActionTree))
+            {
+                SetTree(CppLib.BrEngineActionTree, 0, ActionTree, ActionTree.Nodes, sizeof(ActionTreeNode));
+                _actionTree = ActionTree;
+            }
+            if (!ReferenceEquals(_chanceTree, ChanceTree))
+            {
+                SetTree(CppLib.BrEngineChanceTree, 0, ChanceTree, ChanceTree.Nodes, sizeof(ChanceTreeNode));
+                _chanceTree = ChanceTree;
+            }
+            for (int p = 0; p < Strategies.Length; ++p)
+            {
+                if (p == HeroPosition || ReferenceEquals(_strategies[p], Strategies[p]))
+                {
+                    continue;
+                }
+                SetTree(CppLib.BrEngineStrategyTree, p, Strategies[p], Strategies[p].Nodes, sizeof(StrategyTreeNode));
+                _strategies[p] = Strategies[p];
+            }
+            double value;
+            if (CppLib.BrEngine_Solve(_engine, HeroPosition, &value) == 0)
+            {
+                CppLib.BrEngine_ThrowLastError();
+            }
+            Value = value;
+        }
+
+        public void Dispose()
+        {
+            if (_engine != IntPtr.Zero)
+            {
+                CppLib.BrEngine_Close(_engine);
+                _engine = IntPtr.Zero;
+            }
+            _actionTree = null;
+            _chanceTree = null;
+            Array.Clear(_strategies, 0, _strategies.Length);
+        }
+
+        #endregion
+
+        #region Implementation
+
+        private void CheckPreconditions()
+        {
+            if (ActionTree == null || ChanceTree == null || Strategies == null)
+            {
+                throw new ArgumentException("Input trees must not be null.");
+            }
+            if (ActionTree.PlayersCount != ChanceTree.PlayersCount || ActionTree.PlayersCount != Strategies.Length)
+            {
+                throw new ArgumentException("Inconsistent number of players in the input trees.");
+            }
+            if (HeroPosition < 0 || HeroPosition >= ActionTree.PlayersCount)
+            {
+                throw new ArgumentException("Hero position is out of range.");
+            }
+            for (int p = 0; p < Strategies.Length; ++p)
+            {
+                if (Strategies[p] == null && p != HeroPosition)
+                {
+                    throw new ArgumentException("Input trees must not be null.");
+                }
+            }
+            if (Strategies.Length > _strategies.Length)
+            {
+                throw new ArgumentException("Too many players.");
+            }
+        }
+
+        private void SetTree(int kind, int position, UFTree tree, void* nodes, int nodeByteSize)
+        {
+            if (tree.IsFDA)
+            {
+                throw new ArgumentException("FDA trees are not supported.");
+            }
+            byte[] depths = new byte[tree.NodesCount];
+            for (Int64 i = 0; i < tree.NodesCount; ++i)
+            {
+                depths[i] = tree.GetDepth(i);
+            }
+            fixed (byte* pDepths = depths)
+            {
+                if (CppLib.BrEngine_SetTree(_engine, kind, position, tree.NodesCount, pDepths, nodes, nodeByteSize) == 0)
+                {
+                    CppLib.BrEngine_ThrowLastError();
+                }
+            }
+        }
+
+        IntPtr _engine = IntPtr.Zero;
+
+        /// <summary>
+        /// Trees copied to the engine.
+        /// </summary>
+        ActionTree _actionTree;
+        ChanceTree _chanceTree;
+        StrategyTree[] _strategies = new StrategyTree[8];
+
+        #endregion
+    }
+}
\ No newline at end of file
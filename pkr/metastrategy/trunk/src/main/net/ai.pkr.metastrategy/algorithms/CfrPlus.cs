@@ -0,0 +1,236 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using ai.lib.algorithms.tree;
+
+namespace ai.pkr.metastrategy.algorithms
+{
+    /// <summary>
+    /// Finds an equilibrium in a heads-up game with CFR+ in the native engine (ai.pkr.metastrategy.cpplib).
+    /// Input: action and chance trees of the game (players may use different abstractions, as for EqLp).
+    /// Output: absolute strategy trees of both positions (the average strategy of CFR+) and their exploitability.
+    /// <para>The regrets and the average strategy are stored in vector form for each node of the action tree
+    /// and chance index of the acting player, the leaves are evaluated by the chance tree converted into 
+    /// dense matrices, like in BrNative, see cfr_engine.h. The iterations stop when the exploitability,
+    /// checked each EpsilonCheckPeriod iterations, reaches Epsilon, or after MaxIterationCount iterations.</para>
+    /// <para>The trees must be in memory or memory-mapped (FDA is not supported).</para>
+    /// </summary>
+    public unsafe class CfrPlus : IDisposable
+    {
+        #region Public API
+
+        public CfrPlus()
+        {
+            ThreadsCount = 1;
+            Epsilon = 0.001;
+            MaxIterationCount = int.MaxValue;
+            EpsilonCheckPeriod = 100;
+        }
+
+        public ActionTree ActionTree
+        {
+            set;
+            get;
+        }
+
+        public ChanceTree ChanceTree
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Number of threads. Default: 1.
+        /// </summary>
+        public int ThreadsCount
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Target exploitability (the sum of the values of the best responses of both positions).
+        /// Default: 0.001.
+        /// </summary>
+        public double Epsilon
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Maximal number of iterations. Default: int.MaxValue.
+        /// </summary>
+        public int MaxIterationCount
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Number of iterations between the calculations of the exploitability. Default: 100.
+        /// </summary>
+        public int EpsilonCheckPeriod
+        {
+            set;
+            get;
+        }
+
+        public bool IsVerbose
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Exploitability of the average strategy after the last check.
+        /// </summary>
+        public double CurrentEpsilon
+        {
+            get;
+            protected set;
+        }
+
+        public int IterationCount
+        {
+            get;
+            protected set;
+        }
+
+        /// <summary>
+        /// Absolute strategy trees of the positions.
+        /// </summary>
+        public StrategyTree[] Strategies
+        {
+            get;
+            protected set;
+        }
+
+        public void Solve()
+        {
+            CheckPreconditions();
+            CppLib.Init();
+            Dispose();
+            _engine = CppLib.CfrEngine_Open(ThreadsCount);
+            if (_engine == IntPtr.Zero)
+            {
+                CppLib.CfrEngine_ThrowLastError();
+            }
+            SetTree(CppLib.CfrEngineActionTree, ActionTree, ActionTree.Nodes, sizeof(ActionTreeNode));
+            SetTree(CppLib.CfrEngineChanceTree, ChanceTree, ChanceTree.Nodes, sizeof(ChanceTreeNode));
+
+            IterationCount = 0;
+            DateTime startTime = DateTime.Now;
+            for (; ; )
+            {
+                int count = Math.Min(EpsilonCheckPeriod, MaxIterationCount - IterationCount);
+                if (CppLib.CfrEngine_Iterate(_engine, count) == 0)
+                {
+                    CppLib.CfrEngine_ThrowLastError();
+                }
+                IterationCount += count;
+                double* values = stackalloc double[2];
+                if (CppLib.CfrEngine_GetBestResponseValues(_engine, values) == 0)
+                {
+                    CppLib.CfrEngine_ThrowLastError();
+                }
+                CurrentEpsilon = values[0] + values[1];
+                if (IsVerbose)
+                {
+                    Console.WriteLine("{0} it: {1}, eps: {2:0.000000}, br values: {3:0.000000} {4:0.000000}",
+                        DateTime.Now - startTime, IterationCount, CurrentEpsilon, values[0], values[1]);
+                }
+                if (CurrentEpsilon <= Epsilon || IterationCount >= MaxIterationCount)
+                {
+                    break;
+                }
+            }
+            CreateStrategies();
+        }
+
+        public void Dispose()
+        {
+            if (_engine != IntPtr.Zero)
+            {
+                CppLib.CfrEngine_Close(_engine);
+                _engine = IntPtr.Zero;
+            }
+        }
+
+        #endregion
+
+        #region Implementation
+
+        private void CheckPreconditions()
+        {
+            if (ActionTree == null || ChanceTree == null)
+            {
+                throw new ArgumentException("Input trees must not be null.");
+            }
+            if (ActionTree.PlayersCount != 2 || ChanceTree.PlayersCount != 2)
+            {
+                throw new ArgumentException("Only heads-up games are supported.");
+            }
+            if (ThreadsCount < 1 || EpsilonCheckPeriod < 1 || MaxIterationCount < 1)
+            {
+                throw new ArgumentException("ThreadsCount, EpsilonCheckPeriod and MaxIterationCount must be positive.");
+            }
+        }
+
+        private static byte[] GetDepths(UFTree tree)
+        {
+            if (tree.IsFDA)
+            {
+                throw new ArgumentException("FDA trees are not supported.");
+            }
+            byte[] depths = new byte[tree.NodesCount];
+            for (Int64 i = 0; i < tree.NodesCount; ++i)
+            {
+                depths[i] = tree.GetDepth(i);
+            }
+            return depths;
+        }
+
+        private void SetTree(int kind, UFTree tree, void* nodes, int nodeByteSize)
+        {
+            byte[] depths = GetDepths(tree);
+            fixed (byte* pDepths = depths)
+            {
+                if (CppLib.CfrEngine_SetTree(_engine, kind, tree.NodesCount, pDepths, nodes, nodeByteSize) == 0)
+                {
+                    CppLib.CfrEngine_ThrowLastError();
+                }
+            }
+        }
+
+        /// <summary>
+        /// Creates the strategy trees of the positions and lets the engine set the probabilities.
+        /// </summary>
+        private void CreateStrategies()
+        {
+            Strategies = new StrategyTree[2];
+            for (int p = 0; p < 2; ++p)
+            {
+                ChanceTree pct = ExtractPlayerChanceTree.ExtractS(ChanceTree, p);
+                StrategyTree st = CreateStrategyTreeByChanceAndActionTrees.CreateS(pct, ActionTree);
+                byte[] depths = GetDepths(st);
+                fixed (byte* pDepths = depths)
+                {
+                    if (CppLib.CfrEngine_GetStrategy(_engine, p, st.NodesCount, pDepths, st.Nodes, sizeof(StrategyTreeNode)) == 0)
+                    {
+                        CppLib.CfrEngine_ThrowLastError();
+                    }
+                }
+                Strategies[p] = st;
+            }
+        }
+
+        IntPtr _engine = IntPtr.Zero;
+
+        #endregion
+    }
+}
\ No newline at end of file
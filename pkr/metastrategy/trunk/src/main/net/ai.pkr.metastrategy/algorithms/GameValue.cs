@@ -193,6 +193,16 @@ namespace ai.pkr.metastrategy.algorithms
             get;
         }
 
+        /// <summary>
+        /// Number of threads to walk the chance tree. If PrepareVis is true, 1 thread is used.
+        /// Default: 1.
+        /// </summary>
+        public int ThreadsCount
+        {
+            set { _threadsCount = value; }
+            get { return _threadsCount; }
+        }
+
         public void Solve()
         {
             CheckPreconditions();
@@ -380,10 +390,22 @@ namespace ai.pkr.metastrategy.algorithms
 
         private void Calculate()
         {
+            // Visualization values of different chance nodes may go to the same array element,
+            // this requires a sequential walk.
+            int threadsCount = PrepareVis ? 1 : Math.Max(1, ThreadsCount);
+            _workerGameValues = new double[threadsCount][].Fill(i => new double[_playersCount]);
+            using (_chanceWalker = new WalkUFTreePPParallel<ChanceTree, CalculateChanceContext>())
+            {
+                _chanceWalker.ThreadsCount = threadsCount;
+                _chanceWalker.OnNodeBegin = Calculate_Chance_OnNodeBegin;
+                _chanceWalker.OnReduce = Calculate_Chance_OnReduce;
 
-            WalkUFTreePP<ActionTree, CalculateActionContext> wt = new WalkUFTreePP<ActionTree, CalculateActionContext>();
-            wt.OnNodeBegin = Calculate_Action_OnNodeBegin;
-            wt.Walk(ActionTree);
+                WalkUFTreePP<ActionTree, CalculateActionContext> wt = new WalkUFTreePP<ActionTree, CalculateActionContext>();
+                wt.OnNodeBegin = Calculate_Action_OnNodeBegin;
+                wt.Walk(ActionTree);
+            }
+            _chanceWalker = null;
+            _workerGameValues = null;
         }
 
         void Calculate_Action_OnNodeBegin(ActionTree tree, CalculateActionContext[] stack, int depth)
@@ -409,9 +431,7 @@ namespace ai.pkr.metastrategy.algorithms
             _chanceDepth = (byte)(_playersCount * (round+1));
             _strategicState = context.State;
             _actionTreeNodeIdx = n;
-            WalkUFTreePP<ChanceTree, CalculateChanceContext> wt = new WalkUFTreePP<ChanceTree, CalculateChanceContext>();
-            wt.OnNodeBegin = Calculate_Chance_OnNodeBegin;
-            wt.Walk(ChanceTree);
+            _chanceWalker.Walk(ChanceTree);
         }
 
         void Calculate_Chance_OnNodeBegin(ChanceTree tree, CalculateChanceContext[] stack, int depth)
@@ -458,10 +478,11 @@ namespace ai.pkr.metastrategy.algorithms
                         double chanceProbab = ChanceTree.Nodes[n].Probab;
                         double probab = chanceProbab * context.StrategicProbab;
                         double pot = _strategicState.Pot;
+                        double[] gameValues = _workerGameValues[WalkUFTreePPParallel<ChanceTree, CalculateChanceContext>.CurrentWorker];
                         for (int p = 0; p < _playersCount; ++p)
                         {
                             double playerValue =  probab * (pot*potShares[p] - _strategicState.InPot[p]);
-                            _gameValues[p] += playerValue;
+                            gameValues[p] += playerValue;
                             if (PrepareVis)
                             {
                                 _visLeaveValues[p][_actionTreeNodeIdx][context.ChanceIdx[p]] += playerValue;
@@ -472,6 +493,15 @@ namespace ai.pkr.metastrategy.algorithms
             }
         }
 
+        void Calculate_Chance_OnReduce(ChanceTree tree, int worker)
+        {
+            double[] gameValues = _workerGameValues[worker];
+            for (int p = 0; p < _playersCount; ++p)
+            {
+                _gameValues[p] += gameValues[p];
+                gameValues[p] = 0;
+            }
+        }
 
         private void CleanUp()
         {
@@ -495,6 +525,12 @@ namespace ai.pkr.metastrategy.algorithms
         double[][][] _spArrays;
         double[][][] _visLeaveValues;
         double[] _gameValues;
+        /// <summary>
+        /// Game values accumulated by each worker thread while walking the chance tree.
+        /// </summary>
+        double[][] _workerGameValues;
+        WalkUFTreePPParallel<ChanceTree, CalculateChanceContext> _chanceWalker;
+        int _threadsCount = 1;
         int _playersCount;
         int _curPlayer;
         UFTreeChildrenIndex _actionTreeIndex;
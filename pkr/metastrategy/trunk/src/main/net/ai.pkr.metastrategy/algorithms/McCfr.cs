@@ -0,0 +1,265 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using ai.lib.algorithms.tree;
+
+namespace ai.pkr.metastrategy.algorithms
+{
+    /// <summary>
+    /// Finds an approximate equilibrium in a heads-up game with Monte-Carlo CFR (external sampling) 
+    /// in the native engine (ai.pkr.metastrategy.cpplib). For games where the full traversal of CfrPlus is too costly.
+    /// Input: action and chance trees of the game. For a chance abstraction use the chance tree
+    /// created by CreateChanceTreeByAbstraction, it contains the buckets.
+    /// Output: absolute strategy trees of both positions (the average strategy) and their exploitability.
+    /// <para>Each iteration samples a deal for each position, see mccfr_engine.h. The regrets and the average
+    /// are stored as floats for each information set and action. The exploitability is calculated 
+    /// by BrNative each EpsilonCheckPeriod iterations, the iterations stop when it reaches Epsilon,
+    /// or after MaxIterationCount iterations.</para>
+    /// <para>The trees must be in memory or memory-mapped (FDA is not supported).</para>
+    /// </summary>
+    public unsafe class McCfr : IDisposable
+    {
+        #region Public API
+
+        public McCfr()
+        {
+            ThreadsCount = 1;
+            Epsilon = 0.001;
+            MaxIterationCount = Int64.MaxValue;
+            EpsilonCheckPeriod = 100000;
+        }
+
+        public ActionTree ActionTree
+        {
+            set;
+            get;
+        }
+
+        public ChanceTree ChanceTree
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Number of threads. With more than 1 thread the result is not reproducible. Default: 1.
+        /// </summary>
+        public int ThreadsCount
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Seed of the random numbers. Default: 0.
+        /// </summary>
+        public UInt64 Seed
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Target exploitability (the sum of the values of the best responses of both positions).
+        /// Default: 0.001.
+        /// </summary>
+        public double Epsilon
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Maximal number of iterations. Default: Int64.MaxValue.
+        /// </summary>
+        public Int64 MaxIterationCount
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Number of iterations between the calculations of the exploitability. Default: 100000.
+        /// </summary>
+        public Int64 EpsilonCheckPeriod
+        {
+            set;
+            get;
+        }
+
+        public bool IsVerbose
+        {
+            set;
+            get;
+        }
+
+        /// <summary>
+        /// Exploitability of the average strategy after the last check.
+        /// </summary>
+        public double CurrentEpsilon
+        {
+            get;
+            protected set;
+        }
+
+        public Int64 IterationCount
+        {
+            get;
+            protected set;
+        }
+
+        /// <summary>
+        /// Absolute strategy trees of the positions.
+        /// </summary>
+        public StrategyTree[] Strategies
+        {
+            get;
+            protected set;
+        }
+
+        public void Solve()
+        {
+            CheckPreconditions();
+            CppLib.Init();
+            Dispose();
+            _engine = CppLib.McCfrEngine_Open(ThreadsCount, Seed);
+            if (_engine == IntPtr.Zero)
+            {
+                CppLib.McCfrEngine_ThrowLastError();
+            }
+            SetTree(CppLib.McCfrEngineActionTree, ActionTree, ActionTree.Nodes, sizeof(ActionTreeNode));
+            SetTree(CppLib.McCfrEngineChanceTree, ChanceTree, ChanceTree.Nodes, sizeof(ChanceTreeNode));
+            CreateStrategies();
+
+            IterationCount = 0;
+            DateTime startTime = DateTime.Now;
+            for (; ; )
+            {
+                Int64 count = Math.Min(EpsilonCheckPeriod, MaxIterationCount - IterationCount);
+                if (CppLib.McCfrEngine_Iterate(_engine, count) == 0)
+                {
+                    CppLib.McCfrEngine_ThrowLastError();
+                }
+                IterationCount += count;
+                UpdateStrategies();
+                double[] brValues = new double[2];
+                // The strategy trees are updated in place, so a new BrNative copies them again.
+                using (BrNative br = new BrNative { ActionTree = ActionTree, ChanceTree = ChanceTree, 
+                    Strategies = Strategies, ThreadsCount = ThreadsCount })
+                {
+                    for (int p = 0; p < 2; ++p)
+                    {
+                        br.HeroPosition = p;
+                        br.Solve();
+                        brValues[p] = br.Value;
+                    }
+                }
+                CurrentEpsilon = brValues[0] + brValues[1];
+                if (IsVerbose)
+                {
+                    Console.WriteLine("{0} it: {1}, eps: {2:0.000000}, br values: {3:0.000000} {4:0.000000}, table size: {5}",
+                        DateTime.Now - startTime, IterationCount, CurrentEpsilon, brValues[0], brValues[1],
+                        CppLib.McCfrEngine_GetTableSize(_engine));
+                }
+                if (CurrentEpsilon <= Epsilon || IterationCount >= MaxIterationCount)
+                {
+                    break;
+                }
+            }
+        }
+
+        public void Dispose()
+        {
+            if (_engine != IntPtr.Zero)
+            {
+                CppLib.McCfrEngine_Close(_engine);
+                _engine = IntPtr.Zero;
+            }
+        }
+
+        #endregion
+
+        #region Implementation
+
+        private void CheckPreconditions()
+        {
+            if (ActionTree == null || ChanceTree == null)
+            {
+                throw new ArgumentException("Input trees must not be null.");
+            }
+            if (ActionTree.PlayersCount != 2 || ChanceTree.PlayersCount != 2)
+            {
+                throw new ArgumentException("Only heads-up games are supported.");
+            }
+            if (ThreadsCount < 1 || EpsilonCheckPeriod < 1 || MaxIterationCount < 1)
+            {
+                throw new ArgumentException("ThreadsCount, EpsilonCheckPeriod and MaxIterationCount must be positive.");
+            }
+        }
+
+        private static byte[] GetDepths(UFTree tree)
+        {
+            if (tree.IsFDA)
+            {
+                throw new ArgumentException("FDA trees are not supported.");
+            }
+            byte[] depths = new byte[tree.NodesCount];
+            for (Int64 i = 0; i < tree.NodesCount; ++i)
+            {
+                depths[i] = tree.GetDepth(i);
+            }
+            return depths;
+        }
+
+        private void SetTree(int kind, UFTree tree, void* nodes, int nodeByteSize)
+        {
+            byte[] depths = GetDepths(tree);
+            fixed (byte* pDepths = depths)
+            {
+                if (CppLib.McCfrEngine_SetTree(_engine, kind, tree.NodesCount, pDepths, nodes, nodeByteSize) == 0)
+                {
+                    CppLib.McCfrEngine_ThrowLastError();
+                }
+            }
+        }
+
+        /// <summary>
+        /// Creates the strategy trees of the positions, the probabilities are set by UpdateStrategies().
+        /// </summary>
+        private void CreateStrategies()
+        {
+            Strategies = new StrategyTree[2];
+            _strategyDepths = new byte[2][];
+            for (int p = 0; p < 2; ++p)
+            {
+                ChanceTree pct = ExtractPlayerChanceTree.ExtractS(ChanceTree, p);
+                Strategies[p] = CreateStrategyTreeByChanceAndActionTrees.CreateS(pct, ActionTree);
+                _strategyDepths[p] = GetDepths(Strategies[p]);
+            }
+        }
+
+        private void UpdateStrategies()
+        {
+            for (int p = 0; p < 2; ++p)
+            {
+                StrategyTree st = Strategies[p];
+                fixed (byte* pDepths = _strategyDepths[p])
+                {
+                    if (CppLib.McCfrEngine_GetStrategy(_engine, p, st.NodesCount, pDepths, st.Nodes, sizeof(StrategyTreeNode)) == 0)
+                    {
+                        CppLib.McCfrEngine_ThrowLastError();
+                    }
+                }
+            }
+        }
+
+        IntPtr _engine = IntPtr.Zero;
+        byte[][] _strategyDepths;
+
+        #endregion
+    }
+}
\ No newline at end of file
@@ -16,16 +16,24 @@ namespace ai.pkr.metastrategy.algorithms
     public static class VerifyEq
     {
         public static bool Verify(ActionTree at, ChanceTree ct, StrategyTree[] strategies, double epsilon, out string message)
+        {
+            return Verify(at, ct, strategies, epsilon, 1, out message);
+        }
+
+        /// <summary>
+        /// Same as above, calculates the game value and the best responses with threadsCount threads.
+        /// </summary>
+        public static bool Verify(ActionTree at, ChanceTree ct, StrategyTree[] strategies, double epsilon, int threadsCount, out string message)
         {
             message = "";
             // No need to check preconditions, GameValue does it 
-            GameValue gv = new GameValue {ActionTree = at, ChanceTree = ct, Strategies = strategies };
+            GameValue gv = new GameValue {ActionTree = at, ChanceTree = ct, Strategies = strategies, ThreadsCount = threadsCount };
             gv.Solve();
 
             for (int p = 0; p < at.PlayersCount; ++p)
             {
                 StrategyTree[] strategiesCopy = (StrategyTree[])strategies.Clone();
-                Br br = new Br { ActionTree = at, ChanceTree = ct, Strategies = strategiesCopy, HeroPosition = p };
+                Br br = new Br { ActionTree = at, ChanceTree = ct, Strategies = strategiesCopy, HeroPosition = p, ThreadsCount = threadsCount };
                 br.Solve();
                 if (!FloatingPoint.AreEqual(gv.Values[p], br.Value, epsilon))
                 {
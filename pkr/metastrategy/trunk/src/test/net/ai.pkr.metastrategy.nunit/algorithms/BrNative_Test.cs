@@ -0,0 +1,261 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using ai.pkr.metagame;
+using ai.lib.utils;
+using ai.pkr.metastrategy.algorithms;
+using System.Reflection;
+using System.IO;
+using ai.pkr.metastrategy;
+using ai.lib.algorithms;
+using ai.pkr.metastrategy.model_games;
+using ai.lib.algorithms.tree;
+using System.Runtime.InteropServices;
+
+namespace ai.pkr.metastrategy.algorithms.nunit
+{
+    /// <summary>
+    /// Unit tests for BrNative. The values are compared with the expected ones (see Br_Test) and with Br.
+    /// </summary>
+    [TestFixture]
+    public unsafe class BrNative_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_Kuhn()
+        {
+            Solve(new GameDefParams(this, "kuhn.gamedef.xml",
+                new string[] { "eq-KunhPoker-0-s.xml", "eq-KunhPoker-1-s.xml" }),
+                new double[] { -1.0 / 18, 1.0 / 18 }, 1);
+        }
+
+        [Test]
+        public void Test_Ocp()
+        {
+            Solve(new GameDefParams(this, "ocp.gamedef.xml",
+                new string[] { "eq-OneCardPoker-0-s.xml", "eq-OneCardPoker-1-s.xml" }),
+                new double[] { -0.0641025641026934, 0.0641025641026934 }, 1);
+        }
+
+        [Test]
+        public void Test_LeducHe()
+        {
+            Solve(new GameDefParams(this, "leduc-he.gamedef.xml",
+                new string[] { "eq-LeducHe-0-s.xml", "eq-LeducHe-1-s.xml" }),
+                new double[] { -0.0428032120390257, 0.0428032120390257 }, 1);
+        }
+
+        [Test]
+        public void Test_LeducHeRb()
+        {
+            Solve(new GameDefParams(this, "leduc-he-rb.gamedef.xml",
+                new string[] { "eq-LeducHeRb-0-s.xml", "eq-LeducHeRb-1-s.xml" }),
+                new double[] { -0.00464121889644268, 0.00464121889644268 }, 1);
+        }
+
+        [Test]
+        public void Test_MiniFl()
+        {
+            Solve(new GameDefParams(this, "mini-fl.gamedef.xml",
+                new string[] { "eq-MiniFl-0-s.xml", "eq-MiniFl-1-s.xml" }),
+                new double[] { 0.0277777777778998, -0.0277777777778998 }, 1);
+        }
+
+        [Test]
+        public void Test_MiniFl_Parallel()
+        {
+            Solve(new GameDefParams(this, "mini-fl.gamedef.xml",
+                new string[] { "eq-MiniFl-0-s.xml", "eq-MiniFl-1-s.xml" }),
+                new double[] { 0.0277777777778998, -0.0277777777778998 }, 4);
+        }
+
+        /// <summary>
+        /// A chance abstraction: the strategies are for the abstracted game.
+        /// </summary>
+        [Test]
+        public void Test_Kuhn_CA()
+        {
+            GameDefParams testParams = new GameDefParams(this, "kuhn.gamedef.xml",
+                new string[] { "eq-KunhPoker-0-s.xml", "eq-KunhPoker-1-s.xml" });
+            testParams.ChanceTree = CreateChanceTreeByAbstraction.CreateS(testParams.GameDef,
+                new IChanceAbstraction[] { new KuhnChanceAbstraction(), new KuhnChanceAbstraction() });
+            Solve(testParams, new double[] { -1.0 / 18, 1.0 / 18 }, 2);
+        }
+
+        /// <summary>
+        /// Solves the game from the files written by UFTree.Write(), with the native runner 
+        /// format (see ai.pkr.metastrategy.cpplib-runner br) and with BrNative on the read trees.
+        /// </summary>
+        [Test]
+        public void Test_LeducHe_Files()
+        {
+            GameDefParams testParams = new GameDefParams(this, "leduc-he.gamedef.xml",
+                new string[] { "eq-LeducHe-0-s.xml", "eq-LeducHe-1-s.xml" });
+            string atFile = Path.Combine(_outDir, "leduc-he-at.dat");
+            string ctFile = Path.Combine(_outDir, "leduc-he-ct.dat");
+            string stFile = Path.Combine(_outDir, "leduc-he-st-0.dat");
+            testParams.ActionTree.Write(atFile);
+            testParams.ChanceTree.Write(ctFile);
+            testParams.StrategyTrees[0].Write(stFile);
+
+            using (ActionTree at = UFTree.ReadMapped<ActionTree>(atFile))
+            using (ChanceTree ct = UFTree.ReadMapped<ChanceTree>(ctFile))
+            using (StrategyTree st = UFTree.ReadMapped<StrategyTree>(stFile))
+            using (BrNative br = new BrNative { ActionTree = at, ChanceTree = ct, HeroPosition = 1 })
+            {
+                br.Strategies = new StrategyTree[] { st, null };
+                br.Solve();
+                Assert.AreEqual(0.0428032120390257, br.Value, 1e-12);
+            }
+
+            IntPtr e = CppLib.BrEngine_Open(1);
+            Assert.AreNotEqual(IntPtr.Zero, e);
+            try
+            {
+                Assert.AreEqual(1, CppLib.BrEngine_LoadTree(e, CppLib.BrEngineActionTree, 0, atFile));
+                Assert.AreEqual(1, CppLib.BrEngine_LoadTree(e, CppLib.BrEngineChanceTree, 0, ctFile));
+                Assert.AreEqual(1, CppLib.BrEngine_LoadTree(e, CppLib.BrEngineStrategyTree, 0, stFile));
+                double value;
+                Assert.AreEqual(1, CppLib.BrEngine_Solve(e, 1, &value));
+                Assert.AreEqual(0.0428032120390257, value, 1e-12);
+                Assert.AreEqual(0, CppLib.BrEngine_LoadTree(e, CppLib.BrEngineActionTree, 0, ctFile));
+                Assert.IsTrue(Marshal.PtrToStringAnsi(CppLib.BrEngine_GetLastError()).Contains("wrong node size"));
+            }
+            finally
+            {
+                CppLib.BrEngine_Close(e);
+            }
+        }
+
+        #endregion
+
+        #region Benchmarks
+
+        /// <summary>
+        /// Compares the speed of Br and BrNative.
+        /// </summary>
+        [Test]
+        [Category("Benchmark")]
+        public void Benchmark_Solve()
+        {
+            Benchmark(new GameDefParams(this, "leduc-he.gamedef.xml",
+                new string[] { "eq-LeducHe-0-s.xml", "eq-LeducHe-1-s.xml" }), 100);
+            Benchmark(new GameDefParams(this, "mini-fl.gamedef.xml",
+                new string[] { "eq-MiniFl-0-s.xml", "eq-MiniFl-1-s.xml" }), 100);
+            Benchmark(new GameDefParams(this, "ocp.gamedef.xml",
+                new string[] { "eq-OneCardPoker-0-s.xml", "eq-OneCardPoker-1-s.xml" }), 100);
+        }
+
+        #endregion
+
+        #region Implementation
+
+        string _testResDir = UTHelper.GetTestResourceDir(Assembly.GetExecutingAssembly());
+        string _outDir = UTHelper.MakeAndGetTestOutputDir(Assembly.GetExecutingAssembly(), "algorithms/BrNative_Test");
+
+        /// <summary>
+        /// A game by game definition with strategies from XML.
+        /// </summary>
+        class GameDefParams
+        {
+            public GameDefinition GameDef;
+            public ChanceTree ChanceTree;
+            public ActionTree ActionTree;
+            public StrategyTree[] StrategyTrees;
+
+            public GameDefParams(BrNative_Test test, string gameDefFile, string[] strategyFiles)
+            {
+                GameDef = XmlSerializerExt.Deserialize<GameDefinition>(
+                    Props.Global.Expand("${bds.DataDir}ai.pkr.metastrategy/${0}",
+                    gameDefFile));
+                StrategyTrees = new StrategyTree[GameDef.MinPlayers].Fill(i =>
+                    XmlToStrategyTree.Convert(Path.Combine(test._testResDir, strategyFiles[i]), GameDef.DeckDescr));
+                ChanceTree = CreateChanceTreeByGameDef.Create(GameDef);
+                ActionTree = CreateActionTreeByGameDef.Create(GameDef);
+            }
+        }
+
+        private void Solve(GameDefParams testParams, double[] expectedResult, int threadsCount)
+        {
+            int playersCount = testParams.ChanceTree.PlayersCount;
+            // One instance for all positions, the trees are copied once.
+            using (BrNative brNative = new BrNative
+                       {
+                           ActionTree = testParams.ActionTree,
+                           ChanceTree = testParams.ChanceTree,
+                           Strategies = testParams.StrategyTrees,
+                           ThreadsCount = threadsCount
+                       })
+            {
+                for (int heroPos = 0; heroPos < playersCount; ++heroPos)
+                {
+                    brNative.HeroPosition = heroPos;
+                    brNative.Solve();
+                    Assert.AreEqual(expectedResult[heroPos], brNative.Value, 1e-12, "Wrong BR value");
+
+                    Br br = new Br
+                                {
+                                    HeroPosition = heroPos,
+                                    ChanceTree = testParams.ChanceTree,
+                                    ActionTree = testParams.ActionTree,
+                                    Strategies = new StrategyTree[playersCount].Fill(p => p == heroPos ? null : testParams.StrategyTrees[p])
+                                };
+                    br.Solve();
+                    Assert.AreEqual(br.Value, brNative.Value, 1e-12, "BrNative differs from Br");
+                }
+            }
+        }
+
+        private void Benchmark(GameDefParams testParams, int repetitions)
+        {
+            int playersCount = testParams.ChanceTree.PlayersCount;
+            DateTime startTime = DateTime.Now;
+            for (int r = 0; r < repetitions; ++r)
+            {
+                for (int heroPos = 0; heroPos < playersCount; ++heroPos)
+                {
+                    Br br = new Br
+                    {
+                        HeroPosition = heroPos,
+                        ChanceTree = testParams.ChanceTree,
+                        ActionTree = testParams.ActionTree,
+                        Strategies = new StrategyTree[playersCount].Fill(p => p == heroPos ? null : testParams.StrategyTrees[p])
+                    };
+                    br.Solve();
+                }
+            }
+            double brTime = (DateTime.Now - startTime).TotalSeconds;
+
+            startTime = DateTime.Now;
+            for (int r = 0; r < repetitions; ++r)
+            {
+                // A new instance for each repetition, to include copying of the trees and preparation.
+                using (BrNative brNative = new BrNative
+                {
+                    ActionTree = testParams.ActionTree,
+                    ChanceTree = testParams.ChanceTree,
+                    Strategies = testParams.StrategyTrees,
+                })
+                {
+                    for (int heroPos = 0; heroPos < playersCount; ++heroPos)
+                    {
+                        brNative.HeroPosition = heroPos;
+                        brNative.Solve();
+                    }
+                }
+            }
+            double nativeTime = (DateTime.Now - startTime).TotalSeconds;
+
+            Console.WriteLine("{0}: {1} repetitions, Br: {2:0.000} s, BrNative: {3:0.000} s, speedup: {4:0.0}",
+                testParams.GameDef.Name, repetitions, brTime, nativeTime, brTime / nativeTime);
+        }
+
+        #endregion
+    }
+}
\ No newline at end of file
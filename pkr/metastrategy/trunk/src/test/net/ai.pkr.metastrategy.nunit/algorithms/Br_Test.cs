@@ -125,6 +125,19 @@ namespace ai.pkr.metastrategy.algorithms.nunit
             Solve(testParams, false, null);
         }
 
+        /// <summary>
+        /// Same as Test_MiniFl, calculates with several threads.
+        /// </summary>
+        [Test]
+        public void Test_MiniFl_Parallel()
+        {
+            var testParams = new GameDefParams(this, "mini-fl.gamedef.xml",
+                new string[] { "eq-MiniFl-0-s.xml", "eq-MiniFl-1-s.xml" },
+                new double[] { 0.0277777777778998, -0.0277777777778998 },
+                0.000000000005);
+            Solve(testParams, false, s => { s.ThreadsCount = 4; });
+        }
+
         #endregion
 
         #region Abstract tests
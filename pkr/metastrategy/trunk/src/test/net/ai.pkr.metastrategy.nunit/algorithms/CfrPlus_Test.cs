@@ -0,0 +1,171 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using ai.pkr.metagame;
+using ai.lib.utils;
+using ai.pkr.metastrategy.algorithms;
+using System.IO;
+using ai.pkr.metastrategy;
+using ai.lib.algorithms;
+using ai.pkr.metastrategy.model_games;
+using ai.lib.algorithms.tree;
+
+namespace ai.pkr.metastrategy.algorithms.nunit
+{
+    /// <summary>
+    /// Unit tests for CfrPlus. The strategies are verified by VerifyEq, the game values are compared 
+    /// with the known ones (see EqLp_Test).
+    /// </summary>
+    [TestFixture]
+    public unsafe class CfrPlus_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_Kuhn()
+        {
+            Solve(new GameDefParams("kuhn.gamedef.xml"), -1.0 / 18, 0.0005, 1);
+        }
+
+        [Test]
+        public void Test_Ocp()
+        {
+            Solve(new GameDefParams("ocp.gamedef.xml"), -0.0641025641026934, 0.001, 1);
+        }
+
+        [Test]
+        public void Test_LeducHe()
+        {
+            Solve(new GameDefParams("leduc-he.gamedef.xml"), -0.0428032120390257, 0.005, 2);
+        }
+
+        [Test]
+        public void Test_MiniFl()
+        {
+            Solve(new GameDefParams("mini-fl.gamedef.xml"), 0.0277777777778998, 0.001, 4);
+        }
+
+        /// <summary>
+        /// A chance abstraction: the value of the abstracted game.
+        /// </summary>
+        [Test]
+        public void Test_Kuhn_CA()
+        {
+            GameDefParams testParams = new GameDefParams("kuhn.gamedef.xml");
+            testParams.ChanceTree = CreateChanceTreeByAbstraction.CreateS(testParams.GameDef,
+                new IChanceAbstraction[] { new KuhnChanceAbstraction(), new KuhnChanceAbstraction() });
+            Solve(testParams, -1.0 / 18, 0.0005, 2);
+        }
+
+        [Test]
+        public void Test_MaxIterationCount()
+        {
+            GameDefParams testParams = new GameDefParams("leduc-he.gamedef.xml");
+            using (CfrPlus solver = new CfrPlus
+                                        {
+                                            ActionTree = testParams.ActionTree,
+                                            ChanceTree = testParams.ChanceTree,
+                                            Epsilon = 0,
+                                            MaxIterationCount = 25,
+                                            EpsilonCheckPeriod = 10
+                                        })
+            {
+                solver.Solve();
+                Assert.AreEqual(25, solver.IterationCount);
+                Assert.Greater(solver.CurrentEpsilon, 0);
+                Assert.AreEqual(2, solver.Strategies.Length);
+            }
+        }
+
+        #endregion
+
+        #region Benchmarks
+
+        [Test]
+        [Category("Benchmark")]
+        public void Benchmark_LeducHe()
+        {
+            GameDefParams testParams = new GameDefParams("leduc-he.gamedef.xml");
+            foreach (int threadsCount in new int[] { 1, Environment.ProcessorCount }.Distinct())
+            {
+                DateTime startTime = DateTime.Now;
+                using (CfrPlus solver = new CfrPlus
+                                            {
+                                                ActionTree = testParams.ActionTree,
+                                                ChanceTree = testParams.ChanceTree,
+                                                ThreadsCount = threadsCount,
+                                                Epsilon = 0.0001,
+                                                EpsilonCheckPeriod = 100
+                                            })
+                {
+                    solver.Solve();
+                    double time = (DateTime.Now - startTime).TotalSeconds;
+                    Console.WriteLine("Leduc HE, {0} thread(s): eps {1:0.000000} in {2} iterations, {3:0.000} s, {4:0.0} it/s",
+                        threadsCount, solver.CurrentEpsilon, solver.IterationCount, time, solver.IterationCount / time);
+                }
+            }
+        }
+
+        #endregion
+
+        #region Implementation
+
+        class GameDefParams
+        {
+            public GameDefinition GameDef;
+            public ChanceTree ChanceTree;
+            public ActionTree ActionTree;
+
+            public GameDefParams(string gameDefFile)
+            {
+                GameDef = XmlSerializerExt.Deserialize<GameDefinition>(
+                    Props.Global.Expand("${bds.DataDir}ai.pkr.metastrategy/${0}", gameDefFile));
+                ChanceTree = CreateChanceTreeByGameDef.Create(GameDef);
+                ActionTree = CreateActionTreeByGameDef.Create(GameDef);
+            }
+        }
+
+        private void Solve(GameDefParams testParams, double expectedValue, double epsilon, int threadsCount)
+        {
+            using (CfrPlus solver = new CfrPlus
+                                        {
+                                            ActionTree = testParams.ActionTree,
+                                            ChanceTree = testParams.ChanceTree,
+                                            ThreadsCount = threadsCount,
+                                            Epsilon = epsilon,
+                                            IsVerbose = true
+                                        })
+            {
+                solver.Solve();
+                Console.WriteLine("{0}: eps {1} in {2} iterations", testParams.GameDef.Name, solver.CurrentEpsilon,
+                    solver.IterationCount);
+                Assert.LessOrEqual(solver.CurrentEpsilon, epsilon);
+
+                string message;
+                for (int p = 0; p < 2; ++p)
+                {
+                    Assert.IsTrue(VerifyAbsStrategy.Verify(solver.Strategies[p], p, 1e-7, out message), message);
+                }
+                // The exploitability calculated by the engine must match the one of the strategy trees.
+                Assert.IsTrue(VerifyEq.Verify(testParams.ActionTree, testParams.ChanceTree, solver.Strategies,
+                    solver.CurrentEpsilon + 1e-9, out message), message);
+
+                GameValue gv = new GameValue
+                                   {
+                                       ActionTree = testParams.ActionTree,
+                                       ChanceTree = testParams.ChanceTree,
+                                       Strategies = solver.Strategies
+                                   };
+                gv.Solve();
+                Assert.AreEqual(expectedValue, gv.Values[0], epsilon);
+            }
+        }
+
+        #endregion
+    }
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using ai.pkr.metagame;
+using ai.lib.utils;
+using ai.pkr.metastrategy.algorithms;
+using ai.pkr.metastrategy;
+using ai.lib.algorithms;
+using ai.pkr.metastrategy.model_games;
+using ai.lib.algorithms.tree;
+
+namespace ai.pkr.metastrategy.algorithms.nunit
+{
+    /// <summary>
+    /// Unit tests for McCfr. The strategies are verified by VerifyEq, the game values are compared 
+    /// with the known ones (see EqLp_Test).
+    /// </summary>
+    [TestFixture]
+    public unsafe class McCfr_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_Kuhn()
+        {
+            Solve(new GameDefParams("kuhn.gamedef.xml"), -1.0 / 18, 0.005, 1);
+        }
+
+        [Test]
+        public void Test_LeducHe()
+        {
+            Solve(new GameDefParams("leduc-he.gamedef.xml"), -0.0428032120390257, 0.02, 2);
+        }
+
+        /// <summary>
+        /// A chance abstraction: the value of the abstracted game.
+        /// </summary>
+        [Test]
+        public void Test_Kuhn_CA()
+        {
+            GameDefParams testParams = new GameDefParams("kuhn.gamedef.xml");
+            testParams.ChanceTree = CreateChanceTreeByAbstraction.CreateS(testParams.GameDef,
+                new IChanceAbstraction[] { new KuhnChanceAbstraction(), new KuhnChanceAbstraction() });
+            Solve(testParams, -1.0 / 18, 0.005, 2);
+        }
+
+        /// <summary>
+        /// With 1 thread the result depends only on the seed.
+        /// </summary>
+        [Test]
+        public void Test_Seed()
+        {
+            GameDefParams testParams = new GameDefParams("leduc-he.gamedef.xml");
+            double[] epsilons = new double[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                using (McCfr solver = new McCfr
+                                          {
+                                              ActionTree = testParams.ActionTree,
+                                              ChanceTree = testParams.ChanceTree,
+                                              Seed = i == 2 ? 2UL : 1UL,
+                                              Epsilon = 0,
+                                              MaxIterationCount = 5000,
+                                              EpsilonCheckPeriod = 2000
+                                          })
+                {
+                    solver.Solve();
+                    Assert.AreEqual(5000, solver.IterationCount);
+                    epsilons[i] = solver.CurrentEpsilon;
+                }
+            }
+            Assert.AreEqual(epsilons[0], epsilons[1]);
+            Assert.AreNotEqual(epsilons[0], epsilons[2]);
+        }
+
+        #endregion
+
+        #region Benchmarks
+
+        [Test]
+        [Category("Benchmark")]
+        public void Benchmark_LeducHe()
+        {
+            GameDefParams testParams = new GameDefParams("leduc-he.gamedef.xml");
+            foreach (int threadsCount in new int[] { 1, Environment.ProcessorCount }.Distinct())
+            {
+                DateTime startTime = DateTime.Now;
+                using (McCfr solver = new McCfr
+                                          {
+                                              ActionTree = testParams.ActionTree,
+                                              ChanceTree = testParams.ChanceTree,
+                                              ThreadsCount = threadsCount,
+                                              Epsilon = 0.01,
+                                              EpsilonCheckPeriod = 100000
+                                          })
+                {
+                    solver.Solve();
+                    double time = (DateTime.Now - startTime).TotalSeconds;
+                    Console.WriteLine("Leduc HE, {0} thread(s): eps {1:0.000000} in {2} iterations, {3:0.000} s, {4:0} it/s",
+                        threadsCount, solver.CurrentEpsilon, solver.IterationCount, time, solver.IterationCount / time);
+                }
+            }
+        }
+
+        #endregion
+
+        #region Implementation
+
+        class GameDefParams
+        {
+            public GameDefinition GameDef;
+            public ChanceTree ChanceTree;
+            public ActionTree ActionTree;
+
+            public GameDefParams(string gameDefFile)
+            {
+                GameDef = XmlSerializerExt.Deserialize<GameDefinition>(
+                    Props.Global.Expand("${bds.DataDir}ai.pkr.metastrategy/${0}", gameDefFile));
+                ChanceTree = CreateChanceTreeByGameDef.Create(GameDef);
+                ActionTree = CreateActionTreeByGameDef.Create(GameDef);
+            }
+        }
+
+        private void Solve(GameDefParams testParams, double expectedValue, double epsilon, int threadsCount)
+        {
+            using (McCfr solver = new McCfr
+                                      {
+                                          ActionTree = testParams.ActionTree,
+                                          ChanceTree = testParams.ChanceTree,
+                                          ThreadsCount = threadsCount,
+                                          Epsilon = epsilon,
+                                          EpsilonCheckPeriod = 20000,
+                                          IsVerbose = true
+                                      })
+            {
+                solver.Solve();
+                Console.WriteLine("{0}: eps {1} in {2} iterations", testParams.GameDef.Name, solver.CurrentEpsilon,
+                    solver.IterationCount);
+                Assert.LessOrEqual(solver.CurrentEpsilon, epsilon);
+
+                string message;
+                for (int p = 0; p < 2; ++p)
+                {
+                    Assert.IsTrue(VerifyAbsStrategy.Verify(solver.Strategies[p], p, 1e-6, out message), message);
+                }
+                Assert.IsTrue(VerifyEq.Verify(testParams.ActionTree, testParams.ChanceTree, solver.Strategies,
+                    solver.CurrentEpsilon + 1e-9, out message), message);
+
+                GameValue gv = new GameValue
+                                   {
+                                       ActionTree = testParams.ActionTree,
+                                       ChanceTree = testParams.ChanceTree,
+                                       Strategies = solver.Strategies
+                                   };
+                gv.Solve();
+                Assert.AreEqual(expectedValue, gv.Values[0], epsilon);
+            }
+        }
+
+        #endregion
+    }
+}
\ No newline at end of file
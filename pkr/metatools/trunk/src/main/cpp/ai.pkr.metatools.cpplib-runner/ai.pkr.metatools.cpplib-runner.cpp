@@ -0,0 +1,756 @@
+// ai.pkr.metatools.cpplib-runner.cpp : Tests and benchmarks for ai.pkr.metatools.cpplib.
+//
+// Usage:
+//   ai.pkr.metatools.cpplib-runner test [temp-dir]
+//       Runs the tests (on synthetic game logs, no data files are required).
+//   ai.pkr.metatools.cpplib-runner stat <threads> <binary-log>
+//       Prints the total result of a binary game log.
+//   ai.pkr.metatools.cpplib-runner benchmark [games] [threads] [temp-dir]
+//       Writes a synthetic binary game log and scans it with 1 and with the given number of threads.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include "ai.pkr.metatools.cpplib.h"
+#include "game_log_file.h"
+#include "game_log_writer.h"
+#include "log_scanner.h"
+#include <ai.lib.utils.cpp/bds_version.h>
+
+using namespace std;
+using namespace ai::pkr::metatools;
+
+static string _tempDir = ".";
+
+#define VERIFY(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); throw "Test failed"; }
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// A simple deterministic RNG (the tests must be reproducible).
+class Rng
+{
+public:
+	Rng(uint64_t seed) : _state(seed * 2862933555777941757ULL + 3037000493ULL)
+	{}
+
+	uint32_t Next(uint32_t n)
+	{
+		_state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (uint32_t)((_state >> 33) % n);
+	}
+private:
+	uint64_t _state;
+};
+
+/// A game record (GameRecord in C#) with the session assigned by the writer.
+struct Game
+{
+	struct Player
+	{
+		string name;
+		double stack, blind, result;
+	};
+
+	struct Action
+	{
+		uint8_t kind;
+		int8_t position;
+		double amount;
+		string cards;
+	};
+
+	int32_t session;
+	bool isGameOver;
+	string id;
+	vector<Player> players;
+	vector<Action> actions;
+};
+
+/// A session begin preceding a game.
+struct Session
+{
+	int game;
+	int32_t index;
+	string name;
+};
+
+template<class T> static void Append(string & s, const vector<T> & column)
+{
+	if(!column.empty())
+	{
+		s.append((const char*)&column[0], column.size() * sizeof(T));
+	}
+}
+
+static void Pad8(string & s)
+{
+	s.append((8 - s.size() % 8) % 8, '\0');
+}
+
+static void WriteInt32(string & s, uint32_t v)
+{
+	s.append((const char*)&v, 4);
+}
+
+static void WriteString(string & s, const string & v)
+{
+	// Strings are short here, 1-byte length prefix.
+	s.push_back((char)v.size());
+	s += v;
+}
+
+/// String table of a chunk.
+class Strings
+{
+public:
+	int32_t Add(const string & s)
+	{
+		map<string, int32_t>::const_iterator it = _index.find(s);
+		if(it != _index.end())
+		{
+			return it->second;
+		}
+		int32_t i = (int32_t)_offsets.size() - 1;
+		_index[s] = i;
+		_bytes += s;
+		_offsets.push_back((int32_t)_bytes.size());
+		return i;
+	}
+
+	vector<int32_t> _offsets = vector<int32_t>(1, 0);
+	string _bytes;
+	map<string, int32_t> _index;
+};
+
+/// Writes a binary game log in the format of BinaryGameLogWriter (C#), chunkSize games per chunk.
+static string WriteLog(const char * name, const vector<Game> & games, const vector<Session> & sessions, int chunkSize,
+	size_t * firstChunkPos = 0)
+{
+	string fields;
+	WriteInt32(fields, 1);
+	WriteInt32(fields, 2);
+	WriteInt32(fields, 3);
+	WriteInt32(fields, 4);
+	WriteString(fields, "scm");
+	WriteString(fields, "build");
+	WriteString(fields, "GameLogScanner test data");
+	WriteString(fields, "");
+
+	string file;
+	WriteInt32(file, 5);
+	WriteInt32(file, (uint32_t)fields.size());
+	file += fields;
+	WriteInt32(file, ai::lib::utils::bds_version::crc32(fields.data(), fields.size()));
+	WriteInt32(file, 1);
+	Pad8(file);
+	if(firstChunkPos)
+	{
+		*firstChunkPos = file.size();
+	}
+
+	size_t s = 0;
+	for(size_t begin = 0; begin < games.size(); begin += chunkSize)
+	{
+		size_t end = min(games.size(), begin + chunkSize);
+		Strings strings;
+		vector<double> stack, blind, result, amount;
+		vector<int32_t> gameSession, gameId, gameActions, playerName, actionCards, metaGame, metaText,
+			sessionIndex, sessionGame, sessionName;
+		vector<uint8_t> gameFlags, gamePlayers, actionKind;
+		vector<int8_t> actionPosition;
+		for(size_t g = begin; g < end; ++g)
+		{
+			for(; s < sessions.size() && sessions[s].game == (int)g; ++s)
+			{
+				sessionIndex.push_back(sessions[s].index);
+				sessionGame.push_back((int32_t)(g - begin));
+				sessionName.push_back(strings.Add(sessions[s].name));
+				// The meta-data string is not interpreted by the scanner.
+				metaGame.push_back((int32_t)(g - begin));
+				metaText.push_back(strings.Add("OnSessionBegin Name='" + sessions[s].name + "'"));
+			}
+			const Game & game = games[g];
+			gameSession.push_back(game.session);
+			gameId.push_back(game.id.empty() ? -1 : strings.Add(game.id));
+			gameActions.push_back((int32_t)game.actions.size());
+			gameFlags.push_back(game.isGameOver ? 1 : 0);
+			gamePlayers.push_back((uint8_t)game.players.size());
+			for(size_t p = 0; p < game.players.size(); ++p)
+			{
+				stack.push_back(game.players[p].stack);
+				blind.push_back(game.players[p].blind);
+				result.push_back(game.players[p].result);
+				playerName.push_back(strings.Add(game.players[p].name));
+			}
+			for(size_t a = 0; a < game.actions.size(); ++a)
+			{
+				amount.push_back(game.actions[a].amount);
+				actionCards.push_back(game.actions[a].cards.empty() ? -1 : strings.Add(game.actions[a].cards));
+				actionKind.push_back(game.actions[a].kind);
+				actionPosition.push_back(game.actions[a].position);
+			}
+		}
+		WriteInt32(file, (uint32_t)gameSession.size());
+		WriteInt32(file, (uint32_t)playerName.size());
+		WriteInt32(file, (uint32_t)actionKind.size());
+		WriteInt32(file, (uint32_t)metaGame.size());
+		WriteInt32(file, (uint32_t)sessionIndex.size());
+		WriteInt32(file, (uint32_t)strings._offsets.size() - 1);
+		WriteInt32(file, (uint32_t)strings._bytes.size());
+		WriteInt32(file, 0);
+		Append(file, stack);
+		Append(file, blind);
+		Append(file, result);
+		Append(file, amount);
+		Append(file, gameSession);
+		Append(file, gameId);
+		Append(file, gameActions);
+		Append(file, playerName);
+		Append(file, actionCards);
+		Append(file, metaGame);
+		Append(file, metaText);
+		Append(file, sessionIndex);
+		Append(file, sessionGame);
+		Append(file, sessionName);
+		Append(file, strings._offsets);
+		Append(file, gameFlags);
+		Append(file, gamePlayers);
+		Append(file, actionKind);
+		Append(file, actionPosition);
+		file += strings._bytes;
+		Pad8(file);
+	}
+
+	string path = _tempDir + "/" + name;
+	FILE * f = fopen(path.c_str(), "wb");
+	VERIFY(f != 0);
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+	return path;
+}
+
+/// Creates random games, the players have random names of namesCount names.
+static void CreateRandomLog(Rng & rng, int gamesCount, int namesCount, vector<Game> & games, vector<Session> & sessions)
+{
+	games.clear();
+	sessions.clear();
+	int32_t session = 0;
+	const char * cards[] = {"Ac Ad", "Kh 7c", "? ?", "2h 3h 4h", "Js"};
+	for(int g = 0; g < gamesCount; ++g)
+	{
+		if(rng.Next(50) == 0)
+		{
+			Session s;
+			s.game = g;
+			s.index = ++session;
+			s.name = rng.Next(4) == 0 ? "" : "Session" + to_string(s.index);
+			sessions.push_back(s);
+		}
+		Game game;
+		game.session = session;
+		game.isGameOver = rng.Next(10) != 0;
+		game.id = to_string(g);
+		int playersCount = 2 + rng.Next(min(3, namesCount - 1));
+		vector<int> names;
+		while((int)names.size() < playersCount)
+		{
+			int n = rng.Next(namesCount);
+			if(find(names.begin(), names.end(), n) == names.end())
+			{
+				names.push_back(n);
+			}
+		}
+		double sum = 0;
+		for(int p = 0; p < playersCount; ++p)
+		{
+			Game::Player player;
+			player.name = "Player" + to_string(names[p]);
+			player.stack = 100;
+			player.blind = p < 2 ? p + 1 : 0;
+			player.result = p + 1 < playersCount ? (int)rng.Next(21) - 10 + 0.25 * rng.Next(4) : -sum;
+			sum += player.result;
+			game.players.push_back(player);
+		}
+		int actionsCount = rng.Next(8);
+		for(int a = 0; a < actionsCount; ++a)
+		{
+			Game::Action action;
+			action.kind = (uint8_t)rng.Next(5);
+			action.position = (int8_t)rng.Next(playersCount);
+			action.amount = rng.Next(3);
+			action.cards = action.kind == 1 ? cards[rng.Next(5)] : "";
+			game.actions.push_back(action);
+		}
+		games.push_back(game);
+	}
+}
+
+/// Serial calculation of the sessions, the same logic as TotalResult.Update().
+static void ScanReference(const vector<Game> & games, const vector<Session> & sessions, int64_t gameLimit,
+	map<int32_t, session_result> & result)
+{
+	result.clear();
+	for(size_t s = 0; s < sessions.size() && sessions[s].game < gameLimit; ++s)
+	{
+		result[sessions[s].index].name = sessions[s].name;
+	}
+	for(size_t g = 0; g < games.size() && (int64_t)g < gameLimit; ++g)
+	{
+		const Game & game = games[g];
+		session_result & s = result[game.session];
+		s.games_count++;
+		if(!game.isGameOver)
+		{
+			continue;
+		}
+		s.games_over_count++;
+		for(size_t pos = 0; pos < game.players.size(); ++pos)
+		{
+			player_result * p = 0;
+			for(size_t i = 0; i < s.players.size(); ++i)
+			{
+				if(s.players[i].name == game.players[pos].name)
+				{
+					p = &s.players[i];
+				}
+			}
+			if(p == 0)
+			{
+				s.players.push_back(player_result());
+				p = &s.players.back();
+				p->name = game.players[pos].name;
+				p->first_seat = (int64_t)g * 256 + (int64_t)pos;
+			}
+			if(pos >= p->games.size())
+			{
+				p->games.resize(pos + 1, 0);
+				p->result.resize(pos + 1, 0);
+			}
+			p->games[pos]++;
+			p->result[pos] += game.players[pos].result;
+		}
+	}
+}
+
+static void VerifySessions(const vector<session_result> & actual, const map<int32_t, session_result> & expected)
+{
+	VERIFY(actual.size() == expected.size());
+	map<int32_t, session_result>::const_iterator e = expected.begin();
+	for(size_t s = 0; s < actual.size(); ++s, ++e)
+	{
+		const session_result & a = actual[s];
+		VERIFY(a.index == e->first);
+		VERIFY(a.name == e->second.name);
+		VERIFY(a.games_count == e->second.games_count);
+		VERIFY(a.games_over_count == e->second.games_over_count);
+		VERIFY(a.players.size() == e->second.players.size());
+		for(size_t p = 0; p < a.players.size(); ++p)
+		{
+			const player_result & ap = a.players[p], & ep = e->second.players[p];
+			VERIFY(ap.name == ep.name);
+			VERIFY(ap.first_seat == ep.first_seat);
+			VERIFY(ap.games == ep.games);
+			for(size_t pos = 0; pos < ap.result.size(); ++pos)
+			{
+				VERIFY(fabs(ap.result[pos] - ep.result[pos]) < 1e-9);
+			}
+		}
+	}
+}
+
+/// Checks that all columns are read back.
+static void VerifyColumns(const game_log_file & file, const vector<Game> & games, const vector<Session> & sessions)
+{
+	VERIFY(file.games_count() == (int64_t)games.size());
+	size_t g = 0, s = 0;
+	for(size_t ci = 0; ci < file.chunks_count(); ++ci)
+	{
+		const game_log_chunk & c = file.chunk(ci);
+		VERIFY(c.first_game == (int64_t)g);
+		for(int32_t i = 0; i < c.sessions_count; ++i, ++s)
+		{
+			VERIFY(c.session_index[i] == sessions[s].index);
+			VERIFY(c.string(c.session_name[i]) == sessions[s].name);
+			VERIFY(c.session_game[i] + c.first_game == sessions[s].game);
+			VERIFY(c.meta_game[i] + c.first_game == sessions[s].game);
+		}
+		int32_t player = 0, action = 0;
+		for(int32_t i = 0; i < c.games_count; ++i, ++g)
+		{
+			const Game & game = games[g];
+			VERIFY(c.game_session[i] == game.session);
+			VERIFY(c.string(c.game_id[i]) == game.id);
+			VERIFY((c.game_flags[i] & 1) == (game.isGameOver ? 1 : 0));
+			VERIFY(c.game_players[i] == game.players.size());
+			VERIFY(c.game_actions[i] == (int32_t)game.actions.size());
+			for(size_t p = 0; p < game.players.size(); ++p, ++player)
+			{
+				VERIFY(c.string(c.player_name[player]) == game.players[p].name);
+				VERIFY(c.player_stack[player] == game.players[p].stack);
+				VERIFY(c.player_blind[player] == game.players[p].blind);
+				VERIFY(c.player_result[player] == game.players[p].result);
+			}
+			for(size_t a = 0; a < game.actions.size(); ++a, ++action)
+			{
+				VERIFY(c.action_kind[action] == game.actions[a].kind);
+				VERIFY(c.action_position[action] == game.actions[a].position);
+				VERIFY(c.action_amount[action] == game.actions[a].amount);
+				VERIFY(c.string(c.action_cards[action]) == game.actions[a].cards);
+			}
+		}
+		VERIFY(player == c.players_count);
+		VERIFY(action == c.actions_count);
+	}
+	VERIFY(g == games.size());
+	VERIFY(s == sessions.size());
+}
+
+static void Test_Scan()
+{
+	Rng rng(1);
+	const int chunkSizes[] = {1, 7, 100, 5000};
+	for(int t = 0; t < 4; ++t)
+	{
+		vector<Game> games;
+		vector<Session> sessions;
+		CreateRandomLog(rng, 1000 + rng.Next(1000), 3 + t * 2, games, sessions);
+		string path = WriteLog("GameLogScanner-test.bgl", games, sessions, chunkSizes[t]);
+		game_log_file file;
+		VERIFY(file.open(path.c_str()));
+		VerifyColumns(file, games, sessions);
+
+		const int64_t limits[] = {0, 1, 555, (int64_t)games.size(), INT64_MAX};
+		for(int l = 0; l < 5; ++l)
+		{
+			map<int32_t, session_result> expected;
+			ScanReference(games, sessions, limits[l], expected);
+			for(int threads = 1; threads <= 4; ++threads)
+			{
+				log_scanner scanner;
+				VERIFY(scanner.set_thread_count(threads));
+				VERIFY(scanner.scan(file, limits[l]));
+				VERIFY(scanner.games_count() == min<int64_t>(limits[l], games.size()));
+				VerifySessions(scanner.sessions(), expected);
+			}
+		}
+	}
+}
+
+static void Test_CApi()
+{
+	Rng rng(2);
+	vector<Game> games;
+	vector<Session> sessions;
+	CreateRandomLog(rng, 500, 4, games, sessions);
+	string path = WriteLog("GameLogScanner-capi.bgl", games, sessions, 64);
+	map<int32_t, session_result> expected;
+	ScanReference(games, sessions, 300, expected);
+
+	GameLogScanner * s = GameLogScanner_Open(path.c_str());
+	VERIFY(s != 0);
+	VERIFY(GameLogScanner_GetFileGamesCount(s) == 500);
+	VERIFY(GameLogScanner_Scan(s, 2, 300));
+	VERIFY(GameLogScanner_GetGamesCount(s) == 300);
+	VERIFY(GameLogScanner_GetSessionsCount(s) == (int)expected.size());
+	map<int32_t, session_result>::const_iterator e = expected.begin();
+	for(int i = 0; i < GameLogScanner_GetSessionsCount(s); ++i, ++e)
+	{
+		VERIFY(GameLogScanner_GetSessionIndex(s, i) == e->first);
+		VERIFY(e->second.name == GameLogScanner_GetSessionName(s, i));
+		int64_t gamesCount, gamesOverCount;
+		GameLogScanner_GetSessionGamesCount(s, i, &gamesCount, &gamesOverCount);
+		VERIFY(gamesCount == e->second.games_count);
+		VERIFY(gamesOverCount == e->second.games_over_count);
+		VERIFY(GameLogScanner_GetPlayersCount(s, i) == (int)e->second.players.size());
+		for(int p = 0; p < GameLogScanner_GetPlayersCount(s, i); ++p)
+		{
+			const player_result & ep = e->second.players[p];
+			VERIFY(ep.name == GameLogScanner_GetPlayerName(s, i, p));
+			VERIFY(GameLogScanner_GetPositionsCount(s, i, p) == (int)ep.games.size());
+			for(int pos = 0; pos < (int)ep.games.size(); ++pos)
+			{
+				int64_t playerGames;
+				double result;
+				GameLogScanner_GetPlayerResult(s, i, p, pos, &playerGames, &result);
+				VERIFY(playerGames == ep.games[pos]);
+				VERIFY(fabs(result - ep.result[pos]) < 1e-9);
+			}
+		}
+	}
+	VERIFY(!GameLogScanner_Scan(s, 0, 1));
+	VERIFY(strstr(GameLogScanner_GetLastError(), "threads") != 0);
+	GameLogScanner_Close(s);
+}
+
+/// Writes the games with game_log_writer (the native writer) and verifies them with game_log_file.
+static void Test_Writer()
+{
+	ai::lib::utils::bds_version version;
+	version.major = 1;
+	version.build = 70000;
+	version.description = "Binary game log";
+	// Longer than 127 bytes to test the 7-bit encoded length.
+	version.user_description = string(300, 'u');
+	string versionData;
+	version.write(versionData);
+	ai::lib::utils::bds_version versionRead;
+	VERIFY(versionRead.read(versionData.data(), versionData.size()) == versionData.size());
+	VERIFY(versionRead.major == 1 && versionRead.build == 70000);
+	VERIFY(versionRead.description == version.description);
+	VERIFY(versionRead.user_description == version.user_description);
+
+	Rng rng(3);
+	vector<Game> games;
+	vector<Session> sessions;
+	CreateRandomLog(rng, 3000, 5, games, sessions);
+	const int chunkSizes[] = {1, 7, 5000};
+	for(int t = 0; t < 3; ++t)
+	{
+		string path = _tempDir + "/GameLogWriter-test.bgl";
+		game_log_writer writer;
+		VERIFY(writer.open(path.c_str()));
+		game_log_chunk_builder chunk;
+		size_t s = 0;
+		for(size_t g = 0; g < games.size(); ++g)
+		{
+			for(; s < sessions.size() && sessions[s].game == (int)g; ++s)
+			{
+				chunk.begin_session(sessions[s].index, sessions[s].name);
+			}
+			const Game & game = games[g];
+			chunk.add_game(game.id, game.isGameOver);
+			for(size_t p = 0; p < game.players.size(); ++p)
+			{
+				const Game::Player & player = game.players[p];
+				chunk.add_player(player.name, player.stack, player.blind, player.result);
+			}
+			for(size_t a = 0; a < game.actions.size(); ++a)
+			{
+				const Game::Action & action = game.actions[a];
+				chunk.add_action((action_kind)action.kind, action.position, action.amount, action.cards);
+			}
+			if(chunk.games_count() == chunkSizes[t])
+			{
+				VERIFY(writer.write(chunk));
+				chunk.clear();
+			}
+		}
+		VERIFY(writer.write(chunk));
+		VERIFY(writer.games_count() == (int64_t)games.size());
+		VERIFY(writer.close());
+
+		game_log_file file;
+		VERIFY(file.open(path.c_str()));
+		VERIFY(file.chunks_count() == (games.size() + chunkSizes[t] - 1) / chunkSizes[t]);
+		VerifyColumns(file, games, sessions);
+	}
+
+	game_log_writer writer;
+	VERIFY(!writer.open((_tempDir + "/no-such-dir/x.bgl").c_str()));
+	VERIFY(strstr(writer.error().c_str(), "no-such-dir") != 0);
+}
+
+static void WriteFile(const string & path, const string & data)
+{
+	FILE * f = fopen(path.c_str(), "wb");
+	VERIFY(f != 0);
+	fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+}
+
+static string ReadFile(const string & path)
+{
+	FILE * f = fopen(path.c_str(), "rb");
+	VERIFY(f != 0);
+	string data;
+	char buf[4096];
+	size_t n;
+	while((n = fread(buf, 1, sizeof(buf), f)) > 0)
+	{
+		data.append(buf, n);
+	}
+	fclose(f);
+	return data;
+}
+
+static void Test_Errors()
+{
+	game_log_file file;
+	VERIFY(!file.open((_tempDir + "/no-such-file.bgl").c_str()));
+
+	string path = _tempDir + "/GameLogScanner-bad.bgl";
+	WriteFile(path, "not a game log");
+	VERIFY(!file.open(path.c_str()));
+	VERIFY(file.error().find("version") != string::npos);
+
+	Rng rng(3);
+	vector<Game> games;
+	vector<Session> sessions;
+	CreateRandomLog(rng, 100, 3, games, sessions);
+	size_t chunkPos;
+	string good = ReadFile(WriteLog("GameLogScanner-good.bgl", games, sessions, 50, &chunkPos));
+
+	// Truncated.
+	WriteFile(path, good.substr(0, good.size() - 20));
+	VERIFY(!file.open(path.c_str()));
+	VERIFY(file.error().find("unexpected end") != string::npos);
+	VERIFY(file.chunks_count() == 0);
+
+	// A wrong player name index (the first player column of the first chunk).
+	VERIFY(file.open((_tempDir + "/GameLogScanner-good.bgl").c_str()));
+	// The first column follows the chunk header.
+	size_t namePos = chunkPos + 32 + ((const char *)file.chunk(0).player_name - (const char *)file.chunk(0).player_stack);
+	file.close();
+	string bad = good;
+	int32_t wrongName = 1000000;
+	memcpy(&bad[namePos], &wrongName, 4);
+	WriteFile(path, bad);
+	VERIFY(file.open(path.c_str()));
+	log_scanner scanner;
+	VERIFY(!scanner.scan(file, INT64_MAX));
+	VERIFY(scanner.error().find("corrupt") != string::npos);
+	VERIFY(!scanner.set_thread_count(0));
+
+	VERIFY(GameLogScanner_Open((_tempDir + "/no-such-file.bgl").c_str()) == 0);
+	VERIFY(strstr(GameLogScanner_GetLastError(), "no-such-file") != 0);
+}
+
+static int Test()
+{
+	try
+	{
+		Test_Scan();
+		Test_CApi();
+		Test_Errors();
+		Test_Writer();
+	}
+	catch(const char * e)
+	{
+		printf("%s\n", e);
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+
+static int Stat(int threadsCount, const char * path)
+{
+	game_log_file file;
+	log_scanner scanner;
+	if(!file.open(path) || !scanner.set_thread_count(threadsCount) || !scanner.scan(file, INT64_MAX))
+	{
+		printf("%s\n", file.error().empty() ? scanner.error().c_str() : file.error().c_str());
+		return 1;
+	}
+	printf("%lld games\n", (long long)scanner.games_count());
+	map<string, pair<int64_t, double> > total;
+	vector<string> order;
+	for(size_t s = 0; s < scanner.sessions().size(); ++s)
+	{
+		const vector<player_result> & players = scanner.sessions()[s].players;
+		for(size_t p = 0; p < players.size(); ++p)
+		{
+			if(total.find(players[p].name) == total.end())
+			{
+				order.push_back(players[p].name);
+			}
+			pair<int64_t, double> & t = total[players[p].name];
+			for(size_t pos = 0; pos < players[p].games.size(); ++pos)
+			{
+				t.first += players[p].games[pos];
+				t.second += players[p].result[pos];
+			}
+		}
+	}
+	for(size_t i = 0; i < order.size(); ++i)
+	{
+		const pair<int64_t, double> & t = total[order[i]];
+		printf("%s: %.1f b, %.2f mb/g, %lld games\n", order[i].c_str(), t.second,
+			t.first ? 1000 * t.second / t.first : 0, (long long)t.first);
+	}
+	return 0;
+}
+
+static int Benchmark(int64_t gamesCount, int threadsCount)
+{
+	Rng rng(1);
+	vector<Game> pattern;
+	vector<Session> noSessions;
+	CreateRandomLog(rng, 10000, 6, pattern, noSessions);
+	// Heads-up games as in our matches, one session.
+	for(size_t g = 0; g < pattern.size(); ++g)
+	{
+		pattern[g].session = 0;
+		pattern[g].players.resize(2);
+		pattern[g].players[1].result = -pattern[g].players[0].result;
+	}
+	vector<Game> games;
+	for(int64_t g = 0; g < gamesCount; ++g)
+	{
+		games.push_back(pattern[g % pattern.size()]);
+		games.back().id = to_string(g);
+	}
+	string path = WriteLog("GameLogScanner-benchmark.bgl", games, noSessions, 65536);
+	games.clear();
+
+	game_log_file file;
+	VERIFY(file.open(path.c_str()));
+	const int threads[] = {1, threadsCount};
+	for(int t = 0; t < (threadsCount > 1 ? 2 : 1); ++t)
+	{
+		log_scanner scanner;
+		VERIFY(scanner.set_thread_count(threads[t]));
+		double start = Now();
+		VERIFY(scanner.scan(file, INT64_MAX));
+		double time = Now() - start;
+		printf("%d thread(s): %lld games, %.3f s, %.1f M games/s\n", threads[t],
+			(long long)scanner.games_count(), time, scanner.games_count() / time / 1e6);
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "test") == 0)
+	{
+		if(argc >= 3)
+		{
+			_tempDir = argv[2];
+		}
+		return Test();
+	}
+	if(argc >= 4 && strcmp(argv[1], "stat") == 0)
+	{
+		return Stat(atoi(argv[2]), argv[3]);
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark") == 0)
+	{
+		if(argc >= 5)
+		{
+			_tempDir = argv[4];
+		}
+		try
+		{
+			return Benchmark(argc >= 3 ? atoll(argv[2]) : 2000000, argc >= 4 ? atoi(argv[3]) : 4);
+		}
+		catch(const char * e)
+		{
+			printf("%s\n", e);
+			return 1;
+		}
+	}
+	printf("Usage:\n"
+		"%s test [temp-dir]\n"
+		"%s stat threads binary-log\n"
+		"%s benchmark [games] [threads] [temp-dir]\n", argv[0], argv[0], argv[0]);
+	return 1;
+}
@@ -0,0 +1,122 @@
+// ai.pkr.metatools.cpplib.cpp : Defines the exported functions of the library.
+//
+
+#include <string>
+#include "ai.pkr.metatools.cpplib.h"
+#include "game_log_file.h"
+#include "log_scanner.h"
+
+using namespace ai::pkr::metatools;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL char _lastError[256];
+
+static void SetError(const std::string & error)
+{
+	std::size_t length = error.copy(_lastError, sizeof(_lastError) - 1);
+	_lastError[length] = 0;
+}
+
+struct GameLogScanner
+{
+	game_log_file file;
+	log_scanner scanner;
+};
+
+extern "C"
+{
+
+AIPKRMETATOOLSCPPLIB_API GameLogScanner * GameLogScanner_Open(const char * fileName)
+{
+	GameLogScanner * s = new GameLogScanner;
+	if(!s->file.open(fileName))
+	{
+		SetError(s->file.error());
+		delete s;
+		return 0;
+	}
+	return s;
+}
+
+AIPKRMETATOOLSCPPLIB_API void GameLogScanner_Close(GameLogScanner * s)
+{
+	delete s;
+}
+
+AIPKRMETATOOLSCPPLIB_API const char * GameLogScanner_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRMETATOOLSCPPLIB_API int64_t GameLogScanner_GetFileGamesCount(const GameLogScanner * s)
+{
+	return s->file.games_count();
+}
+
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_Scan(GameLogScanner * s, int threadsCount, int64_t gameLimit)
+{
+	if(!s->scanner.set_thread_count(threadsCount) || !s->scanner.scan(s->file, gameLimit))
+	{
+		SetError(s->scanner.error());
+		return 0;
+	}
+	return 1;
+}
+
+AIPKRMETATOOLSCPPLIB_API int64_t GameLogScanner_GetGamesCount(const GameLogScanner * s)
+{
+	return s->scanner.games_count();
+}
+
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_GetSessionsCount(const GameLogScanner * s)
+{
+	return (int)s->scanner.sessions().size();
+}
+
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_GetSessionIndex(const GameLogScanner * s, int session)
+{
+	return s->scanner.sessions()[session].index;
+}
+
+AIPKRMETATOOLSCPPLIB_API const char * GameLogScanner_GetSessionName(const GameLogScanner * s, int session)
+{
+	return s->scanner.sessions()[session].name.c_str();
+}
+
+AIPKRMETATOOLSCPPLIB_API void GameLogScanner_GetSessionGamesCount(const GameLogScanner * s, int session,
+	int64_t * gamesCount, int64_t * gamesOverCount)
+{
+	const session_result & r = s->scanner.sessions()[session];
+	*gamesCount = r.games_count;
+	*gamesOverCount = r.games_over_count;
+}
+
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_GetPlayersCount(const GameLogScanner * s, int session)
+{
+	return (int)s->scanner.sessions()[session].players.size();
+}
+
+AIPKRMETATOOLSCPPLIB_API const char * GameLogScanner_GetPlayerName(const GameLogScanner * s, int session, int player)
+{
+	return s->scanner.sessions()[session].players[player].name.c_str();
+}
+
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_GetPositionsCount(const GameLogScanner * s, int session, int player)
+{
+	return (int)s->scanner.sessions()[session].players[player].games.size();
+}
+
+AIPKRMETATOOLSCPPLIB_API void GameLogScanner_GetPlayerResult(const GameLogScanner * s, int session, int player,
+	int position, int64_t * gamesCount, double * result)
+{
+	const player_result & p = s->scanner.sessions()[session].players[player];
+	*gamesCount = p.games[position];
+	*result = p.result[position];
+}
+
+}
@@ -0,0 +1,83 @@
+// C interface of ai.pkr.metatools.cpplib (ai.pkr.metatools.cpplib.dll on Windows,
+// libai.pkr.metatools.cpplib.so on Linux). Used by ai.pkr.metatools.CppLib (C#).
+//
+// All files within this library are compiled with the AIPKRMETATOOLSCPPLIB_EXPORTS
+// symbol defined. This symbol should not be defined on any project
+// that uses this library. This way any other project whose source files include
+// this file see AIPKRMETATOOLSCPPLIB_API functions as being imported, whereas the library
+// sees symbols defined with this macro as being exported.
+
+#ifndef AI_PKR_METATOOLS_CPPLIB_H
+#define AI_PKR_METATOOLS_CPPLIB_H
+
+#if defined(_WIN32)
+	#ifdef AIPKRMETATOOLSCPPLIB_EXPORTS
+		#define AIPKRMETATOOLSCPPLIB_API __declspec(dllexport)
+	#else
+		#define AIPKRMETATOOLSCPPLIB_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AIPKRMETATOOLSCPPLIB_API __attribute__((visibility("default")))
+#else
+	#define AIPKRMETATOOLSCPPLIB_API
+#endif
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Opaque handle of a scanner of a binary game log.
+typedef struct GameLogScanner GameLogScanner;
+
+/// Maps a binary game log written by BinaryGameLogWriter.
+/// Returns 0 on error, see GameLogScanner_GetLastError().
+AIPKRMETATOOLSCPPLIB_API GameLogScanner * GameLogScanner_Open(const char * fileName);
+
+AIPKRMETATOOLSCPPLIB_API void GameLogScanner_Close(GameLogScanner * s);
+
+/// Description of the last error in this thread.
+AIPKRMETATOOLSCPPLIB_API const char * GameLogScanner_GetLastError();
+
+/// Number of games in the file.
+AIPKRMETATOOLSCPPLIB_API int64_t GameLogScanner_GetFileGamesCount(const GameLogScanner * s);
+
+/// Calculates the game count, total and session results of the first gameLimit games
+/// with threadsCount threads. Returns 0 on error.
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_Scan(GameLogScanner * s, int threadsCount, int64_t gameLimit);
+
+/// Number of scanned games.
+AIPKRMETATOOLSCPPLIB_API int64_t GameLogScanner_GetGamesCount(const GameLogScanner * s);
+
+/// Number of sessions, they are sorted by the index in the file (0: the games before the first session begin).
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_GetSessionsCount(const GameLogScanner * s);
+
+/// Index of a session in the file.
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_GetSessionIndex(const GameLogScanner * s, int session);
+
+/// Name of a session (UTF-8), empty if unknown. Valid until the next scan.
+AIPKRMETATOOLSCPPLIB_API const char * GameLogScanner_GetSessionName(const GameLogScanner * s, int session);
+
+/// Number of all and of finished games of a session.
+AIPKRMETATOOLSCPPLIB_API void GameLogScanner_GetSessionGamesCount(const GameLogScanner * s, int session,
+	int64_t * gamesCount, int64_t * gamesOverCount);
+
+/// Number of players of a session, they are sorted by their first game and position.
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_GetPlayersCount(const GameLogScanner * s, int session);
+
+/// Name of a player (UTF-8). Valid until the next scan.
+AIPKRMETATOOLSCPPLIB_API const char * GameLogScanner_GetPlayerName(const GameLogScanner * s, int session, int player);
+
+/// Number of positions for which GameLogScanner_GetPlayerResult() returns data.
+AIPKRMETATOOLSCPPLIB_API int GameLogScanner_GetPositionsCount(const GameLogScanner * s, int session, int player);
+
+/// Number of finished games and the result of a player in a position.
+AIPKRMETATOOLSCPPLIB_API void GameLogScanner_GetPlayerResult(const GameLogScanner * s, int session, int player,
+	int position, int64_t * gamesCount, double * result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
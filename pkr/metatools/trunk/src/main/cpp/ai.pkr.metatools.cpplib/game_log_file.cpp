@@ -0,0 +1,135 @@
+#include <cstring>
+#include <ai.lib.utils.cpp/bds_version.h>
+#include "game_log_file.h"
+
+using namespace ai::lib::utils;
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metatools
+		{
+
+			namespace
+			{
+				std::size_t Align8(std::size_t pos)
+				{
+					return (pos + 7) & ~(std::size_t)7;
+				}
+
+				/// Sets a column and advances pos.
+				template<class T> void Column(const char * data, std::size_t & pos, int32_t count, const T * & column)
+				{
+					column = reinterpret_cast<const T *>(data + pos);
+					pos += sizeof(T) * (std::size_t)count;
+				}
+			}
+
+			bool game_log_file::open(const char * file_name)
+			{
+				close();
+				if(!_file.open(file_name, mapped_file::advice_sequential))
+				{
+					return fail(_file.error());
+				}
+				const char * data = _file.data();
+				std::size_t size = _file.size();
+				bds_version version;
+				std::size_t pos = version.read(data, size);
+				if(pos == 0)
+				{
+					return fail(std::string("wrong version in ") + file_name);
+				}
+				int32_t formatVersion;
+				if(pos + 4 > size)
+				{
+					return fail(std::string("cannot read header of ") + file_name);
+				}
+				memcpy(&formatVersion, data + pos, 4);
+				if(formatVersion != 1)
+				{
+					return fail(std::string("unsupported game log format in ") + file_name);
+				}
+				pos = Align8(pos + 4);
+
+				const std::size_t HEADER_SIZE = 8 * 4;
+				while(pos < size)
+				{
+					if(pos + HEADER_SIZE > size)
+					{
+						return fail(std::string("cannot read chunk header of ") + file_name);
+					}
+					int32_t h[8];
+					memcpy(h, data + pos, HEADER_SIZE);
+					for(int i = 0; i < 7; ++i)
+					{
+						if(h[i] < 0)
+						{
+							return fail(std::string("wrong chunk header in ") + file_name);
+						}
+					}
+					game_log_chunk c;
+					c.first_game = _games_count;
+					c.games_count = h[0];
+					c.players_count = h[1];
+					c.actions_count = h[2];
+					c.meta_count = h[3];
+					c.sessions_count = h[4];
+					c.strings_count = h[5];
+					const int32_t stringBytes = h[6];
+
+					// 64-bit arithmetic, the counts are checked against the file size before the columns are set.
+					uint64_t byteSize = 8ULL * (3ULL * c.players_count + c.actions_count)
+						+ 4ULL * (3ULL * c.games_count + c.players_count + c.actions_count + 2ULL * c.meta_count
+							+ 3ULL * c.sessions_count + c.strings_count + 1)
+						+ 2ULL * c.games_count + 2ULL * c.actions_count + (uint64_t)stringBytes;
+					pos += HEADER_SIZE;
+					if(byteSize > (uint64_t)(size - pos))
+					{
+						return fail(std::string("unexpected end of ") + file_name);
+					}
+					Column(data, pos, c.players_count, c.player_stack);
+					Column(data, pos, c.players_count, c.player_blind);
+					Column(data, pos, c.players_count, c.player_result);
+					Column(data, pos, c.actions_count, c.action_amount);
+					Column(data, pos, c.games_count, c.game_session);
+					Column(data, pos, c.games_count, c.game_id);
+					Column(data, pos, c.games_count, c.game_actions);
+					Column(data, pos, c.players_count, c.player_name);
+					Column(data, pos, c.actions_count, c.action_cards);
+					Column(data, pos, c.meta_count, c.meta_game);
+					Column(data, pos, c.meta_count, c.meta_text);
+					Column(data, pos, c.sessions_count, c.session_index);
+					Column(data, pos, c.sessions_count, c.session_game);
+					Column(data, pos, c.sessions_count, c.session_name);
+					Column(data, pos, c.strings_count + 1, c.string_offsets);
+					Column(data, pos, c.games_count, c.game_flags);
+					Column(data, pos, c.games_count, c.game_players);
+					Column(data, pos, c.actions_count, c.action_kind);
+					Column(data, pos, c.actions_count, c.action_position);
+					c.string_bytes = data + pos;
+					pos = Align8(pos + stringBytes);
+
+					// Only the string table is checked here (it is small),
+					// the other columns are checked by the users as they read them.
+					if(c.string_offsets[0] != 0 || c.string_offsets[c.strings_count] != stringBytes)
+					{
+						return fail(std::string("wrong string table in ") + file_name);
+					}
+					for(int32_t i = 0; i < c.strings_count; ++i)
+					{
+						if(c.string_offsets[i] > c.string_offsets[i + 1])
+						{
+							return fail(std::string("wrong string table in ") + file_name);
+						}
+					}
+					_chunks.push_back(c);
+					_games_count += c.games_count;
+				}
+				return true;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,136 @@
+#ifndef AI_PKR_METATOOLS_CPPLIB_GAME_LOG_FILE_H
+#define AI_PKR_METATOOLS_CPPLIB_GAME_LOG_FILE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <ai.lib.utils.cpp/mapped_file.h>
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metatools
+		{
+
+			/** A chunk of a binary game log, the columns point into the mapped file.
+			G games, P players, A actions, M meta-data strings, S sessions, N strings.
+			Players and actions of a game follow the ones of the previous game.
+			*/
+			struct game_log_chunk
+			{
+				/// Index of the first game of the chunk in the file.
+				int64_t first_game;
+
+				int32_t games_count;
+				int32_t players_count;
+				int32_t actions_count;
+				int32_t meta_count;
+				int32_t sessions_count;
+				int32_t strings_count;
+
+				// Columns of 8-byte values.
+				const double * player_stack;
+				const double * player_blind;
+				const double * player_result;
+				const double * action_amount;
+
+				// Columns of 4-byte values, strings are indexes in the string table of the chunk (-1: none).
+				const int32_t * game_session;
+				const int32_t * game_id;
+				const int32_t * game_actions;
+				const int32_t * player_name;
+				const int32_t * action_cards;
+				/// Meta-data meta_text[i] precedes game meta_game[i] (games_count: the end of the chunk).
+				const int32_t * meta_game;
+				const int32_t * meta_text;
+				/// A session with index session_index[i] (global in the file) begins before game session_game[i].
+				const int32_t * session_index;
+				const int32_t * session_game;
+				const int32_t * session_name;
+				/// String i is string_bytes[string_offsets[i] .. string_offsets[i + 1] - 1], UTF-8.
+				const int32_t * string_offsets;
+
+				// Columns of 1-byte values.
+				/// Bit 0: game over.
+				const uint8_t * game_flags;
+				const uint8_t * game_players;
+				/// Ak (C#).
+				const uint8_t * action_kind;
+				const int8_t * action_position;
+
+				const char * string_bytes;
+
+				std::string string(int32_t i) const
+				{
+					return i < 0 ? std::string() :
+						std::string(string_bytes + string_offsets[i], string_bytes + string_offsets[i + 1]);
+				}
+			};
+
+			/** A binary game log written by BinaryGameLogWriter (C#). The file is memory-mapped,
+			the chunks are independent and can be processed in parallel.
+
+			Format: BdsVersion, int32 format version (1), zero padding to a multiple of 8 bytes, chunks.
+			A chunk: 8 int32 (games, players, actions, meta-data, sessions, strings count, string bytes, 0),
+			the columns in the order of game_log_chunk, the string bytes, zero padding to a multiple of 8 bytes.
+			*/
+			class game_log_file
+			{
+			public:
+				game_log_file() : _games_count(0)
+				{
+				}
+
+				/** Maps the file and indexes the chunks.
+				@return false on error, see error().
+				*/
+				bool open(const char * file_name);
+
+				void close()
+				{
+					_chunks.clear();
+					_games_count = 0;
+					_file.close();
+				}
+
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				std::size_t chunks_count() const
+				{
+					return _chunks.size();
+				}
+
+				const game_log_chunk & chunk(std::size_t i) const
+				{
+					return _chunks[i];
+				}
+
+				int64_t games_count() const
+				{
+					return _games_count;
+				}
+
+			private:
+				bool fail(const std::string & error)
+				{
+					_error = error;
+					close();
+					return false;
+				}
+
+				std::vector<game_log_chunk> _chunks;
+				int64_t _games_count;
+				ai::lib::utils::mapped_file _file;
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
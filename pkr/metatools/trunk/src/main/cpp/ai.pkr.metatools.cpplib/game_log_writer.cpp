@@ -0,0 +1,229 @@
+#include <cstring>
+#include <ai.lib.utils.cpp/bds_version.h>
+#include "game_log_writer.h"
+
+using namespace ai::lib::utils;
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metatools
+		{
+
+			namespace
+			{
+				void Pad8(std::string & out)
+				{
+					out.append((8 - out.size() % 8) % 8, (char)0);
+				}
+
+				template<class T> void Append(std::string & out, const std::vector<T> & column)
+				{
+					if(!column.empty())
+					{
+						out.append(reinterpret_cast<const char *>(&column[0]), column.size() * sizeof(T));
+					}
+				}
+
+				void AppendInt32(std::string & out, int32_t v)
+				{
+					out.append(reinterpret_cast<const char *>(&v), 4);
+				}
+			}
+
+			void game_log_chunk_builder::clear()
+			{
+				_stack.clear();
+				_blind.clear();
+				_result.clear();
+				_amount.clear();
+				_game_session.clear();
+				_game_id.clear();
+				_game_actions.clear();
+				_player_name.clear();
+				_action_cards.clear();
+				_meta_game.clear();
+				_meta_text.clear();
+				_session_index.clear();
+				_session_game.clear();
+				_session_name.clear();
+				_game_flags.clear();
+				_game_players.clear();
+				_action_kind.clear();
+				_action_position.clear();
+				_strings.clear();
+				_string_offsets.clear();
+				_string_bytes.clear();
+			}
+
+			void game_log_chunk_builder::add_meta_data(const std::string & text)
+			{
+				_meta_game.push_back(games_count());
+				_meta_text.push_back(add_string(text));
+			}
+
+			void game_log_chunk_builder::begin_session(int32_t index, const std::string & name)
+			{
+				add_meta_data("OnSessionBegin Name='" + name + "' Repetition='0'");
+				_session = index;
+				_session_index.push_back(index);
+				_session_game.push_back(games_count());
+				_session_name.push_back(add_string(name));
+			}
+
+			void game_log_chunk_builder::add_game(const std::string & id, bool is_game_over)
+			{
+				_game_session.push_back(_session);
+				_game_id.push_back(id.empty() ? -1 : add_string(id));
+				_game_actions.push_back(0);
+				_game_flags.push_back(is_game_over ? 1 : 0);
+				_game_players.push_back(0);
+			}
+
+			void game_log_chunk_builder::add_player(const std::string & name, double stack, double blind, double result)
+			{
+				_stack.push_back(stack);
+				_blind.push_back(blind);
+				_result.push_back(result);
+				_player_name.push_back(add_string(name));
+				_game_players.back()++;
+			}
+
+			void game_log_chunk_builder::add_action(action_kind kind, int position, double amount, const std::string & cards)
+			{
+				_amount.push_back(amount);
+				_action_cards.push_back(cards.empty() ? -1 : add_string(cards));
+				_action_kind.push_back((uint8_t)kind);
+				_action_position.push_back((int8_t)position);
+				_game_actions.back()++;
+			}
+
+			int32_t game_log_chunk_builder::add_string(const std::string & s)
+			{
+				std::pair<std::unordered_map<std::string, int32_t>::iterator, bool> r =
+					_strings.insert(std::make_pair(s, (int32_t)_strings.size()));
+				if(r.second)
+				{
+					if(_string_offsets.empty())
+					{
+						_string_offsets.push_back(0);
+					}
+					_string_bytes += s;
+					_string_offsets.push_back((int32_t)_string_bytes.size());
+				}
+				return r.first->second;
+			}
+
+			void game_log_chunk_builder::serialize(std::string & out) const
+			{
+				AppendInt32(out, (int32_t)_game_session.size());
+				AppendInt32(out, (int32_t)_player_name.size());
+				AppendInt32(out, (int32_t)_action_kind.size());
+				AppendInt32(out, (int32_t)_meta_game.size());
+				AppendInt32(out, (int32_t)_session_index.size());
+				AppendInt32(out, (int32_t)_strings.size());
+				AppendInt32(out, (int32_t)_string_bytes.size());
+				AppendInt32(out, 0);
+				Append(out, _stack);
+				Append(out, _blind);
+				Append(out, _result);
+				Append(out, _amount);
+				Append(out, _game_session);
+				Append(out, _game_id);
+				Append(out, _game_actions);
+				Append(out, _player_name);
+				Append(out, _action_cards);
+				Append(out, _meta_game);
+				Append(out, _meta_text);
+				Append(out, _session_index);
+				Append(out, _session_game);
+				Append(out, _session_name);
+				if(_string_offsets.empty())
+				{
+					AppendInt32(out, 0);
+				}
+				else
+				{
+					Append(out, _string_offsets);
+				}
+				Append(out, _game_flags);
+				Append(out, _game_players);
+				Append(out, _action_kind);
+				Append(out, _action_position);
+				out += _string_bytes;
+				Pad8(out);
+			}
+
+			bool game_log_writer::open(const char * file_name)
+			{
+				close();
+				_file_name = file_name;
+				_file = fopen(file_name, "wb");
+				if(!_file)
+				{
+					return fail(std::string("cannot create ") + file_name);
+				}
+				bds_version version;
+				version.description = "Binary game log";
+				_buffer.clear();
+				version.write(_buffer);
+				// Format version, see BinaryGameLogWriter.FormatVersion (C#).
+				AppendInt32(_buffer, 1);
+				Pad8(_buffer);
+				if(fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size())
+				{
+					return fail(std::string("cannot write ") + file_name);
+				}
+				return true;
+			}
+
+			bool game_log_writer::write(const game_log_chunk_builder & chunk)
+			{
+				if(!_file)
+				{
+					return fail("the game log is not open");
+				}
+				if(chunk.empty())
+				{
+					return true;
+				}
+				_buffer.clear();
+				chunk.serialize(_buffer);
+				if(fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size())
+				{
+					return fail(std::string("cannot write ") + _file_name);
+				}
+				_games_count += chunk.games_count();
+				return true;
+			}
+
+			bool game_log_writer::close()
+			{
+				if(!_file)
+				{
+					return true;
+				}
+				bool ok = fclose(_file) == 0;
+				_file = 0;
+				if(!ok)
+				{
+					_error = std::string("cannot write ") + _file_name;
+				}
+				return ok;
+			}
+
+			bool game_log_writer::fail(const std::string & error)
+			{
+				if(_file)
+				{
+					fclose(_file);
+					_file = 0;
+				}
+				_error = error;
+				return false;
+			}
+
+		}
+	}
+}
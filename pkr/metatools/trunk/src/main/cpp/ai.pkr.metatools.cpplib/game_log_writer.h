@@ -0,0 +1,151 @@
+#ifndef AI_PKR_METATOOLS_CPPLIB_GAME_LOG_WRITER_H
+#define AI_PKR_METATOOLS_CPPLIB_GAME_LOG_WRITER_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metatools
+		{
+
+			/// Action kinds, the values of Ak (C#).
+			enum action_kind
+			{
+				ak_b = 0,
+				ak_d = 1,
+				ak_f = 2,
+				ak_c = 3,
+				ak_r = 4
+			};
+
+			/** Builds a chunk of a binary game log in memory (see game_log_file for the format).
+			The chunks are self-contained, so that native game producers can build them in parallel
+			and write them in order with game_log_writer.
+
+			Usage: begin_session() (optional), then for each game add_game(), add_player() for each player,
+			add_action() for each action.
+			*/
+			class game_log_chunk_builder
+			{
+			public:
+				game_log_chunk_builder() : _session(0)
+				{
+				}
+
+				/// Removes the data, keeps the current session.
+				void clear();
+
+				int32_t games_count() const
+				{
+					return (int32_t)_game_session.size();
+				}
+
+				/// True if there are no games and no meta-data.
+				bool empty() const
+				{
+					return _game_session.empty() && _meta_game.empty();
+				}
+
+				/// Adds meta-data before the next game.
+				void add_meta_data(const std::string & text);
+
+				/** Begins session index (numbered by the producer, global in the file) before the next game,
+				adds the OnSessionBegin meta-data like BinaryGameLogWriter.WriteMetaData() (C#).
+				*/
+				void begin_session(int32_t index, const std::string & name);
+
+				/// Sets the session of the next games without beginning it (a session continued from another chunk).
+				void set_session(int32_t index)
+				{
+					_session = index;
+				}
+
+				/// Adds a game of the current session, an empty id is not stored.
+				void add_game(const std::string & id, bool is_game_over);
+
+				/// Adds a player to the last game.
+				void add_player(const std::string & name, double stack, double blind, double result);
+
+				/// Adds an action to the last game (position -1 for shared cards, empty cards are not stored).
+				void add_action(action_kind kind, int position, double amount, const std::string & cards);
+
+				/// Appends the chunk in the file format (the size is a multiple of 8 bytes) to out.
+				void serialize(std::string & out) const;
+
+			private:
+				int32_t add_string(const std::string & s);
+
+				int32_t _session;
+				std::vector<double> _stack, _blind, _result, _amount;
+				std::vector<int32_t> _game_session, _game_id, _game_actions, _player_name, _action_cards,
+					_meta_game, _meta_text, _session_index, _session_game, _session_name;
+				std::vector<uint8_t> _game_flags, _game_players, _action_kind;
+				std::vector<int8_t> _action_position;
+				std::unordered_map<std::string, int32_t> _strings;
+				std::vector<int32_t> _string_offsets;
+				std::string _string_bytes;
+			};
+
+			/** Writes a binary game log, the native counterpart of BinaryGameLogWriter (C#).
+			The file can be read by BinaryGameLogReader, BinaryGameLogScanner and game_log_file.
+			*/
+			class game_log_writer
+			{
+			public:
+				game_log_writer() : _file(0), _games_count(0)
+				{
+				}
+
+				~game_log_writer()
+				{
+					close();
+				}
+
+				/** Creates the file and writes the header.
+				@return false on error, see error().
+				*/
+				bool open(const char * file_name);
+
+				/// Writes a chunk, an empty() chunk is skipped.
+				bool write(const game_log_chunk_builder & chunk);
+
+				/// Closes the file, returns false if it cannot be flushed.
+				bool close();
+
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				int64_t games_count() const
+				{
+					return _games_count;
+				}
+
+			private:
+				bool fail(const std::string & error);
+
+				// Not copyable.
+				game_log_writer(const game_log_writer &);
+				game_log_writer & operator = (const game_log_writer &);
+
+				FILE * _file;
+				std::string _file_name;
+				int64_t _games_count;
+				/// Serialized chunk, a member to reuse the memory.
+				std::string _buffer;
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
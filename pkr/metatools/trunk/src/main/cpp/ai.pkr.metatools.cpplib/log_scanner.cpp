@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <map>
+#include "log_scanner.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metatools
+		{
+
+			namespace
+			{
+				/// Partial result of a session, players by name.
+				struct session_acc
+				{
+					session_acc() : games_count(0), games_over_count(0)
+					{
+					}
+
+					std::string name;
+					int64_t games_count;
+					int64_t games_over_count;
+					std::map<std::string, player_result> players;
+				};
+
+				typedef std::map<int32_t, session_acc> sessions_acc;
+
+				void UpdatePlayer(player_result & p, int pos, double result)
+				{
+					if(pos >= (int)p.games.size())
+					{
+						p.games.resize(pos + 1, 0);
+						p.result.resize(pos + 1, 0);
+					}
+					p.games[pos]++;
+					p.result[pos] += result;
+				}
+
+				/// Adds the results of the first end games of the chunk to acc. Returns false if the chunk is corrupt.
+				bool ScanChunk(const game_log_chunk & c, int32_t end, sessions_acc & acc)
+				{
+					for(int32_t i = 0; i < c.sessions_count && c.session_game[i] < end; ++i)
+					{
+						if(c.session_name[i] >= c.strings_count)
+						{
+							return false;
+						}
+						acc[c.session_index[i]].name = c.string(c.session_name[i]);
+					}
+
+					// Player of each name string of the chunk in the current session.
+					std::vector<player_result *> players((std::size_t)c.strings_count, 0);
+					session_acc * session = 0;
+					int32_t sessionIndex = -1;
+					int32_t player = 0;
+					for(int32_t g = 0; g < end; ++g)
+					{
+						const int32_t playersCount = c.game_players[g];
+						if(player + playersCount > c.players_count)
+						{
+							return false;
+						}
+						if(!(c.game_flags[g] & 1))
+						{
+							acc[c.game_session[g]].games_count++;
+							player += playersCount;
+							continue;
+						}
+						if(c.game_session[g] != sessionIndex || session == 0)
+						{
+							sessionIndex = c.game_session[g];
+							session = &acc[sessionIndex];
+							std::fill(players.begin(), players.end(), (player_result *)0);
+						}
+						session->games_count++;
+						session->games_over_count++;
+						const int64_t game = c.first_game + g;
+						for(int pos = 0; pos < playersCount; ++pos, ++player)
+						{
+							const int32_t name = c.player_name[player];
+							if(name < 0 || name >= c.strings_count)
+							{
+								return false;
+							}
+							player_result * & p = players[name];
+							if(p == 0)
+							{
+								p = &session->players[c.string(name)];
+								if(p->games.empty())
+								{
+									p->name = c.string(name);
+									p->first_seat = game * 256 + pos;
+								}
+							}
+							UpdatePlayer(*p, pos, c.player_result[player]);
+						}
+					}
+					return true;
+				}
+
+				void Merge(sessions_acc & to, sessions_acc & from)
+				{
+					for(sessions_acc::iterator s = from.begin(); s != from.end(); ++s)
+					{
+						session_acc & session = to[s->first];
+						if(!s->second.name.empty())
+						{
+							session.name = s->second.name;
+						}
+						session.games_count += s->second.games_count;
+						session.games_over_count += s->second.games_over_count;
+						for(std::map<std::string, player_result>::iterator p = s->second.players.begin();
+							p != s->second.players.end(); ++p)
+						{
+							player_result & player = session.players[p->first];
+							if(player.games.empty())
+							{
+								player.name = p->first;
+								player.first_seat = p->second.first_seat;
+							}
+							player.first_seat = std::min(player.first_seat, p->second.first_seat);
+							if(player.games.size() < p->second.games.size())
+							{
+								player.games.resize(p->second.games.size(), 0);
+								player.result.resize(p->second.games.size(), 0);
+							}
+							for(std::size_t pos = 0; pos < p->second.games.size(); ++pos)
+							{
+								player.games[pos] += p->second.games[pos];
+								player.result[pos] += p->second.result[pos];
+							}
+						}
+					}
+					from.clear();
+				}
+
+				bool ByFirstSeat(const player_result & a, const player_result & b)
+				{
+					return a.first_seat < b.first_seat;
+				}
+			}
+
+			bool log_scanner::set_thread_count(int thread_count)
+			{
+				if(thread_count < 1)
+				{
+					return fail("the number of threads must be positive");
+				}
+				_thread_count = thread_count;
+				return true;
+			}
+
+			bool log_scanner::scan(const game_log_file & file, int64_t game_limit)
+			{
+				_sessions.clear();
+				_games_count = 0;
+				if(game_limit < 0)
+				{
+					return fail("the game limit must not be negative");
+				}
+				const int64_t gamesEnd = std::min(game_limit, file.games_count());
+				int chunksCount = 0;
+				while(chunksCount < (int)file.chunks_count() && file.chunk(chunksCount).first_game < gamesEnd)
+				{
+					++chunksCount;
+				}
+
+				sessions_acc total;
+				bool isCorrupt = false;
+#ifdef _OPENMP
+				#pragma omp parallel num_threads(_thread_count)
+#endif
+				{
+					sessions_acc threadAcc;
+					bool isThreadCorrupt = false;
+#ifdef _OPENMP
+					#pragma omp for schedule(dynamic, 1)
+#endif
+					for(int i = 0; i < chunksCount; ++i)
+					{
+						const game_log_chunk & c = file.chunk(i);
+						int32_t end = (int32_t)std::min<int64_t>(c.games_count, gamesEnd - c.first_game);
+						if(!ScanChunk(c, end, threadAcc))
+						{
+							isThreadCorrupt = true;
+						}
+					}
+#ifdef _OPENMP
+					#pragma omp critical
+#endif
+					{
+						Merge(total, threadAcc);
+						isCorrupt = isCorrupt || isThreadCorrupt;
+					}
+				}
+				if(isCorrupt)
+				{
+					return fail("the game log is corrupt");
+				}
+
+				for(sessions_acc::iterator s = total.begin(); s != total.end(); ++s)
+				{
+					session_result session;
+					session.index = s->first;
+					session.name = s->second.name;
+					session.games_count = s->second.games_count;
+					session.games_over_count = s->second.games_over_count;
+					for(std::map<std::string, player_result>::iterator p = s->second.players.begin();
+						p != s->second.players.end(); ++p)
+					{
+						session.players.push_back(p->second);
+					}
+					std::sort(session.players.begin(), session.players.end(), ByFirstSeat);
+					_sessions.push_back(session);
+				}
+				_games_count = gamesEnd;
+				return true;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,100 @@
+#ifndef AI_PKR_METATOOLS_CPPLIB_LOG_SCANNER_H
+#define AI_PKR_METATOOLS_CPPLIB_LOG_SCANNER_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "game_log_file.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace metatools
+		{
+
+			/// Result of a player in a session, the same data as TotalResult.Player (C#).
+			struct player_result
+			{
+				std::string name;
+				/// First game * 256 + position of the player in the session, gives the order of the players.
+				int64_t first_seat;
+				/// Number of finished games by position.
+				std::vector<int64_t> games;
+				/// Result by position.
+				std::vector<double> result;
+			};
+
+			/// Result of a session (the games between two session begins).
+			struct session_result
+			{
+				/// Index of the session in the file, 0 for the games before the first session begin.
+				int32_t index;
+				/// Name of the session, empty if unknown.
+				std::string name;
+				/// Number of all games.
+				int64_t games_count;
+				/// Number of finished games (TotalResult.GamesCount).
+				int64_t games_over_count;
+				/// Players in the order of their first game and position (as added to TotalResult).
+				std::vector<player_result> players;
+			};
+
+			/** Calculates the reports of pkrlogstat (game count, total and session results)
+			on a binary game log. The chunks are scanned in parallel, each thread aggregates
+			its chunks, then the results of the threads are merged.
+			Only the columns needed for the reports are read.
+			*/
+			class log_scanner
+			{
+			public:
+				log_scanner() : _thread_count(1), _games_count(0)
+				{
+				}
+
+				/// Sets the number of threads, default: 1.
+				bool set_thread_count(int thread_count);
+
+				/** Scans the first game_limit games of the file.
+				@return false on error, see error().
+				*/
+				bool scan(const game_log_file & file, int64_t game_limit);
+
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				/// Number of scanned games.
+				int64_t games_count() const
+				{
+					return _games_count;
+				}
+
+				/// Sessions sorted by index.
+				const std::vector<session_result> & sessions() const
+				{
+					return _sessions;
+				}
+
+			private:
+				bool fail(const std::string & error)
+				{
+					_error = error;
+					_sessions.clear();
+					_games_count = 0;
+					return false;
+				}
+
+				int _thread_count;
+				int64_t _games_count;
+				std::vector<session_result> _sessions;
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
@@ -65,6 +65,14 @@ namespace ai.pkr.metatools.pkrlogstat
         DefaultValue = null, HelpText = "Report output file. Default: stdout.")]
         public string Output = null;
 
+        [Argument(ArgumentType.AtMostOnce, LongName = "binary", ShortName = "b",
+        DefaultValue = false, HelpText = "Input paths are binary game logs (see pkrlogtransform --binary). Total and session results are calculated by the native scanner unless a report class is specified.")]
+        public bool Binary;
+
+        [Argument(ArgumentType.AtMostOnce, LongName = "threads", ShortName = "",
+        DefaultValue = 0, HelpText = "Number of threads to scan binary game logs, 0: number of processors.")]
+        public int Threads = 0;
+
         [Argument(ArgumentType.AtMostOnce, LongName = "game-limit", ShortName = "",
         DefaultValue = int.MaxValue, HelpText = "Analyze up to N games.")]
         public int GameLimit = int.MaxValue;
@@ -47,6 +47,8 @@ namespace ai.pkr.metatools.pkrlogstat
             GameLogParser logParser = new GameLogParser{Verbose = _cmdLine.Verbose, IncludeFiles = _cmdLine.IncludeFiles};
             logParser.OnGameRecord += new GameLogParser.OnGameRecordHandler(logParser_OnGameRecord);
             logParser.OnMetaData += new GameLogParser.OnMetaDataHandler(logParser_OnMetaData);
+            _binaryReader.OnGameRecord += (source, gameRecord) => OnGameRecord(source.GamesCount, gameRecord);
+            _binaryReader.OnMetaData += (source, metaData) => OnMetaData(GameLogMetaData.Parse(metaData));
 
             if (_cmdLine.TotalResult)
             {
@@ -62,13 +64,24 @@ namespace ai.pkr.metatools.pkrlogstat
             }
             _sessionGamesCount = 0;
 
-            if (_cmdLine.CountGames || _cmdLine.TotalResult || _cmdLine.SessionResult)
+            if (_cmdLine.Binary && String.IsNullOrEmpty(_cmdLine.ReportClass))
+            {
+                ScanBinaryLogs();
+            }
+            else if (_cmdLine.CountGames || _cmdLine.TotalResult || _cmdLine.SessionResult)
             {
                 foreach (string path in _cmdLine.InputPaths)
                 {
                     try
                     {
-                        logParser.ParsePath(path);
+                        if (_cmdLine.Binary)
+                        {
+                            _binaryReader.Read(path);
+                        }
+                        else
+                        {
+                            logParser.ParsePath(path);
+                        }
                     }
                     catch (GameLimitException )
                     {
@@ -90,7 +103,15 @@ namespace ai.pkr.metatools.pkrlogstat
             // Print game count after session result, so that results are not interrupted.
             if (_cmdLine.CountGames)
             {
-                _output.WriteLine("{0} games in {1} files, {2} errors", logParser.GamesCount, logParser.FilesCount, logParser.ErrorCount);
+                if (_cmdLine.Binary)
+                {
+                    _output.WriteLine("{0} games in {1} files, {2} errors", 
+                        Math.Min(_binaryGamesCount + _binaryReader.GamesCount, _cmdLine.GameLimit), _cmdLine.InputPaths.Length, 0);
+                }
+                else
+                {
+                    _output.WriteLine("{0} games in {1} files, {2} errors", logParser.GamesCount, logParser.FilesCount, logParser.ErrorCount);
+                }
             }
 
             double sec = (DateTime.Now - start).TotalSeconds;
@@ -130,6 +151,59 @@ namespace ai.pkr.metatools.pkrlogstat
             return rep;
         }
 
+        /// <summary>
+        /// Calculates the game count, total and session results of binary logs by the native scanner.
+        /// The sessions are continued across the files as in text logs.
+        /// </summary>
+        static void ScanBinaryLogs()
+        {
+            foreach (string path in _cmdLine.InputPaths)
+            {
+                if (_binaryGamesCount >= _cmdLine.GameLimit)
+                {
+                    break;
+                }
+                using (BinaryGameLogScanner scanner = new BinaryGameLogScanner(path))
+                {
+                    if (_cmdLine.Threads > 0)
+                    {
+                        scanner.ThreadsCount = _cmdLine.Threads;
+                    }
+                    scanner.Scan(_cmdLine.GameLimit - _binaryGamesCount);
+                    _binaryGamesCount += scanner.GamesCount;
+                    foreach (BinaryGameLogScanner.Session session in scanner.Sessions)
+                    {
+                        if (session.Index > 0)
+                        {
+                            BeginSession(session.Name);
+                        }
+                        if (_sessionResult != null)
+                        {
+                            ((TotalResult)_sessionResult).UpdateByTotalResult(session.Result);
+                        }
+                        if (_totalResult != null)
+                        {
+                            ((TotalResult)_totalResult).UpdateByTotalResult(session.Result);
+                        }
+                        _sessionGamesCount += (int)session.GamesCount;
+                    }
+                }
+            }
+        }
+
+        static void BeginSession(string name)
+        {
+            if (_cmdLine.SessionResult && _sessionGamesCount > 0)
+            {
+                _sessionResult.Print(_output);
+            }
+            if (_cmdLine.SessionResult)
+            {
+                _sessionResult = CreateGameLogReport(String.IsNullOrEmpty(name) ? "Unnamed session" : name);
+            }
+            _sessionGamesCount = 0;
+        }
+
         static void  logParser_OnMetaData(GameLogParser source, string metaData)
         {
             GameLogMetaData md = GameLogMetaData.Parse(metaData);
@@ -138,30 +212,26 @@ namespace ai.pkr.metatools.pkrlogstat
                 source.ErrorCount++;
                 Console.Error.WriteLine(source.GetDefaultErrorText("Unknown metadata: " + metaData));
             }
-            if(md.Name == "OnSessionBegin")
+            OnMetaData(md);
+        }
+
+        static void OnMetaData(GameLogMetaData md)
+        {
+            string sessionName;
+            if (md != null && md.IsSessionBegin(out sessionName))
             {
-                if(!md.Properties.ContainsKey("Repetition") || int.Parse(md.Properties["Repetition"]) == 0)
-                {
-                    // The very first repetition.
-                    if (_cmdLine.SessionResult && _sessionGamesCount > 0)
-                    {
-                        _sessionResult.Print(_output);
-                    }
-                    if (_cmdLine.SessionResult)
-                    {
-                        _sessionResult =
-                            CreateGameLogReport(md.Properties.ContainsKey("Name")
-                                                    ? md.Properties["Name"]
-                                                    : "Unnamed session");
-                    }
-                    _sessionGamesCount = 0;
-                }
+                BeginSession(sessionName);
             }
         }
 
         static void logParser_OnGameRecord(GameLogParser source, GameRecord gameRecord)
         {
-            if (source.GamesCount > _cmdLine.GameLimit)
+            OnGameRecord(source.GamesCount, gameRecord);
+        }
+
+        static void OnGameRecord(long gamesCount, GameRecord gameRecord)
+        {
+            if (gamesCount > _cmdLine.GameLimit)
             {
                 throw new GameLimitException();
             }
@@ -182,6 +252,8 @@ namespace ai.pkr.metatools.pkrlogstat
         private static IGameLogReport _totalResult;
         private static IGameLogReport _sessionResult;
         static private int _sessionGamesCount = 0;
+        private static BinaryGameLogReader _binaryReader = new BinaryGameLogReader();
+        private static long _binaryGamesCount = 0;
         private static Props _reportParameters = new Props();
         private static TextWriter _output = Console.Out;
         private static bool _isHelpShown = false;
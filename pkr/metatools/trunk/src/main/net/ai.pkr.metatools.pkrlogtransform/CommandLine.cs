@@ -32,9 +32,13 @@ Renames are done before other usages of player names. Order: eq, neq. Only one r
         public bool Verbose;
 
         [Argument(ArgumentType.AtMostOnce, LongName = "output", ShortName = "o",
-        DefaultValue = null, HelpText = "Output file. Default: 'InputFileName-tr.ext'.")]
+        DefaultValue = null, HelpText = "Output file. Default: 'InputFileName-tr.ext' ('InputFileName.bgl' with --binary).")]
         public string Output = null;
 
+        [Argument(ArgumentType.AtMostOnce, LongName = "binary", ShortName = "b",
+        DefaultValue = false, HelpText = "Write a binary game log (see BinaryGameLogWriter), it can be analyzed by pkrlogstat --binary.")]
+        public bool Binary;
+
         [Argument(ArgumentType.AtMostOnce, LongName = "game-limit", ShortName = "",
         DefaultValue = int.MaxValue, HelpText = "Analyze up to N games.")]
         public int GameLimit = int.MaxValue;
@@ -31,10 +31,17 @@ namespace ai.pkr.metatools.pkrlogtransform
             if (String.IsNullOrEmpty(_outputName))
             {
                 _outputName = Path.Combine(Path.GetDirectoryName(_cmdLine.InputFile), Path.GetFileNameWithoutExtension(_cmdLine.InputFile));
-                _outputName += "-tr" + Path.GetExtension(_cmdLine.InputFile);
+                _outputName += _cmdLine.Binary ? ".bgl" : "-tr" + Path.GetExtension(_cmdLine.InputFile);
             }
 
-            _output = new StreamWriter(_outputName);
+            if (_cmdLine.Binary)
+            {
+                _binaryOutput = new BinaryGameLogWriter(_outputName);
+            }
+            else
+            {
+                _output = new StreamWriter(_outputName);
+            }
 
             if (!string.IsNullOrEmpty(_cmdLine.RenameEq))
             {
@@ -83,9 +90,15 @@ namespace ai.pkr.metatools.pkrlogtransform
             {
             }
 
-            _output.Flush();
-
-            _output.Close();
+            if (_cmdLine.Binary)
+            {
+                _binaryOutput.Close();
+            }
+            else
+            {
+                _output.Flush();
+                _output.Close();
+            }
 
             return 0;
         }
@@ -95,7 +108,14 @@ namespace ai.pkr.metatools.pkrlogtransform
             //GameLogMetaData md = GameLogMetaData.Parse(metaData);
             if (!_cmdLine.RemoveMetadata)
             {
-                _output.WriteLine(metaData);
+                if (_cmdLine.Binary)
+                {
+                    _binaryOutput.WriteMetaData(metaData);
+                }
+                else
+                {
+                    _output.WriteLine(metaData);
+                }
             }
         }
 
@@ -110,7 +130,14 @@ namespace ai.pkr.metatools.pkrlogtransform
             {
                 return;
             }
-            _output.WriteLine(gameRecord.ToGameString());
+            if (_cmdLine.Binary)
+            {
+                _binaryOutput.Write(gameRecord);
+            }
+            else
+            {
+                _output.WriteLine(gameRecord.ToGameString());
+            }
         }
 
         #region Data
@@ -118,6 +145,7 @@ namespace ai.pkr.metatools.pkrlogtransform
         static CommandLine _cmdLine = new CommandLine();
         private static string _outputName = null;
         private static TextWriter _output;
+        private static BinaryGameLogWriter _binaryOutput;
         static TransformGameRecords _transformer;
 
 
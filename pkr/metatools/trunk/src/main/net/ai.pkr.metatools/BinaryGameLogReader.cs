@@ -0,0 +1,164 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.IO;
+using ai.lib.utils;
+using ai.pkr.metagame;
+
+namespace ai.pkr.metatools
+{
+    /// <summary>
+    /// Reads a binary game log written by BinaryGameLogWriter and raises the same events as GameLogParser,
+    /// so that any report can process binary logs. The game records are restored without string parsing.
+    /// </summary>
+    public class BinaryGameLogReader
+    {
+        public delegate void OnGameRecordHandler(BinaryGameLogReader source, GameRecord gameRecord);
+        public delegate void OnMetaDataHandler(BinaryGameLogReader source, string metaData);
+
+        public event OnGameRecordHandler OnGameRecord;
+        public event OnMetaDataHandler OnMetaData;
+
+        /// <summary>
+        /// Number of games read so far.
+        /// </summary>
+        public long GamesCount
+        {
+            set;
+            get;
+        }
+
+        public BdsVersion Version
+        {
+            get;
+            private set;
+        }
+
+        public void Read(string fileName)
+        {
+            using (BinaryReader r = new BinaryReader(File.OpenRead(fileName)))
+            {
+                Version = new BdsVersion();
+                Version.Read(r);
+                int formatVersion = r.ReadInt32();
+                if (formatVersion != BinaryGameLogWriter.FormatVersion)
+                {
+                    throw new ApplicationException(string.Format("Unsupported game log format {0} in {1}", formatVersion, fileName));
+                }
+                SkipPadding(r);
+                while (r.BaseStream.Position < r.BaseStream.Length)
+                {
+                    ReadChunk(r);
+                    SkipPadding(r);
+                }
+            }
+        }
+
+        #region Implementation
+
+        void ReadChunk(BinaryReader r)
+        {
+            int gamesCount = r.ReadInt32();
+            int playersCount = r.ReadInt32();
+            int actionsCount = r.ReadInt32();
+            int metaCount = r.ReadInt32();
+            int sessionsCount = r.ReadInt32();
+            int stringsCount = r.ReadInt32();
+            int stringBytes = r.ReadInt32();
+            r.ReadInt32();
+
+            double[] stack = ReadDoubles(r, playersCount);
+            double[] blind = ReadDoubles(r, playersCount);
+            double[] result = ReadDoubles(r, playersCount);
+            double[] amount = ReadDoubles(r, actionsCount);
+            ReadInts(r, gamesCount); // Sessions are not needed here, the meta-data is kept.
+            int[] gameId = ReadInts(r, gamesCount);
+            int[] gameActions = ReadInts(r, gamesCount);
+            int[] playerName = ReadInts(r, playersCount);
+            int[] actionCards = ReadInts(r, actionsCount);
+            int[] metaGame = ReadInts(r, metaCount);
+            int[] metaText = ReadInts(r, metaCount);
+            ReadInts(r, 3 * sessionsCount);
+            int[] stringOffsets = ReadInts(r, stringsCount + 1);
+            byte[] gameFlags = r.ReadBytes(gamesCount);
+            byte[] gamePlayers = r.ReadBytes(gamesCount);
+            byte[] actionKind = r.ReadBytes(actionsCount);
+            byte[] actionPosition = r.ReadBytes(actionsCount);
+            byte[] bytes = r.ReadBytes(stringBytes);
+            if (bytes.Length != stringBytes)
+            {
+                throw new ApplicationException("Unexpected end of binary game log");
+            }
+            string[] strings = new string[stringsCount];
+            for (int i = 0; i < stringsCount; ++i)
+            {
+                strings[i] = Encoding.UTF8.GetString(bytes, stringOffsets[i], stringOffsets[i + 1] - stringOffsets[i]);
+            }
+
+            int player = 0, action = 0, meta = 0;
+            for (int g = 0; g <= gamesCount; ++g)
+            {
+                for (; meta < metaCount && metaGame[meta] == g; ++meta)
+                {
+                    if (OnMetaData != null)
+                    {
+                        OnMetaData(this, strings[metaText[meta]]);
+                    }
+                }
+                if (g == gamesCount)
+                {
+                    break;
+                }
+                GameRecord gr = new GameRecord();
+                gr.Id = gameId[g] < 0 ? "" : strings[gameId[g]];
+                gr.IsGameOver = (gameFlags[g] & 1) != 0;
+                for (int p = 0; p < gamePlayers[g]; ++p, ++player)
+                {
+                    gr.Players.Add(new GameRecord.Player(strings[playerName[player]], stack[player], blind[player], result[player]));
+                }
+                for (int a = 0; a < gameActions[g]; ++a, ++action)
+                {
+                    gr.Actions.Add(new PokerAction((Ak)actionKind[action], (sbyte)actionPosition[action], amount[action],
+                        actionCards[action] < 0 ? "" : strings[actionCards[action]]));
+                }
+                GamesCount++;
+                if (OnGameRecord != null)
+                {
+                    OnGameRecord(this, gr);
+                }
+            }
+        }
+
+        static double[] ReadDoubles(BinaryReader r, int count)
+        {
+            double[] result = new double[count];
+            for (int i = 0; i < count; ++i)
+            {
+                result[i] = r.ReadDouble();
+            }
+            return result;
+        }
+
+        static int[] ReadInts(BinaryReader r, int count)
+        {
+            int[] result = new int[count];
+            for (int i = 0; i < count; ++i)
+            {
+                result[i] = r.ReadInt32();
+            }
+            return result;
+        }
+
+        static void SkipPadding(BinaryReader r)
+        {
+            long padding = (8 - r.BaseStream.Position % 8) % 8;
+            r.BaseStream.Seek(padding, SeekOrigin.Current);
+        }
+
+        #endregion
+    }
+}
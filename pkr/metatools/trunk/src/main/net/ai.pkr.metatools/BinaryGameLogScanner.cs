@@ -0,0 +1,164 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace ai.pkr.metatools
+{
+    /// <summary>
+    /// Calculates the reports of pkrlogstat (game count, total and session results) on a binary game log 
+    /// with the native scanner (ai.pkr.metatools.cpplib). The file is memory-mapped, the chunks are scanned 
+    /// in parallel and only the columns needed for the reports are read, so the speed is limited by I/O.
+    /// <para>The results are the same as of TotalResult updated by each game record, except for rounding 
+    /// (the sums are calculated in a different order).</para>
+    /// </summary>
+    public class BinaryGameLogScanner : IDisposable
+    {
+        #region Public API
+
+        /// <summary>
+        /// Result of a session.
+        /// </summary>
+        public class Session
+        {
+            /// <summary>
+            /// Index of the session in the file, 0 for the games before the first session begin.
+            /// </summary>
+            public int Index
+            {
+                get;
+                internal set;
+            }
+
+            /// <summary>
+            /// Name of the session, empty if not specified.
+            /// </summary>
+            public string Name
+            {
+                get;
+                internal set;
+            }
+
+            /// <summary>
+            /// Number of all games (including the unfinished ones).
+            /// </summary>
+            public long GamesCount
+            {
+                get;
+                internal set;
+            }
+
+            /// <summary>
+            /// Result of the finished games, the players are in the order of their first game.
+            /// </summary>
+            public TotalResult Result
+            {
+                get;
+                internal set;
+            }
+        }
+
+        public BinaryGameLogScanner(string fileName)
+        {
+            CppLib.Init();
+            _handle = CppLib.GameLogScanner_Open(fileName);
+            if (_handle == IntPtr.Zero)
+            {
+                CppLib.GameLogScanner_ThrowLastError();
+            }
+            ThreadsCount = Environment.ProcessorCount;
+        }
+
+        public int ThreadsCount
+        {
+            get;
+            set;
+        }
+
+        /// <summary>
+        /// Number of games in the file.
+        /// </summary>
+        public long FileGamesCount
+        {
+            get { return CppLib.GameLogScanner_GetFileGamesCount(_handle); }
+        }
+
+        /// <summary>
+        /// Number of scanned games.
+        /// </summary>
+        public long GamesCount
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Sessions sorted by index.
+        /// </summary>
+        public List<Session> Sessions
+        {
+            get { return _sessions; }
+        }
+
+        /// <summary>
+        /// Scans the first gameLimit games.
+        /// </summary>
+        public void Scan(long gameLimit)
+        {
+            if (CppLib.GameLogScanner_Scan(_handle, ThreadsCount, gameLimit) == 0)
+            {
+                CppLib.GameLogScanner_ThrowLastError();
+            }
+            GamesCount = CppLib.GameLogScanner_GetGamesCount(_handle);
+            _sessions.Clear();
+            int sessionsCount = CppLib.GameLogScanner_GetSessionsCount(_handle);
+            for (int s = 0; s < sessionsCount; ++s)
+            {
+                Session session = new Session();
+                session.Index = CppLib.GameLogScanner_GetSessionIndex(_handle, s);
+                session.Name = CppLib.PtrToStringUtf8(CppLib.GameLogScanner_GetSessionName(_handle, s));
+                long gamesCount, gamesOverCount;
+                CppLib.GameLogScanner_GetSessionGamesCount(_handle, s, out gamesCount, out gamesOverCount);
+                session.GamesCount = gamesCount;
+                session.Result = new TotalResult { Name = session.Name, GamesCount = (int)gamesOverCount };
+                int playersCount = CppLib.GameLogScanner_GetPlayersCount(_handle, s);
+                for (int p = 0; p < playersCount; ++p)
+                {
+                    string name = CppLib.PtrToStringUtf8(CppLib.GameLogScanner_GetPlayerName(_handle, s, p));
+                    TotalResult.Player player = new TotalResult.Player { Name = name };
+                    int positionsCount = CppLib.GameLogScanner_GetPositionsCount(_handle, s, p);
+                    for (int pos = 0; pos < positionsCount; ++pos)
+                    {
+                        long playerGames;
+                        double result;
+                        CppLib.GameLogScanner_GetPlayerResult(_handle, s, p, pos, out playerGames, out result);
+                        player.Update(pos, (int)playerGames, result);
+                    }
+                    session.Result.Players.Add(name, player);
+                }
+                _sessions.Add(session);
+            }
+        }
+
+        public void Dispose()
+        {
+            if (_handle != IntPtr.Zero)
+            {
+                CppLib.GameLogScanner_Close(_handle);
+                _handle = IntPtr.Zero;
+            }
+        }
+
+        #endregion
+
+        #region Implementation
+
+        IntPtr _handle;
+        List<Session> _sessions = new List<Session>();
+
+        #endregion
+    }
+}
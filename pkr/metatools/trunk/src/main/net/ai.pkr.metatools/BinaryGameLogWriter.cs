@@ -0,0 +1,257 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.IO;
+using System.Reflection;
+using ai.lib.utils;
+using ai.pkr.metagame;
+
+namespace ai.pkr.metatools
+{
+    /// <summary>
+    /// Writes game records and meta-data to a binary game log. It is much more compact than a text log
+    /// and can be read without parsing: by BinaryGameLogReader or by the native scanner (BinaryGameLogScanner).
+    /// <para>The games are stored in chunks of ChunkSize games, a chunk is self-contained (has its own string table),
+    /// so that the chunks can be processed in parallel. Inside a chunk the data is stored by columns 
+    /// (all results, all names, all actions, ...), a report reads only the columns it needs.</para>
+    /// <para>Format (all numbers are little-endian): BdsVersion, int32 format version (1), zero padding to a 
+    /// multiple of 8 bytes, chunks. A chunk: int32 header (games G, players P, actions A, meta-data M, sessions S, strings N,
+    /// string bytes B, 0), columns: double stack[P], blind[P], result[P], amount[A]; int32 gameSession[G], gameId[G], 
+    /// gameActions[G], playerName[P], actionCards[A], metaGame[M], metaText[M], sessionIndex[S], sessionGame[S], sessionName[S], 
+    /// stringOffsets[N + 1]; byte gameFlags[G], gamePlayers[G], actionKind[A]; sbyte actionPosition[A]; string bytes[B] (UTF-8); 
+    /// zero padding to a multiple of 8 bytes. Strings are indexes in the string table of the chunk, -1 for none.</para>
+    /// <para>Sessions are numbered by the writer: session 0 contains the games before the first session begin, 
+    /// each OnSessionBegin of the first repetition begins the next session (see GameLogMetaData.IsSessionBegin()).</para>
+    /// </summary>
+    public class BinaryGameLogWriter : IDisposable
+    {
+        #region Public API
+
+        public const int FormatVersion = 1;
+
+        public BinaryGameLogWriter(string fileName)
+            : this(fileName, 65536)
+        {
+        }
+
+        public BinaryGameLogWriter(string fileName, int chunkSize)
+        {
+            if (chunkSize <= 0)
+            {
+                throw new ArgumentException("Chunk size must be positive");
+            }
+            ChunkSize = chunkSize;
+            _writer = new BinaryWriter(File.Open(fileName, FileMode.Create, FileAccess.Write));
+            BdsVersion version = new BdsVersion(Assembly.GetExecutingAssembly());
+            version.Description = "Binary game log";
+            version.Write(_writer);
+            _writer.Write(FormatVersion);
+            Pad8();
+        }
+
+        public int ChunkSize
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Number of games written so far.
+        /// </summary>
+        public long GamesCount
+        {
+            get;
+            private set;
+        }
+
+        public void WriteMetaData(string metaData)
+        {
+            _metaGame.Add(_gameSession.Count);
+            _metaText.Add(AddString(metaData));
+            GameLogMetaData md = GameLogMetaData.Parse(metaData);
+            string sessionName;
+            if (md != null && md.IsSessionBegin(out sessionName))
+            {
+                _session++;
+                _sessionIndex.Add(_session);
+                _sessionGame.Add(_gameSession.Count);
+                _sessionName.Add(AddString(sessionName));
+            }
+        }
+
+        public void Write(GameRecord gameRecord)
+        {
+            if (gameRecord.Players.Count > byte.MaxValue)
+            {
+                throw new ArgumentException("Too many players");
+            }
+            _gameSession.Add(_session);
+            _gameId.Add(string.IsNullOrEmpty(gameRecord.Id) ? -1 : AddString(gameRecord.Id));
+            _gameActions.Add(gameRecord.Actions.Count);
+            _gameFlags.Add((byte)(gameRecord.IsGameOver ? 1 : 0));
+            _gamePlayers.Add((byte)gameRecord.Players.Count);
+            foreach (GameRecord.Player player in gameRecord.Players)
+            {
+                _stack.Add(player.Stack);
+                _blind.Add(player.Blind);
+                _result.Add(player.Result);
+                _playerName.Add(AddString(player.Name));
+            }
+            foreach (PokerAction action in gameRecord.Actions)
+            {
+                _amount.Add(action.Amount);
+                _actionCards.Add(string.IsNullOrEmpty(action.Cards) ? -1 : AddString(action.Cards));
+                _actionKind.Add((byte)action.Kind);
+                _actionPosition.Add((sbyte)action.Position);
+            }
+            GamesCount++;
+            if (_gameSession.Count == ChunkSize)
+            {
+                WriteChunk();
+            }
+        }
+
+        /// <summary>
+        /// Writes the last chunk and closes the file.
+        /// </summary>
+        public void Close()
+        {
+            if (_writer == null)
+            {
+                return;
+            }
+            if (_gameSession.Count > 0 || _metaGame.Count > 0)
+            {
+                WriteChunk();
+            }
+            _writer.Close();
+            _writer = null;
+        }
+
+        public void Dispose()
+        {
+            Close();
+        }
+
+        #endregion
+
+        #region Implementation
+
+        int AddString(string s)
+        {
+            int index;
+            if (!_strings.TryGetValue(s, out index))
+            {
+                index = _strings.Count;
+                _strings.Add(s, index);
+                _stringList.Add(s);
+            }
+            return index;
+        }
+
+        void WriteChunk()
+        {
+            List<int> stringOffsets = new List<int>(_stringList.Count + 1);
+            MemoryStream stringBytes = new MemoryStream();
+            stringOffsets.Add(0);
+            foreach (string s in _stringList)
+            {
+                byte[] bytes = Encoding.UTF8.GetBytes(s);
+                stringBytes.Write(bytes, 0, bytes.Length);
+                stringOffsets.Add((int)stringBytes.Length);
+            }
+
+            _writer.Write(_gameSession.Count);
+            _writer.Write(_playerName.Count);
+            _writer.Write(_actionKind.Count);
+            _writer.Write(_metaGame.Count);
+            _writer.Write(_sessionIndex.Count);
+            _writer.Write(_stringList.Count);
+            _writer.Write((int)stringBytes.Length);
+            _writer.Write(0);
+
+            _stack.ForEach(v => _writer.Write(v));
+            _blind.ForEach(v => _writer.Write(v));
+            _result.ForEach(v => _writer.Write(v));
+            _amount.ForEach(v => _writer.Write(v));
+            _gameSession.ForEach(v => _writer.Write(v));
+            _gameId.ForEach(v => _writer.Write(v));
+            _gameActions.ForEach(v => _writer.Write(v));
+            _playerName.ForEach(v => _writer.Write(v));
+            _actionCards.ForEach(v => _writer.Write(v));
+            _metaGame.ForEach(v => _writer.Write(v));
+            _metaText.ForEach(v => _writer.Write(v));
+            _sessionIndex.ForEach(v => _writer.Write(v));
+            _sessionGame.ForEach(v => _writer.Write(v));
+            _sessionName.ForEach(v => _writer.Write(v));
+            stringOffsets.ForEach(v => _writer.Write(v));
+            _writer.Write(_gameFlags.ToArray());
+            _writer.Write(_gamePlayers.ToArray());
+            _writer.Write(_actionKind.ToArray());
+            _actionPosition.ForEach(v => _writer.Write(v));
+            stringBytes.WriteTo(_writer.BaseStream);
+            Pad8();
+
+            _stack.Clear();
+            _blind.Clear();
+            _result.Clear();
+            _amount.Clear();
+            _gameSession.Clear();
+            _gameId.Clear();
+            _gameActions.Clear();
+            _playerName.Clear();
+            _actionCards.Clear();
+            _metaGame.Clear();
+            _metaText.Clear();
+            _sessionIndex.Clear();
+            _sessionGame.Clear();
+            _sessionName.Clear();
+            _gameFlags.Clear();
+            _gamePlayers.Clear();
+            _actionKind.Clear();
+            _actionPosition.Clear();
+            _strings.Clear();
+            _stringList.Clear();
+        }
+
+        void Pad8()
+        {
+            _writer.Flush();
+            long padding = (8 - _writer.BaseStream.Position % 8) % 8;
+            for (long i = 0; i < padding; ++i)
+            {
+                _writer.Write((byte)0);
+            }
+        }
+
+        BinaryWriter _writer;
+        int _session = 0;
+
+        List<double> _stack = new List<double>();
+        List<double> _blind = new List<double>();
+        List<double> _result = new List<double>();
+        List<double> _amount = new List<double>();
+        List<int> _gameSession = new List<int>();
+        List<int> _gameId = new List<int>();
+        List<int> _gameActions = new List<int>();
+        List<int> _playerName = new List<int>();
+        List<int> _actionCards = new List<int>();
+        List<int> _metaGame = new List<int>();
+        List<int> _metaText = new List<int>();
+        List<int> _sessionIndex = new List<int>();
+        List<int> _sessionGame = new List<int>();
+        List<int> _sessionName = new List<int>();
+        List<byte> _gameFlags = new List<byte>();
+        List<byte> _gamePlayers = new List<byte>();
+        List<byte> _actionKind = new List<byte>();
+        List<sbyte> _actionPosition = new List<sbyte>();
+        Dictionary<string, int> _strings = new Dictionary<string, int>();
+        List<string> _stringList = new List<string>();
+
+        #endregion
+    }
+}
@@ -0,0 +1,152 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+using ai.lib.utils;
+using System.Reflection;
+using System.IO;
+
+namespace ai.pkr.metatools
+{
+    /// <summary>
+    /// Wrapper for the native library ai.pkr.metatools.cpplib.
+    /// </summary>
+    public class CppLib
+    {
+        #region GameLogScanner
+
+        /// <summary>
+        /// Maps a binary game log written by BinaryGameLogWriter. 
+        /// Returns a handle or IntPtr.Zero on error (see GameLogScanner_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern IntPtr GameLogScanner_Open(string fileName);
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern void GameLogScanner_Close(IntPtr s);
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern IntPtr GameLogScanner_GetLastError();
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern Int64 GameLogScanner_GetFileGamesCount(IntPtr s);
+
+        /// <summary>
+        /// Calculates the game count, total and session results of the first gameLimit games
+        /// with threadsCount threads. Returns 0 on error.
+        /// </summary>
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern int GameLogScanner_Scan(IntPtr s, int threadsCount, Int64 gameLimit);
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern Int64 GameLogScanner_GetGamesCount(IntPtr s);
+
+        /// <summary>
+        /// Number of sessions, sorted by index (0: the games before the first session begin).
+        /// </summary>
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern int GameLogScanner_GetSessionsCount(IntPtr s);
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern int GameLogScanner_GetSessionIndex(IntPtr s, int session);
+
+        /// <summary>
+        /// Name of the session (UTF-8, see PtrToStringUtf8()), empty if unknown.
+        /// </summary>
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern IntPtr GameLogScanner_GetSessionName(IntPtr s, int session);
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern void GameLogScanner_GetSessionGamesCount(IntPtr s, int session, 
+            out Int64 gamesCount, out Int64 gamesOverCount);
+
+        /// <summary>
+        /// Number of players of a session, sorted by their first game and position.
+        /// </summary>
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern int GameLogScanner_GetPlayersCount(IntPtr s, int session);
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern IntPtr GameLogScanner_GetPlayerName(IntPtr s, int session, int player);
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern int GameLogScanner_GetPositionsCount(IntPtr s, int session, int player);
+
+        [DllImport("ai.pkr.metatools.cpplib.dll")]
+        public static extern void GameLogScanner_GetPlayerResult(IntPtr s, int session, int player, int position,
+            out Int64 gamesCount, out double result);
+
+        /// <summary>
+        /// Throws an exception with the last error of GameLogScanner.
+        /// </summary>
+        public static void GameLogScanner_ThrowLastError()
+        {
+            throw new ApplicationException(PtrToStringUtf8(GameLogScanner_GetLastError()));
+        }
+
+        #endregion
+
+        /// <summary>
+        /// Converts a 0-terminated UTF-8 string returned by the library.
+        /// </summary>
+        public static string PtrToStringUtf8(IntPtr p)
+        {
+            int length = 0;
+            while (Marshal.ReadByte(p, length) != 0)
+            {
+                ++length;
+            }
+            byte[] bytes = new byte[length];
+            Marshal.Copy(p, bytes, 0, length);
+            return Encoding.UTF8.GetString(bytes);
+        }
+
+        [DllImport("libdl.so.2")]
+        static extern IntPtr dlopen(string fileName, int flags);
+
+        public static void Init()
+        {
+            bool isUnix = Environment.OSVersion.Platform == PlatformID.Unix;
+            string platform = isUnix ? (System.IntPtr.Size == 8 ? "linux64" : "linux32")
+                : (System.IntPtr.Size == 8 ? "win64" : "win32");
+            string codeBase = CodeBase.Get(Assembly.GetExecutingAssembly());
+            string dllDir = Path.Combine(Path.GetDirectoryName(codeBase), platform);
+
+            string dllName = isUnix ? "libai.pkr.metatools.cpplib.so" : "ai.pkr.metatools.cpplib.dll";
+
+            string dllPath = Path.Combine(dllDir, dllName);
+
+            if (!System.IO.File.Exists(dllPath))
+            {
+                // In case we are in development folder (debug or release) try to load from bin.   
+                dllDir = Props.Global.Expand("${bds.BinDir}") + platform;
+                dllPath = Path.Combine(dllDir, dllName);
+                if (!System.IO.File.Exists(dllPath))
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+            }
+            if (isUnix)
+            {
+                // Load by full path, the DllImports are then resolved by the soname 
+                // (see the dllmap in ai.pkr.metatools.dll.config).
+                const int RTLD_NOW = 2, RTLD_GLOBAL = 0x100;
+                if (dlopen(dllPath, RTLD_NOW | RTLD_GLOBAL) == IntPtr.Zero)
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+                return;
+            }
+            string envPath = Environment.GetEnvironmentVariable("PATH");
+            string envPathL = envPath.ToLower() + ";";
+            if (envPathL.IndexOf(dllDir.ToLower() + ";") < 0)
+            {
+                Environment.SetEnvironmentVariable("PATH", dllDir + ";" + envPath, EnvironmentVariableTarget.Process);
+            }
+        }
+    }
+}
\ No newline at end of file
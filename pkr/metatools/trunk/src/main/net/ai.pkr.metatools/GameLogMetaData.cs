@@ -51,5 +51,27 @@ namespace ai.pkr.metatools
         {
             get { return _properties;}
         }
+
+        /// <summary>
+        /// Returns true if this meta-data begins a new session: OnSessionBegin of the first repetition.
+        /// sessionName is the name of the session or an empty string if it is not specified.
+        /// </summary>
+        public bool IsSessionBegin(out string sessionName)
+        {
+            sessionName = "";
+            if (Name != "OnSessionBegin")
+            {
+                return false;
+            }
+            if (Properties.ContainsKey("Repetition") && int.Parse(Properties["Repetition"]) != 0)
+            {
+                return false;
+            }
+            if (Properties.ContainsKey("Name"))
+            {
+                sessionName = Properties["Name"];
+            }
+            return true;
+        }
     }
 }
@@ -148,7 +148,7 @@ namespace ai.pkr.metatools
 
             internal void Update(Player player)
             {
-                SetArraySizes(player._result.Length);
+                SetArraySizes(player._result.Length - 1);
                 for(int p = 0; p < player._result.Length; ++p)
                 {
                     _gamesCount[p] += player._gamesCount[p];
@@ -0,0 +1,229 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using ai.pkr.metagame;
+using ai.lib.utils;
+using System.Reflection;
+using System.IO;
+using System.Diagnostics;
+
+namespace ai.pkr.metatools.nunit
+{
+    /// <summary>
+    /// Unit tests for BinaryGameLogWriter, BinaryGameLogReader and BinaryGameLogScanner. 
+    /// </summary>
+    [TestFixture]
+    public class BinaryGameLog_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_WriteRead()
+        {
+            string[] log = new string[]
+            {
+                ">OnSessionBegin Name='s1' Repetition='0'",
+                "1; Agent{10 0.5 3} Opp{15 1 -3}; 0d{Ac Ad} 1d{Kc 2d} 0c 1r1;",
+                "2; Agent{10 0.5 -0.5} Opp{15 1 0.5}; 0d{Ac Ad} 1d{? ?} 0f.",
+                ">OnSessionBegin Name='s1' Repetition='1'",
+                "; P1{0 0 1.25} Пётр{0 0 -1.25}; 0d{Ac 2d} 1d{Ks Kd} 0c 1c d{2h 3h 4h} 1r2.5 0c d{Jh} 1c 0c d{Qd} 1c 0c.",
+                "4; A{1 0.5 0} B{1 1 0} C{1 0 0}; 2d{7s};",
+                ">OnSessionEnd",
+            };
+            // Small chunks to test games and meta-data across the chunks.
+            for (int chunkSize = 1; chunkSize <= 5; ++chunkSize)
+            {
+                string fileName = Path.Combine(_outDir, "write-read.bgl");
+                using (BinaryGameLogWriter w = new BinaryGameLogWriter(fileName, chunkSize))
+                {
+                    foreach (string line in log)
+                    {
+                        if (line.StartsWith(">"))
+                        {
+                            w.WriteMetaData(line.Substring(1));
+                        }
+                        else
+                        {
+                            w.Write(new GameRecord(line));
+                        }
+                    }
+                    Assert.AreEqual(4, w.GamesCount);
+                }
+                List<string> actual = new List<string>();
+                BinaryGameLogReader r = new BinaryGameLogReader();
+                r.OnMetaData += (source, metaData) => actual.Add(">" + metaData);
+                r.OnGameRecord += (source, gameRecord) => actual.Add(gameRecord.ToGameString());
+                r.Read(fileName);
+                Assert.AreEqual(4, r.GamesCount);
+                Assert.AreEqual(log.Length, actual.Count);
+                for (int i = 0; i < log.Length; ++i)
+                {
+                    string expected = log[i].StartsWith(">") ? log[i] : new GameRecord(log[i]).ToGameString();
+                    Assert.AreEqual(expected, actual[i]);
+                }
+            }
+        }
+
+        [Test]
+        public void Test_Scanner()
+        {
+            string fileName = Path.Combine(_outDir, "scanner.bgl");
+            WriteRandomLog(fileName, 5000, new Random(1));
+            for (int threadsCount = 1; threadsCount <= 3; ++threadsCount)
+            {
+                foreach (long gameLimit in new long[] { 0, 10, 2777, long.MaxValue })
+                {
+                    using (BinaryGameLogScanner scanner = new BinaryGameLogScanner(fileName))
+                    {
+                        scanner.ThreadsCount = threadsCount;
+                        Assert.AreEqual(5000, scanner.FileGamesCount);
+                        scanner.Scan(gameLimit);
+                        Assert.AreEqual(Math.Min(gameLimit, 5000), scanner.GamesCount);
+                        List<TotalResult> expected = ReadSessions(fileName, gameLimit);
+                        Assert.AreEqual(expected.Count, scanner.Sessions.Count);
+                        for (int s = 0; s < expected.Count; ++s)
+                        {
+                            Assert.AreEqual(expected[s].Name, scanner.Sessions[s].Name);
+                            VerifyResult(expected[s], scanner.Sessions[s].Result);
+                        }
+                    }
+                }
+            }
+        }
+
+        [Test]
+        [ExpectedException(typeof(ApplicationException))]
+        public void Test_Scanner_BadFile()
+        {
+            string fileName = Path.Combine(_outDir, "bad.bgl");
+            File.WriteAllText(fileName, "not a binary game log");
+            new BinaryGameLogScanner(fileName);
+        }
+
+        #endregion
+
+        #region Benchmarks
+
+        [Test]
+        [Category("Benchmark")]
+        public void Benchmark_Scan()
+        {
+            string fileName = Path.Combine(_outDir, "benchmark.bgl");
+            int gamesCount = 1000000;
+            WriteRandomLog(fileName, gamesCount, new Random(1));
+
+            DateTime start = DateTime.Now;
+            TotalResult totalResult = new TotalResult();
+            BinaryGameLogReader r = new BinaryGameLogReader();
+            r.OnGameRecord += (source, gameRecord) => totalResult.Update(gameRecord);
+            r.Read(fileName);
+            double readerTime = (DateTime.Now - start).TotalSeconds;
+            Console.WriteLine("Reader and TotalResult: {0:#,#} games/s", gamesCount / readerTime);
+
+            start = DateTime.Now;
+            using (BinaryGameLogScanner scanner = new BinaryGameLogScanner(fileName))
+            {
+                scanner.Scan(long.MaxValue);
+            }
+            double scannerTime = (DateTime.Now - start).TotalSeconds;
+            Console.WriteLine("Scanner: {0:#,#} games/s, {1} threads, speedup {2:0.0}", 
+                gamesCount / scannerTime, Environment.ProcessorCount, readerTime / scannerTime);
+        }
+
+        #endregion
+
+        #region Implementation
+
+        /// <summary>
+        /// Writes random games with a few players and sessions.
+        /// </summary>
+        void WriteRandomLog(string fileName, int gamesCount, Random rng)
+        {
+            using (BinaryGameLogWriter w = new BinaryGameLogWriter(fileName, 1000))
+            {
+                int session = 0;
+                for (int g = 0; g < gamesCount; ++g)
+                {
+                    if (rng.Next(500) == 0)
+                    {
+                        w.WriteMetaData(string.Format("OnSessionBegin Name='s{0}' Repetition='{1}'", session, rng.Next(2)));
+                        session++;
+                    }
+                    GameRecord gr = new GameRecord { Id = g.ToString(), IsGameOver = rng.Next(10) != 0 };
+                    int playersCount = 2 + rng.Next(2);
+                    int first = rng.Next(5);
+                    double sum = 0;
+                    for (int p = 0; p < playersCount; ++p)
+                    {
+                        double result = p < playersCount - 1 ? rng.Next(-20, 21) * 0.25 : -sum;
+                        sum += result;
+                        gr.Players.Add(new GameRecord.Player("Player" + ((first + p) % 5), 100, p == 0 ? 0.5 : 1, result));
+                    }
+                    gr.Actions.Add(PokerAction.d(0, "Ac Ad"));
+                    gr.Actions.Add(PokerAction.r(0, 1));
+                    gr.Actions.Add(PokerAction.f(1));
+                    w.Write(gr);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Calculates the results of the sessions by TotalResult.
+        /// </summary>
+        List<TotalResult> ReadSessions(string fileName, long gameLimit)
+        {
+            List<TotalResult> sessions = new List<TotalResult>();
+            sessions.Add(new TotalResult { Name = "" });
+            bool hasGamesInSession0 = false;
+            BinaryGameLogReader r = new BinaryGameLogReader();
+            r.OnMetaData += (source, metaData) =>
+            {
+                string name;
+                if (GameLogMetaData.Parse(metaData).IsSessionBegin(out name) && source.GamesCount < gameLimit)
+                {
+                    sessions.Add(new TotalResult { Name = name });
+                }
+            };
+            r.OnGameRecord += (source, gameRecord) =>
+            {
+                if (source.GamesCount <= gameLimit)
+                {
+                    sessions[sessions.Count - 1].Update(gameRecord);
+                    hasGamesInSession0 = hasGamesInSession0 || sessions.Count == 1;
+                }
+            };
+            r.Read(fileName);
+            // The scanner returns session 0 only if it contains games (finished or not).
+            if (!hasGamesInSession0)
+            {
+                sessions.RemoveAt(0);
+            }
+            return sessions;
+        }
+
+        void VerifyResult(TotalResult expected, TotalResult actual)
+        {
+            Assert.AreEqual(expected.GamesCount, actual.GamesCount);
+            Assert.AreEqual(expected.Players.Keys.ToArray(), actual.Players.Keys.ToArray());
+            foreach (TotalResult.Player ep in expected.Players.Values)
+            {
+                TotalResult.Player ap = actual.Players[ep.Name];
+                Assert.AreEqual(ep.GamesCount, ap.GamesCount);
+                Assert.AreEqual(ep.Result.Length, ap.Result.Length);
+                for (int pos = 0; pos < ep.Result.Length; ++pos)
+                {
+                    Assert.AreEqual(ep.Result[pos], ap.Result[pos], 1e-9);
+                }
+            }
+        }
+
+        string _outDir = UTHelper.MakeAndGetTestOutputDir(Assembly.GetExecutingAssembly(), "BinaryGameLog_Test");
+
+        #endregion
+    }
+}
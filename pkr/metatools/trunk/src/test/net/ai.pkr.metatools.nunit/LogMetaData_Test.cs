@@ -29,6 +29,18 @@ namespace ai.pkr.metatools.nunit
             Assert.AreEqual("-580223114", md.Properties["RngSeed"]);
         }
 
+        [Test]
+        public void Test_IsSessionBegin()
+        {
+            string name;
+            Assert.IsTrue(GameLogMetaData.Parse("OnSessionBegin Name='s1' Repetition='0'").IsSessionBegin(out name));
+            Assert.AreEqual("s1", name);
+            Assert.IsTrue(GameLogMetaData.Parse("OnSessionBegin").IsSessionBegin(out name));
+            Assert.AreEqual("", name);
+            Assert.IsFalse(GameLogMetaData.Parse("OnSessionBegin Name='s1' Repetition='1'").IsSessionBegin(out name));
+            Assert.IsFalse(GameLogMetaData.Parse("OnSessionEnd Name='s1'").IsSessionBegin(out name));
+        }
+
         #endregion
 
         #region Benchmarks
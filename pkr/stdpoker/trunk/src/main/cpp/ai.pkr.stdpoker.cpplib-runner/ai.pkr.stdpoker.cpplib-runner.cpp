@@ -0,0 +1,937 @@
+// ai.pkr.stdpoker.cpplib-runner.cpp : Tests and benchmarks for ai.pkr.stdpoker.cpplib.
+//
+// Usage:
+//   ai.pkr.stdpoker.cpplib-runner test
+//       Runs the tests (on synthetic data, no data files are required).
+//   ai.pkr.stdpoker.cpplib-runner benchmark-lut7 <LutEvaluator7.dat> [hands]
+//       Compares scalar and batched evaluation on random 7-card hands.
+//   ai.pkr.stdpoker.cpplib-runner benchmark-iso [hands]
+//       Measures HandIsoIndexer on random 7-card hands.
+//   ai.pkr.stdpoker.cpplib-runner benchmark-normsuit [hands]
+//       Measures norm_suit on single cards and on random 7-card hands (pocket, flop, turn, river).
+//   ai.pkr.stdpoker.cpplib-runner benchmark-showdown [boards]
+//       Compares showdown_kernel with the pairwise evaluation on random river boards (1081 pockets each).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include "ai.pkr.stdpoker.cpplib.h"
+#include "lut_evaluator7.h"
+#include "hand_iso_indexer.h"
+#include "norm_suit.h"
+#include "showdown_kernel.h"
+#include <ai.lib.utils.cpp/bds_version.h>
+
+using namespace std;
+using namespace ai::pkr::stdpoker;
+
+static string _tempDir = ".";
+
+#define VERIFY(cond) if(!(cond)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #cond); throw "Test failed"; }
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// A simple deterministic RNG (the tests must be reproducible).
+class Rng
+{
+public:
+	Rng(uint64_t seed) : _state(seed * 2862933555777941757ULL + 3037000493ULL)
+	{}
+
+	uint32_t Next(uint32_t n)
+	{
+		_state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (uint32_t)((_state >> 33) % n);
+	}
+private:
+	uint64_t _state;
+};
+
+/// Generates n hands of 7 distinct cards.
+static void GenerateHands(Rng & rng, size_t n, vector<int32_t> & cards)
+{
+	cards.resize(n * 7);
+	for(size_t i = 0; i < n; ++i)
+	{
+		uint64_t used = 0;
+		for(int c = 0; c < 7; ++c)
+		{
+			int32_t card;
+			do
+			{
+				card = (int32_t)rng.Next(52);
+			} while(used & (1ULL << card));
+			used |= 1ULL << card;
+			cards[i * 7 + c] = card;
+		}
+	}
+}
+
+static void WriteInt32(string & s, uint32_t v)
+{
+	s.append((const char*)&v, 4);
+}
+
+static void WriteString(string & s, const string & v)
+{
+	// Strings are short here, 1-byte length prefix.
+	s.push_back((char)v.size());
+	s.append(v);
+}
+
+/** Writes a LUT file in the format of LutEvaluatorGenerator.SaveLut().
+The length of user description allows to control the alignment of the LUT.
+*/
+static string WriteLutFile(const char * name, const vector<uint32_t> & lut, const string & userDescription)
+{
+	string fields;
+	WriteInt32(fields, 1);
+	WriteInt32(fields, 2);
+	WriteInt32(fields, 3);
+	WriteInt32(fields, 4);
+	WriteString(fields, "scm");
+	WriteString(fields, "build");
+	WriteString(fields, "LutEvaluator7 test data");
+	WriteString(fields, userDescription);
+
+	string file;
+	WriteInt32(file, 5);
+	WriteInt32(file, (uint32_t)fields.size());
+	file += fields;
+	WriteInt32(file, ai::lib::utils::bds_version::crc32(fields.data(), fields.size()));
+	WriteInt32(file, lut_evaluator7::LUT_FILE_FORMAT_ID);
+	WriteInt32(file, (uint32_t)lut.size());
+	file.append((const char*)&lut[0], lut.size() * 4);
+
+	string path = _tempDir + "/" + name;
+	FILE * f = fopen(path.c_str(), "wb");
+	VERIFY(f != 0);
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+	return path;
+}
+
+/** Creates a LUT with the same structure as a real one, but random content.
+States are arranged in 7 levels, the entries of levels 0..5 point to states of the next level
+(premultiplied by 52), the entries of level 6 are hand values.
+*/
+static void CreateRandomLut(Rng & rng, vector<uint32_t> & lut)
+{
+	const uint32_t levelSizes[7] = {1, 20, 200, 2000, 8000, 16000, 32000};
+	uint32_t levelStart[8] = {0};
+	for(int l = 0; l < 7; ++l)
+	{
+		levelStart[l + 1] = levelStart[l] + levelSizes[l];
+	}
+	lut.resize(levelStart[7] * 52);
+	for(int l = 0; l < 7; ++l)
+	{
+		for(uint32_t s = levelStart[l]; s < levelStart[l + 1]; ++s)
+		{
+			for(int c = 0; c < 52; ++c)
+			{
+				lut[s * 52 + c] = l < 6 ? 52 * (levelStart[l + 1] + rng.Next(levelSizes[l + 1])) : rng.Next(7462) + 1;
+			}
+		}
+	}
+}
+
+static uint32_t EvaluateRef(const vector<uint32_t> & lut, const int32_t * c)
+{
+	uint32_t value = 0;
+	for(int i = 0; i < 7; ++i)
+	{
+		value = lut[value + c[i]];
+	}
+	return value;
+}
+
+static void Test_LutEvaluator7(const char * userDescription)
+{
+	Rng rng(1);
+	vector<uint32_t> lut;
+	CreateRandomLut(rng, lut);
+	string path = WriteLutFile("LutEvaluator7-test.dat", lut, userDescription);
+
+	LutEvaluator7 * e = LutEvaluator7_Open(path.c_str());
+	VERIFY(e != 0);
+	VERIFY(LutEvaluator7_GetLutSize(e) == lut.size());
+	VERIFY(memcmp(LutEvaluator7_GetLut(e), &lut[0], lut.size() * 4) == 0);
+
+	// Cover all tail lengths of the batch.
+	const size_t n = 1000;
+	vector<int32_t> cards;
+	GenerateHands(rng, n, cards);
+	for(size_t count = 0; count <= 3 * lut_evaluator7::BATCH_GROUP + 1; ++count)
+	{
+		vector<uint32_t> values(count + 1, 0xFFFFFFFF);
+		LutEvaluator7_EvaluateBatch(e, (uint32_t)count, &cards[0], &values[0]);
+		for(size_t i = 0; i < count; ++i)
+		{
+			VERIFY(values[i] == EvaluateRef(lut, &cards[i * 7]));
+		}
+		VERIFY(values[count] == 0xFFFFFFFF);
+	}
+	vector<uint32_t> values(n);
+	LutEvaluator7_EvaluateBatch(e, n, &cards[0], &values[0]);
+	for(size_t i = 0; i < n; ++i)
+	{
+		uint32_t expected = EvaluateRef(lut, &cards[i * 7]);
+		VERIFY(LutEvaluator7_Evaluate(e, &cards[i * 7]) == expected);
+		VERIFY(values[i] == expected);
+	}
+	LutEvaluator7_Close(e);
+
+	remove(path.c_str());
+}
+
+static void Test_LutEvaluator7_BadFiles()
+{
+	VERIFY(LutEvaluator7_Open((_tempDir + "/no-such-file.dat").c_str()) == 0);
+	VERIFY(strstr(LutEvaluator7_GetLastError(), "no-such-file.dat") != 0);
+
+	vector<uint32_t> lut(52 * 10, 0);
+	string path = WriteLutFile("LutEvaluator7-bad.dat", lut, "");
+
+	// Corrupt the CRC-protected version.
+	FILE * f = fopen(path.c_str(), "r+b");
+	VERIFY(f != 0);
+	fseek(f, 12, SEEK_SET);
+	fputc('X', f);
+	fclose(f);
+	VERIFY(LutEvaluator7_Open(path.c_str()) == 0);
+	printf("Expected error: %s\n", LutEvaluator7_GetLastError());
+
+	// Truncated LUT.
+	path = WriteLutFile("LutEvaluator7-bad.dat", lut, "");
+	f = fopen(path.c_str(), "r+b");
+	VERIFY(f != 0);
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fclose(f);
+	vector<char> data(size);
+	f = fopen(path.c_str(), "rb");
+	VERIFY(fread(&data[0], 1, size, f) == (size_t)size);
+	fclose(f);
+	f = fopen(path.c_str(), "wb");
+	fwrite(&data[0], 1, size - 4, f);
+	fclose(f);
+	VERIFY(LutEvaluator7_Open(path.c_str()) == 0);
+	printf("Expected error: %s\n", LutEvaluator7_GetLastError());
+	remove(path.c_str());
+}
+
+/** Canonical form of a hand by brute force: the smallest tuple of per-round card masks
+over all permutations of suits.
+*/
+static vector<uint64_t> CanonicalRef(const int32_t * cards, int roundsCount, const int * cardsPerRound)
+{
+	int perm[4] = {0, 1, 2, 3};
+	vector<uint64_t> best;
+	do
+	{
+		vector<uint64_t> masks(roundsCount, 0);
+		for(int r = 0, c = 0; r < roundsCount; ++r)
+		{
+			for(int i = 0; i < cardsPerRound[r]; ++i, ++c)
+			{
+				masks[r] |= 1ULL << (perm[cards[c] / 13] * 13 + cards[c] % 13);
+			}
+		}
+		if(best.empty() || masks < best)
+		{
+			best = masks;
+		}
+	} while(next_permutation(perm, perm + 4));
+	return best;
+}
+
+/// Enumerates all hands (cards in each round ascending), calls f for each.
+template<class F>
+static void ForEachHand(int roundsCount, const int * cardsPerRound, int32_t * cards, int round, int pos, int start, uint64_t used, F & f)
+{
+	if(round == roundsCount)
+	{
+		f(cards);
+		return;
+	}
+	int end = 0;
+	for(int r = 0; r <= round; ++r)
+	{
+		end += cardsPerRound[r];
+	}
+	if(pos == end)
+	{
+		ForEachHand(roundsCount, cardsPerRound, cards, round + 1, pos, 0, used, f);
+		return;
+	}
+	for(int c = start; c < 52; ++c)
+	{
+		if(used & (1ULL << c))
+		{
+			continue;
+		}
+		cards[pos] = c;
+		ForEachHand(roundsCount, cardsPerRound, cards, round, pos + 1, c + 1, used | (1ULL << c), f);
+	}
+}
+
+struct VerifyIsoHand
+{
+	const hand_iso_indexer * indexer;
+	int roundsCount;
+	const int * cardsPerRound;
+	map<vector<uint64_t>, uint64_t> classes;
+	vector<bool> hit;
+
+	void operator () (const int32_t * cards)
+	{
+		uint64_t index = indexer->index(cards);
+		VERIFY(index < indexer->size());
+		hit[(size_t)index] = true;
+		vector<uint64_t> canonical = CanonicalRef(cards, roundsCount, cardsPerRound);
+		map<vector<uint64_t>, uint64_t>::iterator it = classes.find(canonical);
+		if(it == classes.end())
+		{
+			classes[canonical] = index;
+		}
+		else
+		{
+			VERIFY(it->second == index);
+		}
+	}
+};
+
+/** Verifies on all hands that isomorphic hands have equal indexes, that the classes are
+numbered densely and that unindex() is the inverse of index().
+*/
+static void Test_HandIsoIndexer_Exhaustive(int roundsCount, const int * cardsPerRound)
+{
+	hand_iso_indexer indexer;
+	VERIFY(indexer.init(roundsCount, cardsPerRound));
+	VerifyIsoHand v;
+	v.indexer = &indexer;
+	v.roundsCount = roundsCount;
+	v.cardsPerRound = cardsPerRound;
+	v.hit.assign((size_t)indexer.size(), false);
+	int32_t cards[52];
+	ForEachHand(roundsCount, cardsPerRound, cards, 0, 0, 0, 0, v);
+	VERIFY(v.classes.size() == indexer.size());
+	for(uint64_t i = 0; i < indexer.size(); ++i)
+	{
+		VERIFY(v.hit[(size_t)i]);
+		indexer.unindex(i, cards);
+		VERIFY(indexer.index(cards) == i);
+	}
+}
+
+static void Test_HandIsoIndexer()
+{
+	const int r2[] = {2}, r3[] = {3}, r4[] = {4}, r5[] = {5}, r2_3[] = {2, 3}, r2_4[] = {2, 4}, r2_5[] = {2, 5};
+	const int r2_3_1[] = {2, 3, 1}, r2_3_1_1[] = {2, 3, 1, 1};
+	struct
+	{
+		int roundsCount;
+		const int * cardsPerRound;
+		uint64_t size;
+	} known[] =
+	{
+		{1, r2, 169}, {1, r3, 1755}, {1, r4, 16432}, {1, r5, 134459},
+		{2, r2_3, 1286792}, {2, r2_4, 13960050}, {2, r2_5, 123156254},
+		{3, r2_3_1, 55190538}, {4, r2_3_1_1, 2428287420ULL}
+	};
+	for(size_t k = 0; k < sizeof(known) / sizeof(known[0]); ++k)
+	{
+		hand_iso_indexer indexer;
+		VERIFY(indexer.init(known[k].roundsCount, known[k].cardsPerRound));
+		VERIFY(indexer.size() == known[k].size);
+	}
+
+	const int r1_1_1[] = {1, 1, 1}, r2_2[] = {2, 2};
+	Test_HandIsoIndexer_Exhaustive(1, r2);
+	Test_HandIsoIndexer_Exhaustive(1, r3);
+	Test_HandIsoIndexer_Exhaustive(3, r1_1_1);
+	Test_HandIsoIndexer_Exhaustive(2, r2_2);
+
+	// Random hold'em hands: invariance under suit permutations and order of cards within a round,
+	// unindex() returns a hand of the same class.
+	Rng rng(5);
+	vector<int32_t> hands;
+	GenerateHands(rng, 20000, hands);
+	const int * configs[] = {r2_5, r2_3_1_1};
+	const int roundsCounts[] = {2, 4};
+	for(int k = 0; k < 2; ++k)
+	{
+		hand_iso_indexer indexer;
+		VERIFY(indexer.init(roundsCounts[k], configs[k]));
+		for(size_t i = 0; i < hands.size() / 7; ++i)
+		{
+			const int32_t * hand = &hands[i * 7];
+			uint64_t index = indexer.index(hand);
+			VERIFY(index < indexer.size());
+			int perm[4] = {0, 1, 2, 3};
+			for(int j = 3; j > 0; --j)
+			{
+				swap(perm[j], perm[rng.Next(j + 1)]);
+			}
+			int32_t other[7];
+			for(int c = 0; c < 7; ++c)
+			{
+				other[c] = perm[hand[c] / 13] * 13 + hand[c] % 13;
+			}
+			swap(other[0], other[1]);
+			swap(other[2], other[4]);
+			VERIFY(indexer.index(other) == index);
+			indexer.unindex(index, other);
+			VERIFY(indexer.index(other) == index);
+			VERIFY(CanonicalRef(other, roundsCounts[k], configs[k]) == CanonicalRef(hand, roundsCounts[k], configs[k]));
+		}
+	}
+
+	// C interface and errors.
+	const int32_t flop[] = {2, 3};
+	HandIsoIndexer * h = HandIsoIndexer_Create(2, flop);
+	VERIFY(h != 0);
+	VERIFY(HandIsoIndexer_GetSize(h) == 1286792);
+	VERIFY(HandIsoIndexer_GetHandSize(h) == 5);
+	int32_t cards[5];
+	HandIsoIndexer_Unindex(h, 1286791, cards);
+	uint64_t index;
+	HandIsoIndexer_IndexBatch(h, 1, cards, &index);
+	VERIFY(index == 1286791 && HandIsoIndexer_Index(h, cards) == index);
+	HandIsoIndexer_Destroy(h);
+	const int32_t tooMany[] = {20, 20, 20};
+	VERIFY(HandIsoIndexer_Create(3, tooMany) == 0);
+	printf("Expected error: %s\n", HandIsoIndexer_GetLastError());
+}
+
+/** Straightforward implementation of NormSuit.Convert() (C#): new suits are sorted by their cards
+descending, ties are resolved by the suit index.
+*/
+class NormSuitRef
+{
+public:
+	NormSuitRef()
+	{
+		for(int i = 0; i < 4; ++i)
+		{
+			_map[i] = -1;
+		}
+		_count = 0;
+	}
+
+	uint64_t Convert(uint64_t hand)
+	{
+		uint64_t result = 0;
+		vector<int> newSuits;
+		for(int i = 0; i < 4; ++i)
+		{
+			uint64_t s = (hand >> (16 * i)) & 0xFFFF;
+			if(s != 0 && _map[i] < 0)
+			{
+				newSuits.push_back(i);
+			}
+		}
+		for(size_t i = 1; i < newSuits.size(); ++i)
+		{
+			for(size_t j = i; j > 0 && Suit(hand, newSuits[j]) > Suit(hand, newSuits[j - 1]); --j)
+			{
+				swap(newSuits[j], newSuits[j - 1]);
+			}
+		}
+		for(size_t i = 0; i < newSuits.size(); ++i)
+		{
+			_map[newSuits[i]] = _count++;
+		}
+		for(int i = 0; i < 4; ++i)
+		{
+			if(_map[i] >= 0)
+			{
+				result |= Suit(hand, i) << (16 * _map[i]);
+			}
+		}
+		return result;
+	}
+
+private:
+	static uint64_t Suit(uint64_t hand, int s)
+	{
+		return (hand >> (16 * s)) & 0xFFFF;
+	}
+
+	int _map[4];
+	int _count;
+};
+
+static uint64_t CardToBit(int32_t card)
+{
+	return 1ULL << (card / 13 * 16 + card % 13);
+}
+
+/// Converts 7-card hands in 4 parts (pocket, flop, turn, river) to CardSet bits.
+static void HandsToParts(const vector<int32_t> & cards, vector<uint64_t> & parts)
+{
+	static const int partOf[7] = {0, 0, 1, 1, 1, 2, 3};
+	size_t n = cards.size() / 7;
+	parts.assign(n * 4, 0);
+	for(size_t i = 0; i < n; ++i)
+	{
+		for(int c = 0; c < 7; ++c)
+		{
+			parts[i * 4 + partOf[c]] |= CardToBit(cards[i * 7 + c]);
+		}
+	}
+}
+
+static void Test_NormSuit()
+{
+	// Single parts: all 3-card sets and all pocket + random boards.
+	for(int c0 = 0; c0 < 52; ++c0)
+	{
+		for(int c1 = c0 + 1; c1 < 52; ++c1)
+		{
+			for(int c2 = c1 + 1; c2 < 52; ++c2)
+			{
+				uint64_t hand = CardToBit(c0) | CardToBit(c1) | CardToBit(c2);
+				norm_suit ns;
+				NormSuitRef ref;
+				VERIFY(ns.convert(hand) == ref.Convert(hand));
+			}
+		}
+	}
+	Rng rng(3);
+	vector<int32_t> cards;
+	GenerateHands(rng, 200000, cards);
+	vector<uint64_t> parts, batch;
+	HandsToParts(cards, parts);
+	size_t n = parts.size() / 4;
+	for(size_t i = 0; i < n; ++i)
+	{
+		norm_suit ns;
+		NormSuitRef ref;
+		for(int r = 0; r < 4; ++r)
+		{
+			VERIFY(ns.convert(parts[i * 4 + r]) == ref.Convert(parts[i * 4 + r]));
+		}
+		VERIFY(norm_suit::count_suits(parts[i * 4] | parts[i * 4 + 1] | parts[i * 4 + 2] | parts[i * 4 + 3])
+			<= 4);
+	}
+	// Many cards in one part, including full suits.
+	for(int rep = 0; rep < 20000; ++rep)
+	{
+		norm_suit ns;
+		NormSuitRef ref;
+		uint64_t used = 0;
+		for(int part = 0; part < 3; ++part)
+		{
+			uint64_t hand = 0;
+			int count = (int)rng.Next(20);
+			for(int c = 0; c < count; ++c)
+			{
+				uint64_t bit = CardToBit((int32_t)rng.Next(52));
+				hand |= bit & ~used;
+			}
+			if(rng.Next(4) == 0)
+			{
+				hand |= 0x1FFFULL << (16 * rng.Next(4)) & ~used;
+			}
+			used |= hand;
+			VERIFY(ns.convert(hand) == ref.Convert(hand));
+		}
+	}
+
+	// Batch functions.
+	batch.resize(parts.size());
+	NormSuit_ConvertBatch((uint32_t)n, 4, &parts[0], &batch[0]);
+	for(size_t i = 0; i < n; ++i)
+	{
+		NormSuitRef ref;
+		for(int r = 0; r < 4; ++r)
+		{
+			VERIFY(batch[i * 4 + r] == ref.Convert(parts[i * 4 + r]));
+		}
+	}
+	norm_suit pocket;
+	pocket.convert(parts[0]);
+	VERIFY(pocket.suit_map(0) >= -1 && pocket.suit_map(0) < 4);
+	vector<uint64_t> boards(n), boardsResult(n);
+	for(size_t i = 0; i < n; ++i)
+	{
+		boards[i] = parts[i * 4 + 1] & ~parts[0];
+	}
+	pocket.convert_batch(n, &boards[0], &boardsResult[0]);
+	for(size_t i = 0; i < n; ++i)
+	{
+		norm_suit ns(pocket);
+		VERIFY(boardsResult[i] == ns.convert(boards[i]));
+	}
+}
+
+/// The pairwise showdown, O(n^2).
+template<class T> static void ShowdownRef(int handSize, size_t n, const int32_t * cards, const uint32_t * ranks,
+	const T * oppReach, T * win, T * tie, T * lose)
+{
+	for(size_t h = 0; h < n; ++h)
+	{
+		win[h] = tie[h] = lose[h] = 0;
+		for(size_t o = 0; o < n; ++o)
+		{
+			bool isCommon = false;
+			for(int i = 0; i < handSize; ++i)
+			{
+				for(int j = 0; j < handSize; ++j)
+				{
+					isCommon = isCommon || cards[h * handSize + i] == cards[o * handSize + j];
+				}
+			}
+			if(isCommon)
+			{
+				continue;
+			}
+			T & result = ranks[h] > ranks[o] ? win[h] : (ranks[h] == ranks[o] ? tie[h] : lose[h]);
+			result += oppReach[o];
+		}
+	}
+}
+
+/// Creates all hands of handSize cards of cardsCount cards with random ranks in 0..ranksCount-1.
+static void CreateShowdownHands(Rng & rng, int handSize, int cardsCount, uint32_t ranksCount,
+	vector<int32_t> & cards, vector<uint32_t> & ranks)
+{
+	cards.clear();
+	ranks.clear();
+	for(int c0 = 0; c0 < cardsCount; ++c0)
+	{
+		if(handSize == 1)
+		{
+			cards.push_back(c0);
+			ranks.push_back(rng.Next(ranksCount));
+			continue;
+		}
+		for(int c1 = c0 + 1; c1 < cardsCount; ++c1)
+		{
+			// Mixed card order within the hands.
+			cards.push_back(rng.Next(2) ? c0 : c1);
+			cards.push_back(cards.back() == c0 ? c1 : c0);
+			ranks.push_back(rng.Next(ranksCount));
+		}
+	}
+}
+
+static void Test_ShowdownKernel()
+{
+	Rng rng(1);
+	const int handSizes[] = {1, 2, 2, 2, 1};
+	const int cardsCounts[] = {13, 6, 20, 47, 64};
+	const uint32_t ranksCounts[] = {5, 3, 1000, 200, 64};
+	for(int t = 0; t < 5; ++t)
+	{
+		int handSize = handSizes[t];
+		vector<int32_t> cards;
+		vector<uint32_t> ranks;
+		CreateShowdownHands(rng, handSize, cardsCounts[t], ranksCounts[t], cards, ranks);
+		size_t n = ranks.size();
+		showdown_kernel kernel;
+		VERIFY(kernel.set_hands(handSize, n, &cards[0], &ranks[0]));
+		VERIFY(kernel.hands_count() == n);
+		VERIFY(kernel.hand_size() == handSize);
+		for(int rep = 0; rep < 3; ++rep)
+		{
+			// Probabilities with some zeros.
+			vector<double> reach(n), win(n), tie(n), lose(n), winRef(n), tieRef(n), loseRef(n);
+			for(size_t i = 0; i < n; ++i)
+			{
+				reach[i] = rng.Next(4) == 0 ? 0 : rng.Next(1000000) / 1e6;
+			}
+			kernel.evaluate(&reach[0], &win[0], &tie[0], &lose[0]);
+			ShowdownRef(handSize, n, &cards[0], &ranks[0], &reach[0], &winRef[0], &tieRef[0], &loseRef[0]);
+			for(size_t i = 0; i < n; ++i)
+			{
+				VERIFY(fabs(win[i] - winRef[i]) < 1e-9);
+				VERIFY(fabs(tie[i] - tieRef[i]) < 1e-9);
+				VERIFY(fabs(lose[i] - loseRef[i]) < 1e-9);
+			}
+			// The C interface, only some results.
+			ShowdownKernel * k = ShowdownKernel_Create(handSize, (uint32_t)n, &cards[0], &ranks[0]);
+			VERIFY(k != 0);
+			vector<double> win1(n, -1), lose1(n, -1);
+			ShowdownKernel_Evaluate(k, &reach[0], &win1[0], 0, &lose1[0]);
+			VERIFY(win1 == win);
+			VERIFY(lose1 == lose);
+			ShowdownKernel_Destroy(k);
+
+			// Counts (exact, unsigned arithmetic).
+			vector<uint64_t> counts(n), cWin(n), cTie(n), cLose(n), cWinRef(n), cTieRef(n), cLoseRef(n);
+			for(size_t i = 0; i < n; ++i)
+			{
+				counts[i] = rng.Next(3);
+			}
+			kernel.evaluate(&counts[0], &cWin[0], &cTie[0], &cLose[0]);
+			ShowdownRef(handSize, n, &cards[0], &ranks[0], &counts[0], &cWinRef[0], &cTieRef[0], &cLoseRef[0]);
+			VERIFY(cWin == cWinRef);
+			VERIFY(cTie == cTieRef);
+			VERIFY(cLose == cLoseRef);
+		}
+	}
+
+	showdown_kernel kernel;
+	int32_t cards[] = {0, 1, 2, 3, 1, 0};
+	uint32_t ranks[] = {1, 2, 3};
+	VERIFY(!kernel.set_hands(3, 2, cards, ranks));
+	VERIFY(kernel.error().find("hand size") != string::npos);
+	VERIFY(!kernel.set_hands(2, 3, cards, ranks));
+	VERIFY(kernel.error().find("distinct") != string::npos);
+	VERIFY(kernel.hands_count() == 0);
+	int32_t badCards[] = {0, 64};
+	VERIFY(!kernel.set_hands(2, 1, badCards, ranks));
+	VERIFY(kernel.error().find("out of range") != string::npos);
+	int32_t pairCards[] = {5, 5};
+	VERIFY(!kernel.set_hands(2, 1, pairCards, ranks));
+	VERIFY(kernel.error().find("different") != string::npos);
+	VERIFY(ShowdownKernel_Create(1, 0, cards, ranks) == 0);
+	VERIFY(strstr(ShowdownKernel_GetLastError(), "number of hands") != 0);
+}
+
+static int Test()
+{
+	try
+	{
+		// Lengths 0..3 give all alignments of the LUT.
+		Test_LutEvaluator7("");
+		Test_LutEvaluator7("a");
+		Test_LutEvaluator7("ab");
+		Test_LutEvaluator7("abc");
+		Test_LutEvaluator7_BadFiles();
+		Test_HandIsoIndexer();
+		Test_NormSuit();
+		Test_ShowdownKernel();
+	}
+	catch(const char * e)
+	{
+		printf("%s\n", e);
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+
+static void PrintResult(const char * name, size_t count, double duration, uint32_t checksum)
+{
+	printf("%-8s %.3f s, %.0f h/s, checksum: %u\n", name, duration, count / duration, checksum);
+}
+
+static int Benchmark_LutEvaluator7(const char * path, size_t handCount)
+{
+	lut_evaluator7 e;
+	if(!e.open(path))
+	{
+		printf("%s\n", e.error().c_str());
+		return 1;
+	}
+	printf("LUT: %u entries\n", e.lut_size());
+
+	const int repCount = 20;
+	printf("Random hands: %u, repetitions: %d, total: %u\n", (unsigned)handCount, repCount, (unsigned)handCount * repCount);
+	Rng rng(1);
+	vector<int32_t> cards;
+	GenerateHands(rng, handCount, cards);
+	vector<uint32_t> values(handCount);
+
+	uint32_t checksum = 0;
+	double start = Now();
+	for(int r = 0; r < repCount; ++r)
+	{
+		for(size_t i = 0; i < handCount; ++i)
+		{
+			checksum += e.evaluate(&cards[i * 7]);
+		}
+	}
+	double scalarTime = Now() - start;
+	PrintResult("scalar", handCount * repCount, scalarTime, checksum);
+
+	checksum = 0;
+	start = Now();
+	for(int r = 0; r < repCount; ++r)
+	{
+		e.evaluate_batch(handCount, &cards[0], &values[0]);
+		for(size_t i = 0; i < handCount; ++i)
+		{
+			checksum += values[i];
+		}
+	}
+	double batchTime = Now() - start;
+	PrintResult("batch", handCount * repCount, batchTime, checksum);
+	printf("Speedup: %.2f\n", scalarTime / batchTime);
+	return 0;
+}
+
+static int Benchmark_HandIsoIndexer(size_t handCount)
+{
+	Rng rng(1);
+	vector<int32_t> cards;
+	GenerateHands(rng, handCount, cards);
+	const int r2_5[] = {2, 5}, r2_3_1_1[] = {2, 3, 1, 1};
+	const int * configs[] = {r2_5, r2_3_1_1};
+	const int roundsCounts[] = {2, 4};
+	const char * names[] = {"2+5", "2+3+1+1"};
+	for(int k = 0; k < 2; ++k)
+	{
+		hand_iso_indexer indexer;
+		indexer.init(roundsCounts[k], configs[k]);
+		uint64_t checksum = 0;
+		double start = Now();
+		for(size_t i = 0; i < handCount; ++i)
+		{
+			checksum += indexer.index(&cards[i * 7]);
+		}
+		double time = Now() - start;
+		printf("%-8s %.3f s, %.0f h/s, %.1f ns/h, checksum: %llu\n", names[k], time, handCount / time,
+			time * 1e9 / handCount, (unsigned long long)checksum);
+	}
+	return 0;
+}
+
+static int Benchmark_NormSuit(size_t handCount)
+{
+	// Single cards in 4 suits, like the old benchmark in ai.pkr.metastrategy.cpptest.
+	const uint64_t singleCards[4] = {1ULL << 32, 1ULL << 48, 1ULL << 16, 1ULL};
+	uint64_t checksum = 0;
+	double start = Now();
+	for(size_t i = 0; i < handCount; ++i)
+	{
+		norm_suit ns;
+		for(int c = 0; c < 4; ++c)
+		{
+			checksum += ns.convert(singleCards[c]);
+		}
+	}
+	double time = Now() - start;
+	printf("%-14s %.3f s, %.0f conv/s, checksum: %llu\n", "single card", time, handCount * 4 / time,
+		(unsigned long long)checksum);
+
+	Rng rng(1);
+	vector<int32_t> cards;
+	GenerateHands(rng, handCount, cards);
+	vector<uint64_t> parts, result(handCount * 4);
+	HandsToParts(cards, parts);
+	checksum = 0;
+	start = Now();
+	for(size_t i = 0; i < handCount; ++i)
+	{
+		norm_suit ns;
+		for(int r = 0; r < 4; ++r)
+		{
+			checksum += ns.convert(parts[i * 4 + r]);
+		}
+	}
+	time = Now() - start;
+	printf("%-14s %.3f s, %.0f h/s, checksum: %llu\n", "7 cards", time, handCount / time, (unsigned long long)checksum);
+
+	start = Now();
+	NormSuit_ConvertBatch((uint32_t)handCount, 4, &parts[0], &result[0]);
+	time = Now() - start;
+	checksum = 0;
+	for(size_t i = 0; i < result.size(); ++i)
+	{
+		checksum += result[i];
+	}
+	printf("%-14s %.3f s, %.0f h/s, checksum: %llu\n", "7 cards batch", time, handCount / time,
+		(unsigned long long)checksum);
+	return 0;
+}
+
+static int Benchmark_Showdown(size_t boardsCount)
+{
+	Rng rng(1);
+	vector<int32_t> cards;
+	vector<uint32_t> ranks;
+	// 47 live cards of a river board, ranks of a real evaluator have a similar number of ties.
+	CreateShowdownHands(rng, 2, 47, 7462, cards, ranks);
+	size_t n = ranks.size();
+	vector<double> reach(n), win(n), tie(n), lose(n);
+	for(size_t i = 0; i < n; ++i)
+	{
+		reach[i] = rng.Next(1000000) / 1e6;
+	}
+
+	double checksum = 0;
+	size_t refCount = max<size_t>(boardsCount / 100, 1);
+	double start = Now();
+	for(size_t b = 0; b < refCount; ++b)
+	{
+		ShowdownRef(2, n, &cards[0], &ranks[0], &reach[0], &win[0], &tie[0], &lose[0]);
+		checksum += win[b % n];
+	}
+	double refTime = (Now() - start) / refCount;
+	printf("%-18s %.6f s/board, checksum: %.6f\n", "pairwise", refTime, checksum);
+
+	checksum = 0;
+	start = Now();
+	for(size_t b = 0; b < boardsCount; ++b)
+	{
+		showdown_kernel kernel;
+		kernel.set_hands(2, n, &cards[0], &ranks[0]);
+		kernel.evaluate(&reach[0], &win[0], &tie[0], &lose[0]);
+		checksum += win[b % n];
+	}
+	double sortTime = (Now() - start) / boardsCount;
+	printf("%-18s %.6f s/board, checksum: %.6f, speedup: %.1f\n", "kernel with sort", sortTime, checksum,
+		refTime / sortTime);
+
+	showdown_kernel kernel;
+	kernel.set_hands(2, n, &cards[0], &ranks[0]);
+	checksum = 0;
+	start = Now();
+	for(size_t b = 0; b < boardsCount; ++b)
+	{
+		kernel.evaluate(&reach[0], &win[0], &tie[0], &lose[0]);
+		checksum += win[b % n];
+	}
+	double time = (Now() - start) / boardsCount;
+	printf("%-18s %.6f s/board, checksum: %.6f, speedup: %.1f\n", "kernel sorted", time, checksum, refTime / time);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc >= 2 && strcmp(argv[1], "test") == 0)
+	{
+		if(argc >= 3)
+		{
+			_tempDir = argv[2];
+		}
+		return Test();
+	}
+	if(argc >= 3 && strcmp(argv[1], "benchmark-lut7") == 0)
+	{
+		return Benchmark_LutEvaluator7(argv[2], argc >= 4 ? (size_t)atol(argv[3]) : 1000000);
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark-iso") == 0)
+	{
+		return Benchmark_HandIsoIndexer(argc >= 3 ? (size_t)atol(argv[2]) : 10000000);
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark-normsuit") == 0)
+	{
+		return Benchmark_NormSuit(argc >= 3 ? (size_t)atol(argv[2]) : 10000000);
+	}
+	if(argc >= 2 && strcmp(argv[1], "benchmark-showdown") == 0)
+	{
+		return Benchmark_Showdown(argc >= 3 ? (size_t)atol(argv[2]) : 10000);
+	}
+	printf("Usage:\n"
+		"%s test [temp-dir]\n"
+		"%s benchmark-lut7 LutEvaluator7.dat [hands]\n"
+		"%s benchmark-iso [hands]\n"
+		"%s benchmark-normsuit [hands]\n"
+		"%s benchmark-showdown [boards]\n", argv[0], argv[0], argv[0], argv[0], argv[0]);
+	return 1;
+}
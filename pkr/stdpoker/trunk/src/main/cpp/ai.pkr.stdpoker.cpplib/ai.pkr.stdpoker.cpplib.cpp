@@ -0,0 +1,180 @@
+// ai.pkr.stdpoker.cpplib.cpp : Defines the exported functions of the library.
+//
+
+#include <string>
+#include "ai.pkr.stdpoker.cpplib.h"
+#include "lut_evaluator7.h"
+#include "hand_iso_indexer.h"
+#include "norm_suit.h"
+#include "showdown_kernel.h"
+
+using namespace ai::pkr::stdpoker;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL char _lastError[256];
+
+static void SetError(const std::string & error)
+{
+	std::size_t length = error.copy(_lastError, sizeof(_lastError) - 1);
+	_lastError[length] = 0;
+}
+
+struct LutEvaluator7
+{
+	lut_evaluator7 evaluator;
+};
+
+struct HandIsoIndexer
+{
+	hand_iso_indexer indexer;
+};
+
+struct ShowdownKernel
+{
+	showdown_kernel kernel;
+};
+
+extern "C"
+{
+
+AIPKRSTDPOKERCPPLIB_API LutEvaluator7 * LutEvaluator7_Open(const char * path)
+{
+	LutEvaluator7 * e = new LutEvaluator7;
+	if(!e->evaluator.open(path))
+	{
+		SetError(e->evaluator.error());
+		delete e;
+		return 0;
+	}
+	return e;
+}
+
+AIPKRSTDPOKERCPPLIB_API void LutEvaluator7_Close(LutEvaluator7 * e)
+{
+	delete e;
+}
+
+AIPKRSTDPOKERCPPLIB_API const char * LutEvaluator7_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRSTDPOKERCPPLIB_API const uint32_t * LutEvaluator7_GetLut(const LutEvaluator7 * e)
+{
+	return e->evaluator.lut();
+}
+
+AIPKRSTDPOKERCPPLIB_API uint32_t LutEvaluator7_GetLutSize(const LutEvaluator7 * e)
+{
+	return e->evaluator.lut_size();
+}
+
+AIPKRSTDPOKERCPPLIB_API uint32_t LutEvaluator7_Evaluate(const LutEvaluator7 * e, const int32_t * cards)
+{
+	return e->evaluator.evaluate(cards);
+}
+
+AIPKRSTDPOKERCPPLIB_API void LutEvaluator7_EvaluateBatch(const LutEvaluator7 * e, uint32_t n,
+	const int32_t * cards, uint32_t * values)
+{
+	e->evaluator.evaluate_batch(n, cards, values);
+}
+
+AIPKRSTDPOKERCPPLIB_API HandIsoIndexer * HandIsoIndexer_Create(int roundsCount, const int32_t * cardsPerRound)
+{
+	HandIsoIndexer * h = new HandIsoIndexer;
+	int cards[hand_iso_indexer::MAX_ROUNDS];
+	for(int r = 0; r < roundsCount && r < hand_iso_indexer::MAX_ROUNDS; ++r)
+	{
+		cards[r] = cardsPerRound[r];
+	}
+	if(!h->indexer.init(roundsCount, cards))
+	{
+		SetError(h->indexer.error());
+		delete h;
+		return 0;
+	}
+	return h;
+}
+
+AIPKRSTDPOKERCPPLIB_API void HandIsoIndexer_Destroy(HandIsoIndexer * h)
+{
+	delete h;
+}
+
+AIPKRSTDPOKERCPPLIB_API const char * HandIsoIndexer_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRSTDPOKERCPPLIB_API uint64_t HandIsoIndexer_GetSize(const HandIsoIndexer * h)
+{
+	return h->indexer.size();
+}
+
+AIPKRSTDPOKERCPPLIB_API int HandIsoIndexer_GetHandSize(const HandIsoIndexer * h)
+{
+	return h->indexer.hand_size();
+}
+
+AIPKRSTDPOKERCPPLIB_API uint64_t HandIsoIndexer_Index(const HandIsoIndexer * h, const int32_t * cards)
+{
+	return h->indexer.index(cards);
+}
+
+AIPKRSTDPOKERCPPLIB_API void HandIsoIndexer_IndexBatch(const HandIsoIndexer * h, uint32_t n,
+	const int32_t * cards, uint64_t * indexes)
+{
+	const int handSize = h->indexer.hand_size();
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		indexes[i] = h->indexer.index(cards + (std::size_t)i * handSize);
+	}
+}
+
+AIPKRSTDPOKERCPPLIB_API void HandIsoIndexer_Unindex(const HandIsoIndexer * h, uint64_t index, int32_t * cards)
+{
+	h->indexer.unindex(index, cards);
+}
+
+AIPKRSTDPOKERCPPLIB_API void NormSuit_ConvertBatch(uint32_t n, int roundsCount, const uint64_t * hands,
+	uint64_t * result)
+{
+	norm_suit::convert_batch(n, roundsCount, hands, result);
+}
+
+AIPKRSTDPOKERCPPLIB_API ShowdownKernel * ShowdownKernel_Create(int handSize, uint32_t n, const int32_t * cards,
+	const uint32_t * ranks)
+{
+	ShowdownKernel * k = new ShowdownKernel;
+	if(!k->kernel.set_hands(handSize, n, cards, ranks))
+	{
+		SetError(k->kernel.error());
+		delete k;
+		return 0;
+	}
+	return k;
+}
+
+AIPKRSTDPOKERCPPLIB_API void ShowdownKernel_Destroy(ShowdownKernel * k)
+{
+	delete k;
+}
+
+AIPKRSTDPOKERCPPLIB_API const char * ShowdownKernel_GetLastError()
+{
+	return _lastError;
+}
+
+AIPKRSTDPOKERCPPLIB_API void ShowdownKernel_Evaluate(const ShowdownKernel * k, const double * oppReach,
+	double * win, double * tie, double * lose)
+{
+	k->kernel.evaluate(oppReach, win, tie, lose);
+}
+
+}
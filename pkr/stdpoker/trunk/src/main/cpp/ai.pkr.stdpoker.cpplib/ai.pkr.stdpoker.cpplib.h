@@ -0,0 +1,111 @@
+// C interface of ai.pkr.stdpoker.cpplib (ai.pkr.stdpoker.cpplib.dll on Windows,
+// libai.pkr.stdpoker.cpplib.so on Linux). Used by ai.pkr.stdpoker.CppLib (C#).
+//
+// All files within this library are compiled with the AIPKRSTDPOKERCPPLIB_EXPORTS
+// symbol defined. This symbol should not be defined on any project
+// that uses this library. This way any other project whose source files include
+// this file see AIPKRSTDPOKERCPPLIB_API functions as being imported, whereas the library
+// sees symbols defined with this macro as being exported.
+
+#ifndef AI_PKR_STDPOKER_CPPLIB_H
+#define AI_PKR_STDPOKER_CPPLIB_H
+
+#if defined(_WIN32)
+	#ifdef AIPKRSTDPOKERCPPLIB_EXPORTS
+		#define AIPKRSTDPOKERCPPLIB_API __declspec(dllexport)
+	#else
+		#define AIPKRSTDPOKERCPPLIB_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define AIPKRSTDPOKERCPPLIB_API __attribute__((visibility("default")))
+#else
+	#define AIPKRSTDPOKERCPPLIB_API
+#endif
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Opaque handle of a 7-card LUT evaluator.
+typedef struct LutEvaluator7 LutEvaluator7;
+
+/// Maps LutEvaluator7.dat. Returns 0 on error, see LutEvaluator7_GetLastError().
+AIPKRSTDPOKERCPPLIB_API LutEvaluator7 * LutEvaluator7_Open(const char * path);
+
+AIPKRSTDPOKERCPPLIB_API void LutEvaluator7_Close(LutEvaluator7 * e);
+
+/// Description of the last error of LutEvaluator7_Open() in this thread.
+AIPKRSTDPOKERCPPLIB_API const char * LutEvaluator7_GetLastError();
+
+/// Pointer to the LUT (same layout as LutEvaluator7.pLut), may be unaligned.
+AIPKRSTDPOKERCPPLIB_API const uint32_t * LutEvaluator7_GetLut(const LutEvaluator7 * e);
+
+/// Number of entries in the LUT.
+AIPKRSTDPOKERCPPLIB_API uint32_t LutEvaluator7_GetLutSize(const LutEvaluator7 * e);
+
+/// Evaluates card indexes cards[0..6].
+AIPKRSTDPOKERCPPLIB_API uint32_t LutEvaluator7_Evaluate(const LutEvaluator7 * e, const int32_t * cards);
+
+/// Evaluates n hands, cards of hand i are cards[7*i .. 7*i+6], the value is stored to values[i].
+AIPKRSTDPOKERCPPLIB_API void LutEvaluator7_EvaluateBatch(const LutEvaluator7 * e, uint32_t n,
+	const int32_t * cards, uint32_t * values);
+
+/// Opaque handle of a suit-isomorphic hand indexer.
+typedef struct HandIsoIndexer HandIsoIndexer;
+
+/// Creates an indexer for hands of roundsCount rounds, cardsPerRound[r] cards in round r
+/// (for example {2, 3} for pocket + flop). Returns 0 on error, see HandIsoIndexer_GetLastError().
+AIPKRSTDPOKERCPPLIB_API HandIsoIndexer * HandIsoIndexer_Create(int roundsCount, const int32_t * cardsPerRound);
+
+AIPKRSTDPOKERCPPLIB_API void HandIsoIndexer_Destroy(HandIsoIndexer * h);
+
+/// Description of the last error of HandIsoIndexer_Create() in this thread.
+AIPKRSTDPOKERCPPLIB_API const char * HandIsoIndexer_GetLastError();
+
+/// Number of classes of suit-isomorphic hands (indexes are 0..size-1).
+AIPKRSTDPOKERCPPLIB_API uint64_t HandIsoIndexer_GetSize(const HandIsoIndexer * h);
+
+/// Number of cards of a hand.
+AIPKRSTDPOKERCPPLIB_API int HandIsoIndexer_GetHandSize(const HandIsoIndexer * h);
+
+/// Returns the index of a hand, cards of each round are unordered.
+AIPKRSTDPOKERCPPLIB_API uint64_t HandIsoIndexer_Index(const HandIsoIndexer * h, const int32_t * cards);
+
+/// Indexes n hands, hand i is cards[handSize*i ...], the index is stored to indexes[i].
+AIPKRSTDPOKERCPPLIB_API void HandIsoIndexer_IndexBatch(const HandIsoIndexer * h, uint32_t n,
+	const int32_t * cards, uint64_t * indexes);
+
+/// Stores a representative hand of the class to cards, cards of each round in ascending order.
+AIPKRSTDPOKERCPPLIB_API void HandIsoIndexer_Unindex(const HandIsoIndexer * h, uint64_t index, int32_t * cards);
+
+/// Normalizes suits of n hands (CardSet bits) like NormSuit.Convert(). Each hand consists of roundsCount parts
+/// converted subsequently (e.g. pocket and board), part r of hand i is hands[roundsCount*i + r],
+/// the result is stored to result at the same position.
+AIPKRSTDPOKERCPPLIB_API void NormSuit_ConvertBatch(uint32_t n, int roundsCount, const uint64_t * hands,
+	uint64_t * result);
+
+/// Opaque handle of a showdown kernel.
+typedef struct ShowdownKernel ShowdownKernel;
+
+/// Creates a kernel for n distinct hands of handSize (1 or 2) cards on a board, hand i is cards[handSize*i ...],
+/// its rank is ranks[i] (greater wins). Returns 0 on error, see ShowdownKernel_GetLastError().
+AIPKRSTDPOKERCPPLIB_API ShowdownKernel * ShowdownKernel_Create(int handSize, uint32_t n, const int32_t * cards,
+	const uint32_t * ranks);
+
+AIPKRSTDPOKERCPPLIB_API void ShowdownKernel_Destroy(ShowdownKernel * k);
+
+/// Description of the last error of ShowdownKernel_Create() in this thread.
+AIPKRSTDPOKERCPPLIB_API const char * ShowdownKernel_GetLastError();
+
+/// For each hand i stores to win[i], tie[i], lose[i] the sums of oppReach over the hands without common cards
+/// with lower, equal and greater rank. Any of the result pointers may be 0.
+AIPKRSTDPOKERCPPLIB_API void ShowdownKernel_Evaluate(const ShowdownKernel * k, const double * oppReach,
+	double * win, double * tie, double * lose);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include "hand_iso_indexer.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace stdpoker
+		{
+
+			// Definitions for the uses by reference (e.g. std::min()).
+			const int hand_iso_indexer::SUITS;
+			const int hand_iso_indexer::RANKS;
+			const int hand_iso_indexer::MAX_ROUNDS;
+
+			bool hand_iso_indexer::init(int rounds_count, const int * cards_per_round)
+			{
+				_rounds_count = 0;
+				_size = 0;
+				_configs.clear();
+				_config_by_rank.clear();
+				if(rounds_count < 1 || rounds_count > MAX_ROUNDS)
+				{
+					return fail("unsupported number of rounds");
+				}
+				for(int n = 0; n <= RANKS; ++n)
+				{
+					for(int k = 0; k <= RANKS; ++k)
+					{
+						_combin[n][k] = k == 0 ? 1 : (n == 0 ? 0 : _combin[n - 1][k - 1] + _combin[n - 1][k]);
+					}
+				}
+				_hand_size = 0;
+				uint64_t configsCount = 1;
+				for(int r = 0; r < rounds_count; ++r)
+				{
+					if(cards_per_round[r] < 1 || cards_per_round[r] > RANKS * SUITS)
+					{
+						return fail("unsupported number of cards in a round");
+					}
+					_cards_per_round[r] = cards_per_round[r];
+					_config_radix[r] = (uint32_t)configsCount;
+					_hand_size += cards_per_round[r];
+					configsCount *= std::min(cards_per_round[r], RANKS) + 1;
+					// The table of sorted tuples of configurations has C(configsCount + 3, 4) entries.
+					if(configsCount > MAX_SUIT_CONFIGS)
+					{
+						return fail("too many suit configurations");
+					}
+				}
+				if(_hand_size > RANKS * SUITS)
+				{
+					return fail("too many cards");
+				}
+				_rounds_count = rounds_count;
+				_configs_count = (uint32_t)configsCount;
+
+				// Enumerate sorted tuples of suit configurations that make a hand.
+				_config_by_rank.assign((std::size_t)binomial(_configs_count + 3, 4), -1);
+				uint32_t c[SUITS];
+				for(c[0] = 0; c[0] < _configs_count; ++c[0])
+				{
+					for(c[1] = 0; c[1] <= c[0]; ++c[1])
+					{
+						for(c[2] = 0; c[2] <= c[1]; ++c[2])
+						{
+							for(c[3] = 0; c[3] <= c[2]; ++c[3])
+							{
+								bool isHand = true;
+								for(int r = 0; r < _rounds_count && isHand; ++r)
+								{
+									int count = 0;
+									for(int s = 0; s < SUITS; ++s)
+									{
+										count += (c[s] / _config_radix[r]) % (std::min(_cards_per_round[r], RANKS) + 1);
+									}
+									isHand = count == _cards_per_round[r];
+								}
+								for(int s = 0; s < SUITS && isHand; ++s)
+								{
+									isHand = config_space(c[s]) > 0;
+								}
+								if(!isHand)
+								{
+									continue;
+								}
+								config_info ci;
+								ci.offset = _size;
+								ci.groups_count = 0;
+								uint64_t configSize = 1;
+								for(int s = 0; s < SUITS; )
+								{
+									ci.suit_config[s] = c[s];
+									int m = 1;
+									for(; s + m < SUITS && c[s + m] == c[s]; ++m)
+									{
+										ci.suit_config[s + m] = c[s];
+									}
+									// Multisets of m rank indexes, limited to keep the ranking in 64 bits.
+									uint64_t space = config_space(c[s]);
+									long double groupSize = 1;
+									for(int i = 0; i < m; ++i)
+									{
+										groupSize = groupSize * (space + m - 1 - i) / (i + 1);
+									}
+									if(groupSize >= (long double)(1ULL << 61))
+									{
+										return fail("too many hands");
+									}
+									ci.group_multiplicity[ci.groups_count] = m;
+									ci.group_size[ci.groups_count] = binomial(space + m - 1, m);
+									if(configSize > (UINT64_MAX >> 2) / ci.group_size[ci.groups_count])
+									{
+										return fail("too many hands");
+									}
+									configSize *= ci.group_size[ci.groups_count];
+									++ci.groups_count;
+									s += m;
+								}
+								if(_size > (UINT64_MAX >> 2) - configSize)
+								{
+									return fail("too many hands");
+								}
+								_size += configSize;
+								_config_by_rank[(std::size_t)multiset_rank4(c[0], c[1], c[2], c[3])] = (int32_t)_configs.size();
+								_configs.push_back(ci);
+							}
+						}
+					}
+				}
+				return true;
+			}
+
+			uint64_t hand_iso_indexer::config_space(uint32_t config) const
+			{
+				uint64_t space = 1;
+				int used = 0;
+				for(int r = 0; r < _rounds_count; ++r)
+				{
+					int count = (config / _config_radix[r]) % (std::min(_cards_per_round[r], RANKS) + 1);
+					if(used + count > RANKS)
+					{
+						return 0;
+					}
+					space *= _combin[RANKS - used][count];
+					used += count;
+				}
+				return space;
+			}
+
+			uint64_t hand_iso_indexer::find_binomial(uint64_t value, int k, uint64_t limit)
+			{
+				// C(k - 1, k) == 0 <= value.
+				uint64_t lo = k - 1, hi = limit - 1;
+				while(lo < hi)
+				{
+					uint64_t mid = lo + (hi - lo + 1) / 2;
+					if(binomial(mid, k) <= value)
+					{
+						lo = mid;
+					}
+					else
+					{
+						hi = mid - 1;
+					}
+				}
+				return lo;
+			}
+
+			void hand_iso_indexer::unindex(uint64_t index, int32_t * cards) const
+			{
+				// Find the configuration by the offset.
+				std::size_t k = 0;
+				{
+					std::size_t lo = 0, hi = _configs.size() - 1;
+					while(lo < hi)
+					{
+						std::size_t mid = lo + (hi - lo + 1) / 2;
+						if(index < _configs[mid].offset)
+						{
+							hi = mid - 1;
+						}
+						else
+						{
+							lo = mid;
+						}
+					}
+					k = lo;
+				}
+				const config_info & ci = _configs[k];
+				uint64_t rest = index - ci.offset;
+
+				// Rank indexes of the suits.
+				uint64_t rankIndexes[SUITS];
+				int groupStart[SUITS];
+				for(int g = 0, s = 0; g < ci.groups_count; ++g)
+				{
+					groupStart[g] = s;
+					s += ci.group_multiplicity[g];
+				}
+				for(int g = ci.groups_count - 1; g >= 0; --g)
+				{
+					uint64_t rank = rest % ci.group_size[g];
+					rest /= ci.group_size[g];
+					const int m = ci.group_multiplicity[g];
+					uint64_t limit = config_space(ci.suit_config[groupStart[g]]) + m - 1;
+					for(int i = 0; i < m; ++i)
+					{
+						uint64_t j = find_binomial(rank, m - i, limit);
+						rank -= binomial(j, m - i);
+						rankIndexes[groupStart[g] + i] = j - (m - 1 - i);
+						limit = j;
+					}
+				}
+
+				// Rank sets of the suits, suit s of the representative is the s-th sorted suit.
+				uint64_t roundCards[MAX_ROUNDS] = {0};
+				for(int s = 0; s < SUITS; ++s)
+				{
+					const uint32_t config = ci.suit_config[s];
+					int counts[MAX_ROUNDS];
+					int available[MAX_ROUNDS];
+					int used = 0;
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						counts[r] = (config / _config_radix[r]) % (std::min(_cards_per_round[r], RANKS) + 1);
+						available[r] = RANKS - used;
+						used += counts[r];
+					}
+					uint64_t colex[MAX_ROUNDS];
+					uint64_t rankIndex = rankIndexes[s];
+					for(int r = _rounds_count - 1; r >= 0; --r)
+					{
+						uint64_t n = _combin[available[r]][counts[r]];
+						colex[r] = rankIndex % n;
+						rankIndex /= n;
+					}
+					uint32_t usedRanks = 0;
+					for(int r = 0; r < _rounds_count; ++r)
+					{
+						// Unrank the colex index to positions among the available ranks.
+						int positions[RANKS];
+						uint64_t value = colex[r];
+						int x = available[r];
+						for(int i = counts[r] - 1; i >= 0; --i)
+						{
+							do
+							{
+								--x;
+							} while(_combin[x][i + 1] > value);
+							positions[i] = x;
+							value -= _combin[x][i + 1];
+						}
+						uint32_t set = 0;
+						for(int rank = 0, pos = 0, i = 0; rank < RANKS && i < counts[r]; ++rank)
+						{
+							if(usedRanks & (1u << rank))
+							{
+								continue;
+							}
+							if(pos == positions[i])
+							{
+								set |= 1u << rank;
+								++i;
+							}
+							++pos;
+						}
+						usedRanks |= set;
+						roundCards[r] |= (uint64_t)set << (s * RANKS);
+					}
+				}
+				for(int r = 0, c = 0; r < _rounds_count; ++r)
+				{
+					for(uint64_t rest = roundCards[r]; rest != 0; rest &= rest - 1)
+					{
+						int card = 0;
+						for(uint64_t bit = rest & (0 - rest); bit > 1; bit >>= 1)
+						{
+							++card;
+						}
+						cards[c++] = card;
+					}
+				}
+			}
+
+			bool hand_iso_indexer::fail(const std::string & error)
+			{
+				_error = error;
+				return false;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,229 @@
+#ifndef AI_PKR_STDPOKER_CPPLIB_HAND_ISO_INDEXER_H
+#define AI_PKR_STDPOKER_CPPLIB_HAND_ISO_INDEXER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AI_PKR_STDPOKER_POPCOUNT32(x) ((int)__popcnt(x))
+#else
+#define AI_PKR_STDPOKER_POPCOUNT32(x) __builtin_popcount(x)
+#endif
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace stdpoker
+		{
+
+			/** Perfect hash of hands of StdDeck up to suit isomorphism: maps each class of
+			suit-isomorphic hands to a dense index 0..size()-1 in O(1), and back.
+
+			A hand consists of rounds (groups of cards), cards within a round are unordered.
+			For example, rounds {2, 3} index pocket + flop (1286792 classes), {2, 4} pocket + turn board
+			(13960050), {5} a river board (134459).
+
+			Cards are StdDeck indexes (suit * 13 + rank). The cards of a suit form a sequence of
+			rank sets, one per round. Its shape (number of cards in each round) is the suit configuration,
+			the rank sets are indexed by colex ranks within the configuration. A hand is canonized by sorting
+			the suits by (configuration, rank index) descending. The index of the hand is the offset of the
+			sorted tuple of configurations plus the mixed-radix number of the multiset ranks of the rank indexes
+			of the suits with equal configuration.
+			*/
+			class hand_iso_indexer
+			{
+			public:
+
+				static const int SUITS = 4;
+				static const int RANKS = 13;
+				static const int MAX_ROUNDS = 8;
+
+				hand_iso_indexer() : _rounds_count(0), _hand_size(0), _size(0)
+				{
+				}
+
+				/** Sets up the indexer.
+				@param cards_per_round number of cards in each round.
+				@return false on error, see error().
+				*/
+				bool init(int rounds_count, const int * cards_per_round);
+
+				/// Description of the last error.
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				int rounds_count() const
+				{
+					return _rounds_count;
+				}
+
+				/// Number of cards of a hand.
+				int hand_size() const
+				{
+					return _hand_size;
+				}
+
+				/// Number of classes of isomorphic hands.
+				uint64_t size() const
+				{
+					return _size;
+				}
+
+				/// Returns the index of hand cards[0..hand_size()-1].
+				uint64_t index(const int32_t * cards) const
+				{
+					uint32_t rankSets[SUITS][MAX_ROUNDS] = {{0}};
+					for(int r = 0, c = 0; r < _rounds_count; ++r)
+					{
+						for(int end = c + _cards_per_round[r]; c < end; ++c)
+						{
+							const int card = cards[c];
+							rankSets[card / RANKS][r] |= 1u << (card % RANKS);
+						}
+					}
+					// Key of a suit: configuration in the high bits, rank index in the low bits.
+					uint64_t keys[SUITS];
+					for(int s = 0; s < SUITS; ++s)
+					{
+						uint32_t used = 0;
+						uint32_t config = 0;
+						uint64_t rankIndex = 0;
+						for(int r = 0; r < _rounds_count; ++r)
+						{
+							const uint32_t set = rankSets[s][r];
+							const int count = AI_PKR_STDPOKER_POPCOUNT32(set);
+							config += count * _config_radix[r];
+							// Colex rank of the set among the ranks not used in the previous rounds.
+							uint64_t colex = 0;
+							int k = 0;
+							for(uint32_t rest = set; rest != 0; rest &= rest - 1)
+							{
+								uint32_t bit = rest & (0u - rest);
+								int pos = AI_PKR_STDPOKER_POPCOUNT32((bit - 1) & ~used);
+								colex += _combin[pos][++k];
+							}
+							rankIndex = rankIndex * _combin[RANKS - AI_PKR_STDPOKER_POPCOUNT32(used)][count] + colex;
+							used |= set;
+						}
+						keys[s] = ((uint64_t)config << RANK_INDEX_BITS) | rankIndex;
+					}
+					sort_descending(keys);
+
+					const uint32_t c0 = (uint32_t)(keys[0] >> RANK_INDEX_BITS);
+					const uint32_t c1 = (uint32_t)(keys[1] >> RANK_INDEX_BITS);
+					const uint32_t c2 = (uint32_t)(keys[2] >> RANK_INDEX_BITS);
+					const uint32_t c3 = (uint32_t)(keys[3] >> RANK_INDEX_BITS);
+					const config_info & ci = _configs[_config_by_rank[multiset_rank4(c0, c1, c2, c3)]];
+
+					uint64_t index = 0;
+					for(int g = 0, s = 0; g < ci.groups_count; ++g)
+					{
+						const int m = ci.group_multiplicity[g];
+						// Multiset rank of the (descending) rank indexes.
+						uint64_t rank = 0;
+						for(int i = 0; i < m; ++i, ++s)
+						{
+							rank += binomial((keys[s] & RANK_INDEX_MASK) + m - 1 - i, m - i);
+						}
+						index = index * ci.group_size[g] + rank;
+					}
+					return ci.offset + index;
+				}
+
+				/** Restores a representative hand of the class to cards[0..hand_size()-1].
+				Cards of each round are in ascending order.
+				*/
+				void unindex(uint64_t index, int32_t * cards) const;
+
+				/// C(n, k) for k <= SUITS, the result must fit in 64 bits.
+				static uint64_t binomial(uint64_t n, int k)
+				{
+					if((uint64_t)k > n)
+					{
+						return 0;
+					}
+					uint64_t result = 1;
+					for(int i = 0; i < k; ++i)
+					{
+						result = result * (n - i) / (i + 1);
+					}
+					return result;
+				}
+
+			private:
+
+				static const int RANK_INDEX_BITS = 40;
+				static const uint64_t MAX_SUIT_CONFIGS = 64;
+				static const uint64_t RANK_INDEX_MASK = (1ULL << RANK_INDEX_BITS) - 1;
+
+				/// A sorted tuple of suit configurations.
+				struct config_info
+				{
+					/// Index of the first hand.
+					uint64_t offset;
+					/// Configuration of each suit, descending.
+					uint32_t suit_config[SUITS];
+					int groups_count;
+					/// Number of suits with equal configurations and the number of their multisets.
+					int group_multiplicity[SUITS];
+					uint64_t group_size[SUITS];
+				};
+
+				/// Rank of a multiset {c0 >= c1 >= c2 >= c3} among all multisets of 4 numbers.
+				static uint64_t multiset_rank4(uint64_t c0, uint64_t c1, uint64_t c2, uint64_t c3)
+				{
+					return binomial(c0 + 3, 4) + binomial(c1 + 2, 3) + binomial(c2 + 1, 2) + c3;
+				}
+
+				static void sort_descending(uint64_t * k)
+				{
+					// Sorting network for 4 elements.
+					compare_swap(k[0], k[1]);
+					compare_swap(k[2], k[3]);
+					compare_swap(k[0], k[2]);
+					compare_swap(k[1], k[3]);
+					compare_swap(k[1], k[2]);
+				}
+
+				static void compare_swap(uint64_t & a, uint64_t & b)
+				{
+					if(a < b)
+					{
+						uint64_t t = a;
+						a = b;
+						b = t;
+					}
+				}
+
+				/// Number of rank sets of a suit configuration.
+				uint64_t config_space(uint32_t config) const;
+
+				/// Largest x < limit with C(x, k) <= value.
+				static uint64_t find_binomial(uint64_t value, int k, uint64_t limit);
+
+				bool fail(const std::string & error);
+
+				int _rounds_count;
+				int _cards_per_round[MAX_ROUNDS];
+				int _hand_size;
+				uint64_t _size;
+				/// Configuration of a suit is a mixed-radix number of its card counts in each round.
+				uint32_t _config_radix[MAX_ROUNDS];
+				uint32_t _configs_count;
+				uint64_t _combin[RANKS + 1][RANKS + 1];
+				std::vector<config_info> _configs;
+				/// multiset_rank4() of the suit configurations -> index in _configs.
+				std::vector<int32_t> _config_by_rank;
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
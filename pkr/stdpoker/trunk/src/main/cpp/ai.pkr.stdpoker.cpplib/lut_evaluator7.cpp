@@ -0,0 +1,67 @@
+#include <cstring>
+#include "lut_evaluator7.h"
+#include <ai.lib.utils.cpp/bds_version.h>
+
+using namespace ai::lib::utils;
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace stdpoker
+		{
+
+			bool lut_evaluator7::open(const char * path)
+			{
+				close();
+				// The access is random, read the whole file ahead anyway, it is used completely.
+				if(!_file.open(path, mapped_file::advice_random | mapped_file::advice_huge_pages | mapped_file::advice_will_need))
+				{
+					return fail(_file.error());
+				}
+				const char * data = _file.data();
+				std::size_t size = _file.size();
+
+				bds_version version;
+				std::size_t pos = version.read(data, size);
+				if(pos == 0)
+				{
+					return fail(std::string("bad version header in ") + path);
+				}
+				uint32_t header[2]; // format id, LUT size
+				if(pos + sizeof(header) > size)
+				{
+					return fail(std::string("unexpected end of ") + path);
+				}
+				memcpy(header, data + pos, sizeof(header));
+				pos += sizeof(header);
+				if(header[0] != LUT_FILE_FORMAT_ID)
+				{
+					return fail(std::string("unsupported format id in ") + path);
+				}
+				_lut_size = header[1];
+				if((size - pos) / sizeof(uint32_t) < _lut_size || _lut_size < 52)
+				{
+					return fail(std::string("bad LUT size in ") + path);
+				}
+				_lut = data + pos;
+				return true;
+			}
+
+			void lut_evaluator7::close()
+			{
+				_file.close();
+				_lut = 0;
+				_lut_size = 0;
+			}
+
+			bool lut_evaluator7::fail(const std::string & error)
+			{
+				close();
+				_error = error;
+				return false;
+			}
+
+		}
+	}
+}
@@ -0,0 +1,153 @@
+#ifndef AI_PKR_STDPOKER_CPPLIB_LUT_EVALUATOR7_H
+#define AI_PKR_STDPOKER_CPPLIB_LUT_EVALUATOR7_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <ai.lib.utils.cpp/mapped_file.h>
+
+#if defined(__GNUC__)
+#define AI_PKR_STDPOKER_PREFETCH(p) __builtin_prefetch((const void*)(p))
+#else
+#include <xmmintrin.h>
+#define AI_PKR_STDPOKER_PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#endif
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace stdpoker
+		{
+
+			/** 7-card LUT evaluator, native version of ai.pkr.stdpoker.LutEvaluator7 (C#).
+			Reads the same LutEvaluator7.dat (see LutEvaluatorGenerator.SaveLut()).
+
+			The file is memory-mapped read-only, so all processes on a host share one copy of the table.
+			The table in the file is not necessarily 4-byte aligned (this depends on the length
+			of the version header), therefore the entries are read with unaligned loads
+			(memcpy, a plain load on x86).
+
+			A hand is evaluated by a chain of 7 dependent lookups. The scalar evaluate() waits for each
+			lookup in turn. evaluate_batch() runs the chains of BATCH_GROUP hands interleaved and
+			prefetches the next entry of each chain, so that the cache misses of independent hands overlap.
+			*/
+			class lut_evaluator7
+			{
+			public:
+
+				/// Must match LutEvaluator7.LutFileFormatID (C#).
+				static const uint32_t LUT_FILE_FORMAT_ID = 0;
+
+				/// Number of hands evaluated interleaved by evaluate_batch().
+				static const int BATCH_GROUP = 32;
+
+				lut_evaluator7() : _lut(0), _lut_size(0)
+				{
+				}
+
+				/** Loads the LUT file.
+				@return false on error, see error().
+				*/
+				bool open(const char * path);
+
+				void close();
+
+				/// Description of the last error.
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				/// Pointer to the LUT, can be used for incremental evaluation like LutEvaluator7.pLut.
+				/// May be unaligned, see entry().
+				const uint32_t * lut() const
+				{
+					return (const uint32_t *)_lut;
+				}
+
+				/// Returns LUT entry i.
+				uint32_t entry(uint32_t i) const
+				{
+					uint32_t value;
+					memcpy(&value, _lut + (std::size_t)i * 4, 4);
+					return value;
+				}
+
+				/// Number of entries in the LUT.
+				uint32_t lut_size() const
+				{
+					return _lut_size;
+				}
+
+				/// Evaluates card indexes c[0..6].
+				uint32_t evaluate(const int32_t * c) const
+				{
+					uint32_t value = entry(c[0]);
+					value = entry(value + c[1]);
+					value = entry(value + c[2]);
+					value = entry(value + c[3]);
+					value = entry(value + c[4]);
+					value = entry(value + c[5]);
+					return entry(value + c[6]);
+				}
+
+				/** Evaluates n hands. The cards of hand i are cards[7*i .. 7*i+6],
+				the value is stored to values[i].
+				*/
+				void evaluate_batch(std::size_t n, const int32_t * cards, uint32_t * values) const
+				{
+					for(; n >= BATCH_GROUP; n -= BATCH_GROUP, cards += 7 * BATCH_GROUP, values += BATCH_GROUP)
+					{
+						evaluate_group<BATCH_GROUP>(cards, values);
+					}
+					for(; n > 0; --n, cards += 7, ++values)
+					{
+						*values = evaluate(cards);
+					}
+				}
+
+			private:
+
+				template<int G>
+				void evaluate_group(const int32_t * cards, uint32_t * values) const
+				{
+					uint32_t v[G];
+					// The first lookup is in the root state, it is always in cache.
+					for(int j = 0; j < G; ++j)
+					{
+						v[j] = entry(cards[7 * j]);
+						AI_PKR_STDPOKER_PREFETCH(_lut + (std::size_t)(v[j] + cards[7 * j + 1]) * 4);
+					}
+					for(int s = 1; s < 6; ++s)
+					{
+						for(int j = 0; j < G; ++j)
+						{
+							v[j] = entry(v[j] + cards[7 * j + s]);
+							AI_PKR_STDPOKER_PREFETCH(_lut + (std::size_t)(v[j] + cards[7 * j + s + 1]) * 4);
+						}
+					}
+					for(int j = 0; j < G; ++j)
+					{
+						values[j] = entry(v[j] + cards[7 * j + 6]);
+					}
+				}
+
+				bool fail(const std::string & error);
+
+				// Not copyable.
+				lut_evaluator7(const lut_evaluator7 &);
+				lut_evaluator7 & operator = (const lut_evaluator7 &);
+
+				ai::lib::utils::mapped_file _file;
+				const char * _lut;
+				uint32_t _lut_size;
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef AI_PKR_STDPOKER_CPPLIB_NORM_SUIT_H
+#define AI_PKR_STDPOKER_CPPLIB_NORM_SUIT_H
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace stdpoker
+		{
+
+			/** Native version of NormSuit (C#): converts a hand to a suit-equivalent hand by normalizing suits.
+			Hands are CardSet bits (suit s in bits 16*s .. 16*s+15).
+
+			The conversion is incremental: convert() can be called subsequently on the pocket, flop,
+			turn and river, the suits seen before keep their new suits. New suits of a call are ordered
+			by their cards descending (ties: the suit with less index wins) and get the next free suits.
+			The results are identical to NormSuit.Convert().
+
+			The object is a few bytes and can be copied to reuse a partial transform, for example
+			the state after the pocket for all boards (see convert_batch()).
+			*/
+			class norm_suit
+			{
+			public:
+
+				static const int SUITS = 4;
+
+				norm_suit()
+				{
+					reset();
+				}
+
+				/// Resets the conversion to convert a new hand.
+				void reset()
+				{
+					for(int i = 0; i < SUITS; ++i)
+					{
+						_shift[i] = -1;
+					}
+					_suits_count = 0;
+				}
+
+				/// Converts the next part of the hand.
+				uint64_t convert(uint64_t hand)
+				{
+					uint64_t bits = 0;
+					// Key of a new suit: its cards in the high bits, (3 - suit) in the low bits, 0 for others.
+					uint32_t keys[SUITS];
+					for(int i = 0; i < SUITS; ++i)
+					{
+						const uint32_t s = (uint32_t)(hand >> (16 * i)) & 0xFFFF;
+						const int shift = _shift[i];
+						const uint64_t mappedMask = 0 - (uint64_t)(shift >= 0);
+						bits |= ((uint64_t)s << (shift & 63)) & mappedMask;
+						const uint32_t newMask = (0 - (uint32_t)(s != 0)) & ~(uint32_t)mappedMask;
+						keys[i] = ((s << 2) | (3 - i)) & newMask;
+					}
+					if((keys[0] | keys[1] | keys[2] | keys[3]) == 0)
+					{
+						return bits;
+					}
+					// Sorting network, descending.
+					compare_swap(keys[0], keys[1]);
+					compare_swap(keys[2], keys[3]);
+					compare_swap(keys[0], keys[2]);
+					compare_swap(keys[1], keys[3]);
+					compare_swap(keys[1], keys[2]);
+					for(int j = 0; j < SUITS && keys[j] != 0; ++j)
+					{
+						const int suit = 3 - (int)(keys[j] & 3);
+						_shift[suit] = (int8_t)(_suits_count++ << 4);
+						bits |= (uint64_t)(keys[j] >> 2) << _shift[suit];
+					}
+					return bits;
+				}
+
+				/** Converts n hands consisting of rounds_count parts each, starting from a reset state.
+				Part r of hand i is hands[rounds_count * i + r], the result is stored at the same position.
+				*/
+				static void convert_batch(std::size_t n, int rounds_count, const uint64_t * hands, uint64_t * result)
+				{
+					for(std::size_t i = 0; i < n; ++i)
+					{
+						norm_suit ns;
+						for(int r = 0; r < rounds_count; ++r)
+						{
+							result[i * rounds_count + r] = ns.convert(hands[i * rounds_count + r]);
+						}
+					}
+				}
+
+				/// Converts n hands, each starting from a copy of this object (e.g. after the pocket).
+				void convert_batch(std::size_t n, const uint64_t * hands, uint64_t * result) const
+				{
+					for(std::size_t i = 0; i < n; ++i)
+					{
+						norm_suit ns(*this);
+						result[i] = ns.convert(hands[i]);
+					}
+				}
+
+				/// New suit of suit s, -1 if the suit was not seen yet.
+				int suit_map(int s) const
+				{
+					return _shift[s] < 0 ? -1 : _shift[s] >> 4;
+				}
+
+				static int count_suits(uint64_t hand)
+				{
+					int count = 0;
+					for(int i = 0; i < SUITS; ++i)
+					{
+						count += ((hand >> (16 * i)) & 0xFFFF) != 0;
+					}
+					return count;
+				}
+
+			private:
+
+				static void compare_swap(uint32_t & a, uint32_t & b)
+				{
+					const uint32_t hi = a > b ? a : b;
+					const uint32_t lo = a > b ? b : a;
+					a = hi;
+					b = lo;
+				}
+
+				/// Position of the new suit (0, 16, 32, 48) for each suit, -1: not seen yet.
+				int8_t _shift[SUITS];
+				int _suits_count;
+			};
+
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include "showdown_kernel.h"
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace stdpoker
+		{
+
+			bool showdown_kernel::set_hands(int hand_size, std::size_t n, const int32_t * cards, const uint32_t * ranks)
+			{
+				if(hand_size != 1 && hand_size != 2)
+				{
+					return fail("hand size must be 1 or 2");
+				}
+				if(n == 0 || n > 0xFFFFFFFFu)
+				{
+					return fail("wrong number of hands");
+				}
+				_hand_size = hand_size;
+				_cards.resize(n);
+				uint64_t pairs[MAX_CARDS] = {0};
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					hand_cards & h = _cards[i];
+					h.c[1] = 0;
+					for(int k = 0; k < hand_size; ++k)
+					{
+						int32_t c = cards[i * hand_size + k];
+						if(c < 0 || c >= MAX_CARDS)
+						{
+							return fail("card out of range");
+						}
+						h.c[k] = (uint8_t)c;
+					}
+					if(hand_size == 2)
+					{
+						if(h.c[0] == h.c[1])
+						{
+							return fail("cards of a hand must be different");
+						}
+						// The correction for the hero hand requires distinct hands.
+						uint64_t & p = pairs[std::min(h.c[0], h.c[1])];
+						uint64_t bit = 1ULL << std::max(h.c[0], h.c[1]);
+						if(p & bit)
+						{
+							return fail("hands must be distinct");
+						}
+						p |= bit;
+					}
+					else
+					{
+						if(pairs[0] & (1ULL << h.c[0]))
+						{
+							return fail("hands must be distinct");
+						}
+						pairs[0] |= 1ULL << h.c[0];
+					}
+				}
+
+				// Rank in the high bits, index in the low bits: a plain sort of integers, stable by the index.
+				_keys.resize(n);
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					_keys[i] = (uint64_t)ranks[i] << 32 | i;
+				}
+				std::sort(_keys.begin(), _keys.end());
+				_order.resize(n);
+				_group_begin.clear();
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					_order[i] = (uint32_t)_keys[i];
+					if(i == 0 || (_keys[i] >> 32) != (_keys[i - 1] >> 32))
+					{
+						_group_begin.push_back((uint32_t)i);
+					}
+				}
+				_group_begin.push_back((uint32_t)n);
+				return true;
+			}
+
+		}
+	}
+}
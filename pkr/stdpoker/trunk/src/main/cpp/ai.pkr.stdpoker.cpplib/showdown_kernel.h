@@ -0,0 +1,189 @@
+#ifndef AI_PKR_STDPOKER_CPPLIB_SHOWDOWN_KERNEL_H
+#define AI_PKR_STDPOKER_CPPLIB_SHOWDOWN_KERNEL_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ai
+{
+	namespace pkr
+	{
+		namespace stdpoker
+		{
+
+			/** Showdown of all hands of a board against an opponent reach vector.
+
+			The pairwise evaluation (for each hero hand sum over the opponent hands) costs O(n^2).
+			Here the hands are sorted by rank once in set_hands(), then evaluate() calculates for all hands
+			the sums of the opponent reach over the hands with lower, equal and greater rank in one sweep
+			over the rank groups, O(n) per reach vector.
+
+			Card removal: the opponent cannot hold a card of the hero. The sums of the reach of the hands
+			containing card c are kept per card, the hands sharing cards with the hero are subtracted
+			by inclusion-exclusion. For hands of 1 or 2 cards (the only sizes supported) this needs
+			the sums per card and the reach of the hero hand itself (the only hand containing both cards,
+			the hands must be distinct).
+
+			The hero and the opponent share the same set of hands, the reach of a hand that must
+			not be dealt (e.g. it intersects the board) should be 0.
+
+			T is the type of the reach and of the results (double for strategies, an integer type for counts).
+			*/
+			class showdown_kernel
+			{
+			public:
+				/// Cards are 0..MAX_CARDS-1.
+				static const int MAX_CARDS = 64;
+
+				showdown_kernel() : _hand_size(0)
+				{
+				}
+
+				/** Sets the hands: hand i has cards cards[hand_size * i .. hand_size * i + hand_size - 1]
+				and rank ranks[i] (greater rank wins). The hands are sorted here, the kernel can be used
+				for many reach vectors.
+				@return false on error, see error().
+				*/
+				bool set_hands(int hand_size, std::size_t n, const int32_t * cards, const uint32_t * ranks);
+
+				/// Description of the last error.
+				const std::string & error() const
+				{
+					return _error;
+				}
+
+				std::size_t hands_count() const
+				{
+					return _order.size();
+				}
+
+				int hand_size() const
+				{
+					return _hand_size;
+				}
+
+				/** For each hand i calculates win[i], tie[i] and lose[i]: the sums of opp_reach over the hands
+				without common cards with hand i with lower, equal and greater rank. Any of the results may be 0.
+				*/
+				template<class T> void evaluate(const T * opp_reach, T * win, T * tie, T * lose) const
+				{
+					if(_hand_size == 1)
+					{
+						evaluate_k<T, 1>(opp_reach, win, tie, lose);
+					}
+					else
+					{
+						evaluate_k<T, 2>(opp_reach, win, tie, lose);
+					}
+				}
+
+			private:
+				/// Cards of a hand (1 or 2).
+				struct hand_cards
+				{
+					uint8_t c[2];
+				};
+
+				template<class T, int K> void evaluate_k(const T * opp_reach, T * win, T * tie, T * lose) const
+				{
+					T total = 0;
+					T totalCard[MAX_CARDS] = {0};
+					if(lose)
+					{
+						for(std::size_t i = 0; i < _cards.size(); ++i)
+						{
+							const T r = opp_reach[i];
+							total += r;
+							for(int k = 0; k < K; ++k)
+							{
+								totalCard[_cards[i].c[k]] += r;
+							}
+						}
+					}
+					// less*: the hands of lower rank, equal*: the hands of the current rank group.
+					T lessTotal = 0;
+					T lessCard[MAX_CARDS] = {0};
+					T equalCard[MAX_CARDS] = {0};
+					for(std::size_t g = 0; g + 1 < _group_begin.size(); ++g)
+					{
+						const uint32_t * begin = &_order[0] + _group_begin[g];
+						const uint32_t * end = &_order[0] + _group_begin[g + 1];
+						T equalTotal = 0;
+						for(const uint32_t * o = begin; o < end; ++o)
+						{
+							const T r = opp_reach[*o];
+							equalTotal += r;
+							for(int k = 0; k < K; ++k)
+							{
+								equalCard[_cards[*o].c[k]] += r;
+							}
+						}
+						for(const uint32_t * o = begin; o < end; ++o)
+						{
+							const hand_cards & h = _cards[*o];
+							// A 2-card hero is counted in the sums of both his cards.
+							const T self = K == 2 ? opp_reach[*o] : 0;
+							T w = lessTotal, t = equalTotal + self;
+							for(int k = 0; k < K; ++k)
+							{
+								w -= lessCard[h.c[k]];
+								t -= equalCard[h.c[k]];
+							}
+							if(win)
+							{
+								win[*o] = w;
+							}
+							if(tie)
+							{
+								tie[*o] = t;
+							}
+							if(lose)
+							{
+								T l = total + self - w - t;
+								for(int k = 0; k < K; ++k)
+								{
+									l -= totalCard[h.c[k]];
+								}
+								lose[*o] = l;
+							}
+						}
+						for(const uint32_t * o = begin; o < end; ++o)
+						{
+							const T r = opp_reach[*o];
+							for(int k = 0; k < K; ++k)
+							{
+								equalCard[_cards[*o].c[k]] = 0;
+								lessCard[_cards[*o].c[k]] += r;
+							}
+						}
+						lessTotal += equalTotal;
+					}
+				}
+
+				bool fail(const std::string & error)
+				{
+					_error = error;
+					_order.clear();
+					_group_begin.clear();
+					_cards.clear();
+					return false;
+				}
+
+				int _hand_size;
+				/// Hand indexes sorted by rank ascending.
+				std::vector<uint32_t> _order;
+				/// Begin of each group of equal rank in _order, followed by _order.size().
+				std::vector<uint32_t> _group_begin;
+				std::vector<hand_cards> _cards;
+				/// Sort keys, a member to reuse the memory.
+				std::vector<uint64_t> _keys;
+				std::string _error;
+			};
+
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,237 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+using ai.lib.utils;
+using System.Reflection;
+using System.IO;
+
+namespace ai.pkr.stdpoker
+{
+    /// <summary>
+    /// Wrapper for the native library ai.pkr.stdpoker.cpplib.
+    /// </summary>
+    public unsafe class CppLib
+    {
+        #region LutEvaluator7
+
+        /// <summary>
+        /// Maps LutEvaluator7.dat read-only (shared by all processes). Returns a handle
+        /// or IntPtr.Zero on error (see LutEvaluator7_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern IntPtr LutEvaluator7_Open(string path);
+
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern void LutEvaluator7_Close(IntPtr e);
+
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern IntPtr LutEvaluator7_GetLastError();
+
+        /// <summary>
+        /// Pointer to the LUT, same layout as LutEvaluator7.pLut.
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern UInt32* LutEvaluator7_GetLut(IntPtr e);
+
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern UInt32 LutEvaluator7_GetLutSize(IntPtr e);
+
+        /// <summary>
+        /// Evaluates cards[0..6].
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern UInt32 LutEvaluator7_Evaluate(IntPtr e, int* cards);
+
+        /// <summary>
+        /// Evaluates n hands, cards of hand i are cards[7*i .. 7*i+6], the value is stored to values[i].
+        /// Use this for many hands: the lookups of independent hands are interleaved.
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern void LutEvaluator7_EvaluateBatch(IntPtr e, UInt32 n, int* cards, UInt32* values);
+
+        /// <summary>
+        /// Opens the default LUT (LutEvaluator7.LutPath), throws an exception on error.
+        /// </summary>
+        public static IntPtr LutEvaluator7_Open()
+        {
+            IntPtr e = LutEvaluator7_Open(LutEvaluator7.LutPath);
+            if (e == IntPtr.Zero)
+            {
+                throw new ApplicationException(Marshal.PtrToStringAnsi(LutEvaluator7_GetLastError()));
+            }
+            return e;
+        }
+
+        #endregion
+
+        #region HandIsoIndexer
+
+        /// <summary>
+        /// Creates an indexer of hands up to suit isomorphism, a hand consists of roundsCount rounds
+        /// of cardsPerRound[r] cards. Returns a handle or IntPtr.Zero on error (see HandIsoIndexer_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern IntPtr HandIsoIndexer_Create(int roundsCount, int* cardsPerRound);
+
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern void HandIsoIndexer_Destroy(IntPtr h);
+
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern IntPtr HandIsoIndexer_GetLastError();
+
+        /// <summary>
+        /// Number of classes of isomorphic hands.
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern UInt64 HandIsoIndexer_GetSize(IntPtr h);
+
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern int HandIsoIndexer_GetHandSize(IntPtr h);
+
+        /// <summary>
+        /// Index of the hand cards[0..handSize-1] (StdDeck indexes), cards of each round in any order.
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern UInt64 HandIsoIndexer_Index(IntPtr h, int* cards);
+
+        /// <summary>
+        /// Indexes n hands, hand i is cards[handSize*i .. handSize*i+handSize-1].
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern void HandIsoIndexer_IndexBatch(IntPtr h, UInt32 n, int* cards, UInt64* indexes);
+
+        /// <summary>
+        /// Stores a representative hand of the class to cards[0..handSize-1].
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern void HandIsoIndexer_Unindex(IntPtr h, UInt64 index, int* cards);
+
+        #endregion
+
+        #region NormSuit
+
+        /// <summary>
+        /// Normalizes suits of n hands (CardSet bits) like NormSuit.Convert(). A hand consists of roundsCount 
+        /// parts converted subsequently (e.g. pocket and board), part r of hand i is hands[roundsCount*i + r],
+        /// the result is stored to result at the same position.
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern void NormSuit_ConvertBatch(UInt32 n, int roundsCount, UInt64* hands, UInt64* result);
+
+        /// <summary>
+        /// Normalizes suits of the first n hands of the arrays, see above.
+        /// </summary>
+        public static void NormSuit_ConvertBatch(int n, int roundsCount, UInt64[] hands, UInt64[] result)
+        {
+            if (n < 0 || n * roundsCount > hands.Length || n * roundsCount > result.Length)
+            {
+                throw new ArgumentOutOfRangeException("n");
+            }
+            fixed (UInt64* pHands = hands, pResult = result)
+            {
+                NormSuit_ConvertBatch((UInt32)n, roundsCount, pHands, pResult);
+            }
+        }
+
+        #endregion
+
+        #region ShowdownKernel
+
+        /// <summary>
+        /// Creates a showdown kernel of n hands of handSize (1 or 2) cards (0..63), hand i is
+        /// cards[handSize*i .. handSize*i+handSize-1] and has rank ranks[i] (greater rank wins). 
+        /// Returns a handle or IntPtr.Zero on error (see ShowdownKernel_GetLastError()).
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern IntPtr ShowdownKernel_Create(int handSize, UInt32 n, int* cards, UInt32* ranks);
+
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern void ShowdownKernel_Destroy(IntPtr k);
+
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern IntPtr ShowdownKernel_GetLastError();
+
+        /// <summary>
+        /// For each hand i calculates the sums of oppReach over the hands without common cards 
+        /// with lower (win[i]), equal (tie[i]) and greater (lose[i]) rank in O(n).
+        /// Any of the results may be null.
+        /// </summary>
+        [DllImport("ai.pkr.stdpoker.cpplib.dll")]
+        public static extern void ShowdownKernel_Evaluate(IntPtr k, double* oppReach, double* win, double* tie, double* lose);
+
+        /// <summary>
+        /// Creates a showdown kernel, throws an exception on error.
+        /// </summary>
+        public static IntPtr ShowdownKernel_Create(int handSize, int[] cards, UInt32[] ranks)
+        {
+            if (cards.Length != handSize * ranks.Length)
+            {
+                throw new ArgumentException("Length of cards must be handSize * ranks.Length");
+            }
+            IntPtr k;
+            fixed (int* pCards = cards)
+            {
+                fixed (UInt32* pRanks = ranks)
+                {
+                    k = ShowdownKernel_Create(handSize, (UInt32)ranks.Length, pCards, pRanks);
+                }
+            }
+            if (k == IntPtr.Zero)
+            {
+                throw new ApplicationException(Marshal.PtrToStringAnsi(ShowdownKernel_GetLastError()));
+            }
+            return k;
+        }
+
+        #endregion
+
+        [DllImport("libdl.so.2")]
+        static extern IntPtr dlopen(string fileName, int flags);
+
+        public static void Init()
+        {
+            bool isUnix = Environment.OSVersion.Platform == PlatformID.Unix;
+            string platform = isUnix ? (System.IntPtr.Size == 8 ? "linux64" : "linux32")
+                : (System.IntPtr.Size == 8 ? "win64" : "win32");
+            string codeBase = CodeBase.Get(Assembly.GetExecutingAssembly());
+            string dllDir = Path.Combine(Path.GetDirectoryName(codeBase), platform);
+
+            string dllName = isUnix ? "libai.pkr.stdpoker.cpplib.so" : "ai.pkr.stdpoker.cpplib.dll";
+
+            string dllPath = Path.Combine(dllDir, dllName);
+
+            if (!System.IO.File.Exists(dllPath))
+            {
+                // In case we are in development folder (debug or release) try to load from bin.   
+                dllDir = Props.Global.Expand("${bds.BinDir}") + platform;
+                dllPath = Path.Combine(dllDir, dllName);
+                if (!System.IO.File.Exists(dllPath))
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+            }
+            if (isUnix)
+            {
+                // Load by full path, the DllImports are then resolved by the soname 
+                // (see the dllmap in ai.pkr.stdpoker.dll.config).
+                const int RTLD_NOW = 2, RTLD_GLOBAL = 0x100;
+                if (dlopen(dllPath, RTLD_NOW | RTLD_GLOBAL) == IntPtr.Zero)
+                {
+                    throw new ApplicationException(string.Format("Cannot load {0}", dllPath));
+                }
+                return;
+            }
+            string envPath = Environment.GetEnvironmentVariable("PATH");
+            string envPathL = envPath.ToLower() + ";";
+            if (envPathL.IndexOf(dllDir.ToLower() + ";") < 0)
+            {
+                Environment.SetEnvironmentVariable("PATH", dllDir + ";" + envPath, EnvironmentVariableTarget.Process);
+            }
+        }
+    }
+}
@@ -0,0 +1,165 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Runtime.InteropServices;
+
+namespace ai.pkr.stdpoker
+{
+    /// <summary>
+    /// Perfect hash of hands of StdDeck up to suit isomorphism (wrapper for the native hand_iso_indexer, 
+    /// see CppLib). Maps each class of hands that differ only by a permutation of suits 
+    /// to a dense index 0..Size-1 in constant time. 
+    /// A hand consists of rounds, the order of the cards within a round does not matter.
+    /// This allows to store values of hands (HS, AHVO, etc.) in flat arrays without keys.
+    /// </summary>
+    public unsafe class HandIsoIndexer : IDisposable
+    {
+        #region Public API
+
+        /// <summary>
+        /// Creates an indexer for hands of cardsPerRound.Length rounds, for example {2, 3} for pocket + flop.
+        /// </summary>
+        public HandIsoIndexer(params int[] cardsPerRound)
+        {
+            CppLib.Init();
+            fixed (int* p = cardsPerRound)
+            {
+                _handle = CppLib.HandIsoIndexer_Create(cardsPerRound.Length, p);
+            }
+            if (_handle == IntPtr.Zero)
+            {
+                throw new ApplicationException(Marshal.PtrToStringAnsi(CppLib.HandIsoIndexer_GetLastError()));
+            }
+            Size = CppLib.HandIsoIndexer_GetSize(_handle);
+            HandSize = CppLib.HandIsoIndexer_GetHandSize(_handle);
+        }
+
+        /// <summary>
+        /// Returns a shared indexer of hold'em hands: the pocket (round 0) and the board of boardSize cards (round 1).
+        /// For boardSize 0 the hand is the pocket only.
+        /// </summary>
+        public static HandIsoIndexer GetPocketBoard(int boardSize)
+        {
+            lock (_pocketBoard)
+            {
+                if (_pocketBoard[boardSize] == null)
+                {
+                    _pocketBoard[boardSize] = boardSize == 0 ? new HandIsoIndexer(2) : new HandIsoIndexer(2, boardSize);
+                }
+                return _pocketBoard[boardSize];
+            }
+        }
+
+        /// <summary>
+        /// Returns a shared indexer of boards of boardSize cards (a single round).
+        /// </summary>
+        public static HandIsoIndexer GetBoard(int boardSize)
+        {
+            lock (_board)
+            {
+                if (_board[boardSize] == null)
+                {
+                    _board[boardSize] = new HandIsoIndexer(boardSize);
+                }
+                return _board[boardSize];
+            }
+        }
+
+        /// <summary>
+        /// Number of classes of isomorphic hands.
+        /// </summary>
+        public UInt64 Size
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Number of cards in a hand.
+        /// </summary>
+        public int HandSize
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Returns the index of hand cards[0..HandSize-1].
+        /// </summary>
+        public UInt64 Index(int* cards)
+        {
+            return CppLib.HandIsoIndexer_Index(_handle, cards);
+        }
+
+        /// <summary>
+        /// Returns the index of hand cards[start..start+HandSize-1].
+        /// </summary>
+        public UInt64 Index(int[] cards, int start)
+        {
+            if (start < 0 || start + HandSize > cards.Length)
+            {
+                throw new ArgumentOutOfRangeException("start");
+            }
+            fixed (int* p = cards)
+            {
+                return CppLib.HandIsoIndexer_Index(_handle, p + start);
+            }
+        }
+
+        public UInt64 Index(int[] cards)
+        {
+            return Index(cards, 0);
+        }
+
+        /// <summary>
+        /// Stores a representative hand of the class to cards[0..HandSize-1], 
+        /// the cards of each round are in ascending order.
+        /// </summary>
+        public void Unindex(UInt64 index, int[] cards)
+        {
+            if (index >= Size || cards.Length < HandSize)
+            {
+                throw new ArgumentOutOfRangeException();
+            }
+            fixed (int* p = cards)
+            {
+                CppLib.HandIsoIndexer_Unindex(_handle, index, p);
+            }
+        }
+
+        public void Dispose()
+        {
+            Destroy();
+            GC.SuppressFinalize(this);
+        }
+
+        #endregion
+
+        #region Implementation
+
+        ~HandIsoIndexer()
+        {
+            Destroy();
+        }
+
+        void Destroy()
+        {
+            if (_handle != IntPtr.Zero)
+            {
+                CppLib.HandIsoIndexer_Destroy(_handle);
+                _handle = IntPtr.Zero;
+            }
+        }
+
+        IntPtr _handle;
+
+        static readonly HandIsoIndexer[] _pocketBoard = new HandIsoIndexer[6];
+        static readonly HandIsoIndexer[] _board = new HandIsoIndexer[6];
+
+        #endregion
+    }
+}
@@ -0,0 +1,148 @@
+﻿/* Copyright 2010-2012 Ivan Alles.
+   Licensed under the MIT License (see file LICENSE). */
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using NUnit.Framework;
+using ai.pkr.metagame;
+
+namespace ai.pkr.stdpoker.nunit
+{
+    /// <summary>
+    /// Unit tests for HandIsoIndexer. 
+    /// </summary>
+    [TestFixture]
+    public class HandIsoIndexer_Test
+    {
+        #region Tests
+
+        [Test]
+        public void Test_Size()
+        {
+            Assert.AreEqual(169, HandIsoIndexer.GetPocketBoard(0).Size);
+            Assert.AreEqual(1286792, HandIsoIndexer.GetPocketBoard(3).Size);
+            Assert.AreEqual(13960050, HandIsoIndexer.GetPocketBoard(4).Size);
+            Assert.AreEqual(123156254, HandIsoIndexer.GetPocketBoard(5).Size);
+            Assert.AreEqual(1755, HandIsoIndexer.GetBoard(3).Size);
+            Assert.AreEqual(16432, HandIsoIndexer.GetBoard(4).Size);
+            Assert.AreEqual(134459, HandIsoIndexer.GetBoard(5).Size);
+            Assert.AreEqual(7, HandIsoIndexer.GetPocketBoard(5).HandSize);
+        }
+
+        /// <summary>
+        /// Hands with permuted suits and shuffled cards within rounds must have the same index,
+        /// the representative hand must have the same index too.
+        /// </summary>
+        [Test]
+        public void Test_Random()
+        {
+            int rngSeed = (int)DateTime.Now.Ticks;
+            Console.WriteLine("RNG seed {0}", rngSeed);
+            Random rng = new Random(rngSeed);
+            for (int boardSize = 0; boardSize <= 5; ++boardSize)
+            {
+                if (boardSize == 1 || boardSize == 2)
+                {
+                    continue;
+                }
+                HandIsoIndexer indexer = HandIsoIndexer.GetPocketBoard(boardSize);
+                int handSize = 2 + boardSize;
+                for (int rep = 0; rep < 10000; ++rep)
+                {
+                    int[] hand = DealHand(rng, handSize);
+                    UInt64 index = indexer.Index(hand);
+                    Assert.Less(index, indexer.Size);
+
+                    int[] suits = new int[] { 0, 1, 2, 3 };
+                    for (int i = 3; i > 0; --i)
+                    {
+                        int j = rng.Next(i + 1);
+                        int t = suits[i]; suits[i] = suits[j]; suits[j] = t;
+                    }
+                    int[] other = new int[handSize];
+                    for (int c = 0; c < handSize; ++c)
+                    {
+                        other[c] = suits[hand[c] / 13] * 13 + hand[c] % 13;
+                    }
+                    Array.Reverse(other, 0, 2);
+                    Array.Reverse(other, 2, boardSize);
+                    Assert.AreEqual(index, indexer.Index(other));
+
+                    indexer.Unindex(index, other);
+                    Assert.AreEqual(index, indexer.Index(other));
+                }
+            }
+        }
+
+        [Test]
+        public void Test_Unindex()
+        {
+            HandIsoIndexer indexer = HandIsoIndexer.GetBoard(3);
+            int[] board = new int[3];
+            for (UInt64 i = 0; i < indexer.Size; ++i)
+            {
+                indexer.Unindex(i, board);
+                Assert.AreEqual(i, indexer.Index(board));
+            }
+        }
+
+        [Test]
+        public void Test_Error()
+        {
+            try
+            {
+                new HandIsoIndexer(20, 20, 20);
+                Assert.Fail("Exception expected");
+            }
+            catch (ApplicationException e)
+            {
+                Console.WriteLine("Expected exception: {0}", e.Message);
+            }
+        }
+
+        [Test]
+        [Category("Benchmark")]
+        public unsafe void Benchmark_Index()
+        {
+            Random rng = new Random(1);
+            int handCount = 1000000;
+            int[] cards = new int[7 * handCount];
+            for (int i = 0; i < handCount; ++i)
+            {
+                DealHand(rng, 7).CopyTo(cards, 7 * i);
+            }
+            HandIsoIndexer indexer = HandIsoIndexer.GetPocketBoard(5);
+            UInt64 checksum = 0;
+            DateTime startTime = DateTime.Now;
+            fixed (int* pCards = cards)
+            {
+                for (int i = 0; i < handCount; ++i)
+                {
+                    checksum += indexer.Index(pCards + 7 * i);
+                }
+            }
+            double runTime = (DateTime.Now - startTime).TotalSeconds;
+            Console.WriteLine("{0:#,#} hands in {1:0.000} s, {2:#,#} h/s, checksum: {3}",
+                handCount, runTime, handCount / runTime, checksum);
+        }
+
+        #endregion
+
+        #region Implementation
+
+        int[] DealHand(Random rng, int handSize)
+        {
+            int[] deck = StdDeck.Descriptor.FullDeckIndexes.ToArray();
+            for (int i = 0; i < handSize; ++i)
+            {
+                int j = i + rng.Next(deck.Length - i);
+                int t = deck[i]; deck[i] = deck[j]; deck[j] = t;
+            }
+            return deck.Take(handSize).ToArray();
+        }
+
+        #endregion
+    }
+}
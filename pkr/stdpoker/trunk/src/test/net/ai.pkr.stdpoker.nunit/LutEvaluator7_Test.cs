@@ -75,6 +75,39 @@ namespace ai.pkr.stdpoker.nunit
         }
 
 
+        [Test]
+        public void Test_Native_RandomCards()
+        {
+            CppLib.Init();
+            IntPtr e = CppLib.LutEvaluator7_Open();
+            try
+            {
+                int handCount = 1000003;
+                int rngSeed = (int)DateTime.Now.Ticks;
+                Console.WriteLine("Seed: {0}", rngSeed);
+                RandomHandGenerator randomHands = new RandomHandGenerator(rngSeed);
+                randomHands.Generate(handCount);
+                randomHands.SetMask(7);
+                int[] cards = GetCards(randomHands);
+                UInt32[] values = new UInt32[handCount];
+                fixed (int* pCards = cards)
+                fixed (UInt32* pValues = values)
+                {
+                    CppLib.LutEvaluator7_EvaluateBatch(e, (uint)handCount, pCards, pValues);
+                    for (int i = 0; i < handCount; ++i)
+                    {
+                        UInt32 expValue = LutEvaluator7.Evaluate(randomHands.hands[i].Cards);
+                        VerifyHandValue(expValue, CppLib.LutEvaluator7_Evaluate(e, pCards + 7 * i));
+                        VerifyHandValue(expValue, values[i]);
+                    }
+                }
+            }
+            finally
+            {
+                CppLib.LutEvaluator7_Close(e);
+            }
+        }
+
         [Test]
         [Explicit]
         public void Test_CountDistinctHandValues7()
@@ -327,10 +360,99 @@ namespace ai.pkr.stdpoker.nunit
             PrintResult(handCount * repCount, runTime, checksum);
         }
 
+        /// <summary>
+        /// Compares managed evaluation with native scalar and batch evaluation on the same hands.
+        /// </summary>
+        [Test]
+        [Category("Benchmark")]
+        public void Benchmark_RandomCards_Native()
+        {
+            int handCount = 1000000;
+#if DEBUG
+            int repCount = 1;
+#else
+            int repCount = 20;
+#endif
+            Console.WriteLine("Random hands: {0}, repetitions: {1}, total: {2}", handCount, repCount, handCount * repCount);
+
+            RandomHandGenerator randomHands = new RandomHandGenerator();
+            randomHands.Generate(handCount);
+            randomHands.SetMask(7);
+            int[] cards = GetCards(randomHands);
+            UInt32[] values = new UInt32[handCount];
+
+            CppLib.Init();
+            IntPtr e = CppLib.LutEvaluator7_Open();
+            try
+            {
+                // Force loading and JIT.
+                UInt32 checksum = LutEvaluator7.Evaluate(new int[] { 0, 1, 2, 3, 4, 5, 6 });
+                DateTime startTime = DateTime.Now;
+                for (int r = 0; r < repCount; ++r)
+                {
+                    for (int i = 0; i < handCount; ++i)
+                    {
+                        checksum += LutEvaluator7.Evaluate(randomHands.hands[i].Cards);
+                    }
+                }
+                double runTime = (DateTime.Now - startTime).TotalSeconds;
+                Console.Write("Managed: ");
+                PrintResult(handCount * repCount, runTime, checksum);
+
+                fixed (int* pCards = cards)
+                fixed (UInt32* pValues = values)
+                {
+                    checksum = CppLib.LutEvaluator7_Evaluate(e, pCards);
+                    startTime = DateTime.Now;
+                    for (int r = 0; r < repCount; ++r)
+                    {
+                        for (int i = 0; i < handCount; ++i)
+                        {
+                            checksum += CppLib.LutEvaluator7_Evaluate(e, pCards + 7 * i);
+                        }
+                    }
+                    runTime = (DateTime.Now - startTime).TotalSeconds;
+                    Console.Write("Native:  ");
+                    PrintResult(handCount * repCount, runTime, checksum);
+
+                    checksum = CppLib.LutEvaluator7_Evaluate(e, pCards);
+                    startTime = DateTime.Now;
+                    for (int r = 0; r < repCount; ++r)
+                    {
+                        CppLib.LutEvaluator7_EvaluateBatch(e, (uint)handCount, pCards, pValues);
+                        for (int i = 0; i < handCount; ++i)
+                        {
+                            checksum += pValues[i];
+                        }
+                    }
+                    runTime = (DateTime.Now - startTime).TotalSeconds;
+                    Console.Write("Batch:   ");
+                    PrintResult(handCount * repCount, runTime, checksum);
+                }
+            }
+            finally
+            {
+                CppLib.LutEvaluator7_Close(e);
+            }
+        }
+
         #endregion
 
         #region Implementation
 
+        /// <summary>
+        /// Returns cards of all hands in one array (7 cards per hand) for batch evaluation.
+        /// </summary>
+        private int[] GetCards(RandomHandGenerator randomHands)
+        {
+            int[] cards = new int[randomHands.hands.Length * 7];
+            for (int i = 0; i < randomHands.hands.Length; ++i)
+            {
+                Array.Copy(randomHands.hands[i].Cards, 0, cards, 7 * i, 7);
+            }
+            return cards;
+        }
+
         private delegate void OnTestCombinDelegate(CardSet handCs, int[] handA);
 
         private void GenerateTestCombin(CardSet handCs, int[] handA, int start, int count, OnTestCombinDelegate onCombin)